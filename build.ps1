@@ -206,7 +206,8 @@ $coreSources = @(
     "src/main.cpp", "src/temporal_shims.cpp", "src/module/console.cpp", "src/module/node/fs/fs.cpp", 
     "src/module/node/path/path.cpp", "src/module/node/os/os.cpp", "src/module/node/process/process.cpp", 
     "src/module/node/util/util.cpp", "src/module/node/buffer/buffer.cpp", "src/module/node/zlib/zlib.cpp",
-    "src/module/node/events/events.cpp", "src/module/node/stream/stream.cpp", "src/module/timer.cpp"
+    "src/module/node/events/events.cpp", "src/module/node/stream/stream.cpp", "src/module/timer.cpp",
+    "src/module/node/util/text_codec.cpp", "src/module/node/string_decoder/string_decoder.cpp"
 )
 
 $coreObjs = @()
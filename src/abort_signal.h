@@ -0,0 +1,156 @@
+#ifndef Z8_ABORT_SIGNAL_H
+#define Z8_ABORT_SIGNAL_H
+
+#include "v8.h"
+#include <atomic>
+#include <memory>
+
+namespace z8 {
+
+// Ties one thread pool operation to the AbortSignal in its options. The 'abort' listener runs on
+// the main thread: it raises a flag that the worker checks before it starts and between chunks,
+// and settles the promise (or calls the callback) with an AbortError right away, so a caller that
+// gave up never waits for the work to drain. Owned by the operation's context and destroyed on
+// the main thread; the completion runner calls finish() to find out whether its result is wanted.
+class AbortLink {
+  public:
+    AbortLink() = default;
+    AbortLink(const AbortLink&) = delete;
+    AbortLink& operator=(const AbortLink&) = delete;
+
+    ~AbortLink() {
+        detach(v8::Isolate::GetCurrent());
+    }
+
+    // Returns nullptr when options carries no signal. An already aborted signal settles the
+    // operation before this returns; callers check isSettled() and skip the work.
+    static std::unique_ptr<AbortLink> create(v8::Isolate* p_isolate,
+                                             v8::Local<v8::Context> context,
+                                             v8::Local<v8::Value> options,
+                                             v8::Local<v8::Promise::Resolver> resolver,
+                                             v8::Local<v8::Function> callback) {
+        if (options.IsEmpty() || !options->IsObject())
+            return nullptr;
+        v8::Local<v8::Value> signal_val;
+        v8::Local<v8::Object> options_obj = options.As<v8::Object>();
+        if (!options_obj->Get(context, v8::String::NewFromUtf8Literal(p_isolate, "signal")).ToLocal(&signal_val) ||
+            !signal_val->IsObject())
+            return nullptr;
+        v8::Local<v8::Object> signal = signal_val.As<v8::Object>();
+
+        auto up_link = std::make_unique<AbortLink>();
+        up_link->m_signal.Reset(p_isolate, signal);
+        if (!resolver.IsEmpty())
+            up_link->m_resolver.Reset(p_isolate, resolver);
+        if (!callback.IsEmpty())
+            up_link->m_callback.Reset(p_isolate, callback);
+
+        v8::Local<v8::Value> aborted;
+        if (signal->Get(context, v8::String::NewFromUtf8Literal(p_isolate, "aborted")).ToLocal(&aborted) &&
+            aborted->BooleanValue(p_isolate)) {
+            up_link->abort(p_isolate, context);
+            return up_link;
+        }
+        // The listener points at this link, so it is only added when it can be removed again.
+        v8::Local<v8::Value> add_fn;
+        v8::Local<v8::Value> remove_fn;
+        v8::Local<v8::String> add_name = v8::String::NewFromUtf8Literal(p_isolate, "addEventListener");
+        v8::Local<v8::String> remove_name = v8::String::NewFromUtf8Literal(p_isolate, "removeEventListener");
+        if (!signal->Get(context, add_name).ToLocal(&add_fn) || !add_fn->IsFunction() ||
+            !signal->Get(context, remove_name).ToLocal(&remove_fn) || !remove_fn->IsFunction())
+            return up_link;
+        v8::Local<v8::Function> listener =
+            v8::Function::New(context, onAbort, v8::External::New(p_isolate, up_link.get())).ToLocalChecked();
+        v8::Local<v8::Value> argv[] = {v8::String::NewFromUtf8Literal(p_isolate, "abort"), listener};
+        if (!add_fn.As<v8::Function>()->Call(context, signal, 2, argv).IsEmpty())
+            up_link->m_listener.Reset(p_isolate, listener);
+        return up_link;
+    }
+
+    // Safe to call from any thread.
+    bool isAborted() const {
+        return m_aborted.load(std::memory_order_relaxed);
+    }
+
+    bool isSettled() const {
+        return m_settled;
+    }
+
+    // Called on the main thread once the worker is done. Returns false when the operation was
+    // already settled by the abort and its result has to be dropped.
+    bool finish(v8::Isolate* p_isolate) {
+        detach(p_isolate);
+        return !m_settled;
+    }
+
+  private:
+    static void onAbort(const v8::FunctionCallbackInfo<v8::Value>& args) {
+        auto p_link = static_cast<AbortLink*>(args.Data().As<v8::External>()->Value());
+        v8::Isolate* p_isolate = args.GetIsolate();
+        p_link->abort(p_isolate, p_isolate->GetCurrentContext());
+    }
+
+    // Same shape as Node's AbortError: the signal's reason is kept as cause.
+    v8::Local<v8::Value> abortError(v8::Isolate* p_isolate, v8::Local<v8::Context> context) {
+        v8::Local<v8::Object> error =
+            v8::Exception::Error(v8::String::NewFromUtf8Literal(p_isolate, "The operation was aborted"))
+                .As<v8::Object>();
+        (void) error->Set(context,
+                          v8::String::NewFromUtf8Literal(p_isolate, "name"),
+                          v8::String::NewFromUtf8Literal(p_isolate, "AbortError"));
+        (void) error->Set(context,
+                          v8::String::NewFromUtf8Literal(p_isolate, "code"),
+                          v8::String::NewFromUtf8Literal(p_isolate, "ABORT_ERR"));
+        v8::Local<v8::Object> signal = m_signal.Get(p_isolate);
+        v8::Local<v8::Value> reason;
+        if (signal->Get(context, v8::String::NewFromUtf8Literal(p_isolate, "reason")).ToLocal(&reason) &&
+            !reason->IsUndefined())
+            (void) error->Set(context, v8::String::NewFromUtf8Literal(p_isolate, "cause"), reason);
+        return error;
+    }
+
+    void abort(v8::Isolate* p_isolate, v8::Local<v8::Context> context) {
+        m_aborted.store(true, std::memory_order_relaxed);
+        // EventTarget implementations without { once } support may call the listener again.
+        if (m_settled)
+            return;
+        m_settled = true;
+        v8::Local<v8::Value> error = abortError(p_isolate, context);
+        if (!m_resolver.IsEmpty()) {
+            m_resolver.Get(p_isolate)->Reject(context, error).Check();
+        } else if (!m_callback.IsEmpty()) {
+            v8::Local<v8::Value> argv[] = {error};
+            (void) m_callback.Get(p_isolate)->Call(context, context->Global(), 1, argv);
+        }
+    }
+
+    // Unhooks the listener so a long-lived signal does not keep finished operations around.
+    void detach(v8::Isolate* p_isolate) {
+        if (m_listener.IsEmpty() || !p_isolate)
+            return;
+        v8::HandleScope handle_scope(p_isolate);
+        v8::Local<v8::Context> context = p_isolate->GetCurrentContext();
+        v8::Local<v8::Object> signal = m_signal.Get(p_isolate);
+        v8::Local<v8::Value> remove_fn;
+        if (!context.IsEmpty() &&
+            signal->Get(context, v8::String::NewFromUtf8Literal(p_isolate, "removeEventListener"))
+                .ToLocal(&remove_fn) &&
+            remove_fn->IsFunction()) {
+            v8::Local<v8::Value> argv[] = {v8::String::NewFromUtf8Literal(p_isolate, "abort"),
+                                           m_listener.Get(p_isolate)};
+            (void) remove_fn.As<v8::Function>()->Call(context, signal, 2, argv);
+        }
+        m_listener.Reset();
+    }
+
+    std::atomic<bool> m_aborted{false};
+    bool m_settled = false;
+    v8::Global<v8::Object> m_signal;
+    v8::Global<v8::Function> m_listener;
+    v8::Global<v8::Promise::Resolver> m_resolver;
+    v8::Global<v8::Function> m_callback;
+};
+
+} // namespace z8
+
+#endif
@@ -0,0 +1,111 @@
+#ifndef Z8_BUFFER_ALLOCATOR_H
+#define Z8_BUFFER_ALLOCATOR_H
+
+#include "v8.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+namespace z8 {
+
+// The isolate's ArrayBuffer allocator. Backing stores up to 64 KiB are rounded up to a power
+// of two and recycled through per-size-class free lists instead of going back to the C heap,
+// which keeps short-lived Buffers and stream chunks off malloc. Each list holds at most
+// CLASS_CACHE_BYTES, so little memory sits there unaccounted. Larger stores go straight to
+// calloc/malloc. V8 counts every live backing store as external memory either way. Free() can
+// run on V8's background sweeper threads, so every class has its own lock.
+class BufferAllocator : public v8::ArrayBuffer::Allocator {
+  public:
+    static BufferAllocator& getInstance() {
+        // Never destroyed: V8 may still release backing stores while statics are torn down.
+        static BufferAllocator* p_instance = new BufferAllocator();
+        return *p_instance;
+    }
+
+    void* Allocate(size_t length) override {
+        int32_t index = classIndex(length);
+        if (index < 0)
+            return std::calloc(length, 1);
+        void* p_data = takeBlock(index);
+        if (p_data)
+            std::memset(p_data, 0, length);
+        return p_data;
+    }
+
+    // Used by V8 for stores it fills itself, and by Buffer for allocUnsafe and native output.
+    void* AllocateUninitialized(size_t length) override {
+        int32_t index = classIndex(length);
+        if (index < 0)
+            return std::malloc(length);
+        return takeBlock(index);
+    }
+
+    void Free(void* p_data, size_t length) override {
+        if (!p_data)
+            return;
+        int32_t index = classIndex(length);
+        if (index >= 0) {
+            SizeClass& size_class = m_classes[index];
+            std::lock_guard<std::mutex> lock(size_class.m_mutex);
+            if (size_class.m_blocks.size() < size_class.m_blocks.capacity()) {
+                size_class.m_blocks.push_back(p_data);
+                return;
+            }
+        }
+        std::free(p_data);
+    }
+
+  private:
+    static constexpr size_t MIN_CLASS_SIZE = 64;
+    static constexpr int32_t CLASS_COUNT = 11; // 64 B .. 64 KiB
+    static constexpr size_t CLASS_CACHE_BYTES = 512 * 1024;
+
+    struct SizeClass {
+        std::mutex m_mutex;
+        std::vector<void*> m_blocks;
+    };
+
+    BufferAllocator() {
+        for (int32_t i = 0; i < CLASS_COUNT; ++i) {
+            size_t blocks = CLASS_CACHE_BYTES / (MIN_CLASS_SIZE << i);
+            m_classes[i].m_blocks.reserve(blocks < 4 ? 4 : blocks);
+        }
+    }
+
+    BufferAllocator(const BufferAllocator&) = delete;
+    BufferAllocator& operator=(const BufferAllocator&) = delete;
+
+    // Size class for length, or -1 when it is too large to pool.
+    static int32_t classIndex(size_t length) {
+        int32_t index = 0;
+        size_t size = MIN_CLASS_SIZE;
+        while (size < length) {
+            if (++index == CLASS_COUNT)
+                return -1;
+            size <<= 1;
+        }
+        return index;
+    }
+
+    void* takeBlock(int32_t index) {
+        SizeClass& size_class = m_classes[index];
+        {
+            std::lock_guard<std::mutex> lock(size_class.m_mutex);
+            if (!size_class.m_blocks.empty()) {
+                void* p_data = size_class.m_blocks.back();
+                size_class.m_blocks.pop_back();
+                return p_data;
+            }
+        }
+        return std::malloc(MIN_CLASS_SIZE << index);
+    }
+
+    SizeClass m_classes[CLASS_COUNT];
+};
+
+} // namespace z8
+
+#endif
@@ -0,0 +1,413 @@
+#ifndef Z8_IO_RING_H
+#define Z8_IO_RING_H
+
+#include "task_queue.h"
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace z8 {
+
+// Embedded (as a base) in any request that goes through the ring. p_complete runs on the main
+// thread when the CQE is reaped, with the raw CQE result (>= 0 on success, -errno on failure).
+struct IoRingRequest {
+    void (*p_complete)(IoRingRequest* p_req, int32_t result) = nullptr;
+};
+
+// A single io_uring instance owned by the main thread. SQEs are only queued by acquire(); they
+// reach the kernel in one io_uring_enter per loop iteration (submit() or wait()), and
+// completions are reaped by the loop as well. Without a usable ring (other platforms, old
+// kernels, seccomp, Z8_NO_IO_URING=1) acquire() returns nullptr and callers use the thread pool.
+// SQEs the kernel could not take yet stay queued for the next io_uring_enter; a hard failure of
+// the call completes them with its -errno.
+class IoRing {
+  public:
+    static IoRing& getInstance() {
+        static IoRing s_instance;
+        return s_instance;
+    }
+
+#ifdef __linux__
+    bool isAvailable() const {
+        return m_ring_fd >= 0;
+    }
+
+    // Returns a zeroed SQE for p_req, or nullptr when the ring is missing, lacks opcode, or
+    // already has as many requests in flight as the CQ ring can hold.
+    io_uring_sqe* acquire(IoRingRequest* p_req, uint8_t opcode) {
+        if (m_ring_fd < 0 || opcode >= IORING_OP_LAST || !m_supported[opcode] || m_in_flight >= m_cq_entries)
+            return nullptr;
+        io_uring_sqe* p_sqe = nextSqe(opcode, reinterpret_cast<uint64_t>(p_req));
+        if (p_sqe)
+            m_in_flight++;
+        return p_sqe;
+    }
+
+    // Number of requests handed out by acquire() whose completion has not run yet.
+    uint32_t inFlight() const {
+        return m_in_flight;
+    }
+
+    // Pushes every SQE queued since the last call to the kernel without waiting.
+    void submit() {
+        enter(0, 0, nullptr);
+    }
+
+    // Runs the completion of every CQE that is ready. Returns the number of completions run.
+    uint32_t reap() {
+        uint32_t count = 0;
+        uint32_t head = *p_cq_head;
+        for (;;) {
+            uint32_t tail = std::atomic_ref<uint32_t>(*p_cq_tail).load(std::memory_order_acquire);
+            if (head == tail)
+                break;
+            // Completions may queue new SQEs; copy the CQE out and free the slot first.
+            io_uring_cqe cqe = p_cqes[head & m_cq_mask];
+            head++;
+            std::atomic_ref<uint32_t>(*p_cq_head).store(head, std::memory_order_release);
+            if (complete(cqe.user_data, cqe.res))
+                count++;
+        }
+        return count;
+    }
+
+    // Submits pending SQEs and sleeps until a CQE arrives, a task is posted to the TaskQueue or
+    // the timeout expires. Posting a task wakes the ring through an eventfd read kept on it.
+    // Kernels without IORING_ENTER_EXT_ARG (before 5.11) bound the sleep with a timeout SQE
+    // instead. Only when neither works (no eventfd, no timeout opcodes, a full ring) does it
+    // fall back to polling: a 1ms TaskQueue wait, with completions picked up by the next reap().
+    void wait(std::chrono::milliseconds timeout) {
+        if (m_wake_fd < 0 || (!m_ext_arg && !armTimeout(timeout))) {
+            submit();
+            TaskQueue::getInstance().wait(std::chrono::milliseconds(1));
+            return;
+        }
+        armWake();
+        m_sleeping.store(true);
+        if (!TaskQueue::getInstance().isEmpty()) {
+            m_sleeping.store(false);
+            submit();
+            return;
+        }
+        if (m_ext_arg) {
+            __kernel_timespec ts = {};
+            ts.tv_sec = timeout.count() / 1000;
+            ts.tv_nsec = (timeout.count() % 1000) * 1000000;
+            io_uring_getevents_arg arg = {};
+            arg.ts = reinterpret_cast<uint64_t>(&ts);
+            enter(1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg);
+        } else {
+            enter(1, IORING_ENTER_GETEVENTS, nullptr);
+        }
+        m_sleeping.store(false);
+    }
+#else
+    bool isAvailable() const {
+        return false;
+    }
+
+    uint32_t inFlight() const {
+        return 0;
+    }
+
+    void submit() {}
+
+    uint32_t reap() {
+        return 0;
+    }
+
+    void wait(std::chrono::milliseconds timeout) {
+        TaskQueue::getInstance().wait(timeout);
+    }
+#endif
+
+  private:
+#ifdef __linux__
+    static constexpr uint32_t RING_ENTRIES = 256;
+    // user_data of the ring's own SQEs; requests carry their (never this small) address.
+    static constexpr uint64_t WAKE_TAG = 1;
+    static constexpr uint64_t TIMEOUT_TAG = 2;
+    static constexpr uint64_t TIMEOUT_REMOVE_TAG = 3;
+
+    IoRing() {
+        const char* p_disable = std::getenv("Z8_NO_IO_URING");
+        if (p_disable && p_disable[0] == '1')
+            return;
+
+        io_uring_params params = {};
+        params.flags = IORING_SETUP_CLAMP;
+        int32_t fd = static_cast<int32_t>(syscall(__NR_io_uring_setup, RING_ENTRIES, &params));
+        if (fd < 0)
+            return;
+        if (!(params.features & IORING_FEAT_SINGLE_MMAP) || !probe(fd)) {
+            close(fd);
+            return;
+        }
+
+        m_sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+        size_t cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        m_sq_ring_size = m_sq_ring_size > cq_size ? m_sq_ring_size : cq_size;
+        m_sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        p_ring =
+            mmap(nullptr, m_sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        void* p_sqe_map =
+            mmap(nullptr, m_sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+        if (p_ring == MAP_FAILED || p_sqe_map == MAP_FAILED) {
+            if (p_ring != MAP_FAILED)
+                munmap(p_ring, m_sq_ring_size);
+            if (p_sqe_map != MAP_FAILED)
+                munmap(p_sqe_map, m_sqes_size);
+            p_ring = nullptr;
+            close(fd);
+            return;
+        }
+
+        auto p_base = static_cast<char*>(p_ring);
+        p_sq_head = reinterpret_cast<uint32_t*>(p_base + params.sq_off.head);
+        p_sq_tail = reinterpret_cast<uint32_t*>(p_base + params.sq_off.tail);
+        m_sq_mask = *reinterpret_cast<uint32_t*>(p_base + params.sq_off.ring_mask);
+        m_sq_entries = params.sq_entries;
+        m_sq_tail = *p_sq_tail;
+        auto p_array = reinterpret_cast<uint32_t*>(p_base + params.sq_off.array);
+        for (uint32_t i = 0; i < m_sq_entries; ++i)
+            p_array[i] = i;
+        p_cq_head = reinterpret_cast<uint32_t*>(p_base + params.cq_off.head);
+        p_cq_tail = reinterpret_cast<uint32_t*>(p_base + params.cq_off.tail);
+        m_cq_mask = *reinterpret_cast<uint32_t*>(p_base + params.cq_off.ring_mask);
+        // CQ slots stay free for the wake read and the wait timeouts (two of them plus a removal).
+        m_cq_entries = params.cq_entries - 4;
+        p_cqes = reinterpret_cast<io_uring_cqe*>(p_base + params.cq_off.cqes);
+        p_sqes = static_cast<io_uring_sqe*>(p_sqe_map);
+        m_ext_arg = (params.features & IORING_FEAT_EXT_ARG) != 0;
+        m_ring_fd = fd;
+
+        m_wake_fd = eventfd(0, EFD_CLOEXEC);
+        if (m_wake_fd >= 0)
+            TaskQueue::getInstance().setWakeHook(wakeFromTaskQueue);
+    }
+
+    ~IoRing() {
+        if (m_ring_fd < 0)
+            return;
+        TaskQueue::getInstance().setWakeHook(nullptr);
+        munmap(p_sqes, m_sqes_size);
+        munmap(p_ring, m_sq_ring_size);
+        close(m_ring_fd);
+        if (m_wake_fd >= 0)
+            close(m_wake_fd);
+    }
+
+    // Records which opcodes the running kernel implements.
+    bool probe(int32_t fd) {
+        size_t size = sizeof(io_uring_probe) + IORING_OP_LAST * sizeof(io_uring_probe_op);
+        auto p_probe = static_cast<io_uring_probe*>(std::calloc(1, size));
+        if (!p_probe)
+            return false;
+        bool ok = syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, p_probe, IORING_OP_LAST) == 0;
+        for (uint32_t i = 0; ok && i < p_probe->ops_len && i < IORING_OP_LAST; ++i)
+            m_supported[i] = (p_probe->ops[i].flags & IO_URING_OP_SUPPORTED) != 0;
+        std::free(p_probe);
+        return ok;
+    }
+
+    // Free SQ slots. A slot is reusable only once the kernel has moved the SQ head past it.
+    uint32_t sqFree() const {
+        uint32_t head = std::atomic_ref<uint32_t>(*p_sq_head).load(std::memory_order_acquire);
+        return m_sq_entries - (m_sq_tail - head);
+    }
+
+    // Zeroed SQE in the next free slot, submitting once first when the SQ is full. nullptr when
+    // the kernel still holds every slot.
+    io_uring_sqe* nextSqe(uint8_t opcode, uint64_t user_data) {
+        if (sqFree() == 0)
+            submit();
+        if (sqFree() == 0)
+            return nullptr;
+        io_uring_sqe* p_sqe = &p_sqes[m_sq_tail & m_sq_mask];
+        std::memset(p_sqe, 0, sizeof(io_uring_sqe));
+        p_sqe->opcode = opcode;
+        p_sqe->user_data = user_data;
+        m_sq_tail++;
+        m_pending++;
+        return p_sqe;
+    }
+
+    // Publishes the queued SQEs and calls io_uring_enter until the kernel has taken them. A
+    // signal (EINTR) retries the call; a full CQ (EBUSY/EAGAIN) is drained and the call retried,
+    // without waiting again since the drained completions are work for the loop. What the kernel
+    // did not take stays counted in m_pending. Completions run while draining may queue SQEs
+    // but do not enter the ring again themselves.
+    void enter(uint32_t min_complete, uint32_t flags, io_uring_getevents_arg* p_arg) {
+        if (m_entering)
+            return;
+        m_entering = true;
+        for (;;) {
+            if (m_pending == 0 && min_complete == 0)
+                break;
+            std::atomic_ref<uint32_t>(*p_sq_tail).store(m_sq_tail, std::memory_order_release);
+            // The kernel copies the SQEs during the call, so they can be reused right after.
+            int32_t submitted = static_cast<int32_t>(syscall(__NR_io_uring_enter,
+                                                             m_ring_fd,
+                                                             m_pending,
+                                                             min_complete,
+                                                             flags,
+                                                             p_arg,
+                                                             p_arg ? sizeof(io_uring_getevents_arg) : 0));
+            int32_t err_no = submitted < 0 ? errno : 0;
+            m_pending = m_sq_tail - std::atomic_ref<uint32_t>(*p_sq_head).load(std::memory_order_acquire);
+            if (submitted >= 0) {
+                // The wait (if any) is over; a partial submission goes around once more for the rest.
+                if (m_pending == 0 || submitted == 0)
+                    break;
+                min_complete = 0;
+                flags &= ~IORING_ENTER_GETEVENTS;
+            } else if (err_no == EINTR) {
+                continue;
+            } else if (err_no == EBUSY || err_no == EAGAIN) {
+                if (reap() == 0)
+                    break;
+                min_complete = 0;
+                flags &= ~IORING_ENTER_GETEVENTS;
+            } else {
+                failPending(-err_no);
+                break;
+            }
+        }
+        m_entering = false;
+    }
+
+    // Takes back every SQE the kernel has not consumed and completes its request with result.
+    void failPending(int32_t result) {
+        uint32_t head = std::atomic_ref<uint32_t>(*p_sq_head).load(std::memory_order_acquire);
+        std::vector<uint64_t> user_data;
+        user_data.reserve(m_sq_tail - head);
+        for (uint32_t i = head; i != m_sq_tail; ++i)
+            user_data.push_back(p_sqes[i & m_sq_mask].user_data);
+        m_sq_tail = head;
+        m_pending = 0;
+        std::atomic_ref<uint32_t>(*p_sq_tail).store(m_sq_tail, std::memory_order_release);
+        for (uint64_t data : user_data)
+            complete(data, result);
+    }
+
+    // Runs the completion for user_data, or updates the ring's own bookkeeping for its SQEs.
+    // Returns whether a request completed.
+    bool complete(uint64_t user_data, int32_t result) {
+        if (user_data == WAKE_TAG) {
+            m_wake_armed = false;
+            return false;
+        }
+        if (user_data == TIMEOUT_TAG) {
+            m_timeouts--;
+            return false;
+        }
+        if (user_data == TIMEOUT_REMOVE_TAG) {
+            m_timeout_removing = false;
+            return false;
+        }
+        m_in_flight--;
+        auto p_req = reinterpret_cast<IoRingRequest*>(user_data);
+        p_req->p_complete(p_req, result);
+        return true;
+    }
+
+    // Makes sure a timeout SQE fires no later than timeout from now, so a GETEVENTS wait without
+    // EXT_ARG cannot sleep past it. A live timeout that fires soon enough is kept; a later one is
+    // removed and replaced. False when the opcodes are missing or the ring has no room.
+    bool armTimeout(std::chrono::milliseconds timeout) {
+        if (!m_supported[IORING_OP_TIMEOUT] || !m_supported[IORING_OP_TIMEOUT_REMOVE])
+            return false;
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        if (m_timeouts > 0 && m_timeout_deadline <= deadline)
+            return true;
+        if (m_timeouts > 1 || m_timeout_removing || sqFree() < 2)
+            return false;
+        if (m_timeouts == 1) {
+            io_uring_sqe* p_remove = nextSqe(IORING_OP_TIMEOUT_REMOVE, TIMEOUT_REMOVE_TAG);
+            p_remove->addr = TIMEOUT_TAG;
+            m_timeout_removing = true;
+        }
+        m_timeout_ts.tv_sec = timeout.count() / 1000;
+        m_timeout_ts.tv_nsec = (timeout.count() % 1000) * 1000000;
+        io_uring_sqe* p_sqe = nextSqe(IORING_OP_TIMEOUT, TIMEOUT_TAG);
+        p_sqe->addr = reinterpret_cast<uint64_t>(&m_timeout_ts);
+        p_sqe->len = 1;
+        m_timeouts++;
+        m_timeout_deadline = deadline;
+        return true;
+    }
+
+    // Keeps one eventfd read on the ring so wait() also returns when a worker posts a task.
+    void armWake() {
+        if (m_wake_armed || sqFree() == 0)
+            return;
+        io_uring_sqe* p_sqe = nextSqe(IORING_OP_READ, WAKE_TAG);
+        p_sqe->fd = m_wake_fd;
+        p_sqe->addr = reinterpret_cast<uint64_t>(&m_wake_value);
+        p_sqe->len = sizeof(m_wake_value);
+        p_sqe->off = static_cast<uint64_t>(-1);
+        m_wake_armed = true;
+    }
+
+    static void wakeFromTaskQueue() {
+        IoRing& ring = getInstance();
+        if (ring.m_sleeping.exchange(false)) {
+            uint64_t one = 1;
+            ssize_t written = write(ring.m_wake_fd, &one, sizeof(one));
+            (void) written;
+        }
+    }
+
+    int32_t m_ring_fd = -1;
+    void* p_ring = nullptr;
+    size_t m_sq_ring_size = 0;
+    size_t m_sqes_size = 0;
+    uint32_t* p_sq_head = nullptr;
+    uint32_t* p_sq_tail = nullptr;
+    // Tail including SQEs queued since the last io_uring_enter; *p_sq_tail is the published one.
+    uint32_t m_sq_tail = 0;
+    uint32_t m_sq_mask = 0;
+    uint32_t m_sq_entries = 0;
+    uint32_t* p_cq_head = nullptr;
+    uint32_t* p_cq_tail = nullptr;
+    uint32_t m_cq_mask = 0;
+    uint32_t m_cq_entries = 0;
+    io_uring_cqe* p_cqes = nullptr;
+    io_uring_sqe* p_sqes = nullptr;
+    // SQEs queued but not yet taken by the kernel.
+    uint32_t m_pending = 0;
+    uint32_t m_in_flight = 0;
+    bool m_ext_arg = false;
+    bool m_entering = false;
+    bool m_wake_armed = false;
+    uint32_t m_timeouts = 0;
+    bool m_timeout_removing = false;
+    std::chrono::steady_clock::time_point m_timeout_deadline;
+    __kernel_timespec m_timeout_ts = {};
+    uint64_t m_wake_value = 0;
+    bool m_supported[IORING_OP_LAST] = {};
+
+    int32_t m_wake_fd = -1;
+    std::atomic<bool> m_sleeping{false};
+#else
+    IoRing() = default;
+#endif
+    IoRing(const IoRing&) = delete;
+    IoRing& operator=(const IoRing&) = delete;
+};
+
+} // namespace z8
+
+#endif
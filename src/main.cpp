@@ -32,9 +32,13 @@
 #include "module/node/os/os.h"
 #include "module/node/path/path.h"
 #include "module/node/process/process.h"
+#include "module/node/string_decoder/string_decoder.h"
+#include "module/node/util/text_codec.h"
 #include "module/node/util/util.h"
 #include "module/node/zlib/zlib.h"
 #include "module/node/stream/stream.h"
+#include "buffer_allocator.h"
+#include "io_ring.h"
 #include "task_queue.h"
 #include "thread_pool.h"
 
@@ -74,6 +78,8 @@ class Runtime {
         static std::unique_ptr<v8::Platform> up_platform = v8::platform::NewDefaultPlatform();
         v8::V8::InitializePlatform(up_platform.get());
         v8::V8::Initialize();
+
+        z8::module::FS::raiseFdLimit();
     }
 
     static void Shutdown() {
@@ -83,7 +89,7 @@ class Runtime {
 
     Runtime() {
         v8::Isolate::CreateParams create_params;
-        create_params.array_buffer_allocator = v8::ArrayBuffer::Allocator::NewDefaultAllocator();
+        create_params.array_buffer_allocator = &z8::BufferAllocator::getInstance();
 
         // Increase memory limits for competitive benchmarking
         // Deno uses ~128MB semi-space, which is ~256MB young generation
@@ -116,6 +122,9 @@ class Runtime {
 
         // Initialize Buffer module (global object)
         z8::module::Buffer::initialize(p_isolate, context);
+
+        // TextEncoder/TextDecoder globals
+        z8::module::TextCodec::initialize(p_isolate, context);
     }
 
     ~Runtime() {
@@ -469,6 +478,41 @@ class Runtime {
             return module;
         }
 
+        if (specifier_str == "node:string_decoder") {
+            v8::Local<v8::ObjectTemplate> decoder_template = z8::module::StringDecoder::createTemplate(p_isolate);
+            v8::Local<v8::Object> decoder_instance = decoder_template->NewInstance(context).ToLocalChecked();
+            v8::Local<v8::Array> prop_names = decoder_instance->GetPropertyNames(context).ToLocalChecked();
+
+            std::vector<v8::Local<v8::String>> export_names;
+            export_names.push_back(v8::String::NewFromUtf8Literal(p_isolate, "default"));
+            for (uint32_t i = 0; i < prop_names->Length(); ++i) {
+                export_names.push_back(prop_names->Get(context, i).ToLocalChecked().As<v8::String>());
+            }
+
+            auto module = v8::Module::CreateSyntheticModule(
+                p_isolate,
+                v8::String::NewFromUtf8Literal(p_isolate, "node:string_decoder"),
+                v8::MemorySpan<const v8::Local<v8::String>>(export_names.data(), export_names.size()),
+                [](v8::Local<v8::Context> context, v8::Local<v8::Module> module) -> v8::MaybeLocal<v8::Value> {
+                    v8::Isolate* p_isolate = v8::Isolate::GetCurrent();
+                    v8::Local<v8::ObjectTemplate> decoder_template =
+                        z8::module::StringDecoder::createTemplate(p_isolate);
+                    v8::Local<v8::Object> decoder_obj = decoder_template->NewInstance(context).ToLocalChecked();
+                    module
+                        ->SetSyntheticModuleExport(
+                            p_isolate, v8::String::NewFromUtf8Literal(p_isolate, "default"), decoder_obj)
+                        .Check();
+                    v8::Local<v8::Array> prop_names = decoder_obj->GetPropertyNames(context).ToLocalChecked();
+                    for (uint32_t i = 0; i < prop_names->Length(); ++i) {
+                        v8::Local<v8::String> name = prop_names->Get(context, i).ToLocalChecked().As<v8::String>();
+                        v8::Local<v8::Value> value = decoder_obj->Get(context, name).ToLocalChecked();
+                        module->SetSyntheticModuleExport(p_isolate, name, value).Check();
+                    }
+                    return v8::Undefined(p_isolate);
+                });
+            return module;
+        }
+
         // Handle relative imports (very basic for now)
         // In a real implementation, we'd read the file and compile it as a module
         p_isolate->ThrowException(
@@ -523,6 +567,9 @@ class Runtime {
         // Event Loop
         bool keep_running = true;
         while (keep_running) {
+            // 0. Reap io_uring completions; they post their tasks to the TaskQueue
+            z8::IoRing::getInstance().reap();
+
             // 1. Process Tasks from TaskQueue
             while (!z8::TaskQueue::getInstance().isEmpty()) {
                 z8::Task* p_task = z8::TaskQueue::getInstance().dequeue();
@@ -552,7 +599,11 @@ class Runtime {
                 }
             }
 
+            // Everything queued on the ring during this iteration goes to the kernel in one call
+            z8::IoRing::getInstance().submit();
+
             // 3. Final termination check
+            bool ring_busy = z8::IoRing::getInstance().inFlight() > 0;
             bool has_work = z8::module::Timer::hasActiveTimers() ||
                             !z8::TaskQueue::getInstance().isEmpty() ||
                             z8::ThreadPool::getInstance().hasPendingTasks();
@@ -565,8 +616,10 @@ class Runtime {
                 has_work = z8::module::Timer::hasActiveTimers() ||
                            !z8::TaskQueue::getInstance().isEmpty() ||
                            z8::ThreadPool::getInstance().hasPendingTasks();
+                ring_busy = z8::IoRing::getInstance().inFlight() > 0;
                 
-                if (!has_work) {
+                // Open fs watchers keep the loop alive; their events arrive through the TaskQueue.
+                if (!has_work && !ring_busy && !z8::module::FS::hasActiveWatchers()) {
                     keep_running = false;
                 }
             }
@@ -575,10 +628,13 @@ class Runtime {
             if (keep_running && !has_work) { // Only wait if there's truly nothing to do
                 std::chrono::milliseconds delay = z8::module::Timer::getNextDelay();
                 std::chrono::milliseconds timeout(10); // Always wait for a small duration
-                if (delay.count() >= 0) {
+                if (delay.count() > 0) { // 0 also means "no timers", which must not spin
                     timeout = std::chrono::milliseconds(std::min(static_cast<int64_t>(delay.count()), 10LL));
                 }
-                z8::TaskQueue::getInstance().wait(timeout);
+                if (ring_busy)
+                    z8::IoRing::getInstance().wait(timeout); // Also returns when a task is posted
+                else
+                    z8::TaskQueue::getInstance().wait(timeout);
             }
         }
 
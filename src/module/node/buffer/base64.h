@@ -0,0 +1,367 @@
+#ifndef Z8_MODULE_BUFFER_BASE64_H
+#define Z8_MODULE_BUFFER_BASE64_H
+
+#include "simd.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Base64 and base64url codecs for Buffer, atob and btoa. The vector kernels are the pshufb
+// lookups described by Wojciech Mula (SSE4.1/AVX2) and vqtbl lookups on NEON; each handles the
+// clean blocks in the middle of the input and leaves the rest to the scalar loop.
+namespace z8 {
+namespace base64 {
+
+static constexpr char STANDARD_ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+static constexpr char URL_ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+static constexpr uint8_t INVALID = 0xFF;
+
+// Both alphabets decode, whichever encoding was asked for, as in Node.
+constexpr std::array<uint8_t, 256> makeDecodeTable() {
+    std::array<uint8_t, 256> table = {};
+    for (uint8_t& value : table)
+        value = INVALID;
+    for (uint8_t i = 0; i < 64; ++i) {
+        table[static_cast<uint8_t>(STANDARD_ALPHABET[i])] = i;
+        table[static_cast<uint8_t>(URL_ALPHABET[i])] = i;
+    }
+    return table;
+}
+
+static constexpr std::array<uint8_t, 256> DECODE_TABLE = makeDecodeTable();
+
+inline size_t encodedLength(size_t length, bool url) {
+    if (!url)
+        return (length + 2) / 3 * 4;
+    return length / 3 * 4 + (length % 3 ? length % 3 + 1 : 0);
+}
+
+// Upper bound for decode(): no input of length characters decodes to more bytes.
+inline size_t decodedCapacity(size_t length) {
+    return length / 4 * 3 + length % 4 * 3 / 4;
+}
+
+// Node's Buffer.byteLength(str, 'base64'): the length implied by the characters, ignoring up
+// to two trailing '='.
+template <typename Char>
+inline size_t decodedLength(const Char* p_src, size_t length) {
+    if (length > 0 && p_src[length - 1] == '=')
+        length--;
+    if (length > 0 && p_src[length - 1] == '=')
+        length--;
+    size_t size = length / 4 * 3;
+    size_t remainder = length % 4;
+    if (remainder && !(size == 0 && remainder == 1))
+        size += remainder == 3 ? 2 : 1;
+    return size;
+}
+
+// --- Vector kernels ---
+// Each one returns how many input bytes (encode) or characters (decode) it consumed, always a
+// whole number of groups. Decoders stop at the first block holding anything but alphabet
+// characters and may store up to 4 (SSE) or 8 (AVX2) bytes past the decoded data, which
+// decodedCapacity() leaves room for because they only run with 24 or 48 characters left.
+
+#if defined(Z8_SIMD_X64)
+Z8_TARGET_SSE41 inline __m128i encodeIndicesSse41(__m128i in) {
+    in = _mm_shuffle_epi8(in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+    __m128i t0 = _mm_mulhi_epu16(_mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040));
+    __m128i t1 = _mm_mullo_epi16(_mm_and_si128(in, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010));
+    return _mm_or_si128(t0, t1);
+}
+
+// Offsets from a 6-bit index to its character, keyed by the index range (see encodeSse41).
+Z8_TARGET_SSE41 inline __m128i encodeOffsets(bool url) {
+    return _mm_setr_epi8('a' - 26,
+                         '0' - 52,
+                         '0' - 52,
+                         '0' - 52,
+                         '0' - 52,
+                         '0' - 52,
+                         '0' - 52,
+                         '0' - 52,
+                         '0' - 52,
+                         '0' - 52,
+                         '0' - 52,
+                         url ? '-' - 62 : '+' - 62,
+                         url ? '_' - 63 : '/' - 63,
+                         'A',
+                         0,
+                         0);
+}
+
+Z8_TARGET_SSE41 inline size_t encodeSse41(const uint8_t* p_src, size_t length, char* p_dst, bool url) {
+    const __m128i offsets = encodeOffsets(url);
+    size_t i = 0;
+    for (; length - i >= 16; i += 12) {
+        __m128i indices = encodeIndicesSse41(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p_src + i)));
+        // 0..25 -> 13, 26..51 -> 0, 52..61 -> 1..10, 62 -> 11, 63 -> 12
+        __m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+        range = _mm_or_si128(range, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), indices), _mm_set1_epi8(13)));
+        __m128i chars = _mm_add_epi8(_mm_shuffle_epi8(offsets, range), indices);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(p_dst + i / 3 * 4), chars);
+    }
+    return i;
+}
+
+Z8_TARGET_AVX2 inline size_t encodeAvx2(const uint8_t* p_src, size_t length, char* p_dst, bool url) {
+    const __m256i offsets = _mm256_broadcastsi128_si256(encodeOffsets(url));
+    const __m256i spread =
+        _mm256_broadcastsi128_si256(_mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+    size_t i = 0;
+    for (; length - i >= 28; i += 24) {
+        __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p_src + i));
+        __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p_src + i + 12));
+        __m256i in = _mm256_shuffle_epi8(_mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1), spread);
+        __m256i t0 = _mm256_mulhi_epu16(_mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00)),
+                                        _mm256_set1_epi32(0x04000040));
+        __m256i t1 = _mm256_mullo_epi16(_mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0)),
+                                        _mm256_set1_epi32(0x01000010));
+        __m256i indices = _mm256_or_si256(t0, t1);
+        __m256i range = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+        range = _mm256_or_si256(
+            range, _mm256_and_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices), _mm256_set1_epi8(13)));
+        __m256i chars = _mm256_add_epi8(_mm256_shuffle_epi8(offsets, range), indices);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p_dst + i / 3 * 4), chars);
+    }
+    return i;
+}
+
+// Nibble tables that flag non-alphabet characters, and the per-range offsets back to 0..63.
+Z8_TARGET_SSE41 inline __m128i decodeLoTable() {
+    return _mm_setr_epi8(
+        0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+}
+
+Z8_TARGET_SSE41 inline __m128i decodeHiTable() {
+    return _mm_setr_epi8(
+        0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+}
+
+Z8_TARGET_SSE41 inline __m128i decodeRollTable() {
+    return _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+}
+
+Z8_TARGET_SSE41 inline size_t decodeSse41(const uint8_t* p_src, size_t length, uint8_t* p_dst) {
+    const __m128i lo_table = decodeLoTable();
+    const __m128i hi_table = decodeHiTable();
+    const __m128i roll_table = decodeRollTable();
+    const __m128i mask_2f = _mm_set1_epi8(0x2F);
+    size_t i = 0;
+    for (; length - i >= 24; i += 16) {
+        __m128i str = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p_src + i));
+        // base64url characters become their standard twins.
+        str = _mm_add_epi8(str, _mm_and_si128(_mm_cmpeq_epi8(str, _mm_set1_epi8('-')), _mm_set1_epi8('+' - '-')));
+        str = _mm_add_epi8(str, _mm_and_si128(_mm_cmpeq_epi8(str, _mm_set1_epi8('_')), _mm_set1_epi8('/' - '_')));
+        __m128i hi_nibbles = _mm_and_si128(_mm_srli_epi32(str, 4), mask_2f);
+        __m128i lo = _mm_shuffle_epi8(lo_table, _mm_and_si128(str, mask_2f));
+        __m128i hi = _mm_shuffle_epi8(hi_table, hi_nibbles);
+        if (!_mm_testz_si128(lo, hi))
+            break;
+        __m128i roll = _mm_shuffle_epi8(roll_table, _mm_add_epi8(_mm_cmpeq_epi8(str, mask_2f), hi_nibbles));
+        __m128i values = _mm_add_epi8(str, roll);
+        __m128i merged = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+        __m128i packed = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+        packed = _mm_shuffle_epi8(packed, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(p_dst + i / 4 * 3), packed);
+    }
+    return i;
+}
+
+Z8_TARGET_AVX2 inline size_t decodeAvx2(const uint8_t* p_src, size_t length, uint8_t* p_dst) {
+    const __m256i lo_table = _mm256_broadcastsi128_si256(decodeLoTable());
+    const __m256i hi_table = _mm256_broadcastsi128_si256(decodeHiTable());
+    const __m256i roll_table = _mm256_broadcastsi128_si256(decodeRollTable());
+    const __m256i mask_2f = _mm256_set1_epi8(0x2F);
+    const __m256i pack = _mm256_broadcastsi128_si256(
+        _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+    size_t i = 0;
+    for (; length - i >= 48; i += 32) {
+        __m256i str = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p_src + i));
+        str = _mm256_add_epi8(
+            str, _mm256_and_si256(_mm256_cmpeq_epi8(str, _mm256_set1_epi8('-')), _mm256_set1_epi8('+' - '-')));
+        str = _mm256_add_epi8(
+            str, _mm256_and_si256(_mm256_cmpeq_epi8(str, _mm256_set1_epi8('_')), _mm256_set1_epi8('/' - '_')));
+        __m256i hi_nibbles = _mm256_and_si256(_mm256_srli_epi32(str, 4), mask_2f);
+        __m256i lo = _mm256_shuffle_epi8(lo_table, _mm256_and_si256(str, mask_2f));
+        __m256i hi = _mm256_shuffle_epi8(hi_table, hi_nibbles);
+        if (!_mm256_testz_si256(lo, hi))
+            break;
+        __m256i roll =
+            _mm256_shuffle_epi8(roll_table, _mm256_add_epi8(_mm256_cmpeq_epi8(str, mask_2f), hi_nibbles));
+        __m256i values = _mm256_add_epi8(str, roll);
+        __m256i merged = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+        __m256i packed = _mm256_shuffle_epi8(_mm256_madd_epi16(merged, _mm256_set1_epi32(0x00011000)), pack);
+        packed = _mm256_permutevar8x32_epi32(packed, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p_dst + i / 4 * 3), packed);
+    }
+    return i;
+}
+#elif defined(Z8_SIMD_NEON)
+inline uint8x16x4_t loadTable(const uint8_t* p_table) {
+    uint8x16x4_t table;
+    table.val[0] = vld1q_u8(p_table);
+    table.val[1] = vld1q_u8(p_table + 16);
+    table.val[2] = vld1q_u8(p_table + 32);
+    table.val[3] = vld1q_u8(p_table + 48);
+    return table;
+}
+
+inline size_t encodeNeon(const uint8_t* p_src, size_t length, char* p_dst, bool url) {
+    const uint8x16x4_t alphabet =
+        loadTable(reinterpret_cast<const uint8_t*>(url ? URL_ALPHABET : STANDARD_ALPHABET));
+    const uint8x16_t mask = vdupq_n_u8(0x3F);
+    size_t i = 0;
+    for (; length - i >= 48; i += 48) {
+        uint8x16x3_t in = vld3q_u8(p_src + i);
+        uint8x16x4_t out;
+        out.val[0] = vshrq_n_u8(in.val[0], 2);
+        out.val[1] = vandq_u8(vorrq_u8(vshlq_n_u8(in.val[0], 4), vshrq_n_u8(in.val[1], 4)), mask);
+        out.val[2] = vandq_u8(vorrq_u8(vshlq_n_u8(in.val[1], 2), vshrq_n_u8(in.val[2], 6)), mask);
+        out.val[3] = vandq_u8(in.val[2], mask);
+        out.val[0] = vqtbl4q_u8(alphabet, out.val[0]);
+        out.val[1] = vqtbl4q_u8(alphabet, out.val[1]);
+        out.val[2] = vqtbl4q_u8(alphabet, out.val[2]);
+        out.val[3] = vqtbl4q_u8(alphabet, out.val[3]);
+        vst4q_u8(reinterpret_cast<uint8_t*>(p_dst) + i / 3 * 4, out);
+    }
+    return i;
+}
+
+// Characters 0..63 go through the first table, 64..127 through the second; anything that
+// maps to INVALID or has the top bit set ends the run.
+inline uint8x16_t decodeValuesNeon(uint8x16_t chars, uint8x16x4_t lo_table, uint8x16x4_t hi_table, uint8x16_t& bad) {
+    uint8x16_t values = vqtbx4q_u8(vqtbl4q_u8(lo_table, chars), hi_table, vsubq_u8(chars, vdupq_n_u8(64)));
+    bad = vorrq_u8(bad, vorrq_u8(vcgtq_u8(values, vdupq_n_u8(63)), vcgeq_u8(chars, vdupq_n_u8(128))));
+    return values;
+}
+
+inline size_t decodeNeon(const uint8_t* p_src, size_t length, uint8_t* p_dst) {
+    const uint8x16x4_t lo_table = loadTable(DECODE_TABLE.data());
+    const uint8x16x4_t hi_table = loadTable(DECODE_TABLE.data() + 64);
+    size_t i = 0;
+    for (; length - i >= 64; i += 64) {
+        uint8x16x4_t str = vld4q_u8(p_src + i);
+        uint8x16_t bad = vdupq_n_u8(0);
+        uint8x16_t a = decodeValuesNeon(str.val[0], lo_table, hi_table, bad);
+        uint8x16_t b = decodeValuesNeon(str.val[1], lo_table, hi_table, bad);
+        uint8x16_t c = decodeValuesNeon(str.val[2], lo_table, hi_table, bad);
+        uint8x16_t d = decodeValuesNeon(str.val[3], lo_table, hi_table, bad);
+        if (vmaxvq_u8(bad) != 0)
+            break;
+        uint8x16x3_t out;
+        out.val[0] = vorrq_u8(vshlq_n_u8(a, 2), vshrq_n_u8(b, 4));
+        out.val[1] = vorrq_u8(vshlq_n_u8(b, 4), vshrq_n_u8(c, 2));
+        out.val[2] = vorrq_u8(vshlq_n_u8(c, 6), d);
+        vst3q_u8(p_dst + i / 4 * 3, out);
+    }
+    return i;
+}
+#endif
+
+inline size_t encodeBlocks(const uint8_t* p_src, size_t length, char* p_dst, bool url) {
+    size_t i = 0;
+#if defined(Z8_SIMD_X64)
+    int32_t level = simd::level();
+    if (level >= simd::LEVEL_AVX2)
+        i = encodeAvx2(p_src, length, p_dst, url);
+    if (level >= simd::LEVEL_SSE41)
+        i += encodeSse41(p_src + i, length - i, p_dst + i / 3 * 4, url);
+#elif defined(Z8_SIMD_NEON)
+    i = encodeNeon(p_src, length, p_dst, url);
+#endif
+    return i;
+}
+
+inline size_t decodeBlocks(const uint8_t* p_src, size_t length, uint8_t* p_dst) {
+    size_t i = 0;
+#if defined(Z8_SIMD_X64)
+    int32_t level = simd::level();
+    if (level >= simd::LEVEL_AVX2)
+        i = decodeAvx2(p_src, length, p_dst);
+    if (level >= simd::LEVEL_SSE41)
+        i += decodeSse41(p_src + i, length - i, p_dst + i / 4 * 3);
+#elif defined(Z8_SIMD_NEON)
+    i = decodeNeon(p_src, length, p_dst);
+#endif
+    return i;
+}
+
+// --- Codecs ---
+
+// Writes exactly encodedLength(length, url) characters: padded base64, or unpadded base64url.
+inline size_t encode(const uint8_t* p_src, size_t length, char* p_dst, bool url) {
+    const char* p_alphabet = url ? URL_ALPHABET : STANDARD_ALPHABET;
+    size_t i = encodeBlocks(p_src, length, p_dst, url);
+    size_t o = i / 3 * 4;
+    for (; length - i >= 3; i += 3) {
+        uint32_t group = (static_cast<uint32_t>(p_src[i]) << 16) | (p_src[i + 1] << 8) | p_src[i + 2];
+        p_dst[o++] = p_alphabet[group >> 18];
+        p_dst[o++] = p_alphabet[(group >> 12) & 0x3F];
+        p_dst[o++] = p_alphabet[(group >> 6) & 0x3F];
+        p_dst[o++] = p_alphabet[group & 0x3F];
+    }
+    size_t rest = length - i;
+    if (rest > 0) {
+        uint32_t group = (static_cast<uint32_t>(p_src[i]) << 16) | (rest == 2 ? p_src[i + 1] << 8 : 0);
+        p_dst[o++] = p_alphabet[group >> 18];
+        p_dst[o++] = p_alphabet[(group >> 12) & 0x3F];
+        if (rest == 2)
+            p_dst[o++] = p_alphabet[(group >> 6) & 0x3F];
+        if (!url) {
+            if (rest == 1)
+                p_dst[o++] = '=';
+            p_dst[o++] = '=';
+        }
+    }
+    return o;
+}
+
+// Decodes either alphabet the way Node does: characters outside them (whitespace included) are
+// skipped, the first '=' ends the input and a lone trailing character is dropped. Char is
+// uint8_t for one-byte strings, which get the vector kernels, or uint16_t for two-byte ones.
+// Writes at most decodedCapacity(length) bytes and returns the decoded length.
+template <typename Char>
+inline size_t decode(const Char* p_src, size_t length, uint8_t* p_dst) {
+    size_t i = 0;
+    size_t o = 0;
+    uint32_t group = 0;
+    int32_t pending = 0;
+    while (i < length) {
+        if constexpr (sizeof(Char) == 1) {
+            size_t consumed = decodeBlocks(p_src + i, length - i, p_dst + o);
+            i += consumed;
+            o += consumed / 4 * 3;
+        }
+        // A block with whitespace, padding or junk in it: take at least 16 characters one at a
+        // time and finish the group they end in, so the kernels restart on a group boundary.
+        size_t stop = i + 16;
+        while (i < length && (i < stop || pending != 0)) {
+            uint32_t c = static_cast<uint32_t>(p_src[i++]);
+            uint8_t value = c < 256 ? DECODE_TABLE[c] : INVALID;
+            if (value != INVALID) {
+                group = (group << 6) | value;
+                if (++pending == 4) {
+                    p_dst[o++] = static_cast<uint8_t>(group >> 16);
+                    p_dst[o++] = static_cast<uint8_t>(group >> 8);
+                    p_dst[o++] = static_cast<uint8_t>(group);
+                    pending = 0;
+                }
+            } else if (c == '=') {
+                i = length;
+            }
+        }
+    }
+    if (pending == 2) {
+        p_dst[o++] = static_cast<uint8_t>(group >> 4);
+    } else if (pending == 3) {
+        p_dst[o++] = static_cast<uint8_t>(group >> 10);
+        p_dst[o++] = static_cast<uint8_t>(group >> 2);
+    }
+    return o;
+}
+
+} // namespace base64
+} // namespace z8
+
+#endif
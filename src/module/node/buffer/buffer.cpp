@@ -1,109 +1,688 @@
 #include "buffer.h"
+#include "base64.h"
+#include "buffer_allocator.h"
+#include "hex.h"
+#include "latin1.h"
+#include "search.h"
+#include "utf8.h"
+#include "v8-fast-api-calls.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
 #include <cstring>
+#include <memory>
+#include <type_traits>
 #include <vector>
 
 namespace z8 {
 namespace module {
 
-// Helper for Hex
-static int32_t hexValue(char c) {
-    if (c >= '0' && c <= '9') return c - '0';
-    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
-    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
-    return -1;
+// Buffer.prototype, captured once by initialize() so that making a Buffer never looks up
+// globalThis.Buffer by name (user code may also have replaced that global).
+static v8::Persistent<v8::Object> s_buffer_proto;
+
+// Gives a fresh Uint8Array the Buffer prototype. V8 caches the prototype transition on the
+// Uint8Array map, so every Buffer made here shares one hidden class.
+static v8::Local<v8::Uint8Array> asBuffer(v8::Isolate* p_isolate, v8::Local<v8::Context> context, v8::Local<v8::Uint8Array> ui) {
+    if (!s_buffer_proto.IsEmpty())
+        ui->SetPrototypeV2(context, s_buffer_proto.Get(p_isolate)).Check();
+    return ui;
 }
 
-static std::string bytesToHex(const uint8_t* p_data, size_t len) {
-    static const char hex_chars[] = "0123456789abcdef";
-    std::string res;
-    res.reserve(len * 2);
-    for (size_t i = 0; i < len; i++) {
-        res += hex_chars[p_data[i] >> 4];
-        res += hex_chars[p_data[i] & 0x0F];
-    }
-    return res;
-}
-
-// Helper for Base64 (Basic)
-static const std::string base64_chars = 
-             "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
-             "abcdefghijklmnopqrstuvwxyz"
-             "0123456789+/";
-
-static std::string bytesToBase64(const uint8_t* p_data, size_t len) {
-    std::string res;
-    int32_t i = 0;
-    int32_t j = 0;
-    uint8_t char_array_3[3];
-    uint8_t char_array_4[4];
-
-    while (len--) {
-        char_array_3[i++] = *(p_data++);
-        if (i == 3) {
-            char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
-            char_array_4[1] = ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
-            char_array_4[2] = ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
-            char_array_4[3] = char_array_3[2] & 0x3f;
-
-            for(i = 0; (i <4) ; i++)
-                res += base64_chars[char_array_4[i]];
-            i = 0;
-        }
+// Node-style shared pool. allocUnsafe() and native output smaller than half a slab are carved
+// out of one uninitialized slab of Buffer.poolSize bytes (8-byte aligned), so a small Buffer
+// costs a view instead of a backing store. poolSize is read whenever a new slab starts; a value
+// that is not a finite number up to MAX_POOL_SIZE is ignored in favour of the default.
+static constexpr size_t DEFAULT_POOL_SIZE = 8192;
+static constexpr size_t MAX_POOL_SIZE = 64 * 1024 * 1024;
+static v8::Persistent<v8::Function> s_buffer_fn;
+static v8::Persistent<v8::ArrayBuffer> s_pool;
+static uint8_t* s_p_pool_data = nullptr;
+static size_t s_pool_size = 0;
+static size_t s_pool_offset = 0;
+
+static void freeBackingStore(void* p_data, size_t length, void* p_deleter_data) {
+    z8::BufferAllocator::getInstance().Free(p_data, length);
+}
+
+// An ArrayBuffer of its own whose bytes are left uninitialized; p_data receives its start.
+static v8::Local<v8::ArrayBuffer> newUninitializedArrayBuffer(v8::Isolate* p_isolate, size_t length, uint8_t*& p_data) {
+    void* p_raw = z8::BufferAllocator::getInstance().AllocateUninitialized(length);
+    if (!p_raw) {
+        v8::Local<v8::ArrayBuffer> ab = v8::ArrayBuffer::New(p_isolate, length);
+        p_data = static_cast<uint8_t*>(ab->GetBackingStore()->Data());
+        return ab;
+    }
+    p_data = static_cast<uint8_t*>(p_raw);
+    std::unique_ptr<v8::BackingStore> up_store =
+        v8::ArrayBuffer::NewBackingStore(p_raw, length, freeBackingStore, nullptr);
+    return v8::ArrayBuffer::New(p_isolate, std::move(up_store));
+}
+
+static void createPool(v8::Isolate* p_isolate, v8::Local<v8::Context> context) {
+    double size = static_cast<double>(DEFAULT_POOL_SIZE);
+    v8::Local<v8::String> key = v8::String::NewFromUtf8Literal(p_isolate, "poolSize");
+    v8::Local<v8::Value> value;
+    if (!s_buffer_fn.IsEmpty() && s_buffer_fn.Get(p_isolate)->Get(context, key).ToLocal(&value) &&
+        value->IsNumber() && value.As<v8::Number>()->Value() >= 0 &&
+        value.As<v8::Number>()->Value() <= static_cast<double>(MAX_POOL_SIZE))
+        size = value.As<v8::Number>()->Value();
+    s_pool_size = static_cast<size_t>(size);
+    s_pool_offset = 0;
+    s_pool.Reset(p_isolate, newUninitializedArrayBuffer(p_isolate, s_pool_size, s_p_pool_data));
+}
+
+// Room for up to capacity uninitialized bytes at p_data, inside the pool when small. For output
+// whose final length is only known once written: commitUnsafeBuffer() then takes just what was
+// used, and nothing may touch the pool in between.
+static v8::Local<v8::ArrayBuffer> reserveUnsafeBuffer(v8::Isolate* p_isolate,
+                                                      size_t capacity,
+                                                      size_t& offset,
+                                                      uint8_t*& p_data) {
+    v8::Local<v8::Context> context = p_isolate->GetCurrentContext();
+    // A pool that was transferred or detached no longer owns s_p_pool_data.
+    if (s_pool.IsEmpty() || s_pool.Get(p_isolate)->WasDetached())
+        createPool(p_isolate, context);
+    offset = 0;
+    if (capacity == 0 || capacity >= (s_pool_size >> 1))
+        return newUninitializedArrayBuffer(p_isolate, capacity, p_data);
+    if (s_pool_size - s_pool_offset < capacity)
+        createPool(p_isolate, context);
+    offset = s_pool_offset;
+    p_data = s_p_pool_data + s_pool_offset;
+    return s_pool.Get(p_isolate);
+}
+
+static v8::Local<v8::Uint8Array> commitUnsafeBuffer(v8::Isolate* p_isolate,
+                                                    v8::Local<v8::ArrayBuffer> ab,
+                                                    size_t offset,
+                                                    size_t length) {
+    if (ab == s_pool.Get(p_isolate))
+        s_pool_offset = std::min(s_pool_size, (offset + length + 7) & ~static_cast<size_t>(7));
+    return asBuffer(p_isolate, p_isolate->GetCurrentContext(), v8::Uint8Array::New(ab, offset, length));
+}
+
+// An uninitialized Buffer of length bytes, pooled when small; p_data receives its first byte.
+static v8::Local<v8::Uint8Array> newUnsafeBuffer(v8::Isolate* p_isolate, size_t length, uint8_t*& p_data) {
+    size_t offset = 0;
+    v8::Local<v8::ArrayBuffer> ab = reserveUnsafeBuffer(p_isolate, length, offset, p_data);
+    return commitUnsafeBuffer(p_isolate, ab, offset, length);
+}
+
+// Owns the characters of a large string (from std::malloc) so that V8 uses them in place.
+template <typename Resource, typename Char>
+class ExternalString : public Resource {
+  public:
+    ExternalString(Char* p_chars, size_t length) : p_chars(p_chars), m_length(length) {}
+    ~ExternalString() override {
+        std::free(p_chars);
+    }
+
+    const Char* data() const override {
+        return p_chars;
+    }
+
+    size_t length() const override {
+        return m_length;
+    }
+
+  private:
+    Char* p_chars;
+    size_t m_length;
+};
+
+using ExternalOneByteString = ExternalString<v8::String::ExternalOneByteStringResource, char>;
+using ExternalTwoByteString = ExternalString<v8::String::ExternalStringResource, uint16_t>;
+
+// Strings at least this many bytes long are handed to V8 as external strings instead of being
+// copied into the heap.
+static constexpr size_t EXTERNAL_STRING_MIN = 64 * 1024;
+
+// Takes ownership of length Latin-1 characters at p_chars (from std::malloc). Empty when the
+// result would exceed v8::String::kMaxLength; throwStringTooLong() reports that.
+static v8::MaybeLocal<v8::String> adoptOneByteString(v8::Isolate* p_isolate, char* p_chars, size_t length) {
+    if (length > static_cast<size_t>(v8::String::kMaxLength)) {
+        std::free(p_chars);
+        return {};
+    }
+    if (length < EXTERNAL_STRING_MIN) {
+        v8::MaybeLocal<v8::String> str = v8::String::NewFromOneByte(p_isolate,
+                                                                    reinterpret_cast<const uint8_t*>(p_chars),
+                                                                    v8::NewStringType::kNormal,
+                                                                    static_cast<int32_t>(length));
+        std::free(p_chars);
+        return str;
+    }
+    return v8::String::NewExternalOneByte(p_isolate, new ExternalOneByteString(p_chars, length));
+}
+
+// Latin-1 string of the length bytes at p_data. Small strings are copied by V8 straight from
+// the Buffer; large ones get one copy that becomes their external storage.
+static v8::MaybeLocal<v8::String> newOneByteString(v8::Isolate* p_isolate, const uint8_t* p_data, size_t length) {
+    if (length > static_cast<size_t>(v8::String::kMaxLength))
+        return {};
+    if (length < EXTERNAL_STRING_MIN)
+        return v8::String::NewFromOneByte(p_isolate, p_data, v8::NewStringType::kNormal, static_cast<int32_t>(length));
+    char* p_chars = static_cast<char*>(std::malloc(length));
+    if (!p_chars)
+        return {};
+    std::memcpy(p_chars, p_data, length);
+    return adoptOneByteString(p_isolate, p_chars, length);
+}
+
+// String of the units UTF-16LE code units at p_data, which need not be aligned. V8 stores it as
+// one-byte when every unit fits.
+static v8::MaybeLocal<v8::String> newTwoByteString(v8::Isolate* p_isolate, const uint8_t* p_data, size_t units) {
+    if (units > static_cast<size_t>(v8::String::kMaxLength))
+        return {};
+    bool aligned = reinterpret_cast<uintptr_t>(p_data) % alignof(uint16_t) == 0;
+    if (aligned && units * 2 < EXTERNAL_STRING_MIN) {
+        return v8::String::NewFromTwoByte(p_isolate,
+                                          reinterpret_cast<const uint16_t*>(p_data),
+                                          v8::NewStringType::kNormal,
+                                          static_cast<int32_t>(units));
+    }
+    uint16_t* p_units = static_cast<uint16_t*>(std::malloc(units ? units * 2 : 1));
+    if (!p_units)
+        return {};
+    std::memcpy(p_units, p_data, units * 2);
+    if (units * 2 < EXTERNAL_STRING_MIN) {
+        v8::MaybeLocal<v8::String> str =
+            v8::String::NewFromTwoByte(p_isolate, p_units, v8::NewStringType::kNormal, static_cast<int32_t>(units));
+        std::free(p_units);
+        return str;
+    }
+    return v8::String::NewExternalTwoByte(p_isolate, new ExternalTwoByteString(p_units, units));
+}
+
+v8::Local<v8::Value> Buffer::stringTooLongError(v8::Isolate* p_isolate) {
+    v8::Local<v8::Object> error =
+        v8::Exception::Error(
+            v8::String::NewFromUtf8Literal(p_isolate, "Cannot create a string longer than 0x1fffffe8 characters"))
+            .As<v8::Object>();
+    (void) error->Set(p_isolate->GetCurrentContext(),
+                      v8::String::NewFromUtf8Literal(p_isolate, "code"),
+                      v8::String::NewFromUtf8Literal(p_isolate, "ERR_STRING_TOO_LONG"));
+    return error;
+}
+
+static void throwStringTooLong(v8::Isolate* p_isolate) {
+    p_isolate->ThrowException(Buffer::stringTooLongError(p_isolate));
+}
+
+// base64/base64url text of length bytes. Large results keep the encoder's output as their storage.
+static v8::MaybeLocal<v8::String> encodeBase64(v8::Isolate* p_isolate, const uint8_t* p_data, size_t length, bool url) {
+    size_t size = base64::encodedLength(length, url);
+    char* p_chars = static_cast<char*>(std::malloc(size ? size : 1));
+    if (!p_chars)
+        return {};
+    base64::encode(p_data, length, p_chars, url);
+    return adoptOneByteString(p_isolate, p_chars, size);
+}
+
+// Lowercase hex text of length bytes.
+static v8::MaybeLocal<v8::String> encodeHex(v8::Isolate* p_isolate, const uint8_t* p_data, size_t length) {
+    char* p_chars = static_cast<char*>(std::malloc(length ? length * 2 : 1));
+    if (!p_chars)
+        return {};
+    hex::encode(p_data, length, p_chars);
+    return adoptOneByteString(p_isolate, p_chars, length * 2);
+}
+
+// Buffer#toString('ascii'): Latin-1 with the high bit of every byte cleared, as in Node.
+static v8::MaybeLocal<v8::String> encodeAscii(v8::Isolate* p_isolate, const uint8_t* p_data, size_t length) {
+    char* p_chars = static_cast<char*>(std::malloc(length ? length : 1));
+    if (!p_chars)
+        return {};
+    latin1::stripHighBit(p_data, length, p_chars);
+    return adoptOneByteString(p_isolate, p_chars, length);
+}
+
+// --- String writers ---
+// Each decodes str straight from V8's flat one-byte or two-byte contents (no UTF-8 copy) into
+// at most max_length bytes at p_dst and returns how many it wrote. No V8 allocation may happen
+// while a ValueView is alive.
+using StringWriter = size_t (*)(v8::Isolate* p_isolate, v8::Local<v8::String> str, uint8_t* p_dst, size_t max_length);
+
+static size_t writeBase64(v8::Isolate* p_isolate, v8::Local<v8::String> str, uint8_t* p_dst, size_t max_length) {
+    v8::String::ValueView view(p_isolate, str);
+    size_t chars = static_cast<size_t>(view.length());
+    size_t capacity = base64::decodedCapacity(chars);
+    std::vector<uint8_t> scratch;
+    uint8_t* p_out = p_dst;
+    if (capacity > max_length) {
+        scratch.resize(capacity);
+        p_out = scratch.data();
+    }
+    size_t length = view.is_one_byte() ? base64::decode(view.data8(), chars, p_out)
+                                       : base64::decode(view.data16(), chars, p_out);
+    length = std::min(length, max_length);
+    if (p_out != p_dst)
+        std::memcpy(p_dst, p_out, length);
+    return length;
+}
+
+static size_t writeHex(v8::Isolate* p_isolate, v8::Local<v8::String> str, uint8_t* p_dst, size_t max_length) {
+    v8::String::ValueView view(p_isolate, str);
+    size_t pairs = std::min(static_cast<size_t>(view.length()) / 2, max_length);
+    return view.is_one_byte() ? hex::decode(view.data8(), pairs, p_dst) : hex::decode(view.data16(), pairs, p_dst);
+}
+
+// latin1, binary and ascii: one byte per character, the low byte for anything past U+00FF.
+static size_t writeLatin1(v8::Isolate* p_isolate, v8::Local<v8::String> str, uint8_t* p_dst, size_t max_length) {
+    v8::String::ValueView view(p_isolate, str);
+    size_t length = std::min(static_cast<size_t>(view.length()), max_length);
+    if (view.is_one_byte())
+        std::memcpy(p_dst, view.data8(), length);
+    else
+        latin1::narrow(view.data16(), length, p_dst);
+    return length;
+}
+
+// ucs2/utf16le: two bytes per code unit, whole units only.
+static size_t writeUtf16(v8::Isolate* p_isolate, v8::Local<v8::String> str, uint8_t* p_dst, size_t max_length) {
+    v8::String::ValueView view(p_isolate, str);
+    size_t units = std::min(static_cast<size_t>(view.length()), max_length / 2);
+    if (view.is_one_byte())
+        latin1::widen(view.data8(), units, p_dst);
+    else
+        std::memcpy(p_dst, view.data16(), units * 2);
+    return units * 2;
+}
+
+static bool isUtf16Encoding(const std::string& encoding) {
+    return encoding == "ucs2" || encoding == "ucs-2" || encoding == "utf16le" || encoding == "utf-16le";
+}
+
+static bool isLatin1Encoding(const std::string& encoding) {
+    return encoding == "latin1" || encoding == "binary" || encoding == "ascii";
+}
+
+// The writer for encoding; UTF-8 for anything unrecognised.
+static StringWriter stringWriter(const std::string& encoding) {
+    if (encoding == "base64" || encoding == "base64url")
+        return &writeBase64;
+    if (encoding == "hex")
+        return &writeHex;
+    if (isLatin1Encoding(encoding))
+        return &writeLatin1;
+    if (isUtf16Encoding(encoding))
+        return &writeUtf16;
+    return &Buffer::writeUtf8;
+}
+
+// The most bytes str can produce in encoding. Exact for UTF-8, which costs a pass over str.
+static size_t stringCapacity(v8::Isolate* p_isolate, const std::string& encoding, v8::Local<v8::String> str) {
+    size_t chars = static_cast<size_t>(str->Length());
+    if (encoding == "base64" || encoding == "base64url")
+        return base64::decodedCapacity(chars);
+    if (encoding == "hex")
+        return chars / 2;
+    if (isLatin1Encoding(encoding))
+        return chars;
+    if (isUtf16Encoding(encoding))
+        return chars * 2;
+    return Buffer::utf8Length(p_isolate, str);
+}
+
+// A Buffer holding str as written by p_write, trimmed to what it produced.
+static v8::Local<v8::Uint8Array> decodeString(v8::Isolate* p_isolate,
+                                              v8::Local<v8::String> str,
+                                              StringWriter p_write,
+                                              size_t capacity) {
+    size_t offset = 0;
+    uint8_t* p_data = nullptr;
+    v8::Local<v8::ArrayBuffer> ab = reserveUnsafeBuffer(p_isolate, capacity, offset, p_data);
+    size_t length = p_write(p_isolate, str, p_data, capacity);
+    return commitUnsafeBuffer(p_isolate, ab, offset, length);
+}
+
+// Buffer#fill() and Buffer.alloc() with a string: length bytes at p_target repeat str in
+// encoding, or are zeroed when it encodes to nothing. The pattern is written once, in place
+// when it fits, and then doubled.
+static void fillString(v8::Isolate* p_isolate,
+                       v8::Local<v8::String> str,
+                       const std::string& encoding,
+                       uint8_t* p_target,
+                       size_t length) {
+    StringWriter p_write = stringWriter(encoding);
+    size_t capacity = stringCapacity(p_isolate, encoding, str);
+    size_t filled = 0;
+    if (capacity <= length) {
+        filled = p_write(p_isolate, str, p_target, capacity);
+    } else {
+        std::vector<uint8_t> scratch(capacity);
+        filled = std::min(p_write(p_isolate, str, scratch.data(), capacity), length);
+        std::memcpy(p_target, scratch.data(), filled);
     }
-
-    if (i) {
-        for(j = i; j < 3; j++) char_array_3[j] = '\0';
-        char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
-        char_array_4[1] = ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
-        char_array_4[2] = ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
-        char_array_4[3] = char_array_3[2] & 0x3f;
-        for (j = 0; (j < i + 1); j++) res += base64_chars[char_array_4[j]];
-        while((i++ < 3)) res += '=';
+    if (filled == 0) {
+        std::memset(p_target, 0, length);
+        return;
     }
-    return res;
+    for (; filled < length; filled *= 2)
+        std::memcpy(p_target + filled, p_target, std::min(filled, length - filled));
+}
+
+size_t Buffer::utf8Length(v8::Isolate* p_isolate, v8::Local<v8::String> str) {
+    {
+        v8::String::ValueView view(p_isolate, str);
+        if (view.is_one_byte())
+            return utf8::latin1Length(view.data8(), static_cast<size_t>(view.length()));
+    }
+    return str->Utf8LengthV2(p_isolate);
+}
+
+size_t Buffer::writeUtf8(v8::Isolate* p_isolate, v8::Local<v8::String> str, uint8_t* p_dst, size_t max_length) {
+    {
+        v8::String::ValueView view(p_isolate, str);
+        if (view.is_one_byte())
+            return utf8::fromLatin1(view.data8(), static_cast<size_t>(view.length()), p_dst, max_length);
+    }
+    return str->WriteUtf8V2(p_isolate,
+                            reinterpret_cast<char*>(p_dst),
+                            max_length,
+                            v8::String::WriteFlags::kReplaceInvalidUtf8);
+}
+
+size_t Buffer::writeUtf8(v8::Isolate* p_isolate,
+                         v8::Local<v8::String> str,
+                         uint8_t* p_dst,
+                         size_t max_length,
+                         size_t& read) {
+    {
+        v8::String::ValueView view(p_isolate, str);
+        if (view.is_one_byte())
+            return utf8::fromLatin1(view.data8(), static_cast<size_t>(view.length()), p_dst, max_length, read);
+    }
+    return str->WriteUtf8V2(p_isolate,
+                            reinterpret_cast<char*>(p_dst),
+                            max_length,
+                            v8::String::WriteFlags::kReplaceInvalidUtf8,
+                            &read);
+}
+
+void Buffer::toUtf8(v8::Isolate* p_isolate, v8::Local<v8::String> str, std::string& out) {
+    out.resize(utf8Length(p_isolate, str));
+    out.resize(writeUtf8(p_isolate, str, reinterpret_cast<uint8_t*>(out.data()), out.size()));
+}
+
+void Buffer::encodeString(v8::Isolate* p_isolate,
+                          v8::Local<v8::String> str,
+                          const std::string& encoding,
+                          std::string& out) {
+    out.resize(stringCapacity(p_isolate, encoding, str));
+    out.resize(stringWriter(encoding)(p_isolate, str, reinterpret_cast<uint8_t*>(out.data()), out.size()));
+}
+
+v8::MaybeLocal<v8::String> Buffer::decodeUtf8(v8::Isolate* p_isolate, const void* p_data, size_t length) {
+    const uint8_t* p_bytes = static_cast<const uint8_t*>(p_data);
+    size_t ascii = utf8::asciiPrefix(p_bytes, length);
+    if (ascii == length)
+        return newOneByteString(p_isolate, p_bytes, length);
+    if (length > static_cast<size_t>(v8::String::kMaxLength))
+        return {};
+    // Large valid text within Latin-1 (accented Western European text) is decoded here and kept
+    // as an external one-byte string; anything else, and every invalid sequence, is V8's to decode.
+    if (length >= EXTERNAL_STRING_MIN && utf8::validate(p_bytes + ascii, length - ascii)) {
+        char* p_chars = static_cast<char*>(std::malloc(length));
+        size_t written = 0;
+        if (p_chars && utf8::toLatin1(p_bytes, length, reinterpret_cast<uint8_t*>(p_chars), written))
+            return adoptOneByteString(p_isolate, p_chars, written);
+        std::free(p_chars);
+    }
+    return v8::String::NewFromUtf8(p_isolate,
+                                   reinterpret_cast<const char*>(p_bytes),
+                                   v8::NewStringType::kNormal,
+                                   static_cast<int32_t>(length));
+}
+
+v8::MaybeLocal<v8::String> Buffer::decodeLatin1(v8::Isolate* p_isolate, const void* p_data, size_t length) {
+    return newOneByteString(p_isolate, static_cast<const uint8_t*>(p_data), length);
+}
+
+v8::MaybeLocal<v8::String> Buffer::decodeUtf16(v8::Isolate* p_isolate, const void* p_data, size_t units) {
+    return newTwoByteString(p_isolate, static_cast<const uint8_t*>(p_data), units);
+}
+
+v8::MaybeLocal<v8::String> Buffer::decodeBytes(v8::Isolate* p_isolate,
+                                               const std::string& encoding,
+                                               const void* p_data,
+                                               size_t length) {
+    const uint8_t* p_bytes = static_cast<const uint8_t*>(p_data);
+    if (encoding == "hex")
+        return encodeHex(p_isolate, p_bytes, length);
+    if (encoding == "base64" || encoding == "base64url")
+        return encodeBase64(p_isolate, p_bytes, length, encoding == "base64url");
+    if (encoding == "latin1" || encoding == "binary")
+        return newOneByteString(p_isolate, p_bytes, length);
+    if (encoding == "ascii")
+        return encodeAscii(p_isolate, p_bytes, length);
+    if (isUtf16Encoding(encoding))
+        return newTwoByteString(p_isolate, p_bytes, length / 2);
+    return decodeUtf8(p_isolate, p_bytes, length);
+}
+
+// ---- V8 Fast API ----
+// Once a call site is hot, TurboFan calls these directly (--turbo-fast-api-calls) instead of
+// the FunctionCallbackInfo callback, so a read returns a plain number and a write or compare
+// allocates nothing. They cover the common shapes only: a numeric offset, Buffer arguments.
+// Other argument counts, and every call before the site is optimized, take the callback,
+// whose semantics (and RangeError/TypeError) these mirror. Errors are thrown on the isolate
+// the fast call hands over.
+struct FastView {
+    uint8_t* p_data;
+    size_t m_length;
+};
+
+static bool fastView(v8::Local<v8::Value> value, FastView& view) {
+    if (!value->IsUint8Array())
+        return false;
+    v8::Local<v8::Uint8Array> array = value.As<v8::Uint8Array>();
+    view.p_data = static_cast<uint8_t*>(array->Buffer()->Data()) + array->ByteOffset();
+    view.m_length = array->ByteLength();
+    return true;
 }
 
-static std::vector<uint8_t> base64ToBytes(std::string str) {
-    // Handle base64url
-    for (char& c : str) {
-        if (c == '-') c = '+';
-        else if (c == '_') c = '/';
-    }
-    // Remove padding if needed (basic version)
-    // Note: The original code does not explicitly remove padding,
-    // but the loop condition `(str[in_] != '=')` handles it implicitly.
-
-    int32_t in_len = static_cast<int32_t>(str.size());
-    int32_t i = 0;
-    int32_t j = 0;
-    int32_t in_ = 0;
-    uint8_t char_array_4[4], char_array_3[3];
-    std::vector<uint8_t> ret;
-
-    while (in_len-- && ( str[in_] != '=') && (isalnum(str[in_]) || (str[in_] == '+') || (str[in_] == '/'))) {
-        char_array_4[i++] = str[in_]; in_++;
-        if (i == 4) {
-            for (i = 0; i <4; i++)
-                char_array_4[i] = static_cast<uint8_t>(base64_chars.find(char_array_4[i]));
-
-            char_array_3[0] = (char_array_4[0] << 2) + ((char_array_4[1] & 0x30) >> 4);
-            char_array_3[1] = ((char_array_4[1] & 0xf) << 4) + ((char_array_4[2] & 0x3c) >> 2);
-            char_array_3[2] = ((char_array_4[2] & 0x3) << 6) + char_array_4[3];
+static void throwFast(v8::FastApiCallbackOptions& options, bool range_error, const char* p_message) {
+    v8::Isolate* p_isolate = options.isolate;
+    v8::Local<v8::String> message = v8::String::NewFromUtf8(p_isolate, p_message).ToLocalChecked();
+    p_isolate->ThrowException(range_error ? v8::Exception::RangeError(message) : v8::Exception::TypeError(message));
+}
+
+// The callbacks' offset handling: IntegerValue() truncates toward zero and maps NaN to 0, and
+// the access must end within the view.
+static bool fastOffset(double offset, size_t size, size_t length, size_t& off) {
+    offset = std::isnan(offset) ? 0 : std::trunc(offset);
+    if (offset < 0 || offset > static_cast<double>(length))
+        return false;
+    off = static_cast<size_t>(offset);
+    return size <= length - off;
+}
+
+// ToUint32(): Uint32Value()/Int32Value() of the value to write, of which the integer writes
+// keep the low bytes.
+static uint32_t toUint32(double value) {
+    if (value >= 0 && value < 4294967296.0)
+        return static_cast<uint32_t>(value);
+    if (value >= -2147483648.0 && value < 0)
+        return static_cast<uint32_t>(static_cast<int32_t>(value));
+    if (!std::isfinite(value))
+        return 0;
+    double wrapped = std::fmod(std::trunc(value), 4294967296.0);
+    return static_cast<uint32_t>(wrapped < 0 ? wrapped + 4294967296.0 : wrapped);
+}
+
+template<typename T, bool BigEndian>
+static T loadBytes(const uint8_t* p_src) {
+    uint8_t bytes[sizeof(T)];
+    memcpy(bytes, p_src, sizeof(T));
+    if constexpr (BigEndian)
+        std::reverse(bytes, bytes + sizeof(T));
+    T value;
+    memcpy(&value, bytes, sizeof(T));
+    return value;
+}
+
+template<typename T, bool BigEndian>
+static void storeBytes(T value, uint8_t* p_dst) {
+    uint8_t bytes[sizeof(T)];
+    memcpy(bytes, &value, sizeof(T));
+    if constexpr (BigEndian)
+        std::reverse(bytes, bytes + sizeof(T));
+    memcpy(p_dst, bytes, sizeof(T));
+}
+
+// buf.read*(offset). R is what the callback returns: uint32/int32 for integers, double otherwise.
+template<typename T, bool BigEndian, typename R>
+static R fastRead(v8::Local<v8::Value> receiver, double offset, v8::FastApiCallbackOptions& options) {
+    v8::HandleScope scope(options.isolate);
+    FastView self;
+    size_t off = 0;
+    if (!fastView(receiver, self) || !fastOffset(offset, sizeof(T), self.m_length, off)) {
+        throwFast(options, true, "Attempt to access memory outside buffer bounds");
+        return 0;
+    }
+    return static_cast<R>(loadBytes<T, BigEndian>(self.p_data + off));
+}
+
+// buf.write*(value, offset), returning the offset past the bytes written.
+template<typename T, bool BigEndian>
+static uint32_t fastWrite(v8::Local<v8::Value> receiver,
+                          double value,
+                          double offset,
+                          v8::FastApiCallbackOptions& options) {
+    v8::HandleScope scope(options.isolate);
+    FastView self;
+    size_t off = 0;
+    if (!fastView(receiver, self) || !fastOffset(offset, sizeof(T), self.m_length, off)) {
+        throwFast(options, true, "Attempt to access memory outside buffer bounds");
+        return 0;
+    }
+    if constexpr (std::is_integral_v<T>)
+        storeBytes<T, BigEndian>(static_cast<T>(toUint32(value)), self.p_data + off);
+    else
+        storeBytes<T, BigEndian>(static_cast<T>(value), self.p_data + off);
+    return static_cast<uint32_t>(off + sizeof(T));
+}
+
+static int32_t compareViews(const FastView& a, const FastView& b) {
+    size_t len = std::min(a.m_length, b.m_length);
+    int32_t cmp = len > 0 ? memcmp(a.p_data, b.p_data, len) : 0;
+    if (cmp != 0)
+        return cmp < 0 ? -1 : 1;
+    return a.m_length < b.m_length ? -1 : (a.m_length > b.m_length ? 1 : 0);
+}
+
+static bool fastEquals(v8::Local<v8::Value> receiver,
+                       v8::Local<v8::Value> other,
+                       v8::FastApiCallbackOptions& options) {
+    v8::HandleScope scope(options.isolate);
+    FastView self, view;
+    if (!fastView(receiver, self) || !fastView(other, view)) {
+        throwFast(options, false, "Argument must be a Buffer or Uint8Array");
+        return false;
+    }
+    if (self.m_length != view.m_length)
+        return false;
+    return self.m_length == 0 || memcmp(self.p_data, view.p_data, self.m_length) == 0;
+}
+
+// buf.compare(target) with the default ranges.
+static int32_t fastCompareInstance(v8::Local<v8::Value> receiver,
+                                   v8::Local<v8::Value> target,
+                                   v8::FastApiCallbackOptions& options) {
+    v8::HandleScope scope(options.isolate);
+    FastView self, view;
+    if (!fastView(receiver, self) || !fastView(target, view)) {
+        throwFast(options, false, "Argument must be a Buffer or Uint8Array");
+        return 0;
+    }
+    return compareViews(self, view);
+}
+
+// Buffer.compare(a, b).
+static int32_t fastCompare(v8::Local<v8::Value> receiver,
+                           v8::Local<v8::Value> a,
+                           v8::Local<v8::Value> b,
+                           v8::FastApiCallbackOptions& options) {
+    v8::HandleScope scope(options.isolate);
+    FastView first, second;
+    if (!fastView(a, first) || !fastView(b, second)) {
+        throwFast(options, false, "Arguments must be Buffers or Uint8Arrays");
+        return 0;
+    }
+    return compareViews(first, second);
+}
+
+// Buffer.byteLength(value) with the default utf8 encoding.
+static double fastByteLength(v8::Local<v8::Value> receiver,
+                             v8::Local<v8::Value> value,
+                             v8::FastApiCallbackOptions& options) {
+    v8::HandleScope scope(options.isolate);
+    if (value->IsString())
+        return static_cast<double>(Buffer::utf8Length(options.isolate, value.As<v8::String>()));
+    if (value->IsArrayBuffer())
+        return static_cast<double>(value.As<v8::ArrayBuffer>()->ByteLength());
+    if (value->IsArrayBufferView())
+        return static_cast<double>(value.As<v8::ArrayBufferView>()->ByteLength());
+    return 0;
+}
 
-            for (i = 0; (i < 3); i++) ret.push_back(char_array_3[i]);
-            i = 0;
+struct FastBinding {
+    v8::FunctionCallback m_callback;
+    v8::CFunction m_fast;
+};
+
+static const FastBinding FAST_BINDINGS[] = {
+    {Buffer::readUInt8, v8::CFunction::Make(fastRead<uint8_t, false, uint32_t>)},
+    {Buffer::readInt8, v8::CFunction::Make(fastRead<int8_t, false, int32_t>)},
+    {Buffer::readUInt16BE, v8::CFunction::Make(fastRead<uint16_t, true, uint32_t>)},
+    {Buffer::readUInt16LE, v8::CFunction::Make(fastRead<uint16_t, false, uint32_t>)},
+    {Buffer::readInt16BE, v8::CFunction::Make(fastRead<int16_t, true, int32_t>)},
+    {Buffer::readInt16LE, v8::CFunction::Make(fastRead<int16_t, false, int32_t>)},
+    {Buffer::readUInt32BE, v8::CFunction::Make(fastRead<uint32_t, true, uint32_t>)},
+    {Buffer::readUInt32LE, v8::CFunction::Make(fastRead<uint32_t, false, uint32_t>)},
+    {Buffer::readInt32BE, v8::CFunction::Make(fastRead<int32_t, true, int32_t>)},
+    {Buffer::readInt32LE, v8::CFunction::Make(fastRead<int32_t, false, int32_t>)},
+    {Buffer::readFloatBE, v8::CFunction::Make(fastRead<float, true, double>)},
+    {Buffer::readFloatLE, v8::CFunction::Make(fastRead<float, false, double>)},
+    {Buffer::readDoubleBE, v8::CFunction::Make(fastRead<double, true, double>)},
+    {Buffer::readDoubleLE, v8::CFunction::Make(fastRead<double, false, double>)},
+    {Buffer::writeUInt8, v8::CFunction::Make(fastWrite<uint8_t, false>)},
+    {Buffer::writeInt8, v8::CFunction::Make(fastWrite<int8_t, false>)},
+    {Buffer::writeUInt16BE, v8::CFunction::Make(fastWrite<uint16_t, true>)},
+    {Buffer::writeUInt16LE, v8::CFunction::Make(fastWrite<uint16_t, false>)},
+    {Buffer::writeInt16BE, v8::CFunction::Make(fastWrite<int16_t, true>)},
+    {Buffer::writeInt16LE, v8::CFunction::Make(fastWrite<int16_t, false>)},
+    {Buffer::writeUInt32BE, v8::CFunction::Make(fastWrite<uint32_t, true>)},
+    {Buffer::writeUInt32LE, v8::CFunction::Make(fastWrite<uint32_t, false>)},
+    {Buffer::writeInt32BE, v8::CFunction::Make(fastWrite<int32_t, true>)},
+    {Buffer::writeInt32LE, v8::CFunction::Make(fastWrite<int32_t, false>)},
+    {Buffer::writeFloatBE, v8::CFunction::Make(fastWrite<float, true>)},
+    {Buffer::writeFloatLE, v8::CFunction::Make(fastWrite<float, false>)},
+    {Buffer::writeDoubleBE, v8::CFunction::Make(fastWrite<double, true>)},
+    {Buffer::writeDoubleLE, v8::CFunction::Make(fastWrite<double, false>)},
+    {Buffer::equals, v8::CFunction::Make(fastEquals)},
+    {Buffer::compare_instance, v8::CFunction::Make(fastCompareInstance)},
+    {Buffer::compare, v8::CFunction::Make(fastCompare)},
+    {Buffer::byteLength, v8::CFunction::Make(fastByteLength)},
+};
+
+// The template for a method with a fast path in FAST_BINDINGS; callback is always the fallback.
+static v8::Local<v8::FunctionTemplate> fastMethod(v8::Isolate* p_isolate, v8::FunctionCallback callback) {
+    for (const FastBinding& binding : FAST_BINDINGS) {
+        if (binding.m_callback == callback) {
+            return v8::FunctionTemplate::New(p_isolate,
+                                             callback,
+                                             v8::Local<v8::Value>(),
+                                             v8::Local<v8::Signature>(),
+                                             0,
+                                             v8::ConstructorBehavior::kThrow,
+                                             v8::SideEffectType::kHasSideEffect,
+                                             &binding.m_fast);
         }
     }
-
-    if (i) {
-        for (j = i; j <4; j++) char_array_4[j] = 0;
-        for (j = 0; j <4; j++) char_array_4[j] = (uint8_t)base64_chars.find(char_array_4[j]);
-        char_array_3[0] = (char_array_4[0] << 2) + ((char_array_4[1] & 0x30) >> 4);
-        char_array_3[1] = ((char_array_4[1] & 0xf) << 4) + ((char_array_4[2] & 0x3c) >> 2);
-        char_array_3[2] = ((char_array_4[2] & 0x3) << 6) + char_array_4[3];
-        for (j = 0; (j < i - 1); j++) ret.push_back(char_array_3[j]);
-    }
-    return ret;
+    return v8::FunctionTemplate::New(p_isolate, callback);
 }
 
 v8::Local<v8::FunctionTemplate> Buffer::createTemplate(v8::Isolate* p_isolate) {
@@ -119,8 +698,8 @@ v8::Local<v8::FunctionTemplate> Buffer::createTemplate(v8::Isolate* p_isolate) {
     tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "concat"), v8::FunctionTemplate::New(p_isolate, concat));
     tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "isBuffer"), v8::FunctionTemplate::New(p_isolate, isBuffer));
     tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "isEncoding"), v8::FunctionTemplate::New(p_isolate, isEncoding));
-    tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "byteLength"), v8::FunctionTemplate::New(p_isolate, byteLength));
-    tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "compare"), v8::FunctionTemplate::New(p_isolate, compare));
+    tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "byteLength"), fastMethod(p_isolate, byteLength));
+    tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "compare"), fastMethod(p_isolate, compare));
     tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "atob"), v8::FunctionTemplate::New(p_isolate, atob));
     tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "btoa"), v8::FunctionTemplate::New(p_isolate, btoa));
     tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "isAscii"), v8::FunctionTemplate::New(p_isolate, isAscii));
@@ -135,8 +714,8 @@ v8::Local<v8::FunctionTemplate> Buffer::createTemplate(v8::Isolate* p_isolate) {
     proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "copy"), v8::FunctionTemplate::New(p_isolate, copy));
     proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "slice"), v8::FunctionTemplate::New(p_isolate, slice));
     proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "subarray"), v8::FunctionTemplate::New(p_isolate, subarray));
-    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "equals"), v8::FunctionTemplate::New(p_isolate, equals));
-    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "compare"), v8::FunctionTemplate::New(p_isolate, compare_instance));
+    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "equals"), fastMethod(p_isolate, equals));
+    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "compare"), fastMethod(p_isolate, compare_instance));
     proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "indexOf"), v8::FunctionTemplate::New(p_isolate, indexOf));
     proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "lastIndexOf"), v8::FunctionTemplate::New(p_isolate, lastIndexOf));
     proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "includes"), v8::FunctionTemplate::New(p_isolate, includes));
@@ -145,20 +724,20 @@ v8::Local<v8::FunctionTemplate> Buffer::createTemplate(v8::Isolate* p_isolate) {
     proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "swap32"), v8::FunctionTemplate::New(p_isolate, swap32));
     proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "swap64"), v8::FunctionTemplate::New(p_isolate, swap64));
     // Read numeric
-    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "readUInt8"), v8::FunctionTemplate::New(p_isolate, readUInt8));
-    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "readInt8"), v8::FunctionTemplate::New(p_isolate, readInt8));
-    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "readUInt16BE"), v8::FunctionTemplate::New(p_isolate, readUInt16BE));
-    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "readUInt16LE"), v8::FunctionTemplate::New(p_isolate, readUInt16LE));
-    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "readInt16BE"), v8::FunctionTemplate::New(p_isolate, readInt16BE));
-    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "readInt16LE"), v8::FunctionTemplate::New(p_isolate, readInt16LE));
-    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "readUInt32BE"), v8::FunctionTemplate::New(p_isolate, readUInt32BE));
-    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "readUInt32LE"), v8::FunctionTemplate::New(p_isolate, readUInt32LE));
-    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "readInt32BE"), v8::FunctionTemplate::New(p_isolate, readInt32BE));
-    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "readInt32LE"), v8::FunctionTemplate::New(p_isolate, readInt32LE));
-    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "readFloatBE"), v8::FunctionTemplate::New(p_isolate, readFloatBE));
-    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "readFloatLE"), v8::FunctionTemplate::New(p_isolate, readFloatLE));
-    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "readDoubleBE"), v8::FunctionTemplate::New(p_isolate, readDoubleBE));
-    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "readDoubleLE"), v8::FunctionTemplate::New(p_isolate, readDoubleLE));
+    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "readUInt8"), fastMethod(p_isolate, readUInt8));
+    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "readInt8"), fastMethod(p_isolate, readInt8));
+    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "readUInt16BE"), fastMethod(p_isolate, readUInt16BE));
+    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "readUInt16LE"), fastMethod(p_isolate, readUInt16LE));
+    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "readInt16BE"), fastMethod(p_isolate, readInt16BE));
+    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "readInt16LE"), fastMethod(p_isolate, readInt16LE));
+    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "readUInt32BE"), fastMethod(p_isolate, readUInt32BE));
+    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "readUInt32LE"), fastMethod(p_isolate, readUInt32LE));
+    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "readInt32BE"), fastMethod(p_isolate, readInt32BE));
+    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "readInt32LE"), fastMethod(p_isolate, readInt32LE));
+    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "readFloatBE"), fastMethod(p_isolate, readFloatBE));
+    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "readFloatLE"), fastMethod(p_isolate, readFloatLE));
+    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "readDoubleBE"), fastMethod(p_isolate, readDoubleBE));
+    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "readDoubleLE"), fastMethod(p_isolate, readDoubleLE));
     proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "readBigInt64BE"), v8::FunctionTemplate::New(p_isolate, readBigInt64BE));
     proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "readBigInt64LE"), v8::FunctionTemplate::New(p_isolate, readBigInt64LE));
     proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "readBigUInt64BE"), v8::FunctionTemplate::New(p_isolate, readBigUInt64BE));
@@ -173,38 +752,39 @@ v8::Local<v8::FunctionTemplate> Buffer::createTemplate(v8::Isolate* p_isolate) {
     proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "writeUIntBE"), v8::FunctionTemplate::New(p_isolate, writeUIntBE));
     proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "writeUIntLE"), v8::FunctionTemplate::New(p_isolate, writeUIntLE));
     // Lowercase aliases (readUint* = readUInt*, writeUint* = writeUInt*)
-    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "readUint8"),    v8::FunctionTemplate::New(p_isolate, readUInt8));
-    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "readUint16BE"), v8::FunctionTemplate::New(p_isolate, readUInt16BE));
-    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "readUint16LE"), v8::FunctionTemplate::New(p_isolate, readUInt16LE));
-    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "readUint32BE"), v8::FunctionTemplate::New(p_isolate, readUInt32BE));
-    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "readUint32LE"), v8::FunctionTemplate::New(p_isolate, readUInt32LE));
+    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "readUint8"),    fastMethod(p_isolate, readUInt8));
+    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "readUint16BE"), fastMethod(p_isolate, readUInt16BE));
+    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "readUint16LE"), fastMethod(p_isolate, readUInt16LE));
+    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "readUint32BE"), fastMethod(p_isolate, readUInt32BE));
+    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "readUint32LE"), fastMethod(p_isolate, readUInt32LE));
     proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "readBigUint64BE"), v8::FunctionTemplate::New(p_isolate, readBigUInt64BE));
     proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "readBigUint64LE"), v8::FunctionTemplate::New(p_isolate, readBigUInt64LE));
     proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "readUintBE"),   v8::FunctionTemplate::New(p_isolate, readUIntBE));
     proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "readUintLE"),   v8::FunctionTemplate::New(p_isolate, readUIntLE));
-    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "writeUint8"),    v8::FunctionTemplate::New(p_isolate, writeUInt8));
-    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "writeUint16BE"), v8::FunctionTemplate::New(p_isolate, writeUInt16BE));
-    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "writeUint16LE"), v8::FunctionTemplate::New(p_isolate, writeUInt16LE));
-    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "writeUint32BE"), v8::FunctionTemplate::New(p_isolate, writeUInt32BE));
-    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "writeUint32LE"), v8::FunctionTemplate::New(p_isolate, writeUInt32LE));
+    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "writeUint8"),    fastMethod(p_isolate, writeUInt8));
+    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "writeUint16BE"), fastMethod(p_isolate, writeUInt16BE));
+    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "writeUint16LE"), fastMethod(p_isolate, writeUInt16LE));
+    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "writeUint32BE"), fastMethod(p_isolate, writeUInt32BE));
+    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "writeUint32LE"), fastMethod(p_isolate, writeUInt32LE));
     proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "writeBigUint64BE"), v8::FunctionTemplate::New(p_isolate, writeBigUInt64BE));
     proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "writeBigUint64LE"), v8::FunctionTemplate::New(p_isolate, writeBigUInt64LE));
     proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "writeUintBE"),   v8::FunctionTemplate::New(p_isolate, writeUIntBE));
     proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "writeUintLE"),   v8::FunctionTemplate::New(p_isolate, writeUIntLE));
 
-    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "writeInt8"), v8::FunctionTemplate::New(p_isolate, writeInt8));
-    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "writeUInt16BE"), v8::FunctionTemplate::New(p_isolate, writeUInt16BE));
-    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "writeUInt16LE"), v8::FunctionTemplate::New(p_isolate, writeUInt16LE));
-    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "writeInt16BE"), v8::FunctionTemplate::New(p_isolate, writeInt16BE));
-    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "writeInt16LE"), v8::FunctionTemplate::New(p_isolate, writeInt16LE));
-    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "writeUInt32BE"), v8::FunctionTemplate::New(p_isolate, writeUInt32BE));
-    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "writeUInt32LE"), v8::FunctionTemplate::New(p_isolate, writeUInt32LE));
-    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "writeInt32BE"), v8::FunctionTemplate::New(p_isolate, writeInt32BE));
-    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "writeInt32LE"), v8::FunctionTemplate::New(p_isolate, writeInt32LE));
-    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "writeFloatBE"), v8::FunctionTemplate::New(p_isolate, writeFloatBE));
-    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "writeFloatLE"), v8::FunctionTemplate::New(p_isolate, writeFloatLE));
-    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "writeDoubleBE"), v8::FunctionTemplate::New(p_isolate, writeDoubleBE));
-    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "writeDoubleLE"), v8::FunctionTemplate::New(p_isolate, writeDoubleLE));
+    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "writeUInt8"), fastMethod(p_isolate, writeUInt8));
+    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "writeInt8"), fastMethod(p_isolate, writeInt8));
+    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "writeUInt16BE"), fastMethod(p_isolate, writeUInt16BE));
+    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "writeUInt16LE"), fastMethod(p_isolate, writeUInt16LE));
+    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "writeInt16BE"), fastMethod(p_isolate, writeInt16BE));
+    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "writeInt16LE"), fastMethod(p_isolate, writeInt16LE));
+    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "writeUInt32BE"), fastMethod(p_isolate, writeUInt32BE));
+    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "writeUInt32LE"), fastMethod(p_isolate, writeUInt32LE));
+    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "writeInt32BE"), fastMethod(p_isolate, writeInt32BE));
+    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "writeInt32LE"), fastMethod(p_isolate, writeInt32LE));
+    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "writeFloatBE"), fastMethod(p_isolate, writeFloatBE));
+    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "writeFloatLE"), fastMethod(p_isolate, writeFloatLE));
+    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "writeDoubleBE"), fastMethod(p_isolate, writeDoubleBE));
+    proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "writeDoubleLE"), fastMethod(p_isolate, writeDoubleLE));
     proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "writeBigInt64BE"), v8::FunctionTemplate::New(p_isolate, writeBigInt64BE));
     proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "writeBigInt64LE"), v8::FunctionTemplate::New(p_isolate, writeBigInt64LE));
     proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "writeBigUInt64BE"), v8::FunctionTemplate::New(p_isolate, writeBigUInt64BE));
@@ -233,23 +813,43 @@ void Buffer::initialize(v8::Isolate* p_isolate, v8::Local<v8::Context> context)
     
     v8::Local<v8::Value> buffer_proto = buffer_fn->Get(context, v8::String::NewFromUtf8Literal(p_isolate, "prototype")).ToLocalChecked();
     buffer_proto.As<v8::Object>()->SetPrototypeV2(context, u8_proto).Check();
+    s_buffer_proto.Reset(p_isolate, buffer_proto.As<v8::Object>());
+    s_buffer_fn.Reset(p_isolate, buffer_fn);
 }
 
 v8::Local<v8::Uint8Array> Buffer::createBuffer(v8::Isolate* p_isolate, size_t length) {
     v8::Local<v8::ArrayBuffer> ab = v8::ArrayBuffer::New(p_isolate, length);
     v8::Local<v8::Uint8Array> ui = v8::Uint8Array::New(ab, 0, length);
-    
-    // Set the prototype to Buffer.prototype so it gets the Buffer methods
-    v8::Local<v8::Context> context = p_isolate->GetCurrentContext();
-    v8::Local<v8::Value> buffer_val = context->Global()->Get(context, v8::String::NewFromUtf8Literal(p_isolate, "Buffer")).ToLocalChecked();
-    if (buffer_val->IsFunction()) {
-        v8::Local<v8::Value> proto = buffer_val.As<v8::Function>()->Get(context, v8::String::NewFromUtf8Literal(p_isolate, "prototype")).ToLocalChecked();
-        ui->SetPrototypeV2(context, proto).Check();
-    }
-    
+    return asBuffer(p_isolate, p_isolate->GetCurrentContext(), ui);
+}
+
+v8::Local<v8::Uint8Array> Buffer::createUnsafeBuffer(v8::Isolate* p_isolate, size_t length) {
+    uint8_t* p_data = nullptr;
+    return newUnsafeBuffer(p_isolate, length, p_data);
+}
+
+v8::Local<v8::Uint8Array> Buffer::copyBuffer(v8::Isolate* p_isolate, const void* p_src, size_t length) {
+    uint8_t* p_data = nullptr;
+    v8::Local<v8::Uint8Array> ui = newUnsafeBuffer(p_isolate, length, p_data);
+    if (length > 0)
+        memcpy(p_data, p_src, length);
     return ui;
 }
 
+v8::Local<v8::Uint8Array> Buffer::viewBuffer(v8::Isolate* p_isolate, std::shared_ptr<v8::BackingStore> sp_store) {
+    size_t length = sp_store->ByteLength();
+    v8::Local<v8::ArrayBuffer> ab = v8::ArrayBuffer::New(p_isolate, std::move(sp_store));
+    return asBuffer(p_isolate, p_isolate->GetCurrentContext(), v8::Uint8Array::New(ab, 0, length));
+}
+
+uint8_t* Buffer::data(v8::Local<v8::Uint8Array> ui) {
+    return static_cast<uint8_t*>(ui->Buffer()->GetBackingStore()->Data()) + ui->ByteOffset();
+}
+
+v8::Local<v8::Uint8Array> Buffer::createUint8Array(v8::Isolate* p_isolate, size_t length, uint8_t*& p_data) {
+    return v8::Uint8Array::New(newUninitializedArrayBuffer(p_isolate, length, p_data), 0, length);
+}
+
 void Buffer::alloc(const v8::FunctionCallbackInfo<v8::Value>& args) {
     v8::Isolate* p_isolate = args.GetIsolate();
     if (args.Length() < 1 || !args[0]->IsNumber()) {
@@ -258,11 +858,17 @@ void Buffer::alloc(const v8::FunctionCallbackInfo<v8::Value>& args) {
     }
 
     size_t length = static_cast<size_t>(args[0]->IntegerValue(p_isolate->GetCurrentContext()).FromMaybe(0));
-    v8::Local<v8::Uint8Array> ui = createBuffer(p_isolate, length);
 
-    // Zero-fill first
-    void* p_raw = ui->Buffer()->GetBackingStore()->Data();
-    memset(p_raw, 0, length);
+    // createBuffer() comes back zeroed; a numeric or string fill overwrites every byte, so it skips that.
+    uint8_t* p_raw = nullptr;
+    v8::Local<v8::Uint8Array> ui;
+    if (args.Length() > 1 && (args[1]->IsNumber() || args[1]->IsString())) {
+        ui = asBuffer(p_isolate, p_isolate->GetCurrentContext(),
+                      v8::Uint8Array::New(newUninitializedArrayBuffer(p_isolate, length, p_raw), 0, length));
+    } else {
+        ui = createBuffer(p_isolate, length);
+        p_raw = data(ui);
+    }
 
     if (args.Length() > 1 && length > 0) {
         // Simulate fill by delegating through the fill method
@@ -278,14 +884,7 @@ void Buffer::alloc(const v8::FunctionCallbackInfo<v8::Value>& args) {
                 v8::String::Utf8Value e(p_isolate, args[2]);
                 enc = *e;
             }
-            v8::String::Utf8Value fill_str(p_isolate, args[1]);
-            if (fill_str.length() > 0) {
-                for (size_t i = 0; i < length; ) {
-                    size_t to_copy = std::min(static_cast<size_t>(fill_str.length()), length - i);
-                    memcpy(p_data + i, *fill_str, to_copy);
-                    i += to_copy;
-                }
-            }
+            fillString(p_isolate, args[1].As<v8::String>(), enc, p_data, length);
         } else if (args[1]->IsUint8Array()) {
             v8::Local<v8::Uint8Array> fill_buf = args[1].As<v8::Uint8Array>();
             size_t fill_len = fill_buf->ByteLength();
@@ -303,9 +902,21 @@ void Buffer::alloc(const v8::FunctionCallbackInfo<v8::Value>& args) {
     args.GetReturnValue().Set(ui);
 }
 
+static bool allocSize(const v8::FunctionCallbackInfo<v8::Value>& args, size_t& length) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    if (args.Length() < 1 || !args[0]->IsNumber()) {
+        p_isolate->ThrowException(v8::Exception::TypeError(
+            v8::String::NewFromUtf8Literal(p_isolate, "The \"size\" argument must be of type number")));
+        return false;
+    }
+    length = static_cast<size_t>(args[0]->IntegerValue(p_isolate->GetCurrentContext()).FromMaybe(0));
+    return true;
+}
+
 void Buffer::allocUnsafe(const v8::FunctionCallbackInfo<v8::Value>& args) {
-    // For now, same as alloc in Z8 for simplicity
-    alloc(args);
+    size_t length = 0;
+    if (allocSize(args, length))
+        args.GetReturnValue().Set(createUnsafeBuffer(args.GetIsolate(), length));
 }
 
 void Buffer::from(const v8::FunctionCallbackInfo<v8::Value>& args) {
@@ -321,44 +932,14 @@ void Buffer::from(const v8::FunctionCallbackInfo<v8::Value>& args) {
 
     // Case 1: String
     if (input->IsString()) {
-        v8::String::Utf8Value str(p_isolate, input);
         std::string encoding = "utf8";
         if (args.Length() > 1 && args[1]->IsString()) {
             v8::String::Utf8Value enc_str(p_isolate, args[1]);
             encoding = *enc_str;
         }
-
-        if (encoding == "hex") {
-            std::string hex_str(*str);
-            size_t len = hex_str.length() / 2;
-            v8::Local<v8::Uint8Array> ui = createBuffer(p_isolate, len);
-            uint8_t* p_data = static_cast<uint8_t*>(ui->Buffer()->GetBackingStore()->Data());
-            for (size_t i = 0; i < len; i++) {
-                int32_t high = hexValue(hex_str[i * 2]);
-                int32_t low  = hexValue(hex_str[i * 2 + 1]);
-                if (high == -1 || low == -1) break;
-                p_data[i] = static_cast<uint8_t>((high << 4) | low);
-            }
-            args.GetReturnValue().Set(ui);
-            return;
-        } else if (encoding == "base64" || encoding == "base64url") {
-            std::vector<uint8_t> bytes = base64ToBytes(*str);
-            v8::Local<v8::Uint8Array> ui = createBuffer(p_isolate, bytes.size());
-            memcpy(ui->Buffer()->GetBackingStore()->Data(), bytes.data(), bytes.size());
-            args.GetReturnValue().Set(ui);
-            return;
-        } else if (encoding == "latin1" || encoding == "binary" || encoding == "ascii") {
-            size_t len = str.length();
-            v8::Local<v8::Uint8Array> ui = createBuffer(p_isolate, len);
-            memcpy(ui->Buffer()->GetBackingStore()->Data(), *str, len);
-            args.GetReturnValue().Set(ui);
-            return;
-        }
-
-        size_t len = str.length();
-        v8::Local<v8::Uint8Array> ui = createBuffer(p_isolate, len);
-        memcpy(ui->Buffer()->GetBackingStore()->Data(), *str, len);
-        args.GetReturnValue().Set(ui);
+        v8::Local<v8::String> str = input.As<v8::String>();
+        size_t capacity = stringCapacity(p_isolate, encoding, str);
+        args.GetReturnValue().Set(decodeString(p_isolate, str, stringWriter(encoding), capacity));
         return;
     }
 
@@ -381,24 +962,14 @@ void Buffer::from(const v8::FunctionCallbackInfo<v8::Value>& args) {
         }
 
         v8::Local<v8::Uint8Array> ui = v8::Uint8Array::New(ab, byte_offset, length);
-        // Set the prototype to Buffer.prototype
-        v8::Local<v8::Value> buffer_val = context->Global()->Get(context, v8::String::NewFromUtf8Literal(p_isolate, "Buffer")).ToLocalChecked();
-        if (buffer_val->IsFunction()) {
-            v8::Local<v8::Value> proto = buffer_val.As<v8::Function>()->Get(context, v8::String::NewFromUtf8Literal(p_isolate, "prototype")).ToLocalChecked();
-            ui->SetPrototypeV2(context, proto).Check();
-        }
-        args.GetReturnValue().Set(ui);
+        args.GetReturnValue().Set(asBuffer(p_isolate, context, ui));
         return;
     }
 
     // Case 3: TypedArray or Buffer
     if (input->IsUint8Array()) {
         v8::Local<v8::Uint8Array> src = input.As<v8::Uint8Array>();
-        size_t len = src->ByteLength();
-        v8::Local<v8::Uint8Array> ui = createBuffer(p_isolate, len);
-        uint8_t* p_src = static_cast<uint8_t*>(src->Buffer()->GetBackingStore()->Data()) + src->ByteOffset();
-        memcpy(ui->Buffer()->GetBackingStore()->Data(), p_src, len);
-        args.GetReturnValue().Set(ui);
+        args.GetReturnValue().Set(copyBuffer(p_isolate, data(src), src->ByteLength()));
         return;
     }
 
@@ -406,8 +977,8 @@ void Buffer::from(const v8::FunctionCallbackInfo<v8::Value>& args) {
     if (input->IsArray()) {
         v8::Local<v8::Array> arr = input.As<v8::Array>();
         uint32_t len = arr->Length();
-        v8::Local<v8::Uint8Array> ui = createBuffer(p_isolate, len);
-        uint8_t* p_data = static_cast<uint8_t*>(ui->Buffer()->GetBackingStore()->Data());
+        uint8_t* p_data = nullptr;
+        v8::Local<v8::Uint8Array> ui = newUnsafeBuffer(p_isolate, len, p_data);
         for (uint32_t i = 0; i < len; i++) {
             p_data[i] = static_cast<uint8_t>(arr->Get(context, i).ToLocalChecked()->Uint32Value(context).FromMaybe(0));
         }
@@ -418,10 +989,7 @@ void Buffer::from(const v8::FunctionCallbackInfo<v8::Value>& args) {
     // Fallback: Try converting to string (for Objects with valueOf/toString)
     v8::Local<v8::String> s;
     if (input->ToString(context).ToLocal(&s)) {
-        v8::String::Utf8Value str_val(p_isolate, s);
-        v8::Local<v8::Uint8Array> ui = createBuffer(p_isolate, str_val.length());
-        memcpy(ui->Buffer()->GetBackingStore()->Data(), *str_val, str_val.length());
-        args.GetReturnValue().Set(ui);
+        args.GetReturnValue().Set(decodeString(p_isolate, s, &Buffer::writeUtf8, utf8Length(p_isolate, s)));
         return;
     }
 
@@ -453,8 +1021,8 @@ void Buffer::concat(const v8::FunctionCallbackInfo<v8::Value>& args) {
         }
     }
 
-    v8::Local<v8::Uint8Array> result = createBuffer(p_isolate, total_length);
-    uint8_t* p_dst_data = static_cast<uint8_t*>(result->Buffer()->GetBackingStore()->Data());
+    uint8_t* p_dst_data = nullptr;
+    v8::Local<v8::Uint8Array> result = newUnsafeBuffer(p_isolate, total_length, p_dst_data);
     
     size_t offset = 0;
     for (uint32_t i = 0; i < list_len && offset < total_length; i++) {
@@ -467,6 +1035,9 @@ void Buffer::concat(const v8::FunctionCallbackInfo<v8::Value>& args) {
             offset += to_copy;
         }
     }
+    // An explicit totalLength past the inputs is zero-filled, like Node.
+    if (offset < total_length)
+        memset(p_dst_data + offset, 0, total_length - offset);
 
     args.GetReturnValue().Set(result);
 }
@@ -485,12 +1056,9 @@ void Buffer::isBuffer(const v8::FunctionCallbackInfo<v8::Value>& args) {
     }
 
     // Check if prototype is Buffer.prototype
-    v8::Local<v8::Context> context = p_isolate->GetCurrentContext();
-    v8::Local<v8::Value> buffer_val = context->Global()->Get(context, v8::String::NewFromUtf8Literal(p_isolate, "Buffer")).ToLocalChecked();
-    if (buffer_val->IsFunction()) {
-        v8::Local<v8::Value> buffer_proto = buffer_val.As<v8::Function>()->Get(context, v8::String::NewFromUtf8Literal(p_isolate, "prototype")).ToLocalChecked();
+    if (!s_buffer_proto.IsEmpty()) {
         v8::Local<v8::Value> obj_proto = val.As<v8::Object>()->GetPrototypeV2();
-        args.GetReturnValue().Set(v8::Boolean::New(p_isolate, obj_proto->StrictEquals(buffer_proto)));
+        args.GetReturnValue().Set(v8::Boolean::New(p_isolate, obj_proto->StrictEquals(s_buffer_proto.Get(p_isolate))));
         return;
     }
 
@@ -534,24 +1102,12 @@ void Buffer::toString(const v8::FunctionCallbackInfo<v8::Value>& args) {
     }
 
     const uint8_t* p_slice = p_data + offset + static_cast<size_t>(start);
-
-    if (encoding == "hex") {
-        std::string hex = bytesToHex(p_slice, len);
-        args.GetReturnValue().Set(v8::String::NewFromUtf8(p_isolate, hex.c_str()).ToLocalChecked());
-        return;
-    } else if (encoding == "base64" || encoding == "base64url") {
-        std::string b64 = bytesToBase64(p_slice, len);
-        args.GetReturnValue().Set(v8::String::NewFromUtf8(p_isolate, b64.c_str()).ToLocalChecked());
-        return;
-    } else if (encoding == "latin1" || encoding == "binary" || encoding == "ascii") {
-        // latin1: each byte maps directly to unicode codepoint 0-255
-        std::string s(reinterpret_cast<const char*>(p_slice), len);
-        args.GetReturnValue().Set(v8::String::NewFromUtf8(p_isolate, s.c_str(), v8::NewStringType::kNormal, static_cast<int32_t>(len)).ToLocalChecked());
+    v8::Local<v8::String> str;
+    if (!decodeBytes(p_isolate, encoding, p_slice, len).ToLocal(&str)) {
+        throwStringTooLong(p_isolate);
         return;
     }
-
-    // Default to utf8
-    args.GetReturnValue().Set(v8::String::NewFromUtf8(p_isolate, reinterpret_cast<const char*>(p_slice), v8::NewStringType::kNormal, static_cast<int32_t>(len)).ToLocalChecked());
+    args.GetReturnValue().Set(str);
 }
 
 void Buffer::write(const v8::FunctionCallbackInfo<v8::Value>& args) {
@@ -583,7 +1139,7 @@ void Buffer::write(const v8::FunctionCallbackInfo<v8::Value>& args) {
         if (len_param < max_write) max_write = len_param;
     }
 
-    // Encoding is 3rd or 4th argument
+    // Encoding is the 2nd, 3rd or 4th argument
     std::string encoding = "utf8";
     if (args.Length() > 3 && args[3]->IsString()) {
         v8::String::Utf8Value enc_str(p_isolate, args[3]);
@@ -591,33 +1147,13 @@ void Buffer::write(const v8::FunctionCallbackInfo<v8::Value>& args) {
     } else if (args.Length() > 2 && args[2]->IsString()) {
         v8::String::Utf8Value enc_str(p_isolate, args[2]);
         encoding = *enc_str;
+    } else if (args.Length() > 1 && args[1]->IsString()) {
+        v8::String::Utf8Value enc_str(p_isolate, args[1]);
+        encoding = *enc_str;
     }
 
-    v8::String::Utf8Value str(p_isolate, args[0]);
-    size_t to_write = std::min(static_cast<size_t>(str.length()), max_write);
-
-    if (encoding == "hex") {
-        std::string hex_str(*str);
-        size_t hex_len = hex_str.length() / 2;
-        to_write = std::min(hex_len, max_write);
-        for (size_t i = 0; i < to_write; i++) {
-            int32_t high = hexValue(hex_str[i * 2]);
-            int32_t low  = hexValue(hex_str[i * 2 + 1]);
-            if (high == -1 || low == -1) { to_write = i; break; }
-            p_data[offset + i] = static_cast<uint8_t>((high << 4) | low);
-        }
-    } else if (encoding == "base64" || encoding == "base64url") {
-        std::vector<uint8_t> bytes = base64ToBytes(*str);
-        to_write = std::min(bytes.size(), max_write);
-        memcpy(p_data + offset, bytes.data(), to_write);
-    } else if (encoding == "latin1" || encoding == "binary" || encoding == "ascii") {
-        to_write = std::min(static_cast<size_t>(str.length()), max_write);
-        memcpy(p_data + offset, *str, to_write);
-    } else {
-        memcpy(p_data + offset, *str, to_write);
-    }
-
-    args.GetReturnValue().Set(v8::Integer::New(p_isolate, static_cast<int32_t>(to_write)));
+    size_t written = stringWriter(encoding)(p_isolate, args[0].As<v8::String>(), p_data + offset, max_write);
+    args.GetReturnValue().Set(v8::Integer::New(p_isolate, static_cast<int32_t>(written)));
 }
 
 void Buffer::fill(const v8::FunctionCallbackInfo<v8::Value>& args) {
@@ -654,17 +1190,7 @@ void Buffer::fill(const v8::FunctionCallbackInfo<v8::Value>& args) {
         } else if (args.Length() > 2 && args[2]->IsString()) {
             v8::String::Utf8Value e(p_isolate, args[2]); enc = *e;
         }
-        v8::String::Utf8Value str_val(p_isolate, args[0]);
-        size_t src_len = static_cast<size_t>(str_val.length());
-        if (src_len == 0) {
-            memset(p_target, 0, fill_len);
-        } else {
-            for (size_t i = 0; i < fill_len; ) {
-                size_t to_copy = std::min(src_len, fill_len - i);
-                memcpy(p_target + i, *str_val, to_copy);
-                i += to_copy;
-            }
-        }
+        fillString(p_isolate, args[0].As<v8::String>(), enc, p_target, fill_len);
     } else if (args[0]->IsUint8Array()) {
         v8::Local<v8::Uint8Array> fill_buf = args[0].As<v8::Uint8Array>();
         size_t src_len = fill_buf->ByteLength();
@@ -755,21 +1281,19 @@ void Buffer::slice(const v8::FunctionCallbackInfo<v8::Value>& args) {
 
     size_t length = end - start;
     v8::Local<v8::Uint8Array> result = v8::Uint8Array::New(ui->Buffer(), ui->ByteOffset() + start, length);
-    
-    // Re-prototype it
-    v8::Local<v8::Value> buffer_val = context->Global()->Get(context, v8::String::NewFromUtf8Literal(p_isolate, "Buffer")).ToLocalChecked();
-    if (buffer_val->IsFunction()) {
-        v8::Local<v8::Value> proto = buffer_val.As<v8::Function>()->Get(context, v8::String::NewFromUtf8Literal(p_isolate, "prototype")).ToLocalChecked();
-        result->SetPrototypeV2(context, proto).Check();
-    }
-
-    args.GetReturnValue().Set(result);
+    args.GetReturnValue().Set(asBuffer(p_isolate, context, result));
 }
 
 // ---- New static methods ----
 
 void Buffer::allocUnsafeSlow(const v8::FunctionCallbackInfo<v8::Value>& args) {
-    alloc(args);
+    v8::Isolate* p_isolate = args.GetIsolate();
+    size_t length = 0;
+    if (!allocSize(args, length))
+        return;
+    uint8_t* p_data = nullptr;
+    v8::Local<v8::ArrayBuffer> ab = newUninitializedArrayBuffer(p_isolate, length, p_data);
+    args.GetReturnValue().Set(asBuffer(p_isolate, p_isolate->GetCurrentContext(), v8::Uint8Array::New(ab, 0, length)));
 }
 
 void Buffer::isEncoding(const v8::FunctionCallbackInfo<v8::Value>& args) {
@@ -799,22 +1323,31 @@ void Buffer::byteLength(const v8::FunctionCallbackInfo<v8::Value>& args) {
             v8::String::Utf8Value e(p_isolate, args[1]);
             enc = *e;
         }
+        int32_t chars = args[0].As<v8::String>()->Length();
         if (enc == "hex") {
-            v8::String::Utf8Value str(p_isolate, args[0]);
-            args.GetReturnValue().Set(v8::Integer::New(p_isolate, static_cast<int32_t>(str.length() / 2)));
+            args.GetReturnValue().Set(v8::Integer::New(p_isolate, chars / 2));
+            return;
+        }
+        if (isLatin1Encoding(enc)) {
+            args.GetReturnValue().Set(v8::Integer::New(p_isolate, chars));
+            return;
+        }
+        if (isUtf16Encoding(enc)) {
+            args.GetReturnValue().Set(static_cast<double>(chars) * 2);
             return;
         }
         if (enc == "base64" || enc == "base64url") {
-            v8::String::Utf8Value str(p_isolate, args[0]);
-            int32_t len = static_cast<int32_t>(str.length());
-            int32_t decoded = (len * 3) / 4;
-            if (len > 0 && (*str)[len - 1] == '=') decoded--;
-            if (len > 1 && (*str)[len - 2] == '=') decoded--;
-            args.GetReturnValue().Set(v8::Integer::New(p_isolate, decoded));
+            size_t decoded = 0;
+            {
+                v8::String::ValueView view(p_isolate, args[0].As<v8::String>());
+                size_t chars = static_cast<size_t>(view.length());
+                decoded = view.is_one_byte() ? base64::decodedLength(view.data8(), chars)
+                                             : base64::decodedLength(view.data16(), chars);
+            }
+            args.GetReturnValue().Set(static_cast<double>(decoded));
             return;
         }
-        v8::String::Utf8Value str(p_isolate, args[0]);
-        args.GetReturnValue().Set(v8::Integer::New(p_isolate, static_cast<int32_t>(str.length())));
+        args.GetReturnValue().Set(static_cast<double>(utf8Length(p_isolate, args[0].As<v8::String>())));
         return;
     }
     if (args[0]->IsArrayBuffer()) {
@@ -903,89 +1436,145 @@ void Buffer::compare_instance(const v8::FunctionCallbackInfo<v8::Value>& args) {
     args.GetReturnValue().Set(v8::Integer::New(p_isolate, cmp));
 }
 
-static int64_t bufferIndexOf(uint8_t* p_haystack, size_t hay_len, uint8_t* p_needle, size_t needle_len, int64_t byte_offset, bool reverse) {
-    if (needle_len == 0) return reverse ? static_cast<int64_t>(hay_len) : byte_offset;
-    if (needle_len > hay_len) return -1;
-    if (!reverse) {
-        for (int64_t i = byte_offset; i <= static_cast<int64_t>(hay_len - needle_len); i++) {
-            if (memcmp(p_haystack + i, p_needle, needle_len) == 0) return i;
-        }
+// Encoded string needles, matched by string identity: a loop searching for the same literal or
+// the same boundary string encodes it once. Short needles only, replaced round-robin.
+struct EncodedNeedle {
+    v8::Persistent<v8::String> m_string;
+    std::string m_encoding;
+    std::vector<uint8_t> m_bytes;
+};
+
+static constexpr size_t NEEDLE_CACHE_SIZE = 8;
+static constexpr int32_t NEEDLE_CACHE_MAX_CHARS = 256;
+static EncodedNeedle s_needles[NEEDLE_CACHE_SIZE];
+static size_t s_needle_next = 0;
+
+static void encodeNeedle(v8::Isolate* p_isolate,
+                         v8::Local<v8::String> str,
+                         const std::string& encoding,
+                         std::vector<uint8_t>& bytes) {
+    bytes.resize(stringCapacity(p_isolate, encoding, str));
+    bytes.resize(stringWriter(encoding)(p_isolate, str, bytes.data(), bytes.size()));
+}
+
+static const std::vector<uint8_t>& needleBytes(v8::Isolate* p_isolate,
+                                               v8::Local<v8::String> str,
+                                               const std::string& encoding,
+                                               std::vector<uint8_t>& scratch) {
+    if (str->Length() > NEEDLE_CACHE_MAX_CHARS) {
+        encodeNeedle(p_isolate, str, encoding, scratch);
+        return scratch;
+    }
+    for (EncodedNeedle& needle : s_needles) {
+        if (!needle.m_string.IsEmpty() && needle.m_string == str && needle.m_encoding == encoding)
+            return needle.m_bytes;
+    }
+    EncodedNeedle& needle = s_needles[s_needle_next];
+    s_needle_next = (s_needle_next + 1) % NEEDLE_CACHE_SIZE;
+    needle.m_string.Reset(p_isolate, str);
+    needle.m_encoding = encoding;
+    encodeNeedle(p_isolate, str, encoding, needle.m_bytes);
+    return needle.m_bytes;
+}
+
+// Node's IndexOfOffset: where a search of a buffer of length bytes starts for byteOffset, or -1
+// when it cannot match.
+static int64_t searchStart(size_t length, int64_t offset, size_t needle_length, bool forward) {
+    int64_t size = static_cast<int64_t>(length);
+    if (offset < 0) {
+        if (offset + size >= 0)
+            return size + offset;
+        return forward || needle_length == 0 ? 0 : -1;
+    }
+    if (offset + static_cast<int64_t>(needle_length) <= size)
+        return offset;
+    if (needle_length == 0)
+        return size;
+    return forward ? -1 : size - 1;
+}
+
+// indexOf, lastIndexOf and includes: (value[, byteOffset][, encoding]) with Node's coercions.
+// Returns the match or -1.
+static int64_t searchBuffer(const v8::FunctionCallbackInfo<v8::Value>& args, bool forward) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    v8::Local<v8::Context> context = p_isolate->GetCurrentContext();
+    v8::Local<v8::Uint8Array> self = args.This().As<v8::Uint8Array>();
+    const uint8_t* p_data = Buffer::data(self);
+    size_t length = self->ByteLength();
+    if (args.Length() < 1)
+        return -1;
+
+    // A string byteOffset is the encoding; a missing or NaN one searches the whole buffer.
+    std::string encoding = "utf8";
+    double offset = std::nan("");
+    if (args.Length() > 1 && args[1]->IsString()) {
+        encoding = *v8::String::Utf8Value(p_isolate, args[1]);
     } else {
-        int64_t start = static_cast<int64_t>(hay_len - needle_len);
-        if (byte_offset < start) start = byte_offset;
-        for (int64_t i = start; i >= 0; i--) {
-            if (memcmp(p_haystack + i, p_needle, needle_len) == 0) return i;
-        }
+        if (args.Length() > 1 && !args[1]->IsUndefined())
+            offset = args[1]->NumberValue(context).FromMaybe(offset);
+        if (args.Length() > 2 && args[2]->IsString())
+            encoding = *v8::String::Utf8Value(p_isolate, args[2]);
+    }
+    if (std::isnan(offset))
+        offset = forward ? 0 : static_cast<double>(length);
+    int64_t byte_offset = static_cast<int64_t>(std::clamp(offset, -2147483648.0, 2147483647.0));
+
+    if (args[0]->IsNumber()) {
+        uint8_t byte = static_cast<uint8_t>(args[0]->Uint32Value(context).FromMaybe(0));
+        int64_t start = searchStart(length, byte_offset, 1, forward);
+        if (start < 0 || length == 0)
+            return -1;
+        size_t from = static_cast<size_t>(start);
+        return forward ? search::find(p_data, length, &byte, 1, from)
+                       : search::findLast(p_data, length, &byte, 1, from);
+    }
+
+    std::vector<uint8_t> scratch;
+    const uint8_t* p_needle = nullptr;
+    size_t needle_length = 0;
+    if (args[0]->IsString()) {
+        const std::vector<uint8_t>& bytes = needleBytes(p_isolate, args[0].As<v8::String>(), encoding, scratch);
+        p_needle = bytes.data();
+        needle_length = bytes.size();
+    } else if (args[0]->IsUint8Array()) {
+        p_needle = Buffer::data(args[0].As<v8::Uint8Array>());
+        needle_length = args[0].As<v8::Uint8Array>()->ByteLength();
+    } else {
+        return -1;
+    }
+
+    int64_t start = searchStart(length, byte_offset, needle_length, forward);
+    if (needle_length == 0)
+        return start;
+    if (start < 0 || needle_length > length || (forward && static_cast<size_t>(start) + needle_length > length))
+        return -1;
+
+    // UTF-16 needles only match at even offsets, as Node searches them unit by unit.
+    bool units = args[0]->IsString() && isUtf16Encoding(encoding);
+    size_t from = static_cast<size_t>(units ? start & ~static_cast<int64_t>(1) : start);
+    for (;;) {
+        int64_t found = forward ? search::find(p_data, length, p_needle, needle_length, from)
+                                : search::findLast(p_data, length, p_needle, needle_length, from);
+        if (found < 0 || !units || found % 2 == 0)
+            return found;
+        if (forward && static_cast<size_t>(found) + 1 + needle_length > length)
+            return -1;
+        if (!forward && found == 0)
+            return -1;
+        from = forward ? static_cast<size_t>(found) + 1 : static_cast<size_t>(found) - 1;
     }
-    return -1;
 }
 
 void Buffer::indexOf(const v8::FunctionCallbackInfo<v8::Value>& args) {
-    v8::Isolate* p_isolate = args.GetIsolate();
-    v8::Local<v8::Context> context = p_isolate->GetCurrentContext();
-    v8::Local<v8::Uint8Array> self = args.This().As<v8::Uint8Array>();
-    uint8_t* p_data = static_cast<uint8_t*>(self->Buffer()->GetBackingStore()->Data()) + self->ByteOffset();
-    size_t buf_len = self->ByteLength();
-    int64_t byte_offset = 0;
-    if (args.Length() > 1 && args[1]->IsNumber()) {
-        byte_offset = args[1]->IntegerValue(context).FromMaybe(0);
-        if (byte_offset < 0) byte_offset = std::max(static_cast<int64_t>(0), static_cast<int64_t>(buf_len) + byte_offset);
-    }
-    int64_t result = -1;
-    if (args.Length() >= 1) {
-        if (args[0]->IsNumber()) {
-            uint8_t val = static_cast<uint8_t>(args[0]->Uint32Value(context).FromMaybe(0));
-            for (int64_t i = byte_offset; i < static_cast<int64_t>(buf_len); i++) {
-                if (p_data[i] == val) { result = i; break; }
-            }
-        } else if (args[0]->IsString()) {
-            v8::String::Utf8Value str(p_isolate, args[0]);
-            result = bufferIndexOf(p_data, buf_len, reinterpret_cast<uint8_t*>(*str), str.length(), byte_offset, false);
-        } else if (args[0]->IsUint8Array()) {
-            v8::Local<v8::Uint8Array> needle = args[0].As<v8::Uint8Array>();
-            uint8_t* p_needle = static_cast<uint8_t*>(needle->Buffer()->GetBackingStore()->Data()) + needle->ByteOffset();
-            result = bufferIndexOf(p_data, buf_len, p_needle, needle->ByteLength(), byte_offset, false);
-        }
-    }
-    args.GetReturnValue().Set(v8::Integer::New(p_isolate, static_cast<int32_t>(result)));
+    args.GetReturnValue().Set(static_cast<double>(searchBuffer(args, true)));
 }
 
 void Buffer::lastIndexOf(const v8::FunctionCallbackInfo<v8::Value>& args) {
-    v8::Isolate* p_isolate = args.GetIsolate();
-    v8::Local<v8::Context> context = p_isolate->GetCurrentContext();
-    v8::Local<v8::Uint8Array> self = args.This().As<v8::Uint8Array>();
-    uint8_t* p_data = static_cast<uint8_t*>(self->Buffer()->GetBackingStore()->Data()) + self->ByteOffset();
-    size_t buf_len = self->ByteLength();
-    int64_t byte_offset = static_cast<int64_t>(buf_len) - 1;
-    if (args.Length() > 1 && args[1]->IsNumber()) {
-        byte_offset = args[1]->IntegerValue(context).FromMaybe(0);
-        if (byte_offset < 0) byte_offset = static_cast<int64_t>(buf_len) + byte_offset;
-    }
-    int64_t result = -1;
-    if (args.Length() >= 1) {
-        if (args[0]->IsNumber()) {
-            uint8_t val = static_cast<uint8_t>(args[0]->Uint32Value(context).FromMaybe(0));
-            for (int64_t i = std::min(byte_offset, static_cast<int64_t>(buf_len) - 1); i >= 0; i--) {
-                if (p_data[i] == val) { result = i; break; }
-            }
-        } else if (args[0]->IsString()) {
-            v8::String::Utf8Value str(p_isolate, args[0]);
-            result = bufferIndexOf(p_data, buf_len, reinterpret_cast<uint8_t*>(*str), str.length(), byte_offset, true);
-        } else if (args[0]->IsUint8Array()) {
-            v8::Local<v8::Uint8Array> needle = args[0].As<v8::Uint8Array>();
-            uint8_t* p_needle = static_cast<uint8_t*>(needle->Buffer()->GetBackingStore()->Data()) + needle->ByteOffset();
-            result = bufferIndexOf(p_data, buf_len, p_needle, needle->ByteLength(), byte_offset, true);
-        }
-    }
-    args.GetReturnValue().Set(v8::Integer::New(p_isolate, static_cast<int32_t>(result)));
+    args.GetReturnValue().Set(static_cast<double>(searchBuffer(args, false)));
 }
 
 void Buffer::includes(const v8::FunctionCallbackInfo<v8::Value>& args) {
-    indexOf(args);
-    v8::Isolate* p_isolate = args.GetIsolate();
-    v8::Local<v8::Value> idx_val = args.GetReturnValue().Get();
-    int32_t idx = idx_val->Int32Value(p_isolate->GetCurrentContext()).FromMaybe(-1);
-    args.GetReturnValue().Set(v8::Boolean::New(p_isolate, idx >= 0));
+    args.GetReturnValue().Set(searchBuffer(args, true) >= 0);
 }
 
 void Buffer::toJSON(const v8::FunctionCallbackInfo<v8::Value>& args) {
@@ -1477,72 +2066,107 @@ void Buffer::writeUIntLE(const v8::FunctionCallbackInfo<v8::Value>& args) {
     args.GetReturnValue().Set(v8::Integer::New(p_isolate, static_cast<int32_t>(off + byte_local_len)));
 }
 
-void Buffer::atob(const v8::FunctionCallbackInfo<v8::Value>& args) {
-    v8::Isolate* p_isolate = args.GetIsolate();
-    if (args.Length() < 1) return;
-    v8::String::Utf8Value str(p_isolate, args[0]);
-    std::vector<uint8_t> bytes = base64ToBytes(*str);
-    // Latin1 string from bytes
-    args.GetReturnValue().Set(v8::String::NewFromOneByte(p_isolate, bytes.data(), v8::NewStringType::kNormal, static_cast<int32_t>(bytes.size())).ToLocalChecked());
+// Error shaped like the DOMException that atob()/btoa() throw in browsers and Node.
+static void throwInvalidCharacter(v8::Isolate* p_isolate) {
+    v8::Local<v8::Context> context = p_isolate->GetCurrentContext();
+    v8::Local<v8::Object> error =
+        v8::Exception::Error(v8::String::NewFromUtf8Literal(p_isolate, "Invalid character")).As<v8::Object>();
+    (void) error->Set(context,
+                      v8::String::NewFromUtf8Literal(p_isolate, "name"),
+                      v8::String::NewFromUtf8Literal(p_isolate, "InvalidCharacterError"));
+    (void) error->Set(context, v8::String::NewFromUtf8Literal(p_isolate, "code"), v8::Integer::New(p_isolate, 5));
+    p_isolate->ThrowException(error);
 }
 
-void Buffer::btoa(const v8::FunctionCallbackInfo<v8::Value>& args) {
+void Buffer::atob(const v8::FunctionCallbackInfo<v8::Value>& args) {
     v8::Isolate* p_isolate = args.GetIsolate();
-    if (args.Length() < 1) return;
-    v8::String::Utf8Value str(p_isolate, args[0]);
-    std::string b64 = bytesToBase64(reinterpret_cast<const uint8_t*>(*str), str.length());
-    args.GetReturnValue().Set(v8::String::NewFromUtf8(p_isolate, b64.c_str()).ToLocalChecked());
+    v8::Local<v8::String> input;
+    if (args.Length() < 1 || !args[0]->ToString(p_isolate->GetCurrentContext()).ToLocal(&input))
+        return;
+    size_t capacity = base64::decodedCapacity(input->Length());
+    char* p_chars = static_cast<char*>(std::malloc(capacity ? capacity : 1));
+    if (!p_chars)
+        return;
+    size_t length = 0;
+    {
+        v8::String::ValueView view(p_isolate, input);
+        size_t chars = static_cast<size_t>(view.length());
+        uint8_t* p_out = reinterpret_cast<uint8_t*>(p_chars);
+        length = view.is_one_byte() ? base64::decode(view.data8(), chars, p_out)
+                                    : base64::decode(view.data16(), chars, p_out);
+    }
+    // Each decoded byte is one Latin-1 character.
+    v8::Local<v8::String> result;
+    if (adoptOneByteString(p_isolate, p_chars, length).ToLocal(&result))
+        args.GetReturnValue().Set(result);
 }
 
-void Buffer::isAscii(const v8::FunctionCallbackInfo<v8::Value>& args) {
+void Buffer::btoa(const v8::FunctionCallbackInfo<v8::Value>& args) {
     v8::Isolate* p_isolate = args.GetIsolate();
-    if (args.Length() < 1 || !args[0]->IsUint8Array()) {
-        args.GetReturnValue().Set(v8::Boolean::New(p_isolate, false));
+    v8::Local<v8::String> input;
+    if (args.Length() < 1 || !args[0]->ToString(p_isolate->GetCurrentContext()).ToLocal(&input))
         return;
-    }
-    v8::Local<v8::Uint8Array> ui = args[0].As<v8::Uint8Array>();
-    uint8_t* p_data = static_cast<uint8_t*>(ui->Buffer()->GetBackingStore()->Data()) + ui->ByteOffset();
-    size_t len = ui->ByteLength();
-    for (size_t i = 0; i < len; i++) {
-        if (p_data[i] > 127) {
-            args.GetReturnValue().Set(v8::Boolean::New(p_isolate, false));
-            return;
-        }
-    }
-    args.GetReturnValue().Set(v8::Boolean::New(p_isolate, true));
-}
-
-static bool isValidUtf8(const uint8_t* p_data, size_t length) {
-    size_t i = 0;
-    while (i < length) {
-        if (p_data[i] <= 0x7F) {
-            i += 1;
-        } else if ((p_data[i] & 0xE0) == 0xC0) {
-            if (i + 1 >= length || (p_data[i+1] & 0xC0) != 0x80) return false;
-            i += 2;
-        } else if ((p_data[i] & 0xF0) == 0xE0) {
-            if (i + 2 >= length || (p_data[i+1] & 0xC0) != 0x80 || (p_data[i+2] & 0xC0) != 0x80) return false;
-            i += 3;
-        } else if ((p_data[i] & 0xF8) == 0xF0) {
-            if (i + 3 >= length || (p_data[i+1] & 0xC0) != 0x80 || (p_data[i+2] & 0xC0) != 0x80 || (p_data[i+3] & 0xC0) != 0x80) return false;
-            i += 4;
+    size_t size = base64::encodedLength(static_cast<size_t>(input->Length()), false);
+    char* p_chars = static_cast<char*>(std::malloc(size ? size : 1));
+    if (!p_chars)
+        return;
+    bool latin1 = true;
+    {
+        v8::String::ValueView view(p_isolate, input);
+        size_t chars = static_cast<size_t>(view.length());
+        if (view.is_one_byte()) {
+            base64::encode(view.data8(), chars, p_chars, false);
         } else {
-            return false;
+            // A two-byte string is still valid input when every character fits in Latin-1.
+            std::vector<uint8_t> narrow(chars);
+            for (size_t i = 0; i < chars && latin1; i++) {
+                latin1 = view.data16()[i] <= 0xFF;
+                narrow[i] = static_cast<uint8_t>(view.data16()[i]);
+            }
+            if (latin1)
+                base64::encode(narrow.data(), chars, p_chars, false);
         }
     }
-    return true;
+    if (!latin1) {
+        std::free(p_chars);
+        throwInvalidCharacter(p_isolate);
+        return;
+    }
+    v8::Local<v8::String> result;
+    if (!adoptOneByteString(p_isolate, p_chars, size).ToLocal(&result)) {
+        throwStringTooLong(p_isolate);
+        return;
+    }
+    args.GetReturnValue().Set(result);
 }
 
-void Buffer::isUtf8(const v8::FunctionCallbackInfo<v8::Value>& args) {
-    v8::Isolate* p_isolate = args.GetIsolate();
-    if (args.Length() < 1 || !args[0]->IsUint8Array()) {
-        args.GetReturnValue().Set(v8::Boolean::New(p_isolate, false));
-        return;
+bool Buffer::binaryBytes(v8::Local<v8::Value> value, const uint8_t*& p_data, size_t& length) {
+    if (value->IsArrayBufferView()) {
+        v8::Local<v8::ArrayBufferView> view = value.As<v8::ArrayBufferView>();
+        p_data = static_cast<const uint8_t*>(view->Buffer()->Data()) + view->ByteOffset();
+        length = view->ByteLength();
+        return true;
+    }
+    if (value->IsArrayBuffer()) {
+        p_data = static_cast<const uint8_t*>(value.As<v8::ArrayBuffer>()->Data());
+        length = value.As<v8::ArrayBuffer>()->ByteLength();
+        return true;
     }
-    v8::Local<v8::Uint8Array> ui = args[0].As<v8::Uint8Array>();
-    uint8_t* p_data = static_cast<uint8_t*>(ui->Buffer()->GetBackingStore()->Data()) + ui->ByteOffset();
-    size_t len = ui->ByteLength();
-    args.GetReturnValue().Set(v8::Boolean::New(p_isolate, isValidUtf8(p_data, len)));
+    return false;
+}
+
+void Buffer::isAscii(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    const uint8_t* p_data = nullptr;
+    size_t length = 0;
+    bool ascii = args.Length() > 0 && binaryBytes(args[0], p_data, length) && utf8::isAscii(p_data, length);
+    args.GetReturnValue().Set(ascii);
+}
+
+void Buffer::isUtf8(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    const uint8_t* p_data = nullptr;
+    size_t length = 0;
+    bool valid = args.Length() > 0 && binaryBytes(args[0], p_data, length) && utf8::validate(p_data, length);
+    args.GetReturnValue().Set(valid);
 }
 
 } // namespace module
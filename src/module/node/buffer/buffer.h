@@ -2,6 +2,7 @@
 #define Z8_MODULE_BUFFER_H
 
 #include "v8.h"
+#include <string>
 
 namespace z8 {
 namespace module {
@@ -92,7 +93,55 @@ class Buffer {
     static void writeUIntLE(const v8::FunctionCallbackInfo<v8::Value>& args);
 
     // Internal helpers
+    // Zero-filled Buffer with an ArrayBuffer of its own.
     static v8::Local<v8::Uint8Array> createBuffer(v8::Isolate* p_isolate, size_t length);
+    // Uninitialized Buffer; small ones are views into the shared pool, so write through data().
+    static v8::Local<v8::Uint8Array> createUnsafeBuffer(v8::Isolate* p_isolate, size_t length);
+    // Buffer holding a copy of length bytes from p_src, pooled when small.
+    static v8::Local<v8::Uint8Array> copyBuffer(v8::Isolate* p_isolate, const void* p_src, size_t length);
+    // Buffer over the whole of sp_store, sharing its bytes rather than copying them.
+    static v8::Local<v8::Uint8Array> viewBuffer(v8::Isolate* p_isolate, std::shared_ptr<v8::BackingStore> sp_store);
+    // First byte of a Uint8Array's view (its backing store plus ByteOffset()).
+    static uint8_t* data(v8::Local<v8::Uint8Array> ui);
+    // Plain Uint8Array (no Buffer prototype) over an uninitialized ArrayBuffer of its own.
+    static v8::Local<v8::Uint8Array> createUint8Array(v8::Isolate* p_isolate, size_t length, uint8_t*& p_data);
+    // The bytes of an ArrayBuffer or any view of one; false for other values.
+    static bool binaryBytes(v8::Local<v8::Value> value, const uint8_t*& p_data, size_t& length);
+
+    // UTF-8 size of str. One-byte strings are measured and encoded without V8's help.
+    static size_t utf8Length(v8::Isolate* p_isolate, v8::Local<v8::String> str);
+    // Writes str as UTF-8 (lone surrogates become U+FFFD) into at most max_length bytes at p_dst,
+    // whole characters only, and returns how many bytes it wrote.
+    static size_t writeUtf8(v8::Isolate* p_isolate, v8::Local<v8::String> str, uint8_t* p_dst, size_t max_length);
+    // The same, setting read to the number of UTF-16 code units of str that were written.
+    static size_t writeUtf8(v8::Isolate* p_isolate,
+                            v8::Local<v8::String> str,
+                            uint8_t* p_dst,
+                            size_t max_length,
+                            size_t& read);
+    // Replaces out with str as UTF-8, converted in place rather than through a Utf8Value.
+    static void toUtf8(v8::Isolate* p_isolate, v8::Local<v8::String> str, std::string& out);
+    // Replaces out with str written in encoding, as Buffer.from(str, encoding) writes it
+    // (UTF-8 for an encoding it does not know).
+    static void encodeString(v8::Isolate* p_isolate,
+                             v8::Local<v8::String> str,
+                             const std::string& encoding,
+                             std::string& out);
+    // String from length bytes of UTF-8, invalid sequences becoming U+FFFD. ASCII, and large
+    // Latin-1 text, become one-byte strings (external past 64 KiB) without V8 decoding them.
+    // Empty when the result would be too long.
+    static v8::MaybeLocal<v8::String> decodeUtf8(v8::Isolate* p_isolate, const void* p_data, size_t length);
+    // String of length Latin-1 bytes, external past 64 KiB.
+    static v8::MaybeLocal<v8::String> decodeLatin1(v8::Isolate* p_isolate, const void* p_data, size_t length);
+    // String of units UTF-16LE code units, which need not be aligned. Lone surrogates are kept.
+    static v8::MaybeLocal<v8::String> decodeUtf16(v8::Isolate* p_isolate, const void* p_data, size_t units);
+    // String of length bytes as Buffer#toString(encoding) reads them, UTF-8 for an unknown encoding.
+    static v8::MaybeLocal<v8::String> decodeBytes(v8::Isolate* p_isolate,
+                                                  const std::string& encoding,
+                                                  const void* p_data,
+                                                  size_t length);
+    // The Error (code ERR_STRING_TOO_LONG) for text longer than v8::String::kMaxLength.
+    static v8::Local<v8::Value> stringTooLongError(v8::Isolate* p_isolate);
 };
 
 } // namespace module
@@ -0,0 +1,214 @@
+#ifndef Z8_MODULE_BUFFER_HEX_H
+#define Z8_MODULE_BUFFER_HEX_H
+
+#include "simd.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Hex codecs for Buffer. Encoding splits each byte into nibbles and maps them through a 16-entry
+// table in one shuffle; decoding range-checks 16 or 32 characters at once and merges pairs with
+// a multiply-add. Like base64.h, the kernels only take whole clean blocks.
+namespace z8 {
+namespace hex {
+
+static constexpr char DIGITS[] = "0123456789abcdef";
+static constexpr uint8_t INVALID = 0xFF;
+
+constexpr std::array<uint8_t, 256> makeDecodeTable() {
+    std::array<uint8_t, 256> table = {};
+    for (uint8_t& value : table)
+        value = INVALID;
+    for (uint8_t i = 0; i < 10; ++i)
+        table['0' + i] = i;
+    for (uint8_t i = 0; i < 6; ++i) {
+        table['a' + i] = static_cast<uint8_t>(10 + i);
+        table['A' + i] = static_cast<uint8_t>(10 + i);
+    }
+    return table;
+}
+
+static constexpr std::array<uint8_t, 256> DECODE_TABLE = makeDecodeTable();
+
+// --- Vector kernels ---
+// Encoders return the input bytes consumed; decoders return the output bytes written and stop
+// at the first block holding a character that is not a hex digit.
+
+#if defined(Z8_SIMD_X64)
+Z8_TARGET_SSE41 inline size_t encodeSse41(const uint8_t* p_src, size_t length, char* p_dst) {
+    const __m128i digits = _mm_loadu_si128(reinterpret_cast<const __m128i*>(DIGITS));
+    const __m128i low_nibble = _mm_set1_epi8(0x0F);
+    size_t i = 0;
+    for (; length - i >= 16; i += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p_src + i));
+        __m128i hi = _mm_shuffle_epi8(digits, _mm_and_si128(_mm_srli_epi16(bytes, 4), low_nibble));
+        __m128i lo = _mm_shuffle_epi8(digits, _mm_and_si128(bytes, low_nibble));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(p_dst + 2 * i), _mm_unpacklo_epi8(hi, lo));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(p_dst + 2 * i + 16), _mm_unpackhi_epi8(hi, lo));
+    }
+    return i;
+}
+
+Z8_TARGET_AVX2 inline size_t encodeAvx2(const uint8_t* p_src, size_t length, char* p_dst) {
+    const __m256i digits = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(DIGITS)));
+    const __m256i low_nibble = _mm256_set1_epi8(0x0F);
+    size_t i = 0;
+    for (; length - i >= 32; i += 32) {
+        __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p_src + i));
+        __m256i hi = _mm256_shuffle_epi8(digits, _mm256_and_si256(_mm256_srli_epi16(bytes, 4), low_nibble));
+        __m256i lo = _mm256_shuffle_epi8(digits, _mm256_and_si256(bytes, low_nibble));
+        // The unpacks work per 128-bit lane; put the four 16-character runs back in order.
+        __m256i first = _mm256_unpacklo_epi8(hi, lo);
+        __m256i second = _mm256_unpackhi_epi8(hi, lo);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p_dst + 2 * i), _mm256_permute2x128_si256(first, second, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p_dst + 2 * i + 32),
+                            _mm256_permute2x128_si256(first, second, 0x31));
+    }
+    return i;
+}
+
+// Nibble values of 16 characters; valid gets 0xFF for each character that is a hex digit.
+Z8_TARGET_SSE41 inline __m128i nibblesSse41(__m128i chars, __m128i& valid) {
+    __m128i digit = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+    __m128i is_digit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+    __m128i alpha = _mm_sub_epi8(_mm_or_si128(chars, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    __m128i is_alpha = _mm_cmpeq_epi8(_mm_min_epu8(alpha, _mm_set1_epi8(5)), alpha);
+    valid = _mm_or_si128(is_digit, is_alpha);
+    return _mm_or_si128(_mm_and_si128(is_digit, digit),
+                        _mm_and_si128(is_alpha, _mm_add_epi8(alpha, _mm_set1_epi8(10))));
+}
+
+Z8_TARGET_SSE41 inline size_t decodeSse41(const uint8_t* p_src, size_t pairs, uint8_t* p_dst) {
+    // Each 16-bit lane holds a digit pair; the first one is the high nibble.
+    const __m128i merge = _mm_set1_epi16(0x0110);
+    size_t o = 0;
+    for (; pairs - o >= 16; o += 16) {
+        __m128i valid_a;
+        __m128i valid_b;
+        __m128i a = nibblesSse41(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p_src + 2 * o)), valid_a);
+        __m128i b = nibblesSse41(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p_src + 2 * o + 16)), valid_b);
+        if (_mm_movemask_epi8(_mm_and_si128(valid_a, valid_b)) != 0xFFFF)
+            break;
+        __m128i bytes = _mm_packus_epi16(_mm_maddubs_epi16(a, merge), _mm_maddubs_epi16(b, merge));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(p_dst + o), bytes);
+    }
+    return o;
+}
+
+Z8_TARGET_AVX2 inline __m256i nibblesAvx2(__m256i chars, __m256i& valid) {
+    __m256i digit = _mm256_sub_epi8(chars, _mm256_set1_epi8('0'));
+    __m256i is_digit = _mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit);
+    __m256i alpha = _mm256_sub_epi8(_mm256_or_si256(chars, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+    __m256i is_alpha = _mm256_cmpeq_epi8(_mm256_min_epu8(alpha, _mm256_set1_epi8(5)), alpha);
+    valid = _mm256_or_si256(is_digit, is_alpha);
+    return _mm256_or_si256(_mm256_and_si256(is_digit, digit),
+                           _mm256_and_si256(is_alpha, _mm256_add_epi8(alpha, _mm256_set1_epi8(10))));
+}
+
+Z8_TARGET_AVX2 inline size_t decodeAvx2(const uint8_t* p_src, size_t pairs, uint8_t* p_dst) {
+    const __m256i merge = _mm256_set1_epi16(0x0110);
+    size_t o = 0;
+    for (; pairs - o >= 32; o += 32) {
+        __m256i valid_a;
+        __m256i valid_b;
+        __m256i a = nibblesAvx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p_src + 2 * o)), valid_a);
+        __m256i b = nibblesAvx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p_src + 2 * o + 32)), valid_b);
+        if (_mm256_movemask_epi8(_mm256_and_si256(valid_a, valid_b)) != -1)
+            break;
+        __m256i bytes = _mm256_packus_epi16(_mm256_maddubs_epi16(a, merge), _mm256_maddubs_epi16(b, merge));
+        // packus interleaves the lanes of a and b; restore source order.
+        bytes = _mm256_permute4x64_epi64(bytes, 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p_dst + o), bytes);
+    }
+    return o;
+}
+#elif defined(Z8_SIMD_NEON)
+inline size_t encodeNeon(const uint8_t* p_src, size_t length, char* p_dst) {
+    const uint8x16_t digits = vld1q_u8(reinterpret_cast<const uint8_t*>(DIGITS));
+    size_t i = 0;
+    for (; length - i >= 16; i += 16) {
+        uint8x16_t bytes = vld1q_u8(p_src + i);
+        uint8x16x2_t chars;
+        chars.val[0] = vqtbl1q_u8(digits, vshrq_n_u8(bytes, 4));
+        chars.val[1] = vqtbl1q_u8(digits, vandq_u8(bytes, vdupq_n_u8(0x0F)));
+        vst2q_u8(reinterpret_cast<uint8_t*>(p_dst) + 2 * i, chars);
+    }
+    return i;
+}
+
+inline uint8x16_t nibblesNeon(uint8x16_t chars, uint8x16_t& valid) {
+    uint8x16_t digit = vsubq_u8(chars, vdupq_n_u8('0'));
+    uint8x16_t is_digit = vcleq_u8(digit, vdupq_n_u8(9));
+    uint8x16_t alpha = vsubq_u8(vorrq_u8(chars, vdupq_n_u8(0x20)), vdupq_n_u8('a'));
+    uint8x16_t is_alpha = vcleq_u8(alpha, vdupq_n_u8(5));
+    valid = vandq_u8(valid, vorrq_u8(is_digit, is_alpha));
+    return vbslq_u8(is_digit, digit, vaddq_u8(alpha, vdupq_n_u8(10)));
+}
+
+inline size_t decodeNeon(const uint8_t* p_src, size_t pairs, uint8_t* p_dst) {
+    size_t o = 0;
+    for (; pairs - o >= 16; o += 16) {
+        uint8x16x2_t chars = vld2q_u8(p_src + 2 * o);
+        uint8x16_t valid = vdupq_n_u8(0xFF);
+        uint8x16_t hi = nibblesNeon(chars.val[0], valid);
+        uint8x16_t lo = nibblesNeon(chars.val[1], valid);
+        if (vminvq_u8(valid) != 0xFF)
+            break;
+        vst1q_u8(p_dst + o, vorrq_u8(vshlq_n_u8(hi, 4), lo));
+    }
+    return o;
+}
+#endif
+
+// --- Codecs ---
+
+// Writes exactly 2 * length lowercase digits.
+inline void encode(const uint8_t* p_src, size_t length, char* p_dst) {
+    size_t i = 0;
+#if defined(Z8_SIMD_X64)
+    int32_t level = simd::level();
+    if (level >= simd::LEVEL_AVX2)
+        i = encodeAvx2(p_src, length, p_dst);
+    if (level >= simd::LEVEL_SSE41)
+        i += encodeSse41(p_src + i, length - i, p_dst + 2 * i);
+#elif defined(Z8_SIMD_NEON)
+    i = encodeNeon(p_src, length, p_dst);
+#endif
+    for (; i < length; i++) {
+        p_dst[2 * i] = DIGITS[p_src[i] >> 4];
+        p_dst[2 * i + 1] = DIGITS[p_src[i] & 0x0F];
+    }
+}
+
+// Decodes up to pairs bytes from 2 * pairs characters and, like Node, stops at the first pair
+// that is not two hex digits. Returns the number of bytes written.
+template <typename Char>
+inline size_t decode(const Char* p_src, size_t pairs, uint8_t* p_dst) {
+    size_t o = 0;
+    if constexpr (sizeof(Char) == 1) {
+#if defined(Z8_SIMD_X64)
+        int32_t level = simd::level();
+        if (level >= simd::LEVEL_AVX2)
+            o = decodeAvx2(p_src, pairs, p_dst);
+        if (level >= simd::LEVEL_SSE41)
+            o += decodeSse41(p_src + 2 * o, pairs - o, p_dst + o);
+#elif defined(Z8_SIMD_NEON)
+        o = decodeNeon(p_src, pairs, p_dst);
+#endif
+    }
+    for (; o < pairs; o++) {
+        uint32_t hi_char = static_cast<uint32_t>(p_src[2 * o]);
+        uint32_t lo_char = static_cast<uint32_t>(p_src[2 * o + 1]);
+        uint8_t hi = hi_char < 256 ? DECODE_TABLE[hi_char] : INVALID;
+        uint8_t lo = lo_char < 256 ? DECODE_TABLE[lo_char] : INVALID;
+        if (hi == INVALID || lo == INVALID)
+            break;
+        p_dst[o] = static_cast<uint8_t>((hi << 4) | lo);
+    }
+    return o;
+}
+
+} // namespace hex
+} // namespace z8
+
+#endif
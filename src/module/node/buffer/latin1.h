@@ -0,0 +1,125 @@
+#ifndef Z8_MODULE_BUFFER_LATIN1_H
+#define Z8_MODULE_BUFFER_LATIN1_H
+
+#include "simd.h"
+#include <cstddef>
+#include <cstdint>
+
+// Latin-1 <-> UTF-16LE transcoding for the latin1/binary/ascii and ucs2/utf16le encodings.
+// Widening interleaves zero bytes, narrowing keeps the low byte of each code unit (what Node
+// writes for characters above U+00FF). SSE2 is part of the x64 baseline and needs no target
+// attribute; its loops still honour Z8_SIMD=scalar. UTF-16 is stored little-endian, as on
+// every target Z8 builds for.
+namespace z8 {
+namespace latin1 {
+
+#if defined(Z8_SIMD_X64)
+Z8_TARGET_AVX2 inline size_t widenAvx2(const uint8_t* p_src, size_t length, uint8_t* p_dst) {
+    size_t i = 0;
+    for (; length - i >= 32; i += 32) {
+        __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p_src + i));
+        __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p_src + i + 16));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p_dst + 2 * i), _mm256_cvtepu8_epi16(lo));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p_dst + 2 * i + 32), _mm256_cvtepu8_epi16(hi));
+    }
+    return i;
+}
+
+inline size_t widenSse2(const uint8_t* p_src, size_t length, uint8_t* p_dst) {
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; length - i >= 16; i += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p_src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(p_dst + 2 * i), _mm_unpacklo_epi8(bytes, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(p_dst + 2 * i + 16), _mm_unpackhi_epi8(bytes, zero));
+    }
+    return i;
+}
+
+Z8_TARGET_AVX2 inline size_t narrowAvx2(const uint16_t* p_src, size_t length, uint8_t* p_dst) {
+    const __m256i low_byte = _mm256_set1_epi16(0x00FF);
+    size_t i = 0;
+    for (; length - i >= 32; i += 32) {
+        __m256i a = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p_src + i)), low_byte);
+        __m256i b = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p_src + i + 16)), low_byte);
+        __m256i bytes = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p_dst + i), bytes);
+    }
+    return i;
+}
+
+inline size_t narrowSse2(const uint16_t* p_src, size_t length, uint8_t* p_dst) {
+    const __m128i low_byte = _mm_set1_epi16(0x00FF);
+    size_t i = 0;
+    for (; length - i >= 16; i += 16) {
+        __m128i a = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p_src + i)), low_byte);
+        __m128i b = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p_src + i + 8)), low_byte);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(p_dst + i), _mm_packus_epi16(a, b));
+    }
+    return i;
+}
+#elif defined(Z8_SIMD_NEON)
+inline size_t widenNeon(const uint8_t* p_src, size_t length, uint8_t* p_dst) {
+    size_t i = 0;
+    for (; length - i >= 16; i += 16) {
+        uint8x16x2_t units;
+        units.val[0] = vld1q_u8(p_src + i);
+        units.val[1] = vdupq_n_u8(0);
+        vst2q_u8(p_dst + 2 * i, units);
+    }
+    return i;
+}
+
+inline size_t narrowNeon(const uint16_t* p_src, size_t length, uint8_t* p_dst) {
+    size_t i = 0;
+    for (; length - i >= 16; i += 16) {
+        uint8x16x2_t units = vld2q_u8(reinterpret_cast<const uint8_t*>(p_src + i));
+        vst1q_u8(p_dst + i, units.val[0]);
+    }
+    return i;
+}
+#endif
+
+// Writes length Latin-1 characters as 2 * length bytes of UTF-16LE.
+inline void widen(const uint8_t* p_src, size_t length, uint8_t* p_dst) {
+    size_t i = 0;
+#if defined(Z8_SIMD_X64)
+    if (simd::level() >= simd::LEVEL_AVX2)
+        i = widenAvx2(p_src, length, p_dst);
+    if (simd::level() >= simd::LEVEL_SSE41)
+        i += widenSse2(p_src + i, length - i, p_dst + 2 * i);
+#elif defined(Z8_SIMD_NEON)
+    i = widenNeon(p_src, length, p_dst);
+#endif
+    for (; i < length; i++) {
+        p_dst[2 * i] = p_src[i];
+        p_dst[2 * i + 1] = 0;
+    }
+}
+
+// Writes the low byte of each of length code units.
+inline void narrow(const uint16_t* p_src, size_t length, uint8_t* p_dst) {
+    size_t i = 0;
+#if defined(Z8_SIMD_X64)
+    if (simd::level() >= simd::LEVEL_AVX2)
+        i = narrowAvx2(p_src, length, p_dst);
+    if (simd::level() >= simd::LEVEL_SSE41)
+        i += narrowSse2(p_src + i, length - i, p_dst + i);
+#elif defined(Z8_SIMD_NEON)
+    i = narrowNeon(p_src, length, p_dst);
+#endif
+    for (; i < length; i++)
+        p_dst[i] = static_cast<uint8_t>(p_src[i]);
+}
+
+// Buffer#toString('ascii'): Latin-1 with the high bit of every byte cleared. Plain enough for
+// the compiler to vectorize.
+inline void stripHighBit(const uint8_t* p_src, size_t length, char* p_dst) {
+    for (size_t i = 0; i < length; i++)
+        p_dst[i] = static_cast<char>(p_src[i] & 0x7F);
+}
+
+} // namespace latin1
+} // namespace z8
+
+#endif
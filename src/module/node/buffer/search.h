@@ -0,0 +1,347 @@
+#ifndef Z8_MODULE_BUFFER_SEARCH_H
+#define Z8_MODULE_BUFFER_SEARCH_H
+
+#include "simd.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Byte-string search for Buffer#indexOf/lastIndexOf/includes. Single bytes go to memchr going
+// forward. Otherwise the vector kernels compare a block of candidate positions against the
+// needle's first and last bytes at once and memcmp only the survivors (Mula's "SIMD-friendly
+// algorithms for substring searching"). When survivors keep failing, as with periodic text,
+// the rest of the haystack goes to the Two-Way algorithm (Crochemore and Perrin), which is
+// linear in the worst case. Short remainders are compared directly.
+namespace z8 {
+namespace search {
+
+// Kernels give up once they have verified this many candidates plus one per 8 bytes scanned.
+static constexpr size_t GIVE_UP_MIN = 64;
+// At most this many candidate positions are compared directly rather than with Two-Way.
+static constexpr size_t DIRECT_MAX = 64;
+
+// True when a candidate whose first and last bytes match also matches in between.
+inline bool matchesMiddle(const uint8_t* p_candidate, const uint8_t* p_needle, size_t needle_length) {
+    return needle_length <= 2 || std::memcmp(p_candidate + 1, p_needle + 1, needle_length - 2) == 0;
+}
+
+// Forward kernels test candidates from pos upwards, reverse kernels those below end, a block at
+// a time. Both return a match or -1 and leave pos/end at the first candidate not yet tested.
+#if defined(Z8_SIMD_X64)
+Z8_TARGET_AVX2 inline int64_t findAvx2(const uint8_t* p_hay,
+                                       size_t length,
+                                       const uint8_t* p_needle,
+                                       size_t needle_length,
+                                       size_t& pos) {
+    const __m256i first = _mm256_set1_epi8(static_cast<char>(p_needle[0]));
+    const __m256i last = _mm256_set1_epi8(static_cast<char>(p_needle[needle_length - 1]));
+    size_t start = pos;
+    size_t verified = 0;
+    while (length - pos >= needle_length - 1 + 32) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p_hay + pos));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p_hay + pos + needle_length - 1));
+        __m256i hits = _mm256_and_si256(_mm256_cmpeq_epi8(a, first), _mm256_cmpeq_epi8(b, last));
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(hits));
+        for (; mask != 0; mask &= mask - 1, verified++) {
+            size_t candidate = pos + simd::lowestBit(mask);
+            if (matchesMiddle(p_hay + candidate, p_needle, needle_length))
+                return static_cast<int64_t>(candidate);
+        }
+        pos += 32;
+        if (verified > GIVE_UP_MIN + ((pos - start) >> 3))
+            break;
+    }
+    return -1;
+}
+
+inline int64_t findSse2(const uint8_t* p_hay, size_t length, const uint8_t* p_needle, size_t needle_length, size_t& pos) {
+    const __m128i first = _mm_set1_epi8(static_cast<char>(p_needle[0]));
+    const __m128i last = _mm_set1_epi8(static_cast<char>(p_needle[needle_length - 1]));
+    size_t start = pos;
+    size_t verified = 0;
+    while (length - pos >= needle_length - 1 + 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p_hay + pos));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p_hay + pos + needle_length - 1));
+        uint32_t mask = static_cast<uint32_t>(
+            _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last))));
+        for (; mask != 0; mask &= mask - 1, verified++) {
+            size_t candidate = pos + simd::lowestBit(mask);
+            if (matchesMiddle(p_hay + candidate, p_needle, needle_length))
+                return static_cast<int64_t>(candidate);
+        }
+        pos += 16;
+        if (verified > GIVE_UP_MIN + ((pos - start) >> 3))
+            break;
+    }
+    return -1;
+}
+
+Z8_TARGET_AVX2 inline int64_t findLastAvx2(const uint8_t* p_hay,
+                                           const uint8_t* p_needle,
+                                           size_t needle_length,
+                                           size_t& end) {
+    const __m256i first = _mm256_set1_epi8(static_cast<char>(p_needle[0]));
+    const __m256i last = _mm256_set1_epi8(static_cast<char>(p_needle[needle_length - 1]));
+    size_t start = end;
+    size_t verified = 0;
+    while (end >= 32) {
+        const uint8_t* p_block = p_hay + end - 32;
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p_block));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p_block + needle_length - 1));
+        __m256i hits = _mm256_and_si256(_mm256_cmpeq_epi8(a, first), _mm256_cmpeq_epi8(b, last));
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(hits));
+        for (; mask != 0; verified++) {
+            uint32_t bit = simd::highestBit(mask);
+            if (matchesMiddle(p_block + bit, p_needle, needle_length))
+                return static_cast<int64_t>(end - 32 + bit);
+            mask &= ~(1u << bit);
+        }
+        end -= 32;
+        if (verified > GIVE_UP_MIN + ((start - end) >> 3))
+            break;
+    }
+    return -1;
+}
+
+inline int64_t findLastSse2(const uint8_t* p_hay, const uint8_t* p_needle, size_t needle_length, size_t& end) {
+    const __m128i first = _mm_set1_epi8(static_cast<char>(p_needle[0]));
+    const __m128i last = _mm_set1_epi8(static_cast<char>(p_needle[needle_length - 1]));
+    size_t start = end;
+    size_t verified = 0;
+    while (end >= 16) {
+        const uint8_t* p_block = p_hay + end - 16;
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p_block));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p_block + needle_length - 1));
+        uint32_t mask = static_cast<uint32_t>(
+            _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last))));
+        for (; mask != 0; verified++) {
+            uint32_t bit = simd::highestBit(mask);
+            if (matchesMiddle(p_block + bit, p_needle, needle_length))
+                return static_cast<int64_t>(end - 16 + bit);
+            mask &= ~(1u << bit);
+        }
+        end -= 16;
+        if (verified > GIVE_UP_MIN + ((start - end) >> 3))
+            break;
+    }
+    return -1;
+}
+#elif defined(Z8_SIMD_NEON)
+// NEON has no movemask: narrowing the comparison leaves four mask bits per byte.
+inline uint64_t hitMaskNeon(const uint8_t* p_block, size_t needle_length, uint8x16_t first, uint8x16_t last) {
+    uint8x16_t hits = vandq_u8(vceqq_u8(vld1q_u8(p_block), first), vceqq_u8(vld1q_u8(p_block + needle_length - 1), last));
+    return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(hits), 4)), 0);
+}
+
+inline int64_t findNeon(const uint8_t* p_hay, size_t length, const uint8_t* p_needle, size_t needle_length, size_t& pos) {
+    const uint8x16_t first = vdupq_n_u8(p_needle[0]);
+    const uint8x16_t last = vdupq_n_u8(p_needle[needle_length - 1]);
+    size_t start = pos;
+    size_t verified = 0;
+    while (length - pos >= needle_length - 1 + 16) {
+        uint64_t mask = hitMaskNeon(p_hay + pos, needle_length, first, last);
+        for (; mask != 0; verified++) {
+            uint32_t bit = simd::lowestBit(mask) & ~3u;
+            size_t candidate = pos + bit / 4;
+            if (matchesMiddle(p_hay + candidate, p_needle, needle_length))
+                return static_cast<int64_t>(candidate);
+            mask &= ~(0xFull << bit);
+        }
+        pos += 16;
+        if (verified > GIVE_UP_MIN + ((pos - start) >> 3))
+            break;
+    }
+    return -1;
+}
+
+inline int64_t findLastNeon(const uint8_t* p_hay, const uint8_t* p_needle, size_t needle_length, size_t& end) {
+    const uint8x16_t first = vdupq_n_u8(p_needle[0]);
+    const uint8x16_t last = vdupq_n_u8(p_needle[needle_length - 1]);
+    size_t start = end;
+    size_t verified = 0;
+    while (end >= 16) {
+        const uint8_t* p_block = p_hay + end - 16;
+        uint64_t mask = hitMaskNeon(p_block, needle_length, first, last);
+        for (; mask != 0; verified++) {
+            uint32_t bit = simd::highestBit(mask) & ~3u;
+            if (matchesMiddle(p_block + bit / 4, p_needle, needle_length))
+                return static_cast<int64_t>(end - 16 + bit / 4);
+            mask &= ~(0xFull << bit);
+        }
+        end -= 16;
+        if (verified > GIVE_UP_MIN + ((start - end) >> 3))
+            break;
+    }
+    return -1;
+}
+#endif
+
+// A string read front to back, or back to front when Reverse: the last match of a needle is the
+// first match of the reversed needle in the reversed haystack.
+template <bool Reverse>
+struct Bytes {
+    const uint8_t* p_data;
+    size_t m_length;
+
+    uint8_t operator[](size_t i) const {
+        return Reverse ? p_data[m_length - 1 - i] : p_data[i];
+    }
+};
+
+// Start of the maximal suffix of needle under byte order (or its inverse), minus one, and that
+// suffix's period.
+template <bool Reverse>
+inline int64_t maximalSuffix(const Bytes<Reverse>& needle, bool inverted, size_t& period) {
+    int64_t suffix = -1;
+    size_t j = 0;
+    size_t k = 1;
+    period = 1;
+    while (j + k < needle.m_length) {
+        uint8_t a = needle[static_cast<size_t>(suffix + static_cast<int64_t>(k))];
+        uint8_t b = needle[j + k];
+        if (a == b) {
+            if (k == period) {
+                j += period;
+                k = 1;
+            } else {
+                k++;
+            }
+        } else if (inverted ? a < b : a > b) {
+            j += k;
+            k = 1;
+            period = static_cast<size_t>(static_cast<int64_t>(j) - suffix);
+        } else {
+            suffix = static_cast<int64_t>(j++);
+            k = 1;
+            period = 1;
+        }
+    }
+    return suffix;
+}
+
+// First match of needle in hay, or -1. Linear time, constant space.
+template <bool Reverse>
+inline int64_t twoWay(const Bytes<Reverse>& hay, const Bytes<Reverse>& needle) {
+    size_t needle_length = needle.m_length;
+    size_t period = 0;
+    size_t inverted_period = 0;
+    int64_t suffix = maximalSuffix(needle, false, period);
+    int64_t inverted_suffix = maximalSuffix(needle, true, inverted_period);
+    if (inverted_suffix > suffix) {
+        suffix = inverted_suffix;
+        period = inverted_period;
+    }
+    size_t split = static_cast<size_t>(suffix + 1);
+
+    // A periodic needle remembers how much of its prefix already matched after a shift.
+    bool periodic = true;
+    for (size_t i = 0; i < split && periodic; i++)
+        periodic = needle[i] == needle[i + period];
+    size_t memory_after_shift = 0;
+    if (periodic)
+        memory_after_shift = needle_length - period;
+    else
+        period = std::max(split, needle_length - split) + 1;
+
+    // Skips by the last occurrence of the haystack byte under the needle's end.
+    size_t shift[256] = {};
+    for (size_t i = 0; i < needle_length; i++)
+        shift[needle[i]] = i + 1;
+
+    size_t memory = 0;
+    size_t pos = 0;
+    while (hay.m_length - pos >= needle_length) {
+        size_t skip = needle_length - shift[hay[pos + needle_length - 1]];
+        if (skip != 0) {
+            pos += std::max(skip, memory);
+            memory = 0;
+            continue;
+        }
+        size_t k = std::max(split, memory);
+        while (k < needle_length && needle[k] == hay[pos + k])
+            k++;
+        if (k < needle_length) {
+            pos += k - split + 1;
+            memory = 0;
+            continue;
+        }
+        k = split;
+        while (k > memory && needle[k - 1] == hay[pos + k - 1])
+            k--;
+        if (k <= memory)
+            return static_cast<int64_t>(pos);
+        pos += period;
+        memory = memory_after_shift;
+    }
+    return -1;
+}
+
+// First match at or after from, or -1. Needs 1 <= needle_length and from + needle_length <= length.
+inline int64_t find(const uint8_t* p_hay, size_t length, const uint8_t* p_needle, size_t needle_length, size_t from) {
+    if (needle_length == 1) {
+        const void* p_hit = std::memchr(p_hay + from, p_needle[0], length - from);
+        return p_hit ? static_cast<const uint8_t*>(p_hit) - p_hay : -1;
+    }
+    size_t pos = from;
+    int64_t found = -1;
+#if defined(Z8_SIMD_X64)
+    if (simd::level() >= simd::LEVEL_AVX2)
+        found = findAvx2(p_hay, length, p_needle, needle_length, pos);
+    if (found < 0 && simd::level() >= simd::LEVEL_SSE41)
+        found = findSse2(p_hay, length, p_needle, needle_length, pos);
+#elif defined(Z8_SIMD_NEON)
+    found = findNeon(p_hay, length, p_needle, needle_length, pos);
+#endif
+    if (found >= 0)
+        return found;
+    if (length - needle_length + 1 - pos <= DIRECT_MAX) {
+        for (; pos + needle_length <= length; pos++) {
+            if (std::memcmp(p_hay + pos, p_needle, needle_length) == 0)
+                return static_cast<int64_t>(pos);
+        }
+        return -1;
+    }
+    int64_t hit = twoWay(Bytes<false>{p_hay + pos, length - pos}, Bytes<false>{p_needle, needle_length});
+    return hit < 0 ? -1 : static_cast<int64_t>(pos) + hit;
+}
+
+// Last match starting at or before from, or -1. Needs 1 <= needle_length <= length.
+inline int64_t findLast(const uint8_t* p_hay,
+                        size_t length,
+                        const uint8_t* p_needle,
+                        size_t needle_length,
+                        size_t from) {
+    size_t end = std::min(from, length - needle_length) + 1;
+    int64_t found = -1;
+#if defined(Z8_SIMD_X64)
+    if (simd::level() >= simd::LEVEL_AVX2)
+        found = findLastAvx2(p_hay, p_needle, needle_length, end);
+    if (found < 0 && simd::level() >= simd::LEVEL_SSE41)
+        found = findLastSse2(p_hay, p_needle, needle_length, end);
+#elif defined(Z8_SIMD_NEON)
+    found = findLastNeon(p_hay, p_needle, needle_length, end);
+#endif
+    if (found >= 0)
+        return found;
+    if (needle_length == 1) {
+        while (end > 0 && p_hay[end - 1] != p_needle[0])
+            end--;
+        return static_cast<int64_t>(end) - 1;
+    }
+    if (end <= DIRECT_MAX) {
+        while (end > 0) {
+            end--;
+            if (std::memcmp(p_hay + end, p_needle, needle_length) == 0)
+                return static_cast<int64_t>(end);
+        }
+        return -1;
+    }
+    int64_t hit = twoWay(Bytes<true>{p_hay, end + needle_length - 1}, Bytes<true>{p_needle, needle_length});
+    return hit < 0 ? -1 : static_cast<int64_t>(end) - 1 - hit;
+}
+
+} // namespace search
+} // namespace z8
+
+#endif
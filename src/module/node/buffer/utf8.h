@@ -0,0 +1,419 @@
+#ifndef Z8_MODULE_BUFFER_UTF8_H
+#define Z8_MODULE_BUFFER_UTF8_H
+
+#include "simd.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// UTF-8 helpers for strings entering and leaving native code. V8 keeps most strings as one-byte
+// (Latin-1) contents, which encode to UTF-8 without V8's help: ASCII runs are copied as they
+// are and every other character becomes two bytes. The ASCII scans are vectorized; SSE2 is part
+// of the x64 baseline, its loops still honour Z8_SIMD=scalar.
+namespace z8 {
+namespace utf8 {
+
+#if defined(Z8_SIMD_X64)
+Z8_TARGET_AVX2 inline size_t asciiPrefixAvx2(const uint8_t* p_src, size_t length) {
+    size_t i = 0;
+    for (; length - i >= 64; i += 64) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p_src + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p_src + i + 32));
+        if (_mm256_movemask_epi8(_mm256_or_si256(a, b)) != 0)
+            break;
+    }
+    return i;
+}
+
+inline size_t asciiPrefixSse2(const uint8_t* p_src, size_t length) {
+    size_t i = 0;
+    for (; length - i >= 32; i += 32) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p_src + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p_src + i + 16));
+        if (_mm_movemask_epi8(_mm_or_si128(a, b)) != 0)
+            break;
+    }
+    return i;
+}
+#elif defined(Z8_SIMD_NEON)
+inline size_t asciiPrefixNeon(const uint8_t* p_src, size_t length) {
+    size_t i = 0;
+    for (; length - i >= 32; i += 32) {
+        uint8x16_t bytes = vorrq_u8(vld1q_u8(p_src + i), vld1q_u8(p_src + i + 16));
+        if (vmaxvq_u8(bytes) >= 0x80)
+            break;
+    }
+    return i;
+}
+#endif
+
+// Length of the run of ASCII bytes that p_src starts with.
+inline size_t asciiPrefix(const uint8_t* p_src, size_t length) {
+    size_t i = 0;
+#if defined(Z8_SIMD_X64)
+    if (simd::level() >= simd::LEVEL_AVX2)
+        i = asciiPrefixAvx2(p_src, length);
+    if (simd::level() >= simd::LEVEL_SSE41)
+        i += asciiPrefixSse2(p_src + i, length - i);
+#elif defined(Z8_SIMD_NEON)
+    i = asciiPrefixNeon(p_src, length);
+#endif
+    while (i < length && p_src[i] < 0x80)
+        i++;
+    return i;
+}
+
+inline bool isAscii(const uint8_t* p_src, size_t length) {
+    return asciiPrefix(p_src, length) == length;
+}
+
+// Strict UTF-8 validation (as Node's isUtf8): no overlong forms, surrogates, code points above
+// U+10FFFF or cut-off sequences. The vector kernels classify each byte pair with three 16-entry
+// tables indexed by nibbles (Keiser and Lemire, "Validating UTF-8 In Less Than One Instruction
+// Per Byte"); a bit survives the AND of the three lookups only for an invalid pair, and the
+// bytes that must continue a three- or four-byte lead are checked against the 0x80 bit. Blocks
+// of ASCII only check that the previous block did not end inside a character.
+static constexpr uint8_t TOO_SHORT = 1 << 0;
+static constexpr uint8_t TOO_LONG = 1 << 1;
+static constexpr uint8_t OVERLONG_3 = 1 << 2;
+static constexpr uint8_t TOO_LARGE = 1 << 3;
+static constexpr uint8_t SURROGATE = 1 << 4;
+static constexpr uint8_t OVERLONG_2 = 1 << 5;
+static constexpr uint8_t TOO_LARGE_1000 = 1 << 6;
+static constexpr uint8_t OVERLONG_4 = 1 << 6;
+static constexpr uint8_t TWO_CONTS = 1 << 7;
+static constexpr uint8_t CARRY = TOO_SHORT | TOO_LONG | TWO_CONTS;
+
+// Indexed by the high nibble of the first byte of a pair.
+alignas(16) static constexpr uint8_t BYTE_1_HIGH[16] = {
+    TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+    TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+    TOO_SHORT | OVERLONG_2,
+    TOO_SHORT,
+    TOO_SHORT | OVERLONG_3 | SURROGATE,
+    TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4,
+};
+
+// Indexed by the low nibble of the first byte.
+alignas(16) static constexpr uint8_t BYTE_1_LOW[16] = {
+    CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4,
+    CARRY | OVERLONG_2,
+    CARRY,
+    CARRY,
+    CARRY | TOO_LARGE,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+};
+
+// Indexed by the high nibble of the second byte.
+alignas(16) static constexpr uint8_t BYTE_2_HIGH[16] = {
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+};
+
+// Subtracted (saturating) from a block: non-zero where a lead byte in the last three positions
+// starts a character the block does not finish. SSE and NEON use the last 16 entries.
+alignas(32) static constexpr uint8_t INCOMPLETE_MAX[32] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xEF, 0xDF, 0xBF,
+};
+
+#if defined(Z8_SIMD_X64)
+// Kernels validate whole blocks, setting valid, and return how many bytes they covered. The
+// last character may run past that; the caller resumes at its lead byte.
+Z8_TARGET_AVX2 inline size_t validateAvx2(const uint8_t* p_src, size_t length, bool& valid) {
+    const __m256i byte_1_high =
+        _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(BYTE_1_HIGH)));
+    const __m256i byte_1_low =
+        _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(BYTE_1_LOW)));
+    const __m256i byte_2_high =
+        _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(BYTE_2_HIGH)));
+    const __m256i incomplete_max = _mm256_load_si256(reinterpret_cast<const __m256i*>(INCOMPLETE_MAX));
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    const __m256i third_min = _mm256_set1_epi8(static_cast<char>(0xE0 - 0x80));
+    const __m256i fourth_min = _mm256_set1_epi8(static_cast<char>(0xF0 - 0x80));
+    const __m256i high_bit = _mm256_set1_epi8(static_cast<char>(0x80));
+    __m256i prev_input = _mm256_setzero_si256();
+    __m256i prev_incomplete = _mm256_setzero_si256();
+    __m256i error = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; length - i >= 32; i += 32) {
+        __m256i input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p_src + i));
+        if (_mm256_movemask_epi8(input) == 0) {
+            error = _mm256_or_si256(error, prev_incomplete);
+            prev_input = input;
+            continue;
+        }
+        __m256i shifted = _mm256_permute2x128_si256(prev_input, input, 0x21);
+        __m256i prev1 = _mm256_alignr_epi8(input, shifted, 15);
+        __m256i prev2 = _mm256_alignr_epi8(input, shifted, 14);
+        __m256i prev3 = _mm256_alignr_epi8(input, shifted, 13);
+        __m256i special = _mm256_and_si256(
+            _mm256_and_si256(_mm256_shuffle_epi8(byte_1_high, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble)),
+                             _mm256_shuffle_epi8(byte_1_low, _mm256_and_si256(prev1, nibble))),
+            _mm256_shuffle_epi8(byte_2_high, _mm256_and_si256(_mm256_srli_epi16(input, 4), nibble)));
+        __m256i must23 = _mm256_or_si256(_mm256_subs_epu8(prev2, third_min), _mm256_subs_epu8(prev3, fourth_min));
+        error = _mm256_or_si256(error, _mm256_xor_si256(_mm256_and_si256(must23, high_bit), special));
+        prev_incomplete = _mm256_subs_epu8(input, incomplete_max);
+        prev_input = input;
+    }
+    valid = _mm256_testz_si256(error, error) != 0;
+    return i;
+}
+
+Z8_TARGET_SSE41 inline size_t validateSse41(const uint8_t* p_src, size_t length, bool& valid) {
+    const __m128i byte_1_high = _mm_load_si128(reinterpret_cast<const __m128i*>(BYTE_1_HIGH));
+    const __m128i byte_1_low = _mm_load_si128(reinterpret_cast<const __m128i*>(BYTE_1_LOW));
+    const __m128i byte_2_high = _mm_load_si128(reinterpret_cast<const __m128i*>(BYTE_2_HIGH));
+    const __m128i incomplete_max = _mm_load_si128(reinterpret_cast<const __m128i*>(INCOMPLETE_MAX + 16));
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    const __m128i third_min = _mm_set1_epi8(static_cast<char>(0xE0 - 0x80));
+    const __m128i fourth_min = _mm_set1_epi8(static_cast<char>(0xF0 - 0x80));
+    const __m128i high_bit = _mm_set1_epi8(static_cast<char>(0x80));
+    __m128i prev_input = _mm_setzero_si128();
+    __m128i prev_incomplete = _mm_setzero_si128();
+    __m128i error = _mm_setzero_si128();
+    size_t i = 0;
+    for (; length - i >= 16; i += 16) {
+        __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p_src + i));
+        if (_mm_movemask_epi8(input) == 0) {
+            error = _mm_or_si128(error, prev_incomplete);
+            prev_input = input;
+            continue;
+        }
+        __m128i prev1 = _mm_alignr_epi8(input, prev_input, 15);
+        __m128i prev2 = _mm_alignr_epi8(input, prev_input, 14);
+        __m128i prev3 = _mm_alignr_epi8(input, prev_input, 13);
+        __m128i special = _mm_and_si128(
+            _mm_and_si128(_mm_shuffle_epi8(byte_1_high, _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble)),
+                          _mm_shuffle_epi8(byte_1_low, _mm_and_si128(prev1, nibble))),
+            _mm_shuffle_epi8(byte_2_high, _mm_and_si128(_mm_srli_epi16(input, 4), nibble)));
+        __m128i must23 = _mm_or_si128(_mm_subs_epu8(prev2, third_min), _mm_subs_epu8(prev3, fourth_min));
+        error = _mm_or_si128(error, _mm_xor_si128(_mm_and_si128(must23, high_bit), special));
+        prev_incomplete = _mm_subs_epu8(input, incomplete_max);
+        prev_input = input;
+    }
+    valid = _mm_testz_si128(error, error) != 0;
+    return i;
+}
+#elif defined(Z8_SIMD_NEON)
+inline size_t validateNeon(const uint8_t* p_src, size_t length, bool& valid) {
+    const uint8x16_t byte_1_high = vld1q_u8(BYTE_1_HIGH);
+    const uint8x16_t byte_1_low = vld1q_u8(BYTE_1_LOW);
+    const uint8x16_t byte_2_high = vld1q_u8(BYTE_2_HIGH);
+    const uint8x16_t incomplete_max = vld1q_u8(INCOMPLETE_MAX + 16);
+    const uint8x16_t nibble = vdupq_n_u8(0x0F);
+    const uint8x16_t third_min = vdupq_n_u8(0xE0 - 0x80);
+    const uint8x16_t fourth_min = vdupq_n_u8(0xF0 - 0x80);
+    uint8x16_t prev_input = vdupq_n_u8(0);
+    uint8x16_t prev_incomplete = vdupq_n_u8(0);
+    uint8x16_t error = vdupq_n_u8(0);
+    size_t i = 0;
+    for (; length - i >= 16; i += 16) {
+        uint8x16_t input = vld1q_u8(p_src + i);
+        if (vmaxvq_u8(input) < 0x80) {
+            error = vorrq_u8(error, prev_incomplete);
+            prev_input = input;
+            continue;
+        }
+        uint8x16_t prev1 = vextq_u8(prev_input, input, 15);
+        uint8x16_t prev2 = vextq_u8(prev_input, input, 14);
+        uint8x16_t prev3 = vextq_u8(prev_input, input, 13);
+        uint8x16_t special = vandq_u8(vandq_u8(vqtbl1q_u8(byte_1_high, vshrq_n_u8(prev1, 4)),
+                                               vqtbl1q_u8(byte_1_low, vandq_u8(prev1, nibble))),
+                                      vqtbl1q_u8(byte_2_high, vshrq_n_u8(input, 4)));
+        uint8x16_t must23 = vorrq_u8(vqsubq_u8(prev2, third_min), vqsubq_u8(prev3, fourth_min));
+        error = vorrq_u8(error, veorq_u8(vandq_u8(must23, vdupq_n_u8(0x80)), special));
+        prev_incomplete = vqsubq_u8(input, incomplete_max);
+        prev_input = input;
+    }
+    valid = vmaxvq_u8(error) == 0;
+    return i;
+}
+#endif
+
+// Where to resume after the first length bytes were validated: the lead byte of a character
+// they cut off, otherwise length.
+inline size_t resumePoint(const uint8_t* p_src, size_t length) {
+    for (size_t back = 1; back <= 3 && back <= length; back++) {
+        uint8_t c = p_src[length - back];
+        if (c < 0x80)
+            break;
+        if (c >= 0xC0) {
+            size_t size = c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : 2;
+            return size > back ? length - back : length;
+        }
+    }
+    return length;
+}
+
+inline bool validateScalar(const uint8_t* p_src, size_t length) {
+    size_t i = 0;
+    while (i < length) {
+        uint8_t c = p_src[i];
+        if (c < 0x80) {
+            i++;
+            continue;
+        }
+        size_t tail = 0;
+        uint8_t min = 0x80;
+        uint8_t max = 0xBF;
+        if (c >= 0xC2 && c <= 0xDF) {
+            tail = 1;
+        } else if (c >= 0xE0 && c <= 0xEF) {
+            tail = 2;
+            min = c == 0xE0 ? 0xA0 : 0x80;
+            max = c == 0xED ? 0x9F : 0xBF;
+        } else if (c >= 0xF0 && c <= 0xF4) {
+            tail = 3;
+            min = c == 0xF0 ? 0x90 : 0x80;
+            max = c == 0xF4 ? 0x8F : 0xBF;
+        } else {
+            return false;
+        }
+        if (length - i <= tail || p_src[i + 1] < min || p_src[i + 1] > max)
+            return false;
+        for (size_t k = 2; k <= tail; k++) {
+            if ((p_src[i + k] & 0xC0) != 0x80)
+                return false;
+        }
+        i += tail + 1;
+    }
+    return true;
+}
+
+// True when the length bytes at p_src are well-formed UTF-8.
+inline bool validate(const uint8_t* p_src, size_t length) {
+    size_t i = asciiPrefix(p_src, length);
+    bool valid = true;
+#if defined(Z8_SIMD_X64)
+    if (simd::level() >= simd::LEVEL_AVX2) {
+        i += resumePoint(p_src + i, validateAvx2(p_src + i, length - i, valid));
+        if (!valid)
+            return false;
+    }
+    if (simd::level() >= simd::LEVEL_SSE41) {
+        i += resumePoint(p_src + i, validateSse41(p_src + i, length - i, valid));
+        if (!valid)
+            return false;
+    }
+#elif defined(Z8_SIMD_NEON)
+    i += resumePoint(p_src + i, validateNeon(p_src + i, length - i, valid));
+    if (!valid)
+        return false;
+#endif
+    return validateScalar(p_src + i, length - i);
+}
+
+// Decodes valid UTF-8 to Latin-1 at p_dst, setting written. False, with p_dst partly written, at
+// the first character above U+00FF.
+inline bool toLatin1(const uint8_t* p_src, size_t length, uint8_t* p_dst, size_t& written) {
+    size_t i = 0;
+    written = 0;
+    while (i < length) {
+        size_t run = asciiPrefix(p_src + i, length - i);
+        std::memcpy(p_dst + written, p_src + i, run);
+        i += run;
+        written += run;
+        if (i == length)
+            break;
+        if (p_src[i] > 0xC3)
+            return false;
+        p_dst[written++] = static_cast<uint8_t>((p_src[i] << 6) | (p_src[i + 1] & 0x3F));
+        i += 2;
+    }
+    return true;
+}
+
+// UTF-8 size of length Latin-1 characters: one byte each, two from U+0080 up.
+inline size_t latin1Length(const uint8_t* p_src, size_t length) {
+    size_t size = length;
+    for (size_t i = asciiPrefix(p_src, length); i < length; i++)
+        size += p_src[i] >> 7;
+    return size;
+}
+
+// Encodes length Latin-1 characters as UTF-8 into at most max_length bytes at p_dst, whole
+// characters only, and returns how many bytes it wrote; read is how many characters that took.
+inline size_t fromLatin1(const uint8_t* p_src, size_t length, uint8_t* p_dst, size_t max_length, size_t& read) {
+    size_t i = 0;
+    size_t out = 0;
+    while (i < length && out < max_length) {
+        size_t run = asciiPrefix(p_src + i, std::min(length - i, max_length - out));
+        std::memcpy(p_dst + out, p_src + i, run);
+        i += run;
+        out += run;
+        if (i == length || out == max_length || max_length - out < 2)
+            break;
+        uint8_t c = p_src[i++];
+        p_dst[out++] = static_cast<uint8_t>(0xC0 | (c >> 6));
+        p_dst[out++] = static_cast<uint8_t>(0x80 | (c & 0x3F));
+    }
+    read = i;
+    return out;
+}
+
+inline size_t fromLatin1(const uint8_t* p_src, size_t length, uint8_t* p_dst, size_t max_length) {
+    size_t read = 0;
+    return fromLatin1(p_src, length, p_dst, max_length, read);
+}
+
+// Bytes in the character a lead byte starts: 1 to 4, 0 for a byte no character starts with.
+inline size_t sequenceLength(uint8_t lead) {
+    if (lead < 0x80)
+        return 1;
+    if (lead >= 0xC2 && lead <= 0xDF)
+        return 2;
+    if (lead >= 0xE0 && lead <= 0xEF)
+        return 3;
+    if (lead >= 0xF0 && lead <= 0xF4)
+        return 4;
+    return 0;
+}
+
+// Whether c may follow the index - 1 bytes of a character starting with lead. The second byte
+// has the narrower ranges that exclude overlongs, surrogates and code points above U+10FFFF.
+inline bool continues(uint8_t lead, size_t index, uint8_t c) {
+    if (index > 1)
+        return (c & 0xC0) == 0x80;
+    uint8_t min = lead == 0xE0 ? 0xA0 : lead == 0xF0 ? 0x90 : 0x80;
+    uint8_t max = lead == 0xED ? 0x9F : lead == 0xF4 ? 0x8F : 0xBF;
+    return c >= min && c <= max;
+}
+
+// Length of the valid but unfinished character the length bytes at p_src end with, 0 if none:
+// what a streaming decoder holds back until the next chunk.
+inline size_t incompleteSuffix(const uint8_t* p_src, size_t length) {
+    for (size_t back = 1; back <= 3 && back <= length; back++) {
+        const uint8_t* p_lead = p_src + length - back;
+        if ((*p_lead & 0xC0) == 0x80)
+            continue;
+        if (sequenceLength(*p_lead) <= back)
+            return 0;
+        for (size_t k = 1; k < back; k++) {
+            if (!continues(*p_lead, k, p_lead[k]))
+                return 0;
+        }
+        return back;
+    }
+    return 0;
+}
+
+} // namespace utf8
+} // namespace z8
+
+#endif
@@ -1,14 +1,32 @@
 #include "fs.h"
 #include "../stream/stream.h"
 #include "../buffer/buffer.h"
+#include "../events/events.h"
+#include "../process/process.h"
+#include "../string_decoder/string_decoder.h"
 #include "../../adaptive_io.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
 #include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
 #include <fcntl.h> // For O_* constants
 #include <filesystem>
 #include <fstream>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
 #include <mutex>
+#include <set>
 #include <string>
 #include <sys/stat.h>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 #include <v8-isolate.h>
 #ifdef _WIN32
 #include <io.h>
@@ -57,8 +75,28 @@ static int64_t fs_pwrite(int32_t fd, const void* p_buf, size_t count, int64_t of
     return -1;
 }
 #else
+#include <dirent.h>
+#include <sys/resource.h>
+#include <sys/uio.h>
 #include <unistd.h>
+#ifdef __linux__
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/syscall.h>
+#include <sys/sysmacros.h>
 #endif
+
+static int64_t fs_pread(int32_t fd, void* p_buf, size_t count, int64_t offset) {
+    return ::pread(fd, p_buf, count, static_cast<off_t>(offset));
+}
+
+static int64_t fs_pwrite(int32_t fd, const void* p_buf, size_t count, int64_t offset) {
+    return ::pwrite(fd, p_buf, count, static_cast<off_t>(offset));
+}
+#endif
+#include "abort_signal.h"
+#include "io_ring.h"
 #include "task_queue.h"
 #include "thread_pool.h"
 #include <v8-promise.h>
@@ -72,34 +110,459 @@ namespace fs = std::filesystem;
 namespace z8 {
 namespace module {
 
+// Node's UV_DIRENT_* codes. Directory readers produce a packed array of these next to the
+// names, and Dirent objects are built from it without touching the disk again.
+static constexpr uint8_t DIRENT_UNKNOWN = 0;
+static constexpr uint8_t DIRENT_FILE = 1;
+static constexpr uint8_t DIRENT_DIR = 2;
+static constexpr uint8_t DIRENT_LINK = 3;
+static constexpr uint8_t DIRENT_FIFO = 4;
+static constexpr uint8_t DIRENT_SOCKET = 5;
+static constexpr uint8_t DIRENT_CHAR = 6;
+static constexpr uint8_t DIRENT_BLOCK = 7;
+
+static constexpr size_t DIR_DEFAULT_BUFFER_SIZE = 32;
+
+static uint8_t direntTypeOf(const fs::file_status& status) {
+    uint8_t type = DIRENT_UNKNOWN;
+    switch (status.type()) {
+    case fs::file_type::regular:
+        type = DIRENT_FILE;
+        break;
+    case fs::file_type::directory:
+        type = DIRENT_DIR;
+        break;
+    case fs::file_type::symlink:
+        type = DIRENT_LINK;
+        break;
+    case fs::file_type::fifo:
+        type = DIRENT_FIFO;
+        break;
+    case fs::file_type::socket:
+        type = DIRENT_SOCKET;
+        break;
+    case fs::file_type::character:
+        type = DIRENT_CHAR;
+        break;
+    case fs::file_type::block:
+        type = DIRENT_BLOCK;
+        break;
+    default:
+        break;
+    }
+    return type;
+}
+
+static std::string joinPath(const std::string& dir, const std::string& name) {
+    if (dir.empty())
+        return name;
+    if (dir.back() == '/' || dir.back() == '\\')
+        return dir + name;
+    return dir + static_cast<char>(fs::path::preferred_separator) + name;
+}
+
+#ifndef _WIN32
+static std::string errnoMessage(const char* p_op, const std::string& path) {
+    return std::error_code(errno, std::generic_category()).message() + ", " + p_op + " '" + path + "'";
+}
+
+static uint8_t direntTypeOfMode(mode_t mode) {
+    uint8_t type = DIRENT_UNKNOWN;
+    if (S_ISREG(mode))
+        type = DIRENT_FILE;
+    else if (S_ISDIR(mode))
+        type = DIRENT_DIR;
+    else if (S_ISLNK(mode))
+        type = DIRENT_LINK;
+    else if (S_ISFIFO(mode))
+        type = DIRENT_FIFO;
+    else if (S_ISSOCK(mode))
+        type = DIRENT_SOCKET;
+    else if (S_ISCHR(mode))
+        type = DIRENT_CHAR;
+    else if (S_ISBLK(mode))
+        type = DIRENT_BLOCK;
+    return type;
+}
+
+// d_type straight from the kernel; DT_UNKNOWN (XFS without ftype, many network mounts)
+// falls back to one fstatat relative to the directory fd.
+static uint8_t direntTypeOfDtype(uint8_t d_type, int32_t dir_fd, const char* p_name) {
+    uint8_t type = DIRENT_UNKNOWN;
+    switch (d_type) {
+    case DT_REG:
+        type = DIRENT_FILE;
+        break;
+    case DT_DIR:
+        type = DIRENT_DIR;
+        break;
+    case DT_LNK:
+        type = DIRENT_LINK;
+        break;
+    case DT_FIFO:
+        type = DIRENT_FIFO;
+        break;
+    case DT_SOCK:
+        type = DIRENT_SOCKET;
+        break;
+    case DT_CHR:
+        type = DIRENT_CHAR;
+        break;
+    case DT_BLK:
+        type = DIRENT_BLOCK;
+        break;
+    default: {
+        struct stat st;
+        if (fstatat(dir_fd, p_name, &st, AT_SYMLINK_NOFOLLOW) == 0)
+            type = direntTypeOfMode(st.st_mode);
+        break;
+    }
+    }
+    return type;
+}
+#endif
+
+// Directory reader shared by readdir, opendir and the rm/cp walker. On Linux it calls
+// getdents64 directly, so one syscall returns a whole buffer of entries with their types;
+// other POSIX systems go through readdir and Windows through std::filesystem.
+class DirStream {
+  public:
+    DirStream() = default;
+    DirStream(const DirStream&) = delete;
+    DirStream& operator=(const DirStream&) = delete;
+    ~DirStream() {
+        close();
+    }
+
+    bool open(const std::string& path, std::string& err, bool follow_symlink = true);
+    // Appends up to max entries ("." and ".." skipped). isEof() turns true once exhausted.
+    bool read(std::vector<std::string>& names, std::vector<uint8_t>& types, size_t max, std::string& err);
+    void close();
+    bool isEof() const {
+        return m_eof;
+    }
+
+  private:
+    std::string m_path;
+    bool m_eof = true;
+#ifdef _WIN32
+    fs::directory_iterator m_it;
+#elif defined(__linux__)
+    static constexpr size_t BUFFER_SIZE = 64 * 1024;
+    // Offsets of d_reclen, d_type and d_name in struct linux_dirent64.
+    static constexpr size_t RECLEN_OFFSET = 16;
+    static constexpr size_t TYPE_OFFSET = 18;
+    static constexpr size_t NAME_OFFSET = 19;
+    int32_t m_fd = -1;
+    std::vector<char> m_buf;
+    size_t m_buf_pos = 0;
+    size_t m_buf_len = 0;
+#else
+    DIR* p_dir = nullptr;
+#endif
+};
+
+static inline bool isDotEntry(const char* p_name) {
+    return p_name[0] == '.' && (p_name[1] == '\0' || (p_name[1] == '.' && p_name[2] == '\0'));
+}
+
+#ifdef _WIN32
+bool DirStream::open(const std::string& path, std::string& err, bool follow_symlink) {
+    (void) follow_symlink;
+    close();
+    std::error_code ec;
+    m_path = path;
+    m_it = fs::directory_iterator(path, ec);
+    if (ec) {
+        err = ec.message() + ", scandir '" + path + "'";
+        return false;
+    }
+    m_eof = false;
+    return true;
+}
+
+bool DirStream::read(std::vector<std::string>& names, std::vector<uint8_t>& types, size_t max, std::string& err) {
+    std::error_code ec;
+    size_t added = 0;
+    const fs::directory_iterator end;
+    while (added < max && m_it != end) {
+        names.push_back(m_it->path().filename().string());
+        types.push_back(direntTypeOf(m_it->symlink_status(ec)));
+        m_it.increment(ec);
+        if (ec) {
+            err = ec.message() + ", scandir '" + m_path + "'";
+            return false;
+        }
+        ++added;
+    }
+    if (m_it == end)
+        m_eof = true;
+    return true;
+}
+
+void DirStream::close() {
+    m_it = fs::directory_iterator();
+    m_eof = true;
+}
+#elif defined(__linux__)
+bool DirStream::open(const std::string& path, std::string& err, bool follow_symlink) {
+    close();
+    m_path = path;
+    int32_t flags = O_RDONLY | O_DIRECTORY | O_CLOEXEC | (follow_symlink ? 0 : O_NOFOLLOW);
+    m_fd = ::open(path.c_str(), flags);
+    if (m_fd < 0) {
+        err = errnoMessage("scandir", path);
+        return false;
+    }
+    m_buf.resize(BUFFER_SIZE);
+    m_buf_pos = 0;
+    m_buf_len = 0;
+    m_eof = false;
+    return true;
+}
+
+bool DirStream::read(std::vector<std::string>& names, std::vector<uint8_t>& types, size_t max, std::string& err) {
+    size_t added = 0;
+    while (added < max && !m_eof) {
+        if (m_buf_pos >= m_buf_len) {
+            int64_t n = static_cast<int64_t>(syscall(SYS_getdents64, m_fd, m_buf.data(), m_buf.size()));
+            if (n < 0) {
+                if (errno == EINTR)
+                    continue;
+                err = errnoMessage("scandir", m_path);
+                return false;
+            }
+            if (n == 0) {
+                m_eof = true;
+                break;
+            }
+            m_buf_pos = 0;
+            m_buf_len = static_cast<size_t>(n);
+        }
+        const char* p_rec = m_buf.data() + m_buf_pos;
+        uint16_t reclen = 0;
+        std::memcpy(&reclen, p_rec + RECLEN_OFFSET, sizeof(reclen));
+        m_buf_pos += reclen;
+        const char* p_name = p_rec + NAME_OFFSET;
+        if (isDotEntry(p_name))
+            continue;
+        names.emplace_back(p_name);
+        types.push_back(direntTypeOfDtype(static_cast<uint8_t>(p_rec[TYPE_OFFSET]), m_fd, p_name));
+        ++added;
+    }
+    return true;
+}
+
+void DirStream::close() {
+    if (m_fd >= 0)
+        ::close(m_fd);
+    m_fd = -1;
+    m_buf.clear();
+    m_buf.shrink_to_fit();
+    m_eof = true;
+}
+#else
+bool DirStream::open(const std::string& path, std::string& err, bool follow_symlink) {
+    close();
+    m_path = path;
+    int32_t flags = O_RDONLY | O_DIRECTORY | O_CLOEXEC | (follow_symlink ? 0 : O_NOFOLLOW);
+    int32_t fd = ::open(path.c_str(), flags);
+    if (fd < 0 || (p_dir = fdopendir(fd)) == nullptr) {
+        err = errnoMessage("scandir", path);
+        if (fd >= 0)
+            ::close(fd);
+        return false;
+    }
+    m_eof = false;
+    return true;
+}
+
+bool DirStream::read(std::vector<std::string>& names, std::vector<uint8_t>& types, size_t max, std::string& err) {
+    size_t added = 0;
+    while (added < max && !m_eof) {
+        errno = 0;
+        dirent* p_ent = readdir(p_dir);
+        if (p_ent == nullptr) {
+            if (errno != 0) {
+                err = errnoMessage("scandir", m_path);
+                return false;
+            }
+            m_eof = true;
+            break;
+        }
+        if (isDotEntry(p_ent->d_name))
+            continue;
+        names.emplace_back(p_ent->d_name);
+        types.push_back(direntTypeOfDtype(p_ent->d_type, dirfd(p_dir), p_ent->d_name));
+        ++added;
+    }
+    return true;
+}
+
+void DirStream::close() {
+    if (p_dir)
+        closedir(p_dir);
+    p_dir = nullptr;
+    m_eof = true;
+}
+#endif
+
+// Bounded fan-out over the ThreadPool. Jobs queued on one FanoutQueue are drained by at most
+// m_max_parallel pool workers, so one large tree operation cannot starve other fs calls.
+// The owner calls fanoutMarkDone() when its last job completes; the last worker to leave
+// after that reports completion (p_done_task, or m_done_cv for sync callers), so nothing
+// touches the queue once it has been handed back.
+struct FanoutQueue {
+    int32_t m_max_parallel = 2;
+    std::mutex m_mutex;
+    std::deque<std::function<void()>> m_queue;
+    int32_t m_in_flight = 0;
+    bool m_work_done = false;
+
+    z8::Task* p_done_task = nullptr;
+    bool m_done = false;
+    std::condition_variable m_done_cv;
+};
+
+static int32_t fanoutMaxParallel() {
+    // Leave half of the pool for other requests while a large tree is being processed.
+    int32_t hw = static_cast<int32_t>(std::thread::hardware_concurrency());
+    return std::max<int32_t>(2, hw / 2);
+}
+
+static void fanoutMarkDone(FanoutQueue* p_queue) {
+    std::lock_guard<std::mutex> lock(p_queue->m_mutex);
+    p_queue->m_work_done = true;
+}
+
+static void fanoutFinish(FanoutQueue* p_queue) {
+    if (p_queue->p_done_task) {
+        TaskQueue::getInstance().enqueue(p_queue->p_done_task);
+        return;
+    }
+    std::lock_guard<std::mutex> lock(p_queue->m_mutex);
+    p_queue->m_done = true;
+    p_queue->m_done_cv.notify_all();
+}
+
+static void fanoutDrain(FanoutQueue* p_queue) {
+    for (;;) {
+        std::function<void()> fn;
+        bool finished = false;
+        {
+            std::lock_guard<std::mutex> lock(p_queue->m_mutex);
+            if (p_queue->m_queue.empty()) {
+                p_queue->m_in_flight--;
+                finished = p_queue->m_in_flight == 0 && p_queue->m_work_done;
+            } else {
+                fn = std::move(p_queue->m_queue.front());
+                p_queue->m_queue.pop_front();
+            }
+        }
+        if (!fn) {
+            if (finished)
+                fanoutFinish(p_queue);
+            return;
+        }
+        fn();
+    }
+}
+
+static void fanoutSubmit(FanoutQueue* p_queue, std::function<void()> fn) {
+    bool spawn = false;
+    {
+        std::lock_guard<std::mutex> lock(p_queue->m_mutex);
+        p_queue->m_queue.push_back(std::move(fn));
+        if (p_queue->m_in_flight < p_queue->m_max_parallel) {
+            p_queue->m_in_flight++;
+            spawn = true;
+        }
+    }
+    if (spawn)
+        ThreadPool::getInstance().enqueue([p_queue]() { fanoutDrain(p_queue); });
+}
+
+// Blocks a sync caller until the queue has been drained and marked done.
+static void fanoutWait(FanoutQueue* p_queue) {
+    std::unique_lock<std::mutex> lock(p_queue->m_mutex);
+    p_queue->m_done_cv.wait(lock, [p_queue]() { return p_queue->m_done; });
+}
+
 struct DirData {
     fs::path m_path;
-    fs::directory_iterator m_it;
-    fs::directory_iterator m_end;
+    DirStream m_stream;
+    std::vector<std::string> m_names;
+    std::vector<uint8_t> m_types;
+    size_t m_pos = 0;
+    size_t m_buffer_size = DIR_DEFAULT_BUFFER_SIZE;
     bool m_closed = false;
+    std::string m_open_error;
     std::mutex m_mutex;
 
     DirData(const fs::path& p) : m_path(p) {
-        std::error_code ec;
-        m_it = fs::directory_iterator(p, ec);
-        if (ec)
+        if (!m_stream.open(p.string(), m_open_error))
             m_closed = true;
     }
+
+    // All members below expect m_mutex to be held.
+    bool hasBuffered() const {
+        return m_pos < m_names.size();
+    }
+
+    // Pulls the next m_buffer_size entries from disk in one go.
+    bool fill(std::string& err) {
+        m_names.clear();
+        m_types.clear();
+        m_pos = 0;
+        if (m_closed || m_stream.isEof())
+            return true;
+        return m_stream.read(m_names, m_types, m_buffer_size, err);
+    }
+
+    void pop(std::string& name, uint8_t& type) {
+        name = std::move(m_names[m_pos]);
+        type = m_types[m_pos];
+        ++m_pos;
+    }
+
+    void close() {
+        m_closed = true;
+        m_stream.close();
+        m_names.clear();
+        m_types.clear();
+        m_pos = 0;
+    }
 };
 
 struct DirReadCtx {
     DirData* p_data;
     bool m_is_error = false;
     std::string m_error_msg;
-    fs::directory_entry m_entry;
+    std::string m_name;
+    uint8_t m_type = DIRENT_UNKNOWN;
     bool m_has_entry = false;
+    bool m_iter_result = false;
 };
 
-// Helper to convert file_time_type to V8 Date
+// file_clock and system_clock have different epochs. Convert through the library instead of
+// subtracting two now() readings, which skews every result by the time between the calls.
+static std::chrono::system_clock::time_point fileTimeToSystem(fs::file_time_type ftime) {
+#ifdef _MSC_VER
+    return std::chrono::clock_cast<std::chrono::system_clock>(ftime);
+#else
+    return std::chrono::time_point_cast<std::chrono::system_clock::duration>(fs::file_time_type::clock::to_sys(ftime));
+#endif
+}
+
 // Helper to convert V8 milliseconds to file_time_type
 fs::file_time_type V8MillisecondsToFileTime(double ms) {
-    auto system_time = std::chrono::system_clock::time_point(std::chrono::milliseconds(static_cast<int64_t>(ms)));
-    return fs::file_time_type::clock::now() + (system_time - std::chrono::system_clock::now());
+    auto system_time = std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::duration<double, std::milli>(ms)));
+#ifdef _MSC_VER
+    return std::chrono::clock_cast<fs::file_time_type::clock>(system_time);
+#else
+    return fs::file_time_type::clock::from_sys(system_time);
+#endif
 }
 
 #ifdef _WIN32
@@ -123,20 +586,385 @@ static inline bool isPathSafe(const char* p_path) {
     return true;
 }
 
+// --- Descriptor budget ---
+// Opens issued by fs promise operations are counted against the descriptor limit. Once the
+// budget is spent, new opens wait in a FIFO and start as earlier descriptors are closed, so a
+// burst of operations slows down instead of failing with EMFILE. fdAcquire runs on the main
+// thread; fdRelease may run anywhere and hands its slot straight to the oldest waiter.
+static constexpr int64_t FD_RESERVE_MIN = 64;
+static constexpr int64_t FD_BUDGET_MIN = 16;
+
+struct FdWaiter {
+    std::function<void()> m_start;
+    std::chrono::steady_clock::time_point m_queued_at;
+};
+
+struct FdBudget {
+    std::mutex m_mutex;
+    int64_t m_limit = 0;
+    int64_t m_open = 0;
+    std::deque<FdWaiter> m_waiters;
+    std::deque<FdWaiter> m_ready;
+    bool m_drain_posted = false;
+
+    // Main thread only.
+    uint64_t m_queued = 0;
+    double m_blocked_ms = 0;
+    double m_max_blocked_ms = 0;
+};
+
+// Raises the soft RLIMIT_NOFILE to the hard limit and returns the resulting soft limit.
+static int64_t fdRaiseLimit() {
+#ifdef _WIN32
+    // CRT descriptors and streams share the stdio table, which defaults to 512 entries.
+    _setmaxstdio(8192);
+    return _getmaxstdio();
+#else
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) != 0)
+        return 1024;
+    if (limit.rlim_cur < limit.rlim_max) {
+        rlimit raised = limit;
+        raised.rlim_cur = limit.rlim_max;
+#ifdef __APPLE__
+        raised.rlim_cur = std::min<rlim_t>(raised.rlim_cur, OPEN_MAX);
+#endif
+        if (setrlimit(RLIMIT_NOFILE, &raised) == 0)
+            limit = raised;
+    }
+    int64_t soft = limit.rlim_cur == RLIM_INFINITY ? INT32_MAX : static_cast<int64_t>(limit.rlim_cur);
+    return soft;
+#endif
+}
+
+static FdBudget& fdBudget() {
+    // Never destroyed: pool threads may still release descriptors while statics are torn down.
+    static FdBudget* p_budget = []() {
+        auto p_new = new FdBudget();
+        int64_t soft = fdRaiseLimit();
+        // Sockets, pipes, watchers and user fds live outside the budget.
+        p_new->m_limit = std::max(FD_BUDGET_MIN, soft - std::max(FD_RESERVE_MIN, soft / 8));
+        return p_new;
+    }();
+    return *p_budget;
+}
+
+static void fdDrain(v8::Isolate* p_isolate, v8::Local<v8::Context> context, Task* p_task) {
+    FdBudget& budget = fdBudget();
+    std::deque<FdWaiter> ready;
+    {
+        std::lock_guard<std::mutex> lock(budget.m_mutex);
+        ready.swap(budget.m_ready);
+        budget.m_drain_posted = false;
+    }
+    auto now = std::chrono::steady_clock::now();
+    for (FdWaiter& waiter : ready) {
+        double waited = std::chrono::duration<double, std::milli>(now - waiter.m_queued_at).count();
+        budget.m_blocked_ms += waited;
+        budget.m_max_blocked_ms = std::max(budget.m_max_blocked_ms, waited);
+        waiter.m_start();
+    }
+}
+
+// Schedules fdDrain on the main thread to start the waiters moved to m_ready.
+static void fdPostDrain() {
+    z8::Task* p_task = new z8::Task();
+    p_task->m_is_promise = false;
+    p_task->p_data = nullptr;
+    p_task->m_runner = fdDrain;
+    TaskQueue::getInstance().enqueue(p_task);
+}
+
+// Runs start now if a descriptor is free, otherwise once one is released.
+static void fdAcquire(std::function<void()> start) {
+    FdBudget& budget = fdBudget();
+    {
+        std::lock_guard<std::mutex> lock(budget.m_mutex);
+        if (budget.m_open >= budget.m_limit || !budget.m_waiters.empty()) {
+            budget.m_waiters.push_back({std::move(start), std::chrono::steady_clock::now()});
+            budget.m_queued++;
+            return;
+        }
+        budget.m_open++;
+    }
+    start();
+}
+
+// Counts a descriptor that was opened without waiting, e.g. by a synchronous stream constructor.
+static void fdReserve() {
+    FdBudget& budget = fdBudget();
+    std::lock_guard<std::mutex> lock(budget.m_mutex);
+    budget.m_open++;
+}
+
+static void fdRelease() {
+    FdBudget& budget = fdBudget();
+    bool post = false;
+    {
+        std::lock_guard<std::mutex> lock(budget.m_mutex);
+        // Waiters only exist while the budget is spent; fdReserve can push it past the limit.
+        if (budget.m_waiters.empty() || budget.m_open > budget.m_limit) {
+            budget.m_open--;
+            return;
+        }
+        // The slot passes straight to the oldest waiter, so m_open stays as it is.
+        budget.m_ready.push_back(std::move(budget.m_waiters.front()));
+        budget.m_waiters.pop_front();
+        post = !budget.m_drain_posted;
+        budget.m_drain_posted = true;
+    }
+    if (post)
+        fdPostDrain();
+}
+
+void FS::raiseFdLimit() {
+    (void) fdBudget();
+}
+
+// Non-standard: sets the descriptor budget (at least 1) and returns the previous one. Raising it
+// starts as many waiting opens as now fit; lowering it lets open descriptors drain below it first.
+void FS::setOpenQueueLimit(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    FdBudget& budget = fdBudget();
+    bool post = false;
+    int64_t previous;
+    {
+        std::lock_guard<std::mutex> lock(budget.m_mutex);
+        previous = budget.m_limit;
+        if (args.Length() > 0 && args[0]->IsNumber() && args[0].As<v8::Number>()->Value() >= 1)
+            budget.m_limit = static_cast<int64_t>(std::min(args[0].As<v8::Number>()->Value(), 1e15));
+        size_t ready = budget.m_ready.size();
+        while (budget.m_open < budget.m_limit && !budget.m_waiters.empty()) {
+            budget.m_open++;
+            budget.m_ready.push_back(std::move(budget.m_waiters.front()));
+            budget.m_waiters.pop_front();
+        }
+        post = budget.m_ready.size() > ready && !budget.m_drain_posted;
+        budget.m_drain_posted = budget.m_drain_posted || post;
+    }
+    if (post)
+        fdPostDrain();
+    args.GetReturnValue().Set(v8::Number::New(args.GetIsolate(), static_cast<double>(previous)));
+}
+
+// Non-standard: descriptor budget counters. blockedMs sums the time opens spent queued.
+void FS::openQueueStats(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    v8::Local<v8::Context> context = p_isolate->GetCurrentContext();
+    FdBudget& budget = fdBudget();
+    double values[6];
+    {
+        std::lock_guard<std::mutex> lock(budget.m_mutex);
+        values[0] = static_cast<double>(budget.m_limit);
+        values[1] = static_cast<double>(budget.m_open);
+        values[2] = static_cast<double>(budget.m_waiters.size() + budget.m_ready.size());
+    }
+    values[3] = static_cast<double>(budget.m_queued);
+    values[4] = budget.m_blocked_ms;
+    values[5] = budget.m_max_blocked_ms;
+    static const char* const s_names[6] = {"limit", "open", "waiting", "queued", "blockedMs", "maxBlockedMs"};
+    v8::Local<v8::Object> result = v8::Object::New(p_isolate);
+    for (int32_t i = 0; i < 6; ++i) {
+        result
+            ->Set(context,
+                  v8::String::NewFromUtf8(p_isolate, s_names[i]).ToLocalChecked(),
+                  v8::Number::New(p_isolate, values[i]))
+            .Check();
+    }
+    args.GetReturnValue().Set(result);
+}
+
+// --- Group commit ---
+// Durability requests (fsyncPromise, fdatasyncPromise, writeFile with flush or atomic) are
+// flushed by one committer thread. It waits up to the commit window after the first request,
+// then flushes what has queued per filesystem: a lone request gets its own fdatasync/fsync,
+// while several requests on one device share a single syncfs on Linux. Requests that arrive
+// during a flush form the next round, so rounds grow with load. Z8_FS_COMMIT_WINDOW_US sets
+// the window (default 1000; 0 flushes as soon as the committer is idle).
+static constexpr int64_t COMMIT_DEFAULT_WINDOW_US = 1000;
+static constexpr size_t COMMIT_BATCH_MAX = 4096;
+static constexpr uint8_t SYNC_DATA = 0;
+static constexpr uint8_t SYNC_FULL = 1;
+static constexpr uint8_t SYNC_DIRECTORY = 2;
+
+struct SyncRequest {
+    int32_t m_fd = -1;
+    uint8_t m_kind = SYNC_DATA;
+    uint64_t m_dev = 0;
+    std::chrono::steady_clock::time_point m_queued_at;
+    // Receives 0 or an errno value, on the committer thread.
+    std::function<void(int32_t)> m_done;
+};
+
+struct GroupCommit {
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::vector<SyncRequest> m_pending;
+    std::chrono::microseconds m_window{COMMIT_DEFAULT_WINDOW_US};
+
+    uint64_t m_rounds = 0;
+    uint64_t m_requests = 0;
+    uint64_t m_max_batch = 0;
+    double m_latency_ms = 0;
+    double m_max_latency_ms = 0;
+};
+
+static int32_t syncDescriptor(int32_t fd, uint8_t kind) {
+    int32_t err_no = 0;
+#ifdef _WIN32
+    HANDLE h = (HANDLE) _get_osfhandle(fd);
+    if (h == INVALID_HANDLE_VALUE)
+        err_no = EBADF;
+    else if (!FlushFileBuffers(h))
+        err_no = EIO;
+#elif defined(__linux__)
+    if ((kind == SYNC_DATA ? ::fdatasync(fd) : ::fsync(fd)) != 0)
+        err_no = errno;
+#else
+    if (::fsync(fd) != 0)
+        err_no = errno;
+#endif
+    return err_no;
+}
+
+// Flushes one device's share of a round and reports every request in it.
+static void commitDevice(GroupCommit* p_commit, std::vector<SyncRequest>& batch, size_t begin, size_t end) {
+    bool shared = false;
+    int32_t shared_err = 0;
+#ifdef __linux__
+    if (end - begin > 1) {
+        shared = true;
+        if (::syncfs(batch[begin].m_fd) != 0)
+            shared_err = errno;
+    }
+#endif
+    std::vector<int32_t> results(end - begin, shared_err);
+    if (!shared) {
+        for (size_t i = begin; i < end; ++i)
+            results[i - begin] = syncDescriptor(batch[i].m_fd, batch[i].m_kind);
+    }
+    auto now = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(p_commit->m_mutex);
+        p_commit->m_rounds++;
+        p_commit->m_requests += end - begin;
+        p_commit->m_max_batch = std::max<uint64_t>(p_commit->m_max_batch, end - begin);
+        for (size_t i = begin; i < end; ++i) {
+            double waited = std::chrono::duration<double, std::milli>(now - batch[i].m_queued_at).count();
+            p_commit->m_latency_ms += waited;
+            p_commit->m_max_latency_ms = std::max(p_commit->m_max_latency_ms, waited);
+        }
+    }
+    for (size_t i = begin; i < end; ++i)
+        batch[i].m_done(results[i - begin]);
+}
+
+static void commitLoop(GroupCommit* p_commit) {
+    for (;;) {
+        std::vector<SyncRequest> batch;
+        {
+            std::unique_lock<std::mutex> lock(p_commit->m_mutex);
+            p_commit->m_cv.wait(lock, [p_commit]() { return !p_commit->m_pending.empty(); });
+            auto deadline = p_commit->m_pending.front().m_queued_at + p_commit->m_window;
+            p_commit->m_cv.wait_until(
+                lock, deadline, [p_commit]() { return p_commit->m_pending.size() >= COMMIT_BATCH_MAX; });
+            batch.swap(p_commit->m_pending);
+        }
+        std::stable_sort(batch.begin(), batch.end(), [](const SyncRequest& a, const SyncRequest& b) {
+            return a.m_dev < b.m_dev;
+        });
+        size_t begin = 0;
+        while (begin < batch.size()) {
+            size_t end = begin + 1;
+            while (end < batch.size() && batch[end].m_dev == batch[begin].m_dev)
+                end++;
+            commitDevice(p_commit, batch, begin, end);
+            begin = end;
+        }
+    }
+}
+
+static GroupCommit& groupCommit() {
+    // Never destroyed, like the committer thread itself.
+    static GroupCommit* p_commit = []() {
+        auto p_new = new GroupCommit();
+        const char* p_value = std::getenv("Z8_FS_COMMIT_WINDOW_US");
+        if (p_value && *p_value)
+            p_new->m_window = std::chrono::microseconds(std::strtoll(p_value, nullptr, 10));
+        std::thread(commitLoop, p_new).detach();
+        return p_new;
+    }();
+    return *p_commit;
+}
+
+// Queues fd for a durable flush. done may run on the calling thread when fd is unusable.
+static void groupCommitSubmit(int32_t fd, uint8_t kind, std::function<void(int32_t)> done) {
+    SyncRequest request;
+    request.m_fd = fd;
+    request.m_kind = kind;
+#ifndef _WIN32
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        done(errno);
+        return;
+    }
+    request.m_dev = static_cast<uint64_t>(st.st_dev);
+#endif
+    request.m_queued_at = std::chrono::steady_clock::now();
+    request.m_done = std::move(done);
+    GroupCommit& commit = groupCommit();
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lock(commit.m_mutex);
+        wake = commit.m_pending.empty() || commit.m_pending.size() + 1 >= COMMIT_BATCH_MAX;
+        commit.m_pending.push_back(std::move(request));
+    }
+    if (wake)
+        commit.m_cv.notify_one();
+}
+
+// Non-standard: group commit counters. A round is one flush of one device.
+void FS::groupCommitStats(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    v8::Local<v8::Context> context = p_isolate->GetCurrentContext();
+    GroupCommit& commit = groupCommit();
+    double values[7];
+    {
+        std::lock_guard<std::mutex> lock(commit.m_mutex);
+        double rounds = static_cast<double>(commit.m_rounds);
+        double requests = static_cast<double>(commit.m_requests);
+        values[0] = rounds;
+        values[1] = requests;
+        values[2] = rounds > 0 ? requests / rounds : 0;
+        values[3] = static_cast<double>(commit.m_max_batch);
+        values[4] = requests > 0 ? commit.m_latency_ms / requests : 0;
+        values[5] = commit.m_max_latency_ms;
+        values[6] = static_cast<double>(commit.m_window.count());
+    }
+    static const char* const s_names[7] = {
+        "rounds", "requests", "avgBatch", "maxBatch", "avgLatencyMs", "maxLatencyMs", "windowUs"};
+    v8::Local<v8::Object> result = v8::Object::New(p_isolate);
+    for (int32_t i = 0; i < 7; ++i) {
+        result
+            ->Set(context,
+                  v8::String::NewFromUtf8(p_isolate, s_names[i]).ToLocalChecked(),
+                  v8::Number::New(p_isolate, values[i]))
+            .Check();
+    }
+    args.GetReturnValue().Set(result);
+}
+
+// Helper to convert file_time_type to V8 Date, keeping sub-millisecond precision
 v8::Local<v8::Value> FileTimeToV8Date(v8::Isolate* p_isolate, fs::file_time_type ftime) {
-    auto sctp = std::chrono::time_point_cast<std::chrono::system_clock::duration>(
-        ftime - fs::file_time_type::clock::now() + std::chrono::system_clock::now());
-    double ms =
-        static_cast<double>(std::chrono::time_point_cast<std::chrono::milliseconds>(sctp).time_since_epoch().count());
+    double ms = std::chrono::duration<double, std::milli>(fileTimeToSystem(ftime).time_since_epoch()).count();
     return v8::Date::New(p_isolate->GetCurrentContext(), ms).ToLocalChecked();
 }
 
 v8::Local<v8::ObjectTemplate> FS::createTemplate(v8::Isolate* p_isolate) {
-    static bool buffered = []() {
+    static std::once_flag s_stdio_buffered;
+    std::call_once(s_stdio_buffered, []() {
         AdaptiveIO::setupBuffer(stdout);
         AdaptiveIO::setupBuffer(stderr);
-        return true;
-    }();
+    });
 
     v8::Local<v8::ObjectTemplate> tmpl = v8::ObjectTemplate::New(p_isolate);
 
@@ -222,6 +1050,8 @@ v8::Local<v8::ObjectTemplate> FS::createTemplate(v8::Isolate* p_isolate) {
               v8::FunctionTemplate::New(p_isolate, FS::lutimesSync));
     tmpl->Set(v8::String::NewFromUtf8(p_isolate, "opendirSync").ToLocalChecked(),
               v8::FunctionTemplate::New(p_isolate, FS::opendirSync));
+    tmpl->Set(v8::String::NewFromUtf8(p_isolate, "globSync").ToLocalChecked(),
+              v8::FunctionTemplate::New(p_isolate, FS::globSync));
 
     // Add fs.constants
     v8::Local<v8::ObjectTemplate> constants_tmpl = v8::ObjectTemplate::New(p_isolate);
@@ -289,9 +1119,23 @@ v8::Local<v8::ObjectTemplate> FS::createTemplate(v8::Isolate* p_isolate) {
     tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "statfs"), v8::FunctionTemplate::New(p_isolate, FS::statfs));
     tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "lutimes"), v8::FunctionTemplate::New(p_isolate, FS::lutimes));
     tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "opendir"), v8::FunctionTemplate::New(p_isolate, FS::opendir));
+    tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "glob"), v8::FunctionTemplate::New(p_isolate, FS::glob));
+    tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "watch"), v8::FunctionTemplate::New(p_isolate, FS::watch));
+    tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "watchFile"),
+              v8::FunctionTemplate::New(p_isolate, FS::watchFile));
+    tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "unwatchFile"),
+              v8::FunctionTemplate::New(p_isolate, FS::unwatchFile));
  
     tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "createReadStream"), v8::FunctionTemplate::New(p_isolate, FS::createReadStream));
     tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "createWriteStream"), v8::FunctionTemplate::New(p_isolate, FS::createWriteStream));
+    tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "createLogWriter"),
+              v8::FunctionTemplate::New(p_isolate, FS::createLogWriter));
+    tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "enableStatCache"),
+              v8::FunctionTemplate::New(p_isolate, FS::enableStatCache));
+    tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "clearStatCache"),
+              v8::FunctionTemplate::New(p_isolate, FS::clearStatCache));
+    tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "statCacheStats"),
+              v8::FunctionTemplate::New(p_isolate, FS::statCacheStats));
 
     // Expose fs.promises
     tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "promises"), createPromisesTemplate(p_isolate));
@@ -303,6 +1147,14 @@ v8::Local<v8::ObjectTemplate> FS::createPromisesTemplate(v8::Isolate* p_isolate)
     v8::Local<v8::ObjectTemplate> tmpl = v8::ObjectTemplate::New(p_isolate);
     tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "readFile"),
               v8::FunctionTemplate::New(p_isolate, FS::readFilePromise));
+    tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "readFileInlineStats"),
+              v8::FunctionTemplate::New(p_isolate, FS::readFileInlineStats));
+    tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "openQueueStats"),
+              v8::FunctionTemplate::New(p_isolate, FS::openQueueStats));
+    tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "setOpenQueueLimit"),
+              v8::FunctionTemplate::New(p_isolate, FS::setOpenQueueLimit));
+    tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "groupCommitStats"),
+              v8::FunctionTemplate::New(p_isolate, FS::groupCommitStats));
     tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "writeFile"),
               v8::FunctionTemplate::New(p_isolate, FS::writeFilePromise));
     tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "stat"), v8::FunctionTemplate::New(p_isolate, FS::statPromise));
@@ -366,10 +1218,19 @@ v8::Local<v8::ObjectTemplate> FS::createPromisesTemplate(v8::Isolate* p_isolate)
               v8::FunctionTemplate::New(p_isolate, FS::lutimesPromise));
     tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "opendir"),
               v8::FunctionTemplate::New(p_isolate, FS::opendirPromise));
+    tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "glob"), v8::FunctionTemplate::New(p_isolate, FS::globPromise));
+    tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "watch"),
+              v8::FunctionTemplate::New(p_isolate, FS::watchPromise));
     tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "readv"),
               v8::FunctionTemplate::New(p_isolate, FS::readvPromise));
     tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "writev"),
               v8::FunctionTemplate::New(p_isolate, FS::writevPromise));
+    tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "readMany"),
+              v8::FunctionTemplate::New(p_isolate, FS::readManyPromise));
+    tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "statMany"),
+              v8::FunctionTemplate::New(p_isolate, FS::statManyPromise));
+    tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "writeMany"),
+              v8::FunctionTemplate::New(p_isolate, FS::writeManyPromise));
     return tmpl;
 }
 
@@ -424,10 +1285,7 @@ void FS::readFileSync(const v8::FunctionCallbackInfo<v8::Value>& args) {
     if (encoding == "utf8") {
         std::string content(size, '\0');
         if (file.read(&content[0], size)) {
-            args.GetReturnValue().Set(
-                v8::String::NewFromUtf8(
-                    p_isolate, content.c_str(), v8::NewStringType::kNormal, static_cast<int32_t>(size))
-                    .ToLocalChecked());
+            args.GetReturnValue().Set(Buffer::decodeUtf8(p_isolate, content.data(), content.size()).ToLocalChecked());
         }
     } else {
         v8::Local<v8::ArrayBuffer> ab = v8::ArrayBuffer::New(p_isolate, size);
@@ -442,7 +1300,6 @@ void FS::readFileSync(const v8::FunctionCallbackInfo<v8::Value>& args) {
 void FS::writeFileSync(const v8::FunctionCallbackInfo<v8::Value>& args) {
     v8::Isolate* p_isolate = args.GetIsolate();
     v8::HandleScope handle_scope(p_isolate);
-    v8::Local<v8::Context> p_context = p_isolate->GetCurrentContext();
 
     if (args.Length() < 2 || !args[0]->IsString() || (!args[1]->IsString() && !args[1]->IsUint8Array())) {
         p_isolate->ThrowException(
@@ -464,11 +1321,12 @@ void FS::writeFileSync(const v8::FunctionCallbackInfo<v8::Value>& args) {
 
     const void* p_data = nullptr;
     size_t length = 0;
-    v8::String::Utf8Value str_data(p_isolate, args[1]);
+    std::string str_data;
 
     if (args[1]->IsString()) {
-        p_data = *str_data;
-        length = str_data.length();
+        Buffer::toUtf8(p_isolate, args[1].As<v8::String>(), str_data);
+        p_data = str_data.data();
+        length = str_data.size();
     } else {
         v8::Local<v8::Uint8Array> uint8 = args[1].As<v8::Uint8Array>();
         p_data = static_cast<const char*>(uint8->Buffer()->GetBackingStore()->Data()) + uint8->ByteOffset();
@@ -538,55 +1396,214 @@ void FS::appendFileSync(const v8::FunctionCallbackInfo<v8::Value>& args) {
     file.close();
 }
 
-static void DirReadSync(const v8::FunctionCallbackInfo<v8::Value>& args) {
-    v8::Isolate* p_isolate = args.GetIsolate();
-    v8::Local<v8::Object> self = args.This().As<v8::Object>();
+static inline v8::Local<v8::String> newUtf8String(v8::Isolate* p_isolate, const std::string& str) {
+    return v8::String::NewFromUtf8(p_isolate, str.data(), v8::NewStringType::kNormal, static_cast<int32_t>(str.size()))
+        .ToLocalChecked();
+}
+
+// Dirents are thin template instances. Internal fields hold the name (a string, or the holder
+// of a whole listing's names), the parentPath string shared by the listing and the entry's
+// index in the holder; name, parentPath and path are lazy data properties, so building a large
+// listing costs one small allocation per entry and a name is only decoded when first read.
+// Every dirent type has its own class whose prototype carries constant is*() methods.
+static constexpr int32_t DIRENT_FIELD_NAME = 0;
+static constexpr int32_t DIRENT_FIELD_PARENT = 1;
+static constexpr int32_t DIRENT_FIELD_INDEX = 2;
+static constexpr int32_t DIRENT_FIELD_COUNT = 3;
+
+// Names read by a worker for one directory, kept alive by the dirents that point into it.
+struct DirentNames {
+    std::vector<std::string> m_names;
+    int64_t m_bytes = 0;
+    v8::Global<v8::Object> m_self;
+};
+
+static void direntNamesWeak(const v8::WeakCallbackInfo<DirentNames>& data) {
+    DirentNames* p_names = data.GetParameter();
+    p_names->m_self.Reset();
+    data.GetIsolate()->AdjustAmountOfExternalAllocatedMemory(-p_names->m_bytes);
+    delete p_names;
+}
+
+static v8::Local<v8::Object>
+newDirentNames(v8::Isolate* p_isolate, v8::Local<v8::Context> context, std::vector<std::string>&& names) {
+    static v8::Persistent<v8::ObjectTemplate> s_tmpl;
+    if (s_tmpl.IsEmpty()) {
+        v8::Local<v8::ObjectTemplate> tmpl = v8::ObjectTemplate::New(p_isolate);
+        tmpl->SetInternalFieldCount(1);
+        s_tmpl.Reset(p_isolate, tmpl);
+    }
+    v8::Local<v8::Object> holder = s_tmpl.Get(p_isolate)->NewInstance(context).ToLocalChecked();
+    auto p_names = new DirentNames();
+    p_names->m_names = std::move(names);
+    p_names->m_bytes = static_cast<int64_t>(p_names->m_names.capacity() * sizeof(std::string));
+    for (const auto& name : p_names->m_names)
+        p_names->m_bytes += static_cast<int64_t>(name.size());
+    p_isolate->AdjustAmountOfExternalAllocatedMemory(p_names->m_bytes);
+    holder->SetInternalField(0, v8::External::New(p_isolate, p_names));
+    p_names->m_self.Reset(p_isolate, holder);
+    p_names->m_self.SetWeak(p_names, direntNamesWeak, v8::WeakCallbackType::kParameter);
+    return holder;
+}
+
+static void DirentName(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value>& info) {
+    v8::Local<v8::Object> self = info.Holder();
+    v8::Local<v8::Value> name = self->GetInternalField(DIRENT_FIELD_NAME).As<v8::Value>();
+    if (!name->IsObject()) {
+        info.GetReturnValue().Set(name);
+        return;
+    }
+    v8::Local<v8::Value> field = name.As<v8::Object>()->GetInternalField(0).As<v8::Value>();
+    auto p_names = static_cast<DirentNames*>(field.As<v8::External>()->Value());
+    int32_t index = self->GetInternalField(DIRENT_FIELD_INDEX).As<v8::Value>().As<v8::Int32>()->Value();
+    info.GetReturnValue().Set(newUtf8String(info.GetIsolate(), p_names->m_names[index]));
+}
+
+static void DirentParentPath(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value>& info) {
+    info.GetReturnValue().Set(info.Holder()->GetInternalField(DIRENT_FIELD_PARENT).As<v8::Value>());
+}
+
+static v8::Local<v8::ObjectTemplate> getDirentTemplate(v8::Isolate* p_isolate, uint8_t type) {
+    static v8::Persistent<v8::FunctionTemplate> s_tmpls[DIRENT_BLOCK + 1];
+    if (type > DIRENT_BLOCK)
+        type = DIRENT_UNKNOWN;
+    if (s_tmpls[type].IsEmpty()) {
+        v8::Local<v8::FunctionTemplate> tmpl = v8::FunctionTemplate::New(p_isolate);
+        tmpl->SetClassName(v8::String::NewFromUtf8Literal(p_isolate, "Dirent"));
+        v8::Local<v8::ObjectTemplate> instance = tmpl->InstanceTemplate();
+        instance->SetInternalFieldCount(DIRENT_FIELD_COUNT);
+        instance->SetLazyDataProperty(v8::String::NewFromUtf8Literal(p_isolate, "name"), DirentName);
+        instance->SetLazyDataProperty(v8::String::NewFromUtf8Literal(p_isolate, "parentPath"), DirentParentPath);
+        instance->SetLazyDataProperty(v8::String::NewFromUtf8Literal(p_isolate, "path"), DirentParentPath);
+
+        v8::Local<v8::ObjectTemplate> proto = tmpl->PrototypeTemplate();
+        auto add_method = [&](const char* p_name, bool val) {
+            proto->Set(v8::String::NewFromUtf8(p_isolate, p_name, v8::NewStringType::kInternalized).ToLocalChecked(),
+                       v8::FunctionTemplate::New(
+                           p_isolate,
+                           [](const v8::FunctionCallbackInfo<v8::Value>& args) {
+                               args.GetReturnValue().Set(args.Data().As<v8::Boolean>());
+                           },
+                           v8::Boolean::New(p_isolate, val)));
+        };
+        add_method("isDirectory", type == DIRENT_DIR);
+        add_method("isFile", type == DIRENT_FILE);
+        add_method("isSymbolicLink", type == DIRENT_LINK);
+        add_method("isBlockDevice", type == DIRENT_BLOCK);
+        add_method("isCharacterDevice", type == DIRENT_CHAR);
+        add_method("isFIFO", type == DIRENT_FIFO);
+        add_method("isSocket", type == DIRENT_SOCKET);
+        s_tmpls[type].Reset(p_isolate, tmpl);
+    }
+    return s_tmpls[type].Get(p_isolate)->InstanceTemplate();
+}
+
+static v8::Local<v8::Object> newDirent(v8::Local<v8::Context> context,
+                                       v8::Local<v8::ObjectTemplate> tmpl,
+                                       v8::Local<v8::Value> name,
+                                       v8::Local<v8::String> parent_path,
+                                       int32_t index) {
+    v8::Local<v8::Object> dirent = tmpl->NewInstance(context).ToLocalChecked();
+    dirent->SetInternalField(DIRENT_FIELD_NAME, name);
+    dirent->SetInternalField(DIRENT_FIELD_PARENT, parent_path);
+    dirent->SetInternalField(DIRENT_FIELD_INDEX, v8::Integer::New(context->GetIsolate(), index));
+    return dirent;
+}
+
+static v8::Local<v8::Object> createDirentFromType(v8::Isolate* p_isolate,
+                                                  v8::Local<v8::Context> context,
+                                                  v8::Local<v8::String> name,
+                                                  v8::Local<v8::String> parent_path,
+                                                  uint8_t type) {
+    return newDirent(context, getDirentTemplate(p_isolate, type), name, parent_path, 0);
+}
+
+static DirData* getDirData(v8::Local<v8::Object> self) {
     if (self->InternalFieldCount() < 1)
-        return;
+        return nullptr;
     auto internal = self->GetInternalField(0);
-    auto* p_data = static_cast<DirData*>(v8::Local<v8::External>::Cast(internal)->Value());
+    return static_cast<DirData*>(v8::Local<v8::External>::Cast(internal)->Value());
+}
 
-    std::lock_guard<std::mutex> lock(p_data->m_mutex);
-    if (p_data->m_closed || p_data->m_it == p_data->m_end) {
-        args.GetReturnValue().Set(v8::Null(p_isolate));
+static void DirReadSync(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    v8::Local<v8::Context> p_context = p_isolate->GetCurrentContext();
+    auto* p_data = getDirData(args.This().As<v8::Object>());
+    if (!p_data)
         return;
-    }
 
-    std::error_code ec;
-    auto entry = *p_data->m_it;
-    p_data->m_it.increment(ec);
-    if (ec)
-        p_data->m_closed = true;
+    std::string name;
+    uint8_t type = DIRENT_UNKNOWN;
+    {
+        std::lock_guard<std::mutex> lock(p_data->m_mutex);
+        std::string err;
+        if (!p_data->m_closed && !p_data->hasBuffered() && !p_data->fill(err)) {
+            p_isolate->ThrowException(
+                v8::Exception::Error(v8::String::NewFromUtf8(p_isolate, err.c_str()).ToLocalChecked()));
+            return;
+        }
+        if (p_data->m_closed || !p_data->hasBuffered()) {
+            args.GetReturnValue().Set(v8::Null(p_isolate));
+            return;
+        }
+        p_data->pop(name, type);
+    }
 
-    args.GetReturnValue().Set(FS::createDirent(p_isolate, entry));
+    args.GetReturnValue().Set(createDirentFromType(
+        p_isolate, p_context, newUtf8String(p_isolate, name), newUtf8String(p_isolate, p_data->m_path.string()), type));
 }
 
 static void DirCloseSync(const v8::FunctionCallbackInfo<v8::Value>& args) {
-    v8::Local<v8::Object> self = args.This().As<v8::Object>();
-    if (self->InternalFieldCount() < 1)
+    auto* p_data = getDirData(args.This().As<v8::Object>());
+    if (!p_data)
         return;
-    auto internal = self->GetInternalField(0);
-    auto* p_data = static_cast<DirData*>(v8::Local<v8::External>::Cast(internal)->Value());
 
     std::lock_guard<std::mutex> lock(p_data->m_mutex);
-    p_data->m_closed = true;
-    p_data->m_it = fs::directory_iterator();
+    p_data->close();
 }
 
-static void DirRead(const v8::FunctionCallbackInfo<v8::Value>& args) {
+static v8::Local<v8::Value> dirReadResult(v8::Isolate* p_isolate, v8::Local<v8::Context> context, DirReadCtx* p_ctx) {
+    v8::Local<v8::Value> value = v8::Null(p_isolate);
+    if (p_ctx->m_has_entry) {
+        value = createDirentFromType(p_isolate,
+                                     context,
+                                     newUtf8String(p_isolate, p_ctx->m_name),
+                                     newUtf8String(p_isolate, p_ctx->p_data->m_path.string()),
+                                     p_ctx->m_type);
+    }
+    if (!p_ctx->m_iter_result)
+        return value;
+
+    // Async iterator protocol: { value, done }
+    v8::Local<v8::Object> result = v8::Object::New(p_isolate);
+    result
+        ->Set(context,
+              v8::String::NewFromUtf8Literal(p_isolate, "value"),
+              p_ctx->m_has_entry ? value : v8::Undefined(p_isolate).As<v8::Value>())
+        .Check();
+    result
+        ->Set(context,
+              v8::String::NewFromUtf8Literal(p_isolate, "done"),
+              v8::Boolean::New(p_isolate, !p_ctx->m_has_entry))
+        .Check();
+    return result;
+}
+
+// Shared by Dir.read() and the async iterator. Entries already buffered by a previous batch
+// are handed out without a pool hop; otherwise one pool task pulls the next batch.
+static void
+dirReadAsync(const v8::FunctionCallbackInfo<v8::Value>& args, v8::Local<v8::Object> self, bool iter_result) {
     v8::Isolate* p_isolate = args.GetIsolate();
     v8::Local<v8::Context> p_context = p_isolate->GetCurrentContext();
-    v8::Local<v8::Object> self = args.This().As<v8::Object>();
-    if (self->InternalFieldCount() < 1)
+    auto* p_data = getDirData(self);
+    if (!p_data)
         return;
-    auto internal = self->GetInternalField(0);
-    auto* p_data = static_cast<DirData*>(v8::Local<v8::External>::Cast(internal)->Value());
 
     v8::Local<v8::Function> p_cb;
     v8::Local<v8::Promise::Resolver> p_resolver;
     bool is_promise = true;
 
-    if (args.Length() > 0 && args[0]->IsFunction()) {
+    if (!iter_result && args.Length() > 0 && args[0]->IsFunction()) {
         p_cb = args[0].As<v8::Function>();
         is_promise = false;
     } else {
@@ -597,6 +1614,28 @@ static void DirRead(const v8::FunctionCallbackInfo<v8::Value>& args) {
 
     auto p_ctx = new DirReadCtx();
     p_ctx->p_data = p_data;
+    p_ctx->m_iter_result = iter_result;
+
+    bool ready = false;
+    {
+        std::lock_guard<std::mutex> lock(p_data->m_mutex);
+        if (p_data->m_closed) {
+            ready = true;
+        } else if (p_data->hasBuffered()) {
+            p_data->pop(p_ctx->m_name, p_ctx->m_type);
+            p_ctx->m_has_entry = true;
+            ready = true;
+        }
+        // The iterator closes the directory once it is exhausted, like Node does.
+        if (iter_result && ready && !p_ctx->m_has_entry)
+            p_data->close();
+    }
+
+    if (ready && is_promise) {
+        p_resolver->Resolve(p_context, dirReadResult(p_isolate, p_context, p_ctx)).Check();
+        delete p_ctx;
+        return;
+    }
 
     z8::Task* p_task = new z8::Task();
     p_task->m_is_promise = is_promise;
@@ -617,10 +1656,8 @@ static void DirRead(const v8::FunctionCallbackInfo<v8::Value>& args) {
                              v8::Exception::Error(
                                  v8::String::NewFromUtf8(isolate, p_ctx->m_error_msg.c_str()).ToLocalChecked()))
                     .Check();
-            } else if (!p_ctx->m_has_entry) {
-                p_resolver->Resolve(context, v8::Null(isolate)).Check();
             } else {
-                p_resolver->Resolve(context, FS::createDirent(isolate, p_ctx->m_entry)).Check();
+                p_resolver->Resolve(context, dirReadResult(isolate, context, p_ctx)).Check();
             }
         } else {
             v8::Local<v8::Value> argv[2];
@@ -628,45 +1665,88 @@ static void DirRead(const v8::FunctionCallbackInfo<v8::Value>& args) {
                 argv[0] =
                     v8::Exception::Error(v8::String::NewFromUtf8(isolate, p_ctx->m_error_msg.c_str()).ToLocalChecked());
                 argv[1] = v8::Null(isolate);
-            } else if (!p_ctx->m_has_entry) {
-                argv[0] = v8::Null(isolate);
-                argv[1] = v8::Null(isolate);
             } else {
                 argv[0] = v8::Null(isolate);
-                argv[1] = FS::createDirent(isolate, p_ctx->m_entry);
+                argv[1] = dirReadResult(isolate, context, p_ctx);
             }
             (void) task->m_callback.Get(isolate)->Call(context, context->Global(), 2, argv);
         }
         delete p_ctx;
     };
 
-    ThreadPool::getInstance().enqueue([p_task, p_ctx]() {
-        std::lock_guard<std::mutex> lock(p_ctx->p_data->m_mutex);
-        if (p_ctx->p_data->m_closed || p_ctx->p_data->m_it == p_ctx->p_data->m_end) {
-            p_ctx->m_has_entry = false;
-        } else {
-            std::error_code ec;
-            p_ctx->m_entry = *p_ctx->p_data->m_it;
-            p_ctx->p_data->m_it.increment(ec);
-            if (ec) {
-                p_ctx->m_is_error = true;
-                p_ctx->m_error_msg = ec.message();
-            } else {
-                p_ctx->m_has_entry = true;
-            }
-        }
+    if (ready) {
+        // Callback style must stay asynchronous even when the entry is already buffered.
+        TaskQueue::getInstance().enqueue(p_task);
+        return;
+    }
+
+    ThreadPool::getInstance().enqueue([p_task, p_ctx]() {
+        DirData* p_data = p_ctx->p_data;
+        std::lock_guard<std::mutex> lock(p_data->m_mutex);
+        std::string err;
+        if (!p_data->m_closed && !p_data->hasBuffered() && !p_data->fill(err)) {
+            p_ctx->m_is_error = true;
+            p_ctx->m_error_msg = err;
+        } else if (!p_data->m_closed && p_data->hasBuffered()) {
+            p_data->pop(p_ctx->m_name, p_ctx->m_type);
+            p_ctx->m_has_entry = true;
+        } else if (p_ctx->m_iter_result) {
+            p_data->close();
+        }
         TaskQueue::getInstance().enqueue(p_task);
     });
 }
 
-static void DirClose(const v8::FunctionCallbackInfo<v8::Value>& args) {
+static void DirRead(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    dirReadAsync(args, args.This().As<v8::Object>(), false);
+}
+
+static void DirIteratorNext(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    dirReadAsync(args, args.Data().As<v8::Object>(), true);
+}
+
+static void DirIteratorReturn(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    v8::Local<v8::Context> p_context = p_isolate->GetCurrentContext();
+    auto* p_data = getDirData(args.Data().As<v8::Object>());
+    if (p_data) {
+        std::lock_guard<std::mutex> lock(p_data->m_mutex);
+        p_data->close();
+    }
+    v8::Local<v8::Promise::Resolver> p_resolver;
+    if (!v8::Promise::Resolver::New(p_context).ToLocal(&p_resolver))
+        return;
+    v8::Local<v8::Object> result = v8::Object::New(p_isolate);
+    result->Set(p_context, v8::String::NewFromUtf8Literal(p_isolate, "value"), v8::Undefined(p_isolate)).Check();
+    result->Set(p_context, v8::String::NewFromUtf8Literal(p_isolate, "done"), v8::True(p_isolate)).Check();
+    p_resolver->Resolve(p_context, result).Check();
+    args.GetReturnValue().Set(p_resolver->GetPromise());
+}
+
+static void DirAsyncIterator(const v8::FunctionCallbackInfo<v8::Value>& args) {
     v8::Isolate* p_isolate = args.GetIsolate();
     v8::Local<v8::Context> p_context = p_isolate->GetCurrentContext();
     v8::Local<v8::Object> self = args.This().As<v8::Object>();
-    if (self->InternalFieldCount() < 1)
+    v8::Local<v8::Object> iterator = v8::Object::New(p_isolate);
+    iterator
+        ->Set(p_context,
+              v8::String::NewFromUtf8Literal(p_isolate, "next"),
+              v8::Function::New(p_context, DirIteratorNext, self).ToLocalChecked())
+        .Check();
+    iterator
+        ->Set(p_context,
+              v8::String::NewFromUtf8Literal(p_isolate, "return"),
+              v8::Function::New(p_context, DirIteratorReturn, self).ToLocalChecked())
+        .Check();
+    args.GetReturnValue().Set(iterator);
+}
+
+static void DirClose(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    v8::Local<v8::Context> p_context = p_isolate->GetCurrentContext();
+    auto* p_data = getDirData(args.This().As<v8::Object>());
+    if (!p_data)
         return;
-    auto internal = self->GetInternalField(0);
-    auto* p_data = static_cast<DirData*>(v8::Local<v8::External>::Cast(internal)->Value());
 
     v8::Local<v8::Function> p_cb;
     v8::Local<v8::Promise::Resolver> p_resolver;
@@ -699,8 +1779,7 @@ static void DirClose(const v8::FunctionCallbackInfo<v8::Value>& args) {
 
     ThreadPool::getInstance().enqueue([p_task, p_data]() {
         std::lock_guard<std::mutex> lock(p_data->m_mutex);
-        p_data->m_closed = true;
-        p_data->m_it = fs::directory_iterator();
+        p_data->close();
         TaskQueue::getInstance().enqueue(p_task);
     });
 }
@@ -719,6 +1798,8 @@ static v8::Local<v8::ObjectTemplate> GetDirTemplate(v8::Isolate* p_isolate) {
                         v8::FunctionTemplate::New(p_isolate, DirRead));
         local_tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "close"),
                         v8::FunctionTemplate::New(p_isolate, DirClose));
+        local_tmpl->Set(v8::Symbol::GetAsyncIterator(p_isolate),
+                        v8::FunctionTemplate::New(p_isolate, DirAsyncIterator));
 
         dir_tmpl.Reset(p_isolate, local_tmpl);
     }
@@ -727,57 +1808,139 @@ static v8::Local<v8::ObjectTemplate> GetDirTemplate(v8::Isolate* p_isolate) {
 
 v8::Local<v8::Object> FS::createDirent(v8::Isolate* p_isolate, const fs::directory_entry& entry) {
     v8::Local<v8::Context> p_context = p_isolate->GetCurrentContext();
-    v8::Local<v8::Object> dirent = v8::Object::New(p_isolate);
-
-    dirent
-        ->Set(p_context,
-              v8::String::NewFromUtf8Literal(p_isolate, "name"),
-              v8::String::NewFromUtf8(p_isolate, entry.path().filename().string().c_str()).ToLocalChecked())
-        .Check();
-
-    auto add_method = [&](const char* name, bool val) {
-        dirent
-            ->Set(p_context,
-                  v8::String::NewFromUtf8(p_isolate, name).ToLocalChecked(),
-                  v8::FunctionTemplate::New(
-                      p_isolate,
-                      [](const v8::FunctionCallbackInfo<v8::Value>& args) {
-                          args.GetReturnValue().Set(args.Data().As<v8::Boolean>());
-                      },
-                      v8::Boolean::New(p_isolate, val))
-                      ->GetFunction(p_context)
-                      .ToLocalChecked())
-            .Check();
-    };
-
-    add_method("isDirectory", entry.is_directory());
-    add_method("isFile", entry.is_regular_file());
-    add_method("isSymbolicLink", entry.is_symlink());
-    add_method("isBlockDevice", entry.is_block_file());
-    add_method("isCharacterDevice", entry.is_character_file());
-    add_method("isFIFO", entry.is_fifo());
-    add_method("isSocket", entry.is_socket());
-
-    return dirent;
+    std::error_code ec;
+    uint8_t type = direntTypeOf(entry.symlink_status(ec));
+    return createDirentFromType(p_isolate,
+                                p_context,
+                                newUtf8String(p_isolate, entry.path().filename().string()),
+                                newUtf8String(p_isolate, entry.path().parent_path().string()),
+                                type);
 }
 
-v8::Local<v8::Object> FS::createDir(v8::Isolate* p_isolate, const fs::path& path) {
+static v8::Local<v8::Object> createDirObject(v8::Isolate* p_isolate, DirData* p_data) {
     v8::Local<v8::Context> p_context = p_isolate->GetCurrentContext();
     v8::Local<v8::ObjectTemplate> tmpl = GetDirTemplate(p_isolate);
     v8::Local<v8::Object> dir_obj = tmpl->NewInstance(p_context).ToLocalChecked();
 
-    auto* p_data = new DirData(path);
     dir_obj->SetInternalField(0, v8::External::New(p_isolate, p_data));
 
     dir_obj
         ->Set(p_context,
               v8::String::NewFromUtf8Literal(p_isolate, "path"),
-              v8::String::NewFromUtf8(p_isolate, path.string().c_str()).ToLocalChecked())
+              v8::String::NewFromUtf8(p_isolate, p_data->m_path.string().c_str()).ToLocalChecked())
         .Check();
 
     return dir_obj;
 }
 
+v8::Local<v8::Object> FS::createDir(v8::Isolate* p_isolate, const fs::path& path) {
+    return createDirObject(p_isolate, new DirData(path));
+}
+
+// --- Readdir engine ---
+// Workers fill names plus a packed type array per directory; the main thread turns the whole
+// result into one JS array at the end. With { withFileTypes: true } the names move into a
+// DirentNames holder and each entry only gets a thin Dirent wrapper. With { recursive: true } every subdirectory is its
+// own scan job on a FanoutQueue, and the result is assembled breadth-first like Node's.
+struct ReaddirNode {
+    std::string m_rel;
+    std::vector<std::string> m_names;
+    std::vector<uint8_t> m_types;
+    std::vector<std::unique_ptr<ReaddirNode>> m_children;
+};
+
+struct ReaddirCtx : FanoutQueue {
+    std::string m_path;
+    bool m_with_file_types = false;
+    bool m_recursive = false;
+    ReaddirNode m_root;
+    std::atomic<int64_t> m_pending{1};
+    std::atomic<bool> m_failed{false};
+    bool m_is_error = false;
+    std::string m_error_msg;
+};
+
+static void readdirParseOptions(v8::Isolate* p_isolate,
+                                v8::Local<v8::Context> context,
+                                const v8::FunctionCallbackInfo<v8::Value>& args,
+                                ReaddirCtx* p_ctx) {
+    if (args.Length() < 2 || !args[1]->IsObject())
+        return;
+    v8::Local<v8::Object> options = args[1].As<v8::Object>();
+    v8::Local<v8::Value> val;
+    if (options->Get(context, v8::String::NewFromUtf8Literal(p_isolate, "withFileTypes")).ToLocal(&val))
+        p_ctx->m_with_file_types = val->BooleanValue(p_isolate);
+    if (options->Get(context, v8::String::NewFromUtf8Literal(p_isolate, "recursive")).ToLocal(&val))
+        p_ctx->m_recursive = val->BooleanValue(p_isolate);
+}
+
+static void readdirScan(ReaddirCtx* p_ctx, ReaddirNode* p_node) {
+    if (!p_ctx->m_failed.load()) {
+        DirStream stream;
+        std::string err;
+        std::string dir = p_node->m_rel.empty() ? p_ctx->m_path : joinPath(p_ctx->m_path, p_node->m_rel);
+        if (!stream.open(dir, err) || !stream.read(p_node->m_names, p_node->m_types, SIZE_MAX, err)) {
+            std::lock_guard<std::mutex> lock(p_ctx->m_mutex);
+            if (!p_ctx->m_is_error) {
+                p_ctx->m_is_error = true;
+                p_ctx->m_error_msg = err;
+            }
+            p_ctx->m_failed.store(true);
+        } else if (p_ctx->m_recursive) {
+            stream.close();
+            for (size_t i = 0; i < p_node->m_names.size(); ++i) {
+                if (p_node->m_types[i] != DIRENT_DIR)
+                    continue;
+                auto up_child = std::make_unique<ReaddirNode>();
+                up_child->m_rel = joinPath(p_node->m_rel, p_node->m_names[i]);
+                ReaddirNode* p_child = up_child.get();
+                p_node->m_children.push_back(std::move(up_child));
+                p_ctx->m_pending.fetch_add(1);
+                fanoutSubmit(p_ctx, [p_ctx, p_child]() { readdirScan(p_ctx, p_child); });
+            }
+        }
+    }
+    if (p_ctx->m_pending.fetch_sub(1) == 1)
+        fanoutMarkDone(p_ctx);
+}
+
+static void readdirStart(ReaddirCtx* p_ctx) {
+    p_ctx->m_max_parallel = fanoutMaxParallel();
+    fanoutSubmit(p_ctx, [p_ctx]() { readdirScan(p_ctx, &p_ctx->m_root); });
+}
+
+static v8::Local<v8::Array> readdirResult(v8::Isolate* p_isolate, v8::Local<v8::Context> context, ReaddirCtx* p_ctx) {
+    std::vector<v8::Local<v8::Value>> values;
+    v8::Local<v8::ObjectTemplate> tmpls[DIRENT_BLOCK + 1];
+    std::deque<ReaddirNode*> queue;
+    queue.push_back(&p_ctx->m_root);
+    while (!queue.empty()) {
+        ReaddirNode* p_node = queue.front();
+        queue.pop_front();
+        values.reserve(values.size() + p_node->m_names.size());
+        if (p_ctx->m_with_file_types && !p_node->m_names.empty()) {
+            std::string parent = p_node->m_rel.empty() ? p_ctx->m_path : joinPath(p_ctx->m_path, p_node->m_rel);
+            v8::Local<v8::String> parent_path = newUtf8String(p_isolate, parent);
+            size_t count = p_node->m_names.size();
+            v8::Local<v8::Object> holder = newDirentNames(p_isolate, context, std::move(p_node->m_names));
+            for (size_t i = 0; i < count; ++i) {
+                uint8_t type = p_node->m_types[i] > DIRENT_BLOCK ? DIRENT_UNKNOWN : p_node->m_types[i];
+                if (tmpls[type].IsEmpty())
+                    tmpls[type] = getDirentTemplate(p_isolate, type);
+                values.push_back(newDirent(context, tmpls[type], holder, parent_path, static_cast<int32_t>(i)));
+            }
+        } else if (!p_ctx->m_with_file_types) {
+            for (const auto& name : p_node->m_names)
+                values.push_back(newUtf8String(p_isolate, joinPath(p_node->m_rel, name)));
+        }
+        for (const auto& up_child : p_node->m_children)
+            queue.push_back(up_child.get());
+    }
+    return v8::Array::New(p_isolate, values.data(), values.size());
+}
+
+static bool existsCached(const std::string& path);
+
 void FS::existsSync(const v8::FunctionCallbackInfo<v8::Value>& args) {
     v8::Isolate* p_isolate = args.GetIsolate();
     v8::HandleScope handle_scope(p_isolate);
@@ -799,120 +1962,932 @@ void FS::existsSync(const v8::FunctionCallbackInfo<v8::Value>& args) {
         return;
     }
 
-    args.GetReturnValue().Set(fs::exists(*path_val));
-}
+    args.GetReturnValue().Set(existsCached(*path_val));
+}
+
+// --- Stats ---
+// Workers fill a StatData with raw values in Node's packed field order. The main thread copies
+// it into an 18-slot Float64Array (BigInt64Array for { bigint: true }) carved out of a shared
+// slab, and every Stats field is a lazy data property over that array, so Dates are only built
+// when read.
+static constexpr int32_t STAT_DEV = 0;
+static constexpr int32_t STAT_MODE = 1;
+static constexpr int32_t STAT_NLINK = 2;
+static constexpr int32_t STAT_UID = 3;
+static constexpr int32_t STAT_GID = 4;
+static constexpr int32_t STAT_RDEV = 5;
+static constexpr int32_t STAT_BLKSIZE = 6;
+static constexpr int32_t STAT_INO = 7;
+static constexpr int32_t STAT_SIZE = 8;
+static constexpr int32_t STAT_BLOCKS = 9;
+static constexpr int32_t STAT_ATIME_SEC = 10;
+static constexpr int32_t STAT_MTIME_SEC = 12;
+static constexpr int32_t STAT_CTIME_SEC = 14;
+static constexpr int32_t STAT_BIRTHTIME_SEC = 16;
+static constexpr int32_t STAT_FIELD_COUNT = 18;
+
+static constexpr size_t STAT_SLAB_SIZE = 16 * 1024;
+
+// POSIX file type bits; Windows results are mapped onto the same values.
+static constexpr int64_t STAT_IFMT = 0170000;
+static constexpr int64_t STAT_IFSOCK = 0140000;
+static constexpr int64_t STAT_IFLNK = 0120000;
+static constexpr int64_t STAT_IFREG = 0100000;
+static constexpr int64_t STAT_IFBLK = 0060000;
+static constexpr int64_t STAT_IFDIR = 0040000;
+static constexpr int64_t STAT_IFCHR = 0020000;
+static constexpr int64_t STAT_IFIFO = 0010000;
+
+struct StatData {
+    int64_t m_values[STAT_FIELD_COUNT] = {};
+};
 
-v8::Local<v8::Object>
-FS::createStats(v8::Isolate* p_isolate, const fs::path& path, std::error_code& ec, bool follow_symlink) {
-    v8::Local<v8::Context> p_context = p_isolate->GetCurrentContext();
-    auto status = follow_symlink ? fs::status(path, ec) : fs::symlink_status(path, ec);
+struct StatOptions {
+    bool m_bigint = false;
+    bool m_throw_if_no_entry = true;
+};
 
-    v8::Local<v8::Object> stats = v8::Object::New(p_isolate);
+// errno values and the names libuv reports for them (uv_err_name). Anything missing reads
+// "UNKNOWN", as it does in Node.
+struct ErrnoName {
+    int32_t m_errno;
+    const char* p_name;
+};
 
-    // Add properties
-    stats
-        ->Set(p_context,
-              v8::String::NewFromUtf8Literal(p_isolate, "size"),
-              v8::Number::New(
-                  p_isolate,
-                  static_cast<double>(fs::exists(status) && fs::is_regular_file(status) ? fs::file_size(path, ec) : 0)))
-        .Check();
+static constexpr ErrnoName ERRNO_NAMES[] = {
+    {E2BIG, "E2BIG"},
+    {EACCES, "EACCES"},
+    {EADDRINUSE, "EADDRINUSE"},
+    {EADDRNOTAVAIL, "EADDRNOTAVAIL"},
+    {EAFNOSUPPORT, "EAFNOSUPPORT"},
+    {EAGAIN, "EAGAIN"},
+    {EALREADY, "EALREADY"},
+    {EBADF, "EBADF"},
+    {EBUSY, "EBUSY"},
+    {ECANCELED, "ECANCELED"},
+    {ECONNABORTED, "ECONNABORTED"},
+    {ECONNREFUSED, "ECONNREFUSED"},
+    {ECONNRESET, "ECONNRESET"},
+    {EDESTADDRREQ, "EDESTADDRREQ"},
+    {EEXIST, "EEXIST"},
+    {EFAULT, "EFAULT"},
+    {EFBIG, "EFBIG"},
+    {EHOSTUNREACH, "EHOSTUNREACH"},
+    {EINTR, "EINTR"},
+    {EINVAL, "EINVAL"},
+    {EIO, "EIO"},
+    {EISCONN, "EISCONN"},
+    {EISDIR, "EISDIR"},
+    {ELOOP, "ELOOP"},
+    {EMFILE, "EMFILE"},
+    {EMLINK, "EMLINK"},
+    {EMSGSIZE, "EMSGSIZE"},
+    {ENAMETOOLONG, "ENAMETOOLONG"},
+    {ENETDOWN, "ENETDOWN"},
+    {ENETUNREACH, "ENETUNREACH"},
+    {ENFILE, "ENFILE"},
+    {ENOBUFS, "ENOBUFS"},
+    {ENODEV, "ENODEV"},
+    {ENOENT, "ENOENT"},
+    {ENOMEM, "ENOMEM"},
+    {ENOSPC, "ENOSPC"},
+    {ENOSYS, "ENOSYS"},
+    {ENOTCONN, "ENOTCONN"},
+    {ENOTDIR, "ENOTDIR"},
+    {ENOTEMPTY, "ENOTEMPTY"},
+    {ENOTSOCK, "ENOTSOCK"},
+    {ENOTSUP, "ENOTSUP"},
+    {EOVERFLOW, "EOVERFLOW"},
+    {EPERM, "EPERM"},
+    {EPIPE, "EPIPE"},
+    {EPROTO, "EPROTO"},
+    {ERANGE, "ERANGE"},
+    {EROFS, "EROFS"},
+    {ESPIPE, "ESPIPE"},
+    {ESRCH, "ESRCH"},
+    {ETIMEDOUT, "ETIMEDOUT"},
+    {ETXTBSY, "ETXTBSY"},
+    {EXDEV, "EXDEV"},
+};
 
-    auto mtime = follow_symlink ? fs::last_write_time(path, ec) : fs::last_write_time(path, ec);
-    if (!ec) {
-        // Correct conversion to UNIX timestamp (ms)
-        auto sctp = std::chrono::time_point_cast<std::chrono::system_clock::duration>(
-            mtime - fs::file_time_type::clock::now() + std::chrono::system_clock::now());
-        double ms = static_cast<double>(
-            std::chrono::time_point_cast<std::chrono::milliseconds>(sctp).time_since_epoch().count());
-
-        stats
-            ->Set(p_context,
-                  v8::String::NewFromUtf8Literal(p_isolate, "mtime"),
-                  v8::Date::New(p_context, ms).ToLocalChecked())
-            .Check();
-        stats->Set(p_context, v8::String::NewFromUtf8Literal(p_isolate, "mtimeMs"), v8::Number::New(p_isolate, ms))
-            .Check();
+static const char* errnoName(int32_t err_no) {
+    for (const ErrnoName& entry : ERRNO_NAMES) {
+        if (entry.m_errno == err_no)
+            return entry.p_name;
     }
+    return "UNKNOWN";
+}
 
-    // Add methods (Simplified)
-    stats
-        ->Set(p_context,
-              v8::String::NewFromUtf8Literal(p_isolate, "isDirectory"),
-              v8::FunctionTemplate::New(
-                  p_isolate,
-                  [](const v8::FunctionCallbackInfo<v8::Value>& args) {
-                      args.GetReturnValue().Set(args.Data().As<v8::Boolean>());
-                  },
-                  v8::Boolean::New(p_isolate, fs::is_directory(status)))
-                  ->GetFunction(p_context)
-                  .ToLocalChecked())
-        .Check();
+static std::string syscallErrorMessage(int32_t err_no, const char* p_syscall, const std::string& path) {
+    std::string msg = std::generic_category().message(err_no);
+    if (!msg.empty())
+        msg[0] = static_cast<char>(std::tolower(static_cast<unsigned char>(msg[0])));
+    std::string out = std::string(errnoName(err_no)) + ": " + msg + ", " + p_syscall;
+    if (!path.empty())
+        out += " '" + path + "'";
+    return out;
+}
 
-    stats
-        ->Set(p_context,
-              v8::String::NewFromUtf8Literal(p_isolate, "isFile"),
-              v8::FunctionTemplate::New(
-                  p_isolate,
-                  [](const v8::FunctionCallbackInfo<v8::Value>& args) {
-                      args.GetReturnValue().Set(args.Data().As<v8::Boolean>());
-                  },
-                  v8::Boolean::New(p_isolate, fs::is_regular_file(status)))
-                  ->GetFunction(p_context)
-                  .ToLocalChecked())
+// The Error Node builds for a failed syscall: the message above plus code, errno (negated,
+// as libuv reports it), syscall and, when there is one, path.
+static v8::Local<v8::Value>
+syscallError(v8::Isolate* p_isolate, int32_t err_no, const char* p_syscall, const std::string& path) {
+    v8::Local<v8::Context> context = p_isolate->GetCurrentContext();
+    std::string msg = syscallErrorMessage(err_no, p_syscall, path);
+    v8::Local<v8::Object> error =
+        v8::Exception::Error(v8::String::NewFromUtf8(p_isolate, msg.c_str()).ToLocalChecked()).As<v8::Object>();
+    error->Set(context, v8::String::NewFromUtf8Literal(p_isolate, "errno"), v8::Integer::New(p_isolate, -err_no))
         .Check();
-
-    stats
-        ->Set(p_context,
-              v8::String::NewFromUtf8Literal(p_isolate, "isSymbolicLink"),
-              v8::FunctionTemplate::New(
-                  p_isolate,
-                  [](const v8::FunctionCallbackInfo<v8::Value>& args) {
-                      args.GetReturnValue().Set(args.Data().As<v8::Boolean>());
-                  },
-                  v8::Boolean::New(p_isolate, fs::is_symlink(status)))
-                  ->GetFunction(p_context)
-                  .ToLocalChecked())
+    error
+        ->Set(context,
+              v8::String::NewFromUtf8Literal(p_isolate, "code"),
+              v8::String::NewFromUtf8(p_isolate, errnoName(err_no)).ToLocalChecked())
+        .Check();
+    error
+        ->Set(context,
+              v8::String::NewFromUtf8Literal(p_isolate, "syscall"),
+              v8::String::NewFromUtf8(p_isolate, p_syscall).ToLocalChecked())
         .Check();
+    if (!path.empty()) {
+        error
+            ->Set(context,
+                  v8::String::NewFromUtf8Literal(p_isolate, "path"),
+                  v8::String::NewFromUtf8(p_isolate, path.c_str()).ToLocalChecked())
+            .Check();
+    }
+    return error;
+}
 
-    return stats;
+static bool isNoEntry(int32_t err_no) {
+    return err_no == ENOENT || err_no == ENOTDIR;
 }
 
-void FS::statSync(const v8::FunctionCallbackInfo<v8::Value>& args) {
-    v8::Isolate* p_isolate = args.GetIsolate();
-    v8::HandleScope handle_scope(p_isolate);
+#ifdef _WIN32
+using StatBuffer = struct _stat64;
+
+static void statSetFileTime(StatData& out, int32_t sec_index, const FILETIME& ft) {
+    // 100ns ticks since 1601-01-01; no precision is lost on the way to sec/nsec.
+    int64_t ticks = static_cast<int64_t>((static_cast<uint64_t>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime);
+    ticks -= 116444736000000000LL;
+    int64_t sec = ticks / 10000000;
+    int64_t rem = ticks % 10000000;
+    if (rem < 0) {
+        sec -= 1;
+        rem += 10000000;
+    }
+    out.m_values[sec_index] = sec;
+    out.m_values[sec_index + 1] = rem * 100;
+}
+
+static void statFillFromStat64(const StatBuffer& st, StatData& out) {
+    int64_t type = STAT_IFREG;
+    if ((st.st_mode & _S_IFMT) == _S_IFDIR)
+        type = STAT_IFDIR;
+    else if ((st.st_mode & _S_IFMT) == _S_IFCHR)
+        type = STAT_IFCHR;
+    else if ((st.st_mode & _S_IFMT) == _S_IFIFO)
+        type = STAT_IFIFO;
+    out.m_values[STAT_DEV] = st.st_dev;
+    out.m_values[STAT_MODE] = type | (st.st_mode & 0777);
+    out.m_values[STAT_NLINK] = st.st_nlink;
+    out.m_values[STAT_UID] = st.st_uid;
+    out.m_values[STAT_GID] = st.st_gid;
+    out.m_values[STAT_RDEV] = st.st_rdev;
+    out.m_values[STAT_BLKSIZE] = 4096;
+    out.m_values[STAT_INO] = st.st_ino;
+    out.m_values[STAT_SIZE] = st.st_size;
+    out.m_values[STAT_BLOCKS] = (st.st_size + 511) / 512;
+    out.m_values[STAT_ATIME_SEC] = st.st_atime;
+    out.m_values[STAT_MTIME_SEC] = st.st_mtime;
+    out.m_values[STAT_CTIME_SEC] = st.st_ctime;
+    out.m_values[STAT_BIRTHTIME_SEC] = st.st_ctime;
+}
+
+static void statFillTimes(const FILETIME& access, const FILETIME& write, const FILETIME& create, StatData& out) {
+    statSetFileTime(out, STAT_ATIME_SEC, access);
+    statSetFileTime(out, STAT_MTIME_SEC, write);
+    statSetFileTime(out, STAT_CTIME_SEC, write);
+    statSetFileTime(out, STAT_BIRTHTIME_SEC, create);
+}
+
+static bool statPath(const std::string& path, bool follow_symlink, StatData& out, int32_t& err_no) {
+    std::wstring wide = Utf8ToWide(path);
+    WIN32_FILE_ATTRIBUTE_DATA attrs;
+    bool have_attrs = GetFileAttributesExW(wide.c_str(), GetFileExInfoStandard, &attrs) != 0;
+    std::error_code ec;
+    if (!follow_symlink && have_attrs && (attrs.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) &&
+        fs::is_symlink(fs::symlink_status(path, ec))) {
+        // _wstat64 follows links, so a link (possibly dangling) is described from its own attributes.
+        out = StatData();
+        out.m_values[STAT_MODE] = STAT_IFLNK | 0777;
+        out.m_values[STAT_NLINK] = 1;
+        out.m_values[STAT_BLKSIZE] = 4096;
+        statFillTimes(attrs.ftLastAccessTime, attrs.ftLastWriteTime, attrs.ftCreationTime, out);
+        return true;
+    }
+    StatBuffer st;
+    if (_wstat64(wide.c_str(), &st) != 0) {
+        err_no = errno;
+        return false;
+    }
+    statFillFromStat64(st, out);
+    if (have_attrs)
+        statFillTimes(attrs.ftLastAccessTime, attrs.ftLastWriteTime, attrs.ftCreationTime, out);
+    return true;
+}
 
-    if (args.Length() < 1 || !args[0]->IsString()) {
-        p_isolate->ThrowException(
-            v8::String::NewFromUtf8(p_isolate, "TypeError: Path must be a string").ToLocalChecked());
+static bool statFd(int32_t fd, StatData& out, int32_t& err_no) {
+    StatBuffer st;
+    if (_fstat64(fd, &st) != 0) {
+        err_no = errno;
+        return false;
+    }
+    statFillFromStat64(st, out);
+    BY_HANDLE_FILE_INFORMATION info;
+    HANDLE handle = reinterpret_cast<HANDLE>(_get_osfhandle(fd));
+    if (handle != INVALID_HANDLE_VALUE && GetFileInformationByHandle(handle, &info))
+        statFillTimes(info.ftLastAccessTime, info.ftLastWriteTime, info.ftCreationTime, out);
+    return true;
+}
+#else
+using StatBuffer = struct stat;
+
+static void statFillFromStat(const StatBuffer& st, StatData& out) {
+    out.m_values[STAT_DEV] = static_cast<int64_t>(st.st_dev);
+    out.m_values[STAT_MODE] = static_cast<int64_t>(st.st_mode);
+    out.m_values[STAT_NLINK] = static_cast<int64_t>(st.st_nlink);
+    out.m_values[STAT_UID] = static_cast<int64_t>(st.st_uid);
+    out.m_values[STAT_GID] = static_cast<int64_t>(st.st_gid);
+    out.m_values[STAT_RDEV] = static_cast<int64_t>(st.st_rdev);
+    out.m_values[STAT_BLKSIZE] = static_cast<int64_t>(st.st_blksize);
+    out.m_values[STAT_INO] = static_cast<int64_t>(st.st_ino);
+    out.m_values[STAT_SIZE] = static_cast<int64_t>(st.st_size);
+    out.m_values[STAT_BLOCKS] = static_cast<int64_t>(st.st_blocks);
+#ifdef __APPLE__
+    const struct timespec* p_times[4] = {&st.st_atimespec, &st.st_mtimespec, &st.st_ctimespec, &st.st_birthtimespec};
+#else
+    // Plain stat has no birth time on Linux; report ctime like libuv does.
+    const struct timespec* p_times[4] = {&st.st_atim, &st.st_mtim, &st.st_ctim, &st.st_ctim};
+#endif
+    for (int32_t i = 0; i < 4; ++i) {
+        out.m_values[STAT_ATIME_SEC + i * 2] = static_cast<int64_t>(p_times[i]->tv_sec);
+        out.m_values[STAT_ATIME_SEC + i * 2 + 1] = static_cast<int64_t>(p_times[i]->tv_nsec);
+    }
+}
+
+#ifdef __linux__
+using StatxBuffer = struct statx;
+
+static void statFillFromStatx(const StatxBuffer& stx, StatData& out) {
+    out.m_values[STAT_DEV] = static_cast<int64_t>(makedev(stx.stx_dev_major, stx.stx_dev_minor));
+    out.m_values[STAT_MODE] = stx.stx_mode;
+    out.m_values[STAT_NLINK] = stx.stx_nlink;
+    out.m_values[STAT_UID] = stx.stx_uid;
+    out.m_values[STAT_GID] = stx.stx_gid;
+    out.m_values[STAT_RDEV] = static_cast<int64_t>(makedev(stx.stx_rdev_major, stx.stx_rdev_minor));
+    out.m_values[STAT_BLKSIZE] = stx.stx_blksize;
+    out.m_values[STAT_INO] = static_cast<int64_t>(stx.stx_ino);
+    out.m_values[STAT_SIZE] = static_cast<int64_t>(stx.stx_size);
+    out.m_values[STAT_BLOCKS] = static_cast<int64_t>(stx.stx_blocks);
+    const statx_timestamp* p_birth = (stx.stx_mask & STATX_BTIME) ? &stx.stx_btime : &stx.stx_ctime;
+    const statx_timestamp* p_times[4] = {&stx.stx_atime, &stx.stx_mtime, &stx.stx_ctime, p_birth};
+    for (int32_t i = 0; i < 4; ++i) {
+        out.m_values[STAT_ATIME_SEC + i * 2] = p_times[i]->tv_sec;
+        out.m_values[STAT_ATIME_SEC + i * 2 + 1] = p_times[i]->tv_nsec;
+    }
+}
+#endif
+
+// One statx() per call on Linux (falling back to fstatat where the kernel or a seccomp filter
+// lacks it); fstatat elsewhere. With AT_EMPTY_PATH and an empty path this stats dir_fd itself.
+static bool statAt(int32_t dir_fd, const char* p_path, int32_t flags, StatData& out, int32_t& err_no) {
+#ifdef __linux__
+    StatxBuffer stx;
+    if (::statx(dir_fd, p_path, flags | AT_STATX_SYNC_AS_STAT, STATX_BASIC_STATS | STATX_BTIME, &stx) == 0) {
+        statFillFromStatx(stx, out);
+        return true;
+    }
+    if (errno != ENOSYS) {
+        err_no = errno;
+        return false;
+    }
+#endif
+    StatBuffer st;
+    if (::fstatat(dir_fd, p_path, &st, flags) != 0) {
+        err_no = errno;
+        return false;
+    }
+    statFillFromStat(st, out);
+    return true;
+}
+
+static bool statPath(const std::string& path, bool follow_symlink, StatData& out, int32_t& err_no) {
+    return statAt(AT_FDCWD, path.c_str(), follow_symlink ? 0 : AT_SYMLINK_NOFOLLOW, out, err_no);
+}
+
+static bool statFd(int32_t fd, StatData& out, int32_t& err_no) {
+#ifdef __linux__
+    return statAt(fd, "", AT_EMPTY_PATH, out, err_no);
+#else
+    StatBuffer st;
+    if (::fstat(fd, &st) != 0) {
+        err_no = errno;
+        return false;
+    }
+    statFillFromStat(st, out);
+    return true;
+#endif
+}
+#endif
+
+// --- Stat cache ---
+// Opt-in cache of statSync/lstatSync/existsSync/realpathSync results for absolute paths, used
+// only from the main thread and bounded by an LRU. Errors are cached too, so repeated probes of
+// missing files are free. On Linux every entry depends on each directory along its path: the
+// cache watches them with its own inotify fd (watches are added before the lookup, so nothing is
+// missed) and drains the queue before each lookup. Changes made by this process are therefore
+// seen at once, and changes by others as soon as the kernel has queued the event. A path that
+// goes through a symlink depends on directories the walk never sees, so it is not cached at all.
+// Elsewhere, or when a directory cannot be watched, entries expire after ttl milliseconds; on
+// Linux a longer ttl still bounds what a missed event (network filesystems, bind mounts) costs.
+static constexpr char STAT_CACHE_STAT = 's';
+static constexpr char STAT_CACHE_LSTAT = 'l';
+static constexpr char STAT_CACHE_REALPATH = 'r';
+static constexpr size_t STAT_CACHE_DEFAULT_ENTRIES = 10000;
+static constexpr int64_t STAT_CACHE_FALLBACK_TTL_MS = 1000;
+#ifdef __linux__
+static constexpr int64_t STAT_CACHE_DEFAULT_TTL_MS = 30000;
+static constexpr uint32_t STAT_CACHE_WATCH_MASK = IN_ATTRIB | IN_MODIFY | IN_CREATE | IN_DELETE | IN_MOVED_FROM |
+                                                  IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+#else
+static constexpr int64_t STAT_CACHE_DEFAULT_TTL_MS = STAT_CACHE_FALLBACK_TTL_MS;
+#endif
+
+struct StatCacheEntry {
+    bool m_ok = false;
+    StatData m_data;
+    int32_t m_err_no = 0;
+    // realpath result, or the error message of a failed realpath.
+    std::string m_text;
+    std::chrono::steady_clock::time_point m_expires;
+    std::list<std::string>::iterator m_lru;
+#ifdef __linux__
+    // (watch descriptor, child name) pairs; an empty name matches any event in that directory.
+    std::vector<std::pair<int32_t, std::string>> m_deps;
+#endif
+};
+
+struct StatCache {
+    bool m_enabled = false;
+    size_t m_max_entries = STAT_CACHE_DEFAULT_ENTRIES;
+    int64_t m_ttl_ms = STAT_CACHE_DEFAULT_TTL_MS;
+    std::unordered_map<std::string, StatCacheEntry> m_entries;
+    // Keys, most recently used first.
+    std::list<std::string> m_lru;
+    uint64_t m_hits = 0;
+    uint64_t m_misses = 0;
+    uint64_t m_invalidations = 0;
+    uint64_t m_evictions = 0;
+#ifdef __linux__
+    int32_t m_inotify_fd = -1;
+    // Watch descriptor -> child name -> keys of the entries depending on it.
+    std::unordered_map<int32_t, std::unordered_multimap<std::string, std::string>> m_watches;
+#endif
+};
+
+static void statCacheConfigure(StatCache& cache, size_t max_entries, int64_t ttl_ms);
+
+static StatCache& statCache() {
+    static StatCache s_cache;
+    static bool s_loaded = false;
+    if (!s_loaded) {
+        s_loaded = true;
+        // Z8_FS_STAT_CACHE=<maxEntries> turns the cache on without touching the program.
+        const char* p_value = std::getenv("Z8_FS_STAT_CACHE");
+        if (p_value && *p_value)
+            statCacheConfigure(
+                s_cache, static_cast<size_t>(std::strtoull(p_value, nullptr, 10)), STAT_CACHE_DEFAULT_TTL_MS);
+    }
+    return s_cache;
+}
+
+static void statCacheErase(StatCache& cache, std::unordered_map<std::string, StatCacheEntry>::iterator it) {
+#ifdef __linux__
+    for (const auto& dep : it->second.m_deps) {
+        auto watch = cache.m_watches.find(dep.first);
+        if (watch == cache.m_watches.end())
+            continue;
+        auto range = watch->second.equal_range(dep.second);
+        for (auto dep_it = range.first; dep_it != range.second; ++dep_it) {
+            if (dep_it->second == it->first) {
+                watch->second.erase(dep_it);
+                break;
+            }
+        }
+        // Nothing depends on the directory any more; stop paying for its events.
+        if (watch->second.empty()) {
+            inotify_rm_watch(cache.m_inotify_fd, watch->first);
+            cache.m_watches.erase(watch);
+        }
+    }
+#endif
+    cache.m_lru.erase(it->second.m_lru);
+    cache.m_entries.erase(it);
+}
+
+static void statCacheClear(StatCache& cache) {
+    cache.m_entries.clear();
+    cache.m_lru.clear();
+#ifdef __linux__
+    for (const auto& watch : cache.m_watches)
+        inotify_rm_watch(cache.m_inotify_fd, watch.first);
+    cache.m_watches.clear();
+#endif
+}
+
+static void statCacheConfigure(StatCache& cache, size_t max_entries, int64_t ttl_ms) {
+    cache.m_enabled = max_entries > 0;
+    cache.m_max_entries = max_entries;
+    cache.m_ttl_ms = ttl_ms;
+    if (!cache.m_enabled) {
+        statCacheClear(cache);
         return;
     }
+#ifdef __linux__
+    if (cache.m_inotify_fd < 0)
+        cache.m_inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    // Without inotify (out of instances, seccomp) the cache can only bound staleness by time.
+    if (cache.m_inotify_fd < 0 && cache.m_ttl_ms == 0)
+        cache.m_ttl_ms = STAT_CACHE_FALLBACK_TTL_MS;
+#endif
+    while (cache.m_entries.size() > cache.m_max_entries) {
+        statCacheErase(cache, cache.m_entries.find(cache.m_lru.back()));
+        cache.m_evictions++;
+    }
+}
 
-    v8::String::Utf8Value path_val(p_isolate, args[0]);
-    if (*path_val == nullptr)
+#ifdef __linux__
+static void statCacheInvalidate(StatCache& cache, const std::vector<std::string>& keys) {
+    for (const auto& key : keys) {
+        auto it = cache.m_entries.find(key);
+        if (it == cache.m_entries.end())
+            continue;
+        statCacheErase(cache, it);
+        cache.m_invalidations++;
+    }
+}
+
+static void statCacheOnEvent(StatCache& cache, const inotify_event& event) {
+    if (event.mask & IN_Q_OVERFLOW) {
+        cache.m_invalidations += cache.m_entries.size();
+        statCacheClear(cache);
         return;
+    }
+    auto watch = cache.m_watches.find(event.wd);
+    if (watch == cache.m_watches.end())
+        return;
+    std::vector<std::string> keys;
+    if (event.mask & (IN_IGNORED | IN_DELETE_SELF | IN_MOVE_SELF | IN_UNMOUNT)) {
+        // The directory is gone or renamed, so nothing cached below it can be trusted.
+        for (const auto& dep : watch->second)
+            keys.push_back(dep.second);
+    } else {
+        std::string name = event.len > 0 ? std::string(event.name) : std::string();
+        auto range = watch->second.equal_range(name);
+        for (auto it = range.first; it != range.second; ++it)
+            keys.push_back(it->second);
+        if (!name.empty()) {
+            range = watch->second.equal_range(std::string());
+            for (auto it = range.first; it != range.second; ++it)
+                keys.push_back(it->second);
+        }
+    }
+    statCacheInvalidate(cache, keys);
+}
 
-    if (!isPathSafe(*path_val)) {
-        p_isolate->ThrowException(
-            v8::String::NewFromUtf8(p_isolate, "SecurityError: Path validation failed").ToLocalChecked());
+static void statCacheDrain(StatCache& cache) {
+    if (cache.m_inotify_fd < 0)
         return;
+    alignas(inotify_event) char buffer[4096];
+    for (;;) {
+        ssize_t length = read(cache.m_inotify_fd, buffer, sizeof(buffer));
+        if (length <= 0)
+            return;
+        for (ssize_t offset = 0; offset < length;) {
+            auto p_event = reinterpret_cast<const inotify_event*>(buffer + offset);
+            offset += static_cast<ssize_t>(sizeof(inotify_event) + p_event->len);
+            statCacheOnEvent(cache, *p_event);
+        }
     }
+}
 
-    std::error_code ec;
-    auto stats = createStats(p_isolate, *path_val, ec, true);
+static void statCacheDropUnused(StatCache& cache, const std::vector<std::pair<int32_t, std::string>>& deps) {
+    for (const auto& dep : deps) {
+        if (cache.m_watches.find(dep.first) == cache.m_watches.end())
+            inotify_rm_watch(cache.m_inotify_fd, dep.first);
+    }
+}
 
-    if (ec) {
-        p_isolate->ThrowException(
-            v8::String::NewFromUtf8(p_isolate, ("Error: " + ec.message()).c_str()).ToLocalChecked());
+// Watches every directory from the root down to the parent of path (and path itself for stat
+// and lstat, which fails harmlessly unless it is a directory) and records what the entry
+// depends on. Returns 1 when all of them are watched, 0 when an ancestor is missing or not a
+// directory (an error result then only depends on the ancestors watched so far), -1 when a
+// watch could not be added and -2 when a component the lookup follows is a symlink. Each
+// component is checked after its directory is watched, so a later swap still raises an event.
+static int32_t statCacheWatchPath(StatCache& cache,
+                                  const std::string& path,
+                                  char kind,
+                                  std::vector<std::pair<int32_t, std::string>>& deps) {
+    if (cache.m_inotify_fd < 0)
+        return -1;
+    std::string dir = "/";
+    size_t pos = 0;
+    while (pos < path.size()) {
+        size_t end = path.find('/', pos);
+        if (end == std::string::npos)
+            end = path.size();
+        if (end > pos) {
+            std::string name = path.substr(pos, end - pos);
+            int32_t wd = inotify_add_watch(cache.m_inotify_fd, dir.c_str(), STAT_CACHE_WATCH_MASK);
+            if (wd < 0)
+                return errno == ENOENT || errno == ENOTDIR ? 0 : -1;
+            deps.emplace_back(wd, name);
+            if (dir.size() > 1)
+                dir += '/';
+            dir += name;
+            // lstat does not follow its last component.
+            struct stat st;
+            bool followed = end < path.size() || kind != STAT_CACHE_LSTAT;
+            if (followed && ::lstat(dir.c_str(), &st) == 0 && S_ISLNK(st.st_mode))
+                return -2;
+        }
+        pos = end + 1;
+    }
+    if (kind != STAT_CACHE_REALPATH) {
+        uint32_t mask = STAT_CACHE_WATCH_MASK | (kind == STAT_CACHE_LSTAT ? IN_DONT_FOLLOW : 0);
+        int32_t wd = inotify_add_watch(cache.m_inotify_fd, dir.c_str(), mask);
+        if (wd >= 0)
+            deps.emplace_back(wd, std::string());
+    }
+    return 1;
+}
+#endif
+
+// Only absolute paths without "." or ".." segments are cached: relative ones depend on the
+// working directory, and dot segments would not line up with the watched directories.
+static bool statCacheable(const std::string& path) {
+#ifdef _WIN32
+    if (!fs::path(path).is_absolute())
+        return false;
+#else
+    if (path.empty() || path[0] != '/')
+        return false;
+#endif
+    for (size_t pos = 0; (pos = path.find('.', pos)) != std::string::npos; ++pos) {
+        bool at_start = pos == 0 || path[pos - 1] == '/' || path[pos - 1] == '\\';
+        size_t end = pos + 1 < path.size() && path[pos + 1] == '.' ? pos + 2 : pos + 1;
+        if (at_start && (end == path.size() || path[end] == '/' || path[end] == '\\'))
+            return false;
+    }
+    return true;
+}
+
+// Fills out from the cache or, on a miss, through compute (which must set m_ok, m_data,
+// m_err_no or m_text) and caches the result when it can be kept coherent.
+template <typename Compute>
+static void statCacheResolve(const std::string& path, char kind, StatCacheEntry& out, Compute compute) {
+    StatCache& cache = statCache();
+    if (!cache.m_enabled || !statCacheable(path)) {
+        compute(out);
         return;
     }
+#ifdef __linux__
+    statCacheDrain(cache);
+#endif
+    std::string key = kind + path;
+    auto now = std::chrono::steady_clock::now();
+    auto it = cache.m_entries.find(key);
+    if (it != cache.m_entries.end() && (cache.m_ttl_ms == 0 || now < it->second.m_expires)) {
+        cache.m_hits++;
+        cache.m_lru.splice(cache.m_lru.begin(), cache.m_lru, it->second.m_lru);
+        out.m_ok = it->second.m_ok;
+        out.m_data = it->second.m_data;
+        out.m_err_no = it->second.m_err_no;
+        out.m_text = it->second.m_text;
+        return;
+    }
+    cache.m_misses++;
+    if (it != cache.m_entries.end())
+        statCacheErase(cache, it);
+    // Evict before watching: dropping the last user of a directory also drops its watch.
+    if (cache.m_entries.size() >= cache.m_max_entries) {
+        statCacheErase(cache, cache.m_entries.find(cache.m_lru.back()));
+        cache.m_evictions++;
+    }
+
+    StatCacheEntry entry;
+    bool keep = cache.m_ttl_ms > 0;
+#ifdef __linux__
+    int32_t watched = statCacheWatchPath(cache, path, kind, entry.m_deps);
+#endif
+    compute(entry);
+    out.m_ok = entry.m_ok;
+    out.m_data = entry.m_data;
+    out.m_err_no = entry.m_err_no;
+    out.m_text = entry.m_text;
+#ifdef __linux__
+    keep = watched != -2 && (keep || watched > 0 || (watched == 0 && !entry.m_ok));
+    if (!keep) {
+        statCacheDropUnused(cache, entry.m_deps);
+        return;
+    }
+#else
+    if (!keep)
+        return;
+#endif
+
+    entry.m_expires = now + std::chrono::milliseconds(cache.m_ttl_ms);
+    cache.m_lru.push_front(key);
+    entry.m_lru = cache.m_lru.begin();
+#ifdef __linux__
+    for (const auto& dep : entry.m_deps)
+        cache.m_watches[dep.first].emplace(dep.second, key);
+#endif
+    cache.m_entries.emplace(std::move(key), std::move(entry));
+}
 
-    args.GetReturnValue().Set(stats);
+static bool statPathCached(const std::string& path, bool follow_symlink, StatData& out, int32_t& err_no) {
+    StatCacheEntry entry;
+    statCacheResolve(path, follow_symlink ? STAT_CACHE_STAT : STAT_CACHE_LSTAT, entry, [&](StatCacheEntry& result) {
+        result.m_ok = statPath(path, follow_symlink, result.m_data, result.m_err_no);
+    });
+    out = entry.m_data;
+    err_no = entry.m_err_no;
+    return entry.m_ok;
 }
 
-void FS::mkdirSync(const v8::FunctionCallbackInfo<v8::Value>& args) {
+static bool existsCached(const std::string& path) {
+    if (!statCache().m_enabled)
+        return fs::exists(path);
+    StatData data;
+    int32_t err_no = 0;
+    return statPathCached(path, true, data, err_no);
+}
+
+// Returns the canonical path in out, or false with the error message in out.
+static bool realpathCached(const std::string& path, std::string& out) {
+    StatCacheEntry entry;
+    statCacheResolve(path, STAT_CACHE_REALPATH, entry, [&](StatCacheEntry& result) {
+        std::error_code ec;
+        fs::path resolved = fs::canonical(path, ec);
+        result.m_ok = !ec;
+        result.m_text = ec ? ec.message() : resolved.string();
+    });
+    out = std::move(entry.m_text);
+    return entry.m_ok;
+}
+
+// fs.enableStatCache([options]) turns the cache on. options.maxEntries bounds it (0 turns it off
+// again) and options.ttl (ms) also expires entries by age.
+void FS::enableStatCache(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    v8::Local<v8::Context> context = p_isolate->GetCurrentContext();
+    double max_entries = static_cast<double>(STAT_CACHE_DEFAULT_ENTRIES);
+    double ttl = static_cast<double>(STAT_CACHE_DEFAULT_TTL_MS);
+    if (args.Length() > 0 && args[0]->IsObject()) {
+        v8::Local<v8::Object> options = args[0].As<v8::Object>();
+        v8::Local<v8::Value> value;
+        if (options->Get(context, v8::String::NewFromUtf8Literal(p_isolate, "maxEntries")).ToLocal(&value) &&
+            value->IsNumber() && value.As<v8::Number>()->Value() >= 0)
+            max_entries = value.As<v8::Number>()->Value();
+        if (options->Get(context, v8::String::NewFromUtf8Literal(p_isolate, "ttl")).ToLocal(&value) &&
+            value->IsNumber() && value.As<v8::Number>()->Value() >= 0)
+            ttl = value.As<v8::Number>()->Value();
+    }
+    statCacheConfigure(statCache(), static_cast<size_t>(max_entries), static_cast<int64_t>(ttl));
+}
+
+void FS::clearStatCache(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    StatCache& cache = statCache();
+    cache.m_invalidations += cache.m_entries.size();
+    statCacheClear(cache);
+}
+
+void FS::statCacheStats(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    v8::Local<v8::Context> context = p_isolate->GetCurrentContext();
+    StatCache& cache = statCache();
+    double hits = static_cast<double>(cache.m_hits);
+    double lookups = hits + static_cast<double>(cache.m_misses);
+    double watches = 0;
+#ifdef __linux__
+    watches = static_cast<double>(cache.m_watches.size());
+#endif
+    v8::Local<v8::Object> result = v8::Object::New(p_isolate);
+    auto set = [&](const char* p_key, v8::Local<v8::Value> value) {
+        result->Set(context, v8::String::NewFromUtf8(p_isolate, p_key).ToLocalChecked(), value).Check();
+    };
+    auto number = [&](double value) -> v8::Local<v8::Value> { return v8::Number::New(p_isolate, value); };
+    set("enabled", v8::Boolean::New(p_isolate, cache.m_enabled));
+    set("hits", number(hits));
+    set("misses", number(static_cast<double>(cache.m_misses)));
+    set("hitRatio", number(lookups > 0 ? hits / lookups : 0));
+    set("entries", number(static_cast<double>(cache.m_entries.size())));
+    set("maxEntries", number(static_cast<double>(cache.m_max_entries)));
+    set("ttl", number(static_cast<double>(cache.m_ttl_ms)));
+    set("invalidations", number(static_cast<double>(cache.m_invalidations)));
+    set("evictions", number(static_cast<double>(cache.m_evictions)));
+    set("watches", number(watches));
+    args.GetReturnValue().Set(result);
+}
+
+static const char* const STAT_DATE_NAMES[4] = {"atime", "mtime", "ctime", "birthtime"};
+
+// Internal fields of a Stats object: the packed typed array, which keeps its slab alive, and a
+// raw pointer to its first value so field reads skip the backing store lookup.
+static constexpr int32_t STATS_FIELD_VALUES = 0;
+static constexpr int32_t STATS_FIELD_DATA = 1;
+static constexpr int32_t STATS_FIELD_COUNT = 2;
+
+// Set in a callback's data when the Stats it reads is backed by a BigInt64Array.
+static constexpr int32_t STATS_BIGINT = 1 << 20;
+
+static int64_t statsRaw(const void* p_values, bool bigint, int32_t index) {
+    if (bigint)
+        return static_cast<const int64_t*>(p_values)[index];
+    return static_cast<int64_t>(static_cast<const double*>(p_values)[index]);
+}
+
+static const void* statsValues(v8::Local<v8::Object> self) {
+    return self->GetAlignedPointerFromInternalField(STATS_FIELD_DATA);
+}
+
+// Every Stats field is a lazy own data property: it is computed from the packed values on first
+// read and then stays on the instance, so Object.keys, JSON.stringify and spread see all of them.
+static void StatsField(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value>& info) {
+    int32_t data = info.Data().As<v8::Int32>()->Value();
+    int32_t index = data & ~STATS_BIGINT;
+    const void* p_values = statsValues(info.Holder());
+    if (data & STATS_BIGINT)
+        info.GetReturnValue().Set(v8::BigInt::New(info.GetIsolate(), statsRaw(p_values, true, index)));
+    else
+        info.GetReturnValue().Set(static_cast<const double*>(p_values)[index]);
+}
+
+static void StatsTimeMs(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value>& info) {
+    int32_t data = info.Data().As<v8::Int32>()->Value();
+    int32_t index = data & ~STATS_BIGINT;
+    bool bigint = (data & STATS_BIGINT) != 0;
+    const void* p_values = statsValues(info.Holder());
+    int64_t sec = statsRaw(p_values, bigint, index);
+    int64_t nsec = statsRaw(p_values, bigint, index + 1);
+    if (bigint)
+        info.GetReturnValue().Set(v8::BigInt::New(info.GetIsolate(), sec * 1000 + nsec / 1000000));
+    else
+        info.GetReturnValue().Set(static_cast<double>(sec) * 1e3 + static_cast<double>(nsec) / 1e6);
+}
+
+// Only BigIntStats have the nanosecond fields, as in Node.
+static void StatsTimeNs(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value>& info) {
+    int32_t index = info.Data().As<v8::Int32>()->Value() & ~STATS_BIGINT;
+    const void* p_values = statsValues(info.Holder());
+    int64_t sec = statsRaw(p_values, true, index);
+    int64_t nsec = statsRaw(p_values, true, index + 1);
+    info.GetReturnValue().Set(v8::BigInt::New(info.GetIsolate(), sec * 1000000000 + nsec));
+}
+
+static void StatsTimeDate(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value>& info) {
+    int32_t data = info.Data().As<v8::Int32>()->Value();
+    int32_t index = data & ~STATS_BIGINT;
+    bool bigint = (data & STATS_BIGINT) != 0;
+    const void* p_values = statsValues(info.Holder());
+    double ms = static_cast<double>(statsRaw(p_values, bigint, index)) * 1e3 +
+                static_cast<double>(statsRaw(p_values, bigint, index + 1)) / 1e6;
+    v8::Local<v8::Value> date;
+    if (v8::Date::New(info.GetIsolate()->GetCurrentContext(), ms).ToLocal(&date))
+        info.GetReturnValue().Set(date);
+}
+
+static void StatsIsType(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    // Guards against the methods being called on something other than a Stats object.
+    if (args.This()->InternalFieldCount() != STATS_FIELD_COUNT)
+        return;
+    v8::Local<v8::Value> store = args.This()->GetInternalField(STATS_FIELD_VALUES).As<v8::Value>();
+    if (!store->IsFloat64Array() && !store->IsBigInt64Array())
+        return;
+    int32_t data = args.Data().As<v8::Int32>()->Value();
+    int64_t mode = statsRaw(statsValues(args.This()), (data & STATS_BIGINT) != 0, STAT_MODE);
+    args.GetReturnValue().Set((mode & STAT_IFMT) == (data & ~STATS_BIGINT));
+}
+
+static v8::Local<v8::FunctionTemplate> getStatsTemplate(v8::Isolate* p_isolate, bool bigint) {
+    static v8::Persistent<v8::FunctionTemplate> s_tmpls[2];
+    v8::Persistent<v8::FunctionTemplate>& slot = s_tmpls[bigint ? 1 : 0];
+    if (slot.IsEmpty()) {
+        v8::Local<v8::FunctionTemplate> tmpl = v8::FunctionTemplate::New(p_isolate);
+        tmpl->SetClassName(bigint ? v8::String::NewFromUtf8Literal(p_isolate, "BigIntStats")
+                                  : v8::String::NewFromUtf8Literal(p_isolate, "Stats"));
+        v8::Local<v8::ObjectTemplate> instance = tmpl->InstanceTemplate();
+        instance->SetInternalFieldCount(STATS_FIELD_COUNT);
+        int32_t flag = bigint ? STATS_BIGINT : 0;
+        auto add_field = [&](const std::string& name, v8::AccessorNameGetterCallback getter, int32_t index) {
+            instance->SetLazyDataProperty(v8::String::NewFromUtf8(p_isolate, name.c_str()).ToLocalChecked(),
+                                          getter,
+                                          v8::Integer::New(p_isolate, index | flag));
+        };
+
+        // Node's own-property order: the raw fields, the *Ms (and *Ns) times, then the Dates.
+        const char* const p_fields[10] = {
+            "dev", "mode", "nlink", "uid", "gid", "rdev", "blksize", "ino", "size", "blocks"};
+        for (int32_t i = 0; i < 10; ++i)
+            add_field(p_fields[i], StatsField, i);
+        for (int32_t i = 0; i < 4; ++i)
+            add_field(std::string(STAT_DATE_NAMES[i]) + "Ms", StatsTimeMs, STAT_ATIME_SEC + i * 2);
+        if (bigint) {
+            for (int32_t i = 0; i < 4; ++i)
+                add_field(std::string(STAT_DATE_NAMES[i]) + "Ns", StatsTimeNs, STAT_ATIME_SEC + i * 2);
+        }
+        for (int32_t i = 0; i < 4; ++i)
+            add_field(STAT_DATE_NAMES[i], StatsTimeDate, STAT_ATIME_SEC + i * 2);
+
+        v8::Local<v8::ObjectTemplate> proto = tmpl->PrototypeTemplate();
+        const char* const p_checks[7] = {
+            "isFile", "isDirectory", "isSymbolicLink", "isFIFO", "isSocket", "isCharacterDevice", "isBlockDevice"};
+        const int64_t types[7] = {STAT_IFREG, STAT_IFDIR, STAT_IFLNK, STAT_IFIFO, STAT_IFSOCK, STAT_IFCHR, STAT_IFBLK};
+        for (int32_t i = 0; i < 7; ++i) {
+            proto->Set(v8::String::NewFromUtf8(p_isolate, p_checks[i]).ToLocalChecked(),
+                       v8::FunctionTemplate::New(
+                           p_isolate, StatsIsType, v8::Integer::New(p_isolate, static_cast<int32_t>(types[i]) | flag)));
+        }
+        slot.Reset(p_isolate, tmpl);
+    }
+    return slot.Get(p_isolate);
+}
+
+static v8::Local<v8::Object>
+newStats(v8::Isolate* p_isolate, v8::Local<v8::Context> context, const StatData& data, bool bigint) {
+    // Stats share slab ArrayBuffers instead of paying for one backing store each.
+    static v8::Persistent<v8::ArrayBuffer> s_slab;
+    static size_t s_slab_used = STAT_SLAB_SIZE;
+    constexpr size_t bytes = STAT_FIELD_COUNT * sizeof(int64_t);
+    if (s_slab_used + bytes > STAT_SLAB_SIZE) {
+        s_slab.Reset(p_isolate, v8::ArrayBuffer::New(p_isolate, STAT_SLAB_SIZE));
+        s_slab_used = 0;
+    }
+    v8::Local<v8::ArrayBuffer> slab = s_slab.Get(p_isolate);
+    char* p_dst = static_cast<char*>(slab->GetBackingStore()->Data()) + s_slab_used;
+
+    v8::Local<v8::TypedArray> view;
+    if (bigint) {
+        std::memcpy(p_dst, data.m_values, bytes);
+        view = v8::BigInt64Array::New(slab, s_slab_used, STAT_FIELD_COUNT);
+    } else {
+        double* p_doubles = reinterpret_cast<double*>(p_dst);
+        for (int32_t i = 0; i < STAT_FIELD_COUNT; ++i)
+            p_doubles[i] = static_cast<double>(data.m_values[i]);
+        view = v8::Float64Array::New(slab, s_slab_used, STAT_FIELD_COUNT);
+    }
+    s_slab_used += bytes;
+
+    v8::Local<v8::Object> stats =
+        getStatsTemplate(p_isolate, bigint)->InstanceTemplate()->NewInstance(context).ToLocalChecked();
+    stats->SetInternalField(STATS_FIELD_VALUES, view);
+    stats->SetAlignedPointerInInternalField(STATS_FIELD_DATA, p_dst);
+    return stats;
+}
+
+// Reads { bigint, throwIfNoEntry } from args[index] when it is an options object.
+static StatOptions statParseOptions(v8::Isolate* p_isolate,
+                                    v8::Local<v8::Context> context,
+                                    const v8::FunctionCallbackInfo<v8::Value>& args,
+                                    int32_t index) {
+    StatOptions options;
+    if (args.Length() <= index || !args[index]->IsObject() || args[index]->IsFunction())
+        return options;
+    v8::Local<v8::Object> obj = args[index].As<v8::Object>();
+    v8::Local<v8::Value> val;
+    if (obj->Get(context, v8::String::NewFromUtf8Literal(p_isolate, "bigint")).ToLocal(&val))
+        options.m_bigint = val->BooleanValue(p_isolate);
+    if (obj->Get(context, v8::String::NewFromUtf8Literal(p_isolate, "throwIfNoEntry")).ToLocal(&val) &&
+        !val->IsUndefined())
+        options.m_throw_if_no_entry = val->BooleanValue(p_isolate);
+    return options;
+}
+
+// Kept for callers that only have a path; a missing file yields zeroed Stats and sets ec.
+v8::Local<v8::Object>
+FS::createStats(v8::Isolate* p_isolate, const fs::path& path, std::error_code& ec, bool follow_symlink) {
+    StatData data;
+    int32_t err_no = 0;
+    if (!statPath(path.string(), follow_symlink, data, err_no))
+        ec = std::error_code(err_no, std::generic_category());
+    return newStats(p_isolate, p_isolate->GetCurrentContext(), data, false);
+}
+
+static void statSyncImpl(const v8::FunctionCallbackInfo<v8::Value>& args, bool follow_symlink) {
     v8::Isolate* p_isolate = args.GetIsolate();
     v8::HandleScope handle_scope(p_isolate);
+    v8::Local<v8::Context> p_context = p_isolate->GetCurrentContext();
 
     if (args.Length() < 1 || !args[0]->IsString()) {
         p_isolate->ThrowException(
@@ -930,18 +2905,25 @@ void FS::mkdirSync(const v8::FunctionCallbackInfo<v8::Value>& args) {
         return;
     }
 
-    std::error_code ec;
-    // Equivalent to mkdir -p
-    fs::create_directories(*path_val, ec);
-
-    if (ec) {
-        p_isolate->ThrowException(
-            v8::String::NewFromUtf8(p_isolate, ("Error creating directory: " + ec.message()).c_str()).ToLocalChecked());
+    StatOptions options = statParseOptions(p_isolate, p_context, args, 1);
+    StatData data;
+    int32_t err_no = 0;
+    if (!statPathCached(*path_val, follow_symlink, data, err_no)) {
+        // throwIfNoEntry: false returns undefined without building an Error at all.
+        if (!options.m_throw_if_no_entry && isNoEntry(err_no))
+            return;
+        p_isolate->ThrowException(syscallError(p_isolate, err_no, follow_symlink ? "stat" : "lstat", *path_val));
         return;
     }
+
+    args.GetReturnValue().Set(newStats(p_isolate, p_context, data, options.m_bigint));
 }
 
-void FS::rmSync(const v8::FunctionCallbackInfo<v8::Value>& args) {
+void FS::statSync(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    statSyncImpl(args, true);
+}
+
+void FS::mkdirSync(const v8::FunctionCallbackInfo<v8::Value>& args) {
     v8::Isolate* p_isolate = args.GetIsolate();
     v8::HandleScope handle_scope(p_isolate);
 
@@ -962,17 +2944,705 @@ void FS::rmSync(const v8::FunctionCallbackInfo<v8::Value>& args) {
     }
 
     std::error_code ec;
-    // Equivalent to rm -rf
-    fs::remove_all(*path_val, ec);
+    // Equivalent to mkdir -p
+    fs::create_directories(*path_val, ec);
 
     if (ec) {
         p_isolate->ThrowException(
-            v8::String::NewFromUtf8(p_isolate, ("Error removing path: " + ec.message()).c_str()).ToLocalChecked());
+            v8::String::NewFromUtf8(p_isolate, ("Error creating directory: " + ec.message()).c_str()).ToLocalChecked());
         return;
     }
 }
 
-void FS::lstatSync(const v8::FunctionCallbackInfo<v8::Value>& args) {
+// Parallel tree walker used by rm and cp.
+// A recursive operation is split into one scan task per directory and one task per batch of
+// files, all queued on the walk's FanoutQueue. Every TreeNode counts its outstanding
+// scan/batch/child work and is finalized (rmdir for rm) only when that count reaches zero,
+// which keeps children-before-parent ordering without a global barrier.
+static constexpr size_t TREE_FILE_BATCH = 256;
+static constexpr size_t TREE_FILTER_BATCH = 256;
+
+struct TreeEntry {
+    std::string m_name;
+    uint8_t m_type = DIRENT_FILE;
+};
+
+struct TreeNode {
+    TreeNode* p_parent = nullptr;
+    std::string m_src;
+    std::string m_dest;
+    std::atomic<int64_t> m_pending{1};
+};
+
+struct TreeFilterBatch;
+
+struct TreeWalk : FanoutQueue {
+    bool m_is_copy = false;
+    bool m_recursive = true;
+    bool m_force = false;
+    bool m_error_on_exist = false;
+    std::string m_root_src;
+    std::string m_root_dest;
+
+    bool m_is_error = false;
+    std::string m_error_msg;
+    // Node error code ("ERR_FS_EISDIR"), empty for plain errors.
+    std::string m_error_code;
+    std::atomic<bool> m_failed{false};
+
+    // Only touched on the main thread.
+    v8::Global<v8::Function> m_filter;
+    bool m_has_filter = false;
+
+    // cpSync: filter batches wait here (under m_mutex) for the blocked main thread to run them.
+    bool m_sync = false;
+    std::deque<TreeFilterBatch*> m_sync_filters;
+};
+
+struct TreeFilterSlot {
+    TreeFilterBatch* p_batch = nullptr;
+    size_t m_index = 0;
+};
+
+struct TreeFilterBatch {
+    TreeWalk* p_walk = nullptr;
+    TreeNode* p_node = nullptr; // nullptr when filtering the root itself
+    std::vector<TreeEntry> m_entries;
+    std::vector<uint8_t> m_keep;
+    std::vector<TreeFilterSlot> m_slots;
+    int32_t m_remaining = 0;
+};
+
+static void treeFail(TreeWalk* p_walk, const std::string& msg, const char* p_code = nullptr) {
+    std::lock_guard<std::mutex> lock(p_walk->m_mutex);
+    if (!p_walk->m_is_error) {
+        p_walk->m_is_error = true;
+        p_walk->m_error_msg = msg;
+        if (p_code)
+            p_walk->m_error_code = p_code;
+    }
+    p_walk->m_failed.store(true);
+}
+
+// The Error a failed walk is reported with, carrying its code when it has one.
+static v8::Local<v8::Value> treeErrorValue(v8::Isolate* p_isolate, const TreeWalk* p_walk, const std::string& msg) {
+    v8::Local<v8::Value> error =
+        v8::Exception::Error(v8::String::NewFromUtf8(p_isolate, msg.c_str()).ToLocalChecked());
+    if (!p_walk->m_error_code.empty()) {
+        error.As<v8::Object>()
+            ->Set(p_isolate->GetCurrentContext(),
+                  v8::String::NewFromUtf8Literal(p_isolate, "code"),
+                  v8::String::NewFromUtf8(p_isolate, p_walk->m_error_code.c_str()).ToLocalChecked())
+            .Check();
+    }
+    return error;
+}
+
+static bool treeReadDir(const std::string& path, std::vector<TreeEntry>& entries, std::string& err) {
+    DirStream stream;
+    std::vector<std::string> names;
+    std::vector<uint8_t> types;
+    if (!stream.open(path, err, false) || !stream.read(names, types, SIZE_MAX, err))
+        return false;
+    entries.resize(names.size());
+    for (size_t i = 0; i < names.size(); ++i) {
+        entries[i].m_name = std::move(names[i]);
+        entries[i].m_type = types[i];
+    }
+    return true;
+}
+
+#ifdef _WIN32
+static bool treeUnlinkFiles(const std::string& dir, const std::vector<TreeEntry>& files, std::string& err) {
+    for (const auto& entry : files) {
+        std::error_code ec;
+        fs::remove(joinPath(dir, entry.m_name), ec);
+        if (ec) {
+            err = ec.message() + ", unlink '" + joinPath(dir, entry.m_name) + "'";
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool treeRemoveDir(const std::string& path, std::string& err) {
+    std::error_code ec;
+    fs::remove(path, ec);
+    if (ec) {
+        err = ec.message() + ", rmdir '" + path + "'";
+        return false;
+    }
+    return true;
+}
+
+static bool treeMakeDir(const std::string& src, const std::string& dest, std::string& err) {
+    std::error_code ec;
+    if (fs::create_directory(dest, src, ec) || (!ec && fs::is_directory(dest, ec)))
+        return true;
+    err = (ec ? ec.message() : std::string("cannot overwrite non-directory")) + ", mkdir '" + dest + "'";
+    return false;
+}
+
+static bool treeCopyFiles(TreeWalk* p_walk, TreeNode* p_node, const std::vector<TreeEntry>& files, std::string& err) {
+    for (const auto& entry : files) {
+        std::string src = joinPath(p_node->m_src, entry.m_name);
+        std::string dest = joinPath(p_node->m_dest, entry.m_name);
+        std::error_code ec;
+        if (entry.m_type != DIRENT_FILE && entry.m_type != DIRENT_LINK) {
+            err = "cannot copy a special file, cp '" + src + "'";
+            return false;
+        }
+        bool exists = fs::exists(fs::symlink_status(dest, ec));
+        if (exists && !p_walk->m_force) {
+            if (p_walk->m_error_on_exist) {
+                treeFail(p_walk, "EEXIST: file already exists, cp '" + dest + "'", "ERR_FS_CP_EEXIST");
+                return false;
+            }
+            continue;
+        }
+        if (entry.m_type == DIRENT_LINK) {
+            if (exists)
+                fs::remove(dest, ec);
+            fs::copy_symlink(src, dest, ec);
+        } else {
+            fs::copy_file(src, dest, fs::copy_options::overwrite_existing, ec);
+        }
+        if (ec) {
+            err = ec.message() + ", cp '" + src + "'";
+            return false;
+        }
+    }
+    return true;
+}
+#else
+static bool treeUnlinkFiles(const std::string& dir, const std::vector<TreeEntry>& files, std::string& err) {
+    int32_t dir_fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    if (dir_fd < 0) {
+        err = errnoMessage("rm", dir);
+        return false;
+    }
+    bool ok = true;
+    for (const auto& entry : files) {
+        if (unlinkat(dir_fd, entry.m_name.c_str(), 0) != 0 && errno != ENOENT) {
+            err = errnoMessage("unlink", joinPath(dir, entry.m_name));
+            ok = false;
+            break;
+        }
+    }
+    ::close(dir_fd);
+    return ok;
+}
+
+static bool treeRemoveDir(const std::string& path, std::string& err) {
+    if (::rmdir(path.c_str()) != 0 && errno != ENOENT) {
+        err = errnoMessage("rmdir", path);
+        return false;
+    }
+    return true;
+}
+
+static bool treeMakeDir(const std::string& src, const std::string& dest, std::string& err) {
+    struct stat st;
+    if (::stat(src.c_str(), &st) != 0) {
+        err = errnoMessage("stat", src);
+        return false;
+    }
+    if (::mkdir(dest.c_str(), st.st_mode & 07777) == 0)
+        return true;
+    if (errno == EEXIST) {
+        struct stat dest_st;
+        if (::stat(dest.c_str(), &dest_st) == 0 && S_ISDIR(dest_st.st_mode))
+            return true;
+        err = "cannot overwrite non-directory, cp '" + dest + "'";
+        return false;
+    }
+    err = errnoMessage("mkdir", dest);
+    return false;
+}
+
+static bool treeCopyData(int32_t in_fd, int32_t out_fd, int64_t size) {
+#ifdef __linux__
+    // copy_file_range keeps the data in the kernel (and server-side on NFS/CIFS/reflink filesystems).
+    int64_t remaining = size;
+    while (remaining > 0) {
+        ssize_t n = copy_file_range(in_fd, nullptr, out_fd, nullptr, static_cast<size_t>(remaining), 0);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            if (remaining == size && (errno == EXDEV || errno == ENOSYS || errno == EINVAL || errno == EOPNOTSUPP))
+                break; // not supported here, fall back to read/write
+            return false;
+        }
+        if (n == 0)
+            return true;
+        remaining -= n;
+    }
+    if (remaining <= 0)
+        return true;
+#else
+    (void) size;
+#endif
+    char buf[65536];
+    for (;;) {
+        ssize_t n = ::read(in_fd, buf, sizeof(buf));
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        if (n == 0)
+            return true;
+        for (ssize_t off = 0; off < n;) {
+            ssize_t w = ::write(out_fd, buf + off, static_cast<size_t>(n - off));
+            if (w < 0) {
+                if (errno == EINTR)
+                    continue;
+                return false;
+            }
+            off += w;
+        }
+    }
+}
+
+static bool treeCopyFiles(TreeWalk* p_walk, TreeNode* p_node, const std::vector<TreeEntry>& files, std::string& err) {
+    int32_t src_fd = ::open(p_node->m_src.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (src_fd < 0) {
+        err = errnoMessage("cp", p_node->m_src);
+        return false;
+    }
+    int32_t dest_fd = ::open(p_node->m_dest.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dest_fd < 0) {
+        err = errnoMessage("cp", p_node->m_dest);
+        ::close(src_fd);
+        return false;
+    }
+
+    bool ok = true;
+    for (const auto& entry : files) {
+        const char* p_name = entry.m_name.c_str();
+        if (entry.m_type != DIRENT_FILE && entry.m_type != DIRENT_LINK) {
+            err = "cannot copy a special file, cp '" + joinPath(p_node->m_src, entry.m_name) + "'";
+            ok = false;
+            break;
+        }
+
+        struct stat dest_st;
+        if (fstatat(dest_fd, p_name, &dest_st, AT_SYMLINK_NOFOLLOW) == 0 && !p_walk->m_force) {
+            if (p_walk->m_error_on_exist) {
+                treeFail(p_walk,
+                         "EEXIST: file already exists, cp '" + joinPath(p_node->m_dest, entry.m_name) + "'",
+                         "ERR_FS_CP_EEXIST");
+                ok = false;
+                break;
+            }
+            continue;
+        }
+
+        if (entry.m_type == DIRENT_LINK) {
+            char target[4096];
+            ssize_t len = readlinkat(src_fd, p_name, target, sizeof(target) - 1);
+            if (len < 0) {
+                err = errnoMessage("readlink", joinPath(p_node->m_src, entry.m_name));
+                ok = false;
+                break;
+            }
+            target[len] = '\0';
+            unlinkat(dest_fd, p_name, 0);
+            if (symlinkat(target, dest_fd, p_name) != 0) {
+                err = errnoMessage("symlink", joinPath(p_node->m_dest, entry.m_name));
+                ok = false;
+                break;
+            }
+            continue;
+        }
+
+        int32_t in_fd = openat(src_fd, p_name, O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+        if (in_fd < 0) {
+            err = errnoMessage("open", joinPath(p_node->m_src, entry.m_name));
+            ok = false;
+            break;
+        }
+        struct stat st;
+        if (fstat(in_fd, &st) != 0) {
+            err = errnoMessage("stat", joinPath(p_node->m_src, entry.m_name));
+            ::close(in_fd);
+            ok = false;
+            break;
+        }
+        int32_t out_fd = openat(dest_fd, p_name, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, st.st_mode & 07777);
+        if (out_fd < 0) {
+            err = errnoMessage("open", joinPath(p_node->m_dest, entry.m_name));
+            ::close(in_fd);
+            ok = false;
+            break;
+        }
+        bool copied = treeCopyData(in_fd, out_fd, static_cast<int64_t>(st.st_size));
+        if (!copied)
+            err = errnoMessage("copyfile", joinPath(p_node->m_src, entry.m_name));
+        ::close(out_fd);
+        ::close(in_fd);
+        if (!copied) {
+            ok = false;
+            break;
+        }
+    }
+    ::close(dest_fd);
+    ::close(src_fd);
+    return ok;
+}
+#endif
+
+static void treeScan(TreeWalk* p_walk, TreeNode* p_node);
+static void treeFilterPost(TreeWalk* p_walk, TreeNode* p_node, std::vector<TreeEntry>&& entries);
+
+static void treeRelease(TreeWalk* p_walk, TreeNode* p_node) {
+    while (p_node && p_node->m_pending.fetch_sub(1) == 1) {
+        if (!p_walk->m_is_copy && !p_walk->m_failed.load()) {
+            std::string err;
+            if (!treeRemoveDir(p_node->m_src, err))
+                treeFail(p_walk, err);
+        }
+        TreeNode* p_parent = p_node->p_parent;
+        if (!p_parent)
+            fanoutMarkDone(p_walk);
+        delete p_node;
+        p_node = p_parent;
+    }
+}
+
+static void treeFiles(TreeWalk* p_walk, TreeNode* p_node, const std::vector<TreeEntry>& files) {
+    if (p_walk->m_failed.load())
+        return;
+    std::string err;
+    bool ok = p_walk->m_is_copy ? treeCopyFiles(p_walk, p_node, files, err)
+                                : treeUnlinkFiles(p_node->m_src, files, err);
+    if (!ok)
+        treeFail(p_walk, err);
+}
+
+// Subdirectories become new scan tasks; files are cut into batches and the tail batch is
+// handled inline by the current worker.
+static void treeDispatch(TreeWalk* p_walk, TreeNode* p_node, std::vector<TreeEntry>& entries) {
+    std::vector<TreeEntry> files;
+    for (auto& entry : entries) {
+        if (entry.m_type == DIRENT_DIR) {
+            TreeNode* p_child = new TreeNode();
+            p_child->p_parent = p_node;
+            p_child->m_src = joinPath(p_node->m_src, entry.m_name);
+            if (p_walk->m_is_copy)
+                p_child->m_dest = joinPath(p_node->m_dest, entry.m_name);
+            p_node->m_pending.fetch_add(1);
+            fanoutSubmit(p_walk, [p_walk, p_child]() { treeScan(p_walk, p_child); });
+            continue;
+        }
+        files.push_back(std::move(entry));
+        if (files.size() == TREE_FILE_BATCH) {
+            p_node->m_pending.fetch_add(1);
+            fanoutSubmit(p_walk, [p_walk, p_node, batch = std::move(files)]() {
+                treeFiles(p_walk, p_node, batch);
+                treeRelease(p_walk, p_node);
+            });
+            files.clear();
+        }
+    }
+    if (!files.empty())
+        treeFiles(p_walk, p_node, files);
+}
+
+static void treeScan(TreeWalk* p_walk, TreeNode* p_node) {
+    if (!p_walk->m_failed.load()) {
+        std::vector<TreeEntry> entries;
+        std::string err;
+        if (p_walk->m_is_copy && !treeMakeDir(p_node->m_src, p_node->m_dest, err)) {
+            treeFail(p_walk, err);
+        } else if (!treeReadDir(p_node->m_src, entries, err)) {
+            treeFail(p_walk, err);
+        } else if (p_walk->m_has_filter && !entries.empty()) {
+            treeFilterPost(p_walk, p_node, std::move(entries));
+        } else {
+            treeDispatch(p_walk, p_node, entries);
+        }
+    }
+    treeRelease(p_walk, p_node);
+}
+
+// Root step of rm. Runs on a walk worker.
+static void treeRunRemove(TreeWalk* p_walk) {
+    const std::string& path = p_walk->m_root_src;
+    std::error_code ec;
+    fs::file_status status = fs::symlink_status(path, ec);
+    if (!fs::exists(status)) {
+        if (!p_walk->m_force)
+            treeFail(p_walk, "ENOENT: no such file or directory, rm '" + path + "'");
+    } else if (fs::is_directory(status) && !p_walk->m_recursive) {
+        // Like Node, even an empty directory needs { recursive: true }.
+        treeFail(p_walk, "Path is a directory: rm returned EISDIR (is a directory) " + path, "ERR_FS_EISDIR");
+    } else if (!fs::is_directory(status)) {
+        fs::remove(path, ec);
+        if (ec)
+            treeFail(p_walk, ec.message() + ", rm '" + path + "'");
+    } else {
+        TreeNode* p_root = new TreeNode();
+        p_root->m_src = path;
+        fanoutSubmit(p_walk, [p_walk, p_root]() { treeScan(p_walk, p_root); });
+        return;
+    }
+    fanoutMarkDone(p_walk);
+}
+
+// Root step of cp (after the root filter, if any). Runs on a walk worker.
+static void treeRunCopy(TreeWalk* p_walk) {
+    const std::string& src = p_walk->m_root_src;
+    const std::string& dest = p_walk->m_root_dest;
+    std::error_code ec;
+    fs::file_status status = fs::symlink_status(src, ec);
+    if (!fs::exists(status)) {
+        treeFail(p_walk, "ENOENT: no such file or directory, cp '" + src + "'");
+    } else if (fs::is_directory(status)) {
+        fs::path abs_src = fs::weakly_canonical(src, ec);
+        fs::path abs_dest = fs::weakly_canonical(dest, ec);
+        auto rel = abs_dest.lexically_relative(abs_src);
+        if (!rel.empty() && *rel.begin() != "..") {
+            treeFail(p_walk, "cannot copy " + src + " to a subdirectory of self " + dest, "ERR_FS_CP_EINVAL");
+        } else if (!p_walk->m_recursive) {
+            treeFail(p_walk, "Recursive option is required to copy a directory: " + src, "ERR_FS_EISDIR");
+        } else {
+            TreeNode* p_root = new TreeNode();
+            p_root->m_src = src;
+            p_root->m_dest = dest;
+            fanoutSubmit(p_walk, [p_walk, p_root]() { treeScan(p_walk, p_root); });
+            return;
+        }
+    } else {
+        bool exists = fs::exists(fs::symlink_status(dest, ec));
+        if (exists && !p_walk->m_force) {
+            if (p_walk->m_error_on_exist)
+                treeFail(p_walk, "EEXIST: file already exists, cp '" + dest + "'", "ERR_FS_CP_EEXIST");
+        } else {
+            if (fs::is_symlink(status)) {
+                if (exists)
+                    fs::remove(dest, ec);
+                fs::copy_symlink(src, dest, ec);
+            } else {
+                fs::copy_file(src, dest, fs::copy_options::overwrite_existing, ec);
+            }
+            if (ec)
+                treeFail(p_walk, ec.message() + ", cp '" + src + "'");
+        }
+    }
+    fanoutMarkDone(p_walk);
+}
+
+// cp filter: entries are sent to the main thread in batches so JS is entered once per
+// TREE_FILTER_BATCH entries instead of once per file. Async filters are awaited per entry.
+static void treeFilterSettle(TreeFilterBatch* p_batch) {
+    if (--p_batch->m_remaining > 0)
+        return;
+    fanoutSubmit(p_batch->p_walk, [p_batch]() {
+        std::unique_ptr<TreeFilterBatch> up_batch(p_batch);
+        TreeWalk* p_walk = up_batch->p_walk;
+        if (!up_batch->p_node) {
+            if (up_batch->m_keep[0] && !p_walk->m_failed.load())
+                treeRunCopy(p_walk);
+            else
+                fanoutMarkDone(p_walk);
+            return;
+        }
+        if (!p_walk->m_failed.load()) {
+            std::vector<TreeEntry> kept;
+            for (size_t i = 0; i < up_batch->m_entries.size(); ++i) {
+                if (up_batch->m_keep[i])
+                    kept.push_back(std::move(up_batch->m_entries[i]));
+            }
+            treeDispatch(p_walk, up_batch->p_node, kept);
+        }
+        treeRelease(p_walk, up_batch->p_node);
+    });
+}
+
+static void treeFilterResolved(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto p_slot = static_cast<TreeFilterSlot*>(args.Data().As<v8::External>()->Value());
+    p_slot->p_batch->m_keep[p_slot->m_index] = args.Length() > 0 && args[0]->BooleanValue(args.GetIsolate());
+    treeFilterSettle(p_slot->p_batch);
+}
+
+static void treeFilterRejected(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto p_slot = static_cast<TreeFilterSlot*>(args.Data().As<v8::External>()->Value());
+    v8::Isolate* p_isolate = args.GetIsolate();
+    v8::Local<v8::Value> reason = args.Length() > 0 ? args[0] : v8::Undefined(p_isolate).As<v8::Value>();
+    v8::String::Utf8Value msg(p_isolate, reason);
+    treeFail(p_slot->p_batch->p_walk, *msg ? *msg : "filter rejected");
+    treeFilterSettle(p_slot->p_batch);
+}
+
+static void treeFilterCall(v8::Isolate* isolate, v8::Local<v8::Context> context, TreeFilterBatch* p_batch) {
+    TreeWalk* p_walk = p_batch->p_walk;
+    v8::Local<v8::Function> filter = p_walk->m_filter.Get(isolate);
+    size_t count = p_batch->m_entries.size();
+    p_batch->m_keep.assign(count, 0);
+    p_batch->m_slots.resize(count);
+    p_batch->m_remaining = 1;
+
+    for (size_t i = 0; i < count && !p_walk->m_failed.load(); ++i) {
+        std::string src = p_walk->m_root_src;
+        std::string dest = p_walk->m_root_dest;
+        if (p_batch->p_node) {
+            src = joinPath(p_batch->p_node->m_src, p_batch->m_entries[i].m_name);
+            dest = joinPath(p_batch->p_node->m_dest, p_batch->m_entries[i].m_name);
+        }
+        v8::Local<v8::Value> argv[2] = {v8::String::NewFromUtf8(isolate, src.c_str()).ToLocalChecked(),
+                                        v8::String::NewFromUtf8(isolate, dest.c_str()).ToLocalChecked()};
+        v8::TryCatch try_catch(isolate);
+        v8::Local<v8::Value> result;
+        if (!filter->Call(context, v8::Undefined(isolate), 2, argv).ToLocal(&result)) {
+            v8::String::Utf8Value msg(isolate, try_catch.Exception());
+            treeFail(p_walk, *msg ? *msg : "filter threw");
+            break;
+        }
+        if (result->IsPromise() && p_walk->m_sync) {
+            // Like Node, cpSync cannot wait for an async filter.
+            treeFail(p_walk,
+                     "Expected boolean to be returned from the \"filter\" function but got instance of Promise.",
+                     "ERR_INVALID_RETURN_VALUE");
+            break;
+        }
+        if (result->IsPromise()) {
+            p_batch->m_slots[i].p_batch = p_batch;
+            p_batch->m_slots[i].m_index = i;
+            v8::Local<v8::External> data = v8::External::New(isolate, &p_batch->m_slots[i]);
+            v8::Local<v8::Function> on_fulfilled =
+                v8::Function::New(context, treeFilterResolved, data).ToLocalChecked();
+            v8::Local<v8::Function> on_rejected =
+                v8::Function::New(context, treeFilterRejected, data).ToLocalChecked();
+            p_batch->m_remaining++;
+            (void) result.As<v8::Promise>()->Then(context, on_fulfilled, on_rejected);
+        } else {
+            p_batch->m_keep[i] = result->BooleanValue(isolate);
+        }
+    }
+    treeFilterSettle(p_batch);
+}
+
+static void treeFilterRun(v8::Isolate* isolate, v8::Local<v8::Context> context, Task* task) {
+    treeFilterCall(isolate, context, static_cast<TreeFilterBatch*>(task->p_data));
+}
+
+static void treeFilterPostBatch(TreeWalk* p_walk, TreeNode* p_node, std::vector<TreeEntry>&& entries) {
+    auto p_batch = new TreeFilterBatch();
+    p_batch->p_walk = p_walk;
+    p_batch->p_node = p_node;
+    p_batch->m_entries = std::move(entries);
+    if (p_node)
+        p_node->m_pending.fetch_add(1);
+
+    if (p_walk->m_sync) {
+        std::lock_guard<std::mutex> lock(p_walk->m_mutex);
+        p_walk->m_sync_filters.push_back(p_batch);
+        p_walk->m_done_cv.notify_all();
+        return;
+    }
+
+    z8::Task* p_task = new z8::Task();
+    p_task->m_is_promise = false;
+    p_task->p_data = p_batch;
+    p_task->m_runner = treeFilterRun;
+    TaskQueue::getInstance().enqueue(p_task);
+}
+
+static void treeFilterPost(TreeWalk* p_walk, TreeNode* p_node, std::vector<TreeEntry>&& entries) {
+    for (size_t begin = 0; begin < entries.size(); begin += TREE_FILTER_BATCH) {
+        size_t end = std::min(entries.size(), begin + TREE_FILTER_BATCH);
+        std::vector<TreeEntry> chunk(std::make_move_iterator(entries.begin() + begin),
+                                     std::make_move_iterator(entries.begin() + end));
+        treeFilterPostBatch(p_walk, p_node, std::move(chunk));
+    }
+}
+
+static TreeWalk*
+treeCreateRemove(v8::Isolate* p_isolate, const v8::FunctionCallbackInfo<v8::Value>& args, bool recursive, bool force) {
+    TreeWalk* p_walk = new TreeWalk();
+    p_walk->m_root_src = *v8::String::Utf8Value(p_isolate, args[0]);
+    p_walk->m_recursive = recursive;
+    p_walk->m_force = force;
+    p_walk->m_max_parallel = fanoutMaxParallel();
+    if (args.Length() >= 2 && args[1]->IsObject()) {
+        v8::Local<v8::Context> context = p_isolate->GetCurrentContext();
+        v8::Local<v8::Object> options = args[1].As<v8::Object>();
+        v8::Local<v8::Value> val;
+        if (options->Get(context, v8::String::NewFromUtf8Literal(p_isolate, "recursive")).ToLocal(&val) &&
+            !val->IsUndefined())
+            p_walk->m_recursive = val->BooleanValue(p_isolate);
+        if (options->Get(context, v8::String::NewFromUtf8Literal(p_isolate, "force")).ToLocal(&val) &&
+            !val->IsUndefined())
+            p_walk->m_force = val->BooleanValue(p_isolate);
+    }
+    return p_walk;
+}
+
+static TreeWalk* treeCreateCopy(v8::Isolate* p_isolate, const v8::FunctionCallbackInfo<v8::Value>& args) {
+    TreeWalk* p_walk = new TreeWalk();
+    p_walk->m_is_copy = true;
+    p_walk->m_force = true;
+    p_walk->m_root_src = *v8::String::Utf8Value(p_isolate, args[0]);
+    p_walk->m_root_dest = *v8::String::Utf8Value(p_isolate, args[1]);
+    p_walk->m_max_parallel = fanoutMaxParallel();
+    if (args.Length() >= 3 && args[2]->IsObject()) {
+        v8::Local<v8::Context> context = p_isolate->GetCurrentContext();
+        v8::Local<v8::Object> options = args[2].As<v8::Object>();
+        v8::Local<v8::Value> val;
+        if (options->Get(context, v8::String::NewFromUtf8Literal(p_isolate, "recursive")).ToLocal(&val) &&
+            !val->IsUndefined())
+            p_walk->m_recursive = val->BooleanValue(p_isolate);
+        if (options->Get(context, v8::String::NewFromUtf8Literal(p_isolate, "force")).ToLocal(&val) &&
+            !val->IsUndefined())
+            p_walk->m_force = val->BooleanValue(p_isolate);
+        if (options->Get(context, v8::String::NewFromUtf8Literal(p_isolate, "errorOnExist")).ToLocal(&val))
+            p_walk->m_error_on_exist = val->BooleanValue(p_isolate);
+        if (options->Get(context, v8::String::NewFromUtf8Literal(p_isolate, "filter")).ToLocal(&val) &&
+            val->IsFunction()) {
+            p_walk->m_filter.Reset(p_isolate, val.As<v8::Function>());
+            p_walk->m_has_filter = true;
+        }
+    }
+    return p_walk;
+}
+
+static void treeRunAsync(TreeWalk* p_walk) {
+    if (p_walk->m_is_copy && p_walk->m_has_filter) {
+        std::vector<TreeEntry> root(1);
+        treeFilterPostBatch(p_walk, nullptr, std::move(root));
+        return;
+    }
+    fanoutSubmit(p_walk, [p_walk]() {
+        if (p_walk->m_is_copy)
+            treeRunCopy(p_walk);
+        else
+            treeRunRemove(p_walk);
+    });
+}
+
+// Sync callers block the main thread until the walk is done. A cpSync filter still has to run
+// there, so while it waits the main thread also runs the filter batches the workers hand back.
+static void treeRunSync(v8::Isolate* p_isolate, TreeWalk* p_walk) {
+    p_walk->m_sync = true;
+    treeRunAsync(p_walk);
+    v8::Local<v8::Context> context = p_isolate->GetCurrentContext();
+    for (;;) {
+        TreeFilterBatch* p_batch = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(p_walk->m_mutex);
+            p_walk->m_done_cv.wait(lock, [p_walk]() { return p_walk->m_done || !p_walk->m_sync_filters.empty(); });
+            if (p_walk->m_sync_filters.empty())
+                return;
+            p_batch = p_walk->m_sync_filters.front();
+            p_walk->m_sync_filters.pop_front();
+        }
+        v8::HandleScope handle_scope(p_isolate);
+        treeFilterCall(p_isolate, context, p_batch);
+    }
+}
+
+void FS::rmSync(const v8::FunctionCallbackInfo<v8::Value>& args) {
     v8::Isolate* p_isolate = args.GetIsolate();
     v8::HandleScope handle_scope(p_isolate);
 
@@ -992,16 +3662,19 @@ void FS::lstatSync(const v8::FunctionCallbackInfo<v8::Value>& args) {
         return;
     }
 
-    std::error_code ec;
-    auto stats = createStats(p_isolate, *path_val, ec, false);
+    // Equivalent to rm -rf unless the options say otherwise
+    std::unique_ptr<TreeWalk> up_walk(treeCreateRemove(p_isolate, args, true, true));
+    treeRunSync(p_isolate, up_walk.get());
 
-    if (ec) {
+    if (up_walk->m_is_error) {
         p_isolate->ThrowException(
-            v8::String::NewFromUtf8(p_isolate, ("Error: " + ec.message()).c_str()).ToLocalChecked());
+            treeErrorValue(p_isolate, up_walk.get(), "Error removing path: " + up_walk->m_error_msg));
         return;
     }
+}
 
-    args.GetReturnValue().Set(stats);
+void FS::lstatSync(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    statSyncImpl(args, false);
 }
 
 void FS::readdirSync(const v8::FunctionCallbackInfo<v8::Value>& args) {
@@ -1025,34 +3698,25 @@ void FS::readdirSync(const v8::FunctionCallbackInfo<v8::Value>& args) {
         return;
     }
 
-    std::error_code ec;
-
-    bool with_file_types = false;
-    if (args.Length() >= 2 && args[1]->IsObject()) {
-        v8::Local<v8::Object> options = args[1].As<v8::Object>();
-        v8::Local<v8::Value> wft;
-        if (options->Get(p_context, v8::String::NewFromUtf8Literal(p_isolate, "withFileTypes")).ToLocal(&wft)) {
-            with_file_types = wft->BooleanValue(p_isolate);
-        }
-    }
-
-    std::vector<v8::Local<v8::Value>> entries;
-    for (const auto& entry : fs::directory_iterator(*path_val, ec)) {
-        if (with_file_types) {
-            entries.push_back(FS::createDirent(p_isolate, entry));
-        } else {
-            entries.push_back(
-                v8::String::NewFromUtf8(p_isolate, entry.path().filename().string().c_str()).ToLocalChecked());
-        }
+    ReaddirCtx ctx;
+    ctx.m_path = *path_val;
+    readdirParseOptions(p_isolate, p_context, args, &ctx);
+    if (ctx.m_recursive) {
+        readdirStart(&ctx);
+        fanoutWait(&ctx);
+    } else {
+        // A single directory is read right here; a pool hop would only add latency.
+        readdirScan(&ctx, &ctx.m_root);
     }
 
-    if (ec) {
+    if (ctx.m_is_error) {
         p_isolate->ThrowException(
-            v8::String::NewFromUtf8(p_isolate, ("Error reading directory: " + ec.message()).c_str()).ToLocalChecked());
+            v8::String::NewFromUtf8(p_isolate, ("Error reading directory: " + ctx.m_error_msg).c_str())
+                .ToLocalChecked());
         return;
     }
 
-    args.GetReturnValue().Set(v8::Array::New(p_isolate, entries.data(), static_cast<int32_t>(entries.size())));
+    args.GetReturnValue().Set(readdirResult(p_isolate, p_context, &ctx));
 }
 
 void FS::renameSync(const v8::FunctionCallbackInfo<v8::Value>& args) {
@@ -1138,16 +3802,14 @@ void FS::realpathSync(const v8::FunctionCallbackInfo<v8::Value>& args) {
         return;
     }
 
-    std::error_code ec;
-
-    fs::path p = fs::canonical(*path, ec); // Canonical is good for realpath
-    if (ec) {
+    std::string resolved;
+    if (!realpathCached(*path, resolved)) {
         p_isolate->ThrowException(
-            v8::String::NewFromUtf8(p_isolate, ("Error resolving realpath: " + ec.message()).c_str()).ToLocalChecked());
+            v8::String::NewFromUtf8(p_isolate, ("Error resolving realpath: " + resolved).c_str()).ToLocalChecked());
         return;
     }
 
-    args.GetReturnValue().Set(v8::String::NewFromUtf8(p_isolate, p.string().c_str()).ToLocalChecked());
+    args.GetReturnValue().Set(v8::String::NewFromUtf8(p_isolate, resolved.c_str()).ToLocalChecked());
 }
 
 void FS::accessSync(const v8::FunctionCallbackInfo<v8::Value>& args) {
@@ -1630,8 +4292,7 @@ void FS::writeSync(const v8::FunctionCallbackInfo<v8::Value>& args) {
     std::string str_data;
 
     if (args[1]->IsString()) {
-        v8::String::Utf8Value utf8(p_isolate, args[1]);
-        str_data = *utf8;
+        Buffer::toUtf8(p_isolate, args[1].As<v8::String>(), str_data);
         p_data = str_data.c_str();
         length = str_data.length();
     } else if (args[1]->IsUint8Array()) {
@@ -1810,9 +4471,30 @@ struct ReadFileCtx {
     std::string m_content;
     std::vector<char> m_binary_content;
     bool m_is_error = false;
-    std::string m_error_msg;
+    int32_t m_err_no = 0;
+    const char* p_syscall = "open";
+    // Left open by the inline fast path when it could not finish; the pool continues reading
+    // from m_read_offset, starting with a buffer of the m_size fstat reported.
+    int32_t m_fd = -1;
+    size_t m_read_offset = 0;
+    size_t m_size = 0;
+    std::unique_ptr<z8::AbortLink> up_abort;
 };
 
+// Pool reads and writes for ops with a signal go in slices of this size; an abort is noticed
+// between slices.
+static constexpr size_t IO_SLICE_SIZE = 1024 * 1024;
+
+static bool abortRequested(const std::unique_ptr<z8::AbortLink>& up_abort) {
+    return up_abort && up_abort->isAborted();
+}
+
+// ifstream opens through the C runtime, which leaves the failed open's errno behind. Call with
+// errno cleared before the open.
+static int32_t readFileOpenErrno() {
+    return errno != 0 ? errno : ENOENT;
+}
+
 void FS::readFile(const v8::FunctionCallbackInfo<v8::Value>& args) {
     v8::Isolate* p_isolate = args.GetIsolate();
     if (args.Length() < 2 || !args[0]->IsString() || !args[args.Length() - 1]->IsFunction())
@@ -1855,16 +4537,12 @@ void FS::readFile(const v8::FunctionCallbackInfo<v8::Value>& args) {
         auto p_ctx = static_cast<ReadFileCtx*>(task->p_data);
         v8::Local<v8::Value> argv[2];
         if (p_ctx->m_is_error) {
-            argv[0] =
-                v8::Exception::Error(v8::String::NewFromUtf8(isolate, p_ctx->m_error_msg.c_str()).ToLocalChecked());
+            argv[0] = syscallError(isolate, p_ctx->m_err_no, p_ctx->p_syscall, p_ctx->m_path);
             argv[1] = v8::Undefined(isolate);
         } else {
             argv[0] = v8::Null(isolate);
             if (p_ctx->m_encoding == "utf8") {
-                argv[1] = v8::String::NewFromUtf8(isolate,
-                                                  p_ctx->m_binary_content.data(),
-                                                  v8::NewStringType::kNormal,
-                                                  static_cast<int32_t>(p_ctx->m_binary_content.size()))
+                argv[1] = Buffer::decodeUtf8(isolate, p_ctx->m_binary_content.data(), p_ctx->m_binary_content.size())
                               .ToLocalChecked();
             } else {
                 v8::Local<v8::ArrayBuffer> ab = v8::ArrayBuffer::New(isolate, p_ctx->m_binary_content.size());
@@ -1877,10 +4555,11 @@ void FS::readFile(const v8::FunctionCallbackInfo<v8::Value>& args) {
     };
 
     ThreadPool::getInstance().enqueue([p_task, p_ctx]() {
+        errno = 0;
         std::ifstream file(p_ctx->m_path, std::ios::binary | std::ios::ate);
         if (!file.is_open()) {
             p_ctx->m_is_error = true;
-            p_ctx->m_error_msg = "ENOENT: no such file or directory";
+            p_ctx->m_err_no = readFileOpenErrno();
         } else {
             std::streamsize size = file.tellg();
             file.seekg(0, std::ios::beg);
@@ -1891,6 +4570,234 @@ void FS::readFile(const v8::FunctionCallbackInfo<v8::Value>& args) {
     });
 }
 
+static v8::Local<v8::Value> readFileValue(v8::Isolate* p_isolate, ReadFileCtx* p_ctx) {
+    if (p_ctx->m_encoding == "utf8") {
+        return Buffer::decodeUtf8(p_isolate, p_ctx->m_binary_content.data(), p_ctx->m_binary_content.size())
+            .ToLocalChecked();
+    }
+    v8::Local<v8::ArrayBuffer> ab = v8::ArrayBuffer::New(p_isolate, p_ctx->m_binary_content.size());
+    memcpy(ab->GetBackingStore()->Data(), p_ctx->m_binary_content.data(), p_ctx->m_binary_content.size());
+    return v8::Uint8Array::New(ab, 0, p_ctx->m_binary_content.size());
+}
+
+#ifdef __linux__
+// Inline page-cache reads for fsPromises.readFile. A small regular file is read on the main
+// thread with preadv2(RWF_NOWAIT), which fails with EAGAIN instead of blocking when a page is
+// not cached, so hot config and template files settle without a pool round trip.
+// Z8_FS_INLINE_READ_MAX sets the size limit in bytes; 0 turns the fast path off.
+static constexpr size_t READ_INLINE_DEFAULT_MAX = 64 * 1024;
+static constexpr size_t READ_GROW_CHUNK = 64 * 1024;
+
+struct ReadInlineStats {
+    uint64_t m_attempts = 0;
+    uint64_t m_hits = 0;
+    uint64_t m_misses = 0;
+    uint64_t m_skipped = 0;
+    // open() failures; they settle inline but read nothing, so they are not hits.
+    uint64_t m_errors = 0;
+};
+
+// Only touched on the main thread.
+static ReadInlineStats s_read_inline_stats;
+static bool s_read_inline_unsupported = false;
+
+static size_t readInlineMax() {
+    static size_t s_max = READ_INLINE_DEFAULT_MAX;
+    static bool s_loaded = false;
+    if (!s_loaded) {
+        s_loaded = true;
+        const char* p_value = std::getenv("Z8_FS_INLINE_READ_MAX");
+        if (p_value && *p_value)
+            s_max = static_cast<size_t>(std::strtoull(p_value, nullptr, 10));
+    }
+    return s_max;
+}
+
+// Settles the promise on the main thread when the whole file is cached and returns true.
+// Otherwise returns false, possibly leaving the fd and a partial read in p_ctx for the pool.
+static bool readFileInline(Task* p_task, ReadFileCtx* p_ctx) {
+    size_t max = readInlineMax();
+    if (max == 0 || s_read_inline_unsupported)
+        return false;
+    s_read_inline_stats.m_attempts++;
+    v8::Isolate* p_isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope handle_scope(p_isolate);
+    v8::Local<v8::Context> context = p_isolate->GetCurrentContext();
+    v8::Local<v8::Promise::Resolver> resolver = p_task->m_resolver.Get(p_isolate);
+
+    // O_NONBLOCK keeps a FIFO from stalling the open; it has no effect on regular files.
+    int32_t fd = ::open(p_ctx->m_path.c_str(), O_RDONLY | O_CLOEXEC | O_NONBLOCK);
+    if (fd < 0) {
+        int32_t err_no = errno;
+        s_read_inline_stats.m_errors++;
+        fdRelease();
+        resolver->Reject(context, syscallError(p_isolate, err_no, "open", p_ctx->m_path)).Check();
+        delete p_ctx;
+        delete p_task;
+        return true;
+    }
+    StatBuffer st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        ::close(fd);
+        s_read_inline_stats.m_skipped++;
+        return false;
+    }
+    // Empty files include procfs entries whose size is unknown; the pool reads those to EOF.
+    size_t size = static_cast<size_t>(st.st_size);
+    p_ctx->m_fd = fd;
+    p_ctx->m_size = size;
+    if (size == 0 || size > max) {
+        s_read_inline_stats.m_skipped++;
+        return false;
+    }
+    p_ctx->m_binary_content.resize(size);
+
+    while (p_ctx->m_read_offset < size) {
+        iovec iov = {p_ctx->m_binary_content.data() + p_ctx->m_read_offset, size - p_ctx->m_read_offset};
+        ssize_t got = preadv2(fd, &iov, 1, static_cast<off_t>(p_ctx->m_read_offset), RWF_NOWAIT);
+        if (got > 0) {
+            p_ctx->m_read_offset += static_cast<size_t>(got);
+            continue;
+        }
+        if (got == 0)
+            break;
+        if (errno == EINTR)
+            continue;
+        // Old kernels and some filesystems reject the flag outright; stop trying after that.
+        if (errno == EOPNOTSUPP || errno == EINVAL || errno == ENOSYS)
+            s_read_inline_unsupported = true;
+        s_read_inline_stats.m_misses++;
+        return false;
+    }
+
+    ::close(fd);
+    fdRelease();
+    p_ctx->m_fd = -1;
+    p_ctx->m_binary_content.resize(p_ctx->m_read_offset);
+    s_read_inline_stats.m_hits++;
+    resolver->Resolve(context, readFileValue(p_isolate, p_ctx)).Check();
+    delete p_ctx;
+    delete p_task;
+    return true;
+}
+
+// Pool side of a readFile the fast path started: reads from m_read_offset to EOF, growing the
+// buffer past the size fstat reported.
+static void readFileFinishFd(ReadFileCtx* p_ctx) {
+    std::vector<char>& content = p_ctx->m_binary_content;
+    // Files the fast path skipped are sized here, so large buffers are zeroed off the main thread.
+    if (content.size() < p_ctx->m_size)
+        content.resize(p_ctx->m_size);
+    while (!abortRequested(p_ctx->up_abort)) {
+        if (p_ctx->m_read_offset == content.size())
+            content.resize(content.size() + READ_GROW_CHUNK);
+        ssize_t got = ::pread(p_ctx->m_fd,
+                              content.data() + p_ctx->m_read_offset,
+                              content.size() - p_ctx->m_read_offset,
+                              static_cast<off_t>(p_ctx->m_read_offset));
+        if (got > 0) {
+            p_ctx->m_read_offset += static_cast<size_t>(got);
+            continue;
+        }
+        if (got < 0 && errno == EINTR)
+            continue;
+        if (got < 0) {
+            p_ctx->m_is_error = true;
+            p_ctx->m_err_no = errno;
+            p_ctx->p_syscall = "read";
+        }
+        break;
+    }
+    content.resize(p_ctx->m_read_offset);
+    ::close(p_ctx->m_fd);
+    p_ctx->m_fd = -1;
+}
+#endif
+
+// Non-standard: counters for the inline readFile fast path.
+void FS::readFileInlineStats(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    v8::Local<v8::Context> context = p_isolate->GetCurrentContext();
+    double attempts = 0;
+    double hits = 0;
+    double misses = 0;
+    double skipped = 0;
+    double errors = 0;
+    double max = 0;
+#ifdef __linux__
+    attempts = static_cast<double>(s_read_inline_stats.m_attempts);
+    hits = static_cast<double>(s_read_inline_stats.m_hits);
+    misses = static_cast<double>(s_read_inline_stats.m_misses);
+    skipped = static_cast<double>(s_read_inline_stats.m_skipped);
+    errors = static_cast<double>(s_read_inline_stats.m_errors);
+    max = s_read_inline_unsupported ? 0 : static_cast<double>(readInlineMax());
+#endif
+    v8::Local<v8::Object> result = v8::Object::New(p_isolate);
+    auto set = [&](const char* p_key, double value) {
+        result
+            ->Set(context,
+                  v8::String::NewFromUtf8(p_isolate, p_key).ToLocalChecked(),
+                  v8::Number::New(p_isolate, value))
+            .Check();
+    };
+    set("attempts", attempts);
+    set("hits", hits);
+    set("misses", misses);
+    set("skipped", skipped);
+    set("errors", errors);
+    // Failed opens never reach the page cache, so they are left out of the ratio.
+    set("hitRatio", attempts > errors ? hits / (attempts - errors) : 0);
+    set("maxSize", max);
+    args.GetReturnValue().Set(result);
+}
+
+// Runs once the descriptor budget lets the read open its file.
+static void readFileStart(Task* p_task, ReadFileCtx* p_ctx) {
+    // Aborted while waiting for a descriptor; the runner only cleans up.
+    if (abortRequested(p_ctx->up_abort)) {
+        fdRelease();
+        TaskQueue::getInstance().enqueue(p_task);
+        return;
+    }
+#ifdef __linux__
+    if (readFileInline(p_task, p_ctx))
+        return;
+#endif
+    ThreadPool::getInstance().enqueue([p_task, p_ctx]() {
+#ifdef __linux__
+        if (p_ctx->m_fd >= 0) {
+            readFileFinishFd(p_ctx);
+            fdRelease();
+            TaskQueue::getInstance().enqueue(p_task);
+            return;
+        }
+#endif
+        if (abortRequested(p_ctx->up_abort)) {
+            fdRelease();
+            TaskQueue::getInstance().enqueue(p_task);
+            return;
+        }
+        errno = 0;
+        std::ifstream file(p_ctx->m_path, std::ios::binary | std::ios::ate);
+        if (!file.is_open()) {
+            p_ctx->m_is_error = true;
+            p_ctx->m_err_no = readFileOpenErrno();
+        } else {
+            size_t size = static_cast<size_t>(file.tellg());
+            file.seekg(0, std::ios::beg);
+            p_ctx->m_binary_content.resize(size);
+            size_t slice = p_ctx->up_abort ? IO_SLICE_SIZE : size;
+            for (size_t done = 0; done < size && !abortRequested(p_ctx->up_abort); done += slice) {
+                size_t count = std::min(slice, size - done);
+                file.read(p_ctx->m_binary_content.data() + done, static_cast<std::streamsize>(count));
+            }
+            file.close();
+        }
+        fdRelease();
+        TaskQueue::getInstance().enqueue(p_task);
+    });
+}
+
 void FS::readFilePromise(const v8::FunctionCallbackInfo<v8::Value>& args) {
     v8::Isolate* p_isolate = args.GetIsolate();
     v8::Local<v8::Context> p_context = p_isolate->GetCurrentContext();
@@ -1928,6 +4835,11 @@ void FS::readFilePromise(const v8::FunctionCallbackInfo<v8::Value>& args) {
             v8::String::Utf8Value enc_val(p_isolate, p_enc_opt);
             p_ctx->m_encoding = *enc_val;
         }
+        p_ctx->up_abort = z8::AbortLink::create(p_isolate, p_context, args[1], p_resolver, {});
+        if (p_ctx->up_abort && p_ctx->up_abort->isSettled()) {
+            delete p_ctx;
+            return;
+        }
     }
 
     z8::Task* p_task = new z8::Task();
@@ -1936,61 +4848,133 @@ void FS::readFilePromise(const v8::FunctionCallbackInfo<v8::Value>& args) {
     p_task->p_data = p_ctx;
     p_task->m_runner = [](v8::Isolate* isolate, v8::Local<v8::Context> context, Task* task) {
         auto p_ctx = static_cast<ReadFileCtx*>(task->p_data);
+        if (p_ctx->up_abort && !p_ctx->up_abort->finish(isolate)) {
+            delete p_ctx;
+            return;
+        }
         auto p_resolver = task->m_resolver.Get(isolate);
         if (p_ctx->m_is_error) {
             p_resolver
-                ->Reject(
-                    context,
-                    v8::Exception::Error(v8::String::NewFromUtf8(isolate, p_ctx->m_error_msg.c_str()).ToLocalChecked()))
+                ->Reject(context, syscallError(isolate, p_ctx->m_err_no, p_ctx->p_syscall, p_ctx->m_path))
                 .Check();
         } else {
-            if (p_ctx->m_encoding == "utf8") {
-                p_resolver
-                    ->Resolve(context,
-                              v8::String::NewFromUtf8(isolate,
-                                                      p_ctx->m_binary_content.data(),
-                                                      v8::NewStringType::kNormal,
-                                                      static_cast<int32_t>(p_ctx->m_binary_content.size()))
-                                  .ToLocalChecked())
-                    .Check();
-            } else {
-                v8::Local<v8::ArrayBuffer> ab = v8::ArrayBuffer::New(isolate, p_ctx->m_binary_content.size());
-                memcpy(ab->GetBackingStore()->Data(), p_ctx->m_binary_content.data(), p_ctx->m_binary_content.size());
-                p_resolver->Resolve(context, v8::Uint8Array::New(ab, 0, p_ctx->m_binary_content.size())).Check();
-            }
+            p_resolver->Resolve(context, readFileValue(isolate, p_ctx)).Check();
         }
         delete p_ctx;
     };
 
-    ThreadPool::getInstance().enqueue([p_task, p_ctx]() {
-        std::ifstream file(p_ctx->m_path, std::ios::binary | std::ios::ate);
-        if (!file.is_open()) {
-            p_ctx->m_is_error = true;
-            p_ctx->m_error_msg = "ENOENT: no such file or directory";
-        } else {
-            std::streamsize size = file.tellg();
-            file.seekg(0, std::ios::beg);
-            p_ctx->m_binary_content.resize(static_cast<size_t>(size));
-            file.read(p_ctx->m_binary_content.data(), size);
-        }
-        TaskQueue::getInstance().enqueue(p_task);
-    });
+    fdAcquire([p_task, p_ctx]() { readFileStart(p_task, p_ctx); });
 }
 
-struct WriteFileCtx {
+struct WriteFileCtx : z8::IoRingRequest {
     std::string m_path;
     std::string m_content;
     std::vector<char> m_binary_content;
     bool m_is_binary = false;
     bool m_is_error = false;
-    std::string m_error_msg;
+    // Set with m_is_error, for syscallError.
+    int32_t m_err_no = 0;
+    const char* p_syscall = "open";
 
     // Zero-copy support
     v8::Global<v8::Uint8Array> m_buffer_keep_alive;
     const void* p_zero_copy_data = nullptr;
     size_t m_zero_copy_len = 0;
+
+    // io_uring path: openat -> write until done -> close, one step per completion.
+    z8::Task* p_task = nullptr;
+    uint8_t m_ring_step = 0;
+    int32_t m_ring_fd = -1;
+    size_t m_ring_written = 0;
+
+    // Durable writes: flush syncs before resolving, atomic goes through a renamed temp file.
+    bool m_flush = false;
+    bool m_atomic = false;
+    std::string m_temp_path;
+
+    std::unique_ptr<z8::AbortLink> up_abort;
 };
 
+#ifdef __linux__
+static constexpr uint8_t WRITE_RING_OPEN = 0;
+static constexpr uint8_t WRITE_RING_WRITE = 1;
+static constexpr uint8_t WRITE_RING_CLOSE = 2;
+
+// Finishes a ring-driven writeFile on the pool when the ring has no room for the next step.
+static void writeFileFinishOnPool(WriteFileCtx* p_ctx, const char* p_data, size_t length) {
+    ThreadPool::getInstance().enqueue([p_ctx, p_data, length]() {
+        while (p_ctx->m_err_no == 0 && p_ctx->m_ring_written < length) {
+            if (abortRequested(p_ctx->up_abort)) {
+                p_ctx->m_err_no = ECANCELED;
+                break;
+            }
+            size_t count = std::min(length - p_ctx->m_ring_written, IO_SLICE_SIZE);
+            ssize_t put = ::write(p_ctx->m_ring_fd, p_data + p_ctx->m_ring_written, count);
+            if (put < 0) {
+                p_ctx->m_err_no = errno;
+                p_ctx->p_syscall = "write";
+            } else {
+                p_ctx->m_ring_written += static_cast<size_t>(put);
+            }
+        }
+        ::close(p_ctx->m_ring_fd);
+        fdRelease();
+        p_ctx->m_is_error = p_ctx->m_err_no != 0;
+        TaskQueue::getInstance().enqueue(p_ctx->p_task);
+    });
+}
+
+static void writeFileRingStep(z8::IoRingRequest* p_req, int32_t result) {
+    auto p_ctx = static_cast<WriteFileCtx*>(p_req);
+    const char* p_data =
+        p_ctx->m_is_binary ? static_cast<const char*>(p_ctx->p_zero_copy_data) : p_ctx->m_content.c_str();
+    size_t length = p_ctx->m_is_binary ? p_ctx->m_zero_copy_len : p_ctx->m_content.size();
+    uint8_t step = p_ctx->m_ring_step;
+    if (step == WRITE_RING_WRITE && result == 0)
+        result = -EIO;
+    if (result < 0 && p_ctx->m_err_no == 0) {
+        p_ctx->m_err_no = -result;
+        p_ctx->p_syscall = step == WRITE_RING_OPEN ? "open" : (step == WRITE_RING_WRITE ? "write" : "close");
+    } else if (result >= 0 && step == WRITE_RING_OPEN) {
+        p_ctx->m_ring_fd = result;
+    } else if (result >= 0 && step == WRITE_RING_WRITE) {
+        p_ctx->m_ring_written += static_cast<size_t>(result);
+    }
+    // An abort stops further writes; the file is still closed through the ring.
+    if (p_ctx->m_err_no == 0 && abortRequested(p_ctx->up_abort))
+        p_ctx->m_err_no = ECANCELED;
+
+    z8::IoRing& ring = z8::IoRing::getInstance();
+    bool open = p_ctx->m_ring_fd >= 0 && step != WRITE_RING_CLOSE;
+    if (open && p_ctx->m_err_no == 0 && p_ctx->m_ring_written < length) {
+        io_uring_sqe* p_sqe = ring.acquire(p_ctx, IORING_OP_WRITE);
+        if (!p_sqe) {
+            writeFileFinishOnPool(p_ctx, p_data, length);
+            return;
+        }
+        p_sqe->fd = p_ctx->m_ring_fd;
+        p_sqe->addr = reinterpret_cast<uint64_t>(p_data + p_ctx->m_ring_written);
+        p_sqe->len = static_cast<uint32_t>(std::min<size_t>(length - p_ctx->m_ring_written, INT32_MAX));
+        p_sqe->off = p_ctx->m_ring_written;
+        p_ctx->m_ring_step = WRITE_RING_WRITE;
+        return;
+    }
+    if (open) {
+        // A failed write still closes the file before the error is reported.
+        io_uring_sqe* p_sqe = ring.acquire(p_ctx, IORING_OP_CLOSE);
+        if (p_sqe) {
+            p_sqe->fd = p_ctx->m_ring_fd;
+            p_ctx->m_ring_step = WRITE_RING_CLOSE;
+            return;
+        }
+        ::close(p_ctx->m_ring_fd);
+    }
+    fdRelease();
+    p_ctx->m_is_error = p_ctx->m_err_no != 0;
+    TaskQueue::getInstance().enqueue(p_ctx->p_task);
+}
+#endif
+
 // --- WriteFile ---
 
 void FS::writeFile(const v8::FunctionCallbackInfo<v8::Value>& args) {
@@ -2014,8 +4998,7 @@ void FS::writeFile(const v8::FunctionCallbackInfo<v8::Value>& args) {
     p_ctx->m_path = *path;
 
     if (args[1]->IsString()) {
-        v8::String::Utf8Value content(p_isolate, args[1]);
-        p_ctx->m_content = *content;
+        Buffer::toUtf8(p_isolate, args[1].As<v8::String>(), p_ctx->m_content);
         p_ctx->m_is_binary = false;
     } else if (args[1]->IsUint8Array()) {
         v8::Local<v8::Uint8Array> uint8 = args[1].As<v8::Uint8Array>();
@@ -2032,8 +5015,7 @@ void FS::writeFile(const v8::FunctionCallbackInfo<v8::Value>& args) {
         auto p_ctx = static_cast<WriteFileCtx*>(task->p_data);
         v8::Local<v8::Value> argv[1];
         if (p_ctx->m_is_error) {
-            argv[0] =
-                v8::Exception::Error(v8::String::NewFromUtf8(isolate, p_ctx->m_error_msg.c_str()).ToLocalChecked());
+            argv[0] = syscallError(isolate, p_ctx->m_err_no, p_ctx->p_syscall, p_ctx->m_path);
         } else {
             argv[0] = v8::Null(isolate);
         }
@@ -2042,10 +5024,11 @@ void FS::writeFile(const v8::FunctionCallbackInfo<v8::Value>& args) {
     };
 
     ThreadPool::getInstance().enqueue([p_task, p_ctx]() {
+        errno = 0;
         std::ofstream file(p_ctx->m_path, std::ios::binary);
         if (!file.is_open()) {
             p_ctx->m_is_error = true;
-            p_ctx->m_error_msg = "Could not open file for writing";
+            p_ctx->m_err_no = errno != 0 ? errno : EIO;
         } else {
             if (p_ctx->m_is_binary) {
                 file.write(p_ctx->m_binary_content.data(), p_ctx->m_binary_content.size());
@@ -2057,6 +5040,8 @@ void FS::writeFile(const v8::FunctionCallbackInfo<v8::Value>& args) {
     });
 }
 
+static void writeFileStart(Task* p_task, WriteFileCtx* p_ctx);
+
 void FS::writeFilePromise(const v8::FunctionCallbackInfo<v8::Value>& args) {
     v8::Isolate* p_isolate = args.GetIsolate();
     v8::Local<v8::Context> p_context = p_isolate->GetCurrentContext();
@@ -2084,8 +5069,7 @@ void FS::writeFilePromise(const v8::FunctionCallbackInfo<v8::Value>& args) {
     p_ctx->m_path = *path;
 
     if (args[1]->IsString()) {
-        v8::String::Utf8Value content(p_isolate, args[1]);
-        p_ctx->m_content = *content;
+        Buffer::toUtf8(p_isolate, args[1].As<v8::String>(), p_ctx->m_content);
         p_ctx->m_is_binary = false;
     } else if (args[1]->IsUint8Array()) {
         v8::Local<v8::Uint8Array> uint8 = args[1].As<v8::Uint8Array>();
@@ -2096,18 +5080,33 @@ void FS::writeFilePromise(const v8::FunctionCallbackInfo<v8::Value>& args) {
         p_ctx->m_is_binary = true;
     }
 
+    if (args.Length() >= 3 && args[2]->IsObject()) {
+        v8::Local<v8::Object> options = args[2].As<v8::Object>();
+        v8::Local<v8::Value> value;
+        if (options->Get(p_context, v8::String::NewFromUtf8Literal(p_isolate, "flush")).ToLocal(&value))
+            p_ctx->m_flush = value->BooleanValue(p_isolate);
+        if (options->Get(p_context, v8::String::NewFromUtf8Literal(p_isolate, "atomic")).ToLocal(&value))
+            p_ctx->m_atomic = value->BooleanValue(p_isolate);
+        p_ctx->up_abort = z8::AbortLink::create(p_isolate, p_context, options, p_resolver, {});
+        if (p_ctx->up_abort && p_ctx->up_abort->isSettled()) {
+            delete p_ctx;
+            return;
+        }
+    }
+
     z8::Task* p_task = new z8::Task();
     p_task->m_resolver.Reset(p_isolate, p_resolver);
     p_task->m_is_promise = true;
     p_task->p_data = p_ctx;
     p_task->m_runner = [](v8::Isolate* isolate, v8::Local<v8::Context> context, Task* task) {
         auto p_ctx = static_cast<WriteFileCtx*>(task->p_data);
+        if (p_ctx->up_abort && !p_ctx->up_abort->finish(isolate)) {
+            delete p_ctx;
+            return;
+        }
         auto p_resolver = task->m_resolver.Get(isolate);
         if (p_ctx->m_is_error) {
-            p_resolver
-                ->Reject(
-                    context,
-                    v8::Exception::Error(v8::String::NewFromUtf8(isolate, p_ctx->m_error_msg.c_str()).ToLocalChecked()))
+            p_resolver->Reject(context, syscallError(isolate, p_ctx->m_err_no, p_ctx->p_syscall, p_ctx->m_path))
                 .Check();
         } else {
             p_resolver->Resolve(context, v8::Undefined(isolate)).Check();
@@ -2120,94 +5119,316 @@ void FS::writeFilePromise(const v8::FunctionCallbackInfo<v8::Value>& args) {
         delete p_ctx;
     };
 
+    fdAcquire([p_task, p_ctx]() { writeFileStart(p_task, p_ctx); });
+}
+
+// Ends a durable write. The op keeps its descriptor slot until here, covering the directory fd.
+static void writeFileDurableDone(Task* p_task, WriteFileCtx* p_ctx, int32_t err_no, const char* p_syscall) {
+    if (err_no != 0) {
+        p_ctx->m_is_error = true;
+        p_ctx->m_err_no = err_no;
+        p_ctx->p_syscall = p_syscall;
+    }
+    fdRelease();
+    TaskQueue::getInstance().enqueue(p_task);
+}
+
+static void writeFileDiscardTemp(WriteFileCtx* p_ctx) {
+#ifdef _WIN32
+    _unlink(p_ctx->m_temp_path.c_str());
+#else
+    ::unlink(p_ctx->m_temp_path.c_str());
+#endif
+}
+
+// Pool side, after the group commit flushed the written file.
+static void writeFileCommitted(Task* p_task, WriteFileCtx* p_ctx, int32_t fd, int32_t err_no) {
+#ifdef _WIN32
+    _close(fd);
+#else
+    ::close(fd);
+#endif
+    if (err_no != 0 || !p_ctx->m_atomic) {
+        if (err_no != 0 && p_ctx->m_atomic)
+            writeFileDiscardTemp(p_ctx);
+        writeFileDurableDone(p_task, p_ctx, err_no, "fsync");
+        return;
+    }
+#ifdef _WIN32
+    // Windows cannot open a directory for flushing; a write-through rename is the equivalent.
+    std::wstring from = Utf8ToWide(p_ctx->m_temp_path);
+    std::wstring to = Utf8ToWide(p_ctx->m_path);
+    if (!MoveFileExW(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+        err_no = GetLastError() == ERROR_ACCESS_DENIED ? EACCES : EIO;
+        writeFileDiscardTemp(p_ctx);
+    }
+    writeFileDurableDone(p_task, p_ctx, err_no, "rename");
+#else
+    if (::rename(p_ctx->m_temp_path.c_str(), p_ctx->m_path.c_str()) != 0) {
+        err_no = errno;
+        writeFileDiscardTemp(p_ctx);
+        writeFileDurableDone(p_task, p_ctx, err_no, "rename");
+        return;
+    }
+    // The rename itself is only durable once the directory entry is flushed too.
+    std::string dir = fs::path(p_ctx->m_path).parent_path().string();
+    int32_t dir_fd = ::open(dir.empty() ? "." : dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir_fd < 0) {
+        writeFileDurableDone(p_task, p_ctx, errno, "open");
+        return;
+    }
+    groupCommitSubmit(dir_fd, SYNC_DIRECTORY, [p_task, p_ctx, dir_fd](int32_t sync_err) {
+        ::close(dir_fd);
+        writeFileDurableDone(p_task, p_ctx, sync_err, "fsync");
+    });
+#endif
+}
+
+// writeFile with flush or atomic: write on the pool, then hand the fd to the group commit.
+// Atomic writes go to a temp file next to the target, which replaces it once flushed.
+static void writeFileDurable(Task* p_task, WriteFileCtx* p_ctx) {
+    static std::atomic<uint64_t> s_temp_counter{0};
+    if (abortRequested(p_ctx->up_abort)) {
+        writeFileDurableDone(p_task, p_ctx, ECANCELED, "open");
+        return;
+    }
+    const char* p_data =
+        p_ctx->m_is_binary ? static_cast<const char*>(p_ctx->p_zero_copy_data) : p_ctx->m_content.c_str();
+    size_t length = p_ctx->m_is_binary ? p_ctx->m_zero_copy_len : p_ctx->m_content.size();
+
+    int32_t fd = -1;
+    if (p_ctx->m_atomic) {
+        uint64_t stamp = static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+        char suffix[48];
+        snprintf(suffix, sizeof(suffix), ".%llx-%llx.tmp", static_cast<unsigned long long>(stamp),
+                 static_cast<unsigned long long>(s_temp_counter.fetch_add(1)));
+        p_ctx->m_temp_path = p_ctx->m_path + suffix;
+    }
+    const std::string& target = p_ctx->m_atomic ? p_ctx->m_temp_path : p_ctx->m_path;
+#ifdef _WIN32
+    int32_t flags = _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY | (p_ctx->m_atomic ? _O_EXCL : 0);
+    fd = _open(target.c_str(), flags, _S_IREAD | _S_IWRITE);
+#else
+    int32_t flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC | (p_ctx->m_atomic ? O_EXCL : 0);
+    fd = ::open(target.c_str(), flags, 0666);
+#endif
+    if (fd < 0) {
+        writeFileDurableDone(p_task, p_ctx, errno, "open");
+        return;
+    }
+#ifndef _WIN32
+    // The temp file replaces the target, so it takes over the target's permission bits; the
+    // open mode alone would be cut down by the umask.
+    struct stat target_st;
+    if (p_ctx->m_atomic && ::stat(p_ctx->m_path.c_str(), &target_st) == 0 &&
+        ::fchmod(fd, target_st.st_mode & 07777) != 0) {
+        int32_t err_no = errno;
+        ::close(fd);
+        writeFileDiscardTemp(p_ctx);
+        writeFileDurableDone(p_task, p_ctx, err_no, "fchmod");
+        return;
+    }
+#endif
+
+    size_t done = 0;
+    while (done < length) {
+        size_t count = std::min(length - done, IO_SLICE_SIZE);
+        int64_t put = -1;
+        if (abortRequested(p_ctx->up_abort)) {
+            errno = ECANCELED;
+        } else {
+#ifdef _WIN32
+            put = _write(fd, p_data + done, static_cast<uint32_t>(count));
+#else
+            put = ::write(fd, p_data + done, count);
+#endif
+        }
+        if (put < 0 && errno == EINTR)
+            continue;
+        if (put <= 0) {
+            // An aborted atomic write discards its temp file and leaves the target untouched.
+            int32_t err_no = put < 0 ? errno : EIO;
+#ifdef _WIN32
+            _close(fd);
+#else
+            ::close(fd);
+#endif
+            if (p_ctx->m_atomic)
+                writeFileDiscardTemp(p_ctx);
+            writeFileDurableDone(p_task, p_ctx, err_no, "write");
+            return;
+        }
+        done += static_cast<size_t>(put);
+    }
+
+    groupCommitSubmit(fd, SYNC_DATA, [p_task, p_ctx, fd](int32_t err_no) {
+        ThreadPool::getInstance().enqueue([p_task, p_ctx, fd, err_no]() {
+            writeFileCommitted(p_task, p_ctx, fd, err_no);
+        });
+    });
+}
+
+// Runs once the descriptor budget lets the write open its file.
+static void writeFileStart(Task* p_task, WriteFileCtx* p_ctx) {
+    if (abortRequested(p_ctx->up_abort)) {
+        fdRelease();
+        TaskQueue::getInstance().enqueue(p_task);
+        return;
+    }
+    if (p_ctx->m_flush || p_ctx->m_atomic) {
+        ThreadPool::getInstance().enqueue([p_task, p_ctx]() { writeFileDurable(p_task, p_ctx); });
+        return;
+    }
+#ifdef __linux__
+    io_uring_sqe* p_sqe = z8::IoRing::getInstance().acquire(p_ctx, IORING_OP_OPENAT);
+    if (p_sqe) {
+        p_sqe->fd = AT_FDCWD;
+        p_sqe->addr = reinterpret_cast<uint64_t>(p_ctx->m_path.c_str());
+        p_sqe->open_flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+        p_sqe->len = 0666;
+        p_ctx->p_task = p_task;
+        p_ctx->p_complete = writeFileRingStep;
+        return;
+    }
+#endif
+
     ThreadPool::getInstance().enqueue([p_task, p_ctx]() {
+        if (abortRequested(p_ctx->up_abort)) {
+            fdRelease();
+            TaskQueue::getInstance().enqueue(p_task);
+            return;
+        }
+        const char* p_data =
+            p_ctx->m_is_binary ? static_cast<const char*>(p_ctx->p_zero_copy_data) : p_ctx->m_content.c_str();
+        size_t data_len = p_ctx->m_is_binary ? p_ctx->m_zero_copy_len : p_ctx->m_content.size();
+        size_t slice = p_ctx->up_abort ? IO_SLICE_SIZE : data_len;
 #ifdef _WIN32
         std::wstring wpath = Utf8ToWide(p_ctx->m_path);
         HANDLE h_file = CreateFileW(wpath.c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
         
         if (h_file == INVALID_HANDLE_VALUE) {
+            DWORD error = GetLastError();
             p_ctx->m_is_error = true;
-            p_ctx->m_error_msg = "Could not open file for writing (Win32 API)";
+            p_ctx->m_err_no = error == ERROR_ACCESS_DENIED
+                                  ? EACCES
+                                  : (error == ERROR_PATH_NOT_FOUND || error == ERROR_FILE_NOT_FOUND ? ENOENT : EIO);
         } else {
-            const void* p_data = p_ctx->m_is_binary ? p_ctx->p_zero_copy_data : p_ctx->m_content.c_str();
-            size_t data_len = p_ctx->m_is_binary ? p_ctx->m_zero_copy_len : p_ctx->m_content.size();
-            
-            DWORD bytes_written = 0;
-            if (!WriteFile(h_file, p_data, (DWORD)data_len, &bytes_written, nullptr)) {
-                p_ctx->m_is_error = true;
-                p_ctx->m_error_msg = "Write error (Win32 API)";
+            for (size_t done = 0; done < data_len && !abortRequested(p_ctx->up_abort); done += slice) {
+                DWORD bytes_written = 0;
+                DWORD count = static_cast<DWORD>(std::min(slice, data_len - done));
+                if (!WriteFile(h_file, p_data + done, count, &bytes_written, nullptr)) {
+                    p_ctx->m_is_error = true;
+                    p_ctx->m_err_no = GetLastError() == ERROR_DISK_FULL ? ENOSPC : EIO;
+                    p_ctx->p_syscall = "write";
+                    break;
+                }
             }
             CloseHandle(h_file);
         }
 #else
+        errno = 0;
         std::ofstream file(p_ctx->m_path, std::ios::binary);
         if (!file.is_open()) {
             p_ctx->m_is_error = true;
-            p_ctx->m_error_msg = "Could not open file for writing";
+            p_ctx->m_err_no = errno != 0 ? errno : EIO;
         } else {
-            if (p_ctx->m_is_binary) {
-                file.write(static_cast<const char*>(p_ctx->p_zero_copy_data), p_ctx->m_zero_copy_len);
-            } else {
-                file.write(p_ctx->m_content.c_str(), p_ctx->m_content.size());
+            for (size_t done = 0; done < data_len && !abortRequested(p_ctx->up_abort); done += slice)
+                file.write(p_data + done, static_cast<std::streamsize>(std::min(slice, data_len - done)));
+            file.close();
+            if (file.fail()) {
+                p_ctx->m_is_error = true;
+                p_ctx->m_err_no = errno != 0 ? errno : EIO;
+                p_ctx->p_syscall = "write";
             }
         }
 #endif
+        fdRelease();
         TaskQueue::getInstance().enqueue(p_task);
     });
 }
 
 struct StatCtx {
     std::string m_path;
-    bool m_is_error = false;
-    std::string m_error_msg;
+    int32_t m_fd = -1;
     bool m_follow_symlink = true;
-    std::error_code m_ec;
+    StatOptions m_options;
+    StatData m_data;
+    int32_t m_err_no = 0;
+    bool m_is_error = false;
 };
 
-void FS::stat(const v8::FunctionCallbackInfo<v8::Value>& args) {
-    v8::Isolate* p_isolate = args.GetIsolate();
-    if (args.Length() < 2 || !args[0]->IsString() || !args[args.Length() - 1]->IsFunction())
-        return;
-
-    v8::String::Utf8Value path(p_isolate, args[0]);
-    if (*path == nullptr)
-        return;
-    if (!isPathSafe(*path)) {
-        p_isolate->ThrowException(
-            v8::String::NewFromUtf8(p_isolate, "SecurityError: Path validation failed").ToLocalChecked());
-        return;
-    }
-    v8::Local<v8::Function> p_cb = args[args.Length() - 1].As<v8::Function>();
+static v8::Local<v8::Value> statCtxError(v8::Isolate* p_isolate, const StatCtx* p_ctx) {
+    const char* p_syscall = p_ctx->m_fd >= 0 ? "fstat" : (p_ctx->m_follow_symlink ? "stat" : "lstat");
+    return syscallError(p_isolate, p_ctx->m_err_no, p_syscall, p_ctx->m_path);
+}
 
-    auto p_ctx = new StatCtx();
-    p_ctx->m_path = *path;
+// The worker only fills StatData; the Stats object is built by the runner on the main thread.
+static void statSubmit(StatCtx* p_ctx, z8::Task* p_task) {
+    p_task->p_data = p_ctx;
+    ThreadPool::getInstance().enqueue([p_task, p_ctx]() {
+        if (p_ctx->m_fd >= 0)
+            p_ctx->m_is_error = !statFd(p_ctx->m_fd, p_ctx->m_data, p_ctx->m_err_no);
+        else
+            p_ctx->m_is_error = !statPath(p_ctx->m_path, p_ctx->m_follow_symlink, p_ctx->m_data, p_ctx->m_err_no);
+        TaskQueue::getInstance().enqueue(p_task);
+    });
+}
 
+static void statSubmitCallback(v8::Isolate* p_isolate, StatCtx* p_ctx, v8::Local<v8::Function> p_cb) {
     z8::Task* p_task = new z8::Task();
     p_task->m_callback.Reset(p_isolate, p_cb);
     p_task->m_is_promise = false;
-    p_task->p_data = p_ctx;
     p_task->m_runner = [](v8::Isolate* isolate, v8::Local<v8::Context> context, Task* task) {
         auto p_ctx = static_cast<StatCtx*>(task->p_data);
         v8::Local<v8::Value> argv[2];
         if (p_ctx->m_is_error) {
-            argv[0] =
-                v8::Exception::Error(v8::String::NewFromUtf8(isolate, p_ctx->m_error_msg.c_str()).ToLocalChecked());
+            argv[0] = statCtxError(isolate, p_ctx);
             argv[1] = v8::Undefined(isolate);
         } else {
             argv[0] = v8::Null(isolate);
-            argv[1] = FS::createStats(isolate, p_ctx->m_path, p_ctx->m_ec, p_ctx->m_follow_symlink);
+            argv[1] = newStats(isolate, context, p_ctx->m_data, p_ctx->m_options.m_bigint);
         }
         (void) task->m_callback.Get(isolate)->Call(context, context->Global(), 2, argv);
         delete p_ctx;
     };
+    statSubmit(p_ctx, p_task);
+}
 
-    ThreadPool::getInstance().enqueue([p_task, p_ctx]() {
-        if (!fs::exists(p_ctx->m_path, p_ctx->m_ec)) {
-            p_ctx->m_is_error = true;
-            p_ctx->m_error_msg = "ENOENT: no such file or directory";
-        }
-        TaskQueue::getInstance().enqueue(p_task);
-    });
+static void statSubmitPromise(v8::Isolate* p_isolate, StatCtx* p_ctx, v8::Local<v8::Promise::Resolver> p_resolver) {
+    z8::Task* p_task = new z8::Task();
+    p_task->m_resolver.Reset(p_isolate, p_resolver);
+    p_task->m_is_promise = true;
+    p_task->m_runner = [](v8::Isolate* isolate, v8::Local<v8::Context> context, Task* task) {
+        auto p_ctx = static_cast<StatCtx*>(task->p_data);
+        auto p_resolver = task->m_resolver.Get(isolate);
+        if (p_ctx->m_is_error)
+            p_resolver->Reject(context, statCtxError(isolate, p_ctx)).Check();
+        else
+            p_resolver->Resolve(context, newStats(isolate, context, p_ctx->m_data, p_ctx->m_options.m_bigint)).Check();
+        delete p_ctx;
+    };
+    statSubmit(p_ctx, p_task);
+}
+
+void FS::stat(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    if (args.Length() < 2 || !args[0]->IsString() || !args[args.Length() - 1]->IsFunction())
+        return;
+
+    v8::String::Utf8Value path(p_isolate, args[0]);
+    if (*path == nullptr)
+        return;
+    if (!isPathSafe(*path)) {
+        p_isolate->ThrowException(
+            v8::String::NewFromUtf8(p_isolate, "SecurityError: Path validation failed").ToLocalChecked());
+        return;
+    }
+
+    auto p_ctx = new StatCtx();
+    p_ctx->m_path = *path;
+    if (args.Length() > 2)
+        p_ctx->m_options = statParseOptions(p_isolate, p_isolate->GetCurrentContext(), args, 1);
+    statSubmitCallback(p_isolate, p_ctx, args[args.Length() - 1].As<v8::Function>());
 }
 
 void FS::statPromise(const v8::FunctionCallbackInfo<v8::Value>& args) {
@@ -2235,40 +5456,15 @@ void FS::statPromise(const v8::FunctionCallbackInfo<v8::Value>& args) {
 
     auto p_ctx = new StatCtx();
     p_ctx->m_path = *path;
-
-    z8::Task* p_task = new z8::Task();
-    p_task->m_resolver.Reset(p_isolate, p_resolver);
-    p_task->m_is_promise = true;
-    p_task->p_data = p_ctx;
-    p_task->m_runner = [](v8::Isolate* isolate, v8::Local<v8::Context> context, Task* task) {
-        auto p_ctx = static_cast<StatCtx*>(task->p_data);
-        auto p_resolver = task->m_resolver.Get(isolate);
-        if (p_ctx->m_is_error) {
-            p_resolver
-                ->Reject(
-                    context,
-                    v8::Exception::Error(v8::String::NewFromUtf8(isolate, p_ctx->m_error_msg.c_str()).ToLocalChecked()))
-                .Check();
-        } else {
-            p_resolver->Resolve(context, FS::createStats(isolate, p_ctx->m_path, p_ctx->m_ec, p_ctx->m_follow_symlink))
-                .Check();
-        }
-        delete p_ctx;
-    };
-
-    ThreadPool::getInstance().enqueue([p_task, p_ctx]() {
-        if (!fs::exists(p_ctx->m_path, p_ctx->m_ec)) {
-            p_ctx->m_is_error = true;
-            p_ctx->m_error_msg = "ENOENT: no such file or directory";
-        }
-        TaskQueue::getInstance().enqueue(p_task);
-    });
+    p_ctx->m_options = statParseOptions(p_isolate, p_context, args, 1);
+    statSubmitPromise(p_isolate, p_ctx, p_resolver);
 }
 
-struct UnlinkCtx {
+struct UnlinkCtx : z8::IoRingRequest {
     std::string m_path;
     bool m_is_error = false;
     std::string m_error_msg;
+    z8::Task* p_task = nullptr;
 };
 
 void FS::unlink(const v8::FunctionCallbackInfo<v8::Value>& args) {
@@ -2377,6 +5573,24 @@ void FS::unlinkPromise(const v8::FunctionCallbackInfo<v8::Value>& args) {
         delete p_ctx;
     };
 
+#ifdef __linux__
+    io_uring_sqe* p_sqe = z8::IoRing::getInstance().acquire(p_ctx, IORING_OP_UNLINKAT);
+    if (p_sqe) {
+        p_sqe->fd = AT_FDCWD;
+        p_sqe->addr = reinterpret_cast<uint64_t>(p_ctx->m_path.c_str());
+        p_ctx->p_task = p_task;
+        p_ctx->p_complete = [](z8::IoRingRequest* p_req, int32_t result) {
+            auto p_ctx = static_cast<UnlinkCtx*>(p_req);
+            if (result < 0) {
+                p_ctx->m_is_error = true;
+                p_ctx->m_error_msg = syscallErrorMessage(-result, "unlink", p_ctx->m_path);
+            }
+            TaskQueue::getInstance().enqueue(p_ctx->p_task);
+        };
+        return;
+    }
+#endif
+
     ThreadPool::getInstance().enqueue([p_task, p_ctx]() {
         #ifdef _WIN32
         std::wstring wpath = Utf8ToWide(p_ctx->m_path);
@@ -2533,14 +5747,6 @@ void FS::mkdirPromise(const v8::FunctionCallbackInfo<v8::Value>& args) {
 }
 
 // --- Readdir ---
-struct ReaddirCtx {
-    std::string m_path;
-    bool m_with_file_types = false;
-    std::vector<fs::directory_entry> m_entries;
-    bool m_is_error = false;
-    std::string m_error_msg;
-};
-
 void FS::readdir(const v8::FunctionCallbackInfo<v8::Value>& args) {
     v8::Isolate* p_isolate = args.GetIsolate();
     if (args.Length() < 2 || !args[0]->IsString() || !args[args.Length() - 1]->IsFunction())
@@ -2562,13 +5768,7 @@ void FS::readdir(const v8::FunctionCallbackInfo<v8::Value>& args) {
     p_ctx->m_path = *path;
 
     v8::Local<v8::Context> p_context = p_isolate->GetCurrentContext();
-    if (args.Length() >= 2 && args[1]->IsObject()) {
-        v8::Local<v8::Object> options = args[1].As<v8::Object>();
-        v8::Local<v8::Value> wft;
-        if (options->Get(p_context, v8::String::NewFromUtf8Literal(p_isolate, "withFileTypes")).ToLocal(&wft)) {
-            p_ctx->m_with_file_types = wft->BooleanValue(p_isolate);
-        }
-    }
+    readdirParseOptions(p_isolate, p_context, args, p_ctx);
 
     z8::Task* p_task = new z8::Task();
     p_task->m_callback.Reset(p_isolate, p_cb);
@@ -2583,34 +5783,14 @@ void FS::readdir(const v8::FunctionCallbackInfo<v8::Value>& args) {
             argv[1] = v8::Undefined(isolate);
         } else {
             argv[0] = v8::Null(isolate);
-            v8::Local<v8::Array> array = v8::Array::New(isolate, static_cast<int32_t>(p_ctx->m_entries.size()));
-            for (size_t i = 0; i < p_ctx->m_entries.size(); ++i) {
-                v8::Local<v8::Value> entry_val;
-                if (p_ctx->m_with_file_types) {
-                    entry_val = FS::createDirent(isolate, p_ctx->m_entries[i]);
-                } else {
-                    entry_val = v8::String::NewFromUtf8(isolate, p_ctx->m_entries[i].path().filename().string().c_str())
-                                    .ToLocalChecked();
-                }
-                array->Set(context, static_cast<uint32_t>(i), entry_val).Check();
-            }
-            argv[1] = array;
+            argv[1] = readdirResult(isolate, context, p_ctx);
         }
         (void) task->m_callback.Get(isolate)->Call(context, context->Global(), 2, argv);
         delete p_ctx;
     };
 
-    ThreadPool::getInstance().enqueue([p_task, p_ctx]() {
-        std::error_code ec;
-        for (const auto& entry : fs::directory_iterator(p_ctx->m_path, ec)) {
-            p_ctx->m_entries.push_back(entry);
-        }
-        if (ec) {
-            p_ctx->m_is_error = true;
-            p_ctx->m_error_msg = ec.message();
-        }
-        TaskQueue::getInstance().enqueue(p_task);
-    });
+    p_ctx->p_done_task = p_task;
+    readdirStart(p_ctx);
 }
 
 void FS::readdirPromise(const v8::FunctionCallbackInfo<v8::Value>& args) {
@@ -2627,14 +5807,7 @@ void FS::readdirPromise(const v8::FunctionCallbackInfo<v8::Value>& args) {
     v8::String::Utf8Value path(p_isolate, args[0]);
     auto p_ctx = new ReaddirCtx();
     p_ctx->m_path = *path;
-
-    if (args.Length() >= 2 && args[1]->IsObject()) {
-        v8::Local<v8::Object> options = args[1].As<v8::Object>();
-        v8::Local<v8::Value> wft;
-        if (options->Get(p_context, v8::String::NewFromUtf8Literal(p_isolate, "withFileTypes")).ToLocal(&wft)) {
-            p_ctx->m_with_file_types = wft->BooleanValue(p_isolate);
-        }
-    }
+    readdirParseOptions(p_isolate, p_context, args, p_ctx);
 
     z8::Task* p_task = new z8::Task();
     p_task->m_resolver.Reset(p_isolate, p_resolver);
@@ -2650,33 +5823,13 @@ void FS::readdirPromise(const v8::FunctionCallbackInfo<v8::Value>& args) {
                     v8::Exception::Error(v8::String::NewFromUtf8(isolate, p_ctx->m_error_msg.c_str()).ToLocalChecked()))
                 .Check();
         } else {
-            v8::Local<v8::Array> array = v8::Array::New(isolate, static_cast<int32_t>(p_ctx->m_entries.size()));
-            for (size_t i = 0; i < p_ctx->m_entries.size(); ++i) {
-                v8::Local<v8::Value> entry_val;
-                if (p_ctx->m_with_file_types) {
-                    entry_val = FS::createDirent(isolate, p_ctx->m_entries[i]);
-                } else {
-                    entry_val = v8::String::NewFromUtf8(isolate, p_ctx->m_entries[i].path().filename().string().c_str())
-                                    .ToLocalChecked();
-                }
-                array->Set(context, static_cast<uint32_t>(i), entry_val).Check();
-            }
-            p_resolver->Resolve(context, array).Check();
+            p_resolver->Resolve(context, readdirResult(isolate, context, p_ctx)).Check();
         }
         delete p_ctx;
     };
 
-    ThreadPool::getInstance().enqueue([p_task, p_ctx]() {
-        std::error_code ec;
-        for (const auto& entry : fs::directory_iterator(p_ctx->m_path, ec)) {
-            p_ctx->m_entries.push_back(entry);
-        }
-        if (ec) {
-            p_ctx->m_is_error = true;
-            p_ctx->m_error_msg = ec.message();
-        }
-        TaskQueue::getInstance().enqueue(p_task);
-    });
+    p_ctx->p_done_task = p_task;
+    readdirStart(p_ctx);
 }
 
 // --- Rmdir ---
@@ -2771,11 +5924,12 @@ void FS::rmdirPromise(const v8::FunctionCallbackInfo<v8::Value>& args) {
 }
 
 // --- Rename ---
-struct RenameCtx {
+struct RenameCtx : z8::IoRingRequest {
     std::string m_old_path;
     std::string m_new_path;
     bool m_is_error = false;
     std::string m_error_msg;
+    z8::Task* p_task = nullptr;
 };
 
 void FS::rename(const v8::FunctionCallbackInfo<v8::Value>& args) {
@@ -2855,6 +6009,26 @@ void FS::renamePromise(const v8::FunctionCallbackInfo<v8::Value>& args) {
         delete p_ctx;
     };
 
+#ifdef __linux__
+    io_uring_sqe* p_sqe = z8::IoRing::getInstance().acquire(p_ctx, IORING_OP_RENAMEAT);
+    if (p_sqe) {
+        p_sqe->fd = AT_FDCWD;
+        p_sqe->addr = reinterpret_cast<uint64_t>(p_ctx->m_old_path.c_str());
+        p_sqe->len = static_cast<uint32_t>(AT_FDCWD);
+        p_sqe->addr2 = reinterpret_cast<uint64_t>(p_ctx->m_new_path.c_str());
+        p_ctx->p_task = p_task;
+        p_ctx->p_complete = [](z8::IoRingRequest* p_req, int32_t result) {
+            auto p_ctx = static_cast<RenameCtx*>(p_req);
+            if (result < 0) {
+                p_ctx->m_is_error = true;
+                p_ctx->m_error_msg = syscallErrorMessage(-result, "rename", p_ctx->m_old_path);
+            }
+            TaskQueue::getInstance().enqueue(p_ctx->p_task);
+        };
+        return;
+    }
+#endif
+
     ThreadPool::getInstance().enqueue([p_task, p_ctx]() {
         std::error_code ec;
         fs::rename(p_ctx->m_old_path, p_ctx->m_new_path, ec);
@@ -3081,6 +6255,7 @@ struct AppendFileCtx {
     bool m_is_binary = false;
     bool m_is_error = false;
     std::string m_error_msg;
+    std::unique_ptr<z8::AbortLink> up_abort;
 };
 
 void FS::appendFile(const v8::FunctionCallbackInfo<v8::Value>& args) {
@@ -3095,8 +6270,7 @@ void FS::appendFile(const v8::FunctionCallbackInfo<v8::Value>& args) {
     p_ctx->m_path = *path;
 
     if (args[1]->IsString()) {
-        v8::String::Utf8Value content(p_isolate, args[1]);
-        p_ctx->m_content = *content;
+        Buffer::toUtf8(p_isolate, args[1].As<v8::String>(), p_ctx->m_content);
         p_ctx->m_is_binary = false;
     } else if (args[1]->IsUint8Array()) {
         v8::Local<v8::Uint8Array> uint8 = args[1].As<v8::Uint8Array>();
@@ -3154,8 +6328,7 @@ void FS::appendFilePromise(const v8::FunctionCallbackInfo<v8::Value>& args) {
     p_ctx->m_path = *path;
 
     if (args[1]->IsString()) {
-        v8::String::Utf8Value content(p_isolate, args[1]);
-        p_ctx->m_content = *content;
+        Buffer::toUtf8(p_isolate, args[1].As<v8::String>(), p_ctx->m_content);
         p_ctx->m_is_binary = false;
     } else if (args[1]->IsUint8Array()) {
         v8::Local<v8::Uint8Array> uint8 = args[1].As<v8::Uint8Array>();
@@ -3164,12 +6337,24 @@ void FS::appendFilePromise(const v8::FunctionCallbackInfo<v8::Value>& args) {
         p_ctx->m_is_binary = true;
     }
 
+    if (args.Length() >= 3) {
+        p_ctx->up_abort = z8::AbortLink::create(p_isolate, p_context, args[2], p_resolver, {});
+        if (p_ctx->up_abort && p_ctx->up_abort->isSettled()) {
+            delete p_ctx;
+            return;
+        }
+    }
+
     z8::Task* p_task = new z8::Task();
     p_task->m_resolver.Reset(p_isolate, p_resolver);
     p_task->m_is_promise = true;
     p_task->p_data = p_ctx;
     p_task->m_runner = [](v8::Isolate* isolate, v8::Local<v8::Context> context, Task* task) {
         auto p_ctx = static_cast<AppendFileCtx*>(task->p_data);
+        if (p_ctx->up_abort && !p_ctx->up_abort->finish(isolate)) {
+            delete p_ctx;
+            return;
+        }
         auto p_resolver = task->m_resolver.Get(isolate);
         if (p_ctx->m_is_error) {
             p_resolver
@@ -3183,19 +6368,28 @@ void FS::appendFilePromise(const v8::FunctionCallbackInfo<v8::Value>& args) {
         delete p_ctx;
     };
 
-    ThreadPool::getInstance().enqueue([p_task, p_ctx]() {
-        std::ofstream file(p_ctx->m_path, std::ios::binary | std::ios::app);
-        if (!file.is_open()) {
-            p_ctx->m_is_error = true;
-            p_ctx->m_error_msg = "Could not open file for appending";
-        } else {
-            if (p_ctx->m_is_binary) {
-                file.write(p_ctx->m_binary_content.data(), p_ctx->m_binary_content.size());
+    fdAcquire([p_task, p_ctx]() {
+        ThreadPool::getInstance().enqueue([p_task, p_ctx]() {
+            if (abortRequested(p_ctx->up_abort)) {
+                fdRelease();
+                TaskQueue::getInstance().enqueue(p_task);
+                return;
+            }
+            std::ofstream file(p_ctx->m_path, std::ios::binary | std::ios::app);
+            if (!file.is_open()) {
+                p_ctx->m_is_error = true;
+                p_ctx->m_error_msg = "Could not open file for appending";
             } else {
-                file.write(p_ctx->m_content.c_str(), p_ctx->m_content.size());
+                if (p_ctx->m_is_binary) {
+                    file.write(p_ctx->m_binary_content.data(), p_ctx->m_binary_content.size());
+                } else {
+                    file.write(p_ctx->m_content.c_str(), p_ctx->m_content.size());
+                }
+                file.close();
             }
-        }
-        TaskQueue::getInstance().enqueue(p_task);
+            fdRelease();
+            TaskQueue::getInstance().enqueue(p_task);
+        });
     });
 }
 
@@ -3598,39 +6792,12 @@ void FS::lstat(const v8::FunctionCallbackInfo<v8::Value>& args) {
         return;
 
     v8::String::Utf8Value path(p_isolate, args[0]);
-    v8::Local<v8::Function> p_cb = args[args.Length() - 1].As<v8::Function>();
-
     auto p_ctx = new StatCtx();
     p_ctx->m_path = *path;
     p_ctx->m_follow_symlink = false;
-
-    z8::Task* p_task = new z8::Task();
-    p_task->m_callback.Reset(p_isolate, p_cb);
-    p_task->m_is_promise = false;
-    p_task->p_data = p_ctx;
-    p_task->m_runner = [](v8::Isolate* isolate, v8::Local<v8::Context> context, Task* task) {
-        auto p_ctx = static_cast<StatCtx*>(task->p_data);
-        v8::Local<v8::Value> argv[2];
-        if (p_ctx->m_is_error) {
-            argv[0] =
-                v8::Exception::Error(v8::String::NewFromUtf8(isolate, p_ctx->m_error_msg.c_str()).ToLocalChecked());
-            argv[1] = v8::Undefined(isolate);
-        } else {
-            argv[0] = v8::Null(isolate);
-            argv[1] = FS::createStats(isolate, p_ctx->m_path, p_ctx->m_ec, p_ctx->m_follow_symlink);
-        }
-        (void) task->m_callback.Get(isolate)->Call(context, context->Global(), 2, argv);
-        delete p_ctx;
-    };
-
-    ThreadPool::getInstance().enqueue([p_task, p_ctx]() {
-        std::error_code ec;
-        if (!fs::exists(p_ctx->m_path, ec) && !fs::is_symlink(fs::symlink_status(p_ctx->m_path, ec))) {
-            p_ctx->m_is_error = true;
-            p_ctx->m_error_msg = "ENOENT: no such file or directory";
-        }
-        TaskQueue::getInstance().enqueue(p_task);
-    });
+    if (args.Length() > 2)
+        p_ctx->m_options = statParseOptions(p_isolate, p_isolate->GetCurrentContext(), args, 1);
+    statSubmitCallback(p_isolate, p_ctx, args[args.Length() - 1].As<v8::Function>());
 }
 
 void FS::lstatPromise(const v8::FunctionCallbackInfo<v8::Value>& args) {
@@ -3648,35 +6815,8 @@ void FS::lstatPromise(const v8::FunctionCallbackInfo<v8::Value>& args) {
     auto p_ctx = new StatCtx();
     p_ctx->m_path = *path;
     p_ctx->m_follow_symlink = false;
-
-    z8::Task* p_task = new z8::Task();
-    p_task->m_resolver.Reset(p_isolate, p_resolver);
-    p_task->m_is_promise = true;
-    p_task->p_data = p_ctx;
-    p_task->m_runner = [](v8::Isolate* isolate, v8::Local<v8::Context> context, Task* task) {
-        auto p_ctx = static_cast<StatCtx*>(task->p_data);
-        auto p_resolver = task->m_resolver.Get(isolate);
-        if (p_ctx->m_is_error) {
-            p_resolver
-                ->Reject(
-                    context,
-                    v8::Exception::Error(v8::String::NewFromUtf8(isolate, p_ctx->m_error_msg.c_str()).ToLocalChecked()))
-                .Check();
-        } else {
-            p_resolver->Resolve(context, FS::createStats(isolate, p_ctx->m_path, p_ctx->m_ec, p_ctx->m_follow_symlink))
-                .Check();
-        }
-        delete p_ctx;
-    };
-
-    ThreadPool::getInstance().enqueue([p_task, p_ctx]() {
-        std::error_code ec;
-        if (!fs::exists(p_ctx->m_path, ec) && !fs::is_symlink(fs::symlink_status(p_ctx->m_path, ec))) {
-            p_ctx->m_is_error = true;
-            p_ctx->m_error_msg = "ENOENT: no such file or directory";
-        }
-        TaskQueue::getInstance().enqueue(p_task);
-    });
+    p_ctx->m_options = statParseOptions(p_isolate, p_context, args, 1);
+    statSubmitPromise(p_isolate, p_ctx, p_resolver);
 }
 
 // --- Utimes ---
@@ -3998,99 +7138,66 @@ void FS::fstatSync(const v8::FunctionCallbackInfo<v8::Value>& args) {
         return;
     }
     int32_t fd = args[0]->Int32Value(p_context).FromMaybe(-1);
-#ifdef _WIN32
-    struct _stat64 st;
-    if (_fstat64(fd, &st) != 0) {
-        p_isolate->ThrowException(
-            v8::String::NewFromUtf8(p_isolate, "Error: Could not stat file descriptor").ToLocalChecked());
-        return;
-    }
-#else
-    struct stat st;
-    if (fstat(fd, &st) != 0) {
-        p_isolate->ThrowException(
-            v8::String::NewFromUtf8(p_isolate, "Error: Could not stat file descriptor").ToLocalChecked());
+    StatOptions options = statParseOptions(p_isolate, p_context, args, 1);
+    StatData data;
+    int32_t err_no = 0;
+    if (!statFd(fd, data, err_no)) {
+        p_isolate->ThrowException(syscallError(p_isolate, err_no, "fstat", ""));
         return;
     }
-#endif
-    v8::Local<v8::Object> p_stats = v8::Object::New(p_isolate);
-    p_stats
-        ->Set(p_context,
-              v8::String::NewFromUtf8Literal(p_isolate, "size"),
-              v8::Number::New(p_isolate, static_cast<double>(st.st_size)))
-        .Check();
-    p_stats
-        ->Set(p_context,
-              v8::String::NewFromUtf8Literal(p_isolate, "mtimeMs"),
-              v8::Number::New(p_isolate, static_cast<double>(st.st_mtime) * 1000))
-        .Check();
-    bool is_dir = (st.st_mode & S_IFMT) == S_IFDIR;
-    bool is_file = (st.st_mode & S_IFMT) == S_IFREG;
-    p_stats
-        ->Set(p_context,
-              v8::String::NewFromUtf8Literal(p_isolate, "isDirectory"),
-              v8::FunctionTemplate::New(
-                  p_isolate,
-                  [](const v8::FunctionCallbackInfo<v8::Value>& args) {
-                      args.GetReturnValue().Set(args.Data().As<v8::Boolean>());
-                  },
-                  v8::Boolean::New(p_isolate, is_dir))
-                  ->GetFunction(p_context)
-                  .ToLocalChecked())
-        .Check();
-    p_stats
-        ->Set(p_context,
-              v8::String::NewFromUtf8Literal(p_isolate, "isFile"),
-              v8::FunctionTemplate::New(
-                  p_isolate,
-                  [](const v8::FunctionCallbackInfo<v8::Value>& args) {
-                      args.GetReturnValue().Set(args.Data().As<v8::Boolean>());
-                  },
-                  v8::Boolean::New(p_isolate, is_file))
-                  ->GetFunction(p_context)
-                  .ToLocalChecked())
-        .Check();
-    args.GetReturnValue().Set(p_stats);
+    args.GetReturnValue().Set(newStats(p_isolate, p_context, data, options.m_bigint));
 }
 
-struct OpenCtx {
+struct OpenCtx : z8::IoRingRequest {
     std::string m_path;
     int32_t m_flags;
     int32_t m_mode;
     int32_t m_result_fd = -1;
     bool m_is_error = false;
-    std::string m_error_msg;
+    int32_t m_err_no = 0;
+    z8::Task* p_task = nullptr;
 };
 
+// Accepts numeric flags or Node's flag strings ("r", "w+", "ax", "rs+", ...); anything else is
+// O_RDONLY. 's' opens for synchronous I/O (O_SYNC) where the platform has it.
+static int32_t parseOpenFlags(v8::Isolate* p_isolate, v8::Local<v8::Context> context, v8::Local<v8::Value> value) {
+    int32_t flags = O_RDONLY;
+    if (value->IsInt32()) {
+        flags = value->Int32Value(context).FromMaybe(O_RDONLY);
+    } else if (value->IsString()) {
+        std::string f = *v8::String::Utf8Value(p_isolate, value);
+        bool exclusive = f.find('x') != std::string::npos;
+        bool sync = f.find('s') != std::string::npos;
+        f.erase(std::remove_if(f.begin(), f.end(), [](char c) { return c == 'x' || c == 's'; }), f.end());
+        if (f == "r+")
+            flags = O_RDWR;
+        else if (f == "w")
+            flags = O_WRONLY | O_CREAT | O_TRUNC;
+        else if (f == "w+")
+            flags = O_RDWR | O_CREAT | O_TRUNC;
+        else if (f == "a")
+            flags = O_WRONLY | O_CREAT | O_APPEND;
+        else if (f == "a+")
+            flags = O_RDWR | O_CREAT | O_APPEND;
+        if (exclusive && (flags & O_CREAT))
+            flags |= O_EXCL;
+#ifdef O_SYNC
+        if (sync)
+            flags |= O_SYNC;
+#else
+        (void) sync;
+#endif
+    }
+    return flags;
+}
+
 void FS::open(const v8::FunctionCallbackInfo<v8::Value>& args) {
     v8::Isolate* p_isolate = args.GetIsolate();
     if (args.Length() < 2 || !args[0]->IsString() || !args[args.Length() - 1]->IsFunction())
         return;
     v8::String::Utf8Value path(p_isolate, args[0]);
     v8::Local<v8::Function> p_cb = args[args.Length() - 1].As<v8::Function>();
-    int32_t flags = 0;
-    if (args.Length() >= 2) {
-        if (args[1]->IsInt32())
-            flags = args[1]->Int32Value(p_isolate->GetCurrentContext()).FromMaybe(O_RDONLY);
-        else if (args[1]->IsString()) {
-            v8::String::Utf8Value f_str(p_isolate, args[1]);
-            std::string f(*f_str);
-            if (f == "r")
-                flags = O_RDONLY;
-            else if (f == "r+")
-                flags = O_RDWR;
-            else if (f == "w")
-                flags = O_WRONLY | O_CREAT | O_TRUNC;
-            else if (f == "w+")
-                flags = O_RDWR | O_CREAT | O_TRUNC;
-            else if (f == "a")
-                flags = O_WRONLY | O_CREAT | O_APPEND;
-            else if (f == "a+")
-                flags = O_RDWR | O_CREAT | O_APPEND;
-            else
-                flags = O_RDONLY;
-        }
-    }
+    int32_t flags = parseOpenFlags(p_isolate, p_isolate->GetCurrentContext(), args[1]);
     int32_t mode = 0666;
     if (args.Length() >= 3 && args[2]->IsInt32())
         mode = args[2]->Int32Value(p_isolate->GetCurrentContext()).FromMaybe(0666);
@@ -4106,8 +7213,7 @@ void FS::open(const v8::FunctionCallbackInfo<v8::Value>& args) {
         auto p_ctx = static_cast<OpenCtx*>(task->p_data);
         v8::Local<v8::Value> argv[2];
         if (p_ctx->m_is_error) {
-            argv[0] =
-                v8::Exception::Error(v8::String::NewFromUtf8(isolate, p_ctx->m_error_msg.c_str()).ToLocalChecked());
+            argv[0] = syscallError(isolate, p_ctx->m_err_no, "open", p_ctx->m_path);
             argv[1] = v8::Undefined(isolate);
         } else {
             argv[0] = v8::Null(isolate);
@@ -4124,55 +7230,7 @@ void FS::open(const v8::FunctionCallbackInfo<v8::Value>& args) {
 #endif
         if (p_ctx->m_result_fd == -1) {
             p_ctx->m_is_error = true;
-            p_ctx->m_error_msg = "Could not open file";
-        }
-        TaskQueue::getInstance().enqueue(p_task);
-    });
-}
-
-void FS::openPromise(const v8::FunctionCallbackInfo<v8::Value>& args) {
-    v8::Isolate* p_isolate = args.GetIsolate();
-    v8::Local<v8::Context> p_context = p_isolate->GetCurrentContext();
-    if (args.Length() < 1 || !args[0]->IsString())
-        return;
-    v8::Local<v8::Promise::Resolver> p_resolver;
-    if (!v8::Promise::Resolver::New(p_context).ToLocal(&p_resolver))
-        return;
-    args.GetReturnValue().Set(p_resolver->GetPromise());
-    v8::String::Utf8Value path(p_isolate, args[0]);
-    int32_t flags = O_RDONLY;
-    if (args.Length() >= 2 && args[1]->IsInt32())
-        flags = args[1]->Int32Value(p_context).FromMaybe(O_RDONLY);
-    auto p_ctx = new OpenCtx();
-    p_ctx->m_path = *path;
-    p_ctx->m_flags = flags;
-    p_ctx->m_mode = 0666;
-    z8::Task* p_task = new z8::Task();
-    p_task->m_resolver.Reset(p_isolate, p_resolver);
-    p_task->m_is_promise = true;
-    p_task->p_data = p_ctx;
-    p_task->m_runner = [](v8::Isolate* isolate, v8::Local<v8::Context> context, Task* task) {
-        auto p_ctx = static_cast<OpenCtx*>(task->p_data);
-        auto p_resolver = task->m_resolver.Get(isolate);
-        if (p_ctx->m_is_error)
-            p_resolver
-                ->Reject(
-                    context,
-                    v8::Exception::Error(v8::String::NewFromUtf8(isolate, p_ctx->m_error_msg.c_str()).ToLocalChecked()))
-                .Check();
-        else
-            p_resolver->Resolve(context, v8::Integer::New(isolate, p_ctx->m_result_fd)).Check();
-        delete p_ctx;
-    };
-    ThreadPool::getInstance().enqueue([p_task, p_ctx]() {
-#ifdef _WIN32
-        p_ctx->m_result_fd = _open(p_ctx->m_path.c_str(), p_ctx->m_flags | _O_BINARY, p_ctx->m_mode);
-#else
-        p_ctx->m_result_fd = open(p_ctx->m_path.c_str(), p_ctx->m_flags, p_ctx->m_mode);
-#endif
-        if (p_ctx->m_result_fd == -1) {
-            p_ctx->m_is_error = true;
-            p_ctx->m_error_msg = "Could not open file";
+            p_ctx->m_err_no = errno;
         }
         TaskQueue::getInstance().enqueue(p_task);
     });
@@ -4261,11 +7319,10 @@ void FS::write(const v8::FunctionCallbackInfo<v8::Value>& args) {
     auto p_ctx = new RWCtx();
     p_ctx->m_fd = fd;
     if (args[1]->IsString()) {
-        v8::String::Utf8Value utf8(p_isolate, args[1]);
-        std::string str = *utf8;
-        p_ctx->m_length = str.length();
-        p_ctx->p_buffer_data = malloc(p_ctx->m_length);
-        memcpy(p_ctx->p_buffer_data, str.c_str(), p_ctx->m_length);
+        v8::Local<v8::String> str = args[1].As<v8::String>();
+        p_ctx->m_length = Buffer::utf8Length(p_isolate, str);
+        p_ctx->p_buffer_data = malloc(p_ctx->m_length ? p_ctx->m_length : 1);
+        Buffer::writeUtf8(p_isolate, str, static_cast<uint8_t*>(p_ctx->p_buffer_data), p_ctx->m_length);
         p_ctx->m_position = -1;
     } else if (args[1]->IsUint8Array()) {
         v8::Local<v8::Uint8Array> ui8 = args[1].As<v8::Uint8Array>();
@@ -4373,349 +7430,112 @@ void FS::close(const v8::FunctionCallbackInfo<v8::Value>& args) {
     });
 }
 
-struct FstatCtx {
-    int32_t m_fd;
-    bool m_is_error = false;
-    std::string m_error_msg;
-    uint64_t m_size;
-    double m_mtime;
-    bool m_is_dir;
-    bool m_is_file;
-};
-
 void FS::fstat(const v8::FunctionCallbackInfo<v8::Value>& args) {
     v8::Isolate* p_isolate = args.GetIsolate();
     v8::Local<v8::Context> p_context = p_isolate->GetCurrentContext();
     if (args.Length() < 2 || !args[0]->IsInt32() || !args[args.Length() - 1]->IsFunction())
         return;
-    int32_t fd = args[0]->Int32Value(p_context).FromMaybe(-1);
+
+    auto p_ctx = new StatCtx();
+    p_ctx->m_fd = args[0]->Int32Value(p_context).FromMaybe(-1);
+    if (args.Length() > 2)
+        p_ctx->m_options = statParseOptions(p_isolate, p_context, args, 1);
+    statSubmitCallback(p_isolate, p_ctx, args[args.Length() - 1].As<v8::Function>());
+}
+
+void FS::fstatPromise(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    v8::Local<v8::Context> p_context = p_isolate->GetCurrentContext();
+    if (args.Length() < 1 || !args[0]->IsInt32())
+        return;
+    v8::Local<v8::Promise::Resolver> p_resolver;
+    if (!v8::Promise::Resolver::New(p_context).ToLocal(&p_resolver))
+        return;
+    args.GetReturnValue().Set(p_resolver->GetPromise());
+
+    auto p_ctx = new StatCtx();
+    p_ctx->m_fd = args[0]->Int32Value(p_context).FromMaybe(-1);
+    p_ctx->m_options = statParseOptions(p_isolate, p_context, args, 1);
+    statSubmitPromise(p_isolate, p_ctx, p_resolver);
+}
+
+void FS::rm(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    if (args.Length() < 2 || !args[0]->IsString() || !args[args.Length() - 1]->IsFunction())
+        return;
+
     v8::Local<v8::Function> p_cb = args[args.Length() - 1].As<v8::Function>();
+    TreeWalk* p_ctx = treeCreateRemove(p_isolate, args, false, false);
 
-    auto p_ctx = new FstatCtx();
-    p_ctx->m_fd = fd;
     z8::Task* p_task = new z8::Task();
     p_task->m_callback.Reset(p_isolate, p_cb);
     p_task->m_is_promise = false;
     p_task->p_data = p_ctx;
     p_task->m_runner = [](v8::Isolate* isolate, v8::Local<v8::Context> context, Task* task) {
-        auto p_ctx = static_cast<FstatCtx*>(task->p_data);
-        v8::Local<v8::Value> argv[2];
+        auto p_ctx = static_cast<TreeWalk*>(task->p_data);
+        v8::Local<v8::Value> argv[1];
         if (p_ctx->m_is_error) {
-            argv[0] =
-                v8::Exception::Error(v8::String::NewFromUtf8(isolate, p_ctx->m_error_msg.c_str()).ToLocalChecked());
-            argv[1] = v8::Undefined(isolate);
+            argv[0] = treeErrorValue(isolate, p_ctx, p_ctx->m_error_msg);
         } else {
             argv[0] = v8::Null(isolate);
-            v8::Local<v8::Object> p_stats = v8::Object::New(isolate);
-            p_stats
-                ->Set(context,
-                      v8::String::NewFromUtf8Literal(isolate, "size"),
-                      v8::Number::New(isolate, (double) p_ctx->m_size))
-                .Check();
-            p_stats
-                ->Set(context,
-                      v8::String::NewFromUtf8Literal(isolate, "mtimeMs"),
-                      v8::Number::New(isolate, p_ctx->m_mtime))
-                .Check();
-            p_stats
-                ->Set(context,
-                      v8::String::NewFromUtf8Literal(isolate, "isDirectory"),
-                      v8::FunctionTemplate::New(
-                          isolate,
-                          [](const v8::FunctionCallbackInfo<v8::Value>& args) {
-                              args.GetReturnValue().Set(args.Data().As<v8::Boolean>());
-                          },
-                          v8::Boolean::New(isolate, p_ctx->m_is_dir))
-                          ->GetFunction(context)
-                          .ToLocalChecked())
-                .Check();
-            p_stats
-                ->Set(context,
-                      v8::String::NewFromUtf8Literal(isolate, "isFile"),
-                      v8::FunctionTemplate::New(
-                          isolate,
-                          [](const v8::FunctionCallbackInfo<v8::Value>& args) {
-                              args.GetReturnValue().Set(args.Data().As<v8::Boolean>());
-                          },
-                          v8::Boolean::New(isolate, p_ctx->m_is_file))
-                          ->GetFunction(context)
-                          .ToLocalChecked())
-                .Check();
-            argv[1] = p_stats;
         }
-        (void) task->m_callback.Get(isolate)->Call(context, context->Global(), 2, argv);
+        (void) task->m_callback.Get(isolate)->Call(context, context->Global(), 1, argv);
         delete p_ctx;
     };
-    ThreadPool::getInstance().enqueue([p_task, p_ctx]() {
-#ifdef _WIN32
-        struct _stat64 st;
-        if (_fstat64(p_ctx->m_fd, &st) == 0) {
-            p_ctx->m_size = st.st_size;
-            p_ctx->m_mtime = (double) st.st_mtime * 1000;
-            p_ctx->m_is_dir = (st.st_mode & S_IFMT) == S_IFDIR;
-            p_ctx->m_is_file = (st.st_mode & S_IFMT) == S_IFREG;
-        } else {
-            p_ctx->m_is_error = true;
-            p_ctx->m_error_msg = "fstat error";
-        }
-#else
-        struct stat st;
-        if (fstat(p_ctx->m_fd, &st) == 0) {
-            p_ctx->m_size = st.st_size;
-            p_ctx->m_mtime = (double) st.st_mtime * 1000;
-            p_ctx->m_is_dir = S_ISDIR(st.st_mode);
-            p_ctx->m_is_file = S_ISREG(st.st_mode);
-        } else {
-            p_ctx->m_is_error = true;
-            p_ctx->m_error_msg = "fstat error";
-        }
-#endif
-        TaskQueue::getInstance().enqueue(p_task);
-    });
+
+    p_ctx->p_done_task = p_task;
+    treeRunAsync(p_ctx);
 }
 
-void FS::fstatPromise(const v8::FunctionCallbackInfo<v8::Value>& args) {
+void FS::rmPromise(const v8::FunctionCallbackInfo<v8::Value>& args) {
     v8::Isolate* p_isolate = args.GetIsolate();
     v8::Local<v8::Context> p_context = p_isolate->GetCurrentContext();
-    if (args.Length() < 1 || !args[0]->IsInt32())
+    if (args.Length() < 1 || !args[0]->IsString())
         return;
-    int32_t fd = args[0]->Int32Value(p_context).FromMaybe(-1);
+
     v8::Local<v8::Promise::Resolver> p_resolver;
     if (!v8::Promise::Resolver::New(p_context).ToLocal(&p_resolver))
         return;
     args.GetReturnValue().Set(p_resolver->GetPromise());
 
-    auto p_ctx = new FstatCtx();
-    p_ctx->m_fd = fd;
+    TreeWalk* p_ctx = treeCreateRemove(p_isolate, args, false, false);
 
     z8::Task* p_task = new z8::Task();
     p_task->m_resolver.Reset(p_isolate, p_resolver);
     p_task->m_is_promise = true;
     p_task->p_data = p_ctx;
     p_task->m_runner = [](v8::Isolate* isolate, v8::Local<v8::Context> context, Task* task) {
-        auto p_ctx = static_cast<FstatCtx*>(task->p_data);
+        auto p_ctx = static_cast<TreeWalk*>(task->p_data);
         auto p_resolver = task->m_resolver.Get(isolate);
         if (p_ctx->m_is_error) {
-            p_resolver
-                ->Reject(
-                    context,
-                    v8::Exception::Error(v8::String::NewFromUtf8(isolate, p_ctx->m_error_msg.c_str()).ToLocalChecked()))
-                .Check();
+            p_resolver->Reject(context, treeErrorValue(isolate, p_ctx, p_ctx->m_error_msg)).Check();
         } else {
-            v8::Local<v8::Object> p_stats = v8::Object::New(isolate);
-            p_stats
-                ->Set(context,
-                      v8::String::NewFromUtf8Literal(isolate, "size"),
-                      v8::Number::New(isolate, (double) p_ctx->m_size))
-                .Check();
-            p_stats
-                ->Set(context,
-                      v8::String::NewFromUtf8Literal(isolate, "mtimeMs"),
-                      v8::Number::New(isolate, p_ctx->m_mtime))
-                .Check();
-            p_stats
-                ->Set(context,
-                      v8::String::NewFromUtf8Literal(isolate, "isDirectory"),
-                      v8::FunctionTemplate::New(
-                          isolate,
-                          [](const v8::FunctionCallbackInfo<v8::Value>& args) {
-                              args.GetReturnValue().Set(args.Data().As<v8::Boolean>());
-                          },
-                          v8::Boolean::New(isolate, p_ctx->m_is_dir))
-                          ->GetFunction(context)
-                          .ToLocalChecked())
-                .Check();
-            p_stats
-                ->Set(context,
-                      v8::String::NewFromUtf8Literal(isolate, "isFile"),
-                      v8::FunctionTemplate::New(
-                          isolate,
-                          [](const v8::FunctionCallbackInfo<v8::Value>& args) {
-                              args.GetReturnValue().Set(args.Data().As<v8::Boolean>());
-                          },
-                          v8::Boolean::New(isolate, p_ctx->m_is_file))
-                          ->GetFunction(context)
-                          .ToLocalChecked())
-                .Check();
-            p_resolver->Resolve(context, p_stats).Check();
+            p_resolver->Resolve(context, v8::Undefined(isolate)).Check();
         }
         delete p_ctx;
     };
 
-    ThreadPool::getInstance().enqueue([p_task, p_ctx]() {
-#ifdef _WIN32
-        struct _stat64 st;
-        if (_fstat64(p_ctx->m_fd, &st) == 0) {
-            p_ctx->m_size = st.st_size;
-            p_ctx->m_mtime = (double) st.st_mtime * 1000;
-            p_ctx->m_is_dir = (st.st_mode & S_IFMT) == S_IFDIR;
-            p_ctx->m_is_file = (st.st_mode & S_IFMT) == S_IFREG;
-        } else {
-            p_ctx->m_is_error = true;
-            p_ctx->m_error_msg = "fstat error";
-        }
-#else
-        struct stat st;
-        if (fstat(p_ctx->m_fd, &st) == 0) {
-            p_ctx->m_size = st.st_size;
-            p_ctx->m_mtime = (double) st.st_mtime * 1000;
-            p_ctx->m_is_dir = S_ISDIR(st.st_mode);
-            p_ctx->m_is_file = S_ISREG(st.st_mode);
-        } else {
-            p_ctx->m_is_error = true;
-            p_ctx->m_error_msg = "fstat error";
-#endif
-        TaskQueue::getInstance().enqueue(p_task);
-    });
+    p_ctx->p_done_task = p_task;
+    treeRunAsync(p_ctx);
 }
 
-struct RmCtx {
-    std::string m_path;
-    bool m_recursive = false;
-    bool m_force = false;
-    bool m_is_error = false;
-    std::string m_error_msg;
-};
-
-void FS::rm(const v8::FunctionCallbackInfo<v8::Value>& args) {
+void FS::cp(const v8::FunctionCallbackInfo<v8::Value>& args) {
     v8::Isolate* p_isolate = args.GetIsolate();
-    if (args.Length() < 2 || !args[0]->IsString() || !args[args.Length() - 1]->IsFunction())
+    if (args.Length() < 3 || !args[0]->IsString() || !args[1]->IsString() || !args[args.Length() - 1]->IsFunction())
         return;
 
-    v8::String::Utf8Value path(p_isolate, args[0]);
-    v8::Local<v8::Function> p_cb = args[args.Length() - 1].As<v8::Function>();
-
-    auto p_ctx = new RmCtx();
-    p_ctx->m_path = *path;
-
-    if (args.Length() >= 2 && args[1]->IsObject()) {
-        v8::Local<v8::Context> context = p_isolate->GetCurrentContext();
-        v8::Local<v8::Object> options = args[1].As<v8::Object>();
-        v8::Local<v8::Value> recursive_val;
-        if (options->Get(context, v8::String::NewFromUtf8Literal(p_isolate, "recursive")).ToLocal(&recursive_val)) {
-            p_ctx->m_recursive = recursive_val->BooleanValue(p_isolate);
-        }
-    }
-
-    z8::Task* p_task = new z8::Task();
-    p_task->m_callback.Reset(p_isolate, p_cb);
-    p_task->m_is_promise = false;
-    p_task->p_data = p_ctx;
-    p_task->m_runner = [](v8::Isolate* isolate, v8::Local<v8::Context> context, Task* task) {
-        auto p_ctx = static_cast<RmCtx*>(task->p_data);
-        v8::Local<v8::Value> argv[1];
-        if (p_ctx->m_is_error) {
-            argv[0] =
-                v8::Exception::Error(v8::String::NewFromUtf8(isolate, p_ctx->m_error_msg.c_str()).ToLocalChecked());
-        } else {
-            argv[0] = v8::Null(isolate);
-        }
-        (void) task->m_callback.Get(isolate)->Call(context, context->Global(), 1, argv);
-        delete p_ctx;
-    };
-
-    ThreadPool::getInstance().enqueue([p_task, p_ctx]() {
-        std::error_code ec;
-        if (p_ctx->m_recursive) {
-            fs::remove_all(p_ctx->m_path, ec);
-        } else {
-            fs::remove(p_ctx->m_path, ec);
-        }
-        if (ec) {
-            p_ctx->m_is_error = true;
-            p_ctx->m_error_msg = ec.message();
-        }
-        TaskQueue::getInstance().enqueue(p_task);
-    });
-}
-
-void FS::rmPromise(const v8::FunctionCallbackInfo<v8::Value>& args) {
-    v8::Isolate* p_isolate = args.GetIsolate();
-    v8::Local<v8::Context> p_context = p_isolate->GetCurrentContext();
-    if (args.Length() < 1 || !args[0]->IsString())
-        return;
-
-    v8::Local<v8::Promise::Resolver> p_resolver;
-    if (!v8::Promise::Resolver::New(p_context).ToLocal(&p_resolver))
-        return;
-    args.GetReturnValue().Set(p_resolver->GetPromise());
-
-    v8::String::Utf8Value path(p_isolate, args[0]);
-    auto p_ctx = new RmCtx();
-    p_ctx->m_path = *path;
-
-    if (args.Length() >= 2 && args[1]->IsObject()) {
-        v8::Local<v8::Object> options = args[1].As<v8::Object>();
-        v8::Local<v8::Value> recursive_val;
-        if (options->Get(p_context, v8::String::NewFromUtf8Literal(p_isolate, "recursive")).ToLocal(&recursive_val)) {
-            p_ctx->m_recursive = recursive_val->BooleanValue(p_isolate);
-        }
-    }
-
-    z8::Task* p_task = new z8::Task();
-    p_task->m_resolver.Reset(p_isolate, p_resolver);
-    p_task->m_is_promise = true;
-    p_task->p_data = p_ctx;
-    p_task->m_runner = [](v8::Isolate* isolate, v8::Local<v8::Context> context, Task* task) {
-        auto p_ctx = static_cast<RmCtx*>(task->p_data);
-        auto p_resolver = task->m_resolver.Get(isolate);
-        if (p_ctx->m_is_error) {
-            p_resolver
-                ->Reject(
-                    context,
-                    v8::Exception::Error(v8::String::NewFromUtf8(isolate, p_ctx->m_error_msg.c_str()).ToLocalChecked()))
-                .Check();
-        } else {
-            p_resolver->Resolve(context, v8::Undefined(isolate)).Check();
-        }
-        delete p_ctx;
-    };
-
-    ThreadPool::getInstance().enqueue([p_task, p_ctx]() {
-        std::error_code ec;
-        if (p_ctx->m_recursive) {
-            fs::remove_all(p_ctx->m_path, ec);
-        } else {
-            fs::remove(p_ctx->m_path, ec);
-        }
-        if (ec) {
-            p_ctx->m_is_error = true;
-            p_ctx->m_error_msg = ec.message();
-        }
-        TaskQueue::getInstance().enqueue(p_task);
-    });
-}
-
-struct CopyCtx {
-    std::string m_src;
-    std::string m_dest;
-    bool m_is_error = false;
-    std::string m_error_msg;
-};
-
-void FS::cp(const v8::FunctionCallbackInfo<v8::Value>& args) {
-    v8::Isolate* p_isolate = args.GetIsolate();
-    if (args.Length() < 3 || !args[0]->IsString() || !args[1]->IsString() || !args[args.Length() - 1]->IsFunction())
-        return;
-
-    v8::String::Utf8Value src(p_isolate, args[0]);
-    v8::String::Utf8Value dest(p_isolate, args[1]);
     v8::Local<v8::Function> p_cb = args[args.Length() - 1].As<v8::Function>();
-
-    auto p_ctx = new CopyCtx();
-    p_ctx->m_src = *src;
-    p_ctx->m_dest = *dest;
+    TreeWalk* p_ctx = treeCreateCopy(p_isolate, args);
 
     z8::Task* p_task = new z8::Task();
     p_task->m_callback.Reset(p_isolate, p_cb);
     p_task->m_is_promise = false;
     p_task->p_data = p_ctx;
     p_task->m_runner = [](v8::Isolate* isolate, v8::Local<v8::Context> context, Task* task) {
-        auto p_ctx = static_cast<CopyCtx*>(task->p_data);
+        auto p_ctx = static_cast<TreeWalk*>(task->p_data);
         v8::Local<v8::Value> argv[1];
         if (p_ctx->m_is_error) {
-            argv[0] =
-                v8::Exception::Error(v8::String::NewFromUtf8(isolate, p_ctx->m_error_msg.c_str()).ToLocalChecked());
+            argv[0] = treeErrorValue(isolate, p_ctx, p_ctx->m_error_msg);
         } else {
             argv[0] = v8::Null(isolate);
         }
@@ -4723,15 +7543,8 @@ void FS::cp(const v8::FunctionCallbackInfo<v8::Value>& args) {
         delete p_ctx;
     };
 
-    ThreadPool::getInstance().enqueue([p_task, p_ctx]() {
-        std::error_code ec;
-        fs::copy(p_ctx->m_src, p_ctx->m_dest, fs::copy_options::recursive | fs::copy_options::overwrite_existing, ec);
-        if (ec) {
-            p_ctx->m_is_error = true;
-            p_ctx->m_error_msg = ec.message();
-        }
-        TaskQueue::getInstance().enqueue(p_task);
-    });
+    p_ctx->p_done_task = p_task;
+    treeRunAsync(p_ctx);
 }
 
 void FS::cpPromise(const v8::FunctionCallbackInfo<v8::Value>& args) {
@@ -4745,40 +7558,25 @@ void FS::cpPromise(const v8::FunctionCallbackInfo<v8::Value>& args) {
         return;
     args.GetReturnValue().Set(p_resolver->GetPromise());
 
-    v8::String::Utf8Value src(p_isolate, args[0]);
-    v8::String::Utf8Value dest(p_isolate, args[1]);
-    auto p_ctx = new CopyCtx();
-    p_ctx->m_src = *src;
-    p_ctx->m_dest = *dest;
+    TreeWalk* p_ctx = treeCreateCopy(p_isolate, args);
 
     z8::Task* p_task = new z8::Task();
     p_task->m_resolver.Reset(p_isolate, p_resolver);
     p_task->m_is_promise = true;
     p_task->p_data = p_ctx;
     p_task->m_runner = [](v8::Isolate* isolate, v8::Local<v8::Context> context, Task* task) {
-        auto p_ctx = static_cast<CopyCtx*>(task->p_data);
+        auto p_ctx = static_cast<TreeWalk*>(task->p_data);
         auto p_resolver = task->m_resolver.Get(isolate);
         if (p_ctx->m_is_error) {
-            p_resolver
-                ->Reject(
-                    context,
-                    v8::Exception::Error(v8::String::NewFromUtf8(isolate, p_ctx->m_error_msg.c_str()).ToLocalChecked()))
-                .Check();
+            p_resolver->Reject(context, treeErrorValue(isolate, p_ctx, p_ctx->m_error_msg)).Check();
         } else {
             p_resolver->Resolve(context, v8::Undefined(isolate)).Check();
         }
         delete p_ctx;
     };
 
-    ThreadPool::getInstance().enqueue([p_task, p_ctx]() {
-        std::error_code ec;
-        fs::copy(p_ctx->m_src, p_ctx->m_dest, fs::copy_options::recursive | fs::copy_options::overwrite_existing, ec);
-        if (ec) {
-            p_ctx->m_is_error = true;
-            p_ctx->m_error_msg = ec.message();
-        }
-        TaskQueue::getInstance().enqueue(p_task);
-    });
+    p_ctx->p_done_task = p_task;
+    treeRunAsync(p_ctx);
 }
 
 struct FsyncCtx {
@@ -4832,7 +7630,8 @@ void FS::fsync(const v8::FunctionCallbackInfo<v8::Value>& args) {
     });
 }
 
-void FS::fsyncPromise(const v8::FunctionCallbackInfo<v8::Value>& args) {
+// fsyncPromise/fdatasyncPromise share flushes with concurrent requests through the group commit.
+static void syncPromise(const v8::FunctionCallbackInfo<v8::Value>& args, uint8_t kind) {
     v8::Isolate* p_isolate = args.GetIsolate();
     v8::Local<v8::Context> p_context = p_isolate->GetCurrentContext();
     if (args.Length() < 1 || !args[0]->IsInt32())
@@ -4866,29 +7665,26 @@ void FS::fsyncPromise(const v8::FunctionCallbackInfo<v8::Value>& args) {
         delete p_ctx;
     };
 
-    ThreadPool::getInstance().enqueue([p_task, p_ctx]() {
-#ifdef _WIN32
-        HANDLE h = (HANDLE) _get_osfhandle(p_ctx->m_fd);
-        if (h == INVALID_HANDLE_VALUE || FlushFileBuffers(h) == 0) {
+    const char* p_syscall = kind == SYNC_DATA ? "fdatasync" : "fsync";
+    groupCommitSubmit(fd, kind, [p_task, p_ctx, p_syscall](int32_t err_no) {
+        if (err_no != 0) {
             p_ctx->m_is_error = true;
-            p_ctx->m_error_msg = "fsync failed";
+            p_ctx->m_error_msg = syscallErrorMessage(err_no, p_syscall, "");
         }
-#else
-            if (fsync(p_ctx->m_fd) != 0) {
-                p_ctx->m_is_error = true;
-                p_ctx->m_error_msg = "fsync failed";
-            }
-#endif
         TaskQueue::getInstance().enqueue(p_task);
     });
 }
 
+void FS::fsyncPromise(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    syncPromise(args, SYNC_FULL);
+}
+
 void FS::fdatasync(const v8::FunctionCallbackInfo<v8::Value>& args) {
     fsync(args);
 }
 
 void FS::fdatasyncPromise(const v8::FunctionCallbackInfo<v8::Value>& args) {
-    fsyncPromise(args);
+    syncPromise(args, SYNC_DATA);
 }
 
 void FS::fchmod(const v8::FunctionCallbackInfo<v8::Value>& args) {
@@ -4906,14 +7702,10 @@ void FS::cpSync(const v8::FunctionCallbackInfo<v8::Value>& args) {
             v8::String::NewFromUtf8Literal(p_isolate, "Source and destination paths must be strings")));
         return;
     }
-    v8::String::Utf8Value src(p_isolate, args[0]);
-    v8::String::Utf8Value dest(p_isolate, args[1]);
-    std::error_code ec;
-    fs::copy(*src, *dest, fs::copy_options::recursive | fs::copy_options::overwrite_existing, ec);
-    if (ec) {
-        p_isolate->ThrowException(
-            v8::Exception::Error(v8::String::NewFromUtf8(p_isolate, ec.message().c_str()).ToLocalChecked()));
-    }
+    std::unique_ptr<TreeWalk> up_walk(treeCreateCopy(p_isolate, args));
+    treeRunSync(p_isolate, up_walk.get());
+    if (up_walk->m_is_error)
+        p_isolate->ThrowException(treeErrorValue(p_isolate, up_walk.get(), up_walk->m_error_msg));
 }
 
 void FS::fchmodSync(const v8::FunctionCallbackInfo<v8::Value>& args) {
@@ -6101,94 +8893,3291 @@ void FS::lchownPromise(const v8::FunctionCallbackInfo<v8::Value>& args) {
                     v8::Exception::Error(v8::String::NewFromUtf8(isolate, p_ctx->m_error_msg.c_str()).ToLocalChecked()))
                 .Check();
         } else {
-            p_resolver->Resolve(context, v8::Undefined(isolate)).Check();
+            p_resolver->Resolve(context, v8::Undefined(isolate)).Check();
+        }
+        delete p_ctx;
+    };
+
+    ThreadPool::getInstance().enqueue([p_task, p_ctx]() {
+#ifdef _WIN32
+#else
+            if (lchown(p_ctx->m_path.c_str(), p_ctx->m_uid, p_ctx->m_gid) != 0) {
+                p_ctx->m_is_error = true;
+                p_ctx->m_error_msg = "lchown failed";
+            }
+#endif
+        TaskQueue::getInstance().enqueue(p_task);
+    });
+}
+
+static size_t opendirBufferSize(v8::Isolate* p_isolate, const v8::FunctionCallbackInfo<v8::Value>& args) {
+    int64_t size = 0;
+    if (args.Length() >= 2 && args[1]->IsObject()) {
+        v8::Local<v8::Context> context = p_isolate->GetCurrentContext();
+        v8::Local<v8::Object> options = args[1].As<v8::Object>();
+        v8::Local<v8::Value> val;
+        if (options->Get(context, v8::String::NewFromUtf8Literal(p_isolate, "bufferSize")).ToLocal(&val) &&
+            val->IsNumber())
+            size = static_cast<int64_t>(val->NumberValue(context).FromMaybe(0));
+    }
+    return size >= 1 ? static_cast<size_t>(size) : DIR_DEFAULT_BUFFER_SIZE;
+}
+
+struct OpendirCtx {
+    std::string m_path;
+    size_t m_buffer_size = DIR_DEFAULT_BUFFER_SIZE;
+    DirData* p_dir = nullptr;
+};
+
+void FS::opendirSync(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    v8::HandleScope handle_scope(p_isolate);
+    if (args.Length() < 1 || !args[0]->IsString())
+        return;
+
+    v8::String::Utf8Value path(p_isolate, args[0]);
+    auto* p_data = new DirData(*path);
+    if (!p_data->m_open_error.empty()) {
+        p_isolate->ThrowException(
+            v8::Exception::Error(v8::String::NewFromUtf8(p_isolate, p_data->m_open_error.c_str()).ToLocalChecked()));
+        delete p_data;
+        return;
+    }
+    p_data->m_buffer_size = opendirBufferSize(p_isolate, args);
+    args.GetReturnValue().Set(createDirObject(p_isolate, p_data));
+}
+
+void FS::opendir(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    if (args.Length() < 2 || !args[0]->IsString() || !args[args.Length() - 1]->IsFunction())
+        return;
+
+    v8::String::Utf8Value path(p_isolate, args[0]);
+    v8::Local<v8::Function> p_cb = args[args.Length() - 1].As<v8::Function>();
+
+    auto p_ctx = new OpendirCtx();
+    p_ctx->m_path = *path;
+    p_ctx->m_buffer_size = opendirBufferSize(p_isolate, args);
+
+    z8::Task* p_task = new z8::Task();
+    p_task->m_callback.Reset(p_isolate, p_cb);
+    p_task->m_is_promise = false;
+    p_task->p_data = p_ctx;
+    p_task->m_runner = [](v8::Isolate* isolate, v8::Local<v8::Context> context, Task* task) {
+        auto p_ctx = static_cast<OpendirCtx*>(task->p_data);
+        v8::Local<v8::Value> argv[2];
+        if (!p_ctx->p_dir->m_open_error.empty()) {
+            argv[0] = v8::Exception::Error(
+                v8::String::NewFromUtf8(isolate, p_ctx->p_dir->m_open_error.c_str()).ToLocalChecked());
+            argv[1] = v8::Undefined(isolate);
+            delete p_ctx->p_dir;
+        } else {
+            argv[0] = v8::Null(isolate);
+            argv[1] = createDirObject(isolate, p_ctx->p_dir);
+        }
+        (void) task->m_callback.Get(isolate)->Call(context, context->Global(), 2, argv);
+        delete p_ctx;
+    };
+
+    // Opening (and the first stat of the path) happens on the pool, not in the runner.
+    ThreadPool::getInstance().enqueue([p_task, p_ctx]() {
+        p_ctx->p_dir = new DirData(p_ctx->m_path);
+        p_ctx->p_dir->m_buffer_size = p_ctx->m_buffer_size;
+        TaskQueue::getInstance().enqueue(p_task);
+    });
+}
+
+void FS::opendirPromise(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    v8::Local<v8::Context> p_context = p_isolate->GetCurrentContext();
+    if (args.Length() < 1 || !args[0]->IsString())
+        return;
+
+    v8::Local<v8::Promise::Resolver> p_resolver;
+    if (!v8::Promise::Resolver::New(p_context).ToLocal(&p_resolver))
+        return;
+    args.GetReturnValue().Set(p_resolver->GetPromise());
+
+    v8::String::Utf8Value path(p_isolate, args[0]);
+
+    auto p_ctx = new OpendirCtx();
+    p_ctx->m_path = *path;
+    p_ctx->m_buffer_size = opendirBufferSize(p_isolate, args);
+
+    z8::Task* p_task = new z8::Task();
+    p_task->m_resolver.Reset(p_isolate, p_resolver);
+    p_task->m_is_promise = true;
+    p_task->p_data = p_ctx;
+    p_task->m_runner = [](v8::Isolate* isolate, v8::Local<v8::Context> context, Task* task) {
+        auto p_ctx = static_cast<OpendirCtx*>(task->p_data);
+        auto p_resolver = task->m_resolver.Get(isolate);
+        if (!p_ctx->p_dir->m_open_error.empty()) {
+            p_resolver
+                ->Reject(context,
+                         v8::Exception::Error(
+                             v8::String::NewFromUtf8(isolate, p_ctx->p_dir->m_open_error.c_str()).ToLocalChecked()))
+                .Check();
+            delete p_ctx->p_dir;
+        } else {
+            p_resolver->Resolve(context, createDirObject(isolate, p_ctx->p_dir)).Check();
+        }
+        delete p_ctx;
+    };
+
+    ThreadPool::getInstance().enqueue([p_task, p_ctx]() {
+        p_ctx->p_dir = new DirData(p_ctx->m_path);
+        p_ctx->p_dir->m_buffer_size = p_ctx->m_buffer_size;
+        TaskQueue::getInstance().enqueue(p_task);
+    });
+}
+
+// --- Glob ---
+// Patterns are brace-expanded and split into per-segment matchers. The walk keeps, for every
+// directory, the set of (pattern, segment) positions still alive there, so a directory is only
+// read when some pattern can continue into it and directories reached purely through literal
+// segments are probed with one lstat instead of a readdir. Every directory is a job on a
+// FanoutQueue; matches are appended per directory and handed to the async iterator as they land.
+static constexpr uint8_t GLOB_SEG_LITERAL = 0;
+static constexpr uint8_t GLOB_SEG_WILDCARD = 1;
+static constexpr uint8_t GLOB_SEG_GLOBSTAR = 2;
+static constexpr size_t GLOB_MAX_EXPANSION = 10000;
+
+#ifdef _WIN32
+// Backslash is a path separator on Windows, so it cannot double as the escape character.
+static constexpr bool GLOB_BACKSLASH_ESCAPES = false;
+#else
+static constexpr bool GLOB_BACKSLASH_ESCAPES = true;
+#endif
+
+#if defined(_WIN32) || defined(__APPLE__)
+static constexpr bool GLOB_NOCASE = true;
+#else
+static constexpr bool GLOB_NOCASE = false;
+#endif
+
+struct GlobSegment {
+    uint8_t m_kind = GLOB_SEG_LITERAL;
+    std::string m_text;
+};
+
+struct GlobPattern {
+    std::vector<GlobSegment> m_segments;
+    bool m_exclude = false;
+};
+
+// Patterns sharing a starting directory: everything relative to cwd, or one absolute root.
+struct GlobRoot {
+    std::string m_key;
+    std::string m_fs_path;
+    std::string m_display;
+    std::string m_abs_path;
+    std::vector<GlobPattern> m_patterns;
+    bool m_has_positive = false;
+};
+
+struct GlobState {
+    uint32_t m_pattern = 0;
+    uint32_t m_segment = 0;
+};
+
+struct GlobJob {
+    size_t m_root = 0;
+    std::string m_rel;
+    std::vector<GlobState> m_states;
+};
+
+struct GlobMatch {
+    size_t m_root = 0;
+    std::string m_rel;
+    std::string m_name;
+    uint8_t m_type = DIRENT_UNKNOWN;
+};
+
+struct GlobCtx : FanoutQueue {
+    std::vector<GlobRoot> m_roots;
+    bool m_with_file_types = false;
+    v8::Global<v8::Function> m_exclude_fn;
+    std::atomic<int64_t> m_pending{0};
+    std::atomic<bool> m_cancelled{false};
+
+    // Guarded by m_mutex.
+    std::deque<GlobMatch> m_matches;
+    std::vector<z8::Task*> m_waiters;
+
+    // Async iterator state, main thread only.
+    bool m_finished = false;
+    int32_t m_refs = 0;
+    v8::Global<v8::Object> m_self;
+};
+
+static inline bool globIsSeparator(char c) {
+    return c == '/' || (!GLOB_BACKSLASH_ESCAPES && c == '\\');
+}
+
+static inline bool globIsEscape(const std::string& text, size_t i) {
+    return GLOB_BACKSLASH_ESCAPES && text[i] == '\\' && i + 1 < text.size();
+}
+
+static inline bool globCharEq(char a, char b) {
+    if (GLOB_NOCASE)
+        return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b));
+    return a == b;
+}
+
+static bool globParseInt(const std::string& text, int64_t& value) {
+    size_t i = (!text.empty() && text[0] == '-') ? 1 : 0;
+    if (i == text.size() || text.size() > 18)
+        return false;
+    value = 0;
+    for (size_t k = i; k < text.size(); ++k) {
+        if (text[k] < '0' || text[k] > '9')
+            return false;
+        value = value * 10 + (text[k] - '0');
+    }
+    if (i == 1)
+        value = -value;
+    return true;
+}
+
+// a{b,c}d -> abd, acd; {1..3} -> 1, 2, 3. Unbalanced or single-item braces stay literal.
+static void globExpandBraces(const std::string& pattern, std::vector<std::string>& out) {
+    if (out.size() >= GLOB_MAX_EXPANSION)
+        return;
+    for (size_t open = 0; open < pattern.size(); ++open) {
+        if (globIsEscape(pattern, open)) {
+            ++open;
+            continue;
+        }
+        if (pattern[open] != '{')
+            continue;
+
+        int32_t depth = 0;
+        size_t close = std::string::npos;
+        std::vector<size_t> commas;
+        for (size_t i = open; i < pattern.size(); ++i) {
+            if (globIsEscape(pattern, i)) {
+                ++i;
+            } else if (pattern[i] == '{') {
+                ++depth;
+            } else if (pattern[i] == '}' && --depth == 0) {
+                close = i;
+                break;
+            } else if (pattern[i] == ',' && depth == 1) {
+                commas.push_back(i);
+            }
+        }
+        if (close == std::string::npos)
+            break;
+
+        std::string prefix = pattern.substr(0, open);
+        std::string suffix = pattern.substr(close + 1);
+        if (commas.empty()) {
+            std::string body = pattern.substr(open + 1, close - open - 1);
+            size_t dots = body.find("..");
+            int64_t from = 0;
+            int64_t to = 0;
+            if (dots != std::string::npos && globParseInt(body.substr(0, dots), from) &&
+                globParseInt(body.substr(dots + 2), to) &&
+                static_cast<size_t>(from > to ? from - to : to - from) < GLOB_MAX_EXPANSION) {
+                int64_t step = from <= to ? 1 : -1;
+                for (int64_t v = from;; v += step) {
+                    globExpandBraces(prefix + std::to_string(v) + suffix, out);
+                    if (v == to)
+                        break;
+                }
+                return;
+            }
+            continue;
+        }
+
+        size_t start = open + 1;
+        commas.push_back(close);
+        for (size_t comma : commas) {
+            globExpandBraces(prefix + pattern.substr(start, comma - start) + suffix, out);
+            start = comma + 1;
+        }
+        return;
+    }
+    out.push_back(pattern);
+}
+
+static GlobSegment globCompileSegment(const std::string& text) {
+    GlobSegment seg;
+    if (text == "**") {
+        seg.m_kind = GLOB_SEG_GLOBSTAR;
+        return seg;
+    }
+    std::string literal;
+    bool magic = false;
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (globIsEscape(text, i)) {
+            literal += text[++i];
+            continue;
+        }
+        if (text[i] == '*' || text[i] == '?' || text[i] == '[')
+            magic = true;
+        literal += text[i];
+    }
+    seg.m_kind = magic ? GLOB_SEG_WILDCARD : GLOB_SEG_LITERAL;
+    seg.m_text = magic ? text : literal;
+    return seg;
+}
+
+// Returns the index of the ']' closing the class opened at pat[start], or npos.
+static size_t globClassEnd(const std::string& pat, size_t start) {
+    size_t i = start + 1;
+    if (i < pat.size() && (pat[i] == '!' || pat[i] == '^'))
+        ++i;
+    if (i < pat.size() && pat[i] == ']')
+        ++i;
+    while (i < pat.size() && pat[i] != ']') {
+        if (globIsEscape(pat, i))
+            ++i;
+        ++i;
+    }
+    return i < pat.size() ? i : std::string::npos;
+}
+
+static bool globMatchClass(const std::string& pat, size_t start, size_t end, char c) {
+    size_t i = start + 1;
+    bool negate = pat[i] == '!' || pat[i] == '^';
+    if (negate)
+        ++i;
+    bool matched = false;
+    while (i < end) {
+        if (globIsEscape(pat, i))
+            ++i;
+        char lo = pat[i];
+        char hi = lo;
+        if (i + 2 < end && pat[i + 1] == '-') {
+            hi = pat[i + 2];
+            i += 2;
+        }
+        if (GLOB_NOCASE) {
+            char lc = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+            char uc = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+            matched = matched || (lc >= lo && lc <= hi) || (uc >= lo && uc <= hi);
+        } else {
+            matched = matched || (c >= lo && c <= hi);
+        }
+        ++i;
+    }
+    return matched != negate;
+}
+
+// Matches one path segment. Wildcards never match a leading dot unless the pattern spells it.
+static bool globMatchSegment(const GlobSegment& seg, const std::string& name) {
+    const std::string& pat = seg.m_text;
+    if (!name.empty() && name[0] == '.' && (pat.empty() || pat[0] != '.'))
+        return false;
+    if (seg.m_kind == GLOB_SEG_LITERAL) {
+        if (pat.size() != name.size())
+            return false;
+        for (size_t i = 0; i < pat.size(); ++i) {
+            if (!globCharEq(pat[i], name[i]))
+                return false;
+        }
+        return true;
+    }
+
+    size_t p = 0;
+    size_t n = 0;
+    size_t star_p = std::string::npos;
+    size_t star_n = 0;
+    while (n < name.size()) {
+        if (p < pat.size()) {
+            if (pat[p] == '*') {
+                star_p = ++p;
+                star_n = n;
+                continue;
+            }
+            size_t next = p + 1;
+            bool ok = false;
+            if (pat[p] == '?') {
+                ok = true;
+            } else if (pat[p] == '[' && globClassEnd(pat, p) != std::string::npos) {
+                size_t end = globClassEnd(pat, p);
+                ok = globMatchClass(pat, p, end, name[n]);
+                next = end + 1;
+            } else if (globIsEscape(pat, p)) {
+                ok = globCharEq(pat[p + 1], name[n]);
+                next = p + 2;
+            } else {
+                ok = globCharEq(pat[p], name[n]);
+            }
+            if (ok) {
+                p = next;
+                ++n;
+                continue;
+            }
+        }
+        if (star_p == std::string::npos)
+            return false;
+        p = star_p;
+        n = ++star_n;
+    }
+    while (p < pat.size() && pat[p] == '*')
+        ++p;
+    return p == pat.size();
+}
+
+// Adds (pattern, segment) plus everything reachable through zero-length globstars. Returns true
+// when that reaches the end of the pattern, i.e. the entry owning these states is a match.
+static bool globAddState(const GlobPattern& pat, uint32_t p, uint32_t i, std::vector<GlobState>& states) {
+    for (;;) {
+        if (i >= pat.m_segments.size())
+            return true;
+        bool seen = false;
+        for (const GlobState& s : states) {
+            if (s.m_pattern == p && s.m_segment == i) {
+                seen = true;
+                break;
+            }
+        }
+        if (!seen)
+            states.push_back({p, i});
+        if (pat.m_segments[i].m_kind != GLOB_SEG_GLOBSTAR)
+            return false;
+        ++i;
+    }
+}
+
+static void globAddPattern(GlobCtx* p_ctx, const std::string& pattern, bool exclude, const std::string& cwd) {
+    std::vector<std::string> expanded;
+    globExpandBraces(pattern, expanded);
+    for (const std::string& text : expanded) {
+        std::string key;
+        size_t pos = 0;
+        if (!text.empty() && globIsSeparator(text[0])) {
+            key = "/";
+            pos = 1;
+        } else if (text.size() >= 2 && text[1] == ':' && std::isalpha(static_cast<unsigned char>(text[0]))) {
+            key = text.substr(0, 2) + "/";
+            pos = text.size() > 2 && globIsSeparator(text[2]) ? 3 : 2;
+        }
+
+        GlobPattern compiled;
+        compiled.m_exclude = exclude;
+        while (pos <= text.size()) {
+            size_t end = pos;
+            while (end < text.size() && !globIsSeparator(text[end]))
+                ++end;
+            std::string part = text.substr(pos, end - pos);
+            pos = end + 1;
+            if (part.empty() || part == ".")
+                continue;
+            GlobSegment seg = globCompileSegment(part);
+            if (seg.m_kind == GLOB_SEG_GLOBSTAR && !compiled.m_segments.empty() &&
+                compiled.m_segments.back().m_kind == GLOB_SEG_GLOBSTAR)
+                continue;
+            compiled.m_segments.push_back(std::move(seg));
+        }
+        if (compiled.m_segments.empty())
+            continue;
+
+        GlobRoot* p_root = nullptr;
+        for (GlobRoot& root : p_ctx->m_roots) {
+            if (root.m_key == key)
+                p_root = &root;
+        }
+        if (!p_root) {
+            p_ctx->m_roots.emplace_back();
+            p_root = &p_ctx->m_roots.back();
+            p_root->m_key = key;
+            p_root->m_display = key;
+            p_root->m_fs_path = key.empty() ? (cwd.empty() ? std::string(".") : cwd) : key;
+            std::error_code ec;
+            p_root->m_abs_path = fs::absolute(p_root->m_fs_path, ec).lexically_normal().string();
+        }
+        p_root->m_has_positive = p_root->m_has_positive || !exclude;
+        p_root->m_patterns.push_back(std::move(compiled));
+    }
+}
+
+static void globParse(v8::Isolate* p_isolate,
+                      v8::Local<v8::Context> context,
+                      const v8::FunctionCallbackInfo<v8::Value>& args,
+                      GlobCtx* p_ctx) {
+    std::string cwd;
+    std::vector<std::string> excludes;
+    if (args.Length() >= 2 && args[1]->IsObject() && !args[1]->IsFunction()) {
+        v8::Local<v8::Object> options = args[1].As<v8::Object>();
+        v8::Local<v8::Value> val;
+        if (options->Get(context, v8::String::NewFromUtf8Literal(p_isolate, "cwd")).ToLocal(&val) && val->IsString())
+            cwd = *v8::String::Utf8Value(p_isolate, val);
+        if (options->Get(context, v8::String::NewFromUtf8Literal(p_isolate, "withFileTypes")).ToLocal(&val))
+            p_ctx->m_with_file_types = val->BooleanValue(p_isolate);
+        if (options->Get(context, v8::String::NewFromUtf8Literal(p_isolate, "exclude")).ToLocal(&val)) {
+            if (val->IsFunction()) {
+                p_ctx->m_exclude_fn.Reset(p_isolate, val.As<v8::Function>());
+            } else if (val->IsArray()) {
+                v8::Local<v8::Array> list = val.As<v8::Array>();
+                for (uint32_t i = 0; i < list->Length(); ++i) {
+                    v8::Local<v8::Value> item;
+                    if (list->Get(context, i).ToLocal(&item) && item->IsString())
+                        excludes.push_back(*v8::String::Utf8Value(p_isolate, item));
+                }
+            }
+        }
+    }
+
+    std::vector<std::string> patterns;
+    if (args[0]->IsArray()) {
+        v8::Local<v8::Array> list = args[0].As<v8::Array>();
+        for (uint32_t i = 0; i < list->Length(); ++i) {
+            v8::Local<v8::Value> item;
+            if (list->Get(context, i).ToLocal(&item) && item->IsString())
+                patterns.push_back(*v8::String::Utf8Value(p_isolate, item));
+        }
+    } else {
+        patterns.push_back(*v8::String::Utf8Value(p_isolate, args[0]));
+    }
+
+    // "!pattern" entries act like exclude patterns.
+    for (const std::string& pattern : patterns) {
+        if (!pattern.empty() && pattern[0] == '!')
+            globAddPattern(p_ctx, pattern.substr(1), true, cwd);
+        else
+            globAddPattern(p_ctx, pattern, false, cwd);
+    }
+    for (const std::string& pattern : excludes)
+        globAddPattern(p_ctx, pattern, true, cwd);
+}
+
+static void globJobDone(GlobCtx* p_ctx) {
+    if (p_ctx->m_pending.fetch_sub(1) == 1)
+        fanoutMarkDone(p_ctx);
+}
+
+static void globScan(GlobCtx* p_ctx, GlobJob* p_job) {
+    std::unique_ptr<GlobJob> up_job(p_job);
+    if (p_ctx->m_cancelled.load()) {
+        globJobDone(p_ctx);
+        return;
+    }
+
+    const GlobRoot& root = p_ctx->m_roots[up_job->m_root];
+    std::string dir = up_job->m_rel.empty() ? root.m_fs_path : joinPath(root.m_fs_path, up_job->m_rel);
+    std::vector<std::string> names;
+    std::vector<uint8_t> types;
+
+    bool all_literal = true;
+    for (const GlobState& s : up_job->m_states) {
+        if (root.m_patterns[s.m_pattern].m_segments[s.m_segment].m_kind != GLOB_SEG_LITERAL)
+            all_literal = false;
+    }
+    if (all_literal) {
+        for (const GlobState& s : up_job->m_states) {
+            const std::string& name = root.m_patterns[s.m_pattern].m_segments[s.m_segment].m_text;
+            if (std::find(names.begin(), names.end(), name) != names.end())
+                continue;
+            std::error_code ec;
+            fs::file_status status = fs::symlink_status(joinPath(dir, name), ec);
+            if (ec || !fs::exists(status))
+                continue;
+            names.push_back(name);
+            types.push_back(direntTypeOf(status));
+        }
+    } else {
+        // Unreadable directories are skipped rather than failing the whole glob, as in Node.
+        DirStream stream;
+        std::string err;
+        if (stream.open(dir, err))
+            stream.read(names, types, SIZE_MAX, err);
+    }
+
+    std::vector<GlobMatch> matches;
+    for (size_t k = 0; k < names.size(); ++k) {
+        const std::string& name = names[k];
+        bool is_dir = types[k] == DIRENT_DIR;
+        int32_t link_dir = -1;
+        bool matched = false;
+        bool excluded = false;
+        std::vector<GlobState> child;
+
+        for (const GlobState& s : up_job->m_states) {
+            const GlobPattern& pat = root.m_patterns[s.m_pattern];
+            const GlobSegment& seg = pat.m_segments[s.m_segment];
+            bool last = s.m_segment + 1 == pat.m_segments.size();
+            bool reached = false;
+            if (seg.m_kind == GLOB_SEG_GLOBSTAR) {
+                // ** does not descend into dot directories or through symlinks.
+                if (name[0] == '.')
+                    continue;
+                reached = last;
+                if (is_dir)
+                    reached = globAddState(pat, s.m_pattern, s.m_segment, child) || reached;
+            } else if (globMatchSegment(seg, name)) {
+                reached = last;
+                if (!last && types[k] == DIRENT_LINK && link_dir < 0) {
+                    std::error_code ec;
+                    link_dir = fs::is_directory(joinPath(dir, name), ec) ? 1 : 0;
+                }
+                if (!last && (is_dir || link_dir == 1))
+                    reached = globAddState(pat, s.m_pattern, s.m_segment + 1, child);
+            }
+            if (reached) {
+                if (pat.m_exclude)
+                    excluded = true;
+                else
+                    matched = true;
+            }
+        }
+        if (excluded)
+            continue;
+        if (matched)
+            matches.push_back({up_job->m_root, up_job->m_rel, name, types[k]});
+
+        bool has_positive = false;
+        for (const GlobState& s : child)
+            has_positive = has_positive || !root.m_patterns[s.m_pattern].m_exclude;
+        if (!has_positive)
+            continue;
+
+        auto p_child = new GlobJob();
+        p_child->m_root = up_job->m_root;
+        p_child->m_rel = joinPath(up_job->m_rel, name);
+        p_child->m_states = std::move(child);
+        p_ctx->m_pending.fetch_add(1);
+        fanoutSubmit(p_ctx, [p_ctx, p_child]() { globScan(p_ctx, p_child); });
+    }
+
+    if (!matches.empty()) {
+        std::vector<z8::Task*> waiters;
+        {
+            std::lock_guard<std::mutex> lock(p_ctx->m_mutex);
+            for (GlobMatch& match : matches)
+                p_ctx->m_matches.push_back(std::move(match));
+            waiters.swap(p_ctx->m_waiters);
+        }
+        for (z8::Task* p_task : waiters)
+            TaskQueue::getInstance().enqueue(p_task);
+    }
+    globJobDone(p_ctx);
+}
+
+static void globStart(GlobCtx* p_ctx) {
+    p_ctx->m_max_parallel = fanoutMaxParallel();
+    std::vector<GlobJob*> jobs;
+    for (size_t r = 0; r < p_ctx->m_roots.size(); ++r) {
+        const GlobRoot& root = p_ctx->m_roots[r];
+        if (!root.m_has_positive)
+            continue;
+        auto p_job = new GlobJob();
+        p_job->m_root = r;
+        for (uint32_t p = 0; p < root.m_patterns.size(); ++p)
+            globAddState(root.m_patterns[p], p, 0, p_job->m_states);
+        jobs.push_back(p_job);
+    }
+
+    if (jobs.empty()) {
+        p_ctx->m_pending.store(1);
+        fanoutSubmit(p_ctx, [p_ctx]() { globJobDone(p_ctx); });
+        return;
+    }
+    p_ctx->m_pending.store(static_cast<int64_t>(jobs.size()));
+    for (GlobJob* p_job : jobs)
+        fanoutSubmit(p_ctx, [p_ctx, p_job]() { globScan(p_ctx, p_job); });
+}
+
+// Builds the JS value for a match and applies a function-valued exclude option. Returns an
+// empty handle when the match is excluded or the exclude callback threw.
+static v8::MaybeLocal<v8::Value>
+globMatchValue(v8::Isolate* p_isolate, v8::Local<v8::Context> context, GlobCtx* p_ctx, const GlobMatch& match) {
+    const GlobRoot& root = p_ctx->m_roots[match.m_root];
+    v8::Local<v8::Value> value;
+    if (p_ctx->m_with_file_types) {
+        std::string parent = match.m_rel.empty() ? root.m_abs_path : joinPath(root.m_abs_path, match.m_rel);
+        value = createDirentFromType(
+            p_isolate, context, newUtf8String(p_isolate, match.m_name), newUtf8String(p_isolate, parent), match.m_type);
+    } else {
+        value = newUtf8String(p_isolate, joinPath(root.m_display, joinPath(match.m_rel, match.m_name)));
+    }
+    if (p_ctx->m_exclude_fn.IsEmpty())
+        return value;
+
+    v8::Local<v8::Value> excluded;
+    if (!p_ctx->m_exclude_fn.Get(p_isolate)->Call(context, v8::Undefined(p_isolate), 1, &value).ToLocal(&excluded) ||
+        excluded->BooleanValue(p_isolate))
+        return v8::MaybeLocal<v8::Value>();
+    return value;
+}
+
+static v8::Local<v8::Array> globResult(v8::Isolate* p_isolate, v8::Local<v8::Context> context, GlobCtx* p_ctx) {
+    std::vector<v8::Local<v8::Value>> values;
+    values.reserve(p_ctx->m_matches.size());
+    v8::TryCatch try_catch(p_isolate);
+    for (const GlobMatch& match : p_ctx->m_matches) {
+        v8::Local<v8::Value> value;
+        if (globMatchValue(p_isolate, context, p_ctx, match).ToLocal(&value)) {
+            values.push_back(value);
+        } else if (try_catch.HasCaught()) {
+            try_catch.ReThrow();
+            break;
+        }
+    }
+    return v8::Array::New(p_isolate, values.data(), values.size());
+}
+
+static v8::Local<v8::Object>
+makeIterResult(v8::Isolate* p_isolate, v8::Local<v8::Context> context, v8::Local<v8::Value> value, bool done) {
+    v8::Local<v8::Object> result = v8::Object::New(p_isolate);
+    result->Set(context, v8::String::NewFromUtf8Literal(p_isolate, "value"), value).Check();
+    result->Set(context, v8::String::NewFromUtf8Literal(p_isolate, "done"), v8::Boolean::New(p_isolate, done)).Check();
+    return result;
+}
+
+static void globRelease(GlobCtx* p_ctx) {
+    if (--p_ctx->m_refs == 0)
+        delete p_ctx;
+}
+
+static void globParkOrResolve(v8::Isolate* p_isolate,
+                              v8::Local<v8::Context> context,
+                              GlobCtx* p_ctx,
+                              v8::Local<v8::Promise::Resolver> resolver);
+
+static void globWaiterRunner(v8::Isolate* p_isolate, v8::Local<v8::Context> context, Task* p_task) {
+    auto p_ctx = static_cast<GlobCtx*>(p_task->p_data);
+    globParkOrResolve(p_isolate, context, p_ctx, p_task->m_resolver.Get(p_isolate));
+    globRelease(p_ctx);
+}
+
+// Resolves the next iterator result if one is available, otherwise parks the resolver until a
+// worker publishes more matches or the walk finishes.
+static void globParkOrResolve(v8::Isolate* p_isolate,
+                              v8::Local<v8::Context> context,
+                              GlobCtx* p_ctx,
+                              v8::Local<v8::Promise::Resolver> resolver) {
+    for (;;) {
+        GlobMatch match;
+        {
+            std::lock_guard<std::mutex> lock(p_ctx->m_mutex);
+            if (p_ctx->m_matches.empty() || p_ctx->m_cancelled.load()) {
+                if (!p_ctx->m_finished && !p_ctx->m_cancelled.load()) {
+                    z8::Task* p_task = new z8::Task();
+                    p_task->m_resolver.Reset(p_isolate, resolver);
+                    p_task->m_is_promise = true;
+                    p_task->p_data = p_ctx;
+                    p_task->m_runner = globWaiterRunner;
+                    p_ctx->m_refs++;
+                    p_ctx->m_waiters.push_back(p_task);
+                    return;
+                }
+                resolver->Resolve(context, makeIterResult(p_isolate, context, v8::Undefined(p_isolate), true)).Check();
+                return;
+            }
+            match = std::move(p_ctx->m_matches.front());
+            p_ctx->m_matches.pop_front();
+        }
+
+        v8::TryCatch try_catch(p_isolate);
+        v8::Local<v8::Value> value;
+        if (globMatchValue(p_isolate, context, p_ctx, match).ToLocal(&value)) {
+            resolver->Resolve(context, makeIterResult(p_isolate, context, value, false)).Check();
+            return;
+        }
+        if (try_catch.HasCaught()) {
+            p_ctx->m_cancelled.store(true);
+            resolver->Reject(context, try_catch.Exception()).Check();
+            return;
+        }
+    }
+}
+
+static GlobCtx* getGlobCtx(v8::Local<v8::Object> self) {
+    if (self->InternalFieldCount() < 1)
+        return nullptr;
+    return static_cast<GlobCtx*>(self->GetInternalField(0).As<v8::Value>().As<v8::External>()->Value());
+}
+
+static void GlobIteratorNext(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    v8::Local<v8::Context> p_context = p_isolate->GetCurrentContext();
+    auto* p_ctx = getGlobCtx(args.This().As<v8::Object>());
+    v8::Local<v8::Promise::Resolver> p_resolver;
+    if (!p_ctx || !v8::Promise::Resolver::New(p_context).ToLocal(&p_resolver))
+        return;
+    args.GetReturnValue().Set(p_resolver->GetPromise());
+    globParkOrResolve(p_isolate, p_context, p_ctx, p_resolver);
+}
+
+static void GlobIteratorReturn(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    v8::Local<v8::Context> p_context = p_isolate->GetCurrentContext();
+    auto* p_ctx = getGlobCtx(args.This().As<v8::Object>());
+    v8::Local<v8::Promise::Resolver> p_resolver;
+    if (!p_ctx || !v8::Promise::Resolver::New(p_context).ToLocal(&p_resolver))
+        return;
+    // Stops the walk from descending further; jobs already queued finish as no-ops.
+    p_ctx->m_cancelled.store(true);
+    p_resolver->Resolve(p_context, makeIterResult(p_isolate, p_context, v8::Undefined(p_isolate), true)).Check();
+    args.GetReturnValue().Set(p_resolver->GetPromise());
+}
+
+static void IteratorSelf(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    args.GetReturnValue().Set(args.This());
+}
+
+static v8::Local<v8::ObjectTemplate> GetGlobIteratorTemplate(v8::Isolate* p_isolate) {
+    static v8::Persistent<v8::ObjectTemplate> s_tmpl;
+    if (s_tmpl.IsEmpty()) {
+        v8::Local<v8::ObjectTemplate> local_tmpl = v8::ObjectTemplate::New(p_isolate);
+        local_tmpl->SetInternalFieldCount(1);
+        local_tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "next"),
+                        v8::FunctionTemplate::New(p_isolate, GlobIteratorNext));
+        local_tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "return"),
+                        v8::FunctionTemplate::New(p_isolate, GlobIteratorReturn));
+        local_tmpl->Set(v8::Symbol::GetAsyncIterator(p_isolate),
+                        v8::FunctionTemplate::New(p_isolate, IteratorSelf));
+        s_tmpl.Reset(p_isolate, local_tmpl);
+    }
+    return s_tmpl.Get(p_isolate);
+}
+
+void FS::globSync(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    v8::HandleScope handle_scope(p_isolate);
+    v8::Local<v8::Context> p_context = p_isolate->GetCurrentContext();
+    if (args.Length() < 1 || (!args[0]->IsString() && !args[0]->IsArray()))
+        return;
+
+    GlobCtx ctx;
+    globParse(p_isolate, p_context, args, &ctx);
+    globStart(&ctx);
+    fanoutWait(&ctx);
+    args.GetReturnValue().Set(globResult(p_isolate, p_context, &ctx));
+}
+
+void FS::glob(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    v8::Local<v8::Context> p_context = p_isolate->GetCurrentContext();
+    if (args.Length() < 2 || (!args[0]->IsString() && !args[0]->IsArray()) ||
+        !args[args.Length() - 1]->IsFunction())
+        return;
+
+    v8::Local<v8::Function> p_cb = args[args.Length() - 1].As<v8::Function>();
+    auto p_ctx = new GlobCtx();
+    globParse(p_isolate, p_context, args, p_ctx);
+
+    z8::Task* p_task = new z8::Task();
+    p_task->m_callback.Reset(p_isolate, p_cb);
+    p_task->m_is_promise = false;
+    p_task->p_data = p_ctx;
+    p_task->m_runner = [](v8::Isolate* isolate, v8::Local<v8::Context> context, Task* task) {
+        auto p_ctx = static_cast<GlobCtx*>(task->p_data);
+        v8::Local<v8::Value> argv[2];
+        v8::TryCatch try_catch(isolate);
+        argv[1] = globResult(isolate, context, p_ctx);
+        if (try_catch.HasCaught()) {
+            argv[0] = try_catch.Exception();
+            argv[1] = v8::Undefined(isolate);
+            try_catch.Reset();
+        } else {
+            argv[0] = v8::Null(isolate);
+        }
+        (void) task->m_callback.Get(isolate)->Call(context, context->Global(), 2, argv);
+        delete p_ctx;
+    };
+
+    p_ctx->p_done_task = p_task;
+    globStart(p_ctx);
+}
+
+// fsPromises.glob() returns an async iterator; matches stream out while the walk is running.
+void FS::globPromise(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    v8::Local<v8::Context> p_context = p_isolate->GetCurrentContext();
+    if (args.Length() < 1 || (!args[0]->IsString() && !args[0]->IsArray()))
+        return;
+
+    auto p_ctx = new GlobCtx();
+    globParse(p_isolate, p_context, args, p_ctx);
+
+    v8::Local<v8::Object> iterator = GetGlobIteratorTemplate(p_isolate)->NewInstance(p_context).ToLocalChecked();
+    iterator->SetInternalField(0, v8::External::New(p_isolate, p_ctx));
+
+    // One reference for the walk, one for the iterator object.
+    p_ctx->m_refs = 2;
+    p_ctx->m_self.Reset(p_isolate, iterator);
+    p_ctx->m_self.SetWeak(
+        p_ctx,
+        [](const v8::WeakCallbackInfo<GlobCtx>& data) {
+            GlobCtx* p_ctx = data.GetParameter();
+            p_ctx->m_self.Reset();
+            p_ctx->m_cancelled.store(true);
+            globRelease(p_ctx);
+        },
+        v8::WeakCallbackType::kParameter);
+
+    z8::Task* p_task = new z8::Task();
+    p_task->m_is_promise = false;
+    p_task->p_data = p_ctx;
+    p_task->m_runner = [](v8::Isolate* isolate, v8::Local<v8::Context> context, Task* task) {
+        auto p_ctx = static_cast<GlobCtx*>(task->p_data);
+        p_ctx->m_finished = true;
+        std::vector<z8::Task*> waiters;
+        {
+            std::lock_guard<std::mutex> lock(p_ctx->m_mutex);
+            waiters.swap(p_ctx->m_waiters);
+        }
+        for (z8::Task* p_waiter : waiters)
+            TaskQueue::getInstance().enqueue(p_waiter);
+        globRelease(p_ctx);
+    };
+
+    p_ctx->p_done_task = p_task;
+    globStart(p_ctx);
+    args.GetReturnValue().Set(iterator);
+}
+
+// --- Watch ---
+// A single background thread serves every watcher. On Linux it sleeps in poll() on one inotify
+// fd plus an eventfd used to wake it for new watches, and watchers of the same directory share
+// its inotify watch descriptor. Paths inotify cannot take (and other platforms) fall back to
+// periodic snapshots. Events are coalesced per watcher over the debounce window and reach the
+// main loop in batches through the TaskQueue.
+static constexpr int64_t WATCH_POLL_INTERVAL_MS = 100;
+static constexpr int64_t WATCH_FILE_INTERVAL_MS = 5007;
+static constexpr size_t WATCH_DEFAULT_MAX_QUEUE = 2048;
+static constexpr uint8_t WATCH_KIND_EMITTER = 0;
+static constexpr uint8_t WATCH_KIND_ITERATOR = 1;
+static constexpr uint8_t WATCH_KIND_STAT = 2;
+
+#ifdef __linux__
+static constexpr uint32_t WATCH_INOTIFY_MASK =
+    IN_ATTRIB | IN_CREATE | IN_MODIFY | IN_DELETE | IN_DELETE_SELF | IN_MOVE_SELF | IN_MOVED_FROM | IN_MOVED_TO;
+#endif
+
+struct WatchEvent {
+    int32_t m_id = 0;
+    bool m_rename = false;
+    std::string m_filename;
+};
+
+struct WatchStamp {
+    bool m_exists = false;
+    bool m_is_dir = false;
+    int64_t m_size = 0;
+    int64_t m_mtime = 0;
+
+    bool operator==(const WatchStamp& other) const = default;
+};
+
+// Thread-side description of one watcher.
+struct WatchConfig {
+    std::string m_path;
+    std::string m_name;
+    bool m_is_dir = false;
+    bool m_recursive = false;
+    bool m_stat = false;
+    bool m_polling = false;
+    bool m_primed = false;
+    int64_t m_interval_ms = WATCH_POLL_INTERVAL_MS;
+    int64_t m_debounce_ms = 0;
+    std::chrono::steady_clock::time_point m_next_poll;
+    std::map<std::string, WatchStamp> m_snapshot;
+    std::vector<int32_t> m_wds;
+};
+
+static void watchDispatch(v8::Isolate* p_isolate, v8::Local<v8::Context> context, Task* p_task);
+
+static WatchStamp watchStampOf(const std::string& path) {
+    WatchStamp stamp;
+    std::error_code ec;
+    fs::file_status status = fs::status(path, ec);
+    if (ec || !fs::exists(status))
+        return stamp;
+    stamp.m_exists = true;
+    stamp.m_is_dir = fs::is_directory(status);
+    if (fs::is_regular_file(status))
+        stamp.m_size = static_cast<int64_t>(fs::file_size(path, ec));
+    stamp.m_mtime = static_cast<int64_t>(fs::last_write_time(path, ec).time_since_epoch().count());
+    return stamp;
+}
+
+static void
+watchSnapshot(const std::string& path, const std::string& rel, bool recursive, std::map<std::string, WatchStamp>& out) {
+    DirStream stream;
+    std::string err;
+    std::vector<std::string> names;
+    std::vector<uint8_t> types;
+    if (!stream.open(path, err) || !stream.read(names, types, SIZE_MAX, err))
+        return;
+    for (size_t i = 0; i < names.size(); ++i) {
+        std::string child = joinPath(path, names[i]);
+        std::string child_rel = joinPath(rel, names[i]);
+        out[child_rel] = watchStampOf(child);
+        if (recursive && types[i] == DIRENT_DIR)
+            watchSnapshot(child, child_rel, true, out);
+    }
+}
+
+class WatchHub {
+  public:
+    static WatchHub& getInstance() {
+        static WatchHub s_instance;
+        return s_instance;
+    }
+
+    WatchHub(const WatchHub&) = delete;
+    WatchHub& operator=(const WatchHub&) = delete;
+
+    bool add(int32_t id, WatchConfig config, std::string& err);
+    void remove(int32_t id);
+
+  private:
+    struct Sub {
+        int32_t m_id = 0;
+        std::string m_prefix;
+        std::string m_only;
+    };
+
+    struct Target {
+        std::string m_path;
+        std::vector<Sub> m_subs;
+    };
+
+    struct Pending {
+        WatchEvent m_event;
+        std::chrono::steady_clock::time_point m_due;
+    };
+
+    struct Scan {
+        int32_t m_id = 0;
+        std::string m_path;
+        std::string m_prefix;
+        bool m_add_self = false;
+    };
+
+    WatchHub() = default;
+    ~WatchHub();
+
+    void ensureThread();
+    void wake();
+    void run();
+    int64_t nextTimeoutMs();
+    void queueEvent(int32_t id, bool rename, const std::string& filename);
+    void pollDue();
+    void flushDue();
+#ifdef __linux__
+    int32_t addWatch(const std::string& path, const Sub& sub);
+    void processScans();
+    void readInotify(std::vector<char>& buf);
+
+    int32_t m_inotify_fd = -1;
+    int32_t m_wake_fd = -1;
+    std::map<int32_t, Target> m_targets;
+    std::vector<Scan> m_scans;
+#else
+    bool m_wake = false;
+    std::condition_variable m_cv;
+#endif
+
+    // Everything below is guarded by m_mutex.
+    std::mutex m_mutex;
+    std::thread m_thread;
+    bool m_stop = false;
+    std::map<int32_t, WatchConfig> m_configs;
+    std::vector<Pending> m_pending;
+    std::set<std::string> m_pending_keys;
+};
+
+WatchHub::~WatchHub() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+        wake();
+    }
+    if (m_thread.joinable())
+        m_thread.join();
+#ifdef __linux__
+    if (m_inotify_fd >= 0)
+        ::close(m_inotify_fd);
+    if (m_wake_fd >= 0)
+        ::close(m_wake_fd);
+#endif
+}
+
+// Expects m_mutex to be held.
+void WatchHub::ensureThread() {
+    if (m_thread.joinable())
+        return;
+#ifdef __linux__
+    m_inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    m_wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+#endif
+    m_thread = std::thread([this]() { run(); });
+}
+
+// Expects m_mutex to be held.
+void WatchHub::wake() {
+#ifdef __linux__
+    if (m_wake_fd >= 0) {
+        uint64_t one = 1;
+        ssize_t written = ::write(m_wake_fd, &one, sizeof(one));
+        (void) written;
+    }
+#else
+    m_wake = true;
+    m_cv.notify_one();
+#endif
+}
+
+bool WatchHub::add(int32_t id, WatchConfig config, std::string& err) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    WatchStamp stamp = watchStampOf(config.m_path);
+    if (!config.m_stat && !stamp.m_exists) {
+        err = "ENOENT: no such file or directory, watch '" + config.m_path + "'";
+        return false;
+    }
+    ensureThread();
+
+    config.m_is_dir = stamp.m_is_dir;
+    config.m_name = fs::path(config.m_path).filename().string();
+    if (config.m_stat) {
+        // watchFile reports against the stat taken when it started.
+        config.m_snapshot[""] = stamp;
+        config.m_primed = true;
+    }
+    WatchConfig& stored = m_configs[id] = std::move(config);
+
+    int32_t wd = -1;
+#ifdef __linux__
+    if (m_inotify_fd >= 0) {
+        Sub sub;
+        sub.m_id = id;
+        if (stored.m_stat) {
+            // Watch the parent so the file may be created, replaced or deleted.
+            sub.m_only = stored.m_name;
+            std::string parent = fs::path(stored.m_path).parent_path().string();
+            wd = addWatch(parent.empty() ? std::string(".") : parent, sub);
+        } else {
+            wd = addWatch(stored.m_path, sub);
+            if (wd >= 0 && stored.m_recursive && stored.m_is_dir)
+                m_scans.push_back({id, stored.m_path, "", false});
+        }
+    }
+#endif
+    stored.m_polling = wd < 0;
+    if (stored.m_polling) {
+        auto now = std::chrono::steady_clock::now();
+        stored.m_next_poll = stored.m_primed ? now + std::chrono::milliseconds(stored.m_interval_ms) : now;
+    }
+    wake();
+    return true;
+}
+
+void WatchHub::remove(int32_t id) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_configs.find(id);
+    if (it == m_configs.end())
+        return;
+#ifdef __linux__
+    for (int32_t wd : it->second.m_wds) {
+        auto target = m_targets.find(wd);
+        if (target == m_targets.end())
+            continue;
+        auto& subs = target->second.m_subs;
+        subs.erase(std::remove_if(subs.begin(), subs.end(), [id](const Sub& sub) { return sub.m_id == id; }),
+                   subs.end());
+        // The descriptor is shared; it goes away with its last subscriber.
+        if (subs.empty()) {
+            inotify_rm_watch(m_inotify_fd, wd);
+            m_targets.erase(target);
+        }
+    }
+#endif
+    m_configs.erase(it);
+    std::vector<Pending> kept;
+    for (Pending& pending : m_pending) {
+        if (pending.m_event.m_id != id) {
+            kept.push_back(std::move(pending));
+        }
+    }
+    m_pending.swap(kept);
+    m_pending_keys.clear();
+    for (const Pending& pending : m_pending) {
+        m_pending_keys.insert(std::to_string(pending.m_event.m_id) + (pending.m_event.m_rename ? "r" : "c") +
+                              pending.m_event.m_filename);
+    }
+}
+
+// Expects m_mutex to be held. Duplicates of an event already waiting to be flushed are dropped.
+void WatchHub::queueEvent(int32_t id, bool rename, const std::string& filename) {
+    std::string key = std::to_string(id) + (rename ? "r" : "c") + filename;
+    if (!m_pending_keys.insert(key).second)
+        return;
+    Pending pending;
+    pending.m_event.m_id = id;
+    pending.m_event.m_rename = rename;
+    pending.m_event.m_filename = filename;
+    pending.m_due = std::chrono::steady_clock::now() + std::chrono::milliseconds(m_configs[id].m_debounce_ms);
+    m_pending.push_back(std::move(pending));
+}
+
+// Expects m_mutex to be held. Returns -1 to block until woken.
+int64_t WatchHub::nextTimeoutMs() {
+    auto now = std::chrono::steady_clock::now();
+    auto next = std::chrono::steady_clock::time_point::max();
+#ifdef __linux__
+    if (!m_scans.empty())
+        return 0;
+    if (m_wake_fd < 0)
+        next = now + std::chrono::milliseconds(WATCH_POLL_INTERVAL_MS);
+#endif
+    for (const Pending& pending : m_pending)
+        next = std::min(next, pending.m_due);
+    for (const auto& [id, config] : m_configs) {
+        if (config.m_polling)
+            next = std::min(next, config.m_next_poll);
+    }
+    if (next == std::chrono::steady_clock::time_point::max())
+        return -1;
+    if (next <= now)
+        return 0;
+    return std::chrono::duration_cast<std::chrono::milliseconds>(next - now).count() + 1;
+}
+
+// Expects m_mutex to be held.
+void WatchHub::pollDue() {
+    auto now = std::chrono::steady_clock::now();
+    for (auto& [id, config] : m_configs) {
+        if (!config.m_polling || now < config.m_next_poll)
+            continue;
+        config.m_next_poll = now + std::chrono::milliseconds(config.m_interval_ms);
+
+        std::map<std::string, WatchStamp> snapshot;
+        if (config.m_is_dir && !config.m_stat)
+            watchSnapshot(config.m_path, "", config.m_recursive, snapshot);
+        else
+            snapshot[""] = watchStampOf(config.m_path);
+
+        if (config.m_primed) {
+            for (const auto& [rel, stamp] : snapshot) {
+                auto old = config.m_snapshot.find(rel);
+                if (old != config.m_snapshot.end() && old->second == stamp)
+                    continue;
+                bool rename = old == config.m_snapshot.end() || old->second.m_exists != stamp.m_exists;
+                queueEvent(id, rename && !config.m_stat, rel.empty() && !config.m_stat ? config.m_name : rel);
+            }
+            for (const auto& [rel, stamp] : config.m_snapshot) {
+                if (snapshot.find(rel) == snapshot.end())
+                    queueEvent(id, true, rel);
+            }
+        }
+        config.m_snapshot = std::move(snapshot);
+        config.m_primed = true;
+    }
+}
+
+// Expects m_mutex to be held.
+void WatchHub::flushDue() {
+    auto now = std::chrono::steady_clock::now();
+    auto p_events = new std::vector<WatchEvent>();
+    std::vector<Pending> kept;
+    for (Pending& pending : m_pending) {
+        if (pending.m_due <= now) {
+            m_pending_keys.erase(std::to_string(pending.m_event.m_id) + (pending.m_event.m_rename ? "r" : "c") +
+                                 pending.m_event.m_filename);
+            p_events->push_back(std::move(pending.m_event));
+        } else {
+            kept.push_back(std::move(pending));
+        }
+    }
+    m_pending.swap(kept);
+    if (p_events->empty()) {
+        delete p_events;
+        return;
+    }
+
+    z8::Task* p_task = new z8::Task();
+    p_task->m_is_promise = false;
+    p_task->p_data = p_events;
+    p_task->m_runner = watchDispatch;
+    TaskQueue::getInstance().enqueue(p_task);
+}
+
+#ifdef __linux__
+// Expects m_mutex to be held.
+int32_t WatchHub::addWatch(const std::string& path, const Sub& sub) {
+    // inotify hands back the existing descriptor when the inode is already watched.
+    int32_t wd = inotify_add_watch(m_inotify_fd, path.c_str(), WATCH_INOTIFY_MASK);
+    if (wd < 0)
+        return -1;
+    Target& target = m_targets[wd];
+    if (target.m_path.empty())
+        target.m_path = path;
+    target.m_subs.push_back(sub);
+    m_configs[sub.m_id].m_wds.push_back(wd);
+    return wd;
+}
+
+// Adds watches for the subtrees of recursive watchers. Directories are listed without the lock.
+void WatchHub::processScans() {
+    for (;;) {
+        Scan scan;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_scans.empty() || m_stop)
+                return;
+            scan = std::move(m_scans.back());
+            m_scans.pop_back();
+            if (m_configs.find(scan.m_id) == m_configs.end())
+                continue;
+            if (scan.m_add_self && addWatch(scan.m_path, {scan.m_id, scan.m_prefix, ""}) < 0)
+                continue;
+        }
+
+        DirStream stream;
+        std::string err;
+        std::vector<std::string> names;
+        std::vector<uint8_t> types;
+        if (!stream.open(scan.m_path, err, false) || !stream.read(names, types, SIZE_MAX, err))
+            continue;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_configs.find(scan.m_id) == m_configs.end())
+            continue;
+        for (size_t i = 0; i < names.size(); ++i) {
+            if (types[i] == DIRENT_DIR)
+                m_scans.push_back(
+                    {scan.m_id, joinPath(scan.m_path, names[i]), joinPath(scan.m_prefix, names[i]), true});
+        }
+    }
+}
+
+void WatchHub::readInotify(std::vector<char>& buf) {
+    ssize_t len = ::read(m_inotify_fd, buf.data(), buf.size());
+    if (len <= 0)
+        return;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (ssize_t off = 0; off < len;) {
+        const auto* p_ev = reinterpret_cast<const inotify_event*>(buf.data() + off);
+        off += static_cast<ssize_t>(sizeof(inotify_event) + p_ev->len);
+
+        auto target = m_targets.find(p_ev->wd);
+        if (target == m_targets.end())
+            continue;
+        if (p_ev->mask & IN_IGNORED) {
+            // The kernel already dropped this descriptor (path deleted or unmounted).
+            m_targets.erase(target);
+            continue;
+        }
+
+        std::string name = p_ev->len > 0 ? std::string(p_ev->name) : std::string();
+        bool rename = (p_ev->mask & (IN_MODIFY | IN_ATTRIB)) == 0;
+        for (const Sub& sub : target->second.m_subs) {
+            auto found = m_configs.find(sub.m_id);
+            if (found == m_configs.end())
+                continue;
+            WatchConfig& config = found->second;
+            if (config.m_stat) {
+                if (name != sub.m_only)
+                    continue;
+                WatchStamp stamp = watchStampOf(config.m_path);
+                if (stamp == config.m_snapshot[""])
+                    continue;
+                config.m_snapshot[""] = stamp;
+                queueEvent(sub.m_id, false, "");
+                continue;
+            }
+
+            std::string filename;
+            if (!name.empty())
+                filename = joinPath(sub.m_prefix, name);
+            else
+                filename = sub.m_prefix.empty() ? config.m_name : sub.m_prefix;
+            queueEvent(sub.m_id, rename, filename);
+
+            if (config.m_recursive && (p_ev->mask & IN_ISDIR) && (p_ev->mask & (IN_CREATE | IN_MOVED_TO)))
+                m_scans.push_back({sub.m_id, joinPath(target->second.m_path, name), filename, true});
+        }
+    }
+}
+#endif
+
+void WatchHub::run() {
+#ifdef __linux__
+    std::vector<char> buf(64 * 1024);
+#endif
+    for (;;) {
+#ifdef __linux__
+        processScans();
+#endif
+        int64_t timeout = -1;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_stop)
+                return;
+            timeout = nextTimeoutMs();
+        }
+
+#ifdef __linux__
+        pollfd fds[2] = {{m_inotify_fd, POLLIN, 0}, {m_wake_fd, POLLIN, 0}};
+        int32_t ready = ::poll(fds, 2, static_cast<int32_t>(std::min<int64_t>(timeout, INT32_MAX)));
+        if (ready > 0 && (fds[1].revents & POLLIN)) {
+            uint64_t count = 0;
+            ssize_t drained = ::read(m_wake_fd, &count, sizeof(count));
+            (void) drained;
+        }
+        if (ready > 0 && (fds[0].revents & POLLIN))
+            readInotify(buf);
+        std::lock_guard<std::mutex> lock(m_mutex);
+#else
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (!m_wake && !m_stop) {
+            if (timeout < 0)
+                m_cv.wait(lock, [this]() { return m_wake || m_stop; });
+            else
+                m_cv.wait_for(lock, std::chrono::milliseconds(timeout), [this]() { return m_wake || m_stop; });
+        }
+        m_wake = false;
+#endif
+        if (m_stop)
+            return;
+        pollDue();
+        flushDue();
+    }
+}
+
+// Main-thread side of a watcher: the JS object plus, for fsPromises.watch, undelivered events.
+struct WatcherRecord {
+    int32_t m_id = 0;
+    uint8_t m_kind = WATCH_KIND_EMITTER;
+    std::string m_path;
+    bool m_ref = false;
+    v8::Global<v8::Object> m_self;
+    v8::Global<v8::Object> m_prev_stats;
+    size_t m_max_queue = WATCH_DEFAULT_MAX_QUEUE;
+    std::deque<WatchEvent> m_queue;
+    std::deque<v8::Global<v8::Promise::Resolver>> m_waiters;
+};
+
+static std::map<int32_t, std::unique_ptr<WatcherRecord>>& watchRegistry() {
+    // Leaked on purpose: records hold V8 handles that must not be reset after the isolate is gone.
+    static auto* p_registry = new std::map<int32_t, std::unique_ptr<WatcherRecord>>();
+    return *p_registry;
+}
+
+static int32_t s_next_watch_id = 1;
+static int32_t s_watch_refs = 0;
+// Log writers with a pending flush() or close() promise (see createLogWriter).
+static int32_t s_log_waiting = 0;
+
+bool FS::hasActiveWatchers() {
+    return s_watch_refs > 0 || s_log_waiting > 0;
+}
+
+static void watchSetRef(WatcherRecord* p_rec, bool ref) {
+    if (p_rec->m_ref == ref)
+        return;
+    p_rec->m_ref = ref;
+    s_watch_refs += ref ? 1 : -1;
+}
+
+static void watchParseOptions(v8::Isolate* p_isolate,
+                              v8::Local<v8::Context> context,
+                              v8::Local<v8::Value> arg,
+                              WatchConfig& config,
+                              bool& persistent,
+                              size_t& max_queue) {
+    if (!arg->IsObject() || arg->IsFunction())
+        return;
+    v8::Local<v8::Object> options = arg.As<v8::Object>();
+    v8::Local<v8::Value> val;
+    if (options->Get(context, v8::String::NewFromUtf8Literal(p_isolate, "persistent")).ToLocal(&val) &&
+        !val->IsUndefined())
+        persistent = val->BooleanValue(p_isolate);
+    if (options->Get(context, v8::String::NewFromUtf8Literal(p_isolate, "recursive")).ToLocal(&val))
+        config.m_recursive = val->BooleanValue(p_isolate);
+    if (options->Get(context, v8::String::NewFromUtf8Literal(p_isolate, "debounce")).ToLocal(&val) && val->IsNumber())
+        config.m_debounce_ms = std::max<int64_t>(0, static_cast<int64_t>(val->NumberValue(context).FromMaybe(0)));
+    if (options->Get(context, v8::String::NewFromUtf8Literal(p_isolate, "interval")).ToLocal(&val) && val->IsNumber())
+        config.m_interval_ms = std::max<int64_t>(1, static_cast<int64_t>(val->NumberValue(context).FromMaybe(0)));
+    if (options->Get(context, v8::String::NewFromUtf8Literal(p_isolate, "maxQueue")).ToLocal(&val) && val->IsNumber())
+        max_queue = static_cast<size_t>(std::max<double>(1, val->NumberValue(context).FromMaybe(1)));
+}
+
+static int32_t getWatchId(v8::Local<v8::Object> self) {
+    if (self->InternalFieldCount() < 1)
+        return 0;
+    v8::Local<v8::Value> id = self->GetInternalField(0).As<v8::Value>();
+    return id->IsInt32() ? id.As<v8::Int32>()->Value() : 0;
+}
+
+static v8::MaybeLocal<v8::Value> callMethod(v8::Isolate* p_isolate,
+                                            v8::Local<v8::Context> context,
+                                            v8::Local<v8::Object> self,
+                                            const char* p_name,
+                                            int32_t argc,
+                                            v8::Local<v8::Value>* p_argv) {
+    v8::Local<v8::Value> fn;
+    if (!self->Get(context, v8::String::NewFromUtf8(p_isolate, p_name).ToLocalChecked()).ToLocal(&fn) ||
+        !fn->IsFunction())
+        return v8::MaybeLocal<v8::Value>();
+    return fn.As<v8::Function>()->Call(context, self, argc, p_argv);
+}
+
+static v8::Local<v8::Object> watchEventValue(v8::Isolate* p_isolate, const WatchEvent& event) {
+    v8::Local<v8::Name> keys[2] = {v8::String::NewFromUtf8Literal(p_isolate, "eventType"),
+                                   v8::String::NewFromUtf8Literal(p_isolate, "filename")};
+    v8::Local<v8::Value> values[2] = {event.m_rename ? v8::String::NewFromUtf8Literal(p_isolate, "rename")
+                                                     : v8::String::NewFromUtf8Literal(p_isolate, "change"),
+                                      newUtf8String(p_isolate, event.m_filename)};
+    return v8::Object::New(p_isolate, v8::Null(p_isolate), keys, values, 2);
+}
+
+static void watchClose(v8::Isolate* p_isolate, v8::Local<v8::Context> context, int32_t id) {
+    auto& registry = watchRegistry();
+    auto it = registry.find(id);
+    if (it == registry.end())
+        return;
+    std::unique_ptr<WatcherRecord> up_rec = std::move(it->second);
+    registry.erase(it);
+    watchSetRef(up_rec.get(), false);
+    WatchHub::getInstance().remove(id);
+    for (auto& waiter : up_rec->m_waiters) {
+        waiter.Get(p_isolate)
+            ->Resolve(context, makeIterResult(p_isolate, context, v8::Undefined(p_isolate), true))
+            .Check();
+    }
+}
+
+static void watchDispatch(v8::Isolate* p_isolate, v8::Local<v8::Context> context, Task* p_task) {
+    std::unique_ptr<std::vector<WatchEvent>> up_events(static_cast<std::vector<WatchEvent>*>(p_task->p_data));
+    auto& registry = watchRegistry();
+    for (const WatchEvent& event : *up_events) {
+        // Listeners may close watchers, so the record is looked up again for every event.
+        auto it = registry.find(event.m_id);
+        if (it == registry.end())
+            continue;
+        WatcherRecord* p_rec = it->second.get();
+        v8::Local<v8::Object> self = p_rec->m_self.Get(p_isolate);
+
+        if (p_rec->m_kind == WATCH_KIND_STAT) {
+            std::error_code ec;
+            v8::Local<v8::Value> argv[3] = {v8::String::NewFromUtf8Literal(p_isolate, "change"),
+                                            FS::createStats(p_isolate, p_rec->m_path, ec, true),
+                                            p_rec->m_prev_stats.Get(p_isolate)};
+            p_rec->m_prev_stats.Reset(p_isolate, argv[1].As<v8::Object>());
+            (void) callMethod(p_isolate, context, self, "emit", 3, argv);
+        } else if (p_rec->m_kind == WATCH_KIND_ITERATOR) {
+            if (!p_rec->m_waiters.empty()) {
+                v8::Local<v8::Promise::Resolver> resolver = p_rec->m_waiters.front().Get(p_isolate);
+                p_rec->m_waiters.pop_front();
+                resolver->Resolve(context, makeIterResult(p_isolate, context, watchEventValue(p_isolate, event), false))
+                    .Check();
+            } else if (p_rec->m_queue.size() < p_rec->m_max_queue) {
+                p_rec->m_queue.push_back(event);
+            }
+        } else {
+            v8::Local<v8::Value> argv[3] = {v8::String::NewFromUtf8Literal(p_isolate, "change"),
+                                            event.m_rename ? v8::String::NewFromUtf8Literal(p_isolate, "rename")
+                                                           : v8::String::NewFromUtf8Literal(p_isolate, "change"),
+                                            newUtf8String(p_isolate, event.m_filename)};
+            (void) callMethod(p_isolate, context, self, "emit", 3, argv);
+        }
+    }
+}
+
+static void WatcherClose(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    v8::Local<v8::Context> p_context = p_isolate->GetCurrentContext();
+    int32_t id = getWatchId(args.This());
+    if (watchRegistry().find(id) == watchRegistry().end())
+        return;
+    watchClose(p_isolate, p_context, id);
+    v8::Local<v8::Value> argv[1] = {v8::String::NewFromUtf8Literal(p_isolate, "close")};
+    (void) callMethod(p_isolate, p_context, args.This(), "emit", 1, argv);
+}
+
+static void watcherSetRef(const v8::FunctionCallbackInfo<v8::Value>& args, bool ref) {
+    auto it = watchRegistry().find(getWatchId(args.This()));
+    if (it != watchRegistry().end())
+        watchSetRef(it->second.get(), ref);
+    args.GetReturnValue().Set(args.This());
+}
+
+static void WatcherRef(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    watcherSetRef(args, true);
+}
+
+static void WatcherUnref(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    watcherSetRef(args, false);
+}
+
+static v8::Local<v8::Function> GetWatcherClass(v8::Isolate* p_isolate, v8::Local<v8::Context> context) {
+    static v8::Persistent<v8::FunctionTemplate> s_tmpl;
+    if (s_tmpl.IsEmpty()) {
+        v8::Local<v8::FunctionTemplate> tmpl = v8::FunctionTemplate::New(p_isolate, Events::eeConstructor);
+        tmpl->SetClassName(v8::String::NewFromUtf8Literal(p_isolate, "FSWatcher"));
+        tmpl->Inherit(Events::getEventEmitterTemplate(p_isolate));
+        tmpl->InstanceTemplate()->SetInternalFieldCount(1);
+        v8::Local<v8::ObjectTemplate> proto = tmpl->PrototypeTemplate();
+        proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "close"),
+                   v8::FunctionTemplate::New(p_isolate, WatcherClose));
+        proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "ref"), v8::FunctionTemplate::New(p_isolate, WatcherRef));
+        proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "unref"),
+                   v8::FunctionTemplate::New(p_isolate, WatcherUnref));
+        s_tmpl.Reset(p_isolate, tmpl);
+    }
+    return s_tmpl.Get(p_isolate)->GetFunction(context).ToLocalChecked();
+}
+
+static void WatchIteratorNext(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    v8::Local<v8::Context> p_context = p_isolate->GetCurrentContext();
+    v8::Local<v8::Promise::Resolver> p_resolver;
+    if (!v8::Promise::Resolver::New(p_context).ToLocal(&p_resolver))
+        return;
+    args.GetReturnValue().Set(p_resolver->GetPromise());
+
+    auto it = watchRegistry().find(getWatchId(args.This()));
+    if (it == watchRegistry().end()) {
+        p_resolver->Resolve(p_context, makeIterResult(p_isolate, p_context, v8::Undefined(p_isolate), true)).Check();
+        return;
+    }
+    WatcherRecord* p_rec = it->second.get();
+    if (p_rec->m_queue.empty()) {
+        p_rec->m_waiters.emplace_back(p_isolate, p_resolver);
+        return;
+    }
+    WatchEvent event = std::move(p_rec->m_queue.front());
+    p_rec->m_queue.pop_front();
+    p_resolver->Resolve(p_context, makeIterResult(p_isolate, p_context, watchEventValue(p_isolate, event), false))
+        .Check();
+}
+
+static void WatchIteratorReturn(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    v8::Local<v8::Context> p_context = p_isolate->GetCurrentContext();
+    watchClose(p_isolate, p_context, getWatchId(args.This()));
+    v8::Local<v8::Promise::Resolver> p_resolver;
+    if (!v8::Promise::Resolver::New(p_context).ToLocal(&p_resolver))
+        return;
+    p_resolver->Resolve(p_context, makeIterResult(p_isolate, p_context, v8::Undefined(p_isolate), true)).Check();
+    args.GetReturnValue().Set(p_resolver->GetPromise());
+}
+
+static v8::Local<v8::ObjectTemplate> GetWatchIteratorTemplate(v8::Isolate* p_isolate) {
+    static v8::Persistent<v8::ObjectTemplate> s_tmpl;
+    if (s_tmpl.IsEmpty()) {
+        v8::Local<v8::ObjectTemplate> local_tmpl = v8::ObjectTemplate::New(p_isolate);
+        local_tmpl->SetInternalFieldCount(1);
+        local_tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "next"),
+                        v8::FunctionTemplate::New(p_isolate, WatchIteratorNext));
+        local_tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "return"),
+                        v8::FunctionTemplate::New(p_isolate, WatchIteratorReturn));
+        local_tmpl->Set(v8::Symbol::GetAsyncIterator(p_isolate), v8::FunctionTemplate::New(p_isolate, IteratorSelf));
+        s_tmpl.Reset(p_isolate, local_tmpl);
+    }
+    return s_tmpl.Get(p_isolate);
+}
+
+// Registers a watcher with the hub and the main-thread registry. Throws and returns 0 on error.
+static int32_t watchStart(v8::Isolate* p_isolate,
+                          v8::Local<v8::Object> self,
+                          uint8_t kind,
+                          WatchConfig config,
+                          bool persistent,
+                          size_t max_queue) {
+    int32_t id = s_next_watch_id++;
+    std::string path = config.m_path;
+    std::string err;
+    if (!WatchHub::getInstance().add(id, std::move(config), err)) {
+        p_isolate->ThrowException(
+            v8::Exception::Error(v8::String::NewFromUtf8(p_isolate, err.c_str()).ToLocalChecked()));
+        return 0;
+    }
+    self->SetInternalField(0, v8::Integer::New(p_isolate, id));
+
+    auto up_rec = std::make_unique<WatcherRecord>();
+    up_rec->m_id = id;
+    up_rec->m_kind = kind;
+    up_rec->m_path = path;
+    up_rec->m_max_queue = max_queue;
+    up_rec->m_self.Reset(p_isolate, self);
+    WatcherRecord* p_rec = up_rec.get();
+    watchRegistry()[id] = std::move(up_rec);
+    watchSetRef(p_rec, persistent);
+    return id;
+}
+
+void FS::watch(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    v8::Local<v8::Context> p_context = p_isolate->GetCurrentContext();
+    if (args.Length() < 1 || !args[0]->IsString()) {
+        p_isolate->ThrowException(v8::Exception::TypeError(
+            v8::String::NewFromUtf8Literal(p_isolate, "The \"filename\" argument must be of type string")));
+        return;
+    }
+
+    WatchConfig config;
+    config.m_path = *v8::String::Utf8Value(p_isolate, args[0]);
+    bool persistent = true;
+    size_t max_queue = WATCH_DEFAULT_MAX_QUEUE;
+    v8::Local<v8::Function> listener;
+    for (int32_t i = 1; i < args.Length(); ++i) {
+        if (args[i]->IsFunction())
+            listener = args[i].As<v8::Function>();
+        else
+            watchParseOptions(p_isolate, p_context, args[i], config, persistent, max_queue);
+    }
+
+    v8::Local<v8::Object> self;
+    if (!GetWatcherClass(p_isolate, p_context)->NewInstance(p_context).ToLocal(&self))
+        return;
+    if (watchStart(p_isolate, self, WATCH_KIND_EMITTER, std::move(config), persistent, max_queue) == 0)
+        return;
+    if (!listener.IsEmpty()) {
+        v8::Local<v8::Value> argv[2] = {v8::String::NewFromUtf8Literal(p_isolate, "change"), listener};
+        (void) callMethod(p_isolate, p_context, self, "on", 2, argv);
+    }
+    args.GetReturnValue().Set(self);
+}
+
+// fsPromises.watch() returns an async iterator of { eventType, filename }. Events that arrive
+// while nobody is waiting are queued up to maxQueue; later ones are dropped.
+void FS::watchPromise(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    v8::Local<v8::Context> p_context = p_isolate->GetCurrentContext();
+    if (args.Length() < 1 || !args[0]->IsString()) {
+        p_isolate->ThrowException(v8::Exception::TypeError(
+            v8::String::NewFromUtf8Literal(p_isolate, "The \"filename\" argument must be of type string")));
+        return;
+    }
+
+    WatchConfig config;
+    config.m_path = *v8::String::Utf8Value(p_isolate, args[0]);
+    bool persistent = true;
+    size_t max_queue = WATCH_DEFAULT_MAX_QUEUE;
+    if (args.Length() > 1)
+        watchParseOptions(p_isolate, p_context, args[1], config, persistent, max_queue);
+
+    v8::Local<v8::Object> iterator;
+    if (!GetWatchIteratorTemplate(p_isolate)->NewInstance(p_context).ToLocal(&iterator))
+        return;
+    if (watchStart(p_isolate, iterator, WATCH_KIND_ITERATOR, std::move(config), persistent, max_queue) == 0)
+        return;
+    args.GetReturnValue().Set(iterator);
+}
+
+static WatcherRecord* findStatWatcher(const std::string& path) {
+    for (auto& [id, up_rec] : watchRegistry()) {
+        if (up_rec->m_kind == WATCH_KIND_STAT && up_rec->m_path == path)
+            return up_rec.get();
+    }
+    return nullptr;
+}
+
+// All watchFile() listeners of one path share a single stat watcher, as in Node.
+void FS::watchFile(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    v8::Local<v8::Context> p_context = p_isolate->GetCurrentContext();
+    if (args.Length() < 2 || !args[0]->IsString() || !args[args.Length() - 1]->IsFunction()) {
+        p_isolate->ThrowException(v8::Exception::TypeError(
+            v8::String::NewFromUtf8Literal(p_isolate, "watchFile requires a filename and a listener")));
+        return;
+    }
+
+    WatchConfig config;
+    config.m_path = *v8::String::Utf8Value(p_isolate, args[0]);
+    config.m_stat = true;
+    config.m_interval_ms = WATCH_FILE_INTERVAL_MS;
+    bool persistent = true;
+    size_t max_queue = WATCH_DEFAULT_MAX_QUEUE;
+    if (args.Length() > 2)
+        watchParseOptions(p_isolate, p_context, args[1], config, persistent, max_queue);
+
+    WatcherRecord* p_rec = findStatWatcher(config.m_path);
+    v8::Local<v8::Object> self;
+    if (p_rec) {
+        self = p_rec->m_self.Get(p_isolate);
+    } else {
+        if (!GetWatcherClass(p_isolate, p_context)->NewInstance(p_context).ToLocal(&self))
+            return;
+        std::string path = config.m_path;
+        int32_t id = watchStart(p_isolate, self, WATCH_KIND_STAT, std::move(config), persistent, max_queue);
+        if (id == 0)
+            return;
+        std::error_code ec;
+        watchRegistry()[id]->m_prev_stats.Reset(p_isolate, FS::createStats(p_isolate, path, ec, true));
+    }
+
+    v8::Local<v8::Value> argv[2] = {v8::String::NewFromUtf8Literal(p_isolate, "change"), args[args.Length() - 1]};
+    (void) callMethod(p_isolate, p_context, self, "on", 2, argv);
+    args.GetReturnValue().Set(self);
+}
+
+void FS::unwatchFile(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    v8::Local<v8::Context> p_context = p_isolate->GetCurrentContext();
+    if (args.Length() < 1 || !args[0]->IsString())
+        return;
+
+    WatcherRecord* p_rec = findStatWatcher(*v8::String::Utf8Value(p_isolate, args[0]));
+    if (!p_rec)
+        return;
+    int32_t id = p_rec->m_id;
+    v8::Local<v8::Object> self = p_rec->m_self.Get(p_isolate);
+    if (args.Length() > 1 && args[1]->IsFunction()) {
+        v8::Local<v8::Value> argv[2] = {v8::String::NewFromUtf8Literal(p_isolate, "change"), args[1]};
+        (void) callMethod(p_isolate, p_context, self, "removeListener", 2, argv);
+        v8::Local<v8::Value> count_argv[1] = {v8::String::NewFromUtf8Literal(p_isolate, "change")};
+        v8::Local<v8::Value> count;
+        if (callMethod(p_isolate, p_context, self, "listenerCount", 1, count_argv).ToLocal(&count) &&
+            count->IntegerValue(p_context).FromMaybe(0) > 0)
+            return;
+    }
+    watchClose(p_isolate, p_context, id);
+}
+
+// --- FileHandle ---
+// fsPromises.open() resolves to a FileHandle that owns its fd. Ops with an explicit position go
+// through pread/pwrite and run concurrently; ops that use or move the file cursor (position
+// omitted, readFile, readLines) run one at a time per handle in submission order. close() waits
+// for in-flight ops. A handle collected while still open has its fd closed with a warning.
+static constexpr size_t FILE_HANDLE_READ_SIZE = 16 * 1024;
+static constexpr size_t FILE_HANDLE_LINES_CHUNK = 64 * 1024;
+
+struct IoSlice {
+    char* p_data = nullptr;
+    size_t m_length = 0;
+};
+
+struct FileHandleOp;
+
+struct FileHandleState {
+    int32_t m_fd = -1;
+    bool m_closing = false;
+    bool m_sequential_busy = false;
+    int32_t m_in_flight = 0;
+    std::deque<FileHandleOp*> m_queue;
+    std::vector<v8::Global<v8::Promise::Resolver>> m_close_waiters;
+    v8::Global<v8::Object> m_self;
+};
+
+// What an op does, so fileHandleRun can hand it to io_uring instead of running m_work on the pool.
+static constexpr uint8_t FILE_OP_POOL = 0;
+static constexpr uint8_t FILE_OP_READ = 1;
+static constexpr uint8_t FILE_OP_WRITE = 2;
+static constexpr uint8_t FILE_OP_SYNC = 3;
+static constexpr uint8_t FILE_OP_STAT = 4;
+static constexpr uint8_t FILE_OP_CLOSE = 5;
+
+struct FileHandleOp : z8::IoRingRequest {
+    FileHandleState* p_state = nullptr;
+    uint8_t m_kind = FILE_OP_POOL;
+    bool m_sequential = false;
+    int32_t m_fd = -1;
+    int64_t m_position = -1;
+    std::vector<IoSlice> m_slices;
+    std::string m_data;
+    // readFile(): the encoding to decode m_data with, empty for a Buffer.
+    std::string m_encoding;
+    StatOptions m_stat_options;
+    StatData m_stat;
+    int64_t m_result = 0;
+    int32_t m_err_no = 0;
+    const char* p_syscall = "read";
+    v8::Global<v8::Object> m_handle;
+    v8::Global<v8::Value> m_keep_alive;
+    v8::Global<v8::Promise::Resolver> m_resolver;
+    // Runs on the pool; returns false and sets m_err_no on failure.
+    std::function<bool(FileHandleOp*)> m_work;
+    // Runs on the main thread after a successful m_work and settles m_resolver.
+    std::function<void(v8::Isolate*, v8::Local<v8::Context>, FileHandleOp*)> m_finish;
+    z8::Task* p_task = nullptr;
+#ifdef __linux__
+    std::vector<iovec> m_iov;
+    StatxBuffer m_statx;
+#endif
+};
+
+static void fileHandleRun(FileHandleState* p_state, FileHandleOp* p_op);
+
+// Moves bytes between fd and the slices. A negative position uses (and advances) the file
+// cursor. Stops at the first short transfer, like preadv/pwritev.
+static int64_t
+fileHandleTransfer(int32_t fd, bool write, std::vector<IoSlice>& slices, int64_t position, int32_t& err_no) {
+    int64_t total = 0;
+#ifndef _WIN32
+    if (slices.size() > 1) {
+        std::vector<iovec> iov(slices.size());
+        for (size_t i = 0; i < slices.size(); ++i)
+            iov[i] = {slices[i].p_data, slices[i].m_length};
+        int32_t count = static_cast<int32_t>(std::min<size_t>(iov.size(), IOV_MAX));
+        ssize_t done = 0;
+        if (position >= 0)
+            done = write ? ::pwritev(fd, iov.data(), count, position) : ::preadv(fd, iov.data(), count, position);
+        else
+            done = write ? ::writev(fd, iov.data(), count) : ::readv(fd, iov.data(), count);
+        if (done < 0)
+            err_no = errno;
+        return done;
+    }
+#endif
+    for (IoSlice& slice : slices) {
+        int64_t done = 0;
+        if (position >= 0) {
+            done = write ? fs_pwrite(fd, slice.p_data, slice.m_length, position + total)
+                         : fs_pread(fd, slice.p_data, slice.m_length, position + total);
+        } else {
+#ifdef _WIN32
+            done = write ? _write(fd, slice.p_data, static_cast<uint32_t>(slice.m_length))
+                         : _read(fd, slice.p_data, static_cast<uint32_t>(slice.m_length));
+#else
+            done = write ? ::write(fd, slice.p_data, slice.m_length) : ::read(fd, slice.p_data, slice.m_length);
+#endif
+        }
+        if (done < 0) {
+            err_no = errno;
+            return -1;
+        }
+        total += done;
+        if (static_cast<size_t>(done) < slice.m_length)
+            break;
+    }
+    return total;
+}
+
+static void fileHandleCloseFd(int32_t fd) {
+#ifdef _WIN32
+    _close(fd);
+#else
+    ::close(fd);
+#endif
+}
+
+static FileHandleState* getFileHandleState(v8::Local<v8::Object> self) {
+    if (self->InternalFieldCount() < 1)
+        return nullptr;
+    v8::Local<v8::Value> field = self->GetInternalField(0).As<v8::Value>();
+    if (!field->IsExternal())
+        return nullptr;
+    return static_cast<FileHandleState*>(field.As<v8::External>()->Value());
+}
+
+static v8::Local<v8::Value> fileHandleError(v8::Isolate* p_isolate, int32_t err_no, const char* p_syscall) {
+    return syscallError(p_isolate, err_no, p_syscall, "");
+}
+
+static void fileHandleWeak(const v8::WeakCallbackInfo<FileHandleState>& data) {
+    FileHandleState* p_state = data.GetParameter();
+    p_state->m_self.Reset();
+    if (p_state->m_fd >= 0) {
+        // Weak callbacks must not run JS, so this is printed without going through process.emitWarning.
+        Process::writeWarning("Warning",
+                              "Closing file descriptor " + std::to_string(p_state->m_fd) + " on garbage collection");
+        fileHandleCloseFd(p_state->m_fd);
+        fdRelease();
+    }
+    delete p_state;
+}
+
+// Starts the close once nothing is in flight; every close() caller gets the same outcome.
+static void fileHandleMaybeClose(v8::Isolate* p_isolate, FileHandleState* p_state) {
+    if (!p_state->m_closing || p_state->m_in_flight > 0 || !p_state->m_queue.empty() || p_state->m_fd < 0)
+        return;
+    auto p_op = new FileHandleOp();
+    p_op->p_syscall = "close";
+    p_op->m_kind = FILE_OP_CLOSE;
+    p_op->m_work = [](FileHandleOp* p_io) {
+#ifdef _WIN32
+        bool ok = _close(p_io->m_fd) == 0;
+#else
+        bool ok = ::close(p_io->m_fd) == 0;
+#endif
+        if (!ok)
+            p_io->m_err_no = errno;
+        return ok;
+    };
+    p_op->p_state = p_state;
+    p_op->m_handle.Reset(p_isolate, p_state->m_self.Get(p_isolate));
+    int32_t fd = p_state->m_fd;
+    // The fd is considered gone from here on, so the GC path cannot close it a second time.
+    p_state->m_fd = -1;
+    p_op->m_fd = fd;
+    fileHandleRun(p_state, p_op);
+}
+
+static void fileHandleSettleClose(v8::Isolate* p_isolate, v8::Local<v8::Context> context, FileHandleState* p_state,
+                                  FileHandleOp* p_op, bool ok) {
+    for (auto& waiter : p_state->m_close_waiters) {
+        v8::Local<v8::Promise::Resolver> resolver = waiter.Get(p_isolate);
+        if (ok)
+            resolver->Resolve(context, v8::Undefined(p_isolate)).Check();
+        else
+            resolver->Reject(context, fileHandleError(p_isolate, p_op->m_err_no, "close")).Check();
+    }
+    p_state->m_close_waiters.clear();
+}
+
+static void fileHandleDone(v8::Isolate* p_isolate, v8::Local<v8::Context> context, Task* p_task) {
+    auto p_op = static_cast<FileHandleOp*>(p_task->p_data);
+    FileHandleState* p_state = p_op->p_state;
+    bool ok = p_task->m_error_code == 0;
+    if (p_op->m_resolver.IsEmpty()) {
+        fdRelease();
+        fileHandleSettleClose(p_isolate, context, p_state, p_op, ok);
+    } else if (ok) {
+        p_op->m_finish(p_isolate, context, p_op);
+    } else {
+        p_op->m_resolver.Get(p_isolate)->Reject(context, fileHandleError(p_isolate, p_op->m_err_no, p_op->p_syscall))
+            .Check();
+    }
+
+    p_state->m_in_flight--;
+    if (p_op->m_sequential) {
+        p_state->m_sequential_busy = false;
+        if (!p_state->m_queue.empty()) {
+            FileHandleOp* p_next = p_state->m_queue.front();
+            p_state->m_queue.pop_front();
+            p_state->m_sequential_busy = true;
+            fileHandleRun(p_state, p_next);
+        }
+    }
+    // Close before dropping p_op, whose handle reference keeps p_state alive.
+    fileHandleMaybeClose(p_isolate, p_state);
+    delete p_op;
+}
+
+#ifdef __linux__
+static void fileHandleRingDone(z8::IoRingRequest* p_req, int32_t result) {
+    auto p_op = static_cast<FileHandleOp*>(p_req);
+    if (result < 0) {
+        p_op->m_err_no = -result;
+        p_op->p_task->m_error_code = 1;
+    } else {
+        p_op->m_result = result;
+        if (p_op->m_kind == FILE_OP_STAT)
+            statFillFromStatx(p_op->m_statx, p_op->m_stat);
+    }
+    TaskQueue::getInstance().enqueue(p_op->p_task);
+}
+
+// Queues p_op on the ring when it maps to a single SQE. Returns false to use the pool.
+static bool fileHandleRingSubmit(FileHandleOp* p_op) {
+    static constexpr uint8_t OPCODES[] = {
+        IORING_OP_NOP, IORING_OP_READ, IORING_OP_WRITE, IORING_OP_FSYNC, IORING_OP_STATX, IORING_OP_CLOSE};
+    if (p_op->m_kind == FILE_OP_POOL)
+        return false;
+    bool vectored = p_op->m_slices.size() > 1;
+    uint8_t opcode = OPCODES[p_op->m_kind];
+    if (vectored)
+        opcode = p_op->m_kind == FILE_OP_READ ? IORING_OP_READV : IORING_OP_WRITEV;
+    io_uring_sqe* p_sqe = z8::IoRing::getInstance().acquire(p_op, opcode);
+    if (!p_sqe)
+        return false;
+    p_sqe->fd = p_op->m_fd;
+    if (p_op->m_kind == FILE_OP_READ || p_op->m_kind == FILE_OP_WRITE) {
+        // An offset of -1 makes the kernel use and advance the file position.
+        p_sqe->off = static_cast<uint64_t>(p_op->m_position);
+        if (vectored) {
+            p_op->m_iov.resize(std::min<size_t>(p_op->m_slices.size(), IOV_MAX));
+            for (size_t i = 0; i < p_op->m_iov.size(); ++i)
+                p_op->m_iov[i] = {p_op->m_slices[i].p_data, p_op->m_slices[i].m_length};
+            p_sqe->addr = reinterpret_cast<uint64_t>(p_op->m_iov.data());
+            p_sqe->len = static_cast<uint32_t>(p_op->m_iov.size());
+        } else if (!p_op->m_slices.empty()) {
+            p_sqe->addr = reinterpret_cast<uint64_t>(p_op->m_slices[0].p_data);
+            p_sqe->len = static_cast<uint32_t>(std::min<size_t>(p_op->m_slices[0].m_length, INT32_MAX));
+        }
+    } else if (p_op->m_kind == FILE_OP_STAT) {
+        p_sqe->addr = reinterpret_cast<uint64_t>("");
+        p_sqe->statx_flags = AT_EMPTY_PATH | AT_STATX_SYNC_AS_STAT;
+        p_sqe->len = STATX_BASIC_STATS | STATX_BTIME;
+        p_sqe->addr2 = reinterpret_cast<uint64_t>(&p_op->m_statx);
+    }
+    p_op->p_complete = fileHandleRingDone;
+    return true;
+}
+#endif
+
+static void fileHandleRun(FileHandleState* p_state, FileHandleOp* p_op) {
+    p_state->m_in_flight++;
+    if (p_op->m_fd < 0)
+        p_op->m_fd = p_state->m_fd;
+    z8::Task* p_task = new z8::Task();
+    p_task->m_is_promise = true;
+    p_task->p_data = p_op;
+    p_task->m_error_code = 0;
+    p_task->m_runner = fileHandleDone;
+    p_op->p_task = p_task;
+#ifdef __linux__
+    if (fileHandleRingSubmit(p_op))
+        return;
+#endif
+    ThreadPool::getInstance().enqueue([p_task, p_op]() {
+        p_task->m_error_code = p_op->m_work(p_op) ? 0 : 1;
+        TaskQueue::getInstance().enqueue(p_task);
+    });
+}
+
+// Queues p_op behind earlier cursor-based ops when it is one itself; positional ops go straight
+// to the pool. Returns the op's promise.
+static v8::Local<v8::Promise> fileHandleSubmit(v8::Isolate* p_isolate,
+                                               v8::Local<v8::Context> context,
+                                               v8::Local<v8::Object> self,
+                                               FileHandleOp* p_op) {
+    v8::Local<v8::Promise::Resolver> resolver = v8::Promise::Resolver::New(context).ToLocalChecked();
+    FileHandleState* p_state = getFileHandleState(self);
+    if (!p_state || p_state->m_closing || p_state->m_fd < 0) {
+        resolver->Reject(context, fileHandleError(p_isolate, EBADF, p_op->p_syscall)).Check();
+        delete p_op;
+        return resolver->GetPromise();
+    }
+    p_op->p_state = p_state;
+    p_op->m_resolver.Reset(p_isolate, resolver);
+    p_op->m_handle.Reset(p_isolate, self);
+    if (p_op->m_sequential && p_state->m_sequential_busy) {
+        p_state->m_queue.push_back(p_op);
+    } else {
+        if (p_op->m_sequential)
+            p_state->m_sequential_busy = true;
+        fileHandleRun(p_state, p_op);
+    }
+    return resolver->GetPromise();
+}
+
+static int64_t fileHandlePosition(v8::Local<v8::Context> context, v8::Local<v8::Value> value) {
+    if (!value->IsNumber())
+        return -1;
+    return static_cast<int64_t>(value->NumberValue(context).FromMaybe(-1));
+}
+
+static bool getOption(v8::Isolate* p_isolate,
+                      v8::Local<v8::Context> context,
+                      v8::Local<v8::Object> options,
+                      const char* p_name,
+                      v8::Local<v8::Value>* p_out) {
+    return options->Get(context, v8::String::NewFromUtf8(p_isolate, p_name).ToLocalChecked()).ToLocal(p_out) &&
+           !(*p_out)->IsUndefined();
+}
+
+static IoSlice sliceOf(v8::Local<v8::ArrayBufferView> view, size_t offset, size_t length) {
+    IoSlice slice;
+    slice.p_data = static_cast<char*>(view->Buffer()->GetBackingStore()->Data()) + view->ByteOffset() + offset;
+    slice.m_length = length;
+    return slice;
+}
+
+static v8::Local<v8::Object>
+ioResult(v8::Isolate* p_isolate, v8::Local<v8::Context> context, const char* p_count, int64_t count, const char* p_key,
+         v8::Local<v8::Value> value) {
+    v8::Local<v8::Object> result = v8::Object::New(p_isolate);
+    (void) result->CreateDataProperty(context,
+                                      v8::String::NewFromUtf8(p_isolate, p_count).ToLocalChecked(),
+                                      v8::Number::New(p_isolate, static_cast<double>(count)));
+    (void) result->CreateDataProperty(context, v8::String::NewFromUtf8(p_isolate, p_key).ToLocalChecked(), value);
+    return result;
+}
+
+// Node's ERR_OUT_OF_RANGE RangeError, e.g. 'The value of "offset" is out of range. It must be
+// >= 0 && <= 8. Received 9'.
+static void throwOutOfRange(v8::Isolate* p_isolate, const char* p_name, const std::string& range, double received) {
+    v8::Local<v8::Context> context = p_isolate->GetCurrentContext();
+    v8::String::Utf8Value received_text(p_isolate, v8::Number::New(p_isolate, received));
+    std::string msg = std::string("The value of \"") + p_name + "\" is out of range. It must be " + range +
+                      ". Received " + (*received_text ? *received_text : "");
+    v8::Local<v8::Object> error =
+        v8::Exception::RangeError(v8::String::NewFromUtf8(p_isolate, msg.c_str()).ToLocalChecked()).As<v8::Object>();
+    error->Set(context, v8::String::NewFromUtf8Literal(p_isolate, "code"),
+               v8::String::NewFromUtf8Literal(p_isolate, "ERR_OUT_OF_RANGE"))
+        .Check();
+    p_isolate->ThrowException(error);
+}
+
+// Shared by read() and write(): (buffer[, offset[, length[, position]]]), (buffer, options)
+// and ({ buffer, offset, length, position }). Returns false with *p_view empty when there is
+// no buffer, or with an ERR_OUT_OF_RANGE thrown when offset or length does not fit it.
+static bool fileHandleParseBufferArgs(const v8::FunctionCallbackInfo<v8::Value>& args,
+                                      bool allocate,
+                                      v8::Local<v8::ArrayBufferView>* p_view,
+                                      size_t* p_offset,
+                                      size_t* p_length,
+                                      int64_t* p_position) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    v8::Local<v8::Context> context = p_isolate->GetCurrentContext();
+    v8::Local<v8::Value> val;
+    v8::Local<v8::Object> options;
+    int32_t next = 0;
+    if (args.Length() > 0 && args[0]->IsArrayBufferView()) {
+        *p_view = args[0].As<v8::ArrayBufferView>();
+        next = 1;
+        if (args.Length() > 1 && args[1]->IsObject() && !args[1]->IsNull())
+            options = args[1].As<v8::Object>();
+    } else if (args.Length() > 0 && args[0]->IsObject()) {
+        options = args[0].As<v8::Object>();
+        if (getOption(p_isolate, context, options, "buffer", &val) && val->IsArrayBufferView())
+            *p_view = val.As<v8::ArrayBufferView>();
+    }
+    if (p_view->IsEmpty()) {
+        if (!allocate)
+            return false;
+        *p_view = Buffer::createBuffer(p_isolate, FILE_HANDLE_READ_SIZE);
+    }
+
+    size_t size = (*p_view)->ByteLength();
+    double offset = 0;
+    double length = 0;
+    bool has_length = false;
+    *p_position = -1;
+    if (!options.IsEmpty()) {
+        if (getOption(p_isolate, context, options, "offset", &val))
+            offset = val->NumberValue(context).FromMaybe(0);
+        if (getOption(p_isolate, context, options, "length", &val)) {
+            length = val->NumberValue(context).FromMaybe(0);
+            has_length = true;
+        }
+        if (getOption(p_isolate, context, options, "position", &val))
+            *p_position = fileHandlePosition(context, val);
+    } else {
+        if (args.Length() > next && args[next]->IsNumber())
+            offset = args[next]->NumberValue(context).FromMaybe(0);
+        if (args.Length() > next + 1 && args[next + 1]->IsNumber()) {
+            length = args[next + 1]->NumberValue(context).FromMaybe(0);
+            has_length = true;
+        }
+        if (args.Length() > next + 2)
+            *p_position = fileHandlePosition(context, args[next + 2]);
+    }
+    // Like Node, a range that does not fit the buffer is rejected rather than clamped.
+    if (offset != std::floor(offset)) {
+        throwOutOfRange(p_isolate, "offset", "an integer", offset);
+        return false;
+    }
+    if (offset < 0 || offset > static_cast<double>(size)) {
+        throwOutOfRange(p_isolate, "offset", ">= 0 && <= " + std::to_string(size), offset);
+        return false;
+    }
+    *p_offset = static_cast<size_t>(offset);
+    if (!has_length) {
+        *p_length = size - *p_offset;
+        return true;
+    }
+    if (length != std::floor(length)) {
+        throwOutOfRange(p_isolate, "length", "an integer", length);
+        return false;
+    }
+    if (length < 0 || length > static_cast<double>(size - *p_offset)) {
+        throwOutOfRange(p_isolate, "length", ">= 0 && <= " + std::to_string(size - *p_offset), length);
+        return false;
+    }
+    *p_length = static_cast<size_t>(length);
+    return true;
+}
+
+static void FileHandleRead(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    v8::Local<v8::Context> p_context = p_isolate->GetCurrentContext();
+    v8::Local<v8::ArrayBufferView> view;
+    size_t offset = 0;
+    size_t length = 0;
+    int64_t position = -1;
+    if (!fileHandleParseBufferArgs(args, true, &view, &offset, &length, &position))
+        return;
+
+    auto p_op = new FileHandleOp();
+    p_op->m_kind = FILE_OP_READ;
+    p_op->m_position = position;
+    p_op->m_sequential = position < 0;
+    p_op->m_slices.push_back(sliceOf(view, offset, length));
+    p_op->m_keep_alive.Reset(p_isolate, view);
+    p_op->m_work = [](FileHandleOp* p_io) {
+        p_io->m_result = fileHandleTransfer(p_io->m_fd, false, p_io->m_slices, p_io->m_position, p_io->m_err_no);
+        return p_io->m_result >= 0;
+    };
+    p_op->m_finish = [](v8::Isolate* p_isolate, v8::Local<v8::Context> context, FileHandleOp* p_io) {
+        v8::Local<v8::Object> result =
+            ioResult(p_isolate, context, "bytesRead", p_io->m_result, "buffer", p_io->m_keep_alive.Get(p_isolate));
+        p_io->m_resolver.Get(p_isolate)->Resolve(context, result).Check();
+    };
+    args.GetReturnValue().Set(fileHandleSubmit(p_isolate, p_context, args.This(), p_op));
+}
+
+static void FileHandleWrite(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    v8::Local<v8::Context> p_context = p_isolate->GetCurrentContext();
+    auto p_op = new FileHandleOp();
+    p_op->p_syscall = "write";
+    p_op->m_kind = FILE_OP_WRITE;
+
+    if (args.Length() > 0 && args[0]->IsString()) {
+        // write(string[, position[, encoding]]): the bytes are copied, so the op owns them.
+        std::string encoding = "utf8";
+        if (args.Length() > 2 && args[2]->IsString())
+            encoding = StringDecoder::normalizeEncoding(*v8::String::Utf8Value(p_isolate, args[2]));
+        Buffer::encodeString(p_isolate, args[0].As<v8::String>(), encoding, p_op->m_data);
+        p_op->m_position = args.Length() > 1 ? fileHandlePosition(p_context, args[1]) : -1;
+        p_op->m_slices.push_back({p_op->m_data.data(), p_op->m_data.size()});
+        p_op->m_keep_alive.Reset(p_isolate, args[0]);
+    } else {
+        v8::Local<v8::ArrayBufferView> view;
+        size_t offset = 0;
+        size_t length = 0;
+        if (!fileHandleParseBufferArgs(args, false, &view, &offset, &length, &p_op->m_position)) {
+            delete p_op;
+            if (view.IsEmpty()) {
+                p_isolate->ThrowException(v8::Exception::TypeError(v8::String::NewFromUtf8Literal(
+                    p_isolate, "The \"buffer\" argument must be a string or a Buffer")));
+            }
+            return;
+        }
+        p_op->m_slices.push_back(sliceOf(view, offset, length));
+        p_op->m_keep_alive.Reset(p_isolate, view);
+    }
+    p_op->m_sequential = p_op->m_position < 0;
+    p_op->m_work = [](FileHandleOp* p_io) {
+        p_io->m_result = fileHandleTransfer(p_io->m_fd, true, p_io->m_slices, p_io->m_position, p_io->m_err_no);
+        return p_io->m_result >= 0;
+    };
+    p_op->m_finish = [](v8::Isolate* p_isolate, v8::Local<v8::Context> context, FileHandleOp* p_io) {
+        v8::Local<v8::Object> result =
+            ioResult(p_isolate, context, "bytesWritten", p_io->m_result, "buffer", p_io->m_keep_alive.Get(p_isolate));
+        p_io->m_resolver.Get(p_isolate)->Resolve(context, result).Check();
+    };
+    args.GetReturnValue().Set(fileHandleSubmit(p_isolate, p_context, args.This(), p_op));
+}
+
+static void fileHandleVector(const v8::FunctionCallbackInfo<v8::Value>& args, bool write) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    v8::Local<v8::Context> p_context = p_isolate->GetCurrentContext();
+    if (args.Length() < 1 || !args[0]->IsArray()) {
+        p_isolate->ThrowException(v8::Exception::TypeError(v8::String::NewFromUtf8Literal(
+            p_isolate, "The \"buffers\" argument must be an array of ArrayBufferViews")));
+        return;
+    }
+    v8::Local<v8::Array> buffers = args[0].As<v8::Array>();
+    auto p_op = new FileHandleOp();
+    p_op->p_syscall = write ? "writev" : "readv";
+    p_op->m_kind = write ? FILE_OP_WRITE : FILE_OP_READ;
+    for (uint32_t i = 0; i < buffers->Length(); ++i) {
+        v8::Local<v8::Value> val;
+        if (buffers->Get(p_context, i).ToLocal(&val) && val->IsArrayBufferView()) {
+            v8::Local<v8::ArrayBufferView> view = val.As<v8::ArrayBufferView>();
+            p_op->m_slices.push_back(sliceOf(view, 0, view->ByteLength()));
+        }
+    }
+    p_op->m_position = args.Length() > 1 ? fileHandlePosition(p_context, args[1]) : -1;
+    p_op->m_sequential = p_op->m_position < 0;
+    p_op->m_keep_alive.Reset(p_isolate, buffers);
+    if (write) {
+        p_op->m_work = [](FileHandleOp* p_io) {
+            p_io->m_result = fileHandleTransfer(p_io->m_fd, true, p_io->m_slices, p_io->m_position, p_io->m_err_no);
+            return p_io->m_result >= 0;
+        };
+    } else {
+        p_op->m_work = [](FileHandleOp* p_io) {
+            p_io->m_result = fileHandleTransfer(p_io->m_fd, false, p_io->m_slices, p_io->m_position, p_io->m_err_no);
+            return p_io->m_result >= 0;
+        };
+    }
+    p_op->m_finish = [](v8::Isolate* p_isolate, v8::Local<v8::Context> context, FileHandleOp* p_io) {
+        const char* p_count = std::strcmp(p_io->p_syscall, "writev") == 0 ? "bytesWritten" : "bytesRead";
+        v8::Local<v8::Object> result =
+            ioResult(p_isolate, context, p_count, p_io->m_result, "buffers", p_io->m_keep_alive.Get(p_isolate));
+        p_io->m_resolver.Get(p_isolate)->Resolve(context, result).Check();
+    };
+    args.GetReturnValue().Set(fileHandleSubmit(p_isolate, p_context, args.This(), p_op));
+}
+
+static void FileHandleReadv(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    fileHandleVector(args, false);
+}
+
+static void FileHandleWritev(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    fileHandleVector(args, true);
+}
+
+// The encoding of an (encoding) or ({ encoding }) argument, normalized; empty when the result
+// should stay a Buffer or the name is not an encoding.
+static std::string readEncodingArg(v8::Isolate* p_isolate, v8::Local<v8::Context> context, v8::Local<v8::Value> arg) {
+    v8::Local<v8::Value> encoding = arg;
+    if (arg->IsObject() && !arg->IsNull() &&
+        !arg.As<v8::Object>()->Get(context, v8::String::NewFromUtf8Literal(p_isolate, "encoding")).ToLocal(&encoding))
+        return "";
+    if (!encoding->IsString())
+        return "";
+    return StringDecoder::normalizeEncoding(*v8::String::Utf8Value(p_isolate, encoding));
+}
+
+static void FileHandleReadFile(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    v8::Local<v8::Context> p_context = p_isolate->GetCurrentContext();
+    auto p_op = new FileHandleOp();
+    p_op->m_sequential = true;
+    if (args.Length() > 0)
+        p_op->m_encoding = readEncodingArg(p_isolate, p_context, args[0]);
+    p_op->m_work = [](FileHandleOp* p_io) {
+        // Reads from the current position to EOF, like Node's filehandle.readFile().
+        for (;;) {
+            size_t used = p_io->m_data.size();
+            p_io->m_data.resize(used + FILE_HANDLE_LINES_CHUNK);
+            std::vector<IoSlice> slices = {{p_io->m_data.data() + used, FILE_HANDLE_LINES_CHUNK}};
+            int64_t got = fileHandleTransfer(p_io->m_fd, false, slices, -1, p_io->m_err_no);
+            p_io->m_data.resize(used + static_cast<size_t>(std::max<int64_t>(got, 0)));
+            if (got < 0)
+                return false;
+            if (got == 0)
+                return true;
+        }
+    };
+    p_op->m_finish = [](v8::Isolate* p_isolate, v8::Local<v8::Context> context, FileHandleOp* p_io) {
+        v8::Local<v8::Value> result;
+        if (!p_io->m_encoding.empty()) {
+            v8::Local<v8::String> text;
+            if (!Buffer::decodeBytes(p_isolate, p_io->m_encoding, p_io->m_data.data(), p_io->m_data.size())
+                     .ToLocal(&text)) {
+                p_io->m_resolver.Get(p_isolate)->Reject(context, Buffer::stringTooLongError(p_isolate)).Check();
+                return;
+            }
+            result = text;
+        } else {
+            result = Buffer::copyBuffer(p_isolate, p_io->m_data.data(), p_io->m_data.size());
+        }
+        p_io->m_resolver.Get(p_isolate)->Resolve(context, result).Check();
+    };
+    args.GetReturnValue().Set(fileHandleSubmit(p_isolate, p_context, args.This(), p_op));
+}
+
+static void FileHandleStat(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    v8::Local<v8::Context> p_context = p_isolate->GetCurrentContext();
+    auto p_op = new FileHandleOp();
+    p_op->p_syscall = "fstat";
+    p_op->m_kind = FILE_OP_STAT;
+    p_op->m_stat_options = statParseOptions(p_isolate, p_context, args, 0);
+    p_op->m_work = [](FileHandleOp* p_io) { return statFd(p_io->m_fd, p_io->m_stat, p_io->m_err_no); };
+    p_op->m_finish = [](v8::Isolate* p_isolate, v8::Local<v8::Context> context, FileHandleOp* p_io) {
+        v8::Local<v8::Object> stats = newStats(p_isolate, context, p_io->m_stat, p_io->m_stat_options.m_bigint);
+        p_io->m_resolver.Get(p_isolate)->Resolve(context, stats).Check();
+    };
+    args.GetReturnValue().Set(fileHandleSubmit(p_isolate, p_context, args.This(), p_op));
+}
+
+static void FileHandleSync(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    v8::Local<v8::Context> p_context = p_isolate->GetCurrentContext();
+    auto p_op = new FileHandleOp();
+    p_op->p_syscall = "fsync";
+    p_op->m_kind = FILE_OP_SYNC;
+    p_op->m_work = [](FileHandleOp* p_io) {
+#ifdef _WIN32
+        bool ok = FlushFileBuffers(reinterpret_cast<HANDLE>(_get_osfhandle(p_io->m_fd))) != 0;
+        if (!ok)
+            p_io->m_err_no = EIO;
+#else
+        bool ok = ::fsync(p_io->m_fd) == 0;
+        if (!ok)
+            p_io->m_err_no = errno;
+#endif
+        return ok;
+    };
+    p_op->m_finish = [](v8::Isolate* p_isolate, v8::Local<v8::Context> context, FileHandleOp* p_io) {
+        p_io->m_resolver.Get(p_isolate)->Resolve(context, v8::Undefined(p_isolate)).Check();
+    };
+    args.GetReturnValue().Set(fileHandleSubmit(p_isolate, p_context, args.This(), p_op));
+}
+
+static void FileHandleClose(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    v8::Local<v8::Context> p_context = p_isolate->GetCurrentContext();
+    v8::Local<v8::Promise::Resolver> resolver = v8::Promise::Resolver::New(p_context).ToLocalChecked();
+    args.GetReturnValue().Set(resolver->GetPromise());
+
+    FileHandleState* p_state = getFileHandleState(args.This());
+    if (!p_state || (p_state->m_fd < 0 && p_state->m_close_waiters.empty())) {
+        // Already closed: closing again is a no-op, as in Node.
+        resolver->Resolve(p_context, v8::Undefined(p_isolate)).Check();
+        return;
+    }
+    p_state->m_close_waiters.emplace_back(p_isolate, resolver);
+    p_state->m_closing = true;
+    fileHandleMaybeClose(p_isolate, p_state);
+}
+
+static void FileHandleFd(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    FileHandleState* p_state = getFileHandleState(args.This());
+    args.GetReturnValue().Set(p_state ? p_state->m_fd : -1);
+}
+
+// readLines() state: bytes read past the last returned line, plus next() calls waiting for one.
+struct LinesState {
+    v8::Global<v8::Object> m_handle;
+    std::string m_pending;
+    size_t m_scan_from = 0;
+    bool m_eof = false;
+    bool m_reading = false;
+    bool m_done = false;
+    std::deque<v8::Global<v8::Promise::Resolver>> m_waiters;
+    v8::Global<v8::Object> m_self;
+};
+
+static LinesState* getLinesState(v8::Local<v8::Object> self) {
+    if (self->InternalFieldCount() < 1)
+        return nullptr;
+    v8::Local<v8::Value> field = self->GetInternalField(0).As<v8::Value>();
+    return field->IsExternal() ? static_cast<LinesState*>(field.As<v8::External>()->Value()) : nullptr;
+}
+
+static void linesPump(v8::Isolate* p_isolate, v8::Local<v8::Context> context, LinesState* p_lines);
+
+static void linesRead(v8::Isolate* p_isolate, v8::Local<v8::Context> context, LinesState* p_lines) {
+    auto p_op = new FileHandleOp();
+    p_op->m_kind = FILE_OP_READ;
+    p_op->m_sequential = true;
+    p_op->m_data.resize(FILE_HANDLE_LINES_CHUNK);
+    p_op->m_slices.push_back({p_op->m_data.data(), p_op->m_data.size()});
+    p_op->m_keep_alive.Reset(p_isolate, p_lines->m_self.Get(p_isolate));
+    p_op->m_work = [](FileHandleOp* p_io) {
+        p_io->m_result = fileHandleTransfer(p_io->m_fd, false, p_io->m_slices, -1, p_io->m_err_no);
+        return p_io->m_result >= 0;
+    };
+    p_op->m_finish = [](v8::Isolate* p_isolate, v8::Local<v8::Context> context, FileHandleOp* p_io) {
+        v8::Local<v8::Object> iterator = p_io->m_keep_alive.Get(p_isolate).As<v8::Object>();
+        LinesState* p_lines = getLinesState(iterator);
+        p_lines->m_reading = false;
+        if (p_io->m_result == 0)
+            p_lines->m_eof = true;
+        else
+            p_lines->m_pending.append(p_io->m_data.data(), static_cast<size_t>(p_io->m_result));
+        p_io->m_resolver.Get(p_isolate)->Resolve(context, v8::Undefined(p_isolate)).Check();
+        linesPump(p_isolate, context, p_lines);
+    };
+
+    v8::Local<v8::Promise> promise = fileHandleSubmit(p_isolate, context, p_lines->m_handle.Get(p_isolate), p_op);
+    p_lines->m_reading = true;
+    // A failed read (or a closed handle) fails every waiting next().
+    v8::Local<v8::Function> on_error =
+        v8::Function::New(
+            context,
+            [](const v8::FunctionCallbackInfo<v8::Value>& args) {
+                v8::Isolate* p_isolate = args.GetIsolate();
+                v8::Local<v8::Context> context = p_isolate->GetCurrentContext();
+                LinesState* p_lines = getLinesState(args.Data().As<v8::Object>());
+                p_lines->m_reading = false;
+                p_lines->m_done = true;
+                for (auto& waiter : p_lines->m_waiters)
+                    waiter.Get(p_isolate)->Reject(context, args[0]).Check();
+                p_lines->m_waiters.clear();
+            },
+            p_lines->m_self.Get(p_isolate))
+            .ToLocalChecked();
+    (void) promise->Catch(context, on_error);
+}
+
+static void linesPump(v8::Isolate* p_isolate, v8::Local<v8::Context> context, LinesState* p_lines) {
+    while (!p_lines->m_waiters.empty()) {
+        v8::Local<v8::Value> value;
+        bool done = false;
+        size_t newline = p_lines->m_pending.find('\n', p_lines->m_scan_from);
+        if (p_lines->m_done) {
+            done = true;
+        } else if (newline != std::string::npos) {
+            size_t end = newline > 0 && p_lines->m_pending[newline - 1] == '\r' ? newline - 1 : newline;
+            value = newUtf8String(p_isolate, p_lines->m_pending.substr(0, end));
+            p_lines->m_pending.erase(0, newline + 1);
+            p_lines->m_scan_from = 0;
+        } else if (p_lines->m_eof) {
+            if (p_lines->m_pending.empty()) {
+                done = true;
+                p_lines->m_done = true;
+            } else {
+                value = newUtf8String(p_isolate, p_lines->m_pending);
+                p_lines->m_pending.clear();
+            }
+        } else {
+            p_lines->m_scan_from = p_lines->m_pending.size();
+            if (!p_lines->m_reading)
+                linesRead(p_isolate, context, p_lines);
+            return;
+        }
+        v8::Local<v8::Promise::Resolver> resolver = p_lines->m_waiters.front().Get(p_isolate);
+        p_lines->m_waiters.pop_front();
+        if (value.IsEmpty())
+            value = v8::Undefined(p_isolate);
+        resolver->Resolve(context, makeIterResult(p_isolate, context, value, done)).Check();
+    }
+}
+
+static void LinesIteratorNext(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    v8::Local<v8::Context> p_context = p_isolate->GetCurrentContext();
+    v8::Local<v8::Promise::Resolver> resolver = v8::Promise::Resolver::New(p_context).ToLocalChecked();
+    args.GetReturnValue().Set(resolver->GetPromise());
+    LinesState* p_lines = getLinesState(args.This());
+    if (!p_lines) {
+        resolver->Resolve(p_context, makeIterResult(p_isolate, p_context, v8::Undefined(p_isolate), true)).Check();
+        return;
+    }
+    p_lines->m_waiters.emplace_back(p_isolate, resolver);
+    linesPump(p_isolate, p_context, p_lines);
+}
+
+static void LinesIteratorReturn(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    v8::Local<v8::Context> p_context = p_isolate->GetCurrentContext();
+    LinesState* p_lines = getLinesState(args.This());
+    if (p_lines) {
+        p_lines->m_done = true;
+        p_lines->m_pending.clear();
+        linesPump(p_isolate, p_context, p_lines);
+    }
+    v8::Local<v8::Promise::Resolver> resolver = v8::Promise::Resolver::New(p_context).ToLocalChecked();
+    resolver->Resolve(p_context, makeIterResult(p_isolate, p_context, v8::Undefined(p_isolate), true)).Check();
+    args.GetReturnValue().Set(resolver->GetPromise());
+}
+
+static void FileHandleReadLines(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    v8::Local<v8::Context> p_context = p_isolate->GetCurrentContext();
+    static v8::Persistent<v8::ObjectTemplate> s_tmpl;
+    if (s_tmpl.IsEmpty()) {
+        v8::Local<v8::ObjectTemplate> local_tmpl = v8::ObjectTemplate::New(p_isolate);
+        local_tmpl->SetInternalFieldCount(1);
+        local_tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "next"),
+                        v8::FunctionTemplate::New(p_isolate, LinesIteratorNext));
+        local_tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "return"),
+                        v8::FunctionTemplate::New(p_isolate, LinesIteratorReturn));
+        local_tmpl->Set(v8::Symbol::GetAsyncIterator(p_isolate), v8::FunctionTemplate::New(p_isolate, IteratorSelf));
+        s_tmpl.Reset(p_isolate, local_tmpl);
+    }
+
+    v8::Local<v8::Object> iterator;
+    if (!s_tmpl.Get(p_isolate)->NewInstance(p_context).ToLocal(&iterator))
+        return;
+    auto p_lines = new LinesState();
+    p_lines->m_handle.Reset(p_isolate, args.This());
+    p_lines->m_self.Reset(p_isolate, iterator);
+    p_lines->m_self.SetWeak(
+        p_lines,
+        [](const v8::WeakCallbackInfo<LinesState>& data) {
+            LinesState* p_lines = data.GetParameter();
+            p_lines->m_self.Reset();
+            delete p_lines;
+        },
+        v8::WeakCallbackType::kParameter);
+    iterator->SetInternalField(0, v8::External::New(p_isolate, p_lines));
+    args.GetReturnValue().Set(iterator);
+}
+
+static v8::Local<v8::Function> GetFileHandleClass(v8::Isolate* p_isolate, v8::Local<v8::Context> context) {
+    static v8::Persistent<v8::FunctionTemplate> s_tmpl;
+    bool created = s_tmpl.IsEmpty();
+    if (created) {
+        v8::Local<v8::FunctionTemplate> tmpl = v8::FunctionTemplate::New(p_isolate);
+        tmpl->SetClassName(v8::String::NewFromUtf8Literal(p_isolate, "FileHandle"));
+        tmpl->InstanceTemplate()->SetInternalFieldCount(1);
+        v8::Local<v8::ObjectTemplate> proto = tmpl->PrototypeTemplate();
+        proto->SetAccessorProperty(v8::String::NewFromUtf8Literal(p_isolate, "fd"),
+                                   v8::FunctionTemplate::New(p_isolate, FileHandleFd));
+        const std::pair<const char*, v8::FunctionCallback> methods[] = {
+            {"read", FileHandleRead},
+            {"write", FileHandleWrite},
+            {"readv", FileHandleReadv},
+            {"writev", FileHandleWritev},
+            {"readFile", FileHandleReadFile},
+            {"readLines", FileHandleReadLines},
+            {"stat", FileHandleStat},
+            {"sync", FileHandleSync},
+            {"close", FileHandleClose},
+        };
+        for (const auto& [p_name, callback] : methods) {
+            proto->Set(v8::String::NewFromUtf8(p_isolate, p_name).ToLocalChecked(),
+                       v8::FunctionTemplate::New(p_isolate, callback));
+        }
+        s_tmpl.Reset(p_isolate, tmpl);
+    }
+    v8::Local<v8::Function> ctor = s_tmpl.Get(p_isolate)->GetFunction(context).ToLocalChecked();
+    if (created) {
+        // Symbol.asyncDispose has no v8::Symbol accessor yet, so it is looked up on the global.
+        v8::Local<v8::Value> symbol_ctor;
+        v8::Local<v8::Value> dispose;
+        v8::Local<v8::Value> proto;
+        v8::Local<v8::String> symbol_name = v8::String::NewFromUtf8Literal(p_isolate, "Symbol");
+        if (context->Global()->Get(context, symbol_name).ToLocal(&symbol_ctor) && symbol_ctor->IsObject() &&
+            symbol_ctor.As<v8::Object>()
+                ->Get(context, v8::String::NewFromUtf8Literal(p_isolate, "asyncDispose"))
+                .ToLocal(&dispose) &&
+            dispose->IsSymbol() &&
+            ctor->Get(context, v8::String::NewFromUtf8Literal(p_isolate, "prototype")).ToLocal(&proto) &&
+            proto->IsObject()) {
+            (void) proto.As<v8::Object>()->Set(
+                context, dispose, v8::Function::New(context, FileHandleClose).ToLocalChecked());
+        }
+    }
+    return ctor;
+}
+
+static v8::Local<v8::Object> newFileHandle(v8::Isolate* p_isolate, v8::Local<v8::Context> context, int32_t fd) {
+    v8::Local<v8::Object> self = GetFileHandleClass(p_isolate, context)->NewInstance(context).ToLocalChecked();
+    auto p_state = new FileHandleState();
+    p_state->m_fd = fd;
+    p_state->m_self.Reset(p_isolate, self);
+    p_state->m_self.SetWeak(p_state, fileHandleWeak, v8::WeakCallbackType::kParameter);
+    self->SetInternalField(0, v8::External::New(p_isolate, p_state));
+    return self;
+}
+
+static void openStart(Task* p_task, OpenCtx* p_ctx);
+
+void FS::openPromise(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    v8::Local<v8::Context> p_context = p_isolate->GetCurrentContext();
+    if (args.Length() < 1 || !args[0]->IsString())
+        return;
+    v8::Local<v8::Promise::Resolver> p_resolver;
+    if (!v8::Promise::Resolver::New(p_context).ToLocal(&p_resolver))
+        return;
+    args.GetReturnValue().Set(p_resolver->GetPromise());
+    v8::String::Utf8Value path(p_isolate, args[0]);
+    auto p_ctx = new OpenCtx();
+    p_ctx->m_path = *path;
+    p_ctx->m_flags = args.Length() >= 2 ? parseOpenFlags(p_isolate, p_context, args[1]) : O_RDONLY;
+    p_ctx->m_mode = 0666;
+    if (args.Length() >= 3 && args[2]->IsInt32())
+        p_ctx->m_mode = args[2]->Int32Value(p_context).FromMaybe(0666);
+    z8::Task* p_task = new z8::Task();
+    p_task->m_resolver.Reset(p_isolate, p_resolver);
+    p_task->m_is_promise = true;
+    p_task->p_data = p_ctx;
+    p_task->m_runner = [](v8::Isolate* isolate, v8::Local<v8::Context> context, Task* task) {
+        auto p_ctx = static_cast<OpenCtx*>(task->p_data);
+        auto p_resolver = task->m_resolver.Get(isolate);
+        // A FileHandle keeps its budget slot until the descriptor is closed.
+        if (p_ctx->m_is_error) {
+            fdRelease();
+            p_resolver->Reject(context, syscallError(isolate, p_ctx->m_err_no, "open", p_ctx->m_path)).Check();
+        } else {
+            p_resolver->Resolve(context, newFileHandle(isolate, context, p_ctx->m_result_fd)).Check();
+        }
+        delete p_ctx;
+    };
+    fdAcquire([p_task, p_ctx]() { openStart(p_task, p_ctx); });
+}
+
+// Runs once the descriptor budget lets the open proceed.
+static void openStart(Task* p_task, OpenCtx* p_ctx) {
+#ifdef __linux__
+    io_uring_sqe* p_sqe = z8::IoRing::getInstance().acquire(p_ctx, IORING_OP_OPENAT);
+    if (p_sqe) {
+        p_sqe->fd = AT_FDCWD;
+        p_sqe->addr = reinterpret_cast<uint64_t>(p_ctx->m_path.c_str());
+        p_sqe->open_flags = static_cast<uint32_t>(p_ctx->m_flags | O_CLOEXEC);
+        p_sqe->len = static_cast<uint32_t>(p_ctx->m_mode);
+        p_ctx->p_task = p_task;
+        p_ctx->p_complete = [](z8::IoRingRequest* p_req, int32_t result) {
+            auto p_ctx = static_cast<OpenCtx*>(p_req);
+            if (result < 0) {
+                p_ctx->m_is_error = true;
+                p_ctx->m_err_no = -result;
+            } else {
+                p_ctx->m_result_fd = result;
+            }
+            TaskQueue::getInstance().enqueue(p_ctx->p_task);
+        };
+        return;
+    }
+#endif
+    ThreadPool::getInstance().enqueue([p_task, p_ctx]() {
+#ifdef _WIN32
+        p_ctx->m_result_fd = _open(p_ctx->m_path.c_str(), p_ctx->m_flags | _O_BINARY, p_ctx->m_mode);
+#else
+        p_ctx->m_result_fd = ::open(p_ctx->m_path.c_str(), p_ctx->m_flags | O_CLOEXEC, p_ctx->m_mode);
+#endif
+        if (p_ctx->m_result_fd == -1) {
+            p_ctx->m_is_error = true;
+            p_ctx->m_err_no = errno;
+        }
+        TaskQueue::getInstance().enqueue(p_task);
+    });
+}
+
+// --- Batch ---
+// fsPromises.readMany/statMany/writeMany run a whole list of paths as a few pool tasks instead of
+// one task, one TaskQueue hop and one promise per path. The list is cut into chunks; a worker
+// runs a chunk's syscalls back to back and the chunk reaches the main thread as a single task.
+// Results come back as one array in input order, or with { iterator: true } as an async
+// iterator that yields each finished chunk as an array of { path, value, error } entries.
+static constexpr size_t BATCH_MIN_CHUNK = 16;
+static constexpr size_t BATCH_MAX_CHUNK = 1024;
+static constexpr size_t BATCH_CHUNKS_PER_THREAD = 4;
+static constexpr uint8_t BATCH_READ = 0;
+static constexpr uint8_t BATCH_STAT = 1;
+static constexpr uint8_t BATCH_WRITE = 2;
+
+struct BatchItem {
+    std::string m_path;
+    std::vector<char> m_data;
+    std::string m_text;
+    const char* p_input = nullptr;
+    size_t m_input_length = 0;
+    StatData m_stat;
+    int32_t m_err_no = 0;
+    const char* p_syscall = "open";
+    // Set when the data decodes to a string longer than V8 allows.
+    bool m_too_long = false;
+};
+
+struct BatchCtx {
+    uint8_t m_kind = BATCH_READ;
+    // Read results are decoded with this encoding; empty keeps them Buffers.
+    std::string m_encoding;
+    bool m_iterate = false;
+    bool m_follow_symlink = true;
+    StatOptions m_stat_options;
+    size_t m_chunk_size = BATCH_MIN_CHUNK;
+    std::vector<BatchItem> m_items;
+    std::vector<v8::Global<v8::Value>> m_inputs;
+    std::atomic<bool> m_cancelled{false};
+
+    // Main thread only.
+    size_t m_chunks_left = 0;
+    v8::Global<v8::Array> m_results;
+    v8::Global<v8::Promise::Resolver> m_resolver;
+    std::deque<v8::Global<v8::Array>> m_ready;
+    std::deque<v8::Global<v8::Promise::Resolver>> m_waiters;
+    int32_t m_refs = 1;
+    v8::Global<v8::Object> m_self;
+};
+
+struct BatchChunk {
+    BatchCtx* p_ctx = nullptr;
+    size_t m_begin = 0;
+    size_t m_end = 0;
+};
+
+static int32_t batchOpen(const std::string& path, int32_t flags) {
+#ifdef _WIN32
+    return _open(path.c_str(), flags | _O_BINARY, 0666);
+#else
+    return ::open(path.c_str(), flags | O_CLOEXEC, 0666);
+#endif
+}
+
+static bool batchReadFile(BatchItem& item) {
+    int32_t fd = batchOpen(item.m_path, O_RDONLY);
+    if (fd < 0) {
+        item.m_err_no = errno;
+        return false;
+    }
+    // The size is only a hint; the loop still reads to EOF for files that grow or lie (procfs).
+    StatData st;
+    int32_t stat_err = 0;
+    size_t capacity = statFd(fd, st, stat_err) ? static_cast<size_t>(st.m_values[STAT_SIZE]) + 1 : 4096;
+    item.m_data.resize(std::max<size_t>(capacity, 1));
+    size_t used = 0;
+    bool ok = true;
+    for (;;) {
+        if (used == item.m_data.size())
+            item.m_data.resize(item.m_data.size() * 2);
+#ifdef _WIN32
+        int64_t got = _read(fd, item.m_data.data() + used, static_cast<uint32_t>(item.m_data.size() - used));
+#else
+        int64_t got = ::read(fd, item.m_data.data() + used, item.m_data.size() - used);
+#endif
+        if (got < 0) {
+            item.m_err_no = errno;
+            item.p_syscall = "read";
+            ok = false;
+            break;
+        }
+        if (got == 0)
+            break;
+        used += static_cast<size_t>(got);
+    }
+    item.m_data.resize(used);
+    fileHandleCloseFd(fd);
+    return ok;
+}
+
+static bool batchWriteFile(BatchItem& item) {
+    int32_t fd = batchOpen(item.m_path, O_WRONLY | O_CREAT | O_TRUNC);
+    if (fd < 0) {
+        item.m_err_no = errno;
+        return false;
+    }
+    size_t done = 0;
+    bool ok = true;
+    while (done < item.m_input_length) {
+#ifdef _WIN32
+        int64_t put = _write(fd, item.p_input + done, static_cast<uint32_t>(item.m_input_length - done));
+#else
+        int64_t put = ::write(fd, item.p_input + done, item.m_input_length - done);
+#endif
+        if (put < 0) {
+            item.m_err_no = errno;
+            item.p_syscall = "write";
+            ok = false;
+            break;
+        }
+        done += static_cast<size_t>(put);
+    }
+    fileHandleCloseFd(fd);
+    return ok;
+}
+
+static void batchRunChunk(BatchChunk* p_chunk) {
+    BatchCtx* p_ctx = p_chunk->p_ctx;
+    for (size_t i = p_chunk->m_begin; i < p_chunk->m_end && !p_ctx->m_cancelled.load(); ++i) {
+        BatchItem& item = p_ctx->m_items[i];
+        if (p_ctx->m_kind == BATCH_READ) {
+            batchReadFile(item);
+        } else if (p_ctx->m_kind == BATCH_WRITE) {
+            batchWriteFile(item);
+        } else {
+            item.p_syscall = p_ctx->m_follow_symlink ? "stat" : "lstat";
+            statPath(item.m_path, p_ctx->m_follow_symlink, item.m_stat, item.m_err_no);
         }
+    }
+}
+
+static void batchRelease(BatchCtx* p_ctx) {
+    if (--p_ctx->m_refs == 0)
         delete p_ctx;
-    };
+}
 
-    ThreadPool::getInstance().enqueue([p_task, p_ctx]() {
-#ifdef _WIN32
-#else
-            if (lchown(p_ctx->m_path.c_str(), p_ctx->m_uid, p_ctx->m_gid) != 0) {
-                p_ctx->m_is_error = true;
-                p_ctx->m_error_msg = "lchown failed";
+static v8::Local<v8::Value> batchError(v8::Isolate* p_isolate, const BatchItem& item) {
+    if (item.m_too_long)
+        return Buffer::stringTooLongError(p_isolate);
+    return syscallError(p_isolate, item.m_err_no, item.p_syscall, item.m_path);
+}
+
+// Converts a finished item to its JS value and frees the native copy of the data. Empty, with
+// m_too_long set on the item, when the text would be longer than a V8 string can be.
+static v8::MaybeLocal<v8::Value> batchValue(v8::Isolate* p_isolate,
+                                            v8::Local<v8::Context> context,
+                                            BatchCtx* p_ctx,
+                                            BatchItem& item) {
+    v8::Local<v8::Value> value = v8::Undefined(p_isolate);
+    if (p_ctx->m_kind == BATCH_STAT) {
+        value = newStats(p_isolate, context, item.m_stat, p_ctx->m_stat_options.m_bigint);
+    } else if (p_ctx->m_kind == BATCH_READ && !p_ctx->m_encoding.empty()) {
+        v8::Local<v8::String> text;
+        if (!Buffer::decodeBytes(p_isolate, p_ctx->m_encoding, item.m_data.data(), item.m_data.size())
+                 .ToLocal(&text)) {
+            std::vector<char>().swap(item.m_data);
+            item.m_too_long = true;
+            return {};
+        }
+        value = text;
+    } else if (p_ctx->m_kind == BATCH_READ) {
+        value = Buffer::copyBuffer(p_isolate, item.m_data.data(), item.m_data.size());
+    }
+    std::vector<char>().swap(item.m_data);
+    return value;
+}
+
+static void batchFinish(v8::Isolate* p_isolate, v8::Local<v8::Context> context, BatchCtx* p_ctx) {
+    if (p_ctx->m_iterate) {
+        if (p_ctx->m_ready.empty()) {
+            for (auto& waiter : p_ctx->m_waiters) {
+                v8::Local<v8::Value> done = makeIterResult(p_isolate, context, v8::Undefined(p_isolate), true);
+                waiter.Get(p_isolate)->Resolve(context, done).Check();
             }
-#endif
-        TaskQueue::getInstance().enqueue(p_task);
-    });
+            p_ctx->m_waiters.clear();
+        }
+        return;
+    }
+    v8::Local<v8::Promise::Resolver> resolver = p_ctx->m_resolver.Get(p_isolate);
+    // The lowest failing index wins, so the rejection does not depend on worker timing.
+    for (const BatchItem& item : p_ctx->m_items) {
+        if (item.m_err_no != 0 || item.m_too_long) {
+            resolver->Reject(context, batchError(p_isolate, item)).Check();
+            return;
+        }
+    }
+    if (p_ctx->m_kind == BATCH_WRITE)
+        resolver->Resolve(context, v8::Undefined(p_isolate)).Check();
+    else
+        resolver->Resolve(context, p_ctx->m_results.Get(p_isolate)).Check();
+}
+
+static void batchChunkDone(v8::Isolate* p_isolate, v8::Local<v8::Context> context, Task* p_task) {
+    auto p_chunk = static_cast<BatchChunk*>(p_task->p_data);
+    BatchCtx* p_ctx = p_chunk->p_ctx;
+    if (p_ctx->m_iterate && !p_ctx->m_cancelled.load()) {
+        v8::Local<v8::String> path_key = v8::String::NewFromUtf8Literal(p_isolate, "path");
+        v8::Local<v8::String> value_key = v8::String::NewFromUtf8Literal(p_isolate, "value");
+        v8::Local<v8::String> error_key = v8::String::NewFromUtf8Literal(p_isolate, "error");
+        int32_t length = static_cast<int32_t>(p_chunk->m_end - p_chunk->m_begin);
+        v8::Local<v8::Array> entries = v8::Array::New(p_isolate, length);
+        for (size_t i = p_chunk->m_begin; i < p_chunk->m_end; ++i) {
+            BatchItem& item = p_ctx->m_items[i];
+            v8::Local<v8::Object> entry = v8::Object::New(p_isolate);
+            (void) entry->CreateDataProperty(context, path_key, newUtf8String(p_isolate, item.m_path));
+            v8::Local<v8::Value> value;
+            if (item.m_err_no == 0 && batchValue(p_isolate, context, p_ctx, item).ToLocal(&value))
+                (void) entry->CreateDataProperty(context, value_key, value);
+            else
+                (void) entry->CreateDataProperty(context, error_key, batchError(p_isolate, item));
+            (void) entries->Set(context, static_cast<uint32_t>(i - p_chunk->m_begin), entry);
+        }
+        if (!p_ctx->m_waiters.empty()) {
+            v8::Local<v8::Promise::Resolver> waiter = p_ctx->m_waiters.front().Get(p_isolate);
+            p_ctx->m_waiters.pop_front();
+            waiter->Resolve(context, makeIterResult(p_isolate, context, entries, false)).Check();
+        } else {
+            p_ctx->m_ready.emplace_back(p_isolate, entries);
+        }
+    } else if (!p_ctx->m_iterate && p_ctx->m_kind != BATCH_WRITE) {
+        v8::Local<v8::Array> results = p_ctx->m_results.Get(p_isolate);
+        for (size_t i = p_chunk->m_begin; i < p_chunk->m_end; ++i) {
+            BatchItem& item = p_ctx->m_items[i];
+            v8::Local<v8::Value> value;
+            if (item.m_err_no == 0 && batchValue(p_isolate, context, p_ctx, item).ToLocal(&value))
+                (void) results->Set(context, static_cast<uint32_t>(i), value);
+        }
+    }
+    delete p_chunk;
+    if (--p_ctx->m_chunks_left == 0) {
+        p_ctx->m_inputs.clear();
+        batchFinish(p_isolate, context, p_ctx);
+        batchRelease(p_ctx);
+    }
 }
 
-void FS::opendirSync(const v8::FunctionCallbackInfo<v8::Value>& args) {
-    v8::Isolate* p_isolate = args.GetIsolate();
-    v8::HandleScope handle_scope(p_isolate);
-    if (args.Length() < 1 || !args[0]->IsString())
+static void batchStart(v8::Isolate* p_isolate, v8::Local<v8::Context> context, BatchCtx* p_ctx) {
+    size_t count = p_ctx->m_items.size();
+    if (count == 0) {
+        batchFinish(p_isolate, context, p_ctx);
+        batchRelease(p_ctx);
         return;
+    }
+    p_ctx->m_chunks_left = (count + p_ctx->m_chunk_size - 1) / p_ctx->m_chunk_size;
+    for (size_t begin = 0; begin < count; begin += p_ctx->m_chunk_size) {
+        auto p_chunk = new BatchChunk();
+        p_chunk->p_ctx = p_ctx;
+        p_chunk->m_begin = begin;
+        p_chunk->m_end = std::min(count, begin + p_ctx->m_chunk_size);
+        z8::Task* p_task = new z8::Task();
+        p_task->m_is_promise = false;
+        p_task->p_data = p_chunk;
+        p_task->m_runner = batchChunkDone;
+        ThreadPool::getInstance().enqueue([p_task, p_chunk]() {
+            batchRunChunk(p_chunk);
+            TaskQueue::getInstance().enqueue(p_task);
+        });
+    }
+}
 
-    v8::String::Utf8Value path(p_isolate, args[0]);
-    args.GetReturnValue().Set(FS::createDir(p_isolate, *path));
+static BatchCtx* getBatchCtx(v8::Local<v8::Object> self) {
+    if (self->InternalFieldCount() < 1)
+        return nullptr;
+    v8::Local<v8::Value> field = self->GetInternalField(0).As<v8::Value>();
+    return field->IsExternal() ? static_cast<BatchCtx*>(field.As<v8::External>()->Value()) : nullptr;
 }
 
-void FS::opendir(const v8::FunctionCallbackInfo<v8::Value>& args) {
+static void BatchIteratorNext(const v8::FunctionCallbackInfo<v8::Value>& args) {
     v8::Isolate* p_isolate = args.GetIsolate();
-    if (args.Length() < 2 || !args[0]->IsString() || !args[args.Length() - 1]->IsFunction())
-        return;
+    v8::Local<v8::Context> p_context = p_isolate->GetCurrentContext();
+    v8::Local<v8::Promise::Resolver> resolver = v8::Promise::Resolver::New(p_context).ToLocalChecked();
+    args.GetReturnValue().Set(resolver->GetPromise());
+    BatchCtx* p_ctx = getBatchCtx(args.This());
+    if (p_ctx && !p_ctx->m_ready.empty()) {
+        v8::Local<v8::Array> entries = p_ctx->m_ready.front().Get(p_isolate);
+        p_ctx->m_ready.pop_front();
+        resolver->Resolve(p_context, makeIterResult(p_isolate, p_context, entries, false)).Check();
+    } else if (p_ctx && p_ctx->m_chunks_left > 0 && !p_ctx->m_cancelled.load()) {
+        p_ctx->m_waiters.emplace_back(p_isolate, resolver);
+    } else {
+        resolver->Resolve(p_context, makeIterResult(p_isolate, p_context, v8::Undefined(p_isolate), true)).Check();
+    }
+}
 
-    v8::String::Utf8Value path(p_isolate, args[0]);
-    v8::Local<v8::Function> p_cb = args[args.Length() - 1].As<v8::Function>();
+static void BatchIteratorReturn(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    v8::Local<v8::Context> p_context = p_isolate->GetCurrentContext();
+    BatchCtx* p_ctx = getBatchCtx(args.This());
+    if (p_ctx) {
+        // Chunks already on the pool skip their remaining items.
+        p_ctx->m_cancelled.store(true);
+        p_ctx->m_ready.clear();
+        for (auto& waiter : p_ctx->m_waiters) {
+            v8::Local<v8::Value> done = makeIterResult(p_isolate, p_context, v8::Undefined(p_isolate), true);
+            waiter.Get(p_isolate)->Resolve(p_context, done).Check();
+        }
+        p_ctx->m_waiters.clear();
+    }
+    v8::Local<v8::Promise::Resolver> resolver = v8::Promise::Resolver::New(p_context).ToLocalChecked();
+    resolver->Resolve(p_context, makeIterResult(p_isolate, p_context, v8::Undefined(p_isolate), true)).Check();
+    args.GetReturnValue().Set(resolver->GetPromise());
+}
 
-    struct OpendirCtx {
-        std::string m_path;
-    };
-    auto p_ctx = new OpendirCtx();
-    p_ctx->m_path = *path;
+static v8::Local<v8::ObjectTemplate> GetBatchIteratorTemplate(v8::Isolate* p_isolate) {
+    static v8::Persistent<v8::ObjectTemplate> s_tmpl;
+    if (s_tmpl.IsEmpty()) {
+        v8::Local<v8::ObjectTemplate> local_tmpl = v8::ObjectTemplate::New(p_isolate);
+        local_tmpl->SetInternalFieldCount(1);
+        local_tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "next"),
+                        v8::FunctionTemplate::New(p_isolate, BatchIteratorNext));
+        local_tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "return"),
+                        v8::FunctionTemplate::New(p_isolate, BatchIteratorReturn));
+        local_tmpl->Set(v8::Symbol::GetAsyncIterator(p_isolate), v8::FunctionTemplate::New(p_isolate, IteratorSelf));
+        s_tmpl.Reset(p_isolate, local_tmpl);
+    }
+    return s_tmpl.Get(p_isolate);
+}
+
+// Reads { iterator, chunkSize, encoding, bigint } and sizes chunks so every pool thread gets a
+// few of them when no chunkSize is given.
+static void batchParseOptions(v8::Isolate* p_isolate,
+                              v8::Local<v8::Context> context,
+                              const v8::FunctionCallbackInfo<v8::Value>& args,
+                              int32_t index,
+                              BatchCtx* p_ctx) {
+    size_t target = std::max<size_t>(std::thread::hardware_concurrency(), 1) * BATCH_CHUNKS_PER_THREAD;
+    size_t chunk = (p_ctx->m_items.size() + target - 1) / target;
+    p_ctx->m_chunk_size = std::clamp(chunk, BATCH_MIN_CHUNK, BATCH_MAX_CHUNK);
+    if (args.Length() <= index)
+        return;
+    p_ctx->m_encoding = readEncodingArg(p_isolate, context, args[index]);
+    if (!args[index]->IsObject() || args[index]->IsNull())
+        return;
+    v8::Local<v8::Object> options = args[index].As<v8::Object>();
+    v8::Local<v8::Value> val;
+    if (getOption(p_isolate, context, options, "iterator", &val))
+        p_ctx->m_iterate = val->BooleanValue(p_isolate);
+    if (getOption(p_isolate, context, options, "chunkSize", &val) && val->IsNumber()) {
+        double size = val->NumberValue(context).FromMaybe(0);
+        if (size >= 1)
+            p_ctx->m_chunk_size = static_cast<size_t>(size);
+    }
+    p_ctx->m_stat_options = statParseOptions(p_isolate, context, args, index);
+}
+
+static bool batchCollectPaths(v8::Isolate* p_isolate,
+                              v8::Local<v8::Context> context,
+                              v8::Local<v8::Value> list,
+                              BatchCtx* p_ctx) {
+    if (!list->IsArray())
+        return false;
+    v8::Local<v8::Array> paths = list.As<v8::Array>();
+    p_ctx->m_items.resize(paths->Length());
+    for (uint32_t i = 0; i < paths->Length(); ++i) {
+        v8::Local<v8::Value> val;
+        if (!paths->Get(context, i).ToLocal(&val) || !val->IsString())
+            return false;
+        p_ctx->m_items[i].m_path = *v8::String::Utf8Value(p_isolate, val);
+    }
+    return true;
+}
 
-    z8::Task* p_task = new z8::Task();
-    p_task->m_callback.Reset(p_isolate, p_cb);
-    p_task->m_is_promise = false;
-    p_task->p_data = p_ctx;
-    p_task->m_runner = [](v8::Isolate* isolate, v8::Local<v8::Context> context, Task* task) {
-        auto p_ctx = static_cast<OpendirCtx*>(task->p_data);
-        v8::Local<v8::Value> argv[2];
-        argv[0] = v8::Null(isolate);
-        argv[1] = FS::createDir(isolate, p_ctx->m_path);
-        (void) task->m_callback.Get(isolate)->Call(context, context->Global(), 2, argv);
-        delete p_ctx;
-    };
+// Hands the batch to the pool and returns either the result promise or the chunk iterator.
+static v8::Local<v8::Value> batchSubmit(v8::Isolate* p_isolate, v8::Local<v8::Context> context, BatchCtx* p_ctx) {
+    v8::Local<v8::Value> result;
+    if (p_ctx->m_iterate) {
+        v8::Local<v8::Object> iterator = GetBatchIteratorTemplate(p_isolate)->NewInstance(context).ToLocalChecked();
+        iterator->SetInternalField(0, v8::External::New(p_isolate, p_ctx));
+        // One reference for the work, one for the iterator object.
+        p_ctx->m_refs = 2;
+        p_ctx->m_self.Reset(p_isolate, iterator);
+        p_ctx->m_self.SetWeak(
+            p_ctx,
+            [](const v8::WeakCallbackInfo<BatchCtx>& data) {
+                BatchCtx* p_ctx = data.GetParameter();
+                p_ctx->m_self.Reset();
+                p_ctx->m_cancelled.store(true);
+                batchRelease(p_ctx);
+            },
+            v8::WeakCallbackType::kParameter);
+        result = iterator;
+    } else {
+        v8::Local<v8::Promise::Resolver> resolver = v8::Promise::Resolver::New(context).ToLocalChecked();
+        p_ctx->m_resolver.Reset(p_isolate, resolver);
+        p_ctx->m_results.Reset(p_isolate, v8::Array::New(p_isolate, static_cast<int32_t>(p_ctx->m_items.size())));
+        result = resolver->GetPromise();
+    }
+    batchStart(p_isolate, context, p_ctx);
+    return result;
+}
 
-    ThreadPool::getInstance().enqueue([p_task]() { TaskQueue::getInstance().enqueue(p_task); });
+static void batchThrowPaths(v8::Isolate* p_isolate, const char* p_msg) {
+    p_isolate->ThrowException(v8::Exception::TypeError(v8::String::NewFromUtf8(p_isolate, p_msg).ToLocalChecked()));
 }
 
-void FS::opendirPromise(const v8::FunctionCallbackInfo<v8::Value>& args) {
+void FS::readManyPromise(const v8::FunctionCallbackInfo<v8::Value>& args) {
     v8::Isolate* p_isolate = args.GetIsolate();
     v8::Local<v8::Context> p_context = p_isolate->GetCurrentContext();
-    if (args.Length() < 1 || !args[0]->IsString())
-        return;
-
-    v8::Local<v8::Promise::Resolver> p_resolver;
-    if (!v8::Promise::Resolver::New(p_context).ToLocal(&p_resolver))
+    auto p_ctx = new BatchCtx();
+    if (args.Length() < 1 || !batchCollectPaths(p_isolate, p_context, args[0], p_ctx)) {
+        delete p_ctx;
+        batchThrowPaths(p_isolate, "The \"paths\" argument must be an array of strings");
         return;
-    args.GetReturnValue().Set(p_resolver->GetPromise());
-
-    v8::String::Utf8Value path(p_isolate, args[0]);
-
-    struct OpendirCtx {
-        std::string m_path;
-    };
-    auto p_ctx = new OpendirCtx();
-    p_ctx->m_path = *path;
+    }
+    p_ctx->m_kind = BATCH_READ;
+    batchParseOptions(p_isolate, p_context, args, 1, p_ctx);
+    args.GetReturnValue().Set(batchSubmit(p_isolate, p_context, p_ctx));
+}
 
-    z8::Task* p_task = new z8::Task();
-    p_task->m_resolver.Reset(p_isolate, p_resolver);
-    p_task->m_is_promise = true;
-    p_task->p_data = p_ctx;
-    p_task->m_runner = [](v8::Isolate* isolate, v8::Local<v8::Context> context, Task* task) {
-        auto p_ctx = static_cast<OpendirCtx*>(task->p_data);
-        auto p_resolver = task->m_resolver.Get(isolate);
-        p_resolver->Resolve(context, FS::createDir(isolate, p_ctx->m_path)).Check();
+void FS::statManyPromise(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    v8::Local<v8::Context> p_context = p_isolate->GetCurrentContext();
+    auto p_ctx = new BatchCtx();
+    if (args.Length() < 1 || !batchCollectPaths(p_isolate, p_context, args[0], p_ctx)) {
         delete p_ctx;
-    };
+        batchThrowPaths(p_isolate, "The \"paths\" argument must be an array of strings");
+        return;
+    }
+    p_ctx->m_kind = BATCH_STAT;
+    batchParseOptions(p_isolate, p_context, args, 1, p_ctx);
+    if (args.Length() > 1 && args[1]->IsObject()) {
+        v8::Local<v8::Value> val;
+        if (getOption(p_isolate, p_context, args[1].As<v8::Object>(), "followSymlinks", &val))
+            p_ctx->m_follow_symlink = val->BooleanValue(p_isolate);
+    }
+    args.GetReturnValue().Set(batchSubmit(p_isolate, p_context, p_ctx));
+}
 
-    ThreadPool::getInstance().enqueue([p_task]() { TaskQueue::getInstance().enqueue(p_task); });
+// writeMany([[path, data], ...]) or writeMany([{ path, data }, ...]); data is a string or a
+// Uint8Array. Buffers are written in place and kept alive until their chunk is done.
+void FS::writeManyPromise(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    v8::Local<v8::Context> p_context = p_isolate->GetCurrentContext();
+    if (args.Length() < 1 || !args[0]->IsArray()) {
+        batchThrowPaths(p_isolate, "The \"entries\" argument must be an array");
+        return;
+    }
+    v8::Local<v8::Array> entries = args[0].As<v8::Array>();
+    auto p_ctx = new BatchCtx();
+    p_ctx->m_kind = BATCH_WRITE;
+    p_ctx->m_items.resize(entries->Length());
+    for (uint32_t i = 0; i < entries->Length(); ++i) {
+        v8::Local<v8::Value> entry;
+        v8::Local<v8::Value> path;
+        v8::Local<v8::Value> data;
+        bool ok = entries->Get(p_context, i).ToLocal(&entry) && entry->IsObject();
+        if (ok && entry->IsArray()) {
+            ok = entry.As<v8::Array>()->Get(p_context, 0).ToLocal(&path) &&
+                 entry.As<v8::Array>()->Get(p_context, 1).ToLocal(&data);
+        } else if (ok) {
+            v8::Local<v8::Object> object = entry.As<v8::Object>();
+            ok = getOption(p_isolate, p_context, object, "path", &path) &&
+                 object->Get(p_context, v8::String::NewFromUtf8Literal(p_isolate, "data")).ToLocal(&data);
+        }
+        if (!ok || !path->IsString() || (!data->IsString() && !data->IsArrayBufferView())) {
+            delete p_ctx;
+            batchThrowPaths(p_isolate, "Each entry must be [path, data] or { path, data }");
+            return;
+        }
+        BatchItem& item = p_ctx->m_items[i];
+        item.m_path = *v8::String::Utf8Value(p_isolate, path);
+        if (data->IsString()) {
+            item.m_text = *v8::String::Utf8Value(p_isolate, data);
+            item.p_input = item.m_text.data();
+            item.m_input_length = item.m_text.size();
+        } else {
+            IoSlice slice = sliceOf(data.As<v8::ArrayBufferView>(), 0, data.As<v8::ArrayBufferView>()->ByteLength());
+            item.p_input = slice.p_data;
+            item.m_input_length = slice.m_length;
+            p_ctx->m_inputs.emplace_back(p_isolate, data);
+        }
+    }
+    batchParseOptions(p_isolate, p_context, args, 1, p_ctx);
+    args.GetReturnValue().Set(batchSubmit(p_isolate, p_context, p_ctx));
 }
 
 struct ReadVCtx {
@@ -6564,16 +12553,26 @@ void FS::writevPromise(const v8::FunctionCallbackInfo<v8::Value>& args) {
 struct ReadStreamInternal : public z8::module::StreamInternal {
     int32_t m_fd = -1;
     bool m_auto_close = true;
+    // Weak; lets GC close a stream that was dropped without ending.
+    v8::Global<v8::Object> m_self;
 
-    ~ReadStreamInternal() override {
-        if (m_auto_close && m_fd != -1) {
+    // The descriptor budget slot goes back as soon as the stream is done with the fd.
+    void close() override {
+        if (m_fd == -1)
+            return;
+        fdRelease();
+        if (m_auto_close) {
 #ifdef _WIN32
             _close(m_fd);
 #else
-            close(m_fd);
+            ::close(m_fd);
 #endif
-            m_fd = -1;
         }
+        m_fd = -1;
+    }
+
+    ~ReadStreamInternal() override {
+        close();
     }
 };
 
@@ -6614,10 +12613,21 @@ static void readStream_read(const v8::FunctionCallbackInfo<v8::Value>& args) {
         return;
     }
 
-    v8::Local<v8::Uint8Array> ui8 = z8::module::Buffer::createBuffer(p_isolate, bytes_read);
-    memcpy(ui8->Buffer()->GetBackingStore()->Data(), buffer.data(), bytes_read);
+    // With an encoding the chunk is decoded straight from the read buffer, so no Buffer is made
+    // for it; push() passes strings through.
+    v8::Local<v8::Value> chunk;
+    if (p_ctx->up_decoder) {
+        v8::Local<v8::String> text;
+        if (!p_ctx->up_decoder->write(p_isolate, buffer.data(), bytes_read).ToLocal(&text)) {
+            p_isolate->ThrowException(Buffer::stringTooLongError(p_isolate));
+            return;
+        }
+        chunk = text;
+    } else {
+        chunk = z8::module::Buffer::copyBuffer(p_isolate, buffer.data(), bytes_read);
+    }
 
-    v8::Local<v8::Value> push_argv[] = { ui8 };
+    v8::Local<v8::Value> push_argv[] = { chunk };
     (void)push_fn.As<v8::Function>()->Call(context, self, 1, push_argv);
 }
 
@@ -6633,6 +12643,21 @@ void FS::createReadStream(const v8::FunctionCallbackInfo<v8::Value>& args) {
     v8::String::Utf8Value path_val(p_isolate, args[0]);
     std::string path = *path_val;
 
+    // options may be the encoding itself or an object carrying it.
+    std::unique_ptr<z8::module::StringDecoder> up_decoder;
+    if (args.Length() > 1 && (args[1]->IsString() || args[1]->IsObject())) {
+        v8::Local<v8::Value> encoding = args[1];
+        if (args[1]->IsObject()
+            && !args[1].As<v8::Object>()->Get(context, v8::String::NewFromUtf8Literal(p_isolate, "encoding"))
+                    .ToLocal(&encoding))
+            return;
+        if (!encoding->IsNullOrUndefined()) {
+            up_decoder = z8::module::StringDecoder::fromValue(p_isolate, encoding);
+            if (!up_decoder)
+                return;
+        }
+    }
+
     int32_t fd = -1;
 #ifdef _WIN32
     fd = _open(path.c_str(), _O_RDONLY | _O_BINARY);
@@ -6645,23 +12670,26 @@ void FS::createReadStream(const v8::FunctionCallbackInfo<v8::Value>& args) {
         return;
     }
 
+    // Stream constructors are synchronous and cannot wait for a slot; the fd is still counted.
+    fdReserve();
     auto p_ctx = new ReadStreamInternal();
     p_ctx->m_fd = fd;
     p_ctx->m_is_readable = true;
+    p_ctx->up_decoder = std::move(up_decoder);
 
     v8::Local<v8::FunctionTemplate> readable_tmpl = z8::module::Stream::getReadableTemplate(p_isolate);
     v8::Local<v8::Object> js_obj;
     if (!readable_tmpl->GetFunction(context).ToLocalChecked()->NewInstance(context).ToLocal(&js_obj)) return;
     
-    v8::Local<v8::Data> old_internal = js_obj->GetInternalField(0);
-    if (!old_internal.IsEmpty() && old_internal->IsValue() && old_internal.As<v8::Value>()->IsExternal()) {
-        delete static_cast<z8::module::StreamInternal*>(old_internal.As<v8::External>()->Value());
-    }
+    v8::Local<v8::Data> old_internal = js_obj->GetInternalField(0);
+    if (!old_internal.IsEmpty() && old_internal->IsValue() && old_internal.As<v8::Value>()->IsExternal()) {
+        delete static_cast<z8::module::StreamInternal*>(old_internal.As<v8::External>()->Value());
+    }
     js_obj->SetInternalField(0, v8::External::New(p_isolate, p_ctx));
     js_obj->Set(context, v8::String::NewFromUtf8Literal(p_isolate, "_read"), v8::FunctionTemplate::New(p_isolate, readStream_read)->GetFunction(context).ToLocalChecked()).Check();
 
-    v8::Global<v8::Object> global_self(p_isolate, js_obj);
-    global_self.SetWeak(p_ctx, [](const v8::WeakCallbackInfo<ReadStreamInternal>& data) {
+    p_ctx->m_self.Reset(p_isolate, js_obj);
+    p_ctx->m_self.SetWeak(p_ctx, [](const v8::WeakCallbackInfo<ReadStreamInternal>& data) {
         delete data.GetParameter();
     }, v8::WeakCallbackType::kParameter);
 
@@ -6671,16 +12699,26 @@ void FS::createReadStream(const v8::FunctionCallbackInfo<v8::Value>& args) {
 struct WriteStreamInternal : public z8::module::StreamInternal {
     int32_t m_fd = -1;
     bool m_auto_close = true;
+    // Weak; lets GC close a stream that was dropped without ending.
+    v8::Global<v8::Object> m_self;
 
-    ~WriteStreamInternal() override {
-        if (m_auto_close && m_fd != -1) {
+    // The descriptor budget slot goes back as soon as the stream is done with the fd.
+    void close() override {
+        if (m_fd == -1)
+            return;
+        fdRelease();
+        if (m_auto_close) {
 #ifdef _WIN32
             _close(m_fd);
 #else
-            close(m_fd);
+            ::close(m_fd);
 #endif
-            m_fd = -1;
         }
+        m_fd = -1;
+    }
+
+    ~WriteStreamInternal() override {
+        close();
     }
 };
 
@@ -6735,6 +12773,7 @@ void FS::createWriteStream(const v8::FunctionCallbackInfo<v8::Value>& args) {
         return;
     }
 
+    fdReserve();
     auto p_ctx = new WriteStreamInternal();
     p_ctx->m_fd = fd;
     p_ctx->m_is_writable = true;
@@ -6743,21 +12782,603 @@ void FS::createWriteStream(const v8::FunctionCallbackInfo<v8::Value>& args) {
     v8::Local<v8::Object> js_obj;
     if (!writable_tmpl->GetFunction(context).ToLocalChecked()->NewInstance(context).ToLocal(&js_obj)) return;
     
-    v8::Local<v8::Data> old_internal = js_obj->GetInternalField(0);
-    if (!old_internal.IsEmpty() && old_internal->IsValue() && old_internal.As<v8::Value>()->IsExternal()) {
-        delete static_cast<z8::module::StreamInternal*>(old_internal.As<v8::External>()->Value());
-    }
+    v8::Local<v8::Data> old_internal = js_obj->GetInternalField(0);
+    if (!old_internal.IsEmpty() && old_internal->IsValue() && old_internal.As<v8::Value>()->IsExternal()) {
+        delete static_cast<z8::module::StreamInternal*>(old_internal.As<v8::External>()->Value());
+    }
     js_obj->SetInternalField(0, v8::External::New(p_isolate, p_ctx));
     js_obj->Set(context, v8::String::NewFromUtf8Literal(p_isolate, "_write"), v8::FunctionTemplate::New(p_isolate, writeStream_write)->GetFunction(context).ToLocalChecked()).Check();
 
-    v8::Global<v8::Object> global_self(p_isolate, js_obj);
-    global_self.SetWeak(p_ctx, [](const v8::WeakCallbackInfo<WriteStreamInternal>& data) {
+    p_ctx->m_self.Reset(p_isolate, js_obj);
+    p_ctx->m_self.SetWeak(p_ctx, [](const v8::WeakCallbackInfo<WriteStreamInternal>& data) {
         delete data.GetParameter();
     }, v8::WeakCallbackType::kParameter);
 
     args.GetReturnValue().Set(js_obj);
 }
 
+// --- Log writer ---
+// fs.createLogWriter(path[, options]) returns an append-only writer for high-rate logging. The
+// main thread copies each record into a single-producer/single-consumer byte ring and returns;
+// a flusher thread drains the ring with writev once flushBytes are pending or every
+// flushInterval ms, and rotates the file by size (maxSize) or age (rotateInterval) between
+// drains, keeping maxFiles old files as path.1, path.2, ... A write only copies into memory, so
+// writers never issue or wait on a disk call themselves, but a full ring has to go somewhere:
+// overflow: 'block' (default) waits for the flusher to make room, so a writer can stall as long
+// as the disk does, and 'drop' discards the record instead. Both outcomes are counted in
+// stats(). Unflushed records are written at exit.
+static constexpr size_t LOG_DEFAULT_BUFFER = 4 * 1024 * 1024;
+static constexpr size_t LOG_MIN_BUFFER = 4 * 1024;
+static constexpr size_t LOG_DEFAULT_FLUSH_BYTES = 64 * 1024;
+static constexpr int64_t LOG_DEFAULT_FLUSH_MS = 100;
+static constexpr int32_t LOG_DEFAULT_MAX_FILES = 5;
+static constexpr int64_t LOG_BLOCK_POLL_MS = 10;
+
+struct LogWriterState {
+    std::string m_path;
+    int32_t m_fd = -1;
+
+    // Ring: m_head only moves on the main thread, m_tail only on the flusher.
+    std::vector<char> m_ring;
+    size_t m_mask = 0;
+    std::atomic<uint64_t> m_head{0};
+    std::atomic<uint64_t> m_tail{0};
+
+    size_t m_flush_bytes = LOG_DEFAULT_FLUSH_BYTES;
+    std::chrono::milliseconds m_flush_interval{LOG_DEFAULT_FLUSH_MS};
+    uint64_t m_max_size = 0;
+    std::chrono::milliseconds m_rotate_interval{0};
+    int32_t m_max_files = LOG_DEFAULT_MAX_FILES;
+    bool m_drop = false;
+
+    std::mutex m_mutex;
+    std::condition_variable m_flusher_cv;
+    std::condition_variable m_space_cv;
+    std::atomic<bool> m_closing{false};
+    std::atomic<bool> m_flush_wanted{false};
+    std::atomic<bool> m_notify_main{false};
+    std::atomic<bool> m_writer_waiting{false};
+    std::atomic<bool> m_exiting{false};
+    std::atomic<int32_t> m_refs{1};
+    std::thread m_thread;
+
+    // Flusher only.
+    uint64_t m_file_size = 0;
+    std::chrono::steady_clock::time_point m_opened_at;
+
+    std::atomic<uint64_t> m_records{0};
+    std::atomic<uint64_t> m_dropped{0};
+    std::atomic<uint64_t> m_blocked{0};
+    std::atomic<uint64_t> m_blocked_us{0};
+    std::atomic<uint64_t> m_bytes_written{0};
+    std::atomic<uint64_t> m_lost_bytes{0};
+    std::atomic<uint64_t> m_writes{0};
+    std::atomic<uint64_t> m_rotations{0};
+    std::atomic<int32_t> m_last_error{0};
+
+    // Main thread only.
+    bool m_close_requested = false;
+    bool m_finished = false;
+    bool m_waiting = false;
+    // Collected by GC while the flusher was still running; the final settle drops the last ref.
+    bool m_collected = false;
+    std::deque<std::pair<uint64_t, v8::Global<v8::Promise::Resolver>>> m_flush_waiters;
+    std::vector<v8::Global<v8::Promise::Resolver>> m_close_waiters;
+    v8::Global<v8::Object> m_self;
+};
+
+// Writers still open at exit; their rings are drained before the process ends.
+struct LogWriterRegistry {
+    std::mutex m_mutex;
+    std::set<LogWriterState*> m_writers;
+
+    LogWriterRegistry() {
+        // Flushers post to the TaskQueue, so it has to outlive this registry.
+        (void) TaskQueue::getInstance();
+    }
+
+    ~LogWriterRegistry() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (LogWriterState* p_state : m_writers) {
+            p_state->m_exiting.store(true);
+            p_state->m_closing.store(true);
+            p_state->m_flusher_cv.notify_one();
+            if (p_state->m_thread.joinable())
+                p_state->m_thread.join();
+        }
+    }
+};
+
+static LogWriterRegistry& logWriterRegistry() {
+    static LogWriterRegistry s_registry;
+    return s_registry;
+}
+
+static void logUnref(LogWriterState* p_state) {
+    if (p_state->m_refs.fetch_sub(1) == 1)
+        delete p_state;
+}
+
+static int32_t logOpen(const std::string& path) {
+#ifdef _WIN32
+    return _open(path.c_str(), _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+    return ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0666);
+#endif
+}
+
+static void logCloseFd(int32_t fd) {
+#ifdef _WIN32
+    _close(fd);
+#else
+    ::close(fd);
+#endif
+}
+
+// Moves path to path.1 (shifting older files up to maxFiles) and starts a new file. Runs on
+// the flusher between drains, so a record never straddles two files.
+static void logRotate(LogWriterState* p_state) {
+    logCloseFd(p_state->m_fd);
+    std::error_code ec;
+    if (p_state->m_max_files > 0) {
+        for (int32_t i = p_state->m_max_files - 1; i >= 1; --i) {
+            fs::rename(p_state->m_path + "." + std::to_string(i), p_state->m_path + "." + std::to_string(i + 1), ec);
+        }
+        fs::rename(p_state->m_path, p_state->m_path + ".1", ec);
+    } else {
+        fs::remove(p_state->m_path, ec);
+    }
+    p_state->m_fd = logOpen(p_state->m_path);
+    if (p_state->m_fd < 0)
+        p_state->m_last_error.store(errno);
+    p_state->m_file_size = 0;
+    p_state->m_opened_at = std::chrono::steady_clock::now();
+    p_state->m_rotations.fetch_add(1);
+}
+
+static void logMaybeRotate(LogWriterState* p_state, uint64_t incoming) {
+    if (p_state->m_file_size == 0)
+        return;
+    bool too_big = p_state->m_max_size > 0 && p_state->m_file_size + incoming > p_state->m_max_size;
+    bool too_old = p_state->m_rotate_interval.count() > 0 &&
+                   std::chrono::steady_clock::now() - p_state->m_opened_at >= p_state->m_rotate_interval;
+    if (too_big || too_old)
+        logRotate(p_state);
+}
+
+// Writes both ring segments, retrying short writes. Returns the bytes written.
+static uint64_t logWriteSegments(int32_t fd, const char* p_first, size_t first, const char* p_second, size_t second,
+                                 int32_t& err_no) {
+    uint64_t total = 0;
+#ifdef _WIN32
+    const char* p_parts[2] = {p_first, p_second};
+    size_t lengths[2] = {first, second};
+    for (int32_t i = 0; i < 2; ++i) {
+        size_t done = 0;
+        while (done < lengths[i]) {
+            size_t chunk = std::min<size_t>(lengths[i] - done, INT32_MAX);
+            int32_t put = _write(fd, p_parts[i] + done, static_cast<uint32_t>(chunk));
+            if (put <= 0) {
+                err_no = put < 0 ? errno : EIO;
+                return total;
+            }
+            done += static_cast<size_t>(put);
+            total += static_cast<uint64_t>(put);
+        }
+    }
+#else
+    iovec iov[2] = {{const_cast<char*>(p_first), first}, {const_cast<char*>(p_second), second}};
+    int32_t index = 0;
+    int32_t count = second > 0 ? 2 : 1;
+    while (index < count) {
+        ssize_t put = ::writev(fd, iov + index, count - index);
+        if (put < 0 && errno == EINTR)
+            continue;
+        if (put <= 0) {
+            err_no = put < 0 ? errno : EIO;
+            return total;
+        }
+        total += static_cast<uint64_t>(put);
+        size_t left = static_cast<size_t>(put);
+        while (index < count && left >= iov[index].iov_len) {
+            left -= iov[index].iov_len;
+            index++;
+        }
+        if (index < count) {
+            iov[index].iov_base = static_cast<char*>(iov[index].iov_base) + left;
+            iov[index].iov_len -= left;
+        }
+    }
+#endif
+    return total;
+}
+
+// Writes everything published so far. The head snapshot always sits on a record boundary.
+static void logDrain(LogWriterState* p_state) {
+    uint64_t tail = p_state->m_tail.load(std::memory_order_relaxed);
+    uint64_t head = p_state->m_head.load(std::memory_order_acquire);
+    logMaybeRotate(p_state, head - tail);
+    if (head == tail)
+        return;
+    size_t pending = static_cast<size_t>(head - tail);
+    size_t start = static_cast<size_t>(tail) & p_state->m_mask;
+    size_t first = std::min(pending, p_state->m_ring.size() - start);
+    int32_t err_no = 0;
+    uint64_t written = 0;
+    if (p_state->m_fd >= 0) {
+        written = logWriteSegments(
+            p_state->m_fd, p_state->m_ring.data() + start, first, p_state->m_ring.data(), pending - first, err_no);
+    } else {
+        err_no = EBADF;
+    }
+    if (err_no != 0) {
+        // Nothing can be retried safely, so the rest of this drain is reported as lost.
+        p_state->m_last_error.store(err_no);
+        p_state->m_lost_bytes.fetch_add(pending - written);
+    }
+    p_state->m_file_size += written;
+    p_state->m_bytes_written.fetch_add(written);
+    p_state->m_writes.fetch_add(1);
+    p_state->m_tail.store(head, std::memory_order_release);
+    if (p_state->m_writer_waiting.load()) {
+        std::lock_guard<std::mutex> lock(p_state->m_mutex);
+        p_state->m_space_cv.notify_all();
+    }
+}
+
+static void logSettle(v8::Isolate* p_isolate, v8::Local<v8::Context> context, Task* p_task);
+
+static void logPostSettle(LogWriterState* p_state) {
+    if (p_state->m_exiting.load())
+        return;
+    p_state->m_refs.fetch_add(1);
+    z8::Task* p_task = new z8::Task();
+    p_task->m_is_promise = false;
+    p_task->p_data = p_state;
+    p_task->m_runner = logSettle;
+    TaskQueue::getInstance().enqueue(p_task);
+}
+
+static void logFlusherLoop(LogWriterState* p_state) {
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(p_state->m_mutex);
+            p_state->m_flusher_cv.wait_for(lock, p_state->m_flush_interval, [p_state]() {
+                return p_state->m_closing.load() || p_state->m_flush_wanted.load() ||
+                       p_state->m_head.load() - p_state->m_tail.load() >= p_state->m_flush_bytes;
+            });
+        }
+        bool closing = p_state->m_closing.load();
+        p_state->m_flush_wanted.store(false);
+        logDrain(p_state);
+        if (closing && p_state->m_head.load() == p_state->m_tail.load())
+            break;
+        if (p_state->m_notify_main.exchange(false))
+            logPostSettle(p_state);
+    }
+    if (p_state->m_fd >= 0) {
+        logCloseFd(p_state->m_fd);
+        p_state->m_fd = -1;
+    }
+    logPostSettle(p_state);
+}
+
+// Pending flush() or close() promises keep the writer object alive.
+static void logUpdateWeak(LogWriterState* p_state);
+
+// Runs inside GC, so it must not join the flusher: it only asks it to drain and stop. The
+// flusher's last logSettle joins it on the main thread and releases the writer's ref there.
+static void logWeak(const v8::WeakCallbackInfo<LogWriterState>& data) {
+    LogWriterState* p_state = data.GetParameter();
+    p_state->m_self.Reset();
+    if (p_state->m_finished) {
+        logUnref(p_state);
+        return;
+    }
+    p_state->m_collected = true;
+    p_state->m_closing.store(true);
+    std::lock_guard<std::mutex> lock(p_state->m_mutex);
+    p_state->m_flusher_cv.notify_one();
+}
+
+static void logUpdateWeak(LogWriterState* p_state) {
+    bool waiting = !p_state->m_flush_waiters.empty() || !p_state->m_close_waiters.empty();
+    if (waiting != p_state->m_waiting) {
+        p_state->m_waiting = waiting;
+        s_log_waiting += waiting ? 1 : -1;
+    }
+    if (p_state->m_self.IsEmpty())
+        return;
+    if (waiting)
+        p_state->m_self.ClearWeak();
+    else
+        p_state->m_self.SetWeak(p_state, logWeak, v8::WeakCallbackType::kParameter);
+}
+
+static void logSettle(v8::Isolate* p_isolate, v8::Local<v8::Context> context, Task* p_task) {
+    auto p_state = static_cast<LogWriterState*>(p_task->p_data);
+    uint64_t tail = p_state->m_tail.load();
+    while (!p_state->m_flush_waiters.empty() && p_state->m_flush_waiters.front().first <= tail) {
+        p_state->m_flush_waiters.front().second.Get(p_isolate)->Resolve(context, v8::Undefined(p_isolate)).Check();
+        p_state->m_flush_waiters.pop_front();
+    }
+    bool stopped = p_state->m_closing.load() && p_state->m_head.load() == tail && p_state->m_fd < 0;
+    bool release = false;
+    if (stopped && !p_state->m_finished) {
+        release = p_state->m_collected;
+        p_state->m_finished = true;
+        if (p_state->m_thread.joinable())
+            p_state->m_thread.join();
+        {
+            std::lock_guard<std::mutex> lock(logWriterRegistry().m_mutex);
+            logWriterRegistry().m_writers.erase(p_state);
+        }
+        for (auto& waiter : p_state->m_close_waiters)
+            waiter.Get(p_isolate)->Resolve(context, v8::Undefined(p_isolate)).Check();
+        p_state->m_close_waiters.clear();
+    } else if (!p_state->m_flush_waiters.empty()) {
+        // The flusher was mid-drain when the flush was requested; ask for another pass.
+        p_state->m_notify_main.store(true);
+        p_state->m_flush_wanted.store(true);
+        std::lock_guard<std::mutex> lock(p_state->m_mutex);
+        p_state->m_flusher_cv.notify_one();
+    }
+    logUpdateWeak(p_state);
+    logUnref(p_state);
+    if (release)
+        logUnref(p_state);
+}
+
+static LogWriterState* getLogWriterState(v8::Local<v8::Object> self) {
+    if (self->InternalFieldCount() < 1)
+        return nullptr;
+    v8::Local<v8::Value> field = self->GetInternalField(0).As<v8::Value>();
+    if (!field->IsExternal())
+        return nullptr;
+    return static_cast<LogWriterState*>(field.As<v8::External>()->Value());
+}
+
+// Copies one record into the ring. Returns false when it was dropped.
+static bool logPush(LogWriterState* p_state, const char* p_data, size_t length) {
+    size_t capacity = p_state->m_ring.size();
+    if (length > capacity) {
+        p_state->m_dropped.fetch_add(1);
+        return false;
+    }
+    uint64_t head = p_state->m_head.load(std::memory_order_relaxed);
+    if (capacity - (head - p_state->m_tail.load(std::memory_order_acquire)) < length) {
+        if (p_state->m_drop) {
+            p_state->m_dropped.fetch_add(1);
+            return false;
+        }
+        auto start = std::chrono::steady_clock::now();
+        p_state->m_blocked.fetch_add(1);
+        p_state->m_writer_waiting.store(true);
+        std::unique_lock<std::mutex> lock(p_state->m_mutex);
+        p_state->m_flush_wanted.store(true);
+        p_state->m_flusher_cv.notify_one();
+        while (capacity - (head - p_state->m_tail.load(std::memory_order_acquire)) < length)
+            p_state->m_space_cv.wait_for(lock, std::chrono::milliseconds(LOG_BLOCK_POLL_MS));
+        lock.unlock();
+        p_state->m_writer_waiting.store(false);
+        auto waited = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+        p_state->m_blocked_us.fetch_add(static_cast<uint64_t>(waited.count()));
+    }
+    size_t start = static_cast<size_t>(head) & p_state->m_mask;
+    size_t first = std::min(length, capacity - start);
+    memcpy(p_state->m_ring.data() + start, p_data, first);
+    memcpy(p_state->m_ring.data(), p_data + first, length - first);
+    uint64_t pending = head + length - p_state->m_tail.load(std::memory_order_relaxed);
+    p_state->m_head.store(head + length, std::memory_order_release);
+    p_state->m_records.fetch_add(1);
+    if (pending >= p_state->m_flush_bytes && pending - length < p_state->m_flush_bytes)
+        p_state->m_flusher_cv.notify_one();
+    return true;
+}
+
+static void LogWriterWrite(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    LogWriterState* p_state = getLogWriterState(args.This());
+    if (!p_state)
+        return;
+    if (p_state->m_close_requested) {
+        p_isolate->ThrowException(
+            v8::Exception::Error(v8::String::NewFromUtf8Literal(p_isolate, "ERR_STREAM_DESTROYED: writer is closed")));
+        return;
+    }
+    bool ok = false;
+    if (args.Length() > 0 && args[0]->IsArrayBufferView()) {
+        v8::Local<v8::ArrayBufferView> view = args[0].As<v8::ArrayBufferView>();
+        const char* p_data = static_cast<const char*>(view->Buffer()->Data()) + view->ByteOffset();
+        ok = logPush(p_state, p_data, view->ByteLength());
+    } else if (args.Length() > 0) {
+        v8::String::Utf8Value text(p_isolate, args[0]);
+        ok = *text != nullptr && logPush(p_state, *text, static_cast<size_t>(text.length()));
+    }
+    args.GetReturnValue().Set(ok);
+}
+
+static void LogWriterFlush(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    v8::Local<v8::Context> context = p_isolate->GetCurrentContext();
+    LogWriterState* p_state = getLogWriterState(args.This());
+    v8::Local<v8::Promise::Resolver> resolver;
+    if (!p_state || !v8::Promise::Resolver::New(context).ToLocal(&resolver))
+        return;
+    args.GetReturnValue().Set(resolver->GetPromise());
+    uint64_t target = p_state->m_head.load();
+    if (p_state->m_finished || p_state->m_tail.load() >= target) {
+        resolver->Resolve(context, v8::Undefined(p_isolate)).Check();
+        return;
+    }
+    p_state->m_flush_waiters.emplace_back(target, v8::Global<v8::Promise::Resolver>(p_isolate, resolver));
+    logUpdateWeak(p_state);
+    p_state->m_notify_main.store(true);
+    p_state->m_flush_wanted.store(true);
+    std::lock_guard<std::mutex> lock(p_state->m_mutex);
+    p_state->m_flusher_cv.notify_one();
+}
+
+static void LogWriterClose(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    v8::Local<v8::Context> context = p_isolate->GetCurrentContext();
+    LogWriterState* p_state = getLogWriterState(args.This());
+    v8::Local<v8::Promise::Resolver> resolver;
+    if (!p_state || !v8::Promise::Resolver::New(context).ToLocal(&resolver))
+        return;
+    args.GetReturnValue().Set(resolver->GetPromise());
+    if (p_state->m_finished) {
+        resolver->Resolve(context, v8::Undefined(p_isolate)).Check();
+        return;
+    }
+    p_state->m_close_waiters.emplace_back(p_isolate, resolver);
+    logUpdateWeak(p_state);
+    if (p_state->m_close_requested)
+        return;
+    p_state->m_close_requested = true;
+    p_state->m_closing.store(true);
+    std::lock_guard<std::mutex> lock(p_state->m_mutex);
+    p_state->m_flusher_cv.notify_one();
+}
+
+static void LogWriterStats(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    v8::Local<v8::Context> context = p_isolate->GetCurrentContext();
+    LogWriterState* p_state = getLogWriterState(args.This());
+    if (!p_state)
+        return;
+    const std::pair<const char*, double> values[] = {
+        {"records", static_cast<double>(p_state->m_records.load())},
+        {"bytesWritten", static_cast<double>(p_state->m_bytes_written.load())},
+        {"pendingBytes", static_cast<double>(p_state->m_head.load() - p_state->m_tail.load())},
+        {"writes", static_cast<double>(p_state->m_writes.load())},
+        {"dropped", static_cast<double>(p_state->m_dropped.load())},
+        {"blocked", static_cast<double>(p_state->m_blocked.load())},
+        {"blockedMs", static_cast<double>(p_state->m_blocked_us.load()) / 1000.0},
+        {"lostBytes", static_cast<double>(p_state->m_lost_bytes.load())},
+        {"rotations", static_cast<double>(p_state->m_rotations.load())},
+    };
+    v8::Local<v8::Object> result = v8::Object::New(p_isolate);
+    for (const auto& [p_name, value] : values) {
+        result
+            ->Set(context,
+                  v8::String::NewFromUtf8(p_isolate, p_name).ToLocalChecked(),
+                  v8::Number::New(p_isolate, value))
+            .Check();
+    }
+    int32_t err_no = p_state->m_last_error.load();
+    if (err_no != 0) {
+        std::string msg = syscallErrorMessage(err_no, "write", p_state->m_path);
+        result
+            ->Set(context,
+                  v8::String::NewFromUtf8Literal(p_isolate, "lastError"),
+                  v8::String::NewFromUtf8(p_isolate, msg.c_str()).ToLocalChecked())
+            .Check();
+    }
+    args.GetReturnValue().Set(result);
+}
+
+static v8::Local<v8::Function> GetLogWriterClass(v8::Isolate* p_isolate, v8::Local<v8::Context> context) {
+    static v8::Persistent<v8::FunctionTemplate> s_tmpl;
+    if (s_tmpl.IsEmpty()) {
+        v8::Local<v8::FunctionTemplate> tmpl = v8::FunctionTemplate::New(p_isolate);
+        tmpl->SetClassName(v8::String::NewFromUtf8Literal(p_isolate, "LogWriter"));
+        tmpl->InstanceTemplate()->SetInternalFieldCount(1);
+        v8::Local<v8::ObjectTemplate> proto = tmpl->PrototypeTemplate();
+        const std::pair<const char*, v8::FunctionCallback> methods[] = {
+            {"write", LogWriterWrite},
+            {"flush", LogWriterFlush},
+            {"close", LogWriterClose},
+            {"stats", LogWriterStats},
+        };
+        for (const auto& [p_name, callback] : methods) {
+            proto->Set(v8::String::NewFromUtf8(p_isolate, p_name).ToLocalChecked(),
+                       v8::FunctionTemplate::New(p_isolate, callback));
+        }
+        s_tmpl.Reset(p_isolate, tmpl);
+    }
+    return s_tmpl.Get(p_isolate)->GetFunction(context).ToLocalChecked();
+}
+
+static double logOption(v8::Isolate* p_isolate,
+                        v8::Local<v8::Context> context,
+                        v8::Local<v8::Object> options,
+                        const char* p_name,
+                        double fallback) {
+    v8::Local<v8::Value> value;
+    if (!options->Get(context, v8::String::NewFromUtf8(p_isolate, p_name).ToLocalChecked()).ToLocal(&value) ||
+        !value->IsNumber())
+        return fallback;
+    double number = value.As<v8::Number>()->Value();
+    return number >= 0 ? number : fallback;
+}
+
+void FS::createLogWriter(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    v8::Local<v8::Context> context = p_isolate->GetCurrentContext();
+    if (args.Length() < 1 || !args[0]->IsString()) {
+        p_isolate->ThrowException(
+            v8::Exception::TypeError(v8::String::NewFromUtf8Literal(p_isolate, "Path must be a string")));
+        return;
+    }
+    v8::String::Utf8Value path(p_isolate, args[0]);
+    auto p_state = new LogWriterState();
+    p_state->m_path = *path;
+
+    size_t buffer_size = LOG_DEFAULT_BUFFER;
+    if (args.Length() >= 2 && args[1]->IsObject()) {
+        v8::Local<v8::Object> options = args[1].As<v8::Object>();
+        buffer_size = static_cast<size_t>(logOption(p_isolate, context, options, "bufferSize", LOG_DEFAULT_BUFFER));
+        p_state->m_flush_bytes =
+            static_cast<size_t>(logOption(p_isolate, context, options, "flushBytes", LOG_DEFAULT_FLUSH_BYTES));
+        p_state->m_flush_interval = std::chrono::milliseconds(
+            static_cast<int64_t>(logOption(p_isolate, context, options, "flushInterval", LOG_DEFAULT_FLUSH_MS)));
+        p_state->m_max_size = static_cast<uint64_t>(logOption(p_isolate, context, options, "maxSize", 0));
+        p_state->m_rotate_interval = std::chrono::milliseconds(
+            static_cast<int64_t>(logOption(p_isolate, context, options, "rotateInterval", 0)));
+        p_state->m_max_files =
+            static_cast<int32_t>(logOption(p_isolate, context, options, "maxFiles", LOG_DEFAULT_MAX_FILES));
+        v8::Local<v8::Value> overflow;
+        if (options->Get(context, v8::String::NewFromUtf8Literal(p_isolate, "overflow")).ToLocal(&overflow) &&
+            overflow->IsString()) {
+            v8::String::Utf8Value mode(p_isolate, overflow);
+            p_state->m_drop = *mode != nullptr && strcmp(*mode, "drop") == 0;
+        }
+    }
+    // The ring indexes with a mask, so its size is rounded up to a power of two.
+    size_t capacity = LOG_MIN_BUFFER;
+    while (capacity < buffer_size && capacity < (SIZE_MAX >> 1))
+        capacity <<= 1;
+    p_state->m_ring.resize(capacity);
+    p_state->m_mask = capacity - 1;
+    p_state->m_flush_bytes = std::min(std::max<size_t>(p_state->m_flush_bytes, 1), capacity);
+    if (p_state->m_flush_interval.count() == 0)
+        p_state->m_flush_interval = std::chrono::milliseconds(1);
+
+    p_state->m_fd = logOpen(p_state->m_path);
+    if (p_state->m_fd < 0) {
+        p_isolate->ThrowException(syscallError(p_isolate, errno, "open", p_state->m_path));
+        delete p_state;
+        return;
+    }
+    std::error_code ec;
+    p_state->m_file_size = fs::file_size(p_state->m_path, ec);
+    if (ec)
+        p_state->m_file_size = 0;
+    p_state->m_opened_at = std::chrono::steady_clock::now();
+
+    v8::Local<v8::Object> self = GetLogWriterClass(p_isolate, context)->NewInstance(context).ToLocalChecked();
+    self->SetInternalField(0, v8::External::New(p_isolate, p_state));
+    p_state->m_self.Reset(p_isolate, self);
+    logUpdateWeak(p_state);
+    {
+        std::lock_guard<std::mutex> lock(logWriterRegistry().m_mutex);
+        logWriterRegistry().m_writers.insert(p_state);
+    }
+    p_state->m_thread = std::thread(logFlusherLoop, p_state);
+    args.GetReturnValue().Set(self);
+}
+
 } // namespace module
 } // namespace z8
 
@@ -16,6 +16,11 @@ class FS {
     static v8::Local<v8::ObjectTemplate> createPromisesTemplate(v8::Isolate* p_isolate);
     static v8::Local<v8::Object>
     createStats(v8::Isolate* p_isolate, const std::filesystem::path& path, std::error_code& ec, bool follow_symlink);
+    // True while any persistent fs.watch/fs.watchFile watcher is open or a log writer has a pending
+    // flush()/close(); keeps the event loop alive.
+    static bool hasActiveWatchers();
+    // Raises the soft descriptor limit to the hard limit and sizes the fs open budget from it.
+    static void raiseFdLimit();
     static v8::Local<v8::Object> createDirent(v8::Isolate* p_isolate, const std::filesystem::directory_entry& entry);
     static v8::Local<v8::Object> createDir(v8::Isolate* p_isolate, const std::filesystem::path& path);
 
@@ -61,8 +66,13 @@ class FS {
     static void statfsSync(const v8::FunctionCallbackInfo<v8::Value>& args);
     static void lutimesSync(const v8::FunctionCallbackInfo<v8::Value>& args);
     static void opendirSync(const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void globSync(const v8::FunctionCallbackInfo<v8::Value>& args);
 
     static void readFilePromise(const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void readFileInlineStats(const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void openQueueStats(const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void setOpenQueueLimit(const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void groupCommitStats(const v8::FunctionCallbackInfo<v8::Value>& args);
     static void writeFilePromise(const v8::FunctionCallbackInfo<v8::Value>& args);
     static void statPromise(const v8::FunctionCallbackInfo<v8::Value>& args);
     static void unlinkPromise(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -97,8 +107,13 @@ class FS {
     static void statfsPromise(const v8::FunctionCallbackInfo<v8::Value>& args);
     static void lutimesPromise(const v8::FunctionCallbackInfo<v8::Value>& args);
     static void opendirPromise(const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void globPromise(const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void watchPromise(const v8::FunctionCallbackInfo<v8::Value>& args);
     static void readvPromise(const v8::FunctionCallbackInfo<v8::Value>& args);
     static void writevPromise(const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void readManyPromise(const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void statManyPromise(const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void writeManyPromise(const v8::FunctionCallbackInfo<v8::Value>& args);
 
     // Async methods (Callback-based)
     static void readFile(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -141,9 +156,18 @@ class FS {
     static void statfs(const v8::FunctionCallbackInfo<v8::Value>& args);
     static void lutimes(const v8::FunctionCallbackInfo<v8::Value>& args);
     static void opendir(const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void glob(const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void watch(const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void watchFile(const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void unwatchFile(const v8::FunctionCallbackInfo<v8::Value>& args);
  
     static void createReadStream(const v8::FunctionCallbackInfo<v8::Value>& args);
     static void createWriteStream(const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void createLogWriter(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+    static void enableStatCache(const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void clearStatCache(const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void statCacheStats(const v8::FunctionCallbackInfo<v8::Value>& args);
 };
 
 } // namespace module
@@ -1,6 +1,7 @@
 #include "process.h"
 #include "config.h"
 #include <chrono>
+#include <cstdio>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
@@ -50,6 +51,8 @@ v8::Local<v8::ObjectTemplate> Process::createTemplate(v8::Isolate* p_isolate) {
     tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "exit"), v8::FunctionTemplate::New(p_isolate, exit));
     tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "uptime"), v8::FunctionTemplate::New(p_isolate, uptime));
     tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "nextTick"), v8::FunctionTemplate::New(p_isolate, nextTick));
+    tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "emitWarning"),
+              v8::FunctionTemplate::New(p_isolate, emitWarning));
     tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "memoryUsage"), v8::FunctionTemplate::New(p_isolate, memoryUsage));
     
     v8::Local<v8::FunctionTemplate> hrtime_tmpl = v8::FunctionTemplate::New(p_isolate, hrtime);
@@ -597,6 +600,59 @@ void Process::stdinRead(const v8::FunctionCallbackInfo<v8::Value>& args) {
     }
 }
 
+void Process::writeWarning(const std::string& type, const std::string& message, const std::string& code) {
+#ifdef _WIN32
+    uint32_t pid = GetCurrentProcessId();
+#else
+    uint32_t pid = getpid();
+#endif
+    if (code.empty())
+        fprintf(stderr, "(node:%u) %s: %s\n", pid, type.c_str(), message.c_str());
+    else
+        fprintf(stderr, "(node:%u) [%s] %s: %s\n", pid, code.c_str(), type.c_str(), message.c_str());
+    fflush(stderr);
+}
+
+// process.emitWarning(warning[, type[, code]]) and emitWarning(warning, { type, code }).
+// An Error warning supplies its own name as the type.
+void Process::emitWarning(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    v8::Local<v8::Context> context = p_isolate->GetCurrentContext();
+    if (args.Length() < 1)
+        return;
+
+    auto read_string = [&](v8::Local<v8::Value> value, std::string& out) {
+        if (value->IsString())
+            out = *v8::String::Utf8Value(p_isolate, value);
+    };
+    auto read_property = [&](v8::Local<v8::Object> obj, const char* p_key, std::string& out) {
+        v8::Local<v8::Value> value;
+        if (obj->Get(context, v8::String::NewFromUtf8(p_isolate, p_key).ToLocalChecked()).ToLocal(&value))
+            read_string(value, out);
+    };
+
+    std::string type = "Warning";
+    std::string message;
+    std::string code;
+    if (args[0]->IsNativeError()) {
+        v8::Local<v8::Object> error = args[0].As<v8::Object>();
+        read_property(error, "name", type);
+        read_property(error, "message", message);
+    } else {
+        message = *v8::String::Utf8Value(p_isolate, args[0]);
+    }
+    if (args.Length() > 1 && args[1]->IsObject() && !args[1]->IsFunction()) {
+        read_property(args[1].As<v8::Object>(), "type", type);
+        read_property(args[1].As<v8::Object>(), "code", code);
+    } else {
+        if (args.Length() > 1)
+            read_string(args[1], type);
+        if (args.Length() > 2)
+            read_string(args[2], code);
+    }
+    writeWarning(type, message, code);
+}
+
 void Process::on(const v8::FunctionCallbackInfo<v8::Value>& args) {
     args.GetReturnValue().Set(args.This());
 }
@@ -18,6 +18,10 @@ class Process {
     // Setup global state (call once)
     static void setArgv(int32_t argc, char* argv[]);
 
+    // Prints a process warning the way Node does ("(node:<pid>) Warning: ..." on stderr).
+    // It does not enter JS, so GC callbacks may call it.
+    static void writeWarning(const std::string& type, const std::string& message, const std::string& code = "");
+
     private:
     static void cwd(const v8::FunctionCallbackInfo<v8::Value>& args);
     static void chdir(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -33,6 +37,7 @@ class Process {
     static void umask(const v8::FunctionCallbackInfo<v8::Value>& args);
     static void cpuUsage(const v8::FunctionCallbackInfo<v8::Value>& args);
     static void resourceUsage(const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void emitWarning(const v8::FunctionCallbackInfo<v8::Value>& args);
     
     // Event Emitter (Stubs for now)
     static void on(const v8::FunctionCallbackInfo<v8::Value>& args);
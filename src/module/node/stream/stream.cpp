@@ -1,4 +1,5 @@
 #include "stream.h"
+#include "../buffer/buffer.h"
 #include "task_queue.h"
 #include <algorithm>
 #include <cstdio>
@@ -183,6 +184,18 @@ void Stream::readableConstructor(const v8::FunctionCallbackInfo<v8::Value>& args
         if (options->Get(context, v8::String::NewFromUtf8Literal(p_isolate, "read")).ToLocal(&read_fn) && read_fn->IsFunction()) {
             (void)self->Set(context, v8::String::NewFromUtf8Literal(p_isolate, "_read"), read_fn);
         }
+        v8::Local<v8::Value> encoding;
+        if (!options->Get(context, v8::String::NewFromUtf8Literal(p_isolate, "encoding")).ToLocal(&encoding)) {
+            delete p_internal;
+            return;
+        }
+        if (!encoding->IsNullOrUndefined()) {
+            p_internal->up_decoder = StringDecoder::fromValue(p_isolate, encoding);
+            if (!p_internal->up_decoder) {
+                delete p_internal;
+                return;
+            }
+        }
     }
 
     self->SetInternalField(0, v8::External::New(p_isolate, p_internal));
@@ -211,32 +224,69 @@ void Stream::readableRead(const v8::FunctionCallbackInfo<v8::Value>& args) {
     args.GetReturnValue().Set(v8::Undefined(p_isolate));
 }
 
+// Emits 'end' on a readable, preceded by a last 'data' with whatever character the decoder was
+// still holding from an unfinished chunk. Every path that ends a readable goes through here.
+static void emitEnd(v8::Isolate* p_isolate,
+                    v8::Local<v8::Context> context,
+                    v8::Local<v8::Object> self,
+                    StreamInternal* p_internal) {
+    v8::Local<v8::Value> emit_val;
+    if (!self->Get(context, v8::String::NewFromUtf8Literal(p_isolate, "emit")).ToLocal(&emit_val) || !emit_val->IsFunction())
+        return;
+    if (p_internal && p_internal->up_decoder) {
+        v8::Local<v8::String> rest;
+        if (!p_internal->up_decoder->end(p_isolate).ToLocal(&rest)) {
+            p_isolate->ThrowException(Buffer::stringTooLongError(p_isolate));
+            return;
+        }
+        if (rest->Length() > 0) {
+            v8::Local<v8::Value> data_argv[] = { v8::String::NewFromUtf8Literal(p_isolate, "data"), rest };
+            (void)emit_val.As<v8::Function>()->Call(context, self, 2, data_argv);
+        }
+    }
+    v8::Local<v8::Value> argv[] = { v8::String::NewFromUtf8Literal(p_isolate, "end") };
+    (void)emit_val.As<v8::Function>()->Call(context, self, 1, argv);
+}
+
 void Stream::readablePush(const v8::FunctionCallbackInfo<v8::Value>& args) {
     v8::Isolate* p_isolate = args.GetIsolate();
     v8::Local<v8::Context> context = p_isolate->GetCurrentContext();
     v8::Local<v8::Object> self = args.This();
+    v8::Local<v8::External> ext = self->GetInternalField(0).As<v8::External>();
+    StreamInternal* p_internal = static_cast<StreamInternal*>(ext->Value());
     
     if (args.Length() == 0 || args[0]->IsNull()) {
         // EOF
-        v8::Local<v8::Value> emit_val;
-        if (self->Get(context, v8::String::NewFromUtf8Literal(p_isolate, "emit")).ToLocal(&emit_val) && emit_val->IsFunction()) {
-            v8::Local<v8::Value> argv[] = { v8::String::NewFromUtf8Literal(p_isolate, "end") };
-            (void)emit_val.As<v8::Function>()->Call(context, self, 1, argv);
-        }
+        emitEnd(p_isolate, context, self, p_internal);
+        p_internal->close();
         args.GetReturnValue().Set(false);
         return;
     }
 
+    // With an encoding set, bytes become text here, straight from the chunk. Strings are taken
+    // as already decoded, and a chunk that only carried part of a character emits nothing.
+    v8::Local<v8::Value> chunk = args[0];
+    const uint8_t* p_bytes = nullptr;
+    size_t length = 0;
+    if (p_internal->up_decoder && chunk->IsArrayBufferView() && Buffer::binaryBytes(chunk, p_bytes, length)) {
+        v8::Local<v8::String> text;
+        if (!p_internal->up_decoder->write(p_isolate, p_bytes, length).ToLocal(&text)) {
+            p_isolate->ThrowException(Buffer::stringTooLongError(p_isolate));
+            return;
+        }
+        chunk = text;
+    }
+
     // Emit 'data'
     v8::Local<v8::Value> emit_val;
-    if (self->Get(context, v8::String::NewFromUtf8Literal(p_isolate, "emit")).ToLocal(&emit_val) && emit_val->IsFunction()) {
-        v8::Local<v8::Value> argv[] = { v8::String::NewFromUtf8Literal(p_isolate, "data"), args[0] };
+    bool empty = p_internal->up_decoder && chunk->IsString() && chunk.As<v8::String>()->Length() == 0;
+    if (!empty && self->Get(context, v8::String::NewFromUtf8Literal(p_isolate, "emit")).ToLocal(&emit_val)
+        && emit_val->IsFunction()) {
+        v8::Local<v8::Value> argv[] = { v8::String::NewFromUtf8Literal(p_isolate, "data"), chunk };
         (void)emit_val.As<v8::Function>()->Call(context, self, 2, argv);
     }
 
     // If not paused, schedule another read to ensure continuous data flow
-    v8::Local<v8::External> ext = self->GetInternalField(0).As<v8::External>();
-    StreamInternal* p_internal = static_cast<StreamInternal*>(ext->Value());
     if (!p_internal->m_paused) {
         z8::Task* p_task = new z8::Task();
         p_task->p_data = new v8::Global<v8::Object>(p_isolate, self); // Pass the stream object
@@ -297,8 +347,16 @@ void Stream::readableResume(const v8::FunctionCallbackInfo<v8::Value>& args) {
 }
 
 void Stream::readableSetEncoding(const v8::FunctionCallbackInfo<v8::Value>& args) {
-    // Simplified: we don't store encoding in StreamInternal yet
-    args.GetReturnValue().Set(args.This());
+    v8::Isolate* p_isolate = args.GetIsolate();
+    v8::Local<v8::Object> self = args.This();
+    v8::Local<v8::External> ext = self->GetInternalField(0).As<v8::External>();
+    StreamInternal* p_internal = static_cast<StreamInternal*>(ext->Value());
+    std::unique_ptr<StringDecoder> up_decoder =
+        StringDecoder::fromValue(p_isolate, args.Length() > 0 ? args[0] : v8::Undefined(p_isolate).As<v8::Value>());
+    if (!up_decoder)
+        return;
+    p_internal->up_decoder = std::move(up_decoder);
+    args.GetReturnValue().Set(self);
 }
 
 // Data structure to hold V8 Global handles for Readable.from task
@@ -403,6 +461,9 @@ void Stream::readableDestroy(const v8::FunctionCallbackInfo<v8::Value>& args) {
     v8::Isolate* p_isolate = args.GetIsolate();
     v8::Local<v8::Context> context = p_isolate->GetCurrentContext();
     v8::Local<v8::Object> self = args.This();
+    v8::Local<v8::External> ext = self->GetInternalField(0).As<v8::External>();
+    StreamInternal* p_internal = static_cast<StreamInternal*>(ext->Value());
+    p_internal->close();
     
     v8::Local<v8::Value> emit_val;
     if (self->Get(context, v8::String::NewFromUtf8Literal(p_isolate, "emit")).ToLocal(&emit_val) && emit_val->IsFunction()) {
@@ -570,6 +631,7 @@ void Stream::writableEnd(const v8::FunctionCallbackInfo<v8::Value>& args) {
                 v8::Local<v8::Value> argv[] = { v8::String::NewFromUtf8Literal(p_isolate, "finish") };
                 (void)emit_val.As<v8::Function>()->Call(context, self, 1, argv);
             }
+            p_internal->close();
         }, self).ToLocalChecked();
         
         v8::Local<v8::Value> flush_argv[] = { flush_cb };
@@ -581,6 +643,7 @@ void Stream::writableEnd(const v8::FunctionCallbackInfo<v8::Value>& args) {
             v8::Local<v8::Value> argv[] = { v8::String::NewFromUtf8Literal(p_isolate, "finish") };
             (void)emit_val.As<v8::Function>()->Call(context, self, 1, argv);
         }
+        p_internal->close();
     }
 
     if (args.Length() > 0 && args[args.Length()-1]->IsFunction()) {
@@ -595,6 +658,9 @@ void Stream::writableDestroy(const v8::FunctionCallbackInfo<v8::Value>& args) {
     v8::Isolate* p_isolate = args.GetIsolate();
     v8::Local<v8::Context> context = p_isolate->GetCurrentContext();
     v8::Local<v8::Object> self = args.This();
+    v8::Local<v8::External> ext = self->GetInternalField(0).As<v8::External>();
+    StreamInternal* p_internal = static_cast<StreamInternal*>(ext->Value());
+    p_internal->close();
     
     v8::Local<v8::Value> emit_val;
     if (self->Get(context, v8::String::NewFromUtf8Literal(p_isolate, "emit")).ToLocal(&emit_val) && emit_val->IsFunction()) {
@@ -1135,7 +1201,15 @@ void Stream::getReadableLength(const v8::FunctionCallbackInfo<v8::Value>& args)
 
 void Stream::getReadableEncoding(const v8::FunctionCallbackInfo<v8::Value>& args) {
     v8::Isolate* p_isolate = args.GetIsolate();
-    args.GetReturnValue().Set(v8::Null(p_isolate));
+    v8::Local<v8::Object> self = args.This();
+    v8::Local<v8::External> ext = self->GetInternalField(0).As<v8::External>();
+    StreamInternal* p_internal = static_cast<StreamInternal*>(ext->Value());
+    if (!p_internal->up_decoder) {
+        args.GetReturnValue().Set(v8::Null(p_isolate));
+        return;
+    }
+    const std::string& encoding = p_internal->up_decoder->encoding();
+    args.GetReturnValue().Set(v8::String::NewFromUtf8(p_isolate, encoding.c_str()).ToLocalChecked());
 }
 
 void Stream::getReadableEnded(const v8::FunctionCallbackInfo<v8::Value>& args) {
@@ -1226,11 +1300,8 @@ void Stream::readableUnshift(const v8::FunctionCallbackInfo<v8::Value>& args) {
     
     // If null, signal EOF
     if (chunk->IsNull()) {
-        v8::Local<v8::Value> emit_val;
-        if (self->Get(context, v8::String::NewFromUtf8Literal(p_isolate, "emit")).ToLocal(&emit_val) && emit_val->IsFunction()) {
-            v8::Local<v8::Value> argv[] = { v8::String::NewFromUtf8Literal(p_isolate, "end") };
-            (void)emit_val.As<v8::Function>()->Call(context, self, 1, argv);
-        }
+        v8::Local<v8::External> ext = self->GetInternalField(0).As<v8::External>();
+        emitEnd(p_isolate, context, self, static_cast<StreamInternal*>(ext->Value()));
         return;
     }
     
@@ -1515,18 +1586,11 @@ void Stream::passThroughConstructor(const v8::FunctionCallbackInfo<v8::Value>& a
         }
         
         // Emit 'end' event
-        v8::Local<v8::Value> emit_val;
-        if (self->Get(context, v8::String::NewFromUtf8Literal(p_isolate, "emit")).ToLocal(&emit_val) && emit_val->IsFunction()) {
-            v8::Local<v8::Function> emit_fn = emit_val.As<v8::Function>();
-            v8::Local<v8::Value> emit_argv[] = {
-                v8::String::NewFromUtf8Literal(p_isolate, "end")
-            };
-            (void)emit_fn->Call(context, self, 1, emit_argv);
-        }
-        
-        // Mark as ended
         v8::Local<v8::External> ext = self->GetInternalField(0).As<v8::External>();
         StreamInternal* p_internal = static_cast<StreamInternal*>(ext->Value());
+        emitEnd(p_isolate, context, self, p_internal);
+        
+        // Mark as ended
         p_internal->m_ended = true;
     };
     
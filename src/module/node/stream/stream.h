@@ -3,8 +3,10 @@
 
 #include "v8.h"
 #include "../events/events.h"
+#include "../string_decoder/string_decoder.h"
 #include <vector> // Added for std::vector
 #include <cstdint>
+#include <memory>
 
 namespace z8 {
 namespace module {
@@ -30,6 +32,11 @@ struct StreamInternal {
     std::vector<uint8_t> m_buffer;
     uint64_t m_bytes_read = 0;
     uint64_t m_bytes_written = 0;
+    // Set by setEncoding or the encoding option; pushed bytes are decoded as they arrive.
+    std::unique_ptr<StringDecoder> up_decoder;
+
+    // Runs when the stream ends, finishes or is destroyed; streams over a resource release it here.
+    virtual void close() {}
 };
 
 class Stream {
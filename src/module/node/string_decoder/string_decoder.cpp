@@ -0,0 +1,421 @@
+#include "string_decoder.h"
+#include "../buffer/buffer.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <memory>
+#include <string>
+
+namespace z8 {
+namespace module {
+
+v8::Persistent<v8::FunctionTemplate> StringDecoder::m_decoder_tmpl;
+
+// What is held back between chunks: characters for UTF-8 and UTF-16, 3-byte groups for base64.
+// The other encodings map every byte on its own and hold nothing.
+static constexpr uint8_t KIND_UTF8 = 0;
+static constexpr uint8_t KIND_UTF16 = 1;
+static constexpr uint8_t KIND_BASE64 = 2;
+static constexpr uint8_t KIND_BYTES = 3;
+
+// A StringDecoder object's decoder, freed with the object.
+struct DecoderHandle {
+    StringDecoder m_decoder;
+    v8::Global<v8::Object> m_self;
+
+    explicit DecoderHandle(const std::string& encoding) : m_decoder(encoding) {}
+};
+
+static void decoderWeak(const v8::WeakCallbackInfo<DecoderHandle>& data) {
+    DecoderHandle* p_handle = data.GetParameter();
+    p_handle->m_self.Reset();
+    delete p_handle;
+}
+
+static StringDecoder* getDecoder(v8::Local<v8::Object> self) {
+    if (self->InternalFieldCount() < 1)
+        return nullptr;
+    v8::Local<v8::Value> field = self->GetInternalField(0).As<v8::Value>();
+    if (!field->IsExternal())
+        return nullptr;
+    return &static_cast<DecoderHandle*>(field.As<v8::External>()->Value())->m_decoder;
+}
+
+// TypeError carrying the Node error code.
+static void throwCodedError(v8::Isolate* p_isolate, const char* p_code, const std::string& message) {
+    v8::Local<v8::Context> context = p_isolate->GetCurrentContext();
+    v8::Local<v8::String> text = v8::String::NewFromUtf8(p_isolate, message.c_str()).ToLocalChecked();
+    v8::Local<v8::Object> error = v8::Exception::TypeError(text).As<v8::Object>();
+    (void) error->Set(context,
+                      v8::String::NewFromUtf8Literal(p_isolate, "code"),
+                      v8::String::NewFromUtf8(p_isolate, p_code).ToLocalChecked());
+    p_isolate->ThrowException(error);
+}
+
+static void throwStringTooLong(v8::Isolate* p_isolate) {
+    p_isolate->ThrowException(Buffer::stringTooLongError(p_isolate));
+}
+
+// The bytes of a write()/end() argument, which has to be an ArrayBuffer view.
+static bool chunkBytes(v8::Isolate* p_isolate, v8::Local<v8::Value> value, const uint8_t*& p_data, size_t& length) {
+    if (value->IsArrayBufferView() && Buffer::binaryBytes(value, p_data, length))
+        return true;
+    throwCodedError(p_isolate,
+                    "ERR_INVALID_ARG_TYPE",
+                    "The \"buf\" argument must be an instance of Buffer, TypedArray, or DataView.");
+    return false;
+}
+
+// ---- Decoding ----
+
+std::string StringDecoder::normalizeEncoding(const std::string& encoding) {
+    std::string name = encoding;
+    std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) {
+        return static_cast<char>(std::tolower(c));
+    });
+    if (name.empty() || name == "utf8" || name == "utf-8")
+        return "utf8";
+    if (name == "ucs2" || name == "ucs-2" || name == "utf16le" || name == "utf-16le")
+        return "utf16le";
+    if (name == "latin1" || name == "binary")
+        return "latin1";
+    if (name == "ascii" || name == "base64" || name == "base64url" || name == "hex")
+        return name;
+    return "";
+}
+
+std::unique_ptr<StringDecoder> StringDecoder::fromValue(v8::Isolate* p_isolate, v8::Local<v8::Value> encoding) {
+    if (encoding->IsNullOrUndefined())
+        return std::make_unique<StringDecoder>("utf8");
+    v8::Local<v8::String> name;
+    if (!encoding->ToString(p_isolate->GetCurrentContext()).ToLocal(&name))
+        return nullptr;
+    v8::String::Utf8Value name_utf8(p_isolate, name);
+    std::string name_str(*name_utf8, name_utf8.length());
+    std::string normalized = encoding->IsString() ? normalizeEncoding(name_str) : "";
+    if (normalized.empty()) {
+        throwCodedError(p_isolate, "ERR_UNKNOWN_ENCODING", "Unknown encoding: " + name_str);
+        return nullptr;
+    }
+    return std::make_unique<StringDecoder>(normalized);
+}
+
+static void freeBuffered(void* p_data, size_t length, void* p_deleter_data) {
+    delete[] static_cast<uint8_t*>(p_data);
+}
+
+StringDecoder::StringDecoder(const std::string& encoding) : m_encoding(encoding) {
+    p_buffered = new uint8_t[4]();
+    sp_buffered = v8::ArrayBuffer::NewBackingStore(p_buffered, 4, freeBuffered, nullptr);
+    if (encoding == "utf8")
+        m_kind = KIND_UTF8;
+    else if (encoding == "utf16le")
+        m_kind = KIND_UTF16;
+    else if (encoding == "base64" || encoding == "base64url")
+        m_kind = KIND_BASE64;
+    else
+        m_kind = KIND_BYTES;
+}
+
+v8::MaybeLocal<v8::String> StringDecoder::decode(v8::Isolate* p_isolate, const uint8_t* p_data, size_t length) const {
+    if (m_kind == KIND_UTF8)
+        return Buffer::decodeUtf8(p_isolate, p_data, length);
+    if (m_kind == KIND_UTF16)
+        return Buffer::decodeUtf16(p_isolate, p_data, length / 2);
+    return Buffer::decodeBytes(p_isolate, m_encoding, p_data, length);
+}
+
+// Held UTF-8 that stopped short gets one U+FFFD per maximal subpart (Unicode 3.9): the lead byte
+// and the continuation bytes the lead allows (Table 3-7) go together, any other byte on its own.
+// Node does the same, so F0 80 is two replacements but F0 90 only one. V8's decoder would not
+// agree on every prefix, so the replacements are written out before decoding.
+v8::MaybeLocal<v8::String> StringDecoder::decodeBuffered(v8::Isolate* p_isolate, size_t length) const {
+    if (m_kind != KIND_UTF8)
+        return decode(p_isolate, p_buffered, length);
+    uint8_t text[12];
+    size_t text_length = 0;
+    for (size_t i = 0; i < length;) {
+        uint8_t lead = p_buffered[i];
+        size_t total = lead >= 0xC2 && lead <= 0xDF   ? 2
+                       : lead >= 0xE0 && lead <= 0xEF ? 3
+                       : lead >= 0xF0 && lead <= 0xF4 ? 4
+                                                      : 1;
+        uint8_t low = lead == 0xE0 ? 0xA0 : lead == 0xF0 ? 0x90 : 0x80;
+        uint8_t high = lead == 0xED ? 0x9F : lead == 0xF4 ? 0x8F : 0xBF;
+        size_t run = 1;
+        if (total > 1 && i + 1 < length && p_buffered[i + 1] >= low && p_buffered[i + 1] <= high) {
+            run = 2;
+            while (run < total && i + run < length && (p_buffered[i + run] & 0xC0) == 0x80)
+                run++;
+        }
+        if (lead < 0x80 || (total > 1 && run == total)) {
+            std::memcpy(text + text_length, p_buffered + i, run);
+            text_length += run;
+        } else {
+            text[text_length++] = 0xEF;
+            text[text_length++] = 0xBF;
+            text[text_length++] = 0xBD;
+        }
+        i += run;
+    }
+    return Buffer::decodeUtf8(p_isolate, text, text_length);
+}
+
+// Node's rules, so each chunk yields the same text it does there. UTF-8 goes back from the last
+// byte over continuation bytes to the lead byte, whose high bits give the character's length;
+// UTF-16 holds an odd byte or a final high surrogate.
+size_t StringDecoder::unfinished(const uint8_t* p_data, size_t length) {
+    m_missing = 0;
+    if (m_kind == KIND_UTF8) {
+        if (!(p_data[length - 1] & 0x80))
+            return 0;
+        for (size_t i = length - 1, held = 1;; i--, held++) {
+            uint8_t byte = p_data[i];
+            if ((byte & 0xC0) == 0x80) {
+                if (held >= 4 || i == 0)
+                    return 0;
+                continue;
+            }
+            size_t total = (byte & 0xE0) == 0xC0 ? 2 : (byte & 0xF0) == 0xE0 ? 3 : (byte & 0xF8) == 0xF0 ? 4 : 0;
+            if (held >= total)
+                return 0;
+            m_missing = static_cast<uint8_t>(total - held);
+            return held;
+        }
+    }
+    if (m_kind == KIND_UTF16) {
+        if (length % 2 == 1) {
+            m_missing = 1;
+            return 1;
+        }
+        if ((p_data[length - 1] & 0xFC) == 0xD8) {
+            m_missing = 2;
+            return 2;
+        }
+        return 0;
+    }
+    if (m_kind == KIND_BASE64) {
+        size_t held = length % 3;
+        m_missing = static_cast<uint8_t>(held ? 3 - held : 0);
+        return held;
+    }
+    return 0;
+}
+
+v8::MaybeLocal<v8::String> StringDecoder::write(v8::Isolate* p_isolate, const uint8_t* p_data, size_t length) {
+    // Finish the character held back from the previous chunk first. In UTF-8 a byte that does
+    // not continue it ends it early and starts the next character, as V8's decoder would see it.
+    v8::Local<v8::String> prepend;
+    if (m_missing > 0) {
+        if (m_kind == KIND_UTF8) {
+            for (size_t i = 0; i < length && i < m_missing; i++) {
+                if ((p_data[i] & 0xC0) != 0x80) {
+                    std::memcpy(p_buffered + m_buffered_length, p_data, i);
+                    m_buffered_length += static_cast<uint8_t>(i);
+                    p_data += i;
+                    length -= i;
+                    m_missing = 0;
+                    break;
+                }
+            }
+        }
+        size_t found = std::min(length, static_cast<size_t>(m_missing));
+        std::memcpy(p_buffered + m_buffered_length, p_data, found);
+        p_data += found;
+        length -= found;
+        m_missing -= static_cast<uint8_t>(found);
+        m_buffered_length += static_cast<uint8_t>(found);
+        if (m_missing > 0)
+            return v8::String::Empty(p_isolate);
+        if (!decodeBuffered(p_isolate, m_buffered_length).ToLocal(&prepend))
+            return {};
+        m_buffered_length = 0;
+    }
+
+    v8::Local<v8::String> body = v8::String::Empty(p_isolate);
+    if (length > 0) {
+        size_t held = unfinished(p_data, length);
+        length -= held;
+        std::memcpy(p_buffered, p_data + length, held);
+        m_buffered_length = static_cast<uint8_t>(held);
+        if (length > 0 && !decode(p_isolate, p_data, length).ToLocal(&body))
+            return {};
+    }
+    if (prepend.IsEmpty())
+        return body;
+    return v8::String::Concat(p_isolate, prepend, body);
+}
+
+v8::MaybeLocal<v8::String> StringDecoder::end(v8::Isolate* p_isolate) {
+    // A lone trailing byte of UTF-16 is dropped, as Node does.
+    if (m_kind == KIND_UTF16 && m_buffered_length % 2 == 1)
+        m_buffered_length--;
+    size_t length = m_buffered_length;
+    m_buffered_length = 0;
+    m_missing = 0;
+    if (length == 0)
+        return v8::String::Empty(p_isolate);
+    return decodeBuffered(p_isolate, length);
+}
+
+// ---- Templates ----
+
+v8::Local<v8::ObjectTemplate> StringDecoder::createTemplate(v8::Isolate* p_isolate) {
+    v8::Local<v8::ObjectTemplate> tmpl = v8::ObjectTemplate::New(p_isolate);
+    tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "StringDecoder"), getDecoderTemplate(p_isolate));
+    return tmpl;
+}
+
+v8::Local<v8::FunctionTemplate> StringDecoder::getDecoderTemplate(v8::Isolate* p_isolate) {
+    if (m_decoder_tmpl.IsEmpty()) {
+        v8::Local<v8::FunctionTemplate> tmpl = v8::FunctionTemplate::New(p_isolate, decoderConstructor);
+        tmpl->SetClassName(v8::String::NewFromUtf8Literal(p_isolate, "StringDecoder"));
+        tmpl->InstanceTemplate()->SetInternalFieldCount(1);
+        v8::Local<v8::ObjectTemplate> proto = tmpl->PrototypeTemplate();
+        proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "write"),
+                   v8::FunctionTemplate::New(p_isolate, decoderWrite));
+        proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "end"), v8::FunctionTemplate::New(p_isolate, decoderEnd));
+        proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "text"),
+                   v8::FunctionTemplate::New(p_isolate, decoderText));
+        proto->SetAccessorProperty(v8::String::NewFromUtf8Literal(p_isolate, "lastChar"),
+                                   v8::FunctionTemplate::New(p_isolate, getLastChar));
+        proto->SetAccessorProperty(v8::String::NewFromUtf8Literal(p_isolate, "lastNeed"),
+                                   v8::FunctionTemplate::New(p_isolate, getLastNeed));
+        proto->SetAccessorProperty(v8::String::NewFromUtf8Literal(p_isolate, "lastTotal"),
+                                   v8::FunctionTemplate::New(p_isolate, getLastTotal));
+        m_decoder_tmpl.Reset(p_isolate, tmpl);
+    }
+    return m_decoder_tmpl.Get(p_isolate);
+}
+
+// ---- StringDecoder ----
+
+void StringDecoder::decoderConstructor(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    v8::Local<v8::Context> context = p_isolate->GetCurrentContext();
+    if (!args.IsConstructCall()) {
+        p_isolate->ThrowException(v8::Exception::TypeError(v8::String::NewFromUtf8Literal(
+            p_isolate, "Class constructor StringDecoder cannot be invoked without 'new'")));
+        return;
+    }
+    std::unique_ptr<StringDecoder> up_decoder =
+        fromValue(p_isolate, args.Length() > 0 ? args[0] : v8::Undefined(p_isolate).As<v8::Value>());
+    if (!up_decoder)
+        return;
+    const std::string& encoding = up_decoder->encoding();
+
+    v8::Local<v8::Object> self = args.This();
+    auto p_handle = new DecoderHandle(encoding);
+    p_handle->m_self.Reset(p_isolate, self);
+    p_handle->m_self.SetWeak(p_handle, decoderWeak, v8::WeakCallbackType::kParameter);
+    self->SetInternalField(0, v8::External::New(p_isolate, p_handle));
+    (void) self->Set(context,
+                     v8::String::NewFromUtf8Literal(p_isolate, "encoding"),
+                     v8::String::NewFromUtf8(p_isolate, encoding.c_str()).ToLocalChecked());
+    args.GetReturnValue().Set(self);
+}
+
+// Strings are returned as they are, as in Node.
+void StringDecoder::decoderWrite(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    v8::Local<v8::Value> chunk = args.Length() > 0 ? args[0] : v8::Undefined(p_isolate).As<v8::Value>();
+    if (chunk->IsString()) {
+        args.GetReturnValue().Set(chunk);
+        return;
+    }
+    const uint8_t* p_data = nullptr;
+    size_t length = 0;
+    if (!chunkBytes(p_isolate, chunk, p_data, length))
+        return;
+    StringDecoder* p_decoder = getDecoder(args.This());
+    if (!p_decoder) {
+        throwCodedError(p_isolate, "ERR_INVALID_THIS", "Value of \"this\" must be of type StringDecoder");
+        return;
+    }
+    v8::Local<v8::String> result;
+    if (!p_decoder->write(p_isolate, p_data, length).ToLocal(&result)) {
+        throwStringTooLong(p_isolate);
+        return;
+    }
+    args.GetReturnValue().Set(result);
+}
+
+void StringDecoder::decoderEnd(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    StringDecoder* p_decoder = getDecoder(args.This());
+    if (!p_decoder) {
+        throwCodedError(p_isolate, "ERR_INVALID_THIS", "Value of \"this\" must be of type StringDecoder");
+        return;
+    }
+    v8::Local<v8::String> result = v8::String::Empty(p_isolate);
+    if (args.Length() > 0 && !args[0]->IsUndefined()) {
+        if (args[0]->IsString()) {
+            result = args[0].As<v8::String>();
+        } else {
+            const uint8_t* p_data = nullptr;
+            size_t length = 0;
+            if (!chunkBytes(p_isolate, args[0], p_data, length))
+                return;
+            if (!p_decoder->write(p_isolate, p_data, length).ToLocal(&result)) {
+                throwStringTooLong(p_isolate);
+                return;
+            }
+        }
+    }
+    v8::Local<v8::String> rest;
+    if (!p_decoder->end(p_isolate).ToLocal(&rest)) {
+        throwStringTooLong(p_isolate);
+        return;
+    }
+    args.GetReturnValue().Set(rest->Length() > 0 ? v8::String::Concat(p_isolate, result, rest) : result);
+}
+
+// Legacy text(buf, offset): drops anything held back and decodes buf from offset.
+void StringDecoder::decoderText(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    v8::Local<v8::Context> context = p_isolate->GetCurrentContext();
+    StringDecoder* p_decoder = getDecoder(args.This());
+    if (!p_decoder) {
+        throwCodedError(p_isolate, "ERR_INVALID_THIS", "Value of \"this\" must be of type StringDecoder");
+        return;
+    }
+    const uint8_t* p_data = nullptr;
+    size_t length = 0;
+    if (!chunkBytes(p_isolate, args.Length() > 0 ? args[0] : v8::Undefined(p_isolate).As<v8::Value>(), p_data, length))
+        return;
+    int64_t offset = 0;
+    if (args.Length() > 1 && !args[1]->IntegerValue(context).To(&offset))
+        return;
+    if (offset < 0)
+        offset = std::max<int64_t>(0, static_cast<int64_t>(length) + offset);
+    size_t start = std::min(static_cast<size_t>(offset), length);
+    p_decoder->m_buffered_length = 0;
+    p_decoder->m_missing = 0;
+    v8::Local<v8::String> result;
+    if (!p_decoder->write(p_isolate, p_data + start, length - start).ToLocal(&result)) {
+        throwStringTooLong(p_isolate);
+        return;
+    }
+    args.GetReturnValue().Set(result);
+}
+
+void StringDecoder::getLastChar(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    StringDecoder* p_decoder = getDecoder(args.This());
+    if (p_decoder)
+        args.GetReturnValue().Set(Buffer::viewBuffer(args.GetIsolate(), p_decoder->sp_buffered));
+}
+
+void StringDecoder::getLastNeed(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    StringDecoder* p_decoder = getDecoder(args.This());
+    if (p_decoder)
+        args.GetReturnValue().Set(static_cast<uint32_t>(p_decoder->m_missing));
+}
+
+void StringDecoder::getLastTotal(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    StringDecoder* p_decoder = getDecoder(args.This());
+    if (p_decoder)
+        args.GetReturnValue().Set(static_cast<uint32_t>(p_decoder->m_buffered_length + p_decoder->m_missing));
+}
+
+} // namespace module
+} // namespace z8
@@ -0,0 +1,74 @@
+#ifndef Z8_MODULE_STRING_DECODER_H
+#define Z8_MODULE_STRING_DECODER_H
+
+#include "v8.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace z8 {
+namespace module {
+
+// node:string_decoder. Turns a byte stream into text chunk by chunk without splitting
+// characters: the bytes of a UTF-8 or UTF-16 character, or of a base64 group, cut off at the end
+// of a chunk are kept (never more than four) and finished by the next one. Everything else is
+// converted straight from the chunk by the Buffer decoders. Readable#setEncoding decodes with
+// the same class.
+class StringDecoder {
+  public:
+    // Node's name for an encoding ("utf8", "utf16le", "latin1", "ascii", "base64", "base64url"
+    // or "hex"), ignoring case. "utf8" when encoding is empty, "" when it is not an encoding.
+    static std::string normalizeEncoding(const std::string& encoding);
+
+    // The decoder for a JS encoding argument, undefined and null meaning UTF-8. Throws
+    // ERR_UNKNOWN_ENCODING and returns null when the value does not name an encoding.
+    static std::unique_ptr<StringDecoder> fromValue(v8::Isolate* p_isolate, v8::Local<v8::Value> encoding);
+
+    // encoding must be a name normalizeEncoding returned.
+    explicit StringDecoder(const std::string& encoding);
+
+    const std::string& encoding() const {
+        return m_encoding;
+    }
+    // The text of length more bytes, holding back an unfinished character at the end.
+    v8::MaybeLocal<v8::String> write(v8::Isolate* p_isolate, const uint8_t* p_data, size_t length);
+    // The held-back bytes decoded as they are (U+FFFD for a cut-off UTF-8 character); the
+    // decoder is then empty.
+    v8::MaybeLocal<v8::String> end(v8::Isolate* p_isolate);
+
+    static v8::Local<v8::ObjectTemplate> createTemplate(v8::Isolate* p_isolate);
+    static v8::Local<v8::FunctionTemplate> getDecoderTemplate(v8::Isolate* p_isolate);
+
+    // StringDecoder class
+    static void decoderConstructor(const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void decoderWrite(const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void decoderEnd(const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void decoderText(const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void getLastChar(const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void getLastNeed(const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void getLastTotal(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+  private:
+    v8::MaybeLocal<v8::String> decode(v8::Isolate* p_isolate, const uint8_t* p_data, size_t length) const;
+    // The held-back bytes as text, once they are finished or can no longer be.
+    v8::MaybeLocal<v8::String> decodeBuffered(v8::Isolate* p_isolate, size_t length) const;
+    // Bytes to hold back from the end of length bytes that start on a character boundary.
+    size_t unfinished(const uint8_t* p_data, size_t length);
+
+    std::string m_encoding;
+    uint8_t m_kind = 0;
+    // The held-back bytes, how many there are, and how many more finish the character. The four
+    // bytes live in a backing store so that lastChar can be a view of them, as it is in Node.
+    std::shared_ptr<v8::BackingStore> sp_buffered;
+    uint8_t* p_buffered = nullptr;
+    uint8_t m_buffered_length = 0;
+    uint8_t m_missing = 0;
+
+    static v8::Persistent<v8::FunctionTemplate> m_decoder_tmpl;
+};
+
+} // namespace module
+} // namespace z8
+
+#endif // Z8_MODULE_STRING_DECODER_H
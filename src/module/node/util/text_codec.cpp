@@ -0,0 +1,569 @@
+#include "text_codec.h"
+#include "../buffer/buffer.h"
+#include "../buffer/utf8.h"
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace z8 {
+namespace module {
+
+v8::Persistent<v8::FunctionTemplate> TextCodec::m_encoder_tmpl;
+v8::Persistent<v8::FunctionTemplate> TextCodec::m_decoder_tmpl;
+
+static constexpr uint8_t ENCODING_UTF8 = 0;
+static constexpr uint8_t ENCODING_UTF16LE = 1;
+static constexpr uint8_t ENCODING_WINDOWS_1252 = 2;
+
+struct EncodingLabel {
+    const char* p_label;
+    uint8_t m_encoding;
+};
+
+// The WHATWG Encoding labels of the encodings the decoder implements.
+static const EncodingLabel ENCODING_LABELS[] = {
+    {"unicode-1-1-utf-8", ENCODING_UTF8},
+    {"unicode11utf8", ENCODING_UTF8},
+    {"unicode20utf8", ENCODING_UTF8},
+    {"utf-8", ENCODING_UTF8},
+    {"utf8", ENCODING_UTF8},
+    {"x-unicode20utf8", ENCODING_UTF8},
+    {"csunicode", ENCODING_UTF16LE},
+    {"iso-10646-ucs-2", ENCODING_UTF16LE},
+    {"ucs-2", ENCODING_UTF16LE},
+    {"unicode", ENCODING_UTF16LE},
+    {"unicodefeff", ENCODING_UTF16LE},
+    {"utf-16", ENCODING_UTF16LE},
+    {"utf-16le", ENCODING_UTF16LE},
+    {"ansi_x3.4-1968", ENCODING_WINDOWS_1252},
+    {"ascii", ENCODING_WINDOWS_1252},
+    {"cp1252", ENCODING_WINDOWS_1252},
+    {"cp819", ENCODING_WINDOWS_1252},
+    {"csisolatin1", ENCODING_WINDOWS_1252},
+    {"ibm819", ENCODING_WINDOWS_1252},
+    {"iso-8859-1", ENCODING_WINDOWS_1252},
+    {"iso-ir-100", ENCODING_WINDOWS_1252},
+    {"iso8859-1", ENCODING_WINDOWS_1252},
+    {"iso88591", ENCODING_WINDOWS_1252},
+    {"iso_8859-1", ENCODING_WINDOWS_1252},
+    {"iso_8859-1:1987", ENCODING_WINDOWS_1252},
+    {"l1", ENCODING_WINDOWS_1252},
+    {"latin1", ENCODING_WINDOWS_1252},
+    {"us-ascii", ENCODING_WINDOWS_1252},
+    {"windows-1252", ENCODING_WINDOWS_1252},
+    {"x-cp1252", ENCODING_WINDOWS_1252},
+};
+
+static const char* const ENCODING_NAMES[] = {"utf-8", "utf-16le", "windows-1252"};
+
+// windows-1252 bytes 0x80-0x9F; every other byte is the code point of the same value.
+static const uint16_t WINDOWS_1252_HIGH[32] = {
+    0x20AC, 0x0081, 0x201A, 0x0192, 0x201E, 0x2026, 0x2020, 0x2021, 0x02C6, 0x2030, 0x0160,
+    0x2039, 0x0152, 0x008D, 0x017D, 0x008F, 0x0090, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022,
+    0x2013, 0x2014, 0x02DC, 0x2122, 0x0161, 0x203A, 0x0153, 0x009D, 0x017E, 0x0178,
+};
+
+// Decoder state between decode() calls. In stream mode m_pending holds the start of a character
+// cut off at the end of a chunk: up to 3 bytes of UTF-8, or for UTF-16 an odd byte, a high
+// surrogate, or both. A call without stream flushes it and starts a new stream.
+struct DecoderState {
+    uint8_t m_encoding = ENCODING_UTF8;
+    bool m_fatal = false;
+    bool m_ignore_bom = false;
+    bool m_bom_seen = false;
+    uint8_t m_pending[4] = {};
+    size_t m_pending_length = 0;
+    v8::Global<v8::Object> m_self;
+};
+
+static void decoderWeak(const v8::WeakCallbackInfo<DecoderState>& data) {
+    DecoderState* p_state = data.GetParameter();
+    p_state->m_self.Reset();
+    delete p_state;
+}
+
+static DecoderState* getDecoderState(v8::Local<v8::Object> self) {
+    if (self->InternalFieldCount() < 1)
+        return nullptr;
+    v8::Local<v8::Value> field = self->GetInternalField(0).As<v8::Value>();
+    if (!field->IsExternal())
+        return nullptr;
+    return static_cast<DecoderState*>(field.As<v8::External>()->Value());
+}
+
+// TypeError/RangeError carrying the Node error code, as node:util's codecs throw them.
+static void throwCodedError(v8::Isolate* p_isolate, bool range_error, const char* p_code, const std::string& message) {
+    v8::Local<v8::Context> context = p_isolate->GetCurrentContext();
+    v8::Local<v8::String> text = v8::String::NewFromUtf8(p_isolate, message.c_str()).ToLocalChecked();
+    v8::Local<v8::Object> error =
+        (range_error ? v8::Exception::RangeError(text) : v8::Exception::TypeError(text)).As<v8::Object>();
+    (void) error->Set(context,
+                      v8::String::NewFromUtf8Literal(p_isolate, "code"),
+                      v8::String::NewFromUtf8(p_isolate, p_code).ToLocalChecked());
+    p_isolate->ThrowException(error);
+}
+
+static void throwStringTooLong(v8::Isolate* p_isolate) {
+    p_isolate->ThrowException(Buffer::stringTooLongError(p_isolate));
+}
+
+// Label lookup after the trimming and ASCII lowercasing the Encoding spec asks for.
+static bool resolveLabel(std::string label, uint8_t& encoding) {
+    const char* p_space = " \t\n\f\r";
+    size_t first = label.find_first_not_of(p_space);
+    if (first == std::string::npos)
+        return false;
+    label = label.substr(first, label.find_last_not_of(p_space) - first + 1);
+    std::transform(label.begin(), label.end(), label.begin(), [](char c) {
+        return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+    });
+    for (const EncodingLabel& entry : ENCODING_LABELS) {
+        if (label == entry.p_label) {
+            encoding = entry.m_encoding;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void append(v8::Isolate* p_isolate, v8::Local<v8::String>& result, v8::Local<v8::String> piece) {
+    result = result->Length() == 0 ? piece : v8::String::Concat(p_isolate, result, piece);
+}
+
+// ---- utf-8 ----
+
+// Decodes one chunk of UTF-8. The character the previous chunk left in m_pending is finished
+// first, then the body goes to Buffer::decodeUtf8 (invalid sequences become U+FFFD, or with
+// fatal are refused up front by the vectorized validator). In stream mode a valid but
+// unfinished character at the end of the body is held back.
+static v8::MaybeLocal<v8::String> decodeUtf8Chunk(v8::Isolate* p_isolate,
+                                                  DecoderState* p_state,
+                                                  const uint8_t* p_data,
+                                                  size_t length,
+                                                  bool stream,
+                                                  bool& invalid) {
+    v8::Local<v8::String> result = v8::String::Empty(p_isolate);
+    size_t i = 0;
+    if (p_state->m_pending_length > 0) {
+        uint8_t* p_pending = p_state->m_pending;
+        size_t& have = p_state->m_pending_length;
+        size_t need = utf8::sequenceLength(p_pending[0]);
+        while (have < need && i < length && utf8::continues(p_pending[0], have, p_data[i]))
+            p_pending[have++] = p_data[i++];
+        if (have < need && i == length && stream)
+            return result;
+        // Finished, or cut short by an invalid byte or the end of the stream: one U+FFFD.
+        if (have < need && p_state->m_fatal) {
+            invalid = true;
+            return {};
+        }
+        bool bom = !p_state->m_bom_seen && !p_state->m_ignore_bom && have == 3 && p_pending[0] == 0xEF &&
+                   p_pending[1] == 0xBB && p_pending[2] == 0xBF;
+        p_state->m_bom_seen = true;
+        if (!bom && !Buffer::decodeUtf8(p_isolate, p_pending, have).ToLocal(&result))
+            return {};
+        have = 0;
+    }
+
+    const uint8_t* p_body = p_data + i;
+    size_t body = length - i;
+    size_t kept = stream ? utf8::incompleteSuffix(p_body, body) : 0;
+    body -= kept;
+    if (body > 0 && !p_state->m_bom_seen) {
+        p_state->m_bom_seen = true;
+        if (!p_state->m_ignore_bom && body >= 3 && p_body[0] == 0xEF && p_body[1] == 0xBB && p_body[2] == 0xBF) {
+            p_body += 3;
+            body -= 3;
+        }
+    }
+    if (body > 0) {
+        if (p_state->m_fatal && !utf8::validate(p_body, body)) {
+            invalid = true;
+            return {};
+        }
+        v8::Local<v8::String> piece;
+        if (!Buffer::decodeUtf8(p_isolate, p_body, body).ToLocal(&piece))
+            return {};
+        append(p_isolate, result, piece);
+    }
+    std::memcpy(p_state->m_pending, p_data + length - kept, kept);
+    p_state->m_pending_length = kept;
+    return result;
+}
+
+// ---- utf-16le ----
+
+static uint16_t loadUnit(const uint8_t* p_data, size_t index) {
+    uint16_t unit;
+    std::memcpy(&unit, p_data + 2 * index, 2);
+    return unit;
+}
+
+static bool isHighSurrogate(uint16_t unit) {
+    return unit >= 0xD800 && unit <= 0xDBFF;
+}
+
+static bool isLowSurrogate(uint16_t unit) {
+    return unit >= 0xDC00 && unit <= 0xDFFF;
+}
+
+// Bytes of a UTF-16LE span that decode without the next chunk: whole units, less a trailing
+// high surrogate whose low half has not arrived.
+static size_t completeUtf16(const uint8_t* p_data, size_t length) {
+    size_t units = length / 2;
+    if (units > 0 && isHighSurrogate(loadUnit(p_data, units - 1)))
+        units--;
+    return units * 2;
+}
+
+// Index of the first lone surrogate among units, or units.
+static size_t loneSurrogate(const uint8_t* p_data, size_t units) {
+    for (size_t i = 0; i < units; i++) {
+        uint16_t unit = loadUnit(p_data, i);
+        if ((unit & 0xF800) != 0xD800)
+            continue;
+        if (isHighSurrogate(unit) && i + 1 < units && isLowSurrogate(loadUnit(p_data, i + 1))) {
+            i++;
+            continue;
+        }
+        return i;
+    }
+    return units;
+}
+
+// Appends length bytes of UTF-16LE to result. Lone surrogates and an odd last byte become U+FFFD
+// (one for a high surrogate followed by the odd byte, as in the Encoding spec); only that case
+// copies the units before V8 does.
+static bool appendUtf16(v8::Isolate* p_isolate,
+                        DecoderState* p_state,
+                        const uint8_t* p_data,
+                        size_t length,
+                        v8::Local<v8::String>& result,
+                        bool& invalid) {
+    if (length == 0)
+        return true;
+    if (!p_state->m_bom_seen) {
+        p_state->m_bom_seen = true;
+        if (!p_state->m_ignore_bom && length >= 2 && p_data[0] == 0xFF && p_data[1] == 0xFE) {
+            p_data += 2;
+            length -= 2;
+        }
+    }
+    size_t units = length / 2;
+    bool odd = length % 2 != 0;
+    size_t lone = loneSurrogate(p_data, units);
+    if ((lone < units || odd) && p_state->m_fatal) {
+        invalid = true;
+        return false;
+    }
+    v8::Local<v8::String> piece;
+    if (lone == units && !odd) {
+        if (!Buffer::decodeUtf16(p_isolate, p_data, units).ToLocal(&piece))
+            return false;
+    } else {
+        bool cut_pair = odd && units > 0 && isHighSurrogate(loadUnit(p_data, units - 1));
+        std::vector<uint16_t> fixed(units + (odd && !cut_pair ? 1 : 0));
+        std::memcpy(fixed.data(), p_data, units * 2);
+        for (size_t i = lone; i < units; i++) {
+            if (isHighSurrogate(fixed[i]) && i + 1 < units && isLowSurrogate(fixed[i + 1]))
+                i++;
+            else if ((fixed[i] & 0xF800) == 0xD800)
+                fixed[i] = 0xFFFD;
+        }
+        if (fixed.size() > units)
+            fixed[units] = 0xFFFD;
+        if (!Buffer::decodeUtf16(p_isolate, fixed.data(), fixed.size()).ToLocal(&piece))
+            return false;
+    }
+    append(p_isolate, result, piece);
+    return true;
+}
+
+// Decodes one chunk of UTF-16LE. Pending bytes are joined with the first few bytes of the chunk
+// in a small stitch buffer, so the body is decoded in place whatever its alignment.
+static v8::MaybeLocal<v8::String> decodeUtf16Chunk(v8::Isolate* p_isolate,
+                                                   DecoderState* p_state,
+                                                   const uint8_t* p_data,
+                                                   size_t length,
+                                                   bool stream,
+                                                   bool& invalid) {
+    v8::Local<v8::String> result = v8::String::Empty(p_isolate);
+    size_t i = 0;
+    size_t pending = p_state->m_pending_length;
+    if (pending > 0) {
+        uint8_t stitch[8];
+        size_t taken = std::min<size_t>(length, 4);
+        std::memcpy(stitch, p_state->m_pending, pending);
+        std::memcpy(stitch + pending, p_data, taken);
+        size_t size = pending + taken;
+        bool last = taken == length && !stream;
+        size_t done = last ? size : completeUtf16(stitch, size);
+        if (!appendUtf16(p_isolate, p_state, stitch, done, result, invalid))
+            return {};
+        if (done < pending) {
+            // Only once the chunk is used up: what the stitch could not finish stays pending.
+            std::memmove(p_state->m_pending, stitch + done, size - done);
+            p_state->m_pending_length = size - done;
+            return result;
+        }
+        i = done - pending;
+    }
+    size_t body = length - i;
+    size_t done = stream ? completeUtf16(p_data + i, body) : body;
+    if (!appendUtf16(p_isolate, p_state, p_data + i, done, result, invalid))
+        return {};
+    std::memcpy(p_state->m_pending, p_data + i + done, body - done);
+    p_state->m_pending_length = body - done;
+    return result;
+}
+
+// ---- windows-1252 ----
+
+// Latin-1 unless a byte falls in 0x80-0x9F, where windows-1252 has its own characters.
+static v8::MaybeLocal<v8::String> decodeWindows1252(v8::Isolate* p_isolate, const uint8_t* p_data, size_t length) {
+    bool remapped = false;
+    for (size_t i = 0; i < length; i++)
+        remapped |= static_cast<uint8_t>(p_data[i] - 0x80) < 0x20;
+    if (!remapped)
+        return Buffer::decodeLatin1(p_isolate, p_data, length);
+    std::vector<uint16_t> units(length);
+    for (size_t i = 0; i < length; i++) {
+        uint8_t byte = p_data[i];
+        units[i] = static_cast<uint8_t>(byte - 0x80) < 0x20 ? WINDOWS_1252_HIGH[byte - 0x80] : byte;
+    }
+    return Buffer::decodeUtf16(p_isolate, units.data(), length);
+}
+
+// ---- Templates ----
+
+void TextCodec::initialize(v8::Isolate* p_isolate, v8::Local<v8::Context> context) {
+    v8::Local<v8::Object> global = context->Global();
+    global
+        ->Set(context,
+              v8::String::NewFromUtf8Literal(p_isolate, "TextEncoder"),
+              getEncoderTemplate(p_isolate)->GetFunction(context).ToLocalChecked())
+        .Check();
+    global
+        ->Set(context,
+              v8::String::NewFromUtf8Literal(p_isolate, "TextDecoder"),
+              getDecoderTemplate(p_isolate)->GetFunction(context).ToLocalChecked())
+        .Check();
+}
+
+v8::Local<v8::FunctionTemplate> TextCodec::getEncoderTemplate(v8::Isolate* p_isolate) {
+    if (m_encoder_tmpl.IsEmpty()) {
+        v8::Local<v8::FunctionTemplate> tmpl = v8::FunctionTemplate::New(p_isolate, encoderConstructor);
+        tmpl->SetClassName(v8::String::NewFromUtf8Literal(p_isolate, "TextEncoder"));
+        v8::Local<v8::ObjectTemplate> proto = tmpl->PrototypeTemplate();
+        proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "encode"), v8::FunctionTemplate::New(p_isolate, encode));
+        proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "encodeInto"),
+                   v8::FunctionTemplate::New(p_isolate, encodeInto));
+        proto->SetAccessorProperty(v8::String::NewFromUtf8Literal(p_isolate, "encoding"),
+                                   v8::FunctionTemplate::New(p_isolate, getEncoderEncoding));
+        m_encoder_tmpl.Reset(p_isolate, tmpl);
+    }
+    return m_encoder_tmpl.Get(p_isolate);
+}
+
+v8::Local<v8::FunctionTemplate> TextCodec::getDecoderTemplate(v8::Isolate* p_isolate) {
+    if (m_decoder_tmpl.IsEmpty()) {
+        v8::Local<v8::FunctionTemplate> tmpl = v8::FunctionTemplate::New(p_isolate, decoderConstructor);
+        tmpl->SetClassName(v8::String::NewFromUtf8Literal(p_isolate, "TextDecoder"));
+        tmpl->InstanceTemplate()->SetInternalFieldCount(1);
+        v8::Local<v8::ObjectTemplate> proto = tmpl->PrototypeTemplate();
+        proto->Set(v8::String::NewFromUtf8Literal(p_isolate, "decode"), v8::FunctionTemplate::New(p_isolate, decode));
+        proto->SetAccessorProperty(v8::String::NewFromUtf8Literal(p_isolate, "encoding"),
+                                   v8::FunctionTemplate::New(p_isolate, getDecoderEncoding));
+        proto->SetAccessorProperty(v8::String::NewFromUtf8Literal(p_isolate, "fatal"),
+                                   v8::FunctionTemplate::New(p_isolate, getDecoderFatal));
+        proto->SetAccessorProperty(v8::String::NewFromUtf8Literal(p_isolate, "ignoreBOM"),
+                                   v8::FunctionTemplate::New(p_isolate, getDecoderIgnoreBom));
+        m_decoder_tmpl.Reset(p_isolate, tmpl);
+    }
+    return m_decoder_tmpl.Get(p_isolate);
+}
+
+// ---- TextEncoder ----
+
+void TextCodec::encoderConstructor(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    if (!args.IsConstructCall()) {
+        p_isolate->ThrowException(v8::Exception::TypeError(v8::String::NewFromUtf8Literal(
+            p_isolate, "Class constructor TextEncoder cannot be invoked without 'new'")));
+        return;
+    }
+    args.GetReturnValue().Set(args.This());
+}
+
+// Sized with Buffer::utf8Length and encoded straight into the new array's backing store.
+void TextCodec::encode(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    v8::Local<v8::Context> context = p_isolate->GetCurrentContext();
+    v8::Local<v8::String> str = v8::String::Empty(p_isolate);
+    if (args.Length() > 0 && !args[0]->IsUndefined() && !args[0]->ToString(context).ToLocal(&str))
+        return;
+    size_t length = Buffer::utf8Length(p_isolate, str);
+    uint8_t* p_data = nullptr;
+    v8::Local<v8::Uint8Array> array = Buffer::createUint8Array(p_isolate, length, p_data);
+    if (length > 0)
+        Buffer::writeUtf8(p_isolate, str, p_data, length);
+    args.GetReturnValue().Set(array);
+}
+
+void TextCodec::encodeInto(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    v8::Local<v8::Context> context = p_isolate->GetCurrentContext();
+    if (args.Length() < 1 || !args[0]->IsString()) {
+        throwCodedError(p_isolate, false, "ERR_INVALID_ARG_TYPE", "The \"src\" argument must be of type string");
+        return;
+    }
+    if (args.Length() < 2 || !args[1]->IsUint8Array()) {
+        throwCodedError(
+            p_isolate, false, "ERR_INVALID_ARG_TYPE", "The \"dest\" argument must be an instance of Uint8Array");
+        return;
+    }
+    v8::Local<v8::Uint8Array> dest = args[1].As<v8::Uint8Array>();
+    uint8_t* p_dest = Buffer::data(dest);
+    size_t read = 0;
+    size_t written = Buffer::writeUtf8(p_isolate, args[0].As<v8::String>(), p_dest, dest->ByteLength(), read);
+    v8::Local<v8::Object> result = v8::Object::New(p_isolate);
+    (void) result->CreateDataProperty(context,
+                                      v8::String::NewFromUtf8Literal(p_isolate, "read"),
+                                      v8::Number::New(p_isolate, static_cast<double>(read)));
+    (void) result->CreateDataProperty(context,
+                                      v8::String::NewFromUtf8Literal(p_isolate, "written"),
+                                      v8::Number::New(p_isolate, static_cast<double>(written)));
+    args.GetReturnValue().Set(result);
+}
+
+void TextCodec::getEncoderEncoding(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    args.GetReturnValue().Set(v8::String::NewFromUtf8Literal(args.GetIsolate(), "utf-8"));
+}
+
+// ---- TextDecoder ----
+
+void TextCodec::decoderConstructor(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    v8::Local<v8::Context> context = p_isolate->GetCurrentContext();
+    if (!args.IsConstructCall()) {
+        p_isolate->ThrowException(v8::Exception::TypeError(v8::String::NewFromUtf8Literal(
+            p_isolate, "Class constructor TextDecoder cannot be invoked without 'new'")));
+        return;
+    }
+    uint8_t encoding = ENCODING_UTF8;
+    if (args.Length() > 0 && !args[0]->IsUndefined()) {
+        v8::Local<v8::String> label;
+        if (!args[0]->ToString(context).ToLocal(&label))
+            return;
+        v8::String::Utf8Value label_utf8(p_isolate, label);
+        std::string label_str(*label_utf8, label_utf8.length());
+        if (!resolveLabel(label_str, encoding)) {
+            throwCodedError(p_isolate,
+                            true,
+                            "ERR_ENCODING_NOT_SUPPORTED",
+                            "The \"" + label_str + "\" encoding is not supported");
+            return;
+        }
+    }
+    bool fatal = false;
+    bool ignore_bom = false;
+    if (args.Length() > 1 && args[1]->IsObject()) {
+        v8::Local<v8::Object> options = args[1].As<v8::Object>();
+        v8::Local<v8::Value> value;
+        if (!options->Get(context, v8::String::NewFromUtf8Literal(p_isolate, "fatal")).ToLocal(&value))
+            return;
+        fatal = value->BooleanValue(p_isolate);
+        if (!options->Get(context, v8::String::NewFromUtf8Literal(p_isolate, "ignoreBOM")).ToLocal(&value))
+            return;
+        ignore_bom = value->BooleanValue(p_isolate);
+    }
+
+    v8::Local<v8::Object> self = args.This();
+    auto p_state = new DecoderState();
+    p_state->m_encoding = encoding;
+    p_state->m_fatal = fatal;
+    p_state->m_ignore_bom = ignore_bom;
+    p_state->m_self.Reset(p_isolate, self);
+    p_state->m_self.SetWeak(p_state, decoderWeak, v8::WeakCallbackType::kParameter);
+    self->SetInternalField(0, v8::External::New(p_isolate, p_state));
+    args.GetReturnValue().Set(self);
+}
+
+void TextCodec::decode(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* p_isolate = args.GetIsolate();
+    v8::Local<v8::Context> context = p_isolate->GetCurrentContext();
+    DecoderState* p_state = getDecoderState(args.This());
+    if (!p_state) {
+        throwCodedError(p_isolate, false, "ERR_INVALID_THIS", "Value of \"this\" must be of type TextDecoder");
+        return;
+    }
+    const uint8_t* p_data = nullptr;
+    size_t length = 0;
+    if (args.Length() > 0 && !args[0]->IsUndefined() && !Buffer::binaryBytes(args[0], p_data, length)) {
+        throwCodedError(p_isolate,
+                        false,
+                        "ERR_INVALID_ARG_TYPE",
+                        "The \"input\" argument must be an instance of ArrayBuffer or ArrayBufferView");
+        return;
+    }
+    bool stream = false;
+    if (args.Length() > 1 && args[1]->IsObject()) {
+        v8::Local<v8::Object> options = args[1].As<v8::Object>();
+        v8::Local<v8::Value> value;
+        if (!options->Get(context, v8::String::NewFromUtf8Literal(p_isolate, "stream")).ToLocal(&value))
+            return;
+        stream = value->BooleanValue(p_isolate);
+    }
+
+    bool invalid = false;
+    v8::MaybeLocal<v8::String> result;
+    if (p_state->m_encoding == ENCODING_UTF8)
+        result = decodeUtf8Chunk(p_isolate, p_state, p_data, length, stream, invalid);
+    else if (p_state->m_encoding == ENCODING_UTF16LE)
+        result = decodeUtf16Chunk(p_isolate, p_state, p_data, length, stream, invalid);
+    else
+        result = decodeWindows1252(p_isolate, p_data, length);
+
+    v8::Local<v8::String> str;
+    bool ok = result.ToLocal(&str);
+    if (!stream || !ok) {
+        p_state->m_pending_length = 0;
+        p_state->m_bom_seen = false;
+    }
+    if (invalid) {
+        std::string message = "The encoded data was not valid for encoding ";
+        throwCodedError(
+            p_isolate, false, "ERR_ENCODING_INVALID_ENCODED_DATA", message + ENCODING_NAMES[p_state->m_encoding]);
+        return;
+    }
+    if (!ok) {
+        throwStringTooLong(p_isolate);
+        return;
+    }
+    args.GetReturnValue().Set(str);
+}
+
+void TextCodec::getDecoderEncoding(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    DecoderState* p_state = getDecoderState(args.This());
+    if (!p_state)
+        return;
+    v8::Isolate* p_isolate = args.GetIsolate();
+    const char* p_name = ENCODING_NAMES[p_state->m_encoding];
+    args.GetReturnValue().Set(v8::String::NewFromUtf8(p_isolate, p_name).ToLocalChecked());
+}
+
+void TextCodec::getDecoderFatal(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    DecoderState* p_state = getDecoderState(args.This());
+    if (p_state)
+        args.GetReturnValue().Set(p_state->m_fatal);
+}
+
+void TextCodec::getDecoderIgnoreBom(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    DecoderState* p_state = getDecoderState(args.This());
+    if (p_state)
+        args.GetReturnValue().Set(p_state->m_ignore_bom);
+}
+
+} // namespace module
+} // namespace z8
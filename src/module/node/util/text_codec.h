@@ -0,0 +1,38 @@
+#ifndef Z8_MODULE_TEXT_CODEC_H
+#define Z8_MODULE_TEXT_CODEC_H
+
+#include "v8.h"
+
+namespace z8 {
+namespace module {
+
+// WHATWG TextEncoder/TextDecoder, installed as globals and exported by node:util. The decoder
+// handles utf-8, utf-16le and windows-1252 (the encoding every latin1/ascii label names).
+class TextCodec {
+  public:
+    static void initialize(v8::Isolate* p_isolate, v8::Local<v8::Context> context);
+    static v8::Local<v8::FunctionTemplate> getEncoderTemplate(v8::Isolate* p_isolate);
+    static v8::Local<v8::FunctionTemplate> getDecoderTemplate(v8::Isolate* p_isolate);
+
+    // TextEncoder
+    static void encoderConstructor(const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void encode(const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void encodeInto(const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void getEncoderEncoding(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+    // TextDecoder
+    static void decoderConstructor(const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void decode(const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void getDecoderEncoding(const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void getDecoderFatal(const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void getDecoderIgnoreBom(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+  private:
+    static v8::Persistent<v8::FunctionTemplate> m_encoder_tmpl;
+    static v8::Persistent<v8::FunctionTemplate> m_decoder_tmpl;
+};
+
+} // namespace module
+} // namespace z8
+
+#endif // Z8_MODULE_TEXT_CODEC_H
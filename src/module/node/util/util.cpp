@@ -1,4 +1,5 @@
 #include "util.h"
+#include "text_codec.h"
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
@@ -30,6 +31,8 @@ v8::Local<v8::ObjectTemplate> Util::createTemplate(v8::Isolate* p_isolate) {
     tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "inspect"), v8::FunctionTemplate::New(p_isolate, inspect));
 
     tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "types"), createTypesTemplate(p_isolate));
+    tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "TextEncoder"), TextCodec::getEncoderTemplate(p_isolate));
+    tmpl->Set(v8::String::NewFromUtf8Literal(p_isolate, "TextDecoder"), TextCodec::getDecoderTemplate(p_isolate));
 
     return tmpl;
 }
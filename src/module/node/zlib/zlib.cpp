@@ -9,6 +9,7 @@
 #include "../../../../deps/brotli/c/include/brotli/encode.h"
 #include "../../../../deps/brotli/c/include/brotli/decode.h"
 #include "../../../../deps/zstd/lib/zstd.h"
+#include "abort_signal.h"
 #include "task_queue.h"
 #include "thread_pool.h"
 
@@ -87,8 +88,18 @@ struct ZlibAsyncCtx {
     std::string m_gzname;
     std::string m_gzcomment;
     uint32_t m_gzmtime = 0;
+
+    // Set from options.signal; checked before the work starts and between output chunks.
+    std::unique_ptr<AbortLink> up_abort;
 };
 
+static bool zlibAborted(ZlibAsyncCtx* p_ctx) {
+    if (!p_ctx->up_abort || !p_ctx->up_abort->isAborted()) return false;
+    p_ctx->m_is_error = true;
+    p_ctx->m_error_msg = "The operation was aborted";
+    return true;
+}
+
 static void parseZlibOptions(v8::Isolate* p_isolate, v8::Local<v8::Context> context, v8::Local<v8::Value> options_val,
                              int32_t& level, int32_t& window_bits, int32_t& mem_level, int32_t& strategy,
                              int32_t& chunk_size, std::vector<uint8_t>& dictionary,
@@ -233,8 +244,9 @@ static bool getInput(const v8::FunctionCallbackInfo<v8::Value>& args, uint8_t**
     }
 
     if (args[0]->IsString()) {
-        v8::String::Utf8Value str(p_isolate, args[0]);
-        storage.assign(reinterpret_cast<uint8_t*>(*str), reinterpret_cast<uint8_t*>(*str) + str.length());
+        v8::Local<v8::String> str = args[0].As<v8::String>();
+        storage.resize(Buffer::utf8Length(p_isolate, str));
+        storage.resize(Buffer::writeUtf8(p_isolate, str, storage.data(), storage.size()));
         *p_data = storage.data();
         *length = storage.size();
         return true;
@@ -255,9 +267,7 @@ static bool getInput(const v8::FunctionCallbackInfo<v8::Value>& args, uint8_t**
 
 static void returnBuffer(const v8::FunctionCallbackInfo<v8::Value>& args, const std::vector<uint8_t>& out_buffer) {
     v8::Isolate* p_isolate = args.GetIsolate();
-    v8::Local<v8::Uint8Array> ui = z8::module::Buffer::createBuffer(p_isolate, out_buffer.size());
-    memcpy(ui->Buffer()->GetBackingStore()->Data(), out_buffer.data(), out_buffer.size());
-    args.GetReturnValue().Set(ui);
+    args.GetReturnValue().Set(z8::module::Buffer::copyBuffer(p_isolate, out_buffer.data(), out_buffer.size()));
 }
 
 v8::Local<v8::ObjectTemplate> Zlib::createTemplate(v8::Isolate* p_isolate) {
@@ -738,6 +748,11 @@ static void doZlibAsync(const v8::FunctionCallbackInfo<v8::Value>& args, int32_t
         } else {
             parseZlibOptions(p_isolate, context, args[1], p_ctx->m_level, p_ctx->m_window_bits, p_ctx->m_mem_level, p_ctx->m_strategy, p_ctx->m_chunk_size, p_ctx->m_dictionary, p_ctx->m_max_output_length, p_ctx->m_info, p_ctx->m_gzname, p_ctx->m_gzcomment, p_ctx->m_gzmtime);
         }
+        p_ctx->up_abort = AbortLink::create(p_isolate, context, args[1], resolver, callback);
+        if (p_ctx->up_abort && p_ctx->up_abort->isSettled()) {
+            delete p_ctx;
+            return;
+        }
     }
 
     Task* p_task = new Task();
@@ -751,13 +766,18 @@ static void doZlibAsync(const v8::FunctionCallbackInfo<v8::Value>& args, int32_t
 
     p_task->m_runner = [](v8::Isolate* isolate, v8::Local<v8::Context> context, Task* task) {
         ZlibAsyncCtx* p_ctx = static_cast<ZlibAsyncCtx*>(task->p_data);
+        // Already rejected (or called back) by the abort listener.
+        if (p_ctx->up_abort && !p_ctx->up_abort->finish(isolate)) {
+            delete p_ctx;
+            return;
+        }
         if (task->m_is_promise) {
             auto resolver = task->m_resolver.Get(isolate);
             if (p_ctx->m_is_error) {
                 resolver->Reject(context, v8::Exception::Error(v8::String::NewFromUtf8(isolate, p_ctx->m_error_msg.c_str()).ToLocalChecked())).Check();
             } else {
-                v8::Local<v8::Uint8Array> ui = z8::module::Buffer::createBuffer(isolate, p_ctx->m_output.size());
-                memcpy(ui->Buffer()->GetBackingStore()->Data(), p_ctx->m_output.data(), p_ctx->m_output.size());
+                v8::Local<v8::Uint8Array> ui =
+                    z8::module::Buffer::copyBuffer(isolate, p_ctx->m_output.data(), p_ctx->m_output.size());
                 
                 if (p_ctx->m_info) {
                     v8::Local<v8::Object> res_obj = v8::Object::New(isolate);
@@ -775,8 +795,8 @@ static void doZlibAsync(const v8::FunctionCallbackInfo<v8::Value>& args, int32_t
                 argv[1] = v8::Null(isolate);
             } else {
                 argv[0] = v8::Null(isolate);
-                v8::Local<v8::Uint8Array> ui = z8::module::Buffer::createBuffer(isolate, p_ctx->m_output.size());
-                memcpy(ui->Buffer()->GetBackingStore()->Data(), p_ctx->m_output.data(), p_ctx->m_output.size());
+                v8::Local<v8::Uint8Array> ui =
+                    z8::module::Buffer::copyBuffer(isolate, p_ctx->m_output.data(), p_ctx->m_output.size());
                 
                 if (p_ctx->m_info) {
                     v8::Local<v8::Object> res_obj = v8::Object::New(isolate);
@@ -793,7 +813,12 @@ static void doZlibAsync(const v8::FunctionCallbackInfo<v8::Value>& args, int32_t
 
     ThreadPool::getInstance().enqueue([p_task]() {
         ZlibAsyncCtx* p_ctx = static_cast<ZlibAsyncCtx*>(p_task->p_data);
-        
+        // Aborted while still queued: skip the work entirely.
+        if (zlibAborted(p_ctx)) {
+            TaskQueue::getInstance().enqueue(p_task);
+            return;
+        }
+
         if (p_ctx->m_is_brotli) {
             if (p_ctx->m_is_deflate) { // Brotli Compress
                 BrotliEncoderState* p_s = BrotliEncoderCreateInstance(nullptr, nullptr, nullptr);
@@ -821,6 +846,7 @@ static void doZlibAsync(const v8::FunctionCallbackInfo<v8::Value>& args, int32_t
                     const size_t chunk_size = p_ctx->m_chunk_size > 0 ? p_ctx->m_chunk_size : 16384;
                     
                     while (available_in > 0 || BrotliEncoderHasMoreOutput(p_s)) {
+                        if (zlibAborted(p_ctx)) break;
                         p_ctx->m_output.resize(total_out + chunk_size);
                         size_t available_out = chunk_size;
                         uint8_t* p_next_out = p_ctx->m_output.data() + total_out;
@@ -856,6 +882,7 @@ static void doZlibAsync(const v8::FunctionCallbackInfo<v8::Value>& args, int32_t
 
                     BrotliDecoderResult res = BROTLI_DECODER_RESULT_NEEDS_MORE_OUTPUT;
                     while (res == BROTLI_DECODER_RESULT_NEEDS_MORE_OUTPUT) {
+                        if (zlibAborted(p_ctx)) break;
                         p_ctx->m_output.resize(total_out + chunk_size);
                         size_t available_out = chunk_size;
                         uint8_t* p_next_out = p_ctx->m_output.data() + total_out;
@@ -928,6 +955,7 @@ static void doZlibAsync(const v8::FunctionCallbackInfo<v8::Value>& args, int32_t
                         ZSTD_inBuffer input = { p_ctx->m_input.data(), p_ctx->m_input.size(), 0 };
                         ZSTD_outBuffer output = { p_ctx->m_output.data(), p_ctx->m_output.size(), 0 };
                         while (input.pos < input.size) {
+                            if (zlibAborted(p_ctx)) break;
                             size_t const res = ZSTD_decompressStream(p_dctx, &output, &input);
                             if (ZSTD_isError(res)) {
                                 p_ctx->m_is_error = true;
@@ -990,6 +1018,7 @@ static void doZlibAsync(const v8::FunctionCallbackInfo<v8::Value>& args, int32_t
             size_t total_out = 0;
 
             do {
+                if (zlibAborted(p_ctx)) break;
                 if (total_out + chunk_size > p_ctx->m_output.size()) {
                     p_ctx->m_output.resize(p_ctx->m_output.size() + chunk_size);
                 }
@@ -1478,8 +1507,7 @@ static void streamProcess(const v8::FunctionCallbackInfo<v8::Value>& args, int32
         p_obj->m_finished = true;
     }
 
-    v8::Local<v8::Uint8Array> output_chunk = z8::module::Buffer::createBuffer(p_isolate, total_out);
-    memcpy(output_chunk->Buffer()->GetBackingStore()->Data(), out_buffer.data(), total_out);
+    v8::Local<v8::Uint8Array> output_chunk = z8::module::Buffer::copyBuffer(p_isolate, out_buffer.data(), total_out);
 
     if (args.Length() > 2 && args[2]->IsFunction()) { // Callback for _transform
         v8::Local<v8::Function> callback = args[2].As<v8::Function>();
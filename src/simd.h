@@ -0,0 +1,94 @@
+#ifndef Z8_SIMD_H
+#define Z8_SIMD_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+// Kernels above the build's baseline are compiled per function: MSVC accepts any intrinsic in
+// any function, GCC and Clang need the target attribute. NEON is part of the AArch64 baseline.
+#if defined(_M_X64) || defined(__x86_64__)
+#define Z8_SIMD_X64 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#define Z8_TARGET_SSE41
+#define Z8_TARGET_AVX2
+#else
+#define Z8_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define Z8_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define Z8_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace z8 {
+namespace simd {
+
+static constexpr int32_t LEVEL_SCALAR = 0;
+static constexpr int32_t LEVEL_SSE41 = 1;
+static constexpr int32_t LEVEL_AVX2 = 2;
+static constexpr int32_t LEVEL_NEON = 3;
+
+inline int32_t detectLevel() {
+    int32_t level = LEVEL_SCALAR;
+#if defined(Z8_SIMD_X64) && defined(_MSC_VER) && !defined(__clang__)
+    int32_t regs[4] = {};
+    __cpuid(regs, 1);
+    bool sse41 = (regs[2] & (1 << 19)) != 0;
+    bool os_avx = (regs[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+    __cpuidex(regs, 7, 0);
+    bool avx2 = os_avx && (regs[1] & (1 << 5)) != 0;
+    level = avx2 ? LEVEL_AVX2 : sse41 ? LEVEL_SSE41 : LEVEL_SCALAR;
+#elif defined(Z8_SIMD_X64)
+    __builtin_cpu_init();
+    level = __builtin_cpu_supports("avx2")     ? LEVEL_AVX2
+            : __builtin_cpu_supports("sse4.1") ? LEVEL_SSE41
+                                               : LEVEL_SCALAR;
+#elif defined(Z8_SIMD_NEON)
+    level = LEVEL_NEON;
+#endif
+    // Z8_SIMD=scalar|sse41 caps the level, which benchmarks use to compare kernels.
+    const char* p_cap = std::getenv("Z8_SIMD");
+    if (p_cap && std::strcmp(p_cap, "scalar") == 0)
+        level = LEVEL_SCALAR;
+    else if (p_cap && std::strcmp(p_cap, "sse41") == 0 && level == LEVEL_AVX2)
+        level = LEVEL_SSE41;
+    return level;
+}
+
+// Index of the lowest set bit of a non-zero mask.
+inline uint32_t lowestBit(uint64_t mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index = 0;
+    _BitScanForward64(&index, mask);
+    return static_cast<uint32_t>(index);
+#else
+    return static_cast<uint32_t>(__builtin_ctzll(mask));
+#endif
+}
+
+// Index of the highest set bit of a non-zero mask.
+inline uint32_t highestBit(uint64_t mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index = 0;
+    _BitScanReverse64(&index, mask);
+    return static_cast<uint32_t>(index);
+#else
+    return static_cast<uint32_t>(63 - __builtin_clzll(mask));
+#endif
+}
+
+// The widest kernel set the running CPU and OS support, detected once.
+inline int32_t level() {
+    static const int32_t s_level = detectLevel();
+    return s_level;
+}
+
+} // namespace simd
+} // namespace z8
+
+#endif
@@ -2,6 +2,7 @@
 #define Z8_TASK_QUEUE_H
 
 #include "v8.h"
+#include <atomic>
 #include <chrono>
 #include <condition_variable>
 #include <cstdint>
@@ -35,6 +36,13 @@ class TaskQueue {
             m_queue.push(p_task);
         }
         m_condition.notify_one(); // Wake up Main Thread
+        if (auto p_hook = m_wake_hook.load())
+            p_hook();
+    }
+
+    // Runs after every enqueue, for a main loop that sleeps somewhere other than wait().
+    void setWakeHook(void (*p_hook)()) {
+        m_wake_hook.store(p_hook);
     }
 
     Task* dequeue() {
@@ -63,6 +71,7 @@ class TaskQueue {
     std::queue<Task*> m_queue;
     std::mutex m_mutex;
     std::condition_variable m_condition;
+    std::atomic<void (*)()> m_wake_hook{nullptr};
 };
 
 } // namespace z8
@@ -0,0 +1,30 @@
+// base64 encode/decode throughput by payload size. Compare kernels with Z8_SIMD=scalar or
+// Z8_SIMD=sse41, or run the same file under node:
+//   z8 test/buffer/bench_base64.js
+const SIZES = [64, 1024, 64 * 1024, 4 * 1024 * 1024];
+const TOTAL = 256 * 1024 * 1024;
+
+function throughput(label, bytes, fn) {
+    const rounds = Math.max(1, Math.floor(TOTAL / bytes));
+    const start = Date.now();
+    let sink = 0;
+    for (let i = 0; i < rounds; i++) sink += fn().length;
+    const ms = Math.max(Date.now() - start, 1);
+    console.log(`${label.padEnd(30)} ${String(ms).padStart(7)} ms  ${((rounds * bytes) / ms / 1000).toFixed(0)} MB/s`);
+    return sink;
+}
+
+function main() {
+    for (const size of SIZES) {
+        const data = Buffer.allocUnsafe(size);
+        for (let i = 0; i < size; i++) data[i] = (i * 131) & 0xff;
+        const text = data.toString('base64');
+        const wrapped = text.replace(/.{76}/g, '$&\n');
+        throughput(`encode ${size} B`, size, () => data.toString('base64'));
+        throughput(`decode ${size} B`, text.length, () => Buffer.from(text, 'base64'));
+        throughput(`decode ${size} B (wrapped)`, wrapped.length, () => Buffer.from(wrapped, 'base64'));
+        throughput(`base64url ${size} B`, size, () => data.toString('base64url'));
+    }
+}
+
+main();
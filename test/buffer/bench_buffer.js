@@ -0,0 +1,36 @@
+// Allocation-heavy Buffer paths. Run with an optional iteration count:
+//   z8 test/buffer/bench_buffer.js 2000000
+const COUNT = Number(process.argv[2]) || 1000000;
+
+function time(label, fn) {
+    const start = Date.now();
+    let sink = 0;
+    for (let i = 0; i < COUNT; i++) sink += fn(i).length;
+    const ms = Math.max(Date.now() - start, 1);
+    console.log(`${label.padEnd(28)} ${String(ms).padStart(9)} ms  ${((COUNT / ms) * 1000).toFixed(0)} ops/s`);
+    return sink;
+}
+
+function main() {
+    const text = 'hello buffer benchmark';
+    const bytes = [1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16];
+    const big = Buffer.alloc(64 * 1024, 1);
+    const parts = [Buffer.from('ab'), Buffer.from('cd'), Buffer.from('ef')];
+
+    console.log(`${COUNT} iterations`);
+    time('Buffer.alloc(64)', () => Buffer.alloc(64));
+    time('Buffer.allocUnsafe(64)', () => Buffer.allocUnsafe(64));
+    time('Buffer.alloc(4096)', () => Buffer.alloc(4096));
+    time('Buffer.from(string)', () => Buffer.from(text));
+    time('Buffer.from(array)', () => Buffer.from(bytes));
+    time('Buffer.from(arrayBuffer)', () => Buffer.from(big.buffer, 16, 64));
+    time('buf.slice(i, i + 64)', (i) => big.slice(i & 0x7fff, (i & 0x7fff) + 64));
+    time('buf.subarray(i, i + 64)', (i) => big.subarray(i & 0x7fff, (i & 0x7fff) + 64));
+    time('Buffer.concat(3 parts)', () => Buffer.concat(parts));
+
+    // Every path above has to produce the same hidden class for the optimizer to stay monomorphic.
+    const samples = [Buffer.alloc(1), Buffer.from('x'), big.slice(0, 1), Buffer.concat(parts)];
+    if (!samples.every((b) => Object.getPrototypeOf(b) === Buffer.prototype)) console.log('[FAIL] prototype mismatch');
+}
+
+main();
@@ -0,0 +1,73 @@
+// Per-call cost of the small Buffer methods that have V8 Fast API paths. Run the same file
+// under node to compare:
+//   z8 test/buffer/bench_fast_api.js
+const CALLS = 20000000;
+
+// Each loop is its own function so that every call site gets its own feedback and is optimized.
+function perCall(label, run) {
+    run(100000);
+    const start = process.hrtime.bigint();
+    const sink = run(CALLS);
+    const ns = Number(process.hrtime.bigint() - start) / CALLS;
+    console.log(`${label.padEnd(28)} ${ns.toFixed(2).padStart(7)} ns/call`);
+    return sink;
+}
+
+function main() {
+    const buf = Buffer.alloc(64);
+    const same = Buffer.alloc(64);
+    const other = Buffer.alloc(64, 1);
+
+    perCall('readUInt8', (n) => {
+        let s = 0;
+        for (let i = 0; i < n; i++) s += buf.readUInt8(i & 63);
+        return s;
+    });
+    perCall('readUInt32LE', (n) => {
+        let s = 0;
+        for (let i = 0; i < n; i++) s += buf.readUInt32LE(i & 31);
+        return s;
+    });
+    perCall('readInt32BE', (n) => {
+        let s = 0;
+        for (let i = 0; i < n; i++) s += buf.readInt32BE(i & 31);
+        return s;
+    });
+    perCall('readDoubleLE', (n) => {
+        let s = 0;
+        for (let i = 0; i < n; i++) s += buf.readDoubleLE(i & 31);
+        return s;
+    });
+    perCall('writeUInt32LE', (n) => {
+        let s = 0;
+        for (let i = 0; i < n; i++) s += buf.writeUInt32LE(i >>> 0, i & 31);
+        return s;
+    });
+    perCall('writeDoubleBE', (n) => {
+        let s = 0;
+        for (let i = 0; i < n; i++) s += buf.writeDoubleBE(i * 0.5, i & 31);
+        return s;
+    });
+    perCall('equals (64 bytes)', (n) => {
+        let s = 0;
+        for (let i = 0; i < n; i++) s += (buf.equals(same) ? 1 : 0);
+        return s;
+    });
+    perCall('compare (64 bytes)', (n) => {
+        let s = 0;
+        for (let i = 0; i < n; i++) s += buf.compare(other);
+        return s;
+    });
+    perCall('Buffer.compare (64 bytes)', (n) => {
+        let s = 0;
+        for (let i = 0; i < n; i++) s += Buffer.compare(buf, other);
+        return s;
+    });
+    perCall('Buffer.byteLength (string)', (n) => {
+        let s = 0;
+        for (let i = 0; i < n; i++) s += Buffer.byteLength('héllo wörld');
+        return s;
+    });
+}
+
+main();
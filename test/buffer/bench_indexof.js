@@ -0,0 +1,44 @@
+// indexOf/lastIndexOf throughput for short and long needles over text and periodic data. Run
+// the same file under node to compare, or cap the kernels with Z8_SIMD=scalar|sse41:
+//   z8 test/buffer/bench_indexof.js
+const SIZE = 4 * 1024 * 1024;
+const TOTAL = 512 * 1024 * 1024;
+
+function throughput(label, fn) {
+    const rounds = Math.max(1, Math.floor(TOTAL / SIZE));
+    const start = Date.now();
+    let sink = 0;
+    for (let i = 0; i < rounds; i++) sink += fn();
+    const ms = Math.max(Date.now() - start, 1);
+    console.log(`${label.padEnd(36)} ${String(ms).padStart(7)} ms  ${((rounds * SIZE) / ms / 1000).toFixed(0)} MB/s`);
+    return sink;
+}
+
+function main() {
+    const words = 'lorem ipsum dolor sit amet consectetur adipiscing elit sed do eiusmod tempor ';
+    const text = Buffer.alloc(SIZE, words);
+    const periodic = Buffer.alloc(SIZE, 'a');
+    const boundary = '------WebKitFormBoundary7MA4YWxkTrZu0gW';
+    const boundaryBuf = Buffer.from(boundary);
+    const tricky = Buffer.from('a'.repeat(30) + 'b' + 'a'.repeat(33));
+
+    throughput('byte (miss)', () => text.indexOf(0x0a));
+    throughput('byte reverse (miss)', () => text.lastIndexOf(0x0a));
+    throughput('"\\n" string (miss)', () => text.indexOf('\n'));
+    throughput('4-byte needle (miss)', () => text.indexOf('zzzz'));
+    throughput('4-byte needle reverse (miss)', () => text.lastIndexOf('zzzz'));
+    throughput('boundary string (miss)', () => text.indexOf(boundary));
+    throughput('boundary Buffer (miss)', () => text.indexOf(boundaryBuf));
+    throughput('periodic 64-byte needle (miss)', () => periodic.indexOf(tricky));
+    throughput('periodic 64-byte reverse (miss)', () => periodic.lastIndexOf(tricky));
+
+    // Many short searches: the needle string's conversion dominates unless it is cached.
+    const line = Buffer.from('GET /index.html HTTP/1.1\r\nHost: example.com\r\n\r\n');
+    const start = Date.now();
+    let found = 0;
+    for (let i = 0; i < 2000000; i++) found += line.indexOf('\r\n\r\n');
+    console.log(`${'2M short searches ("\\r\\n\\r\\n")'.padEnd(36)} ${String(Date.now() - start).padStart(7)} ms`);
+    return found;
+}
+
+main();
@@ -0,0 +1,112 @@
+// Checks base64/base64url against a plain JS codec across the lengths that exercise the vector
+// kernels, their scalar tails and the skip path for whitespace and junk.
+const ALPHABET = 'ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/';
+const atob = globalThis.atob ?? Buffer.atob;
+const btoa = globalThis.btoa ?? Buffer.btoa;
+
+function reference(bytes, url) {
+    let out = '';
+    for (let i = 0; i < bytes.length; i += 3) {
+        const n = (bytes[i] << 16) | ((bytes[i + 1] ?? 0) << 8) | (bytes[i + 2] ?? 0);
+        const chars = Math.min(4, bytes.length - i + 1);
+        for (let k = 0; k < 4; k++) out += k < chars ? ALPHABET[(n >> (18 - 6 * k)) & 63] : url ? '' : '=';
+    }
+    return url ? out.replace(/\+/g, '-').replace(/\//g, '_') : out;
+}
+
+function pattern(length, seed) {
+    const bytes = Buffer.allocUnsafe(length);
+    for (let i = 0; i < length; i++) bytes[i] = (i * 131 + seed * 17 + (i >> 7)) & 0xff;
+    return bytes;
+}
+
+async function runTest(name, testFn) {
+    try {
+        console.log(`[RUNNING] ${name}`);
+        await testFn();
+        console.log(`[PASS] ${name}`);
+    } catch (e) {
+        console.error(`[FAIL] ${name}`);
+        console.error(`  Error: ${e.message}`);
+        process.exit(1);
+    }
+}
+
+async function main() {
+    for (let length = 0; length < 300; length++) {
+        const bytes = pattern(length, length);
+        const text = bytes.toString('base64');
+        if (text !== reference(bytes, false)) {
+            throw new Error(`base64 of ${length} bytes is wrong`);
+        }
+        if (bytes.toString('base64url') !== reference(bytes, true)) {
+            throw new Error(`base64url of ${length} bytes is wrong`);
+        }
+        if (!Buffer.from(text, 'base64').equals(bytes)) {
+            throw new Error(`base64 round trip of ${length} bytes failed`);
+        }
+        if (!Buffer.from(reference(bytes, true), 'base64url').equals(bytes)) {
+            throw new Error(`base64url round trip ${length} failed`);
+        }
+        if (Buffer.byteLength(text, 'base64') !== length) {
+            throw new Error(`byteLength of ${length} bytes is wrong`);
+        }
+    }
+
+    const big = pattern(3 * 1024 * 1024 + 7, 3);
+    const bigText = big.toString('base64');
+    if (bigText !== reference(big, false)) {
+        throw new Error('base64 of a large Buffer is wrong');
+    }
+    if (!Buffer.from(bigText, 'base64').equals(big)) {
+        throw new Error('large base64 round trip failed');
+    }
+
+    // MIME-style line breaks, stray whitespace, and both alphabets mixed are skipped or accepted.
+    const head = bigText.slice(0, 4000);
+    const wrapped = head.replace(/.{76}/g, '$&\r\n');
+    if (!Buffer.from(wrapped, 'base64').equals(Buffer.from(head, 'base64'))) {
+        throw new Error('line breaks broke decoding');
+    }
+    if (Buffer.from(' QU JD\tRA== ', 'base64').toString() !== 'ABCD') {
+        throw new Error('whitespace was not skipped');
+    }
+    if (!Buffer.from('-_-_', 'base64').equals(Buffer.from('+/+/', 'base64'))) {
+        throw new Error('base64 rejected url characters');
+    }
+    if (Buffer.from('QUJD=RUZH', 'base64').toString() !== 'ABC') {
+        throw new Error("decoding did not stop at '='");
+    }
+    if (Buffer.from('QUJDR', 'base64').toString() !== 'ABC') {
+        throw new Error('a lone trailing character was kept');
+    }
+    if (Buffer.from('QUJD\u3000RUZH', 'base64').toString() !== 'ABCEFG') {
+        throw new Error('two-byte input was not decoded');
+    }
+
+    const target = Buffer.alloc(8, 0xaa);
+    if (target.write('QUJDREVGR0g=', 2, 'base64') !== 6) {
+        throw new Error('write did not stop at the end of the Buffer');
+    }
+    if (target.toString('latin1', 0, 8) !== '\xaa\xaaABCDEF') {
+        throw new Error('write put bytes in the wrong place');
+    }
+
+    if (btoa('\xff\xfe\x00') !== '//4A') {
+        throw new Error('btoa did not treat its input as Latin-1');
+    }
+    if (atob(' //4A\n') !== '\xff\xfe\x00') {
+        throw new Error('atob did not return Latin-1');
+    }
+    let threw = false;
+    try {
+        btoa('€');
+    } catch (e) {
+        threw = e.name === 'InvalidCharacterError';
+    }
+    if (!threw) {
+        throw new Error('btoa accepted a character outside Latin-1');
+    }
+}
+
+runTest('base64', main);
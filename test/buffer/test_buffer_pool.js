@@ -0,0 +1,96 @@
+// Checks the shared allocUnsafe pool: small Buffers share a slab, big ones and
+// allocUnsafeSlow get their own, and contents stay independent.
+async function runTest(name, testFn) {
+    try {
+        console.log(`[RUNNING] ${name}`);
+        await testFn();
+        console.log(`[PASS] ${name}`);
+    } catch (e) {
+        console.error(`[FAIL] ${name}`);
+        console.error(`  Error: ${e.message}`);
+        process.exit(1);
+    }
+}
+
+async function main() {
+    const a = Buffer.allocUnsafe(10);
+    const b = Buffer.allocUnsafe(10);
+    if (a.buffer !== b.buffer) {
+        throw new Error('small allocUnsafe calls did not share the pool');
+    }
+    if (b.byteOffset % 8 !== 0) {
+        throw new Error(`pooled Buffer is not 8-byte aligned (${b.byteOffset})`);
+    }
+    a.fill(1);
+    b.fill(2);
+    if (!(a[9] === 1 && b[0] === 2)) {
+        throw new Error('pooled Buffers overlap');
+    }
+
+    if (Buffer.allocUnsafe(Buffer.poolSize).buffer.byteLength !== Buffer.poolSize) {
+        throw new Error('large Buffer was pooled');
+    }
+    if (Buffer.allocUnsafeSlow(10).buffer.byteLength !== 10) {
+        throw new Error('allocUnsafeSlow used the pool');
+    }
+    if (!Buffer.alloc(16).every((v) => v === 0)) {
+        throw new Error('alloc returned dirty memory');
+    }
+    if (!Buffer.alloc(16, 7).every((v) => v === 7)) {
+        throw new Error('alloc ignored a numeric fill');
+    }
+
+    const text = Buffer.from('pooled text');
+    if (text.toString() !== 'pooled text') {
+        throw new Error('pooled Buffer.from(string) lost its contents');
+    }
+    if (Buffer.from(text).toString() !== 'pooled text') {
+        throw new Error('copy of a pooled Buffer is wrong');
+    }
+    if (Buffer.from([1, 2, 3]).join() !== '1,2,3') {
+        throw new Error('pooled Buffer.from(array) is wrong');
+    }
+    const joined = Buffer.concat([text.subarray(0, 6), Buffer.from('!')], 10);
+    if (joined.toString('latin1', 0, 7) !== 'pooled!') {
+        throw new Error('concat of pooled Buffers is wrong');
+    }
+    if (!(joined[7] === 0 && joined[9] === 0)) {
+        throw new Error('concat did not zero-fill past its inputs');
+    }
+
+    // A new slab picks up the current poolSize once the old one runs out.
+    const saved = Buffer.poolSize;
+    Buffer.poolSize = 64;
+    let last = null;
+    for (let i = 0; i < saved; i += 24) last = Buffer.allocUnsafe(20);
+    if (last.buffer.byteLength !== 64) {
+        throw new Error(`new slab ignored poolSize (${last.buffer.byteLength} bytes)`);
+    }
+    Buffer.poolSize = saved;
+
+    // Transferring the slab away must not leave later allocations pointing into freed memory.
+    const before = Buffer.allocUnsafe(8);
+    const moved = before.buffer.transfer();
+    const after = Buffer.allocUnsafe(8);
+    if (after.buffer === before.buffer || after.buffer.detached) {
+        throw new Error('allocUnsafe carved from a transferred pool');
+    }
+    after.fill(9);
+    new Uint8Array(moved).fill(3);
+    if (!after.every((v) => v === 9)) {
+        throw new Error('pooled Buffer shares memory with a transferred pool');
+    }
+
+    // A non-finite or huge poolSize falls back to the default slab size.
+    for (const size of [Infinity, 2 ** 53]) {
+        Buffer.poolSize = size;
+        let slab = null;
+        for (let i = 0; i < saved; i += 8) slab = Buffer.allocUnsafe(8);
+        if (slab.buffer.byteLength !== 8192) {
+            throw new Error(`poolSize ${size} was used for a slab (${slab.buffer.byteLength} bytes)`);
+        }
+    }
+    Buffer.poolSize = saved;
+}
+
+runTest('buffer pool', main);
@@ -0,0 +1,143 @@
+// Checks the numeric read/write methods, equals, compare and byteLength in loops long enough
+// for the call sites to be optimized, so both the callbacks and their fast paths run.
+function random(seed) {
+    return () => (seed = (seed * 1103515245 + 12345) & 0x7fffffff);
+}
+
+const ROUNDS = 200000;
+
+// One entry per method pair. Every read/write goes through its own arrow with a direct call, so
+// each call site only ever sees one Buffer method and stays monomorphic once optimized; a
+// computed buf[name](...) call would share one megamorphic site across all of them.
+const UINT8 = (r) => r() & 0xff;
+const INT8 = (r) => (r() & 0xff) - 128;
+const UINT16 = (r) => r() & 0xffff;
+const INT16 = (r) => (r() & 0xffff) - 32768;
+const UINT32 = (r) => r() * 2 + (r() & 1);
+const INT32 = (r) => r() - 0x40000000;
+const FLOAT = (r) => Math.fround((r() - 0x40000000) / 977);
+const DOUBLE = (r) => (r() - 0x40000000) / 977;
+
+const TYPES = [
+    ['UInt8', 1, false, 'Uint8', UINT8, (b, v, o) => b.writeUInt8(v, o), (b, o) => b.readUInt8(o)],
+    ['Int8', 1, false, 'Int8', INT8, (b, v, o) => b.writeInt8(v, o), (b, o) => b.readInt8(o)],
+    ['UInt16BE', 2, false, 'Uint16', UINT16, (b, v, o) => b.writeUInt16BE(v, o), (b, o) => b.readUInt16BE(o)],
+    ['UInt16LE', 2, true, 'Uint16', UINT16, (b, v, o) => b.writeUInt16LE(v, o), (b, o) => b.readUInt16LE(o)],
+    ['Int16BE', 2, false, 'Int16', INT16, (b, v, o) => b.writeInt16BE(v, o), (b, o) => b.readInt16BE(o)],
+    ['Int16LE', 2, true, 'Int16', INT16, (b, v, o) => b.writeInt16LE(v, o), (b, o) => b.readInt16LE(o)],
+    ['UInt32BE', 4, false, 'Uint32', UINT32, (b, v, o) => b.writeUInt32BE(v, o), (b, o) => b.readUInt32BE(o)],
+    ['UInt32LE', 4, true, 'Uint32', UINT32, (b, v, o) => b.writeUInt32LE(v, o), (b, o) => b.readUInt32LE(o)],
+    ['Int32BE', 4, false, 'Int32', INT32, (b, v, o) => b.writeInt32BE(v, o), (b, o) => b.readInt32BE(o)],
+    ['Int32LE', 4, true, 'Int32', INT32, (b, v, o) => b.writeInt32LE(v, o), (b, o) => b.readInt32LE(o)],
+    ['FloatBE', 4, false, 'Float32', FLOAT, (b, v, o) => b.writeFloatBE(v, o), (b, o) => b.readFloatBE(o)],
+    ['FloatLE', 4, true, 'Float32', FLOAT, (b, v, o) => b.writeFloatLE(v, o), (b, o) => b.readFloatLE(o)],
+    ['DoubleBE', 8, false, 'Float64', DOUBLE, (b, v, o) => b.writeDoubleBE(v, o), (b, o) => b.readDoubleBE(o)],
+    ['DoubleLE', 8, true, 'Float64', DOUBLE, (b, v, o) => b.writeDoubleLE(v, o), (b, o) => b.readDoubleLE(o)],
+];
+
+function checkType([name, size, little, kind, value, write, read]) {
+    const next = random(size * 31 + name.length);
+    const buf = Buffer.alloc(64);
+    const view = new DataView(buf.buffer, buf.byteOffset, buf.byteLength);
+    for (let i = 0; i < ROUNDS; i++) {
+        const v = value(next);
+        const off = next() % (65 - size);
+        if (write(buf, v, off) !== off + size) {
+            throw new Error(`write${name} returns the next offset`);
+        }
+        if (view[`get${kind}`](off, little) !== v) {
+            throw new Error(`write${name}(${v}, ${off}) stores the value`);
+        }
+        view[`set${kind}`](off, v, little);
+        if (read(buf, off) !== v) {
+            throw new Error(`read${name}(${off}) returns ${v}`);
+        }
+    }
+    for (let i = 0; i < 1000; i++) {
+        let threw = false;
+        try {
+            read(buf, 64 - size + 1 + (i % 4));
+        } catch (e) {
+            threw = e instanceof RangeError;
+        }
+        if (!threw) {
+            throw new Error(`read${name} past the end throws a RangeError`);
+        }
+    }
+}
+
+async function runTest(name, testFn) {
+    try {
+        console.log(`[RUNNING] ${name}`);
+        await testFn();
+        console.log(`[PASS] ${name}`);
+    } catch (e) {
+        console.error(`[FAIL] ${name}`);
+        console.error(`  Error: ${e.message}`);
+        process.exit(1);
+    }
+}
+
+async function main() {
+    for (const type of TYPES) checkType(type);
+    if (typeof Buffer.alloc(4).writeUInt8 !== 'function') {
+        throw new Error('writeUInt8 exists');
+    }
+
+    const next = random(3);
+    const a = Buffer.alloc(40);
+    const b = Buffer.alloc(40);
+    let equal = 0;
+    for (let i = 0; i < ROUNDS; i++) {
+        const len = next() % 40;
+        const x = a.subarray(0, len);
+        const y = b.subarray(0, next() % 2 ? len : next() % 40);
+        if (next() % 2) y.fill(next() & 3);
+        else y.set(x.subarray(0, Math.min(x.length, y.length)));
+        let cmp = 0;
+        for (let j = 0; j < Math.min(x.length, y.length) && cmp === 0; j++) cmp = Math.sign(x[j] - y[j]);
+        if (cmp === 0) cmp = Math.sign(x.length - y.length);
+        if (x.compare(y) !== cmp) {
+            throw new Error(`compare at round ${i}`);
+        }
+        if (Buffer.compare(x, y) !== cmp) {
+            throw new Error(`Buffer.compare at round ${i}`);
+        }
+        if (x.equals(y) !== (cmp === 0)) {
+            throw new Error(`equals at round ${i}`);
+        }
+        if (cmp === 0) equal++;
+        a[next() % 40] = next() & 3;
+    }
+    if (equal <= 0) {
+        throw new Error('some buffers compared equal');
+    }
+    let threw = 0;
+    for (let i = 0; i < 1000; i++) {
+        try {
+            a.equals(i % 2 ? 'abc' : {});
+        } catch (e) {
+            if (e instanceof TypeError) threw++;
+        }
+    }
+    if (threw !== 1000) {
+        throw new Error('equals with a non-buffer throws a TypeError');
+    }
+
+    const strings = ['', 'ascii', 'café', '€10', '😀', 'x'.repeat(300) + 'ÿ'];
+    const lengths = [0, 5, 5, 5, 4, 302];
+    for (let i = 0; i < ROUNDS; i++) {
+        const k = i % strings.length;
+        if (Buffer.byteLength(strings[k]) !== lengths[k]) {
+            throw new Error(`byteLength of string ${k}`);
+        }
+        if (Buffer.byteLength(a) !== 40) {
+            throw new Error('byteLength of a Buffer');
+        }
+        if (Buffer.byteLength(a.buffer.slice(0, k)) !== k) {
+            throw new Error('byteLength of an ArrayBuffer');
+        }
+    }
+}
+
+runTest('fast API read/write/equals/compare/byteLength', main);
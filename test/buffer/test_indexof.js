@@ -0,0 +1,111 @@
+// Checks indexOf/lastIndexOf/includes against a byte-by-byte search over small alphabets (many
+// partial matches), long and periodic needles, every offset form and needle encodings.
+function naive(hay, needle, from, forward) {
+    const last = hay.length - needle.length;
+    if (forward) {
+        for (let i = from; i <= last; i++) if (hay.compare(needle, 0, needle.length, i, i + needle.length) === 0) return i;
+    } else {
+        for (let i = Math.min(from, last); i >= 0; i--) {
+            if (hay.compare(needle, 0, needle.length, i, i + needle.length) === 0) return i;
+        }
+    }
+    return -1;
+}
+
+function random(seed) {
+    return () => (seed = (seed * 1103515245 + 12345) & 0x7fffffff);
+}
+
+async function runTest(name, testFn) {
+    try {
+        console.log(`[RUNNING] ${name}`);
+        await testFn();
+        console.log(`[PASS] ${name}`);
+    } catch (e) {
+        console.error(`[FAIL] ${name}`);
+        console.error(`  Error: ${e.message}`);
+        process.exit(1);
+    }
+}
+
+async function main() {
+    const next = random(7);
+    for (let round = 0; round < 3000; round++) {
+        const alphabet = [2, 4, 256][round % 3];
+        const hay = Buffer.alloc(next() % (round % 10 === 0 ? 2000 : 200));
+        for (let i = 0; i < hay.length; i++) hay[i] = 97 + (next() % alphabet);
+        const needle = Buffer.alloc(1 + (next() % (round % 4 === 0 ? 70 : 6)));
+        if (needle.length > hay.length) continue;
+        const at = next() % (hay.length - needle.length + 1);
+        for (let i = 0; i < needle.length; i++) needle[i] = next() % 2 ? hay[at + i] : 97 + (next() % alphabet);
+        const from = next() % (hay.length + 1);
+        if (hay.indexOf(needle, from) !== naive(hay, needle, from, true)) {
+            throw new Error(`indexOf round ${round}`);
+        }
+        if (hay.lastIndexOf(needle, from) !== naive(hay, needle, from, false)) {
+            throw new Error(`lastIndexOf round ${round}`);
+        }
+        if (hay.includes(needle) !== (naive(hay, needle, 0, true) >= 0)) {
+            throw new Error(`includes round ${round}`);
+        }
+    }
+
+    // Periodic haystacks that defeat the first/last byte filter.
+    const periodic = Buffer.alloc(1 << 16, 'a');
+    const tricky = Buffer.from('a'.repeat(30) + 'b' + 'a'.repeat(33));
+    if (!(periodic.indexOf(tricky) === -1 && periodic.lastIndexOf(tricky) === -1)) {
+        throw new Error('periodic miss');
+    }
+    tricky.copy(periodic, 40000);
+    if (!(periodic.indexOf(tricky) === 40000 && periodic.lastIndexOf(tricky) === 40000)) {
+        throw new Error('periodic hit');
+    }
+
+    // Offsets and empty needles follow Node.
+    const abc = Buffer.from('abc');
+    if (!(abc.lastIndexOf('') === 3 && abc.lastIndexOf('', 1) === 1 && abc.indexOf('', 10) === 3)) {
+        throw new Error('empty needle');
+    }
+    if (!(abc.lastIndexOf('', -1) === 2 && abc.lastIndexOf('', -10) === 0 && abc.indexOf('', -10) === 0)) {
+        throw new Error('empty needle');
+    }
+    if (!(Buffer.alloc(0).lastIndexOf('') === 0 && Buffer.alloc(0).indexOf('a') === -1)) {
+        throw new Error('empty buffer');
+    }
+    if (!(abc.lastIndexOf('c', -1) === 2 && abc.lastIndexOf('a', -5) === -1)) {
+        throw new Error('negative lastIndexOf offset');
+    }
+    if (!(abc.indexOf('b', -2) === 1 && abc.indexOf('b', 5) === -1 && abc.lastIndexOf('bc', 5) === 1)) {
+        throw new Error('offsets');
+    }
+    if (!(abc.indexOf(98.7) === 1 && abc.indexOf(0x162) === 1 && abc.lastIndexOf(97, null) === 0)) {
+        throw new Error('number needles');
+    }
+
+    // Needles in other encodings, including an encoding given in place of byteOffset.
+    if (!(abc.indexOf('62', 'hex') === 1 && abc.indexOf('YmM=', 0, 'base64') === 1)) {
+        throw new Error('encoded needles');
+    }
+    const wide = Buffer.from('xaxbab', 'latin1');
+    if (!(wide.indexOf('a', 'latin1') === 1 && wide.lastIndexOf('ab', 'latin1') === 4)) {
+        throw new Error('latin1 needles');
+    }
+    const units = Buffer.from('愀戀', 'ucs2');
+    if (units.indexOf('a', 'ucs2') !== -1) {
+        throw new Error('ucs2 needle matched at an odd offset');
+    }
+    if (Buffer.from('abcabc', 'ucs2').lastIndexOf('ca', 'ucs2') !== 4) {
+        throw new Error('ucs2 lastIndexOf');
+    }
+
+    // The same needle string, searched repeatedly, keeps giving the same answers.
+    const boundary = '--' + 'x'.repeat(30);
+    const body = Buffer.from(`head${boundary}one${boundary}two${boundary}`);
+    const parts = [];
+    for (let at = body.indexOf(boundary); at >= 0; at = body.indexOf(boundary, at + 1)) parts.push(at);
+    if (parts.join() !== '4,39,74') {
+        throw new Error(`boundary positions ${parts.join()}`);
+    }
+}
+
+runTest('indexOf', main);
@@ -0,0 +1,120 @@
+// Checks hex, latin1/ascii and ucs2/utf16le conversions, including lengths that end inside and
+// past the vector blocks and Buffers at odd offsets.
+function pattern(length) {
+    const bytes = Buffer.allocUnsafe(length);
+    for (let i = 0; i < length; i++) bytes[i] = (i * 167 + (i >> 5)) & 0xff;
+    return bytes;
+}
+
+function hexOf(bytes) {
+    let out = '';
+    for (const b of bytes) out += (b < 16 ? '0' : '') + b.toString(16);
+    return out;
+}
+
+async function runTest(name, testFn) {
+    try {
+        console.log(`[RUNNING] ${name}`);
+        await testFn();
+        console.log(`[PASS] ${name}`);
+    } catch (e) {
+        console.error(`[FAIL] ${name}`);
+        console.error(`  Error: ${e.message}`);
+        process.exit(1);
+    }
+}
+
+async function main() {
+    for (let length = 0; length < 200; length++) {
+        const bytes = pattern(length);
+        const hex = bytes.toString('hex');
+        if (hex !== hexOf(bytes)) {
+            throw new Error(`hex of ${length} bytes is wrong`);
+        }
+        if (!Buffer.from(hex, 'hex').equals(bytes)) {
+            throw new Error(`hex round trip of ${length} bytes failed`);
+        }
+        if (!Buffer.from(hex.toUpperCase(), 'hex').equals(bytes)) {
+            throw new Error(`upper-case hex of ${length} bytes failed`);
+        }
+
+        const text = bytes.toString('latin1');
+        if (!(text.length === length && (length === 0 || text.charCodeAt(length - 1) === bytes[length - 1]))) {
+            throw new Error(`latin1 of ${length} bytes is wrong`);
+        }
+        if (!Buffer.from(text, 'latin1').equals(bytes)) {
+            throw new Error(`latin1 round trip of ${length} bytes failed`);
+        }
+        if (Buffer.from(text, 'ucs2').toString('ucs2') !== text) {
+            throw new Error(`ucs2 round trip of ${length} chars failed`);
+        }
+    }
+
+    // Hex stops at the first pair that is not two digits; odd trailing digits are dropped.
+    if (Buffer.from('abzz12', 'hex').toString('hex') !== 'ab') {
+        throw new Error('hex did not stop at an invalid pair');
+    }
+    if (Buffer.from('abc', 'hex').toString('hex') !== 'ab') {
+        throw new Error('odd hex digit was kept');
+    }
+    const longHex = 'ab'.repeat(40) + 'x0' + 'cd'.repeat(40);
+    if (Buffer.from(longHex, 'hex').length !== 40) {
+        throw new Error('hex kept decoding past an invalid block');
+    }
+    if (Buffer.alloc(4).write('aabbzz', 'hex') !== 2) {
+        throw new Error('hex write did not stop at an invalid pair');
+    }
+    if (Buffer.byteLength('abc', 'hex') !== 1) {
+        throw new Error('hex byteLength is wrong');
+    }
+
+    // Characters past U+00FF keep their low byte; ascii decoding clears the high bit.
+    if (Buffer.from('é€', 'latin1').toString('hex') !== 'e9ac') {
+        throw new Error('latin1 did not keep low bytes');
+    }
+    const wide = 'x€'.repeat(40);
+    if (Buffer.from(wide, 'latin1').toString('hex') !== '78ac'.repeat(40)) {
+        throw new Error('two-byte latin1 is wrong');
+    }
+    if (Buffer.from([0x41, 0xe9, 0xff]).toString('ascii') !== 'Ai\x7f') {
+        throw new Error('ascii kept the high bit');
+    }
+
+    // UTF-16LE at odd offsets, whole code units only.
+    const units = Buffer.from('Aé☺ pair 😀 end', 'utf16le');
+    if (units.toString('ucs2') !== 'Aé☺ pair 😀 end') {
+        throw new Error('utf16le round trip failed');
+    }
+    const odd = Buffer.alloc(units.length + 2);
+    units.copy(odd, 1);
+    if (odd.subarray(1, units.length + 1).toString('utf-16le') !== 'Aé☺ pair 😀 end') {
+        throw new Error('unaligned utf16le failed');
+    }
+    if (Buffer.from([0x41, 0, 0x42]).toString('utf16le') !== 'A') {
+        throw new Error('a trailing odd byte was decoded');
+    }
+    const target = Buffer.alloc(5);
+    if (target.write('abcd', 'ucs2') !== 4) {
+        throw new Error('ucs2 write did not stop at whole units');
+    }
+    if (target.toString('hex') !== '6100620000') {
+        throw new Error('ucs2 write put the wrong bytes');
+    }
+    if (!(Buffer.byteLength('é€', 'ucs2') === 4 && Buffer.byteLength('é€', 'latin1') === 2)) {
+        throw new Error('byteLength is wrong');
+    }
+
+    const big = pattern(1 << 20);
+    if (!Buffer.from(big.toString('hex'), 'hex').equals(big)) {
+        throw new Error('large hex round trip failed');
+    }
+    if (!Buffer.from(big.toString('latin1'), 'latin1').equals(big)) {
+        throw new Error('large latin1 round trip failed');
+    }
+    const bigText = big.toString('latin1');
+    if (Buffer.from(bigText, 'ucs2').toString('ucs2') !== bigText) {
+        throw new Error('large ucs2 round trip failed');
+    }
+}
+
+runTest('transcode', main);
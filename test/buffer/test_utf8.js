@@ -0,0 +1,116 @@
+// Checks UTF-8 conversions of one-byte (ASCII and Latin-1) and two-byte strings: from, write,
+// fill, byteLength and toString, with truncation at whole characters and lone surrogates.
+function encodeUtf8(text) {
+    const bytes = [];
+    for (const ch of text) {
+        let cp = ch.codePointAt(0);
+        if (cp >= 0xd800 && cp <= 0xdfff) cp = 0xfffd;
+        if (cp < 0x80) bytes.push(cp);
+        else if (cp < 0x800) bytes.push(0xc0 | (cp >> 6), 0x80 | (cp & 0x3f));
+        else if (cp < 0x10000) bytes.push(0xe0 | (cp >> 12), 0x80 | ((cp >> 6) & 0x3f), 0x80 | (cp & 0x3f));
+        else bytes.push(0xf0 | (cp >> 18), 0x80 | ((cp >> 12) & 0x3f), 0x80 | ((cp >> 6) & 0x3f), 0x80 | (cp & 0x3f));
+    }
+    return Buffer.from(bytes);
+}
+
+function text(length, alphabet) {
+    alphabet = Array.from(alphabet);
+    let out = '';
+    for (let i = 0; i < length; i++) out += alphabet[(i * 7 + (i >> 3)) % alphabet.length];
+    return out;
+}
+
+async function runTest(name, testFn) {
+    try {
+        console.log(`[RUNNING] ${name}`);
+        await testFn();
+        console.log(`[PASS] ${name}`);
+    } catch (e) {
+        console.error(`[FAIL] ${name}`);
+        console.error(`  Error: ${e.message}`);
+        process.exit(1);
+    }
+}
+
+async function main() {
+    const alphabets = {
+        ascii: 'abcdefghijklmnopqrstuvwxyz0123456789 ',
+        latin1: 'abcdefghéÿ\u0080 xyz',
+        twoByte: 'abc€é中😀 ',
+    };
+    for (const [name, alphabet] of Object.entries(alphabets)) {
+        for (let length = 0; length < 160; length++) {
+            const str = text(length, alphabet);
+            const expected = encodeUtf8(str);
+            const buf = Buffer.from(str);
+            if (!buf.equals(expected)) {
+                throw new Error(`${name} from() of ${length} chars is wrong`);
+            }
+            if (Buffer.byteLength(str) !== expected.length) {
+                throw new Error(`${name} byteLength of ${length} chars is wrong`);
+            }
+            if (buf.toString() !== str) {
+                throw new Error(`${name} toString of ${length} chars is wrong`);
+            }
+        }
+    }
+
+    // write() stops before a character that does not fit.
+    const target = Buffer.alloc(4, 0x2e);
+    if (!(target.write('abéé') === 4 && target.toString() === 'abé')) {
+        throw new Error('latin1 write truncated badly');
+    }
+    if (Buffer.alloc(3, 0x2e).write('aéé') !== 3) {
+        throw new Error('latin1 write split a character');
+    }
+    if (Buffer.alloc(5).write('ab€€') !== 5) {
+        throw new Error('two-byte write split a character');
+    }
+    if (Buffer.alloc(8).write('éé', 3) !== 4) {
+        throw new Error('write at an offset is wrong');
+    }
+
+    // Lone surrogates become U+FFFD; pairs become one four-byte character.
+    if (Buffer.from('a\ud800b').toString('hex') !== '61efbfbd62') {
+        throw new Error('lone surrogate was not replaced');
+    }
+    if (!(Buffer.byteLength('😀') === 4 && Buffer.byteLength('\ud83d') === 3)) {
+        throw new Error('surrogate byteLength');
+    }
+
+    // fill() and alloc() repeat the encoded pattern, honouring the encoding argument.
+    if (Buffer.alloc(7, 'éa').toString('hex') !== 'c3a961c3a961c3') {
+        throw new Error('alloc utf8 fill is wrong');
+    }
+    if (Buffer.alloc(5, 'ab12', 'hex').toString('hex') !== 'ab12ab12ab') {
+        throw new Error('alloc hex fill is wrong');
+    }
+    if (Buffer.alloc(4).fill('€', 1).toString('hex') !== '00e282ac') {
+        throw new Error('utf8 fill is wrong');
+    }
+    if (Buffer.alloc(6).fill('YQ==', 'base64').toString() !== 'aaaaaa') {
+        throw new Error('base64 fill is wrong');
+    }
+    if (Buffer.alloc(3).fill('').toString('hex') !== '000000') {
+        throw new Error('empty fill did not zero');
+    }
+
+    // Large strings, including ones V8 builds from pieces.
+    const big = text(1 << 20, alphabets.ascii);
+    if (Buffer.from(big).toString() !== big) {
+        throw new Error('large ascii round trip failed');
+    }
+    const mixed = big + 'é' + big;
+    if (Buffer.byteLength(mixed) !== 2 * big.length + 2) {
+        throw new Error('large latin1 byteLength is wrong');
+    }
+    if (Buffer.from(mixed).toString() !== mixed) {
+        throw new Error('large latin1 round trip failed');
+    }
+    const wide = big + '€';
+    if (Buffer.from(wide).toString() !== wide) {
+        throw new Error('large two-byte round trip failed');
+    }
+}
+
+runTest('utf8', main);
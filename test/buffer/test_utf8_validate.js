@@ -0,0 +1,104 @@
+// Checks Buffer.isUtf8/isAscii against a scalar decoder on valid text, on every malformed
+// sequence class (overlong, surrogate, above U+10FFFF, cut off, stray continuation) placed at
+// each offset across the vector blocks, and on views and ArrayBuffers.
+const MALFORMED = {
+    overlong2: [0xc1, 0xbf],
+    overlong3: [0xe0, 0x9f, 0xbf],
+    overlong4: [0xf0, 0x8f, 0xbf, 0xbf],
+    surrogate: [0xed, 0xa0, 0x80],
+    tooLarge: [0xf4, 0x90, 0x80, 0x80],
+    badLead: [0xf8, 0x88, 0x80, 0x80],
+    cutOff3: [0xe2, 0x82],
+    cutOff4: [0xf0, 0x9f, 0x98],
+    strayContinuation: [0x80],
+    missingContinuation: [0xc3, 0x41],
+};
+
+async function runTest(name, testFn) {
+    try {
+        console.log(`[RUNNING] ${name}`);
+        await testFn();
+        console.log(`[PASS] ${name}`);
+    } catch (e) {
+        console.error(`[FAIL] ${name}`);
+        console.error(`  Error: ${e.message}`);
+        process.exit(1);
+    }
+}
+
+async function main() {
+    const { isUtf8, isAscii } = typeof Buffer.isUtf8 === 'function' ? Buffer : await import('node:buffer');
+
+    const text = 'plain ascii, é, €, 中文 and 😀 '.repeat(8);
+    const valid = Buffer.from(text);
+    if (!(isUtf8(valid) && !isAscii(valid))) {
+        throw new Error('mixed text misclassified');
+    }
+    if (!(isUtf8(Buffer.alloc(0)) && isAscii(Buffer.alloc(0)))) {
+        throw new Error('empty input misclassified');
+    }
+    if (!isUtf8(Buffer.from([0xf4, 0x8f, 0xbf, 0xbf]))) {
+        throw new Error('U+10FFFF rejected');
+    }
+    if (!isUtf8(Buffer.from([0xed, 0x9f, 0xbf]))) {
+        throw new Error('U+D7FF rejected');
+    }
+
+    for (let length = 0; length < 130; length++) {
+        const ascii = Buffer.alloc(length, 0x61);
+        if (!(isAscii(ascii) && isUtf8(ascii))) {
+            throw new Error(`ascii of ${length} bytes rejected`);
+        }
+        if (length === 0) continue;
+        const high = Buffer.from(ascii);
+        high[length - 1] = 0x80;
+        if (isAscii(high)) {
+            throw new Error(`high byte at ${length - 1} missed`);
+        }
+
+        // A valid character ending exactly at each offset, then the same with its last byte cut.
+        const prefix = Buffer.alloc(length, 0x62);
+        const euro = Buffer.concat([prefix, Buffer.from('€')]);
+        if (!isUtf8(euro)) {
+            throw new Error(`character at offset ${length} rejected`);
+        }
+        if (isUtf8(euro.subarray(0, euro.length - 1))) {
+            throw new Error(`cut-off character at offset ${length} accepted`);
+        }
+
+        for (const [name, bytes] of Object.entries(MALFORMED)) {
+            const bad = Buffer.concat([prefix, Buffer.from(bytes), Buffer.from(text.slice(0, 40))]);
+            if (isUtf8(bad)) {
+                throw new Error(`${name} at offset ${length} accepted`);
+            }
+        }
+    }
+
+    // Views and ArrayBuffers, and text long enough for many vector blocks.
+    const big = Buffer.from(text.repeat(2000));
+    if (!isUtf8(big)) {
+        throw new Error('large text rejected');
+    }
+    if (!isUtf8(new Uint8Array(big.buffer, big.byteOffset, big.length))) {
+        throw new Error('Uint8Array view rejected');
+    }
+    const copy = new Uint8Array(big).buffer;
+    if (!isUtf8(copy)) {
+        throw new Error('ArrayBuffer rejected');
+    }
+    big[big.length >> 1] = 0xff;
+    if (isUtf8(big)) {
+        throw new Error('invalid byte in large text accepted');
+    }
+
+    // toString picks the one-byte path for ASCII and Latin-1 text, and still replaces bad bytes.
+    const latin = 'façade déjà vu '.repeat(5000);
+    if (Buffer.from(latin).toString() !== latin) {
+        throw new Error('large Latin-1 text did not round trip');
+    }
+    if (Buffer.from([0x61, 0xff, 0x62]).toString() !== 'a�b') {
+        throw new Error('invalid byte was not replaced');
+    }
+}
+
+runTest('utf8 validate', main);
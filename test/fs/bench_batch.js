@@ -0,0 +1,35 @@
+import { mkdir, rm, readFile, readMany, writeFile, writeMany, stat, statMany } from 'node:fs/promises';
+
+// Compares the batch entry points against one promise per file. Run with an optional file count:
+//   z8 test/fs/bench_batch.js 50000
+const DIR = './batch_bench_tmp';
+const COUNT = Number(process.argv[2]) || 20000;
+
+async function time(label, fn) {
+    const start = Date.now();
+    await fn();
+    const ms = Date.now() - start;
+    console.log(`${label.padEnd(28)} ${String(ms).padStart(9)} ms  ${((COUNT / ms) * 1000).toFixed(0)} ops/s`);
+}
+
+async function main() {
+    await rm(DIR, { recursive: true, force: true });
+    await mkdir(DIR);
+    const paths = Array.from({ length: COUNT }, (_, i) => `${DIR}/f${i}.json`);
+    const body = JSON.stringify({ id: 0, name: 'bench', tags: ['a', 'b', 'c'] });
+
+    console.log(`${COUNT} small files`);
+    await time('writeFile x N', () => Promise.all(paths.map((p) => writeFile(p, body))));
+    await time('writeMany', () => writeMany(paths.map((p) => [p, body])));
+    await time('readFile x N', () => Promise.all(paths.map((p) => readFile(p, 'utf8'))));
+    await time('readMany', () => readMany(paths, { encoding: 'utf8' }));
+    await time('readMany (iterator)', async () => {
+        for await (const chunk of readMany(paths, { encoding: 'utf8', iterator: true })) void chunk;
+    });
+    await time('stat x N', () => Promise.all(paths.map((p) => stat(p))));
+    await time('statMany', () => statMany(paths));
+
+    await rm(DIR, { recursive: true, force: true });
+}
+
+main().catch((e) => console.log('[FAIL]', e.message));
@@ -0,0 +1,45 @@
+import { mkdir, writeFile, unlink, rm, readFile, readdir } from 'node:fs/promises';
+import { join } from 'node:path';
+
+// Runs the sequential writeFile/unlink workload from test.js and reports wall time and the
+// context switches of every runtime thread. On Linux compare against the thread pool path with
+//   Z8_NO_IO_URING=1 z8 test/fs/bench_io_ring.js
+// and count syscalls by prefixing either run with `strace -f -c`.
+const DIR = './io_ring_bench_tmp';
+const COUNT = Number(process.argv[2]) || 500;
+
+async function contextSwitches() {
+    let total = 0;
+    try {
+        for (const tid of await readdir('/proc/self/task')) {
+            const status = await readFile(`/proc/self/task/${tid}/status`, 'utf8');
+            for (const m of status.matchAll(/^(?:non)?voluntary_ctxt_switches:\s+(\d+)/gm)) total += Number(m[1]);
+        }
+    } catch {
+        return NaN;
+    }
+    return total;
+}
+
+async function main() {
+    await rm(DIR, { recursive: true, force: true });
+    await mkdir(DIR, { recursive: true });
+    const content = 'Test data';
+
+    const switchesBefore = await contextSwitches();
+    const start = Date.now();
+    for (let i = 0; i < COUNT; i++) await writeFile(join(DIR, `f_${i}.txt`), content);
+    const mid = Date.now();
+    for (let i = 0; i < COUNT; i++) await unlink(join(DIR, `f_${i}.txt`));
+    const end = Date.now();
+    const switches = (await contextSwitches()) - switchesBefore;
+
+    console.log(`${COUNT} files, io_uring ${process.env.Z8_NO_IO_URING === '1' ? 'disabled' : 'enabled'}`);
+    console.log(`- writeFile: ${mid - start} ms`);
+    console.log(`- unlink:    ${end - mid} ms`);
+    console.log(`- total:     ${end - start} ms, ${Number.isNaN(switches) ? 'n/a' : switches} context switches`);
+
+    await rm(DIR, { recursive: true, force: true });
+}
+
+main().catch((e) => console.log('[FAIL]', e.message));
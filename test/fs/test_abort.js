@@ -0,0 +1,116 @@
+import { readFile, writeFile, appendFile, rm } from 'node:fs/promises';
+import { EventTarget, Event } from 'node:events';
+import zlib from 'node:zlib';
+
+// Checks { signal } on fs promise calls and zlib async calls: an aborted signal rejects at
+// once with AbortError, and an abort while the work is queued or running rejects promptly.
+const FILE = './abort_src.bin';
+
+// Minimal controller over the runtime's EventTarget when AbortController is not global.
+const Controller =
+    typeof AbortController !== 'undefined'
+        ? AbortController
+        : class {
+              constructor() {
+                  this.signal = new EventTarget();
+                  this.signal.aborted = false;
+                  this.signal.reason = undefined;
+              }
+              abort(reason) {
+                  if (this.signal.aborted) return;
+                  this.signal.aborted = true;
+                  this.signal.reason = reason;
+                  this.signal.dispatchEvent(new Event('abort'));
+              }
+          };
+
+async function expectAbort(promise, what) {
+    try {
+        await promise;
+    } catch (e) {
+        if (!(e.name === 'AbortError' && e.code === 'ABORT_ERR')) {
+            throw new Error(`${what} rejected with ${e.name}: ${e.message}`);
+        }
+        return e;
+    }
+    throw new Error(`${what} was not aborted`);
+}
+
+async function runTest(name, testFn) {
+    try {
+        console.log(`[RUNNING] ${name}`);
+        await testFn();
+        console.log(`[PASS] ${name}`);
+    } catch (e) {
+        console.error(`[FAIL] ${name}`);
+        console.error(`  Error: ${e.message}`);
+        process.exit(1);
+    }
+}
+
+async function main() {
+    const data = Buffer.alloc(32 * 1024 * 1024, 7);
+    await writeFile(FILE, data);
+
+    // Already aborted: nothing is started.
+    const done = new Controller();
+    done.abort('stop');
+    const early = await expectAbort(readFile(FILE, { signal: done.signal }), 'readFile with an aborted signal');
+    if (early.cause !== 'stop') {
+        throw new Error('the abort reason was not kept as cause');
+    }
+    await expectAbort(writeFile('./abort_never.txt', 'x', { signal: done.signal }), 'writeFile with an aborted signal');
+    await expectAbort(appendFile('./abort_never.txt', 'x', { signal: done.signal }), 'appendFile with an aborted signal');
+    await expectAbort(zlib.promises.gzip(data, { signal: done.signal }), 'gzip with an aborted signal');
+    let missing = false;
+    try {
+        await readFile('./abort_never.txt');
+    } catch (e) {
+        missing = true;
+    }
+    if (!missing) {
+        throw new Error('an aborted writeFile still created its file');
+    }
+
+    // Aborted after submission: the promise settles before the work would have finished.
+    const reads = new Controller();
+    const started = Date.now();
+    const pending = readFile(FILE, { signal: reads.signal });
+    reads.abort();
+    await expectAbort(pending, 'in-flight readFile');
+
+    const zip = new Controller();
+    const gzipped = zlib.promises.gzip(data, { level: 9, signal: zip.signal });
+    setTimeout(() => zip.abort(), 1);
+    await expectAbort(gzipped, 'in-flight gzip');
+    const elapsed = Date.now() - started;
+
+    let callbackError = null;
+    const cb = new Controller();
+    await new Promise((resolve) => {
+        zlib.deflate(data, { signal: cb.signal }, (err) => {
+            callbackError = err;
+            resolve();
+        });
+        cb.abort();
+    });
+    if (!(callbackError && callbackError.name === 'AbortError')) {
+        throw new Error('callback deflate was not aborted');
+    }
+
+    // A signal that never fires does not change the result.
+    const idle = new Controller();
+    const text = await readFile(FILE, { signal: idle.signal });
+    if (text.length !== data.length) {
+        throw new Error('readFile with an idle signal returned the wrong size');
+    }
+    const roundTrip = await zlib.promises.gunzip(await zlib.promises.gzip(Buffer.from('abc'), { signal: idle.signal }));
+    if (roundTrip.toString() !== 'abc') {
+        throw new Error('gzip with an idle signal produced bad output');
+    }
+
+    await rm(FILE, { force: true });
+    console.log(`- aborted ops settled in ${elapsed} ms`);
+}
+
+runTest('abort', main);
@@ -0,0 +1,86 @@
+import { mkdir, rm, readMany, statMany, writeMany } from 'node:fs/promises';
+
+// Checks the batch entry points in array and iterator mode, ordering and error reporting.
+const DIR = './batch_tmp';
+const COUNT = 200;
+
+async function runTest(name, testFn) {
+    try {
+        console.log(`[RUNNING] ${name}`);
+        await testFn();
+        console.log(`[PASS] ${name}`);
+    } catch (e) {
+        console.error(`[FAIL] ${name}`);
+        console.error(`  Error: ${e.message}`);
+        process.exit(1);
+    }
+}
+
+async function main() {
+    await rm(DIR, { recursive: true, force: true });
+    await mkdir(DIR);
+
+    const paths = [];
+    const entries = [];
+    for (let i = 0; i < COUNT; i++) {
+        const path = `${DIR}/f${i}.json`;
+        paths.push(path);
+        entries.push(i % 2 ? [path, JSON.stringify({ i })] : { path, data: Buffer.from(JSON.stringify({ i })) });
+    }
+    if ((await writeMany(entries, { chunkSize: 32 })) !== undefined) {
+        throw new Error('writeMany should resolve undefined');
+    }
+
+    const texts = await readMany(paths, { encoding: 'utf8', chunkSize: 16 });
+    if (texts.length !== COUNT) {
+        throw new Error(`readMany returned ${texts.length} results`);
+    }
+    if (!texts.every((t, i) => JSON.parse(t).i === i)) {
+        throw new Error('readMany results are out of order');
+    }
+
+    const buffers = await readMany(paths.slice(0, 3));
+    if (!(Buffer.isBuffer(buffers[0]) && buffers[0].toString() === '{"i":0}')) {
+        throw new Error('readMany without encoding');
+    }
+
+    const stats = await statMany(paths, { bigint: true });
+    if (!stats.every((s) => s.isFile() && typeof s.size === 'bigint')) {
+        throw new Error('statMany lost the Stats shape');
+    }
+
+    let seen = 0;
+    let failures = 0;
+    const withMissing = [...paths, `${DIR}/missing.json`];
+    for await (const chunk of readMany(withMissing, { iterator: true, chunkSize: 50, encoding: 'utf8' })) {
+        for (const entry of chunk) {
+            seen++;
+            if (entry.error) {
+                failures++;
+            } else if (JSON.parse(entry.value).i < 0) {
+                throw new Error(`bad value for ${entry.path}`);
+            }
+        }
+    }
+    if (!(seen === COUNT + 1 && failures === 1)) {
+        throw new Error(`iterator saw ${seen} entries and ${failures} failures`);
+    }
+
+    let rejected = false;
+    try {
+        await readMany(withMissing);
+    } catch (e) {
+        rejected = e.message.startsWith('ENOENT') && e.message.includes('missing.json');
+    }
+    if (!rejected) {
+        throw new Error('readMany did not reject with the missing path');
+    }
+
+    if ((await readMany([])).length !== 0) {
+        throw new Error('empty batch should resolve to an empty array');
+    }
+
+    await rm(DIR, { recursive: true, force: true });
+}
+
+runTest('batch', main);
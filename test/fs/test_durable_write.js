@@ -0,0 +1,91 @@
+import { mkdir, readFile, readdir, writeFile, rm, fsync, groupCommitStats } from 'node:fs/promises';
+import fs from 'node:fs';
+
+// Checks writeFile({ flush }) and writeFile({ atomic }) and that concurrent durable writes
+// share group commit rounds.
+const DIR = './durable_tmp';
+const COUNT = 200;
+
+async function runTest(name, testFn) {
+    try {
+        console.log(`[RUNNING] ${name}`);
+        await testFn();
+        console.log(`[PASS] ${name}`);
+    } catch (e) {
+        console.error(`[FAIL] ${name}`);
+        console.error(`  Error: ${e.message}`);
+        process.exit(1);
+    }
+}
+
+async function main() {
+    await rm(DIR, { recursive: true, force: true });
+    await mkdir(DIR);
+    const before = groupCommitStats();
+
+    await writeFile(`${DIR}/flushed.txt`, 'flushed', { flush: true });
+    if ((await readFile(`${DIR}/flushed.txt`, 'utf8')) !== 'flushed') {
+        throw new Error('flush write lost data');
+    }
+
+    await writeFile(`${DIR}/state.json`, '{"v":1}');
+    if (process.platform !== 'win32') fs.chmodSync(`${DIR}/state.json`, 0o640);
+    await writeFile(`${DIR}/state.json`, Buffer.from('{"v":2}'), { atomic: true });
+    if ((await readFile(`${DIR}/state.json`, 'utf8')) !== '{"v":2}') {
+        throw new Error('atomic write did not replace the file');
+    }
+    if (process.platform !== 'win32' && (fs.statSync(`${DIR}/state.json`).mode & 0o777) !== 0o640) {
+        throw new Error('atomic write dropped the permissions of the file it replaced');
+    }
+
+    const paths = Array.from({ length: COUNT }, (_, i) => `${DIR}/s${i}.json`);
+    await Promise.all(paths.map((p, i) => writeFile(p, JSON.stringify({ i }), { atomic: true })));
+    for (let i = 0; i < COUNT; i += 37) {
+        if (JSON.parse(await readFile(paths[i], 'utf8')).i !== i) {
+            throw new Error(`atomic write ${i} has the wrong contents`);
+        }
+    }
+    const leftovers = (await readdir(DIR)).filter((name) => name.endsWith('.tmp'));
+    if (leftovers.length !== 0) {
+        throw new Error(`temp files left behind: ${leftovers.join(', ')}`);
+    }
+
+    const fd = fs.openSync(`${DIR}/flushed.txt`, 'r+');
+    await fsync(fd);
+    fs.closeSync(fd);
+
+    for (const options of [{ atomic: true }, {}]) {
+        let error;
+        try {
+            await writeFile(`${DIR}/missing/dir.txt`, 'x', options);
+        } catch (e) {
+            error = e;
+        }
+        if (!error || !error.message.startsWith('ENOENT') || error.code !== 'ENOENT' || error.syscall !== 'open') {
+            throw new Error(`write into a missing directory (${JSON.stringify(options)}) gave ${error}`);
+        }
+        if (!(error.errno < 0) || !error.path.endsWith('dir.txt')) {
+            throw new Error(`write error has errno ${error.errno} and path ${error.path}`);
+        }
+    }
+
+    const after = groupCommitStats();
+    const requests = after.requests - before.requests;
+    const rounds = after.rounds - before.rounds;
+    // Atomic writes also flush the directory, except on Windows where the rename is write-through.
+    const perAtomic = process.platform === 'win32' ? 1 : 2;
+    const expected = 1 + perAtomic * (COUNT + 1) + 1;
+    if (requests !== expected) {
+        throw new Error(`expected ${expected} sync requests, saw ${requests}`);
+    }
+    if (!(rounds > 0 && rounds < requests)) {
+        throw new Error(`concurrent writes were not coalesced (${rounds} rounds)`);
+    }
+    if (!(after.maxBatch > 1 && after.avgLatencyMs >= 0)) {
+        throw new Error('batch metrics are missing');
+    }
+
+    await rm(DIR, { recursive: true, force: true });
+}
+
+runTest('durable write', main);
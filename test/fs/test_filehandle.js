@@ -0,0 +1,150 @@
+import { open, readFile, writeFile, rm } from 'node:fs/promises';
+
+// Checks FileHandle positional I/O, cursor ordering, readLines, stat and close semantics.
+const FILE = './filehandle_src.txt';
+
+async function runTest(name, testFn) {
+    try {
+        console.log(`[RUNNING] ${name}`);
+        await testFn();
+        console.log(`[PASS] ${name}`);
+    } catch (e) {
+        console.error(`[FAIL] ${name}`);
+        console.error(`  Error: ${e.message}`);
+        process.exit(1);
+    }
+}
+
+async function main() {
+    await writeFile(FILE, 'alpha\nbeta\r\ngamma');
+
+    const fh = await open(FILE, 'r+');
+    if (!(typeof fh.fd === 'number' && fh.fd >= 0)) {
+        throw new Error('fd getter is missing');
+    }
+
+    // Cursor reads are queued, so they come back in submission order.
+    const [first, second] = await Promise.all([fh.read(Buffer.alloc(3), 0, 3), fh.read(Buffer.alloc(3), 0, 3)]);
+    if (!(first.buffer.toString() === 'alp' && second.buffer.toString() === 'ha\n')) {
+        throw new Error('cursor reads were reordered');
+    }
+
+    const rest = await fh.readFile('utf8');
+    if (rest !== 'beta\r\ngamma') {
+        throw new Error(`readFile from the cursor gave ${JSON.stringify(rest)}`);
+    }
+
+    const buf = Buffer.alloc(4);
+    const { bytesRead } = await fh.read(buf, 0, 4, 6);
+    if (!(bytesRead === 4 && buf.toString() === 'beta')) {
+        throw new Error(`positional read returned ${buf.toString()}`);
+    }
+
+    // Positional writes run concurrently and must all land.
+    await Promise.all([fh.write('A', 0), fh.write(Buffer.from('B'), 0, 1, 1)]);
+    const head = Buffer.alloc(2);
+    await fh.read(head, 0, 2, 0);
+    if (head.toString() !== 'AB') {
+        throw new Error(`positional writes gave ${head.toString()}`);
+    }
+
+    const iov = [Buffer.alloc(2), Buffer.alloc(3)];
+    const vec = await fh.readv(iov, 6);
+    if (!(vec.bytesRead === 5 && Buffer.concat(iov).toString() === 'beta\r')) {
+        throw new Error('readv returned the wrong bytes');
+    }
+
+    // A range that does not fit the buffer is rejected, not clamped.
+    const ranges = [
+        () => fh.read(Buffer.alloc(4), 2, 3, 0),
+        () => fh.read(Buffer.alloc(4), 5),
+        () => fh.read(Buffer.alloc(4), 1.5, 1, 0),
+        () => fh.write(Buffer.alloc(4), 0, 5, 0),
+        () => fh.write(Buffer.alloc(4), { offset: -1 }),
+    ];
+    for (const op of ranges) {
+        let code;
+        try {
+            await op();
+        } catch (e) {
+            code = e.code;
+        }
+        if (code !== 'ERR_OUT_OF_RANGE') {
+            throw new Error(`${op} gave ${code} instead of ERR_OUT_OF_RANGE`);
+        }
+    }
+
+    if ((await fh.stat()).size !== 17) {
+        throw new Error('stat size mismatch');
+    }
+    await fh.sync();
+    await fh.close();
+    await fh.close();
+
+    let rejected = false;
+    try {
+        await fh.read(Buffer.alloc(1), 0, 1, 0);
+    } catch (e) {
+        rejected = e.message.startsWith('EBADF');
+    }
+    if (!rejected) {
+        throw new Error('read after close did not reject with EBADF');
+    }
+
+    const lines = [];
+    const reader = await open(FILE);
+    for await (const line of reader.readLines()) lines.push(line);
+    if (lines.join('|') !== 'ABpha|beta|gamma') {
+        throw new Error(`readLines gave ${lines.join('|')}`);
+    }
+    await reader.close();
+
+    if (Symbol.asyncDispose) {
+        const disposable = await open(FILE);
+        await disposable[Symbol.asyncDispose]();
+        if (disposable.fd !== -1) {
+            throw new Error('asyncDispose did not close the handle');
+        }
+    }
+
+    // String writes and readFile honour the encoding; "s" flags still open the file.
+    const synced = await open(FILE, 'rs+');
+    await synced.write('68656c6c6f', 0, 'hex');
+    await synced.write('d29ybGQ=', 5, 'base64');
+    const text = await synced.readFile({ encoding: 'latin1' });
+    if (text !== 'helloworld\r\ngamma') {
+        throw new Error(`encoded write/readFile gave ${JSON.stringify(text)}`);
+    }
+    if ((await synced.read(Buffer.alloc(4), 0, 4, 0)).buffer.toString('hex') !== '68656c6c') {
+        throw new Error('hex write');
+    }
+    await synced.close();
+    const appended = await open(FILE, 'as+');
+    await appended.write('!');
+    await appended.close();
+
+    let missing = false;
+    try {
+        await open('./filehandle_missing.txt');
+    } catch (e) {
+        missing = e.message.startsWith('ENOENT') && e.message.includes('open');
+        if (!(e.code === 'ENOENT' && e.syscall === 'open' && e.errno < 0 && e.path === './filehandle_missing.txt')) {
+            throw new Error('open error lacks code/errno/syscall/path');
+        }
+    }
+    if (!missing) {
+        throw new Error('open on a missing file did not report ENOENT');
+    }
+    const readError = await readFile('./filehandle_missing.txt').catch((e) => e);
+    if (!(readError.code === 'ENOENT' && readError.syscall === 'open')) {
+        throw new Error(`readFile of a missing file gave ${readError.code}/${readError.syscall}`);
+    }
+    const notDir = await readFile(`${FILE}/child`).catch((e) => e);
+    if (notDir.code !== 'ENOTDIR') {
+        throw new Error(`readFile below a file gave ${notDir.code}`);
+    }
+
+    await rm(FILE, { force: true });
+}
+
+runTest('filehandle', main);
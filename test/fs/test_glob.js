@@ -0,0 +1,89 @@
+import { mkdir, writeFile, rm, glob } from 'node:fs/promises';
+import fs from 'node:fs';
+import { join } from 'node:path';
+
+// Checks pattern features and the three glob entry points against a small tree.
+const ROOT = './glob_src';
+
+async function runTest(name, testFn) {
+    try {
+        console.log(`[RUNNING] ${name}`);
+        await testFn();
+        console.log(`[PASS] ${name}`);
+    } catch (e) {
+        console.error(`[FAIL] ${name}`);
+        console.error(`  Error: ${e.message}`);
+        process.exit(1);
+    }
+}
+
+async function main() {
+    await rm(ROOT, { recursive: true, force: true });
+    await mkdir(join(ROOT, 'lib', 'util'), { recursive: true });
+    await mkdir(join(ROOT, 'node_modules', 'dep'), { recursive: true });
+    await mkdir(join(ROOT, '.cache'), { recursive: true });
+    const files = ['a.js', 'b.ts', 'c.md', 'lib/x.js', 'lib/util/y.js', 'lib/util/z1.ts', 'node_modules/dep/i.js'];
+    for (const f of [...files, '.cache/h.js']) {
+        await writeFile(join(ROOT, f), 'x');
+    }
+
+    const all = fs.globSync('**/*.js', { cwd: ROOT }).sort();
+    if (all.length !== 4) {
+        throw new Error(`**/*.js matched ${all.length}: ${all}`);
+    }
+    if (all.some((p) => p.includes('.cache'))) {
+        throw new Error('** descended into a dot directory');
+    }
+
+    const braces = fs.globSync('{lib/**/*.{js,ts},*.md}', { cwd: ROOT });
+    if (braces.length !== 4) {
+        throw new Error(`brace pattern matched ${braces.length}: ${braces}`);
+    }
+
+    const cls = fs.globSync('lib/util/[a-y]*', { cwd: ROOT });
+    if (cls.length !== 1) {
+        throw new Error(`character class matched ${cls.length}: ${cls}`);
+    }
+
+    const pruned = fs.globSync('**/*.js', { cwd: ROOT, exclude: ['node_modules/**'] });
+    if (pruned.length !== 3) {
+        throw new Error(`exclude array matched ${pruned.length}: ${pruned}`);
+    }
+
+    const negated = fs.globSync(['**/*.js', '!**/node_modules'], { cwd: ROOT });
+    if (negated.length !== 3) {
+        throw new Error(`negated pattern matched ${negated.length}: ${negated}`);
+    }
+
+    const byFn = fs.globSync('*', { cwd: ROOT, exclude: (p) => p.endsWith('.md') });
+    if (byFn.includes('c.md')) {
+        throw new Error('exclude function was ignored');
+    }
+
+    const typed = fs.globSync('lib/*', { cwd: ROOT, withFileTypes: true });
+    if (!typed.find((d) => d.name === 'util').isDirectory()) {
+        throw new Error('withFileTypes lost the directory type');
+    }
+
+    const viaCallback = await new Promise((resolve, reject) =>
+        fs.glob('**/*.ts', { cwd: ROOT }, (err, matches) => (err ? reject(err) : resolve(matches))),
+    );
+    if (viaCallback.length !== 2) {
+        throw new Error(`fs.glob matched ${viaCallback.length}`);
+    }
+
+    let streamed = 0;
+    for await (const entry of glob('**', { cwd: ROOT })) {
+        if (typeof entry !== 'string') {
+            throw new Error('iterator yielded a non-string');
+        }
+        streamed++;
+    }
+    if (streamed !== 11) {
+        throw new Error(`fsPromises.glob streamed ${streamed} entries`);
+    }
+
+    await rm(ROOT, { recursive: true, force: true });
+}
+
+runTest('glob', main);
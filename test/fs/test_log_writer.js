@@ -0,0 +1,106 @@
+import { mkdir, readFile, readdir, rm } from 'node:fs/promises';
+import fs from 'node:fs';
+
+// Checks fs.createLogWriter: buffered appends, flush(), size rotation, drop accounting and close().
+const DIR = './log_writer_tmp';
+
+async function runTest(name, testFn) {
+    try {
+        console.log(`[RUNNING] ${name}`);
+        await testFn();
+        console.log(`[PASS] ${name}`);
+    } catch (e) {
+        console.error(`[FAIL] ${name}`);
+        console.error(`  Error: ${e.message}`);
+        process.exit(1);
+    }
+}
+
+async function main() {
+    await rm(DIR, { recursive: true, force: true });
+    await mkdir(DIR);
+
+    const log = fs.createLogWriter(`${DIR}/app.log`, { flushInterval: 1000 });
+    for (let i = 0; i < 1000; i++) {
+        if (!log.write(`line ${i}\n`)) {
+            throw new Error(`write ${i} was rejected`);
+        }
+    }
+    log.write(Buffer.from('bytes\n'));
+    await log.flush();
+    const text = await readFile(`${DIR}/app.log`, 'utf8');
+    const lines = text.split('\n');
+    if (!(lines.length === 1002 && lines[999] === 'line 999' && lines[1000] === 'bytes')) {
+        throw new Error('flush lost records');
+    }
+    const stats = log.stats();
+    if (!(stats.records === 1001 && stats.pendingBytes === 0)) {
+        throw new Error(`stats after flush: ${JSON.stringify(stats)}`);
+    }
+    if (stats.writes >= 1001) {
+        throw new Error('records were not batched into fewer writes');
+    }
+    await log.close();
+    await log.close();
+
+    let threw = false;
+    try {
+        log.write('late\n');
+    } catch (e) {
+        threw = e.message.includes('closed');
+    }
+    if (!threw) {
+        throw new Error('write after close did not throw');
+    }
+
+    // 100-byte records into 1000-byte files with two backups kept.
+    const rotating = fs.createLogWriter(`${DIR}/rot.log`, { maxSize: 1000, maxFiles: 2, flushBytes: 1 });
+    const record = 'x'.repeat(99) + '\n';
+    for (let i = 0; i < 50; i++) {
+        rotating.write(record);
+        await rotating.flush();
+    }
+    await rotating.close();
+    const files = (await readdir(DIR)).filter((f) => f.startsWith('rot.log')).sort();
+    if (files.join(',') !== 'rot.log,rot.log.1,rot.log.2') {
+        throw new Error(`rotation left ${files.join(',')}`);
+    }
+    for (const f of files) {
+        const size = (await readFile(`${DIR}/${f}`)).length;
+        if (!(size > 0 && size <= 1000)) {
+            throw new Error(`${f} has ${size} bytes`);
+        }
+    }
+    if (rotating.stats().rotations < 4) {
+        throw new Error('rotations were not counted');
+    }
+
+    // A 4 KiB ring in drop mode cannot hold 256 KiB written in one turn.
+    const lossy = fs.createLogWriter(`${DIR}/drop.log`, { bufferSize: 4096, overflow: 'drop', flushInterval: 1000 });
+    let accepted = 0;
+    for (let i = 0; i < 256; i++) if (lossy.write('y'.repeat(1023) + '\n')) accepted++;
+    await lossy.close();
+    const dropped = lossy.stats().dropped;
+    if (!(dropped > 0 && accepted + dropped === 256)) {
+        throw new Error(`accepted ${accepted}, dropped ${dropped}`);
+    }
+    if ((await readFile(`${DIR}/drop.log`)).length !== accepted * 1024) {
+        throw new Error('accepted records were not all written');
+    }
+
+    // Blocking mode waits for the flusher instead of dropping.
+    const blocking = fs.createLogWriter(`${DIR}/block.log`, { bufferSize: 4096 });
+    for (let i = 0; i < 64; i++) blocking.write('z'.repeat(1023) + '\n');
+    await blocking.close();
+    const blockStats = blocking.stats();
+    if (!(blockStats.dropped === 0 && blockStats.blocked > 0)) {
+        throw new Error(`block stats: ${JSON.stringify(blockStats)}`);
+    }
+    if ((await readFile(`${DIR}/block.log`)).length !== 64 * 1024) {
+        throw new Error('blocking writer lost records');
+    }
+
+    await rm(DIR, { recursive: true, force: true });
+}
+
+runTest('log writer', main);
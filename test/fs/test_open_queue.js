@@ -0,0 +1,95 @@
+import { readFile, writeFile, open, rm, openQueueStats, setOpenQueueLimit } from 'node:fs/promises';
+import { createReadStream, createWriteStream } from 'node:fs';
+
+// Shrinks the descriptor budget and fires a burst of opens well past it; they must all succeed,
+// with the overflow waiting in the native open queue instead of failing with EMFILE. Streams
+// count their fd against the same budget and must give it back once they end or are destroyed.
+const FILE = './open_queue_src.txt';
+const OUT = './open_queue_out.txt';
+const LIMIT = 8;
+const BURST = 500;
+
+async function runTest(name, testFn) {
+    try {
+        console.log(`[RUNNING] ${name}`);
+        await testFn();
+        console.log(`[PASS] ${name}`);
+    } catch (e) {
+        console.error(`[FAIL] ${name}`);
+        console.error(`  Error: ${e.message}`);
+        process.exit(1);
+    }
+}
+
+async function main() {
+    await writeFile(FILE, 'queued');
+    const before = openQueueStats();
+    if (before.limit <= 0) {
+        throw new Error('descriptor budget was not initialised');
+    }
+
+    const previous = setOpenQueueLimit(before.open + LIMIT);
+    if (previous !== before.limit) {
+        throw new Error(`setOpenQueueLimit returned ${previous}, expected ${before.limit}`);
+    }
+    try {
+        const reads = Array.from({ length: BURST }, () => readFile(FILE, 'utf8'));
+        const during = openQueueStats();
+        const results = await Promise.all(reads);
+        if (!results.every((r) => r === 'queued')) {
+            throw new Error('a queued read returned the wrong data');
+        }
+        const burst = openQueueStats();
+        if (burst.queued - before.queued < BURST - LIMIT) {
+            throw new Error(`only ${burst.queued - before.queued} of ${BURST} opens queued`);
+        }
+        if (during.waiting === 0) {
+            throw new Error('no opens were waiting during the burst');
+        }
+
+        // Handles hold their slot until closed; closing them must let the rest through.
+        const handles = await Promise.all(Array.from({ length: LIMIT * 4 }, () => open(FILE)));
+        await Promise.all(handles.map((h) => h.close()));
+
+        // A stream takes a slot when created and returns it at end, finish or destroy.
+        const rs = createReadStream(FILE);
+        const ws = createWriteStream(OUT);
+        if (openQueueStats().open !== before.open + 2) {
+            throw new Error('streams did not count their descriptors');
+        }
+        let ended = false;
+        rs.on('end', () => {
+            ended = true;
+        });
+        rs.read();
+        rs.read();
+        ws.end();
+        if (!ended) {
+            throw new Error('read stream did not end');
+        }
+        const destroyed = createReadStream(FILE);
+        destroyed.destroy();
+        const streams = openQueueStats();
+        if (streams.open !== before.open) {
+            throw new Error(`streams kept their descriptors: ${before.open} -> ${streams.open}`);
+        }
+    } finally {
+        setOpenQueueLimit(before.limit);
+    }
+
+    const after = openQueueStats();
+    if (after.open !== before.open) {
+        throw new Error(`descriptor count leaked: ${before.open} -> ${after.open}`);
+    }
+    if (after.waiting !== 0) {
+        throw new Error('opens are still waiting');
+    }
+    if (!(after.blockedMs > before.blockedMs && after.maxBlockedMs > 0)) {
+        throw new Error('queued opens recorded no blocked time');
+    }
+
+    await rm(FILE, { force: true });
+    await rm(OUT, { force: true });
+}
+
+runTest('open queue', main);
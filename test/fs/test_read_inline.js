@@ -0,0 +1,73 @@
+import { readFile, writeFile, rm, readFileInlineStats } from 'node:fs/promises';
+
+// Checks that readFile results match across the inline page-cache path and the pool path, and
+// that the fast path counters move. On platforms without the fast path maxSize is 0.
+const SMALL = './read_inline_small.txt';
+const LARGE = './read_inline_large.bin';
+
+async function runTest(name, testFn) {
+    try {
+        console.log(`[RUNNING] ${name}`);
+        await testFn();
+        console.log(`[PASS] ${name}`);
+    } catch (e) {
+        console.error(`[FAIL] ${name}`);
+        console.error(`  Error: ${e.message}`);
+        process.exit(1);
+    }
+}
+
+async function main() {
+    const large = Buffer.alloc(256 * 1024, 'z');
+    await writeFile(SMALL, 'cached config');
+    await writeFile(LARGE, large);
+
+    const before = readFileInlineStats();
+    if ((await readFile(SMALL, 'utf8')) !== 'cached config') {
+        throw new Error('small utf8 read mismatch');
+    }
+    const bytes = await readFile(SMALL);
+    if (!(bytes.length === 13 && bytes[0] === 0x63)) {
+        throw new Error('small binary read mismatch');
+    }
+    if ((await readFile(LARGE)).length !== large.length) {
+        throw new Error('large read was truncated');
+    }
+
+    let missing = false;
+    try {
+        await readFile('./read_inline_missing.txt');
+    } catch (e) {
+        missing = e.message.startsWith('ENOENT');
+    }
+    if (!missing) {
+        throw new Error('missing file did not reject with ENOENT');
+    }
+
+    const after = readFileInlineStats();
+    if (after.maxSize > 0) {
+        if (after.attempts - before.attempts !== 4) {
+            throw new Error(`expected 4 attempts, saw ${after.attempts - before.attempts}`);
+        }
+        if (after.skipped - before.skipped !== 1) {
+            throw new Error('large file was not skipped');
+        }
+        if (after.errors - before.errors !== 1) {
+            throw new Error('missing file was not counted as an error');
+        }
+        // Only the two small reads can hit; the missing file must not count as one.
+        const hits = after.hits - before.hits;
+        const misses = after.misses - before.misses;
+        if (hits < 1 || hits > 2 || hits + misses !== 2) {
+            throw new Error(`expected 2 small reads as hits or misses, saw ${hits} hits and ${misses} misses`);
+        }
+        if (!(after.hitRatio >= 0 && after.hitRatio <= 1)) {
+            throw new Error('hitRatio out of range');
+        }
+    }
+
+    await rm(SMALL, { force: true });
+    await rm(LARGE, { force: true });
+}
+
+runTest('read inline', main);
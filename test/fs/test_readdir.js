@@ -0,0 +1,103 @@
+import { mkdir, writeFile, readdir, rm, opendir } from 'node:fs/promises';
+import fs from 'node:fs';
+import { join } from 'node:path';
+
+// Checks batched readdir, recursive readdir and Dir iteration on a small tree.
+const ROOT = './readdir_src';
+
+async function runTest(name, testFn) {
+    try {
+        console.log(`[RUNNING] ${name}`);
+        await testFn();
+        console.log(`[PASS] ${name}`);
+    } catch (e) {
+        console.error(`[FAIL] ${name}`);
+        console.error(`  Error: ${e.message}`);
+        process.exit(1);
+    }
+}
+
+async function main() {
+    await rm(ROOT, { recursive: true, force: true });
+    await mkdir(join(ROOT, 'a', 'b'), { recursive: true });
+    for (let i = 0; i < 100; i++) {
+        await writeFile(join(ROOT, `f_${i}.txt`), 'x');
+    }
+    await writeFile(join(ROOT, 'a', 'inner.txt'), 'x');
+    await writeFile(join(ROOT, 'a', 'b', 'deep.txt'), 'x');
+
+    const names = await readdir(ROOT);
+    if (names.length !== 101) {
+        throw new Error(`readdir returned ${names.length} entries`);
+    }
+
+    const dirents = fs.readdirSync(ROOT, { withFileTypes: true });
+    const dir = dirents.find((d) => d.name === 'a');
+    if (!(dir && dir.isDirectory() && !dir.isFile())) {
+        throw new Error('withFileTypes lost the directory type');
+    }
+    if (!dirents.find((d) => d.name === 'f_0.txt').isFile()) {
+        throw new Error('withFileTypes lost the file type');
+    }
+
+    // Dirents are lazy wrappers; their fields must still look like plain own properties.
+    const typed = await readdir(ROOT, { withFileTypes: true, recursive: true });
+    const deep = typed.find((d) => d.name === 'deep.txt');
+    if (!(deep && deep.isFile())) {
+        throw new Error('recursive withFileTypes lost a nested file');
+    }
+    if (!deep.parentPath.endsWith(join('a', 'b'))) {
+        throw new Error(`recursive dirent has parentPath ${deep.parentPath}`);
+    }
+    if (deep.path !== deep.parentPath) {
+        throw new Error('dirent path does not match parentPath');
+    }
+    if (Object.keys(deep).join() !== 'name,parentPath,path') {
+        throw new Error(`dirent keys are ${Object.keys(deep).join()}`);
+    }
+    if (JSON.parse(JSON.stringify(deep)).name !== 'deep.txt') {
+        throw new Error('dirent does not serialize its name');
+    }
+    if (new Set(typed.map((d) => `${d.parentPath}/${d.name}`)).size !== 104) {
+        throw new Error('dirent names are not distinct');
+    }
+
+    const all = await readdir(ROOT, { recursive: true });
+    if (all.length !== 104) {
+        throw new Error(`recursive readdir returned ${all.length} entries`);
+    }
+    if (!all.includes(join('a', 'b', 'deep.txt'))) {
+        throw new Error('recursive readdir missed a nested file');
+    }
+    if (fs.readdirSync(ROOT, { recursive: true }).length !== 104) {
+        throw new Error('recursive readdirSync mismatch');
+    }
+
+    let count = 0;
+    const handle = await opendir(ROOT, { bufferSize: 8 });
+    for await (const entry of handle) {
+        if (typeof entry.name !== 'string') {
+            throw new Error('Dir iterator yielded a bad entry');
+        }
+        count++;
+    }
+    if (count !== 101) {
+        throw new Error(`Dir iterator yielded ${count} entries`);
+    }
+
+    const sync = fs.opendirSync(ROOT);
+    let first = sync.readSync();
+    count = 0;
+    while (first) {
+        count++;
+        first = sync.readSync();
+    }
+    sync.closeSync();
+    if (count !== 101) {
+        throw new Error(`Dir.readSync yielded ${count} entries`);
+    }
+
+    await rm(ROOT, { recursive: true, force: true });
+}
+
+runTest('readdir/opendir', main);
@@ -0,0 +1,111 @@
+import { writeFile, rm, stat, lstat } from 'node:fs/promises';
+import fs from 'node:fs';
+
+// Checks packed Stats fields, bigint results, throwIfNoEntry and the three stat flavours.
+const FILE = './stat_src.txt';
+
+async function runTest(name, testFn) {
+    try {
+        console.log(`[RUNNING] ${name}`);
+        await testFn();
+        console.log(`[PASS] ${name}`);
+    } catch (e) {
+        console.error(`[FAIL] ${name}`);
+        console.error(`  Error: ${e.message}`);
+        process.exit(1);
+    }
+}
+
+async function main() {
+    await writeFile(FILE, 'hello');
+
+    const st = fs.statSync(FILE);
+    if (!(st.isFile() && !st.isDirectory())) {
+        throw new Error('statSync lost the file type');
+    }
+    if (st.size !== 5) {
+        throw new Error(`statSync size was ${st.size}`);
+    }
+    if (!(st.mtime instanceof Date)) {
+        throw new Error('mtime is not a Date');
+    }
+    if (Math.abs(st.mtime.getTime() - st.mtimeMs) >= 1) {
+        throw new Error('mtime and mtimeMs disagree');
+    }
+    if (st.mtime !== st.mtime) {
+        throw new Error('mtime Date was not cached');
+    }
+    if (!(typeof st.ino === 'number' && st.nlink >= 1)) {
+        throw new Error('raw fields are missing');
+    }
+
+    // Fields are own enumerable properties, as in Node.
+    const keys = Object.keys(fs.statSync(FILE));
+    if (!(keys.includes('size') && keys.includes('mtimeMs') && keys.includes('mtime'))) {
+        throw new Error(`Object.keys(stats) gave ${keys.join(',')}`);
+    }
+    if (JSON.parse(JSON.stringify(st)).size !== 5 || { ...st }.mode !== st.mode) {
+        throw new Error('JSON.stringify or spread lost the Stats fields');
+    }
+    if ('mtimeNs' in st) {
+        throw new Error('number Stats expose mtimeNs');
+    }
+
+    const big = fs.statSync(FILE, { bigint: true });
+    if (!(typeof big.size === 'bigint' && big.size === 5n)) {
+        throw new Error('bigint size is wrong');
+    }
+    if (typeof big.mtimeNs !== 'bigint') {
+        throw new Error('mtimeNs is not a bigint');
+    }
+    if (big.mtimeNs / 1000000n !== big.mtimeMs) {
+        throw new Error('mtimeNs and mtimeMs disagree');
+    }
+
+    if (fs.statSync('./stat_missing.txt', { throwIfNoEntry: false }) !== undefined) {
+        throw new Error('throwIfNoEntry ignored');
+    }
+    let threw = false;
+    try {
+        fs.lstatSync('./stat_missing.txt');
+    } catch (e) {
+        threw = e.message.startsWith('ENOENT') && e.message.includes('lstat');
+        if (!(e.code === 'ENOENT' && e.syscall === 'lstat' && e.errno < 0)) {
+            throw new Error('error lacks code/syscall/errno');
+        }
+        if (e.path !== './stat_missing.txt') {
+            throw new Error(`error path was ${e.path}`);
+        }
+    }
+    if (!threw) {
+        throw new Error('lstatSync did not throw ENOENT');
+    }
+    const rejected = await stat('./stat_missing.txt').catch((e) => e);
+    if (!(rejected.code === 'ENOENT' && rejected.syscall === 'stat')) {
+        throw new Error('fsPromises.stat error lacks code/syscall');
+    }
+
+    const viaPromise = await stat(FILE, { bigint: true });
+    if (viaPromise.size !== 5n) {
+        throw new Error('fsPromises.stat ignored bigint');
+    }
+    if (!(await lstat(FILE)).isFile()) {
+        throw new Error('fsPromises.lstat lost the file type');
+    }
+
+    const fd = fs.openSync(FILE, 'r');
+    if (fs.fstatSync(fd).size !== 5) {
+        throw new Error('fstatSync size mismatch');
+    }
+    const viaCallback = await new Promise((resolve, reject) =>
+        fs.fstat(fd, (err, s) => (err ? reject(err) : resolve(s))),
+    );
+    if (viaCallback.size !== 5) {
+        throw new Error('fs.fstat size mismatch');
+    }
+    fs.closeSync(fd);
+
+    await rm(FILE, { force: true });
+}
+
+runTest('stat', main);
@@ -0,0 +1,97 @@
+import fs from 'node:fs';
+
+// Checks that the stat cache serves repeated lookups and notices changes to cached paths.
+const DIR = fs.realpathSync('.') + '/stat_cache_tmp';
+
+async function runTest(name, testFn) {
+    try {
+        console.log(`[RUNNING] ${name}`);
+        await testFn();
+        console.log(`[PASS] ${name}`);
+    } catch (e) {
+        console.error(`[FAIL] ${name}`);
+        console.error(`  Error: ${e.message}`);
+        process.exit(1);
+    }
+}
+
+async function main() {
+    fs.rmSync(DIR, { recursive: true, force: true });
+    fs.mkdirSync(DIR);
+    fs.writeFileSync(`${DIR}/a.txt`, 'hello');
+    fs.enableStatCache({ maxEntries: 1000 });
+    const before = fs.statCacheStats();
+
+    for (let i = 0; i < 100; i++) {
+        if (fs.statSync(`${DIR}/a.txt`).size !== 5) {
+            throw new Error('cached stat has the wrong size');
+        }
+        if (fs.existsSync(`${DIR}/missing.txt`)) {
+            throw new Error('missing file reported as existing');
+        }
+    }
+    const warm = fs.statCacheStats();
+    if (warm.hits - before.hits < 190) {
+        throw new Error(`repeated lookups missed the cache (${warm.hits - before.hits} hits)`);
+    }
+    if (!(warm.hitRatio > 0 && warm.hitRatio <= 1)) {
+        throw new Error('hitRatio is out of range');
+    }
+
+    // The cache has to see these changes (inotify on Linux; elsewhere they need the TTL or a clear).
+    if (process.platform !== 'linux') fs.clearStatCache();
+    fs.appendFileSync(`${DIR}/a.txt`, ' world');
+    fs.writeFileSync(`${DIR}/missing.txt`, 'now here');
+    if (process.platform !== 'linux') fs.clearStatCache();
+    if (fs.statSync(`${DIR}/a.txt`).size !== 11) {
+        throw new Error('stat returned a stale size after a write');
+    }
+    if (!fs.existsSync(`${DIR}/missing.txt`)) {
+        throw new Error('existsSync returned a stale negative result');
+    }
+
+    fs.mkdirSync(`${DIR}/real`);
+    if (fs.realpathSync(`${DIR}/real`) !== `${DIR}/real`) {
+        throw new Error('realpath of a plain directory changed');
+    }
+
+    // A ConfigMap-style swap: key -> ..data/key, and ..data is replaced by a link to a new directory.
+    // Nothing on the literal path of key changes, so paths through symlinks must not be cached.
+    fs.mkdirSync(`${DIR}/v1`);
+    fs.mkdirSync(`${DIR}/v2`);
+    fs.writeFileSync(`${DIR}/v1/key`, 'one');
+    fs.writeFileSync(`${DIR}/v2/key`, 'three');
+    fs.symlinkSync('v1', `${DIR}/..data`);
+    fs.symlinkSync('..data/key', `${DIR}/key`);
+    if (fs.statSync(`${DIR}/key`).size !== 3 || fs.realpathSync(`${DIR}/key`) !== `${DIR}/v1/key`) {
+        throw new Error('stat through a symlink gave the wrong target');
+    }
+    fs.symlinkSync('v2', `${DIR}/..data_tmp`);
+    fs.renameSync(`${DIR}/..data_tmp`, `${DIR}/..data`);
+    if (process.platform !== 'linux') fs.clearStatCache();
+    if (fs.statSync(`${DIR}/key`).size !== 5) {
+        throw new Error('stat returned a stale result after the symlink swap');
+    }
+    if (fs.realpathSync(`${DIR}/key`) !== `${DIR}/v2/key`) {
+        throw new Error('realpath returned a stale result after the symlink swap');
+    }
+    fs.clearStatCache();
+    if (fs.statCacheStats().entries !== 0) {
+        throw new Error('clearStatCache left entries behind');
+    }
+
+    // Relative paths are never cached.
+    const rel = fs.statCacheStats();
+    fs.statSync('.');
+    if (fs.statCacheStats().misses !== rel.misses) {
+        throw new Error('relative path went through the cache');
+    }
+
+    fs.enableStatCache({ maxEntries: 0 });
+    if (fs.statCacheStats().enabled) {
+        throw new Error('maxEntries: 0 did not turn the cache off');
+    }
+    fs.rmSync(DIR, { recursive: true, force: true });
+}
+
+runTest('stat cache', main);
@@ -0,0 +1,138 @@
+import { mkdir, writeFile, readFile, readdir, rm, cp } from 'node:fs/promises';
+import fs from 'node:fs';
+import { join } from 'node:path';
+
+// Builds a small tree (width x depth) and checks that the parallel cp/rm walker
+// copies, filters and removes it correctly.
+const ROOT = './tree_ops_src';
+const COPY = './tree_ops_copy';
+const FILTERED = './tree_ops_filtered';
+
+async function makeTree(dir, depth, width) {
+    await mkdir(dir, { recursive: true });
+    for (let i = 0; i < width; i++) {
+        await writeFile(join(dir, `f_${i}.txt`), `file ${i} at ${dir}`);
+        await writeFile(join(dir, `skip_${i}.log`), 'log');
+    }
+    if (depth > 0) {
+        for (let i = 0; i < width; i++) {
+            await makeTree(join(dir, `d_${i}`), depth - 1, width);
+        }
+    }
+}
+
+async function runTest(name, testFn) {
+    try {
+        console.log(`[RUNNING] ${name}`);
+        await testFn();
+        console.log(`[PASS] ${name}`);
+    } catch (e) {
+        console.error(`[FAIL] ${name}`);
+        console.error(`  Error: ${e.message}`);
+        process.exit(1);
+    }
+}
+
+async function main() {
+    await rm(ROOT, { recursive: true, force: true });
+    await rm(COPY, { recursive: true, force: true });
+    await rm(FILTERED, { recursive: true, force: true });
+
+    await makeTree(ROOT, 3, 4);
+
+    let start = Date.now();
+    await cp(ROOT, COPY, { recursive: true });
+    console.log(`- cp: ${Date.now() - start}ms`);
+    const copied = await readFile(join(COPY, 'd_1', 'd_2', 'f_3.txt'), 'utf8');
+    if (copied !== `file 3 at ${join(ROOT, 'd_1', 'd_2')}`) {
+        throw new Error('cp content mismatch');
+    }
+
+    let calls = 0;
+    await cp(ROOT, FILTERED, {
+        recursive: true,
+        filter: async (src) => {
+            calls++;
+            return !src.endsWith('.log');
+        },
+    });
+    const names = await readdir(join(FILTERED, 'd_0'));
+    if (names.some((n) => n.endsWith('.log'))) {
+        throw new Error('filter did not exclude .log files');
+    }
+    if (!names.includes('f_0.txt')) {
+        throw new Error('filter excluded a kept file');
+    }
+    console.log(`- cp with filter: ${calls} filter calls`);
+
+    let rejected = false;
+    await cp(ROOT, COPY, { recursive: true, force: false, errorOnExist: true }).catch(() => (rejected = true));
+    if (!rejected) {
+        throw new Error('errorOnExist did not reject');
+    }
+    const cb_error = await new Promise((resolve) =>
+        fs.cp(ROOT, COPY, { recursive: true, force: false, errorOnExist: true }, resolve));
+    if (!cb_error || cb_error.code !== 'ERR_FS_CP_EEXIST') {
+        throw new Error(`cp callback errorOnExist gave ${cb_error && cb_error.code}`);
+    }
+
+    start = Date.now();
+    await rm(COPY, { recursive: true });
+    console.log(`- rm: ${Date.now() - start}ms`);
+    if (fs.existsSync(COPY)) {
+        throw new Error('rm left the directory behind');
+    }
+
+    rejected = false;
+    await rm(COPY).catch(() => (rejected = true));
+    if (!rejected) {
+        throw new Error('rm of a missing path without force should reject');
+    }
+
+    // A directory, even an empty one, needs { recursive: true }.
+    await mkdir(COPY);
+    let code;
+    await rm(COPY).catch((e) => (code = e.code));
+    if (code !== 'ERR_FS_EISDIR') {
+        throw new Error(`rm of an empty directory gave ${code}`);
+    }
+    if (!fs.existsSync(COPY)) {
+        throw new Error('non-recursive rm removed a directory');
+    }
+    await rm(COPY, { recursive: true });
+
+    // cpSync runs the filter on the calling thread, but it cannot wait for a promise.
+    fs.rmSync(FILTERED, { recursive: true });
+    let sync_calls = 0;
+    fs.cpSync(ROOT, FILTERED, {
+        recursive: true,
+        filter: (src) => {
+            sync_calls++;
+            return !src.endsWith('.log');
+        },
+    });
+    const sync_names = fs.readdirSync(join(FILTERED, 'd_2', 'd_0'));
+    if (sync_names.some((n) => n.endsWith('.log'))) {
+        throw new Error('cpSync filter did not exclude .log files');
+    }
+    if (!sync_names.includes('f_1.txt') || sync_calls !== calls) {
+        throw new Error(`cpSync filter made ${sync_calls} calls, cp made ${calls}`);
+    }
+    code = undefined;
+    try {
+        fs.cpSync(ROOT, COPY, { recursive: true, filter: async () => true });
+    } catch (e) {
+        code = e.code;
+    }
+    if (code !== 'ERR_INVALID_RETURN_VALUE' || fs.existsSync(COPY)) {
+        throw new Error(`cpSync with an async filter gave ${code}`);
+    }
+
+    fs.rmSync(FILTERED);
+    if (fs.existsSync(FILTERED)) {
+        throw new Error('rmSync left the directory behind');
+    }
+    await rm(ROOT, { recursive: true, force: true });
+}
+
+runTest('parallel cp/rm', main);
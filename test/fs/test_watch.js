@@ -0,0 +1,86 @@
+import { mkdir, writeFile, rm, watch } from 'node:fs/promises';
+import fs from 'node:fs';
+import { join } from 'node:path';
+
+// Checks fs.watch (plain and recursive), fsPromises.watch and watchFile against a scratch tree.
+const ROOT = './watch_src';
+
+function sleep(ms) {
+    return new Promise((resolve) => setTimeout(resolve, ms));
+}
+
+async function runTest(name, testFn) {
+    try {
+        console.log(`[RUNNING] ${name}`);
+        await testFn();
+        console.log(`[PASS] ${name}`);
+    } catch (e) {
+        console.error(`[FAIL] ${name}`);
+        console.error(`  Error: ${e.message}`);
+        process.exit(1);
+    }
+}
+
+async function main() {
+    await rm(ROOT, { recursive: true, force: true });
+    await mkdir(join(ROOT, 'sub'), { recursive: true });
+
+    let threw = false;
+    try {
+        fs.watch(join(ROOT, 'missing'));
+    } catch (e) {
+        threw = e.message.startsWith('ENOENT');
+    }
+    if (!threw) {
+        throw new Error('watching a missing path did not throw ENOENT');
+    }
+
+    const seen = [];
+    const watcher = fs.watch(ROOT, { recursive: true, debounce: 50 }, (type, name) => seen.push(`${type}:${name}`));
+    await sleep(100);
+    await writeFile(join(ROOT, 'a.txt'), 'x');
+    await writeFile(join(ROOT, 'sub', 'b.txt'), 'x');
+    await sleep(400);
+    if (!seen.some((e) => e.endsWith(':a.txt'))) {
+        throw new Error(`no event for a.txt: ${seen}`);
+    }
+    if (!seen.some((e) => e.endsWith(join('sub', 'b.txt')))) {
+        throw new Error(`recursive watch missed sub/b.txt: ${seen}`);
+    }
+    const modifies = seen.filter((e) => e === 'change:a.txt').length;
+    if (modifies > 1) {
+        throw new Error(`duplicate change events were not coalesced: ${seen}`);
+    }
+
+    let closed = false;
+    watcher.on('close', () => (closed = true));
+    watcher.close();
+    if (!closed) {
+        throw new Error('close() did not emit close');
+    }
+
+    const iterator = watch(ROOT);
+    setTimeout(() => writeFile(join(ROOT, 'c.txt'), 'x'), 100);
+    for await (const event of iterator) {
+        if (event.filename !== 'c.txt') {
+            throw new Error(`async iterator yielded ${event.filename}`);
+        }
+        break;
+    }
+
+    const target = join(ROOT, 'a.txt');
+    const changed = new Promise((resolve) => {
+        fs.watchFile(target, { interval: 50 }, (curr, prev) => resolve([curr, prev]));
+    });
+    await sleep(100);
+    await writeFile(target, 'longer contents');
+    const [curr, prev] = await changed;
+    if (!(curr.size === 15 && prev.size === 1)) {
+        throw new Error(`watchFile reported sizes ${curr.size}/${prev.size}`);
+    }
+    fs.unwatchFile(target);
+
+    await rm(ROOT, { recursive: true, force: true });
+}
+
+runTest('watch', main);
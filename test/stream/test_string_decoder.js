@@ -0,0 +1,186 @@
+// Checks node:string_decoder on text split at every byte in each encoding that holds bytes back
+// (utf8, utf16le, base64), the per-chunk results Node gives for malformed UTF-8, end() flushing
+// and the error codes, then Readable#setEncoding and the encoding option on chunked pushes.
+import { StringDecoder } from 'node:string_decoder';
+import { Readable } from 'node:stream';
+
+function code(fn) {
+    try {
+        fn();
+    } catch (e) {
+        return e.code;
+    }
+    return undefined;
+}
+
+// Every chunk result plus end(), joined with '|'.
+function decodeChunks(encoding, bytes, cuts) {
+    const decoder = new StringDecoder(encoding);
+    const out = [];
+    let prev = 0;
+    for (const cut of [...cuts, bytes.length]) {
+        out.push(decoder.write(bytes.subarray(prev, cut)));
+        prev = cut;
+    }
+    out.push(decoder.end());
+    return out.join('|');
+}
+
+function pushAll(stream, chunks) {
+    return new Promise((resolve) => {
+        const out = [];
+        stream.on('data', (chunk) => out.push(chunk));
+        stream.on('end', () => resolve(out));
+        for (const chunk of chunks) stream.push(chunk);
+        stream.push(null);
+    });
+}
+
+async function runTest(name, testFn) {
+    try {
+        console.log(`[RUNNING] ${name}`);
+        await testFn();
+        console.log(`[PASS] ${name}`);
+    } catch (e) {
+        console.error(`[FAIL] ${name}`);
+        console.error(`  Error: ${e.message}`);
+        process.exit(1);
+    }
+}
+
+async function main() {
+    const text = 'plain ascii, é, €, 中文 and 😀 end';
+    for (const encoding of ['utf8', 'utf16le', 'base64', 'hex', 'latin1']) {
+        const bytes = Buffer.from(text, encoding === 'base64' || encoding === 'hex' ? 'utf8' : encoding);
+        const whole = bytes.toString(encoding);
+        for (let cut = 0; cut <= bytes.length; cut++) {
+            const decoder = new StringDecoder(encoding);
+            const out = decoder.write(bytes.subarray(0, cut)) + decoder.write(bytes.subarray(cut)) + decoder.end();
+            if (out !== whole) {
+                throw new Error(`${encoding} split at ${cut} decoded wrongly`);
+            }
+        }
+        const byByte = new StringDecoder(encoding);
+        let out = '';
+        for (let i = 0; i < bytes.length; i++) out += byByte.write(bytes.subarray(i, i + 1));
+        if (out + byByte.end() !== whole) {
+            throw new Error(`${encoding} byte-at-a-time decode mismatch`);
+        }
+    }
+
+    // Chunk-level results for cut-off and malformed UTF-8, and UTF-16 leftovers.
+    const euro = Buffer.from([0xe2, 0x82, 0xac]);
+    if (decodeChunks('utf8', euro, [1, 2]) !== '||€|') {
+        throw new Error('cut euro sign');
+    }
+    if (decodeChunks('utf8', Buffer.from([0xe2, 0x82, 0x41]), [2]) !== '|�A|') {
+        throw new Error('broken sequence');
+    }
+    if (decodeChunks('utf8', Buffer.from([0x61, 0xe2, 0x82]), []) !== 'a|�') {
+        throw new Error('truncated tail');
+    }
+    if (decodeChunks('utf8', Buffer.from([0xf0, 0x9f, 0x98, 0x80]), [3]) !== '|😀|') {
+        throw new Error('cut emoji');
+    }
+    if (decodeChunks('utf8', Buffer.from([0xc3, 0xa9, 0x80, 0xff]), [1]) !== '|é��|') {
+        throw new Error('stray bytes');
+    }
+    // One U+FFFD per maximal subpart: F0 80 is two, F0 90 (a valid start) one.
+    if (decodeChunks('utf8', Buffer.from([0xf0, 0x80, 0x41]), [2]) !== '|��A|') {
+        throw new Error('held invalid prefix');
+    }
+    if (decodeChunks('utf8', Buffer.from([0xf0, 0x90, 0x41]), [2]) !== '|�A|') {
+        throw new Error('held valid prefix');
+    }
+    if (decodeChunks('utf8', Buffer.from([0xed, 0xa0]), []) !== '|��') {
+        throw new Error('held surrogate prefix');
+    }
+    if (decodeChunks('utf16le', Buffer.from([0x3d, 0xd8, 0x00, 0xde]), [2]) !== '|😀|') {
+        throw new Error('cut surrogate pair');
+    }
+    if (decodeChunks('utf16le', Buffer.from([0x61, 0x00, 0x62]), []) !== 'a|') {
+        throw new Error('odd byte not dropped');
+    }
+    if (decodeChunks('utf16le', Buffer.from([0x3d, 0xd8]), []) !== '|\ud83d') {
+        throw new Error('lone high surrogate');
+    }
+    if (decodeChunks('base64', Buffer.from('abcd'), [1]) !== '|YWJj|ZA==') {
+        throw new Error('base64 groups');
+    }
+
+    const decoder = new StringDecoder('UCS-2');
+    if (decoder.encoding !== 'utf16le') {
+        throw new Error(`ucs-2 normalised to ${decoder.encoding}`);
+    }
+    if (new StringDecoder('binary').encoding !== 'latin1') {
+        throw new Error('binary not normalised');
+    }
+    if (!(new StringDecoder().encoding === 'utf8' && new StringDecoder(null).encoding === 'utf8')) {
+        throw new Error('default');
+    }
+    decoder.write(Buffer.from([0x61]));
+    if (!(decoder.lastNeed === 1 && decoder.lastTotal === 2)) {
+        throw new Error('lastNeed/lastTotal');
+    }
+    // lastChar is a view of the held bytes, so one taken earlier sees the later ones.
+    const held = new StringDecoder();
+    held.write(Buffer.from([0xe2]));
+    const lastChar = held.lastChar;
+    if (!(Buffer.isBuffer(lastChar) && lastChar.toString('hex') === 'e2000000')) {
+        throw new Error('lastChar');
+    }
+    held.write(Buffer.from([0x82]));
+    if (lastChar.toString('hex') !== 'e2820000') {
+        throw new Error('lastChar is not live');
+    }
+    if (decoder.write('as is') !== 'as is') {
+        throw new Error('string not passed through');
+    }
+    if (new StringDecoder().end(Buffer.from([0xe2, 0x82])) !== '�') {
+        throw new Error('end(buf) did not flush');
+    }
+    if (code(() => new StringDecoder('klingon')) !== 'ERR_UNKNOWN_ENCODING') {
+        throw new Error('unknown encoding accepted');
+    }
+    if (code(() => new StringDecoder().write(5)) !== 'ERR_INVALID_ARG_TYPE') {
+        throw new Error('number accepted');
+    }
+
+    // Readable decodes pushed chunks itself and flushes a cut-off character before 'end'.
+    const bytes = Buffer.from(text);
+    const chunks = [];
+    for (let i = 0; i < bytes.length; i += 3) chunks.push(bytes.subarray(i, i + 3));
+    const stream = new Readable({ read() {} });
+    if (stream.readableEncoding !== null) {
+        throw new Error('readableEncoding set before setEncoding');
+    }
+    if (!(stream.setEncoding('utf8') === stream && stream.readableEncoding === 'utf8')) {
+        throw new Error('setEncoding');
+    }
+    const out = await pushAll(stream, chunks);
+    if (!out.every((chunk) => typeof chunk === 'string' && chunk.length > 0)) {
+        throw new Error('non-string or empty chunk');
+    }
+    if (out.join('') !== text) {
+        throw new Error('setEncoding stream decoded wrongly');
+    }
+
+    const hex = new Readable({ read() {}, encoding: 'hex' });
+    if (hex.readableEncoding !== 'hex') {
+        throw new Error('encoding option ignored');
+    }
+    if ((await pushAll(hex, [Buffer.from([1, 2]), Buffer.from([255])])).join('') !== '0102ff') {
+        throw new Error('hex stream');
+    }
+
+    const cut = new Readable({ read() {} });
+    cut.setEncoding('utf8');
+    if ((await pushAll(cut, [Buffer.from([0x61, 0xe2, 0x82])])).join('') !== 'a�') {
+        throw new Error('cut-off tail dropped');
+    }
+    if (code(() => new Readable({ read() {} }).setEncoding('klingon')) !== 'ERR_UNKNOWN_ENCODING') {
+        throw new Error('setEncoding');
+    }
+}
+
+runTest('string decoder', main);
@@ -0,0 +1,161 @@
+// Checks the native TextEncoder/TextDecoder: encode/encodeInto accounting, streaming decodes
+// split at every byte, fatal mode, BOM handling, utf-16le, windows-1252 and the error codes.
+// Everything except the windows-1252 0x80-0x9F range matches node; node decodes that range as
+// Latin-1, while Z8 follows the WHATWG table (0x80 is the euro sign).
+import util from 'node:util';
+
+function code(fn) {
+    try {
+        fn();
+    } catch (e) {
+        return e.code;
+    }
+    return undefined;
+}
+
+async function runTest(name, testFn) {
+    try {
+        console.log(`[RUNNING] ${name}`);
+        await testFn();
+        console.log(`[PASS] ${name}`);
+    } catch (e) {
+        console.error(`[FAIL] ${name}`);
+        console.error(`  Error: ${e.message}`);
+        process.exit(1);
+    }
+}
+
+async function main() {
+    if (!(util.TextEncoder === TextEncoder && util.TextDecoder === TextDecoder)) {
+        throw new Error('util exports differ from globals');
+    }
+
+    const text = 'plain ascii, é, €, 中文 and 😀';
+    const encoder = new TextEncoder();
+    if (encoder.encoding !== 'utf-8') {
+        throw new Error('encoder encoding is not utf-8');
+    }
+    const bytes = encoder.encode(text);
+    if (!(bytes instanceof Uint8Array && Buffer.from(bytes).equals(Buffer.from(text)))) {
+        throw new Error('encode mismatch');
+    }
+    if (encoder.encode().length !== 0) {
+        throw new Error('encode() is not empty');
+    }
+    if (Buffer.from(encoder.encode('a\ud800b')).toString('hex') !== '61efbfbd62') {
+        throw new Error('lone surrogate not replaced');
+    }
+
+    // encodeInto stops before a character that does not fit, counting UTF-16 units read.
+    const dest = new Uint8Array(5);
+    const into = encoder.encodeInto('a€😀', dest);
+    if (!(into.read === 2 && into.written === 4)) {
+        throw new Error(`encodeInto counted ${into.read}/${into.written}`);
+    }
+    const exact = encoder.encodeInto('a😀', new Uint8Array(5));
+    if (!(exact.read === 3 && exact.written === 5)) {
+        throw new Error('encodeInto did not fill the destination');
+    }
+    if (code(() => encoder.encodeInto('a', [])) !== 'ERR_INVALID_ARG_TYPE') {
+        throw new Error('encodeInto accepted an array');
+    }
+
+    // Streaming decodes hold incomplete sequences across every possible split.
+    for (let cut = 0; cut <= bytes.length; cut++) {
+        const decoder = new TextDecoder();
+        const out = decoder.decode(bytes.subarray(0, cut), { stream: true }) + decoder.decode(bytes.subarray(cut));
+        if (out !== text) {
+            throw new Error(`utf-8 split at ${cut} decoded wrongly`);
+        }
+    }
+    const byByte = new TextDecoder();
+    let out = '';
+    for (const byte of bytes) out += byByte.decode(new Uint8Array([byte]), { stream: true });
+    if (out + byByte.decode() !== text) {
+        throw new Error('byte-at-a-time decode mismatch');
+    }
+    if (new TextDecoder().decode(new Uint8Array([0xe2, 0x82])) !== '�') {
+        throw new Error('truncated tail not flushed');
+    }
+
+    // BOM handling and fatal mode.
+    const bom = new Uint8Array([0xef, 0xbb, 0xbf, 0x61]);
+    if (new TextDecoder().decode(bom) !== 'a') {
+        throw new Error('BOM was not stripped');
+    }
+    if (new TextDecoder('utf-8', { ignoreBOM: true }).decode(bom) !== '﻿a') {
+        throw new Error('ignoreBOM dropped the BOM');
+    }
+    const fatal = new TextDecoder('utf-8', { fatal: true });
+    if (!(fatal.fatal && !fatal.ignoreBOM)) {
+        throw new Error('fatal/ignoreBOM getters are wrong');
+    }
+    if (code(() => fatal.decode(new Uint8Array([0x61, 0xff]))) !== 'ERR_ENCODING_INVALID_ENCODED_DATA') {
+        throw new Error('fatal');
+    }
+    if (fatal.decode(new Uint8Array([0x61])) !== 'a') {
+        throw new Error('fatal decoder did not reset after an error');
+    }
+    if (new TextDecoder().decode(new Uint8Array([0x61, 0xff, 0x62])) !== 'a�b') {
+        throw new Error('bad byte not replaced');
+    }
+
+    // Input may be any ArrayBuffer view or an ArrayBuffer.
+    if (new TextDecoder().decode(bytes.buffer) !== text) {
+        throw new Error('ArrayBuffer input mismatch');
+    }
+    if (new TextDecoder().decode(new DataView(bytes.buffer, 0, 5)) !== 'plain') {
+        throw new Error('DataView input mismatch');
+    }
+    if (new TextDecoder().decode(undefined) !== '') {
+        throw new Error('undefined input is not empty');
+    }
+    if (code(() => new TextDecoder().decode('abc')) !== 'ERR_INVALID_ARG_TYPE') {
+        throw new Error('string input accepted');
+    }
+
+    // utf-16le, with a surrogate pair split across chunks and a lone surrogate.
+    const utf16 = new TextDecoder('utf-16le');
+    if (utf16.encoding !== 'utf-16le') {
+        throw new Error('utf-16le encoding name');
+    }
+    const units = Buffer.from('﻿x😀y', 'utf16le');
+    for (let cut = 0; cut <= units.length; cut++) {
+        const decoder = new TextDecoder('utf-16le');
+        const part = decoder.decode(units.subarray(0, cut), { stream: true }) + decoder.decode(units.subarray(cut));
+        if (part !== 'x😀y') {
+            throw new Error(`utf-16le split at ${cut} decoded wrongly`);
+        }
+    }
+    if (utf16.decode(Buffer.from('a\ud800b', 'utf16le')) !== 'a�b') {
+        throw new Error('lone surrogate not replaced');
+    }
+    if (utf16.decode(new Uint8Array([0x61, 0x00, 0x62])) !== 'a�') {
+        throw new Error('odd byte not replaced');
+    }
+
+    // windows-1252 and its latin1 labels.
+    const legacy = new TextDecoder(' Latin1 ');
+    if (legacy.encoding !== 'windows-1252') {
+        throw new Error(`latin1 resolved to ${legacy.encoding}`);
+    }
+    if (legacy.decode(new Uint8Array([0x61, 0xe9, 0xff])) !== 'aéÿ') {
+        throw new Error('windows-1252 high bytes mismatch');
+    }
+    if (process.versions.z8)
+        if (legacy.decode(new Uint8Array([0x80, 0x9f])) !== '€Ÿ') {
+            throw new Error('windows-1252 C1 range mismatch');
+        }
+
+    if (code(() => new TextDecoder('klingon')) !== 'ERR_ENCODING_NOT_SUPPORTED') {
+        throw new Error('unknown label accepted');
+    }
+    if (new TextDecoder('UTF8').encoding !== 'utf-8') {
+        throw new Error('utf8 label');
+    }
+    if (new TextDecoder('unicode-1-1-utf-8').encoding !== 'utf-8') {
+        throw new Error('unicode-1-1-utf-8 label');
+    }
+}
+
+runTest('text codec', main);
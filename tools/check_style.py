@@ -137,7 +137,7 @@ _SYSTEM_STRUCT_NAMES: Set[str] = {
     'sockaddr', 'sockaddr_in', 'sockaddr_in6', 'sockaddr_storage',
     'addrinfo', 'iovec', 'pollfd', 'epoll_event', 'rlimit', 'rusage',
     'sigaction', 'passwd', 'group', 'utsname', 'termios', 'winsize',
-    'itimerval', 'siginfo_t',
+    'itimerval', 'siginfo_t', 'statx', 'statx_timestamp', 'inotify_event',
     # Windows
     'OVERLAPPED', 'SECURITY_ATTRIBUTES', 'STARTUPINFO', 'STARTUPINFOW',
     'PROCESS_INFORMATION', 'SYSTEM_INFO', 'MEMORYSTATUSEX', 'FILETIME',